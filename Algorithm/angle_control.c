@@ -6,9 +6,12 @@
   */
 
 #include "angle_control.h"
+#include "recorder.h"
 #include "delay.h"
+#include "timebase.h"
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 /* 控制参数默认值 */
 #define DEFAULT_KP               10.0f    // 默认比例系数
@@ -16,53 +19,170 @@
 #define DEFAULT_KD               1.0f     // 默认微分系数
 #define DEFAULT_ALLOWED_ERROR    5.0f     // 默认允许误差 ±5°
 #define DEFAULT_STABLE_TIME      3000     // 默认稳定时间 3秒
+#define DEFAULT_STABLE_WINDOW_MS 500      // 默认稳定判定窗口(ms)，按控制频率换算为样本数
+#define STABLE_ENTER_RATIO       0.7f     // 进入阈值相对允许误差的比例(滞回)
+#define DEFAULT_EARLY_CONFIDENCE 0.8f     // 默认序列模式提前认定稳定的置信度门限
 
 #define DEFAULT_FAN_BASE_SPEED   50       // 默认风扇基础速度 50%
 #define DEFAULT_DUAL_MODE_RATIO  30       // 默认双风扇差速比例 30%
+#define DEFAULT_FAN_ACCEL        5.0f     // 默认风扇加速率(满量程/秒)
+#define DEFAULT_FAN_DECEL        3.0f     // 默认风扇减速率(满量程/秒)
 
-#define ANGLE_CONTROL_INTERVAL   10       // 控制循环间隔(ms)
+#define DEFAULT_MPC_HORIZON_MS   300      // 默认MPC预测时域(ms)，按控制频率换算为步数
+
+#define DEFAULT_SYSID_LAMBDA     0.995f   // 默认辨识遗忘因子(时间常数约2s)
+#define DEFAULT_SYSID_COVARIANCE 100.0f   // 默认辨识初始协方差
+
+#define DEFAULT_RPM_MAX          6000.0f  // 默认100%指令对应的转速(RPM)
+#define DEFAULT_RPM_KP           0.005f   // 默认转速环比例系数(%/RPM)
+#define DEFAULT_RPM_KI           0.05f    // 默认转速环积分系数(%/(RPM*s))
+#define RPM_TRIM_LIMIT           30.0f    // 转速环对开环指令的最大修正(%)
+#define RPM_SEPARATION           2000.0f  // 转速环积分分离阈值(RPM)
+
+#define DEFAULT_EST_PROCESS_NOISE     200.0f  // 默认估计器过程噪声(度/秒^2)
+#define DEFAULT_EST_MEASUREMENT_NOISE 0.5f    // 默认单样本测量噪声(度)
+
+#define SENSOR_FAULT_CYCLES      10       // 角度读数持续不可信多少个控制周期后停止风扇(100ms)
+
+/* 参数存储记录 */
+typedef struct {
+    float kp, ki, kd;            // 角度PID参数
+} AngleControlPidParam_TypeDef;
+
+typedef struct {
+    uint8_t base_speed;          // 风扇基础速度(%)
+    uint8_t ratio;               // 差速比例(%)
+} AngleControlFanParam_TypeDef;
+
+typedef struct {
+    float allowed_error;         // 允许误差(度)
+    uint16_t stable_time;        // 稳定时间(ms)
+} AngleControlStableParam_TypeDef;
+
+typedef struct {
+    float angles[10];            // 角度序列
+    uint8_t hold_times[10];      // 保持时间(秒)
+    uint8_t count;               // 角度数量
+} AngleControlSequenceParam_TypeDef;  // 旧格式，只读取
+
+typedef struct {
+    uint8_t count;               // 步数
+    uint8_t version;             // 记录版本，0为定长的旧记录(后面是SEQ_RING_SIZE步，未用的步清零)
+    uint8_t reserved[2];
+    SeqStep_TypeDef steps[SEQ_RING_SIZE]; // 序列程序，只保存前count步
+} AngleControlProgramParam_TypeDef;
+
+#define PROGRAM_PARAM_VERSION    1        // 序列程序记录版本：变长，4字节头后接count步
+#define PROGRAM_PARAM_HEADER     4        // 记录头(count, version, reserved)字节数
+
+/* 每轴参数占用的存储缓存(字节)，与上面的记录结构一致：PID 12、风扇 2、稳定判定 8、偏移 4、
+   序列程序最多 4+12*SEQ_RING_SIZE、旧格式序列 52(保存新记录时可能仍在)、传感器线性化表；每轴7个键 */
+#define ANGLE_CONTROL_PARAM_BYTES  (12 + 2 + 8 + 4 + (4 + 12 * SEQ_RING_SIZE) + 52 + 4 * ANGLE_SENSOR_LUT_SIZE)
+#define ANGLE_CONTROL_PARAM_KEYS   7
+#if ANGLE_CONTROL_AXIS_COUNT * ANGLE_CONTROL_PARAM_BYTES > PARAM_CACHE_SIZE || \
+    ANGLE_CONTROL_AXIS_COUNT * ANGLE_CONTROL_PARAM_KEYS > PARAM_MAX_KEYS
+#error "PARAM_CACHE_SIZE/PARAM_MAX_KEYS too small for ANGLE_CONTROL_AXIS_COUNT axes (reduce SEQ_RING_SIZE)"
+#endif
 
 /* 私有变量 */
-static volatile uint32_t g_system_time = 0;  // 系统时间，由SysTick中断更新
+static volatile uint32_t g_system_time = 0;  // 系统时间，由TIM4 1ms中断更新
+static uint32_t g_control_period_us = ANGLE_CONTROL_TICK_US; // 控制周期(us)，各轴共用TIM3节拍
+static AngleControlProgramParam_TypeDef g_program_param;     // 序列程序记录(近400字节，不放在栈上)
 
 /* 私有函数声明 */
 static void ANGLE_CONTROL_UpdateTime(AngleControl_TypeDef *control);
+static void ANGLE_CONTROL_EnterMode(AngleControl_TypeDef *control, ControlMode_TypeDef mode);
+static void ANGLE_CONTROL_Acquire(AngleControl_TypeDef *control);
+static void ANGLE_CONTROL_UpdateSampleTime(AngleControl_TypeDef *control, uint64_t timestamp);
+static void ANGLE_CONTROL_ResetTiming(AngleControl_TypeDef *control);
+static float ANGLE_CONTROL_Period(void);
+static uint32_t ANGLE_CONTROL_MsToSamples(uint32_t ms, uint32_t max);
+static float ANGLE_CONTROL_ComputePID(AngleControl_TypeDef *control);
+static void ANGLE_CONTROL_UpdateTach(AngleControl_TypeDef *control);
+static float ANGLE_CONTROL_RpmLoop(AngleControl_TypeDef *control, FanSelect_TypeDef fan, float percent);
+static void ANGLE_CONTROL_Allocate(AngleControl_TypeDef *control, float *left, float *right);
+static void ANGLE_CONTROL_ApplyOutput(AngleControl_TypeDef *control, float left, float right);
 static void ANGLE_CONTROL_ProcessSingleFan(AngleControl_TypeDef *control);
 static void ANGLE_CONTROL_ProcessDualFan(AngleControl_TypeDef *control);
+static void ANGLE_CONTROL_ProcessDualFanMPC(AngleControl_TypeDef *control);
 static void ANGLE_CONTROL_ProcessSequence(AngleControl_TypeDef *control);
 
 /**
   * @brief  角度控制系统初始化
   * @param  control: 角度控制结构体指针
   * @param  mode: 控制模式
+  * @param  fan: 本轴使用的风扇驱动实例(需已初始化)
+  * @param  sensor: 本轴使用的角度传感器实例(需已初始化)
   * @retval 无
   */
-void ANGLE_CONTROL_Init(AngleControl_TypeDef *control, ControlMode_TypeDef mode)
+void ANGLE_CONTROL_Init(AngleControl_TypeDef *control, ControlMode_TypeDef mode,
+                        FanDriver_TypeDef *fan, AngleSensor_TypeDef *sensor)
 {
     /* 初始化控制结构体 */
+    control->fan = fan;
+    control->sensor = sensor;
     control->mode = mode;
     control->target_angle = 0.0f;
     control->current_angle = 0.0f;
     control->allowed_error = DEFAULT_ALLOWED_ERROR;
     control->stable_time = DEFAULT_STABLE_TIME;
-    control->stable_start_time = 0;
+    control->early_confidence = DEFAULT_EARLY_CONFIDENCE;
+    STABILITY_Init(&control->stability,
+                   (uint8_t)ANGLE_CONTROL_MsToSamples(DEFAULT_STABLE_WINDOW_MS, STABILITY_WINDOW_MAX),
+                   DEFAULT_ALLOWED_ERROR * STABLE_ENTER_RATIO, DEFAULT_ALLOWED_ERROR,
+                   ANGLE_CONTROL_MsToSamples(DEFAULT_STABLE_TIME, 0xFFFFFFFF));
     control->fan_base_speed = DEFAULT_FAN_BASE_SPEED;
     control->dual_mode_ratio = DEFAULT_DUAL_MODE_RATIO;
+    ALLOC_Init(&control->alloc);
+    control->alloc_mode = ALLOC_MODE_FIXED_BASE;
     control->state = ANGLE_STATE_INIT;
     control->system_time = 0;
     control->last_update_time = 0;
+    control->cycles_last = 0;
+    control->cycles_max = 0;
+    control->sample_time_us = 0;
+    control->loop_time_us = 0;
+    control->timing.sample_dt = 0;
+    ANGLE_CONTROL_ResetTiming(control);
     
     /* 初始化PID控制器 */
-    PID_Init(&control->pid, DEFAULT_KP, DEFAULT_KI, DEFAULT_KD, PID_MODE_POSITION, 0.01f);
+    PID_Init(&control->pid, DEFAULT_KP, DEFAULT_KI, DEFAULT_KD, PID_MODE_POSITION, ANGLE_CONTROL_Period());
     PID_SetOutputLimits(&control->pid, -100.0f, 100.0f);
     
+    /* 初始化MPC控制器 */
+    MPC_Init(&control->mpc, ANGLE_CONTROL_Period(),
+             (uint8_t)ANGLE_CONTROL_MsToSamples(DEFAULT_MPC_HORIZON_MS, MPC_HORIZON_MAX));
+    
+    /* 初始化在线辨识器(默认关闭) */
+    SYSID_Init(&control->sysid, DEFAULT_SYSID_LAMBDA, DEFAULT_SYSID_COVARIANCE);
+    control->applied_input = 0.0f;
+    control->fine_output = 0;
+    
+    /* 初始化转速内环(默认关闭，未关联测速) */
+    control->tach[FAN_LEFT] = NULL;
+    control->tach[FAN_RIGHT] = NULL;
+    control->rpm_loop = 0;
+    control->current = NULL;
+    RECORDER_NestBegin();
+    ANGLE_CONTROL_SetRpmLoop(control, DEFAULT_RPM_MAX, DEFAULT_RPM_KP, DEFAULT_RPM_KI);
+    RECORDER_NestEnd();
+    
+    /* 初始化状态估计器(默认关闭) */
+    ANGLE_ESTIMATOR_Init(&control->estimator, DEFAULT_EST_PROCESS_NOISE, DEFAULT_EST_MEASUREMENT_NOISE,
+                         ANGLE_CONTROL_Period(), ANGLE_SENSOR_GetOversampling());
+    control->use_estimator = 0;
+    control->current_rate = 0.0f;
+    control->sample_dt = ANGLE_CONTROL_Period();
+    control->sample_new = 0;
+    control->sensor_fault = 0;
+    control->sensor_fault_cycles = 0;
+    
     /* 序列控制初始化 */
-    control->sequence.angle_count = 0;
-    control->sequence.current_index = 0;
+    SEQ_Init(&control->sequence);
     
-    /* 初始化风扇驱动 */
-    FAN_Init();
-    FAN_StopAll();
+    /* 风扇驱动由调用者初始化，这里只保证停转并设置斜坡 */
+    FAN_StopAll(control->fan);
+    FAN_SetRamp(control->fan, DEFAULT_FAN_ACCEL, DEFAULT_FAN_DECEL);
     
     printf("Angle control system initialized, mode: %d\r\n", mode);
 }
@@ -75,6 +195,8 @@ void ANGLE_CONTROL_Init(AngleControl_TypeDef *control, ControlMode_TypeDef mode)
   */
 void ANGLE_CONTROL_SetTarget(AngleControl_TypeDef *control, float angle)
 {
+    RECORDER_Command(control, RECORDER_CMD_TARGET, RECORDER_Float(angle), 0, 0);
+    
     /* 限制角度范围 */
     if (angle > 90.0f) angle = 90.0f;
     if (angle < -90.0f) angle = -90.0f;
@@ -85,7 +207,7 @@ void ANGLE_CONTROL_SetTarget(AngleControl_TypeDef *control, float angle)
     
     /* 重置稳定状态 */
     control->state = ANGLE_STATE_ADJUSTING;
-    control->stable_start_time = 0;
+    STABILITY_Reset(&control->stability);
     
     printf("Target angle set to %.1f degrees\r\n", angle);
 }
@@ -98,21 +220,54 @@ void ANGLE_CONTROL_SetTarget(AngleControl_TypeDef *control, float angle)
   */
 void ANGLE_CONTROL_SetMode(AngleControl_TypeDef *control, ControlMode_TypeDef mode)
 {
+    RECORDER_Command(control, RECORDER_CMD_MODE, mode, 0, 0);
+    
     if (control->mode != mode) {
-        /* 切换模式前停止所有风扇 */
-        FAN_StopAll();
-        
-        /* 更新模式 */
-        control->mode = mode;
-        
-        /* 重置控制状态 */
-        control->state = ANGLE_STATE_INIT;
-        PID_Reset(&control->pid);
-        
+        /* 
+         * 切换模式时风扇保持当前推力，由新模式的输出经斜坡平滑接管；
+         * 切换到空闲模式时由主循环按减速率停止
+         */
+        ANGLE_CONTROL_EnterMode(control, mode);
         printf("Control mode changed to %d\r\n", mode);
     }
 }
 
+/**
+  * @brief  进入控制模式并重置控制状态
+  * @param  control: 角度控制结构体指针
+  * @param  mode: 控制模式
+  * @retval 无
+  * @note   私有函数，SetMode和Stop共用，不记录命令
+  */
+static void ANGLE_CONTROL_EnterMode(AngleControl_TypeDef *control, ControlMode_TypeDef mode)
+{
+    /* 更新模式 */
+    control->mode = mode;
+    
+    /* 重置控制状态 */
+    control->state = ANGLE_STATE_INIT;
+    PID_Reset(&control->pid);
+    PID_SetOutputLimits(&control->pid, -100.0f, 100.0f);  // 单风扇模式会收窄为单侧
+    MPC_Reset(&control->mpc);
+    ALLOC_ResetEnergy(&control->alloc);
+    
+    /* 新模式的首个输出按斜坡从当前推力过渡(从空闲进入即软启动)，之后的闭环指令立即生效 */
+    FAN_ArmRamp(control->fan);
+    
+    /* 回到空闲时风扇已停，解除过流锁存，下次启动重新检测 */
+    if (mode == CONTROL_MODE_IDLE) {
+        FAN_ClearFault(control->fan, FAN_LEFT);
+        FAN_ClearFault(control->fan, FAN_RIGHT);
+    }
+    
+    /* 进入序列模式从第一步开始，离开时停止解释器 */
+    if (mode == CONTROL_MODE_SEQUENCE) {
+        SEQ_Start(&control->sequence, control->system_time, control->current_angle);
+    } else {
+        SEQ_Stop(&control->sequence);
+    }
+}
+
 /**
   * @brief  设置PID参数
   * @param  control: 角度控制结构体指针
@@ -123,10 +278,206 @@ void ANGLE_CONTROL_SetMode(AngleControl_TypeDef *control, ControlMode_TypeDef mo
   */
 void ANGLE_CONTROL_SetPID(AngleControl_TypeDef *control, float kp, float ki, float kd)
 {
+    RECORDER_Command(control, RECORDER_CMD_PID, RECORDER_Float(kp), RECORDER_Float(ki), RECORDER_Float(kd));
     PID_Tune(&control->pid, kp, ki, kd);
     printf("PID parameters updated: Kp=%.2f, Ki=%.2f, Kd=%.2f\r\n", kp, ki, kd);
 }
 
+/**
+  * @brief  使能/禁用角度状态估计器
+  * @param  control: 角度控制结构体指针
+  * @param  enable: 1使能，0禁用(使用平均+死区的原始测量)
+  * @retval 无
+  */
+void ANGLE_CONTROL_EnableEstimator(AngleControl_TypeDef *control, uint8_t enable)
+{
+    RECORDER_Command(control, RECORDER_CMD_ESTIMATOR, enable, 0, 0);
+    
+    if (enable && !control->use_estimator) {
+        /* 重新以下一次测量初始化估计状态 */
+        ANGLE_ESTIMATOR_Reset(&control->estimator);
+    }
+    control->use_estimator = enable ? 1 : 0;
+    control->current_rate = 0.0f;
+    
+    printf("Angle estimator %s\r\n", enable ? "enabled" : "disabled");
+}
+
+/**
+  * @brief  设置估计器噪声参数
+  * @param  control: 角度控制结构体指针
+  * @param  process_noise: 过程噪声，角加速度标准差(度/秒^2)
+  * @param  measurement_noise: 单样本测量噪声标准差(度)
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetEstimatorNoise(AngleControl_TypeDef *control, float process_noise, float measurement_noise)
+{
+    RECORDER_Command(control, RECORDER_CMD_EST_NOISE, RECORDER_Float(process_noise),
+                     RECORDER_Float(measurement_noise), 0);
+    ANGLE_ESTIMATOR_SetNoise(&control->estimator, process_noise, measurement_noise);
+    printf("Estimator noise updated: Q=%.2f, R=%.3f\r\n", process_noise, measurement_noise);
+}
+
+/**
+  * @brief  使能/禁用在线系统辨识
+  * @param  control: 角度控制结构体指针
+  * @param  enable: 使能状态 (1:使能, 0:禁用)
+  * @retval 无
+  */
+void ANGLE_CONTROL_EnableIdentification(AngleControl_TypeDef *control, uint8_t enable)
+{
+    RECORDER_Command(control, RECORDER_CMD_SYSID, enable, 0, 0);
+    SYSID_Enable(&control->sysid, enable);
+    printf("System identification %s\r\n", enable ? "enabled" : "disabled");
+}
+
+/**
+  * @brief  使能/禁用高分辨率输出
+  * @param  control: 角度控制结构体指针
+  * @param  enable: 1使能，输出按推力百分比经线性化表和抖动输出；0按整数占空比输出
+  * @retval 无
+  */
+void ANGLE_CONTROL_EnableFineOutput(AngleControl_TypeDef *control, uint8_t enable)
+{
+    RECORDER_Command(control, RECORDER_CMD_FINE_OUTPUT, enable, 0, 0);
+    control->fine_output = enable ? 1 : 0;
+    FAN_EnableDither(control->fan, control->fine_output);
+    printf("Fine output %s (PWM %luHz, %d bits)\r\n", enable ? "enabled" : "disabled",
+           (unsigned long)FAN_GetPwmFrequency(control->fan), FAN_GetResolutionBits(control->fan));
+}
+
+/**
+  * @brief  关联本轴风扇的测速实例
+  * @param  control: 角度控制结构体指针
+  * @param  left: 左风扇测速实例(需已初始化)，NULL表示无测速
+  * @param  right: 右风扇测速实例(需已初始化)，NULL表示无测速
+  * @retval 无
+  */
+void ANGLE_CONTROL_AttachTach(AngleControl_TypeDef *control, Tach_TypeDef *left, Tach_TypeDef *right)
+{
+    RECORDER_Command(control, RECORDER_CMD_ATTACH_TACH, (left != NULL) | ((right != NULL) << 1), 0, 0);
+    control->tach[FAN_LEFT] = left;
+    control->tach[FAN_RIGHT] = right;
+}
+
+/**
+  * @brief  关联本轴风扇驱动的电流检测实例
+  * @param  control: 角度控制结构体指针
+  * @param  current: 电流检测实例(需已初始化)，NULL表示无
+  * @retval 无
+  */
+void ANGLE_CONTROL_AttachCurrentSense(AngleControl_TypeDef *control, CurrentSense_TypeDef *current)
+{
+    control->current = current;
+}
+
+/**
+  * @brief  使能/禁用转速内环
+  * @param  control: 角度控制结构体指针
+  * @param  enable: 1使能，0禁用(开环占空比/推力输出)
+  * @retval 无
+  * @note   未关联测速的风扇始终开环输出
+  */
+void ANGLE_CONTROL_EnableRpmLoop(AngleControl_TypeDef *control, uint8_t enable)
+{
+    RECORDER_Command(control, RECORDER_CMD_RPM_LOOP, enable, 0, 0);
+    control->rpm_loop = enable ? 1 : 0;
+    PID_Reset(&control->rpm_pid[FAN_LEFT]);
+    PID_Reset(&control->rpm_pid[FAN_RIGHT]);
+    printf("RPM loop %s\r\n", enable ? "enabled" : "disabled");
+}
+
+/**
+  * @brief  设置转速内环参数
+  * @param  control: 角度控制结构体指针
+  * @param  rpm_max: 100%指令对应的转速(RPM)
+  * @param  kp: 比例系数(%/RPM)
+  * @param  ki: 积分系数(%/(RPM*s))
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetRpmLoop(AngleControl_TypeDef *control, float rpm_max, float kp, float ki)
+{
+    uint8_t i;
+    
+    RECORDER_Command(control, RECORDER_CMD_RPM_PARAMS, RECORDER_Float(rpm_max), RECORDER_Float(kp), RECORDER_Float(ki));
+    if (rpm_max <= 0.0f) return;
+    control->rpm_max = rpm_max;
+    
+    for (i = 0; i < FAN_COUNT; i++) {
+        PID_Init(&control->rpm_pid[i], kp, ki, 0.0f, PID_MODE_POSITION, ANGLE_CONTROL_Period());
+        PID_EnableDerivative(&control->rpm_pid[i], 0);
+        PID_SetOutputLimits(&control->rpm_pid[i], -RPM_TRIM_LIMIT, RPM_TRIM_LIMIT);
+        if (ki > 0.0f) {
+            PID_SetIntegralLimits(&control->rpm_pid[i], -RPM_TRIM_LIMIT / ki, RPM_TRIM_LIMIT / ki);
+        }
+        PID_SetIntegralSeparationThreshold(&control->rpm_pid[i], RPM_SEPARATION);
+    }
+}
+
+/**
+  * @brief  设置双风扇推力分配方式
+  * @param  control: 角度控制结构体指针
+  * @param  mode: ALLOC_MODE_FIXED_BASE固定共模，ALLOC_MODE_MIN_POWER最小功耗
+  * @retval 无
+  * @note   两种方式给出相同的净推力，角度环增益不变，可在运行中切换
+  */
+void ANGLE_CONTROL_SetAllocation(AngleControl_TypeDef *control, AllocMode_TypeDef mode)
+{
+    RECORDER_Command(control, RECORDER_CMD_ALLOCATION, mode, 0, 0);
+    control->alloc_mode = mode;
+    printf("Fan allocation: %s\r\n", (mode == ALLOC_MODE_MIN_POWER) ? "min power" : "fixed base");
+}
+
+/**
+  * @brief  获取本次运行的能耗统计
+  * @param  control: 角度控制结构体指针
+  * @param  energy: 输出实际分配的累计电能(J)
+  * @param  reference: 输出同样净推力按固定共模分配的累计电能(J)
+  * @retval 无
+  * @note   双风扇/序列模式下累计，切换模式时清零
+  */
+void ANGLE_CONTROL_GetEnergy(AngleControl_TypeDef *control, float *energy, float *reference)
+{
+    *energy = control->alloc.energy;
+    *reference = control->alloc.energy_ref;
+}
+
+/**
+  * @brief  获取采样间隔和控制周期的抖动统计
+  * @param  control: 角度控制结构体指针
+  * @param  timing: 输出统计(us)，区间内无数据时最小值为0
+  * @param  reset: 1表示读取后复位最小/最大值，开始新的统计区间
+  * @retval 无
+  * @note   统计在控制中断中更新，关中断取快照
+  */
+void ANGLE_CONTROL_GetTiming(AngleControl_TypeDef *control, AngleTiming_TypeDef *timing, uint8_t reset)
+{
+    __disable_irq();
+    *timing = control->timing;
+    if (reset) {
+        ANGLE_CONTROL_ResetTiming(control);
+    }
+    __enable_irq();
+    
+    if (timing->sample_dt_min == 0xFFFFFFFF) timing->sample_dt_min = 0;
+    if (timing->loop_dt_min == 0xFFFFFFFF) timing->loop_dt_min = 0;
+}
+
+/**
+  * @brief  设置MPC预测模型参数
+  * @param  control: 角度控制结构体指针
+  * @param  gain: 差动推力到角加速度的增益(度/秒^2/%)
+  * @param  damping: 角速度阻尼系数(1/s)
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetMPCModel(AngleControl_TypeDef *control, float gain, float damping)
+{
+    RECORDER_Command(control, RECORDER_CMD_MPC_MODEL, RECORDER_Float(gain), RECORDER_Float(damping), 0);
+    MPC_SetModel(&control->mpc, gain, damping);
+    printf("MPC model updated: Gain=%.2f, Damping=%.2f, K=[%.3f %.3f]\r\n",
+           gain, damping, control->mpc.gain_angle, control->mpc.gain_rate);
+}
+
 /**
   * @brief  设置允许误差和稳定时间
   * @param  control: 角度控制结构体指针
@@ -136,11 +487,27 @@ void ANGLE_CONTROL_SetPID(AngleControl_TypeDef *control, float kp, float ki, flo
   */
 void ANGLE_CONTROL_SetStableCondition(AngleControl_TypeDef *control, float error, uint16_t time)
 {
+    RECORDER_Command(control, RECORDER_CMD_STABLE, RECORDER_Float(error), time, 0);
     control->allowed_error = error;
     control->stable_time = time;
+    STABILITY_SetThresholds(&control->stability, error * STABLE_ENTER_RATIO, error);
+    STABILITY_SetHoldSamples(&control->stability, ANGLE_CONTROL_MsToSamples(time, 0xFFFFFFFF));
     printf("Stable condition updated: Error=%.1f degrees, Time=%d ms\r\n", error, time);
 }
 
+/**
+  * @brief  设置序列模式提前认定稳定的置信度门限
+  * @param  control: 角度控制结构体指针
+  * @param  confidence: 置信度门限(0-1)，大于1表示禁用，始终等待完整稳定时间
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetEarlyConfidence(AngleControl_TypeDef *control, float confidence)
+{
+    RECORDER_Command(control, RECORDER_CMD_EARLY_CONF, RECORDER_Float(confidence), 0, 0);
+    if (confidence < 0.0f) confidence = 0.0f;
+    control->early_confidence = confidence;
+}
+
 /**
   * @brief  角度控制主循环，在定时器中断中调用
   * @param  control: 角度控制结构体指针
@@ -148,25 +515,36 @@ void ANGLE_CONTROL_SetStableCondition(AngleControl_TypeDef *control, float error
   */
 void ANGLE_CONTROL_Process(AngleControl_TypeDef *control)
 {
-    float error;
+    StabilityState_TypeDef result;
+    uint32_t start_cycles;
+    uint64_t now_us;
+    uint32_t loop_dt;
     
-    /* 更新系统时间 */
+    /* 更新系统时间，节拍由TIM3按控制周期产生 */
     ANGLE_CONTROL_UpdateTime(control);
+    control->last_update_time = control->system_time;
+    RECORDER_TickBegin(control);
+    start_cycles = TIMEBASE_GetCycles();
     
-    /* 检查是否达到控制间隔 */
-    if ((control->system_time - control->last_update_time) < ANGLE_CONTROL_INTERVAL) {
-        return;
+    /* 控制周期抖动统计 */
+    now_us = TIMEBASE_GetMicros();
+    if (control->loop_time_us != 0) {
+        loop_dt = (uint32_t)(now_us - control->loop_time_us);
+        if (loop_dt < control->timing.loop_dt_min) control->timing.loop_dt_min = loop_dt;
+        if (loop_dt > control->timing.loop_dt_max) control->timing.loop_dt_max = loop_dt;
     }
-    control->last_update_time = control->system_time;
+    control->loop_time_us = now_us;
     
-    /* 获取当前角度 */
-    control->current_angle = ANGLE_SENSOR_GetAngle();
+    /* 获取当前角度和风扇转速 */
+    ANGLE_CONTROL_Acquire(control);
+    ANGLE_CONTROL_UpdateTach(control);
     
     /* 根据控制模式进行处理 */
     switch (control->mode) {
         case CONTROL_MODE_IDLE:
-            /* 空闲模式，停止所有风扇 */
-            FAN_StopAll();
+            /* 空闲模式，按减速率停止所有风扇 */
+            FAN_SoftStopAll(control->fan);
+            control->applied_input = 0.0f;
             control->state = ANGLE_STATE_INIT;
             break;
         
@@ -185,38 +563,328 @@ void ANGLE_CONTROL_Process(AngleControl_TypeDef *control)
             ANGLE_CONTROL_ProcessSequence(control);
             break;
         
+        case CONTROL_MODE_DUAL_FAN_MPC:
+            /* 双风扇MPC控制 */
+            ANGLE_CONTROL_ProcessDualFanMPC(control);
+            break;
+        
         default:
             /* 未知模式，停止所有风扇 */
-            FAN_StopAll();
+            FAN_StopAll(control->fan);
+            control->applied_input = 0.0f;
             control->state = ANGLE_STATE_ERROR;
             break;
     }
     
-    /* 检查是否稳定 */
-    error = fabs(control->target_angle - control->current_angle);
+    /* 电流：按本周期输出更新采样点 */
+    if (control->current != NULL) {
+        CURRENT_SENSE_Update(control->current);
+    }
     
-    if (error <= control->allowed_error) {
-        /* 在允许误差范围内 */
-        if (control->state != ANGLE_STATE_STABLE) {
-            /* 第一次进入稳定状态，记录开始时间 */
-            if (control->stable_start_time == 0) {
-                control->stable_start_time = control->system_time;
-            }
-            
-            /* 检查是否保持足够长的时间 */
-            if ((control->system_time - control->stable_start_time) >= control->stable_time) {
-                /* 稳定状态确认 */
-                control->state = ANGLE_STATE_STABLE;
-                printf("Angle stable at %.1f degrees\r\n", control->current_angle);
-            }
+    /* 在线辨识：用本周期的角度和施加的差速输入更新模型 */
+    if (control->mode != CONTROL_MODE_IDLE) {
+        SYSID_Update(&control->sysid, control->current_angle, control->applied_input);
+    }
+    
+    /* 稳定判定：滑动窗口统计+滞回，单点毛刺不会重置计时 */
+    result = STABILITY_Update(&control->stability, control->current_angle - control->target_angle);
+    
+    if (result == STABILITY_UNSETTLED) {
+        control->state = ANGLE_STATE_ADJUSTING;
+    } else if (control->state != ANGLE_STATE_STABLE) {
+        /* 序列模式下窗口统计足够可信时提前认定稳定 */
+        if (result == STABILITY_STABLE ||
+            (control->mode == CONTROL_MODE_SEQUENCE &&
+             STABILITY_IsConfident(&control->stability, control->early_confidence))) {
+            control->state = ANGLE_STATE_STABLE;
+            printf("Angle stable at %.1f degrees\r\n", control->current_angle);
+        }
+    }
+    
+    /* 本周期的输入和输出写入记录 */
+    RECORDER_TickEnd(control);
+    
+    /* 记录本轴单次控制的CPU周期开销 */
+    control->cycles_last = TIMEBASE_GetCycles() - start_cycles;
+    if (control->cycles_last > control->cycles_max) {
+        control->cycles_max = control->cycles_last;
+    }
+}
+
+/**
+  * @brief  依次处理多个控制轴
+  * @param  controls: 控制结构体数组
+  * @param  count: 轴数
+  * @retval 无
+  * @note   在TIM3中断中调用，各轴互不共享状态
+  */
+void ANGLE_CONTROL_ProcessAll(AngleControl_TypeDef *controls, uint8_t count)
+{
+    uint8_t i;
+    
+    for (i = 0; i < count; i++) {
+        ANGLE_CONTROL_Process(&controls[i]);
+    }
+}
+
+/**
+  * @brief  修改控制频率
+  * @param  controls: 控制结构体数组
+  * @param  count: 轴数
+  * @param  rate_hz: 控制频率(ANGLE_CONTROL_RATE_MIN - ANGLE_CONTROL_RATE_MAX Hz)
+  * @retval uint8_t: 1成功，0频率超范围或有轴不在空闲模式
+  * @note   位置式PID增益以秒为单位，按实际间隔计算，无需重新整定；
+  *         过采样率按新周期选择，估计器、MPC、稳定判定按新周期重新计算，
+  *         辨识模型与采样周期相关，一并复位。新周期从下一个TIM3节拍起生效
+  */
+uint8_t ANGLE_CONTROL_SetLoopRate(AngleControl_TypeDef *controls, uint8_t count, uint16_t rate_hz)
+{
+    AngleControl_TypeDef *control;
+    float period;
+    uint8_t i, j;
+    
+    if (rate_hz < ANGLE_CONTROL_RATE_MIN || rate_hz > ANGLE_CONTROL_RATE_MAX) return 0;
+    for (i = 0; i < count; i++) {
+        if (controls[i].mode != CONTROL_MODE_IDLE) {
+            printf("Error: loop rate can only be changed in idle mode\r\n");
+            return 0;
         }
+    }
+    
+    g_control_period_us = 1000000UL / rate_hz;
+    period = ANGLE_CONTROL_Period();
+    ANGLE_SENSOR_FitOversampling(g_control_period_us);
+    
+    for (i = 0; i < count; i++) {
+        control = &controls[i];
+        
+        /* 空闲模式下控制中断仍在采集和判稳，关中断保证重配置完整 */
+        __disable_irq();
+        PID_SetSampleTime(&control->pid, period);
+        PID_Reset(&control->pid);
+        for (j = 0; j < FAN_COUNT; j++) {
+            PID_SetSampleTime(&control->rpm_pid[j], period);
+            PID_Reset(&control->rpm_pid[j]);
+        }
+        ANGLE_ESTIMATOR_SetTiming(&control->estimator, period, ANGLE_SENSOR_GetOversampling());
+        MPC_SetTiming(&control->mpc, period,
+                      (uint8_t)ANGLE_CONTROL_MsToSamples(DEFAULT_MPC_HORIZON_MS, MPC_HORIZON_MAX));
+        STABILITY_Init(&control->stability,
+                       (uint8_t)ANGLE_CONTROL_MsToSamples(DEFAULT_STABLE_WINDOW_MS, STABILITY_WINDOW_MAX),
+                       control->allowed_error * STABLE_ENTER_RATIO, control->allowed_error,
+                       ANGLE_CONTROL_MsToSamples(control->stable_time, 0xFFFFFFFF));
+        SYSID_Reset(&control->sysid);
+        control->sample_dt = period;
+        control->loop_time_us = 0;
+        ANGLE_CONTROL_ResetTiming(control);
+        __enable_irq();
+    }
+    
+    RECORDER_Command(controls, RECORDER_CMD_LOOP_RATE, rate_hz, count, ANGLE_SENSOR_GetOversampling());
+    printf("Control loop rate %u Hz, oversampling %u\r\n", rate_hz, ANGLE_SENSOR_GetOversampling());
+    return 1;
+}
+
+/**
+  * @brief  获取控制节拍
+  * @param  无
+  * @retval uint16_t: TIM3 CC4每次推进的计数(us)
+  */
+uint16_t ANGLE_CONTROL_GetTickUs(void)
+{
+    return (uint16_t)g_control_period_us;
+}
+
+/**
+  * @brief  采集角度测量值
+  * @param  control: 角度控制结构体指针
+  * @retval 无
+  * @note   私有函数。估计器启用时由过采样窗口的定点角度直接融合出角度和角速度；
+  *         传感器超量程或数据停止时保持上一周期的角度，持续SENSOR_FAULT_CYCLES后停止风扇
+  */
+static void ANGLE_CONTROL_Acquire(AngleControl_TypeDef *control)
+{
+    int32_t angle_q16;
+    uint64_t timestamp = control->sample_time_us;
+    
+    control->sample_new = 0;
+    control->sensor_fault = ANGLE_SENSOR_GetFault(control->sensor);
+    RECORDER_Fault(control, control->sensor_fault);
+    if (control->sensor_fault & (ANGLE_SENSOR_FAULT_RANGE | ANGLE_SENSOR_FAULT_STALE)) {
+        if (control->sensor_fault_cycles < SENSOR_FAULT_CYCLES) {
+            control->sensor_fault_cycles++;
+        } else if (control->mode != CONTROL_MODE_IDLE) {
+            printf("Angle sensor fault 0x%02X, fans stopped\r\n", control->sensor_fault);
+            ANGLE_CONTROL_SetMode(control, CONTROL_MODE_IDLE);
+        }
+        return;
+    }
+    control->sensor_fault_cycles = 0;
+    
+    if (!control->use_estimator) {
+        control->current_angle = ANGLE_SENSOR_GetAngleAt(control->sensor, &timestamp);
+        RECORDER_Angle(control, RECORDER_READ_FLOAT, RECORDER_Float(control->current_angle), timestamp);
+        ANGLE_CONTROL_UpdateSampleTime(control, timestamp);
+        return;
+    }
+    
+    /* 读取失败时仅保持预测前的状态，不用无效样本更新 */
+    if (ANGLE_SENSOR_GetAngleQ16(control->sensor, &angle_q16, &timestamp) == ANGLE_SENSOR_OK) {
+        RECORDER_Angle(control, RECORDER_READ_Q16, (uint32_t)angle_q16, timestamp);
+        ANGLE_ESTIMATOR_UpdateQ16(&control->estimator, angle_q16);
+        ANGLE_CONTROL_UpdateSampleTime(control, timestamp);
     } else {
-        /* 不在允许误差范围内，重置稳定计时 */
-        control->stable_start_time = 0;
-        control->state = ANGLE_STATE_ADJUSTING;
+        RECORDER_Angle(control, RECORDER_READ_Q16 | RECORDER_READ_FAILED, 0, timestamp);
+    }
+    
+    control->current_angle = ANGLE_ESTIMATOR_GetAngle(&control->estimator);
+    control->current_rate = ANGLE_ESTIMATOR_GetRate(&control->estimator);
+}
+
+/**
+  * @brief  由样本时间戳更新实际采样间隔
+  * @param  control: 角度控制结构体指针
+  * @param  timestamp: 本周期所用样本的时间戳(us)
+  * @retval 无
+  * @note   私有函数。过采样窗口与控制周期不同步，样本间隔在窗口长度的整数倍间跳变；
+  *         PID按实际间隔积分和微分(停顿后的长间隔由PID限幅)。首个样本按标称控制周期计算
+  */
+static void ANGLE_CONTROL_UpdateSampleTime(AngleControl_TypeDef *control, uint64_t timestamp)
+{
+    uint32_t dt_us;
+    
+    if (timestamp == control->sample_time_us) return;
+    
+    if (control->sample_time_us != 0) {
+        dt_us = (uint32_t)(timestamp - control->sample_time_us);
+        control->timing.sample_dt = dt_us;
+        if (dt_us < control->timing.sample_dt_min) control->timing.sample_dt_min = dt_us;
+        if (dt_us > control->timing.sample_dt_max) control->timing.sample_dt_max = dt_us;
+        control->sample_dt = dt_us / 1000000.0f;
+    } else {
+        control->sample_dt = ANGLE_CONTROL_Period();
+    }
+    control->sample_time_us = timestamp;
+    control->sample_new = 1;
+}
+
+/**
+  * @brief  复位抖动统计的最小/最大值
+  * @param  control: 角度控制结构体指针
+  * @retval 无
+  * @note   私有函数
+  */
+static void ANGLE_CONTROL_ResetTiming(AngleControl_TypeDef *control)
+{
+    control->timing.sample_dt_min = 0xFFFFFFFF;
+    control->timing.sample_dt_max = 0;
+    control->timing.loop_dt_min = 0xFFFFFFFF;
+    control->timing.loop_dt_max = 0;
+}
+
+/**
+  * @brief  获取标称控制周期
+  * @param  无
+  * @retval float: 控制周期(s)
+  * @note   私有函数
+  */
+static float ANGLE_CONTROL_Period(void)
+{
+    return g_control_period_us / 1000000.0f;
+}
+
+/**
+  * @brief  把时间换算为控制周期数
+  * @param  ms: 时间(ms)
+  * @param  max: 结果上限
+  * @retval uint32_t: 周期数，至少为1
+  * @note   私有函数。窗口、时域等按时间配置的量在改变控制频率后保持时间不变
+  */
+static uint32_t ANGLE_CONTROL_MsToSamples(uint32_t ms, uint32_t max)
+{
+    uint32_t samples = (uint32_t)(((uint64_t)ms * 1000 + g_control_period_us / 2) / g_control_period_us);
+    
+    if (samples < 1) samples = 1;
+    if (samples > max) samples = max;
+    return samples;
+}
+
+/**
+  * @brief  处理各风扇的测速捕获
+  * @param  control: 角度控制结构体指针
+  * @retval 无
+  * @note   私有函数。每个控制周期调用，停转检测不依赖控制模式
+  */
+static void ANGLE_CONTROL_UpdateTach(AngleControl_TypeDef *control)
+{
+    Tach_TypeDef *tach;
+    uint8_t i;
+    
+    for (i = 0; i < FAN_COUNT; i++) {
+        tach = control->tach[i];
+        if (tach == NULL) continue;
+#if TACH_USE_SIMULATION
+        /* 仿真转速源：以当前推力指令驱动一阶转速模型 */
+        TACH_SimSetCommand(tach, FAN_GetThrust(control->fan, (FanSelect_TypeDef)i) * 100.0f / FAN_THRUST_MAX);
+#endif
+        TACH_Update(tach, TACH_GetCounter(tach));
     }
 }
 
+/**
+  * @brief  转速内环
+  * @param  control: 角度控制结构体指针
+  * @param  fan: 风扇选择
+  * @param  percent: 角度环给出的指令(%)，按percent*rpm_max/100解释为目标转速
+  * @retval float: 修正后的开环指令(%)
+  * @note   私有函数。开环指令作前馈，PI只补偿电压、老化等引起的转速偏差；
+  *         无测速、指令为0或停转(含起转未测到转速)时开环输出并清除积分
+  */
+static float ANGLE_CONTROL_RpmLoop(AngleControl_TypeDef *control, FanSelect_TypeDef fan, float percent)
+{
+    Tach_TypeDef *tach = control->tach[fan];
+    PID_TypeDef *pid = &control->rpm_pid[fan];
+    float output, rpm;
+    
+    if (tach == NULL || percent <= 0.0f) {
+        PID_Reset(pid);
+        return percent;
+    }
+    if (TACH_IsStalled(tach)) {
+        RECORDER_Rpm(control, fan, 1, 0, 0.0f);
+        PID_Reset(pid);
+        return percent;
+    }
+    
+    rpm = TACH_GetRpm(tach);
+    RECORDER_Rpm(control, fan, 0, 1, rpm);
+    PID_SetPoint(pid, percent * control->rpm_max / 100.0f);
+    output = percent + PID_Calculate(pid, rpm);
+    
+    if (output < 0.0f) output = 0.0f;
+    if (output > 100.0f) output = 100.0f;
+    return output;
+}
+
+/**
+  * @brief  计算PID输出
+  * @param  control: 角度控制结构体指针
+  * @retval float: PID输出
+  * @note   私有函数。估计器启用时微分项使用估计角速度；按实际样本间隔计算，
+  *         本周期没有新样本时保持上次输出(零阶保持)
+  */
+static float ANGLE_CONTROL_ComputePID(AngleControl_TypeDef *control)
+{
+    if (!control->sample_new) {
+        return control->pid.output;
+    }
+    if (control->use_estimator) {
+        return PID_CalculateWithRateDt(&control->pid, control->current_angle, control->current_rate,
+                                       control->sample_dt);
+    }
+    return PID_CalculateDt(&control->pid, control->current_angle, control->sample_dt);
+}
+
 /**
   * @brief  单风扇控制处理
   * @param  control: 角度控制结构体指针
@@ -226,10 +894,17 @@ void ANGLE_CONTROL_Process(AngleControl_TypeDef *control)
 static void ANGLE_CONTROL_ProcessSingleFan(AngleControl_TypeDef *control)
 {
     float pid_output;
-    uint8_t speed;
+    float speed;
+    
+    /* 单风扇不能反推：PID输出限制在风扇可达的一侧，抗积分饱和按实际执行量生效 */
+    if (control->target_angle >= 0.0f) {
+        PID_SetOutputLimits(&control->pid, 0.0f, 100.0f);
+    } else {
+        PID_SetOutputLimits(&control->pid, -100.0f, 0.0f);
+    }
     
     /* 计算PID输出 */
-    pid_output = PID_Calculate(&control->pid, control->current_angle);
+    pid_output = ANGLE_CONTROL_ComputePID(control);
     
     /* 
      * 单风扇控制逻辑：
@@ -237,27 +912,19 @@ static void ANGLE_CONTROL_ProcessSingleFan(AngleControl_TypeDef *control)
      * 2. 当需要负角度时(逆时针)，使用左风扇
      */
     
-    /* 根据目标角度决定使用哪个风扇 */
+    /* 根据目标角度决定使用哪个风扇；反向输出只能靠重力回摆，风扇停转 */
     if (control->target_angle >= 0.0f) {
         /* 目标角度为正，使用右风扇 */
-        speed = (uint8_t)(fabs(pid_output));
-        if (speed > 100) speed = 100;
-        
-        FAN_SetSpeed(FAN_RIGHT, speed);
-        FAN_SetSpeed(FAN_LEFT, 0);
+        speed = (pid_output > 0.0f) ? pid_output : 0.0f;
+        if (speed > 100.0f) speed = 100.0f;
         
-        /* 设置风扇方向 */
-        FAN_SetDirection(FAN_RIGHT, FAN_DIR_FORWARD);
+        ANGLE_CONTROL_ApplyOutput(control, 0.0f, speed);
     } else {
         /* 目标角度为负，使用左风扇 */
-        speed = (uint8_t)(fabs(pid_output));
-        if (speed > 100) speed = 100;
+        speed = (pid_output < 0.0f) ? -pid_output : 0.0f;
+        if (speed > 100.0f) speed = 100.0f;
         
-        FAN_SetSpeed(FAN_LEFT, speed);
-        FAN_SetSpeed(FAN_RIGHT, 0);
-        
-        /* 设置风扇方向 */
-        FAN_SetDirection(FAN_LEFT, FAN_DIR_FORWARD);
+        ANGLE_CONTROL_ApplyOutput(control, speed, 0.0f);
     }
 }
 
@@ -270,14 +937,13 @@ static void ANGLE_CONTROL_ProcessSingleFan(AngleControl_TypeDef *control)
 static void ANGLE_CONTROL_ProcessDualFan(AngleControl_TypeDef *control)
 {
     float pid_output;
-    int16_t base_speed;
+    float base_speed;
     float delta;
-    int16_t left_raw;
-    int16_t right_raw;
-    uint8_t left_speed, right_speed;
+    float left_raw;
+    float right_raw;
     
     /* 计算PID输出 */
-    pid_output = PID_Calculate(&control->pid, control->current_angle);
+    pid_output = ANGLE_CONTROL_ComputePID(control);
     
     /* 
      * 双风扇控制逻辑：
@@ -294,23 +960,142 @@ static void ANGLE_CONTROL_ProcessDualFan(AngleControl_TypeDef *control)
     delta = pid_output * control->dual_mode_ratio / 100.0f;
     
     /* 计算左右风扇速度 */
-    left_raw = base_speed - (int16_t)delta;
-    right_raw = base_speed + (int16_t)delta;
+    left_raw = base_speed - delta;
+    right_raw = base_speed + delta;
     
     /* 限制速度范围 */
-    if (left_raw < 0) left_raw = 0;
-    if (left_raw > 100) left_raw = 100;
-    if (right_raw < 0) right_raw = 0;
-    if (right_raw > 100) right_raw = 100;
+    if (left_raw < 0.0f) left_raw = 0.0f;
+    if (left_raw > 100.0f) left_raw = 100.0f;
+    if (right_raw < 0.0f) right_raw = 0.0f;
+    if (right_raw > 100.0f) right_raw = 100.0f;
     
-    left_speed = (uint8_t)left_raw;
-    right_speed = (uint8_t)right_raw;
+    /* 推力分配：按同样的净推力重新分配左右指令，并统计能耗 */
+    ANGLE_CONTROL_Allocate(control, &left_raw, &right_raw);
     
     /* 设置风扇速度和方向 */
-    FAN_SetSpeed(FAN_LEFT, left_speed);
-    FAN_SetSpeed(FAN_RIGHT, right_speed);
-    FAN_SetDirection(FAN_LEFT, FAN_DIR_FORWARD);
-    FAN_SetDirection(FAN_RIGHT, FAN_DIR_FORWARD);
+    ANGLE_CONTROL_ApplyOutput(control, left_raw, right_raw);
+}
+
+/**
+  * @brief  双风扇MPC控制处理
+  * @param  control: 角度控制结构体指针
+  * @retval 无
+  * @note   私有函数
+  */
+static void ANGLE_CONTROL_ProcessDualFanMPC(AngleControl_TypeDef *control)
+{
+    float base = (float)control->fan_base_speed;
+    float left_thrust, right_thrust;
+    
+    /* 
+     * MPC控制逻辑：
+     * 1. 以左右风扇推力为决策变量，在0-100%箱约束下由显式解求最优推力，
+     *    共模推力以fan_base_speed对应的推力为参考计入代价
+     * 2. 推力与指令的关系同线性化表：高分辨率输出时指令即推力，否则按平方关系换算为占空比
+     */
+    /* 本周期没有新样本时保持上次输出，重复的样本会被当作零角速度并使扰动估计漂移 */
+    if (control->sample_new) {
+        MPC_Calculate(&control->mpc, control->target_angle, control->current_angle,
+                      control->current_rate, control->use_estimator, control->sample_dt,
+                      control->fine_output ? base : base * base / 100.0f,
+                      &left_thrust, &right_thrust);
+    } else {
+        left_thrust = control->mpc.output_left;
+        right_thrust = control->mpc.output_right;
+    }
+    
+    if (!control->fine_output) {
+        left_thrust = 10.0f * sqrtf(left_thrust);
+        right_thrust = 10.0f * sqrtf(right_thrust);
+    }
+    
+    /* 设置风扇速度和方向 */
+    ANGLE_CONTROL_ApplyOutput(control, left_thrust, right_thrust);
+}
+
+/**
+  * @brief  双风扇推力分配
+  * @param  control: 角度控制结构体指针
+  * @param  left: 输入固定共模的左风扇指令，输出分配后的指令(%)
+  * @param  right: 输入固定共模的右风扇指令，输出分配后的指令(%)
+  * @retval 无
+  * @note   私有函数。推力与指令的关系同线性化表：高分辨率输出时指令即推力，
+  *         否则推力与占空比平方成正比。最小功耗分配保持净推力(右-左)不变
+  */
+static void ANGLE_CONTROL_Allocate(AngleControl_TypeDef *control, float *left, float *right)
+{
+    float ref_left, ref_right;
+    float thrust_left, thrust_right;
+    
+    if (control->fine_output) {
+        ref_left = *left;
+        ref_right = *right;
+    } else {
+        ref_left = *left * *left / 100.0f;
+        ref_right = *right * *right / 100.0f;
+    }
+    thrust_left = ref_left;
+    thrust_right = ref_right;
+    
+    if (control->alloc_mode == ALLOC_MODE_MIN_POWER) {
+        ALLOC_Lookup(&control->alloc, ref_right - ref_left, &thrust_left, &thrust_right);
+        if (control->fine_output) {
+            *left = thrust_left;
+            *right = thrust_right;
+        } else {
+            *left = 10.0f * sqrtf(thrust_left);
+            *right = 10.0f * sqrtf(thrust_right);
+        }
+    }
+    
+    ALLOC_Accumulate(&control->alloc, thrust_left, thrust_right, ref_left, ref_right,
+                     ANGLE_CONTROL_Period());
+}
+
+/**
+  * @brief  输出左右风扇指令
+  * @param  control: 角度控制结构体指针
+  * @param  left: 左风扇指令(%，0-100)
+  * @param  right: 右风扇指令(%，0-100)
+  * @retval 无
+  * @note   私有函数。高分辨率输出时指令为推力百分比，经线性化表换算为占空比；
+  *         否则四舍五入为整数占空比。applied_input记录实际施加的差值；
+  *         转速内环使能时记录角度环给出的转速指令差值
+  */
+static void ANGLE_CONTROL_ApplyOutput(AngleControl_TypeDef *control, float left, float right)
+{
+    uint16_t left_thrust, right_thrust;
+    uint8_t left_speed, right_speed;
+    float requested = right - left;
+    
+    if (control->rpm_loop) {
+        left = ANGLE_CONTROL_RpmLoop(control, FAN_LEFT, left);
+        right = ANGLE_CONTROL_RpmLoop(control, FAN_RIGHT, right);
+    }
+    
+    if (control->fine_output) {
+        left_thrust = (uint16_t)(left * FAN_THRUST_MAX / 100.0f + 0.5f);
+        right_thrust = (uint16_t)(right * FAN_THRUST_MAX / 100.0f + 0.5f);
+        FAN_StageThrust(control->fan, FAN_LEFT, left_thrust);
+        FAN_StageThrust(control->fan, FAN_RIGHT, right_thrust);
+        RECORDER_Output(control, 1, left_thrust, right_thrust);
+        control->applied_input = ((float)right_thrust - left_thrust) * 100.0f / FAN_THRUST_MAX;
+    } else {
+        left_speed = (uint8_t)(left + 0.5f);
+        right_speed = (uint8_t)(right + 0.5f);
+        FAN_StageSpeed(control->fan, FAN_LEFT, left_speed);
+        FAN_StageSpeed(control->fan, FAN_RIGHT, right_speed);
+        RECORDER_Output(control, 0, left_speed, right_speed);
+        control->applied_input = (float)right_speed - left_speed;
+    }
+    if (control->rpm_loop) {
+        control->applied_input = requested;
+    }
+    
+    /* 两路在同一PWM边沿生效，方向未变化时不重写引脚 */
+    FAN_StageDirection(control->fan, FAN_LEFT, FAN_DIR_FORWARD);
+    FAN_StageDirection(control->fan, FAN_RIGHT, FAN_DIR_FORWARD);
+    FAN_Commit(control->fan);
 }
 
 /**
@@ -321,51 +1106,52 @@ static void ANGLE_CONTROL_ProcessDualFan(AngleControl_TypeDef *control)
   */
 static void ANGLE_CONTROL_ProcessSequence(AngleControl_TypeDef *control)
 {
-    float current_target;
-    uint8_t hold_time;
-    uint32_t stable_time;
-    float next_angle;
+    SeqEngine_TypeDef *seq = &control->sequence;
+    uint8_t events;
     
     /* 检查序列是否有效 */
-    if (control->sequence.angle_count == 0) {
+    if (SEQ_IsEmpty(seq)) {
         /* 无效序列，切换到空闲模式 */
         ANGLE_CONTROL_SetMode(control, CONTROL_MODE_IDLE);
         return;
     }
     
-    /* 获取当前目标角度和保持时间 */
-    current_target = control->sequence.angles[control->sequence.current_index];
-    hold_time = control->sequence.hold_times[control->sequence.current_index];
+    /* 推进解释器，稳定判定用上一周期的结果 */
+    events = SEQ_Update(seq, control->system_time, control->current_angle,
+                        (control->state == ANGLE_STATE_STABLE) ? 1 : 0);
     
-    /* 检查当前角度是否已达到目标 */
-    if (control->state == ANGLE_STATE_STABLE) {
-        /* 已稳定，检查是否保持足够长的时间 */
-        stable_time = (control->system_time - control->sequence.stable_start_time) / 1000; // 转换为秒
-        
-        if (stable_time >= hold_time) {
-            /* 当前角度已保持足够长时间，切换到下一个角度 */
-            control->sequence.current_index++;
-            
-            /* 检查是否完成所有角度 */
-            if (control->sequence.current_index >= control->sequence.angle_count) {
-                /* 序列完成，切换到空闲模式 */
-                printf("Angle sequence completed\r\n");
-                ANGLE_CONTROL_SetMode(control, CONTROL_MODE_IDLE);
-                return;
-            }
-            
-            /* 设置新的目标角度 */
-            next_angle = control->sequence.angles[control->sequence.current_index];
-            ANGLE_CONTROL_SetTarget(control, next_angle);
-            
-            /* 重置稳定计时 */
-            control->sequence.stable_start_time = 0;
-            printf("Moving to next angle: %.1f degrees\r\n", next_angle);
-        }
-    } else if (control->state == ANGLE_STATE_STABLE && control->sequence.stable_start_time == 0) {
-        /* 刚稳定，记录稳定开始时间 */
-        control->sequence.stable_start_time = control->system_time;
-        printf("Angle %.1f degrees stable, holding for %d seconds\r\n", current_target, hold_time);
+    if (events & SEQ_EVENT_ERROR) {
+        printf("Angle sequence error at step %lu\r\n", (unsigned long)seq->pc);
+        ANGLE_CONTROL_SetMode(control, CONTROL_MODE_IDLE);
+        return;
+    }
+    if (events & SEQ_EVENT_DONE) {
+        /* 序列完成，切换到空闲模式 */
+        printf("Angle sequence completed, energy %.1f J (fixed base %.1f J)\r\n",
+               control->alloc.energy, control->alloc.energy_ref);
+        ANGLE_CONTROL_SetMode(control, CONTROL_MODE_IDLE);
+        return;
+    }
+    if (events & SEQ_EVENT_MOVE) {
+        printf("Moving to next angle: %.1f degrees\r\n", seq->target);
+    }
+    if (events & SEQ_EVENT_HOLD) {
+        printf("Angle %.1f degrees stable, holding for %lu ms\r\n", seq->target, (unsigned long)seq->step.time);
+    }
+    if (events & SEQ_EVENT_KEY) {
+        printf("Angle sequence waiting for key\r\n");
+    }
+    if (events & SEQ_EVENT_STARVED) {
+        printf("Angle sequence waiting for step %lu\r\n", (unsigned long)seq->pc);
+    }
+    
+    if (seq->state == SEQ_STATE_RUNNING && seq->phase == SEQ_PHASE_RAMP) {
+        /* 斜坡中只移动设定值，不重置PID和稳定判定 */
+        control->target_angle = seq->setpoint;
+        PID_SetPoint(&control->pid, seq->setpoint);
+    } else if (events & (SEQ_EVENT_MOVE | SEQ_EVENT_RAMP_END)) {
+        /* 阶跃或斜坡结束：设定终点，重新开始稳定判定 */
+        ANGLE_CONTROL_SetTarget(control, seq->target);
     }
     
     /* 使用双风扇控制模式处理角度 */
@@ -387,31 +1173,89 @@ uint8_t ANGLE_CONTROL_IsStable(AngleControl_TypeDef *control)
   * @param  control: 角度控制结构体指针
   * @param  angles: 角度序列数组
   * @param  hold_times: 各角度保持时间数组(秒)
-  * @param  count: 角度数量
-  * @retval 无
+  * @param  count: 角度数量(最多SEQ_RING_SIZE-1，留一步给END)
+  * @retval uint8_t: 1成功，0角度过多，当前程序不变
+  * @note   编译为序列程序(每个角度一条MOVE，使用本轴稳定判定)，替换当前程序
   */
-void ANGLE_CONTROL_ConfigSequence(AngleControl_TypeDef *control, float *angles, uint8_t *hold_times, uint8_t count)
+uint8_t ANGLE_CONTROL_ConfigSequence(AngleControl_TypeDef *control, float *angles, uint8_t *hold_times, uint8_t count)
 {
+    SeqStep_TypeDef step;
     uint8_t i;
-    float angle;
     
-    /* 检查参数有效性 */
-    if (count > 10) count = 10; // 最多10个角度
+    /* 放不下时拒绝，不截断成另一个程序 */
+    if (count > SEQ_RING_SIZE - 1) {
+        printf("Angle sequence too long: %d angles, max %d\r\n", count, SEQ_RING_SIZE - 1);
+        return 0;
+    }
     
-    /* 保存序列参数 */
-    control->sequence.angle_count = count;
+    for (i = 0; i < count; i++) {
+        RECORDER_Command(control, RECORDER_CMD_SEQ_STEP, i, RECORDER_Float(angles[i]), hold_times[i]);
+    }
+    RECORDER_Command(control, RECORDER_CMD_SEQUENCE, count, 0, 0);
     
+    /* 内部的清空和追加由重放时的本函数产生，记为嵌套 */
+    RECORDER_NestBegin();
+    ANGLE_CONTROL_ClearProgram(control, 0);
+    memset(&step, 0, sizeof(step));
+    step.op = SEQ_OP_MOVE;
+    step.flags = SEQ_RAMP_STEP;
     for (i = 0; i < count; i++) {
         /* 限制角度范围 */
-        angle = angles[i];
-        if (angle > 90.0f) angle = 90.0f;
-        if (angle < -90.0f) angle = -90.0f;
-        
-        control->sequence.angles[i] = angle;
-        control->sequence.hold_times[i] = hold_times[i];
+        step.value = (int16_t)(((angles[i] > 90.0f) ? 90.0f : (angles[i] < -90.0f) ? -90.0f : angles[i]) * 100.0f);
+        step.time = hold_times[i] * 1000UL;
+        ANGLE_CONTROL_AppendStep(control, &step);
     }
+    step.op = SEQ_OP_END;
+    ANGLE_CONTROL_AppendStep(control, &step);
+    RECORDER_NestEnd();
     
     printf("Angle sequence configured with %d angles\r\n", count);
+    return 1;
+}
+
+/**
+  * @brief  清空序列程序，准备逐步追加
+  * @param  control: 角度控制结构体指针
+  * @param  stream: 1流式(执行过的步随即释放，长度不限)，0存储(最多SEQ_RING_SIZE步，可保存)
+  * @retval 无
+  */
+void ANGLE_CONTROL_ClearProgram(AngleControl_TypeDef *control, uint8_t stream)
+{
+    RECORDER_Command(control, RECORDER_CMD_PROG_CLEAR, stream, 0, 0);
+    SEQ_Clear(&control->sequence, stream);
+}
+
+/**
+  * @brief  追加一步序列指令
+  * @param  control: 角度控制结构体指针
+  * @param  step: 指令
+  * @retval uint8_t: SEQ_OK/SEQ_FULL(稍后重试)/SEQ_INVALID
+  * @note   流式程序可在序列运行中追加
+  */
+uint8_t ANGLE_CONTROL_AppendStep(AngleControl_TypeDef *control, const SeqStep_TypeDef *step)
+{
+    RECORDER_Command(control, RECORDER_CMD_PROG_STEP,
+                     step->op | ((uint32_t)step->flags << 8) | ((uint32_t)(uint16_t)step->value << 16),
+                     step->tolerance | ((uint32_t)step->rate << 16), step->time);
+    return SEQ_Append(&control->sequence, step);
+}
+
+/**
+  * @brief  改用内置序列程序(Flash)
+  * @param  control: 角度控制结构体指针
+  * @param  id: SEQ_PROGRAM_x
+  * @retval uint8_t: 1成功，0程序号无效
+  */
+uint8_t ANGLE_CONTROL_LoadProgram(AngleControl_TypeDef *control, uint8_t id)
+{
+    const SeqStep_TypeDef *program;
+    uint32_t len;
+    
+    RECORDER_Command(control, RECORDER_CMD_PROG_BUILTIN, id, 0, 0);
+    program = SEQ_GetBuiltin(id, &len);
+    if (program == NULL) return 0;
+    SEQ_LoadProgram(&control->sequence, program, len);
+    return 1;
 }
 
 /**
@@ -422,25 +1266,40 @@ void ANGLE_CONTROL_ConfigSequence(AngleControl_TypeDef *control, float *angles,
 void ANGLE_CONTROL_StartSequence(AngleControl_TypeDef *control)
 {
     /* 检查是否有有效序列 */
-    if (control->sequence.angle_count == 0) {
+    if (SEQ_IsEmpty(&control->sequence)) {
         printf("Error: No valid angle sequence\r\n");
         return;
     }
     
-    /* 切换到序列控制模式 */
-    ANGLE_CONTROL_SetMode(control, CONTROL_MODE_SEQUENCE);
-    
-    /* 重置序列索引 */
-    control->sequence.current_index = 0;
-    control->sequence.start_time = control->system_time;
-    control->sequence.stable_start_time = 0;
+    /* 内部的模式设置由重放时的本函数产生，记为嵌套 */
+    RECORDER_Command(control, RECORDER_CMD_START_SEQ, 0, 0, 0);
+    RECORDER_NestBegin();
     
-    /* 设置第一个目标角度 */
-    ANGLE_CONTROL_SetTarget(control, control->sequence.angles[0]);
+    /* 切换到序列控制模式，已在序列模式时从第一步重新开始 */
+    ANGLE_CONTROL_SetMode(control, CONTROL_MODE_SEQUENCE);
+    if (!SEQ_Start(&control->sequence, control->system_time, control->current_angle)) {
+        printf("Error: Stream sequence already consumed\r\n");
+        ANGLE_CONTROL_SetMode(control, CONTROL_MODE_IDLE);
+        RECORDER_NestEnd();
+        return;
+    }
+    RECORDER_NestEnd();
     
     printf("Angle sequence started\r\n");
 }
 
+/**
+  * @brief  向序列输入按键(WAIT_KEY)
+  * @param  control: 角度控制结构体指针
+  * @param  key: 键值
+  * @retval 无
+  */
+void ANGLE_CONTROL_SequenceKey(AngleControl_TypeDef *control, uint8_t key)
+{
+    RECORDER_Command(control, RECORDER_CMD_SEQ_KEY, key, 0, 0);
+    SEQ_Key(&control->sequence, key);
+}
+
 /**
   * @brief  设置风扇基础速度和比例
   * @param  control: 角度控制结构体指针
@@ -450,6 +1309,8 @@ void ANGLE_CONTROL_StartSequence(AngleControl_TypeDef *control)
   */
 void ANGLE_CONTROL_SetFanParameters(AngleControl_TypeDef *control, uint8_t base_speed, uint8_t ratio)
 {
+    RECORDER_Command(control, RECORDER_CMD_FAN_PARAMS, base_speed, ratio, 0);
+    
     /* 限制参数范围 */
     if (base_speed > 100) base_speed = 100;
     if (ratio > 100) ratio = 100;
@@ -467,15 +1328,13 @@ void ANGLE_CONTROL_SetFanParameters(AngleControl_TypeDef *control, uint8_t base_
   */
 void ANGLE_CONTROL_Stop(AngleControl_TypeDef *control)
 {
-    /* 停止所有风扇 */
-    FAN_StopAll();
+    RECORDER_Command(control, RECORDER_CMD_STOP, 0, 0, 0);
     
-    /* 切换到空闲模式 */
-    control->mode = CONTROL_MODE_IDLE;
-    control->state = ANGLE_STATE_INIT;
+    /* 按减速率停止所有风扇 */
+    FAN_SoftStopAll(control->fan);
     
-    /* 重置PID控制器 */
-    PID_Reset(&control->pid);
+    /* 切换到空闲模式，已空闲时同样重置控制状态 */
+    ANGLE_CONTROL_EnterMode(control, CONTROL_MODE_IDLE);
     
     printf("Angle control stopped\r\n");
 }
@@ -491,6 +1350,134 @@ static void ANGLE_CONTROL_UpdateTime(AngleControl_TypeDef *control)
     control->system_time = g_system_time;
 }
 
+/**
+  * @brief  从参数存储加载本轴参数
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号(参数键的实例号)
+  * @retval uint8_t: 加载的参数组数，未保存的参数保持默认值
+  * @note   包括PID参数、风扇基础速度/比例、稳定判定条件、角度序列和传感器偏移
+  */
+uint8_t ANGLE_CONTROL_LoadParams(AngleControl_TypeDef *control, uint8_t axis)
+{
+    AngleControlPidParam_TypeDef pid;
+    AngleControlFanParam_TypeDef fan;
+    AngleControlStableParam_TypeDef stable;
+    AngleControlSequenceParam_TypeDef sequence;
+    AngleControlProgramParam_TypeDef *program;
+    float offset;
+    uint16_t len;
+    uint8_t loaded = 0;
+    uint8_t i;
+    
+    if (PARAM_Get(PARAM_KEY_PID(axis), &pid, sizeof(pid)) == PARAM_OK) {
+        ANGLE_CONTROL_SetPID(control, pid.kp, pid.ki, pid.kd);
+        loaded++;
+    }
+    if (PARAM_Get(PARAM_KEY_FAN(axis), &fan, sizeof(fan)) == PARAM_OK) {
+        ANGLE_CONTROL_SetFanParameters(control, fan.base_speed, fan.ratio);
+        loaded++;
+    }
+    if (PARAM_Get(PARAM_KEY_STABLE(axis), &stable, sizeof(stable)) == PARAM_OK) {
+        ANGLE_CONTROL_SetStableCondition(control, stable.allowed_error, stable.stable_time);
+        loaded++;
+    }
+    if (PARAM_Get(PARAM_KEY_SEQUENCE(axis), &sequence, sizeof(sequence)) == PARAM_OK &&
+        sequence.count <= sizeof(sequence.hold_times) &&
+        ANGLE_CONTROL_ConfigSequence(control, sequence.angles, sequence.hold_times, sequence.count)) {
+        loaded++;
+    }
+    
+    /* 变长记录和旧的定长记录都只用前count步；SEQ_RING_SIZE不同的固件保存的记录放不下时不加载并提示 */
+    program = &g_program_param;
+    if (PARAM_GetVar(PARAM_KEY_SEQ_PROGRAM(axis), program, sizeof(*program), &len) == PARAM_OK) {
+        if (program->version > PROGRAM_PARAM_VERSION || len < PROGRAM_PARAM_HEADER ||
+            program->count > (len - PROGRAM_PARAM_HEADER) / sizeof(SeqStep_TypeDef)) {
+            printf("Stored sequence program invalid (version %d, %d bytes), not loaded\r\n",
+                   program->version, len);
+        } else if (program->count > SEQ_RING_SIZE) {
+            printf("Stored sequence program has %d steps, max %d, not loaded\r\n",
+                   program->count, SEQ_RING_SIZE);
+        } else {
+            ANGLE_CONTROL_ClearProgram(control, 0);
+            for (i = 0; i < program->count; i++) {
+                ANGLE_CONTROL_AppendStep(control, &program->steps[i]);
+            }
+            loaded++;
+        }
+    }
+    if (PARAM_Get(PARAM_KEY_ANGLE_OFFSET(axis), &offset, sizeof(offset)) == PARAM_OK) {
+        ANGLE_SENSOR_SetOffset(control->sensor, offset);
+        loaded++;
+    }
+    
+    return loaded;
+}
+
+/**
+  * @brief  保存本轴参数到参数存储
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号(参数键的实例号)
+  * @retval ParamStatus_TypeDef: PARAM_OK，或第一个保存失败的原因(PARAM_FULL为缓存不足)
+  * @note   只更新参数存储的RAM缓存，由主循环分批写入Flash
+  */
+ParamStatus_TypeDef ANGLE_CONTROL_SaveParams(AngleControl_TypeDef *control, uint8_t axis)
+{
+    AngleControlPidParam_TypeDef pid;
+    AngleControlFanParam_TypeDef fan;
+    AngleControlStableParam_TypeDef stable;
+    AngleControlProgramParam_TypeDef *program = &g_program_param;
+    SeqEngine_TypeDef *seq = &control->sequence;
+    ParamStatus_TypeDef status, result = PARAM_OK;
+    float offset;
+    uint16_t len;
+    uint8_t i;
+    
+    /* 各组独立保存，返回第一个失败 */
+    pid.kp = control->pid.Kp;
+    pid.ki = control->pid.Ki;
+    pid.kd = control->pid.Kd;
+    status = PARAM_Set(PARAM_KEY_PID(axis), &pid, sizeof(pid));
+    if (result == PARAM_OK) result = status;
+    
+    fan.base_speed = control->fan_base_speed;
+    fan.ratio = control->dual_mode_ratio;
+    status = PARAM_Set(PARAM_KEY_FAN(axis), &fan, sizeof(fan));
+    if (result == PARAM_OK) result = status;
+    
+    memset(&stable, 0, sizeof(stable));
+    stable.allowed_error = control->allowed_error;
+    stable.stable_time = control->stable_time;
+    status = PARAM_Set(PARAM_KEY_STABLE(axis), &stable, sizeof(stable));
+    if (result == PARAM_OK) result = status;
+    
+    /* 只保存存储方式的RAM程序，记录长度随步数变化；填充字节清零，内容未变时不产生写入 */
+    if (seq->program == NULL && !seq->stream && seq->tail > 0) {
+        memset(program, 0, PROGRAM_PARAM_HEADER);
+        program->count = (uint8_t)seq->tail;
+        program->version = PROGRAM_PARAM_VERSION;
+        for (i = 0; i < program->count; i++) {
+            program->steps[i] = seq->ring[i];
+        }
+        len = (uint16_t)(PROGRAM_PARAM_HEADER + program->count * sizeof(SeqStep_TypeDef));
+        status = PARAM_Set(PARAM_KEY_SEQ_PROGRAM(axis), program, len);
+        if (status == PARAM_ERROR) {
+            /* 已有记录长度不同(步数变化或旧的定长记录)：删除后重新保存 */
+            PARAM_Delete(PARAM_KEY_SEQ_PROGRAM(axis));
+            status = PARAM_Set(PARAM_KEY_SEQ_PROGRAM(axis), program, len);
+        }
+        if (status == PARAM_OK) {
+            PARAM_Delete(PARAM_KEY_SEQUENCE(axis));    // 旧格式记录由新记录取代
+        }
+        if (result == PARAM_OK) result = status;
+    }
+    
+    offset = ANGLE_SENSOR_GetOffset(control->sensor);
+    status = PARAM_Set(PARAM_KEY_ANGLE_OFFSET(axis), &offset, sizeof(offset));
+    if (result == PARAM_OK) result = status;
+    
+    return result;
+}
+
 /**
   * @brief  获取控制系统运行时间(ms)
   * @param  无
@@ -502,10 +1489,10 @@ uint32_t ANGLE_CONTROL_GetTime(void)
 }
 
 /**
-  * @brief  SysTick中断处理函数，更新系统时间
+  * @brief  1ms时基中断处理函数，更新系统时间
   * @param  无
   * @retval 无
-  * @note   需要在stm32f10x_it.c中调用
+  * @note   需要在stm32f10x_it.c的TIM4中断中调用
   */
 void ANGLE_CONTROL_TimeUpdate(void)
 {
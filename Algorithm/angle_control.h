@@ -12,13 +12,34 @@
 #include "pid_controller.h" 
 #include "fan_driver.h"
 #include "angle_sensor.h"
+#include "tach.h"
+#include "current_sense.h"
+#include "angle_estimator.h"
+#include "mpc_controller.h"
+#include "control_allocation.h"
+#include "system_ident.h"
+#include "stability_detector.h"
+#include "sequence_engine.h"
+#include "param_store.h"
+
+/* 控制轴(风力板)数量，每轴独占一个风扇驱动和一个角度传感器 */
+#ifndef ANGLE_CONTROL_AXIS_COUNT
+#define ANGLE_CONTROL_AXIS_COUNT 1
+#endif
+
+/* 控制节拍：TIM3以1MHz自由运行(兼作测速捕获时基)，CC4比较中断每次推进一个控制周期，
+   默认ANGLE_CONTROL_TICK_US，可由ANGLE_CONTROL_SetLoopRate在运行时修改 */
+#define ANGLE_CONTROL_TICK_US    10000    // 默认控制周期(us)，100Hz
+#define ANGLE_CONTROL_RATE_MIN   50       // 最低控制频率(Hz)
+#define ANGLE_CONTROL_RATE_MAX   1000     // 最高控制频率(Hz)
 
 /* 控制系统工作模式 */
 typedef enum {
     CONTROL_MODE_IDLE = 0,       // 空闲模式（不控制）
     CONTROL_MODE_SINGLE_FAN = 1, // 单风扇控制
     CONTROL_MODE_DUAL_FAN = 2,   // 双风扇控制
-    CONTROL_MODE_SEQUENCE = 3    // 角度序列控制
+    CONTROL_MODE_SEQUENCE = 3,   // 角度序列控制
+    CONTROL_MODE_DUAL_FAN_MPC = 4 // 双风扇模型预测控制
 } ControlMode_TypeDef;
 
 /* 角度控制状态 */
@@ -29,36 +50,72 @@ typedef enum {
     ANGLE_STATE_ERROR = 3       // 控制错误
 } AngleState_TypeDef;
 
-/* 角度序列控制配置 */
+/* 采样与控制周期抖动统计(us) */
 typedef struct {
-    float angles[10];           // 角度序列
-    uint8_t hold_times[10];     // 各角度保持时间(秒)
-    uint8_t angle_count;        // 角度数量
-    uint8_t current_index;      // 当前角度索引
-    uint32_t start_time;        // 开始时间
-    uint32_t stable_start_time; // 稳定开始时间
-} AngleSequence_TypeDef;
+    uint32_t sample_dt;          // 最近两次所用角度样本的间隔
+    uint32_t sample_dt_min;      // 样本间隔最小值
+    uint32_t sample_dt_max;      // 样本间隔最大值
+    uint32_t loop_dt_min;        // 控制计算周期最小值
+    uint32_t loop_dt_max;        // 控制计算周期最大值
+} AngleTiming_TypeDef;
 
 /* 角度控制配置 */
 typedef struct {
+    FanDriver_TypeDef *fan;      // 本轴风扇驱动
+    AngleSensor_TypeDef *sensor; // 本轴角度传感器
+    
     ControlMode_TypeDef mode;    // 控制模式
     float target_angle;          // 目标角度
     float current_angle;         // 当前角度
     float allowed_error;         // 允许误差(角度稳定判定)
     uint16_t stable_time;        // 需要保持稳定的时间(ms)
-    uint32_t stable_start_time;  // 稳定开始时间
+    StabilityDetector_TypeDef stability; // 稳定判定器
+    float early_confidence;      // 序列模式提前认定稳定的置信度门限
     
     PID_TypeDef pid;             // PID控制器
+    MPC_TypeDef mpc;             // 双风扇MPC控制器
+    
+    /* 状态估计 */
+    AngleEstimator_TypeDef estimator; // 角度/角速度估计器
+    uint8_t use_estimator;       // 1: 使用估计器输出角度，并以估计角速度作为PID微分
+    float current_rate;          // 当前角速度(度/秒)，仅估计器启用时有效
+    float sample_dt;             // 本次与上次所用角度样本的实际间隔(s)
+    uint8_t sample_new;          // 1: 本周期取到了新的角度样本
+    uint8_t sensor_fault;        // 角度传感器故障标志(ANGLE_SENSOR_FAULT_x)
+    uint8_t sensor_fault_cycles; // 读数连续不可信的控制周期数
+    
+    /* 在线辨识 */
+    SysId_TypeDef sysid;         // 占空比->角度ARX模型辨识器
+    float applied_input;         // 本周期施加的差速占空比 右-左(%)
+    uint8_t fine_output;         // 1: 以推力百分比经线性化表+抖动输出，0: 整数占空比输出
+    
+    /* 转速内环 */
+    Tach_TypeDef *tach[FAN_COUNT]; // 各风扇测速实例(NULL表示无测速)
+    PID_TypeDef rpm_pid[FAN_COUNT]; // 各风扇转速PI，输出为对开环指令的修正(%)
+    float rpm_max;               // 100%指令对应的转速(RPM)
+    uint8_t rpm_loop;            // 1: 输出百分比按转速指令解释，经转速内环修正
+    CurrentSense_TypeDef *current; // 电流检测实例(NULL表示无)
     
     uint8_t fan_base_speed;      // 风扇基础速度(%)
     uint8_t dual_mode_ratio;     // 双风扇模式下的差速比例(%)
     
+    /* 双风扇推力分配 */
+    Alloc_TypeDef alloc;         // 最小功耗分配表与能耗统计
+    AllocMode_TypeDef alloc_mode; // 分配方式
+    
     AngleState_TypeDef state;    // 当前控制状态
     uint32_t system_time;        // 系统时间(ms)
     uint32_t last_update_time;   // 上次更新时间
+    uint32_t cycles_last;        // 上次控制计算耗时(CPU周期)
+    uint32_t cycles_max;         // 控制计算最大耗时(CPU周期)
     
-    /* 序列控制设置 */
-    AngleSequence_TypeDef sequence;
+    /* 采样时间戳(us，TIMEBASE_GetMicros) */
+    uint64_t sample_time_us;     // 本周期所用角度样本的时间戳
+    uint64_t loop_time_us;       // 本次控制计算的开始时刻
+    AngleTiming_TypeDef timing;  // 抖动统计，ANGLE_CONTROL_GetTiming读取
+    
+    /* 序列控制 */
+    SeqEngine_TypeDef sequence;  // 序列解释器
 } AngleControl_TypeDef;
 
 /* 函数声明 */
@@ -67,9 +124,12 @@ typedef struct {
   * @brief  角度控制系统初始化
   * @param  control: 角度控制结构体指针
   * @param  mode: 控制模式
+  * @param  fan: 本轴使用的风扇驱动实例(需已初始化)
+  * @param  sensor: 本轴使用的角度传感器实例(需已初始化)
   * @retval 无
   */
-void ANGLE_CONTROL_Init(AngleControl_TypeDef *control, ControlMode_TypeDef mode);
+void ANGLE_CONTROL_Init(AngleControl_TypeDef *control, ControlMode_TypeDef mode,
+                        FanDriver_TypeDef *fan, AngleSensor_TypeDef *sensor);
 
 /**
   * @brief  设置目标角度
@@ -97,6 +157,111 @@ void ANGLE_CONTROL_SetMode(AngleControl_TypeDef *control, ControlMode_TypeDef mo
   */
 void ANGLE_CONTROL_SetPID(AngleControl_TypeDef *control, float kp, float ki, float kd);
 
+/**
+  * @brief  使能/禁用角度状态估计器
+  * @param  control: 角度控制结构体指针
+  * @param  enable: 1使能，0禁用(使用平均+死区的原始测量)
+  * @retval 无
+  */
+void ANGLE_CONTROL_EnableEstimator(AngleControl_TypeDef *control, uint8_t enable);
+
+/**
+  * @brief  设置估计器噪声参数
+  * @param  control: 角度控制结构体指针
+  * @param  process_noise: 过程噪声，角加速度标准差(度/秒^2)
+  * @param  measurement_noise: 单样本测量噪声标准差(度)
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetEstimatorNoise(AngleControl_TypeDef *control, float process_noise, float measurement_noise);
+
+/**
+  * @brief  使能/禁用在线系统辨识
+  * @param  control: 角度控制结构体指针
+  * @param  enable: 使能状态 (1:使能, 0:禁用)
+  * @retval 无
+  */
+void ANGLE_CONTROL_EnableIdentification(AngleControl_TypeDef *control, uint8_t enable);
+
+/**
+  * @brief  使能/禁用高分辨率输出
+  * @param  control: 角度控制结构体指针
+  * @param  enable: 1使能，输出按推力百分比经线性化表和抖动输出；0按整数占空比输出
+  * @retval 无
+  */
+void ANGLE_CONTROL_EnableFineOutput(AngleControl_TypeDef *control, uint8_t enable);
+
+/**
+  * @brief  关联本轴风扇的测速实例
+  * @param  control: 角度控制结构体指针
+  * @param  left: 左风扇测速实例(需已初始化)，NULL表示无测速
+  * @param  right: 右风扇测速实例(需已初始化)，NULL表示无测速
+  * @retval 无
+  */
+void ANGLE_CONTROL_AttachTach(AngleControl_TypeDef *control, Tach_TypeDef *left, Tach_TypeDef *right);
+
+/**
+  * @brief  关联本轴风扇驱动的电流检测实例
+  * @param  control: 角度控制结构体指针
+  * @param  current: 电流检测实例(需已初始化)，NULL表示无
+  * @retval 无
+  */
+void ANGLE_CONTROL_AttachCurrentSense(AngleControl_TypeDef *control, CurrentSense_TypeDef *current);
+
+/**
+  * @brief  使能/禁用转速内环
+  * @param  control: 角度控制结构体指针
+  * @param  enable: 1使能，0禁用(开环占空比/推力输出)
+  * @retval 无
+  */
+void ANGLE_CONTROL_EnableRpmLoop(AngleControl_TypeDef *control, uint8_t enable);
+
+/**
+  * @brief  设置转速内环参数
+  * @param  control: 角度控制结构体指针
+  * @param  rpm_max: 100%指令对应的转速(RPM)
+  * @param  kp: 比例系数(%/RPM)
+  * @param  ki: 积分系数(%/(RPM*s))
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetRpmLoop(AngleControl_TypeDef *control, float rpm_max, float kp, float ki);
+
+/**
+  * @brief  设置双风扇推力分配方式
+  * @param  control: 角度控制结构体指针
+  * @param  mode: ALLOC_MODE_FIXED_BASE固定共模，ALLOC_MODE_MIN_POWER最小功耗
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetAllocation(AngleControl_TypeDef *control, AllocMode_TypeDef mode);
+
+/**
+  * @brief  获取本次运行的能耗统计
+  * @param  control: 角度控制结构体指针
+  * @param  energy: 输出实际分配的累计电能(J)
+  * @param  reference: 输出同样净推力按固定共模分配的累计电能(J)
+  * @retval 无
+  * @note   双风扇/序列模式下累计，切换模式时清零
+  */
+void ANGLE_CONTROL_GetEnergy(AngleControl_TypeDef *control, float *energy, float *reference);
+
+/**
+  * @brief  获取采样间隔和控制周期的抖动统计
+  * @param  control: 角度控制结构体指针
+  * @param  timing: 输出统计(us)
+  * @param  reset: 1表示读取后复位最小/最大值，开始新的统计区间
+  * @retval 无
+  * @note   在主循环中调用，关中断取快照
+  */
+void ANGLE_CONTROL_GetTiming(AngleControl_TypeDef *control, AngleTiming_TypeDef *timing, uint8_t reset);
+
+/**
+  * @brief  设置MPC预测模型参数
+  * @param  control: 角度控制结构体指针
+  * @param  gain: 差动推力到角加速度的增益(度/秒^2/%)
+  * @param  damping: 角速度阻尼系数(1/s)
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetMPCModel(AngleControl_TypeDef *control, float gain, float damping);
+
 /**
   * @brief  设置允许误差和稳定时间
   * @param  control: 角度控制结构体指针
@@ -106,6 +271,14 @@ void ANGLE_CONTROL_SetPID(AngleControl_TypeDef *control, float kp, float ki, flo
   */
 void ANGLE_CONTROL_SetStableCondition(AngleControl_TypeDef *control, float error, uint16_t time);
 
+/**
+  * @brief  设置序列模式提前认定稳定的置信度门限
+  * @param  control: 角度控制结构体指针
+  * @param  confidence: 置信度门限(0-1)，大于1表示禁用
+  * @retval 无
+  */
+void ANGLE_CONTROL_SetEarlyConfidence(AngleControl_TypeDef *control, float confidence);
+
 /**
   * @brief  角度控制主循环，在定时器中断中调用
   * @param  control: 角度控制结构体指针
@@ -113,6 +286,32 @@ void ANGLE_CONTROL_SetStableCondition(AngleControl_TypeDef *control, float error
   */
 void ANGLE_CONTROL_Process(AngleControl_TypeDef *control);
 
+/**
+  * @brief  依次处理多个控制轴
+  * @param  controls: 控制结构体数组
+  * @param  count: 轴数
+  * @retval 无
+  */
+void ANGLE_CONTROL_ProcessAll(AngleControl_TypeDef *controls, uint8_t count);
+
+/**
+  * @brief  修改控制频率
+  * @param  controls: 控制结构体数组
+  * @param  count: 轴数
+  * @param  rate_hz: 控制频率(ANGLE_CONTROL_RATE_MIN - ANGLE_CONTROL_RATE_MAX Hz)
+  * @retval uint8_t: 1成功，0频率超范围或有轴不在空闲模式
+  * @note   所有轴须处于空闲模式
+  */
+uint8_t ANGLE_CONTROL_SetLoopRate(AngleControl_TypeDef *controls, uint8_t count, uint16_t rate_hz);
+
+/**
+  * @brief  获取控制节拍
+  * @param  无
+  * @retval uint16_t: TIM3 CC4每次推进的计数(us)
+  * @note   在TIM3中断中推进比较值时调用
+  */
+uint16_t ANGLE_CONTROL_GetTickUs(void);
+
 /**
   * @brief  判断角度是否已稳定在目标位置
   * @param  control: 角度控制结构体指针
@@ -125,10 +324,36 @@ uint8_t ANGLE_CONTROL_IsStable(AngleControl_TypeDef *control);
   * @param  control: 角度控制结构体指针
   * @param  angles: 角度序列数组
   * @param  hold_times: 各角度保持时间数组(秒)
-  * @param  count: 角度数量
+  * @param  count: 角度数量(最多SEQ_RING_SIZE-1，留一步给END)
+  * @retval uint8_t: 1成功，0角度过多，当前程序不变
+  * @note   编译为序列程序(每个角度一条MOVE，使用本轴稳定判定)，替换当前程序
+  */
+uint8_t ANGLE_CONTROL_ConfigSequence(AngleControl_TypeDef *control, float *angles, uint8_t *hold_times, uint8_t count);
+
+/**
+  * @brief  清空序列程序，准备逐步追加
+  * @param  control: 角度控制结构体指针
+  * @param  stream: 1流式(执行过的步随即释放，长度不限)，0存储(最多SEQ_RING_SIZE步，可保存)
   * @retval 无
   */
-void ANGLE_CONTROL_ConfigSequence(AngleControl_TypeDef *control, float *angles, uint8_t *hold_times, uint8_t count);
+void ANGLE_CONTROL_ClearProgram(AngleControl_TypeDef *control, uint8_t stream);
+
+/**
+  * @brief  追加一步序列指令
+  * @param  control: 角度控制结构体指针
+  * @param  step: 指令
+  * @retval uint8_t: SEQ_OK/SEQ_FULL(稍后重试)/SEQ_INVALID
+  * @note   流式程序可在序列运行中追加
+  */
+uint8_t ANGLE_CONTROL_AppendStep(AngleControl_TypeDef *control, const SeqStep_TypeDef *step);
+
+/**
+  * @brief  改用内置序列程序(Flash)
+  * @param  control: 角度控制结构体指针
+  * @param  id: SEQ_PROGRAM_x
+  * @retval uint8_t: 1成功，0程序号无效
+  */
+uint8_t ANGLE_CONTROL_LoadProgram(AngleControl_TypeDef *control, uint8_t id);
 
 /**
   * @brief  开始角度序列控制
@@ -137,6 +362,14 @@ void ANGLE_CONTROL_ConfigSequence(AngleControl_TypeDef *control, float *angles,
   */
 void ANGLE_CONTROL_StartSequence(AngleControl_TypeDef *control);
 
+/**
+  * @brief  向序列输入按键(WAIT_KEY)
+  * @param  control: 角度控制结构体指针
+  * @param  key: 键值
+  * @retval 无
+  */
+void ANGLE_CONTROL_SequenceKey(AngleControl_TypeDef *control, uint8_t key);
+
 /**
   * @brief  设置风扇基础速度和比例
   * @param  control: 角度控制结构体指针
@@ -146,6 +379,24 @@ void ANGLE_CONTROL_StartSequence(AngleControl_TypeDef *control);
   */
 void ANGLE_CONTROL_SetFanParameters(AngleControl_TypeDef *control, uint8_t base_speed, uint8_t ratio);
 
+/**
+  * @brief  从参数存储加载本轴参数
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号(参数键的实例号)
+  * @retval uint8_t: 加载的参数组数，未保存的参数保持默认值
+  * @note   包括PID参数、风扇基础速度/比例、稳定判定条件、角度序列和传感器偏移
+  */
+uint8_t ANGLE_CONTROL_LoadParams(AngleControl_TypeDef *control, uint8_t axis);
+
+/**
+  * @brief  保存本轴参数到参数存储
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号(参数键的实例号)
+  * @retval ParamStatus_TypeDef: PARAM_OK，或第一个保存失败的原因(PARAM_FULL为缓存不足)
+  * @note   只更新参数存储的RAM缓存，由主循环分批写入Flash
+  */
+ParamStatus_TypeDef ANGLE_CONTROL_SaveParams(AngleControl_TypeDef *control, uint8_t axis);
+
 /**
   * @brief  停止所有控制
   * @param  control: 角度控制结构体指针
@@ -161,10 +412,10 @@ void ANGLE_CONTROL_Stop(AngleControl_TypeDef *control);
 uint32_t ANGLE_CONTROL_GetTime(void);
 
 /**
-  * @brief  SysTick中断处理函数，更新系统时间
+  * @brief  1ms时基中断处理函数，更新系统时间
   * @param  无
   * @retval 无
-  * @note   需要在stm32f10x_it.c中调用
+  * @note   需要在stm32f10x_it.c的TIM4中断中调用
   */
 void ANGLE_CONTROL_TimeUpdate(void);
 
@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @file    angle_estimator.c
+  * @brief   角度/角速度状态估计器模块实现
+  ******************************************************************************
+  */
+
+#include "angle_estimator.h"
+#include <math.h>
+#include <stddef.h>
+
+#define Q16_ONE               65536.0f
+
+/* 私有函数声明 */
+static void ANGLE_ESTIMATOR_ComputeGains(AngleEstimator_TypeDef *est);
+
+/**
+  * @brief  初始化角度估计器
+  * @param  est: 估计器结构体指针
+  * @param  process_noise: 过程噪声，角加速度标准差(度/秒^2)
+  * @param  measurement_noise: 单样本测量噪声标准差(度)
+  * @param  dt: 更新周期(秒)
+  * @param  samples_per_update: 每次更新平均的样本数(过采样率)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_Init(AngleEstimator_TypeDef *est, float process_noise, float measurement_noise,
+                          float dt, uint16_t samples_per_update)
+{
+    if (samples_per_update == 0) samples_per_update = 1;
+
+    est->dt = dt;
+    est->samples_per_update = samples_per_update;
+    est->dt_q16 = (int32_t)(dt * Q16_ONE);
+
+    ANGLE_ESTIMATOR_SetNoise(est, process_noise, measurement_noise);
+    ANGLE_ESTIMATOR_Reset(est);
+}
+
+/**
+  * @brief  修改更新周期和每次更新的样本数并重新计算增益
+  * @param  est: 估计器结构体指针
+  * @param  dt: 更新周期(秒)
+  * @param  samples_per_update: 每次更新平均的样本数(过采样率)
+  * @retval 无
+  * @note   状态同时复位，下一次测量重新初始化
+  */
+void ANGLE_ESTIMATOR_SetTiming(AngleEstimator_TypeDef *est, float dt, uint16_t samples_per_update)
+{
+    if (samples_per_update == 0) samples_per_update = 1;
+
+    est->dt = dt;
+    est->samples_per_update = samples_per_update;
+    est->dt_q16 = (int32_t)(dt * Q16_ONE);
+
+    ANGLE_ESTIMATOR_ComputeGains(est);
+    ANGLE_ESTIMATOR_Reset(est);
+}
+
+/**
+  * @brief  设置过程噪声和测量噪声并重新计算增益
+  * @param  est: 估计器结构体指针
+  * @param  process_noise: 过程噪声，角加速度标准差(度/秒^2)
+  * @param  measurement_noise: 单样本测量噪声标准差(度)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_SetNoise(AngleEstimator_TypeDef *est, float process_noise, float measurement_noise)
+{
+    /* 噪声必须为正，避免增益退化 */
+    if (process_noise < 0.001f) process_noise = 0.001f;
+    if (measurement_noise < 0.001f) measurement_noise = 0.001f;
+
+    est->process_noise = process_noise;
+    est->measurement_noise = measurement_noise;
+
+    ANGLE_ESTIMATOR_ComputeGains(est);
+}
+
+/**
+  * @brief  计算稳态卡尔曼增益
+  * @param  est: 估计器结构体指针
+  * @retval 无
+  * @note   私有函数。匀速模型的稳态解(Kalata)：
+  *         lambda = sigma_w * dt^2 / sigma_v
+  *         r = (4 + lambda - sqrt(8*lambda + lambda^2)) / 4
+  *         alpha = 1 - r^2,  beta = 2*(2 - alpha) - 4*sqrt(1 - alpha)
+  */
+static void ANGLE_ESTIMATOR_ComputeGains(AngleEstimator_TypeDef *est)
+{
+    float sigma_v;
+    float lambda;
+    float r;
+    float alpha;
+    float beta;
+
+    /* N个样本平均后的测量噪声 */
+    sigma_v = est->measurement_noise / sqrtf((float)est->samples_per_update);
+
+    lambda = est->process_noise * est->dt * est->dt / sigma_v;
+    r = (4.0f + lambda - sqrtf(8.0f * lambda + lambda * lambda)) / 4.0f;
+    alpha = 1.0f - r * r;
+    beta = 2.0f * (2.0f - alpha) - 4.0f * sqrtf(1.0f - alpha);
+
+    est->alpha_q16 = (int32_t)(alpha * Q16_ONE);
+    est->beta_dt_q16 = (int32_t)(beta / est->dt * Q16_ONE);
+}
+
+/**
+  * @brief  用一组ADC原始样本更新估计
+  * @param  est: 估计器结构体指针
+  * @param  sensor: 样本所属的角度传感器(用于换算和偏移)
+  * @param  samples: ADC原始样本
+  * @param  count: 样本数量(不超过ANGLE_ESTIMATOR_MAX_SAMPLES)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_Update(AngleEstimator_TypeDef *est, AngleSensor_TypeDef *sensor, const uint16_t *samples, uint8_t count)
+{
+    uint32_t sum = 0;
+    uint8_t i;
+
+    if (samples == NULL || count == 0) return;
+    if (count > ANGLE_ESTIMATOR_MAX_SAMPLES) count = ANGLE_ESTIMATOR_MAX_SAMPLES;
+
+    for (i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+
+    ANGLE_ESTIMATOR_UpdateQ16(est, ANGLE_SENSOR_RawToAngleQ16(sensor, sum, count));
+}
+
+/**
+  * @brief  用已换算的角度测量值更新估计
+  * @param  est: 估计器结构体指针
+  * @param  measurement_q16: 角度测量值 (Q16.16, 度)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_UpdateQ16(AngleEstimator_TypeDef *est, int32_t measurement_q16)
+{
+    int32_t predicted;
+    int32_t residual;
+
+    /* 首次测量直接初始化状态 */
+    if (!est->initialized) {
+        est->angle_q16 = measurement_q16;
+        est->rate_q16 = 0;
+        est->residual_q16 = 0;
+        est->initialized = 1;
+        return;
+    }
+
+    /* 预测 */
+    predicted = est->angle_q16 + (int32_t)(((int64_t)est->rate_q16 * est->dt_q16) >> 16);
+
+    /* 校正 */
+    residual = measurement_q16 - predicted;
+    est->angle_q16 = predicted + (int32_t)(((int64_t)est->alpha_q16 * residual) >> 16);
+    est->rate_q16 += (int32_t)(((int64_t)est->beta_dt_q16 * residual) >> 16);
+    est->residual_q16 = residual;
+}
+
+/**
+  * @brief  复位估计器，下一次测量将重新初始化状态
+  * @param  est: 估计器结构体指针
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_Reset(AngleEstimator_TypeDef *est)
+{
+    est->angle_q16 = 0;
+    est->rate_q16 = 0;
+    est->residual_q16 = 0;
+    est->initialized = 0;
+}
+
+/**
+  * @brief  获取角度估计值
+  * @param  est: 估计器结构体指针
+  * @retval float: 角度(度)
+  */
+float ANGLE_ESTIMATOR_GetAngle(AngleEstimator_TypeDef *est)
+{
+    return (float)est->angle_q16 / Q16_ONE;
+}
+
+/**
+  * @brief  获取角速度估计值
+  * @param  est: 估计器结构体指针
+  * @retval float: 角速度(度/秒)
+  */
+float ANGLE_ESTIMATOR_GetRate(AngleEstimator_TypeDef *est)
+{
+    return (float)est->rate_q16 / Q16_ONE;
+}
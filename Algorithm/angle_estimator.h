@@ -0,0 +1,118 @@
+/**
+  ******************************************************************************
+  * @file    angle_estimator.h
+  * @brief   角度/角速度状态估计器模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __ANGLE_ESTIMATOR_H
+#define __ANGLE_ESTIMATOR_H
+
+#include "stm32f10x.h"
+#include "angle_sensor.h"
+
+/* 单次更新允许的最大样本数，用于限定每次更新的运算周期 */
+#define ANGLE_ESTIMATOR_MAX_SAMPLES   32
+
+/*
+ * 估计器模型：匀速模型 + 白噪声角加速度（稳态卡尔曼滤波，即alpha-beta滤波器）
+ *   预测: angle += rate * dt
+ *   校正: angle += alpha * residual
+ *         rate  += (beta / dt) * residual
+ * 增益由过程噪声和测量噪声在配置时求出，运行时仅做定点乘加，
+ * 每次更新的运算量固定（样本累加 + 约10次32/64位整数运算）。
+ */
+
+/* 角度估计器结构体 */
+typedef struct {
+    /* 状态量 (Q16.16) */
+    int32_t angle_q16;          // 角度估计 (度)
+    int32_t rate_q16;           // 角速度估计 (度/秒)
+    int32_t residual_q16;       // 最近一次测量残差 (度)
+
+    /* 定点增益 (Q16.16) */
+    int32_t alpha_q16;          // 角度校正增益
+    int32_t beta_dt_q16;        // 角速度校正增益 (beta/dt, 1/秒)
+    int32_t dt_q16;             // 更新周期 (秒)
+
+    /* 配置参数 */
+    float process_noise;        // 过程噪声：角加速度标准差 (度/秒^2)
+    float measurement_noise;    // 测量噪声：单个ADC样本换算后的角度标准差 (度)
+    float dt;                   // 更新周期 (秒)
+    uint16_t samples_per_update; // 每次更新的样本数(决定平均后的测量噪声)
+
+    uint8_t initialized;        // 是否已用首个测量值初始化
+} AngleEstimator_TypeDef;
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化角度估计器
+  * @param  est: 估计器结构体指针
+  * @param  process_noise: 过程噪声，角加速度标准差(度/秒^2)
+  * @param  measurement_noise: 单样本测量噪声标准差(度)
+  * @param  dt: 更新周期(秒)
+  * @param  samples_per_update: 每次更新平均的样本数(过采样率)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_Init(AngleEstimator_TypeDef *est, float process_noise, float measurement_noise,
+                          float dt, uint16_t samples_per_update);
+
+/**
+  * @brief  修改更新周期和每次更新的样本数并重新计算增益
+  * @param  est: 估计器结构体指针
+  * @param  dt: 更新周期(秒)
+  * @param  samples_per_update: 每次更新平均的样本数(过采样率)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_SetTiming(AngleEstimator_TypeDef *est, float dt, uint16_t samples_per_update);
+
+/**
+  * @brief  设置过程噪声和测量噪声并重新计算增益
+  * @param  est: 估计器结构体指针
+  * @param  process_noise: 过程噪声，角加速度标准差(度/秒^2)
+  * @param  measurement_noise: 单样本测量噪声标准差(度)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_SetNoise(AngleEstimator_TypeDef *est, float process_noise, float measurement_noise);
+
+/**
+  * @brief  用一组ADC原始样本更新估计
+  * @param  est: 估计器结构体指针
+  * @param  sensor: 样本所属的角度传感器(用于换算和偏移)
+  * @param  samples: ADC原始样本
+  * @param  count: 样本数量(不超过ANGLE_ESTIMATOR_MAX_SAMPLES)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_Update(AngleEstimator_TypeDef *est, AngleSensor_TypeDef *sensor, const uint16_t *samples, uint8_t count);
+
+/**
+  * @brief  用已换算的角度测量值更新估计
+  * @param  est: 估计器结构体指针
+  * @param  measurement_q16: 角度测量值 (Q16.16, 度)
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_UpdateQ16(AngleEstimator_TypeDef *est, int32_t measurement_q16);
+
+/**
+  * @brief  复位估计器，下一次测量将重新初始化状态
+  * @param  est: 估计器结构体指针
+  * @retval 无
+  */
+void ANGLE_ESTIMATOR_Reset(AngleEstimator_TypeDef *est);
+
+/**
+  * @brief  获取角度估计值
+  * @param  est: 估计器结构体指针
+  * @retval float: 角度(度)
+  */
+float ANGLE_ESTIMATOR_GetAngle(AngleEstimator_TypeDef *est);
+
+/**
+  * @brief  获取角速度估计值
+  * @param  est: 估计器结构体指针
+  * @retval float: 角速度(度/秒)
+  */
+float ANGLE_ESTIMATOR_GetRate(AngleEstimator_TypeDef *est);
+
+#endif /* __ANGLE_ESTIMATOR_H */
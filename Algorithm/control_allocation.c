@@ -0,0 +1,197 @@
+/**
+  ******************************************************************************
+  * @file    control_allocation.c
+  * @brief   双风扇推力分配(最小功耗)模块实现
+  ******************************************************************************
+  */
+
+#include "control_allocation.h"
+#include <math.h>
+
+/* 默认功率模型：12V风扇，满速约0.8A */
+#define DEFAULT_ALLOC_MAX_POWER     9.6f     // 默认满推力电功率(W)
+#define DEFAULT_ALLOC_IDLE_POWER    0.2f     // 默认运转固定损耗(W)
+#define DEFAULT_ALLOC_MIN_THRUST    4.0f     // 默认最小稳定运转推力(%)，约对应20%占空比
+
+/* 私有函数声明 */
+static uint8_t ALLOC_IsFeasible(Alloc_TypeDef *alloc, int16_t thrust);
+static void ALLOC_ComputeTable(Alloc_TypeDef *alloc);
+
+/**
+  * @brief  初始化推力分配(默认功率模型)并计算分配表
+  * @param  alloc: 推力分配结构体指针
+  * @retval 无
+  */
+void ALLOC_Init(Alloc_TypeDef *alloc)
+{
+    alloc->max_power = DEFAULT_ALLOC_MAX_POWER;
+    alloc->idle_power = DEFAULT_ALLOC_IDLE_POWER;
+    alloc->min_thrust = DEFAULT_ALLOC_MIN_THRUST;
+    alloc->idle_thrust = 0.0f;
+
+    ALLOC_ComputeTable(alloc);
+    ALLOC_ResetEnergy(alloc);
+}
+
+/**
+  * @brief  设置风扇功率模型并重新计算分配表
+  * @param  alloc: 推力分配结构体指针
+  * @param  max_power: 满推力电功率(W)
+  * @param  idle_power: 运转时的固定损耗(W)
+  * @param  min_thrust: 最小稳定运转推力(%)
+  * @retval 无
+  */
+void ALLOC_SetModel(Alloc_TypeDef *alloc, float max_power, float idle_power, float min_thrust)
+{
+    if (max_power <= 0.0f || idle_power < 0.0f) return;
+    if (min_thrust < 0.0f) min_thrust = 0.0f;
+    if (min_thrust > 100.0f) min_thrust = 100.0f;
+
+    alloc->max_power = max_power;
+    alloc->idle_power = idle_power;
+    alloc->min_thrust = min_thrust;
+    ALLOC_ComputeTable(alloc);
+}
+
+/**
+  * @brief  设置两风扇保持的最小推力并重新计算分配表
+  * @param  alloc: 推力分配结构体指针
+  * @param  idle_thrust: 最小推力(%)，大于0时反向风扇保持低速运转以缩短响应
+  * @retval 无
+  */
+void ALLOC_SetIdleThrust(Alloc_TypeDef *alloc, float idle_thrust)
+{
+    if (idle_thrust < 0.0f) idle_thrust = 0.0f;
+    if (idle_thrust > 50.0f) idle_thrust = 50.0f;
+
+    alloc->idle_thrust = idle_thrust;
+    ALLOC_ComputeTable(alloc);
+}
+
+/**
+  * @brief  按净推力需求查表分配左右推力
+  * @param  alloc: 推力分配结构体指针
+  * @param  demand: 净推力需求 右-左(%)，范围[-100, 100]
+  * @param  left: 输出左风扇推力(%)
+  * @param  right: 输出右风扇推力(%)
+  * @retval 无
+  * @note   相邻表项间线性插值，换向附近两风扇平滑交接
+  */
+void ALLOC_Lookup(Alloc_TypeDef *alloc, float demand, float *left, float *right)
+{
+    float pos, frac;
+    uint8_t index;
+
+    if (demand > 100.0f) demand = 100.0f;
+    if (demand < -100.0f) demand = -100.0f;
+
+    pos = (demand + 100.0f) / ALLOC_TABLE_STEP;
+    index = (uint8_t)pos;
+    if (index >= ALLOC_TABLE_SIZE - 1) {
+        *left = alloc->left[ALLOC_TABLE_SIZE - 1];
+        *right = alloc->right[ALLOC_TABLE_SIZE - 1];
+        return;
+    }
+    frac = pos - index;
+
+    *left = alloc->left[index] + frac * ((float)alloc->left[index + 1] - alloc->left[index]);
+    *right = alloc->right[index] + frac * ((float)alloc->right[index + 1] - alloc->right[index]);
+}
+
+/**
+  * @brief  按功率模型计算单个风扇电功率
+  * @param  alloc: 推力分配结构体指针
+  * @param  thrust: 推力(%)
+  * @retval float: 电功率(W)
+  */
+float ALLOC_Power(Alloc_TypeDef *alloc, float thrust)
+{
+    float t;
+
+    if (thrust <= 0.0f) return 0.0f;
+
+    t = (thrust > 100.0f) ? 1.0f : thrust / 100.0f;
+    return alloc->idle_power + alloc->max_power * t * sqrtf(t);
+}
+
+/**
+  * @brief  累计一个控制周期的能耗
+  * @param  alloc: 推力分配结构体指针
+  * @param  left: 实际左风扇推力(%)
+  * @param  right: 实际右风扇推力(%)
+  * @param  ref_left: 固定共模分配的左风扇推力(%)
+  * @param  ref_right: 固定共模分配的右风扇推力(%)
+  * @param  dt: 控制周期(s)
+  * @retval 无
+  */
+void ALLOC_Accumulate(Alloc_TypeDef *alloc, float left, float right,
+                      float ref_left, float ref_right, float dt)
+{
+    alloc->energy += (ALLOC_Power(alloc, left) + ALLOC_Power(alloc, right)) * dt;
+    alloc->energy_ref += (ALLOC_Power(alloc, ref_left) + ALLOC_Power(alloc, ref_right)) * dt;
+}
+
+/**
+  * @brief  清零能耗统计
+  * @param  alloc: 推力分配结构体指针
+  * @retval 无
+  */
+void ALLOC_ResetEnergy(Alloc_TypeDef *alloc)
+{
+    alloc->energy = 0.0f;
+    alloc->energy_ref = 0.0f;
+}
+
+/**
+  * @brief  判断推力是否为可用的运行点
+  * @param  alloc: 推力分配结构体指针
+  * @param  thrust: 推力(%)
+  * @retval uint8_t: 1可用
+  * @note   私有函数
+  */
+static uint8_t ALLOC_IsFeasible(Alloc_TypeDef *alloc, int16_t thrust)
+{
+    if (thrust == 0) {
+        return (alloc->idle_thrust <= 0.0f) ? 1 : 0;
+    }
+    return (thrust >= alloc->min_thrust && thrust >= alloc->idle_thrust) ? 1 : 0;
+}
+
+/**
+  * @brief  计算分配表
+  * @param  alloc: 推力分配结构体指针
+  * @retval 无
+  * @note   私有函数。对每个净推力需求在1%推力网格上穷举左风扇推力，
+  *         右风扇推力由需求确定，取功率和最小的可行点；
+  *         无可行点(最小推力约束下满量程需求)时退化为单风扇输出
+  */
+static void ALLOC_ComputeTable(Alloc_TypeDef *alloc)
+{
+    uint8_t k;
+    int16_t demand, l, r, l_min, l_max;
+    int16_t best_l;
+    float cost, best_cost;
+
+    for (k = 0; k < ALLOC_TABLE_SIZE; k++) {
+        demand = (int16_t)(k * ALLOC_TABLE_STEP) - 100;
+        l_min = (demand < 0) ? -demand : 0;
+        l_max = (demand > 0) ? 100 - demand : 100;
+
+        best_l = -1;
+        best_cost = 0.0f;
+        for (l = l_min; l <= l_max; l++) {
+            r = l + demand;
+            if (!ALLOC_IsFeasible(alloc, l) || !ALLOC_IsFeasible(alloc, r)) continue;
+
+            cost = ALLOC_Power(alloc, l) + ALLOC_Power(alloc, r);
+            if (best_l < 0 || cost < best_cost) {
+                best_l = l;
+                best_cost = cost;
+            }
+        }
+        if (best_l < 0) best_l = l_min;
+
+        alloc->left[k] = (uint8_t)best_l;
+        alloc->right[k] = (uint8_t)(best_l + demand);
+    }
+}
@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file    control_allocation.h
+  * @brief   双风扇推力分配(最小功耗)模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __CONTROL_ALLOCATION_H
+#define __CONTROL_ALLOCATION_H
+
+#include "stm32f10x.h"
+
+/*
+ * 板子的力矩只取决于两风扇推力差 右-左，共模推力只消耗功率。
+ * 分配表以净推力需求(右-左，满推力百分比)为索引，存放在0-100%约束下
+ * 电功率之和最小的左右推力对；风扇功率模型：
+ *   P(t) = 0                                  t = 0
+ *   P(t) = idle_power + max_power * t^1.5     t >= min_thrust (t为推力比例)
+ * 推力低于min_thrust时风扇无法稳定运转，不作为候选。
+ * 表在初始化或修改模型时穷举求出，运行时只做一次线性插值。
+ */
+#define ALLOC_TABLE_SIZE         101      // 分配表点数(净推力-100%~100%，步长2%)
+#define ALLOC_TABLE_STEP         2.0f     // 分配表净推力步长(%)
+
+/* 分配方式 */
+typedef enum {
+    ALLOC_MODE_FIXED_BASE = 0,   // 固定共模：左右 = 基础速度 ∓ 差速
+    ALLOC_MODE_MIN_POWER = 1     // 查分配表：同样的净推力，功率最小
+} AllocMode_TypeDef;
+
+/* 推力分配结构体 */
+typedef struct {
+    /* 风扇功率模型 */
+    float max_power;             // 满推力电功率(W)
+    float idle_power;            // 运转时的固定损耗(W)
+    float min_thrust;            // 最小稳定运转推力(%)
+    float idle_thrust;           // 两风扇保持的最小推力(%)，0表示允许停转
+
+    /* 分配表(推力%，预计算) */
+    uint8_t left[ALLOC_TABLE_SIZE];
+    uint8_t right[ALLOC_TABLE_SIZE];
+
+    /* 能耗统计 */
+    float energy;                // 实际分配的累计电能(J)
+    float energy_ref;            // 同样净推力按固定共模分配的累计电能(J)
+} Alloc_TypeDef;
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化推力分配(默认功率模型)并计算分配表
+  * @param  alloc: 推力分配结构体指针
+  * @retval 无
+  */
+void ALLOC_Init(Alloc_TypeDef *alloc);
+
+/**
+  * @brief  设置风扇功率模型并重新计算分配表
+  * @param  alloc: 推力分配结构体指针
+  * @param  max_power: 满推力电功率(W)
+  * @param  idle_power: 运转时的固定损耗(W)
+  * @param  min_thrust: 最小稳定运转推力(%)
+  * @retval 无
+  */
+void ALLOC_SetModel(Alloc_TypeDef *alloc, float max_power, float idle_power, float min_thrust);
+
+/**
+  * @brief  设置两风扇保持的最小推力并重新计算分配表
+  * @param  alloc: 推力分配结构体指针
+  * @param  idle_thrust: 最小推力(%)，大于0时反向风扇保持低速运转以缩短响应
+  * @retval 无
+  */
+void ALLOC_SetIdleThrust(Alloc_TypeDef *alloc, float idle_thrust);
+
+/**
+  * @brief  按净推力需求查表分配左右推力
+  * @param  alloc: 推力分配结构体指针
+  * @param  demand: 净推力需求 右-左(%)，范围[-100, 100]
+  * @param  left: 输出左风扇推力(%)
+  * @param  right: 输出右风扇推力(%)
+  * @retval 无
+  */
+void ALLOC_Lookup(Alloc_TypeDef *alloc, float demand, float *left, float *right);
+
+/**
+  * @brief  按功率模型计算单个风扇电功率
+  * @param  alloc: 推力分配结构体指针
+  * @param  thrust: 推力(%)
+  * @retval float: 电功率(W)
+  */
+float ALLOC_Power(Alloc_TypeDef *alloc, float thrust);
+
+/**
+  * @brief  累计一个控制周期的能耗
+  * @param  alloc: 推力分配结构体指针
+  * @param  left: 实际左风扇推力(%)
+  * @param  right: 实际右风扇推力(%)
+  * @param  ref_left: 固定共模分配的左风扇推力(%)
+  * @param  ref_right: 固定共模分配的右风扇推力(%)
+  * @param  dt: 控制周期(s)
+  * @retval 无
+  */
+void ALLOC_Accumulate(Alloc_TypeDef *alloc, float left, float right,
+                      float ref_left, float ref_right, float dt);
+
+/**
+  * @brief  清零能耗统计
+  * @param  alloc: 推力分配结构体指针
+  * @retval 无
+  */
+void ALLOC_ResetEnergy(Alloc_TypeDef *alloc);
+
+#endif /* __CONTROL_ALLOCATION_H */
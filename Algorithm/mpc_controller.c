@@ -0,0 +1,283 @@
+/**
+  ******************************************************************************
+  * @file    mpc_controller.c
+  * @brief   双风扇模型预测控制(MPC)模块实现
+  ******************************************************************************
+  */
+
+#include "mpc_controller.h"
+
+/* 默认参数 */
+#define DEFAULT_MPC_MODEL_GAIN      20.0f    // 默认模型增益(度/秒^2/%)
+#define DEFAULT_MPC_MODEL_DAMPING   2.0f     // 默认阻尼系数(1/s)
+#define DEFAULT_MPC_Q_ANGLE         1.0f     // 默认角度误差权重
+#define DEFAULT_MPC_Q_RATE          0.01f    // 默认角速度权重
+#define DEFAULT_MPC_R_INPUT         0.05f    // 默认差动推力权重
+#define DEFAULT_MPC_R_COMMON        0.05f    // 默认共模权重
+#define DEFAULT_MPC_OBSERVER_GAIN   0.05f    // 默认扰动观测器增益
+#define DEFAULT_MPC_DIST_LIMIT      60.0f    // 默认扰动估计限幅(%)
+
+#define MPC_THRUST_MAX              100.0f   // 单个风扇推力上限(%)
+#define MPC_OBSERVER_REF_DT         0.01f    // 观测器增益的参考间隔(s)
+
+/* 私有函数声明 */
+static void MPC_ComputeGains(MPC_TypeDef *mpc);
+static void MPC_SolveBox(MPC_TypeDef *mpc, float v0, float m_ref, float *left, float *right);
+
+/**
+  * @brief  初始化MPC控制器
+  * @param  mpc: MPC结构体指针
+  * @param  dt: 控制周期(s)
+  * @param  horizon: 预测步数(1-MPC_HORIZON_MAX)
+  * @retval 无
+  */
+void MPC_Init(MPC_TypeDef *mpc, float dt, uint8_t horizon)
+{
+    if (horizon == 0) horizon = 1;
+    if (horizon > MPC_HORIZON_MAX) horizon = MPC_HORIZON_MAX;
+
+    mpc->dt = dt;
+    mpc->horizon = horizon;
+    mpc->model_gain = DEFAULT_MPC_MODEL_GAIN;
+    mpc->model_damping = DEFAULT_MPC_MODEL_DAMPING;
+    mpc->q_angle = DEFAULT_MPC_Q_ANGLE;
+    mpc->q_rate = DEFAULT_MPC_Q_RATE;
+    mpc->r_input = DEFAULT_MPC_R_INPUT;
+    mpc->r_common = DEFAULT_MPC_R_COMMON;
+    mpc->observer_gain = DEFAULT_MPC_OBSERVER_GAIN;
+    mpc->disturbance_limit = DEFAULT_MPC_DIST_LIMIT;
+
+    MPC_ComputeGains(mpc);
+    MPC_Reset(mpc);
+}
+
+/**
+  * @brief  修改控制周期和预测步数并重新计算显式解
+  * @param  mpc: MPC结构体指针
+  * @param  dt: 控制周期(s)
+  * @param  horizon: 预测步数(1-MPC_HORIZON_MAX)
+  * @retval 无
+  * @note   保留模型参数和权重，运行状态复位
+  */
+void MPC_SetTiming(MPC_TypeDef *mpc, float dt, uint8_t horizon)
+{
+    if (horizon == 0) horizon = 1;
+    if (horizon > MPC_HORIZON_MAX) horizon = MPC_HORIZON_MAX;
+
+    mpc->dt = dt;
+    mpc->horizon = horizon;
+
+    MPC_ComputeGains(mpc);
+    MPC_Reset(mpc);
+}
+
+/**
+  * @brief  设置预测模型参数并重新计算显式解
+  * @param  mpc: MPC结构体指针
+  * @param  gain: 差速输入到角加速度的增益(度/秒^2/%)
+  * @param  damping: 角速度阻尼系数(1/s)
+  * @retval 无
+  */
+void MPC_SetModel(MPC_TypeDef *mpc, float gain, float damping)
+{
+    if (gain <= 0.0f) return;
+    if (damping < 0.0f) damping = 0.0f;
+
+    mpc->model_gain = gain;
+    mpc->model_damping = damping;
+    MPC_ComputeGains(mpc);
+}
+
+/**
+  * @brief  设置代价函数权重并重新计算显式解
+  * @param  mpc: MPC结构体指针
+  * @param  q_angle: 角度误差权重
+  * @param  q_rate: 角速度权重
+  * @param  r_input: 差动推力权重
+  * @param  r_common: 共模偏离参考的权重
+  * @retval 无
+  */
+void MPC_SetWeights(MPC_TypeDef *mpc, float q_angle, float q_rate, float r_input, float r_common)
+{
+    if (q_angle < 0.0f || q_rate < 0.0f || r_input <= 0.0f || r_common < 0.0f) return;
+
+    mpc->q_angle = q_angle;
+    mpc->q_rate = q_rate;
+    mpc->r_input = r_input;
+    mpc->r_common = r_common;
+    MPC_ComputeGains(mpc);
+}
+
+/**
+  * @brief  由预测响应表求显式解系数
+  * @param  mpc: MPC结构体指针
+  * @retval 无
+  * @note   私有函数。第j步预测：
+  *           angle_j = angle_0 + a_j*rate_0 + s_j*v
+  *           rate_j  = n_j*rate_0 + w_j*v
+  *         代价中与v有关的部分为 H_v*(v - v0)^2，其中
+  *           v0 = -(gain_angle*e_0 + gain_rate*rate_0)
+  *           H_v = sum(q_angle*s_j^2 + q_rate*w_j^2) + r_input
+  *         约束边上 m = |v|/2 + c，对 H_v*(v - v0)^2 + r_common*(m - m_ref)^2
+  *         求极值得边上系数
+  */
+static void MPC_ComputeGains(MPC_TypeDef *mpc)
+{
+    float alpha = 1.0f - mpc->model_damping * mpc->dt;  // 角速度衰减
+    float beta = mpc->model_gain * mpc->dt;             // 输入增益
+    float a = 0.0f, n = 1.0f;                            // 自由响应
+    float s = 0.0f, w = 0.0f;                            // 输入响应
+    float sum_e = 0.0f, sum_r = 0.0f, denom = mpc->r_input;
+    uint8_t j;
+
+    for (j = 1; j <= mpc->horizon; j++) {
+        /* 由第j-1步递推到第j步 */
+        a += mpc->dt * n;
+        s += mpc->dt * w;
+        n *= alpha;
+        w = alpha * w + beta;
+
+        sum_e += mpc->q_angle * s;
+        sum_r += mpc->q_angle * s * a + mpc->q_rate * w * n;
+        denom += mpc->q_angle * s * s + mpc->q_rate * w * w;
+    }
+
+    mpc->gain_angle = sum_e / denom;
+    mpc->gain_rate = sum_r / denom;
+    mpc->hessian = denom;
+    mpc->edge_ratio = denom / (denom + mpc->r_common / 4.0f);
+    mpc->edge_common = (mpc->r_common / 2.0f) / (denom + mpc->r_common / 4.0f);
+}
+
+/**
+  * @brief  箱约束下的显式解
+  * @param  mpc: MPC结构体指针
+  * @param  v0: 无约束最优差动推力(%)
+  * @param  m_ref: 共模参考(%)，已限制在[0, 100]
+  * @param  left: 输出左风扇推力(%)
+  * @param  right: 输出右风扇推力(%)
+  * @retval 无
+  * @note   私有函数。按v0符号对称处理，只需考虑低侧风扇为0和高侧风扇为100两条边；
+  *         v0超过100时两条边都可能违反，取代价较小者
+  */
+static void MPC_SolveBox(MPC_TypeDef *mpc, float v0, float m_ref, float *left, float *right)
+{
+    float sign = (v0 < 0.0f) ? -1.0f : 1.0f;
+    float va = v0 * sign;
+    float v = va, m = m_ref;
+    float v_low, v_high, cost_low, cost_high;
+
+    if (m_ref < va / 2.0f || m_ref > MPC_THRUST_MAX - va / 2.0f) {
+        /* 低侧风扇为0的边：m = v/2 */
+        v_low = mpc->edge_ratio * va + mpc->edge_common * m_ref;
+        if (v_low > MPC_THRUST_MAX) v_low = MPC_THRUST_MAX;
+        if (v_low < 0.0f) v_low = 0.0f;
+        cost_low = mpc->hessian * (v_low - va) * (v_low - va)
+                 + mpc->r_common * (v_low / 2.0f - m_ref) * (v_low / 2.0f - m_ref);
+
+        /* 高侧风扇为100的边：m = 100 - v/2 */
+        v_high = mpc->edge_ratio * va + mpc->edge_common * (MPC_THRUST_MAX - m_ref);
+        if (v_high > MPC_THRUST_MAX) v_high = MPC_THRUST_MAX;
+        if (v_high < 0.0f) v_high = 0.0f;
+        cost_high = mpc->hessian * (v_high - va) * (v_high - va)
+                  + mpc->r_common * (MPC_THRUST_MAX - v_high / 2.0f - m_ref) * (MPC_THRUST_MAX - v_high / 2.0f - m_ref);
+
+        /* 只有被违反的边可能是最优的有效约束 */
+        if (m_ref >= va / 2.0f || (m_ref > MPC_THRUST_MAX - va / 2.0f && cost_high < cost_low)) {
+            v = v_high;
+            m = MPC_THRUST_MAX - v_high / 2.0f;
+        } else {
+            v = v_low;
+            m = v_low / 2.0f;
+        }
+    }
+
+    v *= sign;
+    *left = m - v / 2.0f;
+    *right = m + v / 2.0f;
+    if (*left < 0.0f) *left = 0.0f;
+    if (*right < 0.0f) *right = 0.0f;
+    if (*left > MPC_THRUST_MAX) *left = MPC_THRUST_MAX;
+    if (*right > MPC_THRUST_MAX) *right = MPC_THRUST_MAX;
+}
+
+/**
+  * @brief  计算左右风扇推力
+  * @param  mpc: MPC结构体指针
+  * @param  target: 目标角度(度)
+  * @param  angle: 当前角度(度)
+  * @param  rate: 当前角速度(度/秒)
+  * @param  rate_valid: 0表示由MPC内部对角度差分求角速度
+  * @param  dt: 与上一个样本的实际间隔(s)，用于差分和扰动观测
+  * @param  common_ref: 共模推力参考(%)
+  * @param  left: 输出左风扇推力(%)，范围[0, 100]
+  * @param  right: 输出右风扇推力(%)，范围[0, 100]
+  * @retval 无
+  * @note   只在有新样本时调用；预测增益仍按标称周期mpc->dt求出。
+  *         差动推力同时保存在mpc->output
+  */
+void MPC_Calculate(MPC_TypeDef *mpc, float target, float angle, float rate, uint8_t rate_valid,
+                   float dt, float common_ref, float *left, float *right)
+{
+    float alpha, beta;
+    float predicted_rate;
+    float v0;
+
+    /* 间隔无效(首个样本或计时异常)时按标称周期 */
+    if (dt <= 0.0f) dt = mpc->dt;
+    alpha = 1.0f - mpc->model_damping * dt;
+    if (alpha < 0.0f) alpha = 0.0f;        // 停顿后的长间隔：角速度按完全衰减
+    beta = mpc->model_gain * dt;
+
+    if (!rate_valid) {
+        rate = mpc->initialized ? (angle - mpc->last_angle) / dt : 0.0f;
+    }
+
+    /* 扰动观测：比较实测角速度与上一拍的模型预测。增益按间隔折算，
+     * 否则高控制频率下差分角速度的噪声更大、修正次数更多，扰动估计会在限幅间跳动 */
+    if (mpc->initialized) {
+        predicted_rate = alpha * mpc->last_rate + beta * (mpc->last_input + mpc->disturbance);
+        mpc->disturbance += mpc->observer_gain * (dt / MPC_OBSERVER_REF_DT) * (rate - predicted_rate) / beta;
+
+        if (mpc->disturbance > mpc->disturbance_limit) {
+            mpc->disturbance = mpc->disturbance_limit;
+        } else if (mpc->disturbance < -mpc->disturbance_limit) {
+            mpc->disturbance = -mpc->disturbance_limit;
+        }
+    }
+
+    /* 无约束最优差动推力(含扰动补偿) */
+    v0 = -(mpc->gain_angle * (angle - target) + mpc->gain_rate * rate) - mpc->disturbance;
+
+    if (common_ref < 0.0f) common_ref = 0.0f;
+    if (common_ref > MPC_THRUST_MAX) common_ref = MPC_THRUST_MAX;
+
+    /* 箱约束下的显式解 */
+    MPC_SolveBox(mpc, v0, common_ref, left, right);
+
+    /* 保存状态 */
+    mpc->last_angle = angle;
+    mpc->last_rate = rate;
+    mpc->last_input = *right - *left;
+    mpc->output = mpc->last_input;
+    mpc->output_left = *left;
+    mpc->output_right = *right;
+    mpc->initialized = 1;
+}
+
+/**
+  * @brief  复位MPC运行状态
+  * @param  mpc: MPC结构体指针
+  * @retval 无
+  */
+void MPC_Reset(MPC_TypeDef *mpc)
+{
+    mpc->disturbance = 0.0f;
+    mpc->last_angle = 0.0f;
+    mpc->last_rate = 0.0f;
+    mpc->last_input = 0.0f;
+    mpc->output = 0.0f;
+    mpc->output_left = 0.0f;
+    mpc->output_right = 0.0f;
+    mpc->initialized = 0;
+}
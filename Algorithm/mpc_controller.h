@@ -0,0 +1,135 @@
+/**
+  ******************************************************************************
+  * @file    mpc_controller.h
+  * @brief   双风扇模型预测控制(MPC)模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __MPC_CONTROLLER_H
+#define __MPC_CONTROLLER_H
+
+#include "stm32f10x.h"
+
+#define MPC_HORIZON_MAX      50      // 最大预测步数
+
+/*
+ * 决策变量为左右风扇推力 tL、tR(%，推力与占空比平方成正比，高分辨率输出时即指令)，
+ * 约束 0 <= tL, tR <= 100。记差动 v = tR - tL，共模 m = (tL + tR) / 2。
+ *
+ * 预测模型（离散，周期dt）：
+ *   angle[k+1] = angle[k] + dt * rate[k]
+ *   rate[k+1]  = (1 - damping*dt) * rate[k] + gain*dt * (v[k] + d)
+ * d为扰动(重力矩、风扇不对称等)的等效差动推力。
+ *
+ * 代价 J = sum(q_angle*e_j^2 + q_rate*rate_j^2) + r_input*v^2 + r_common*(m - m_ref)^2，
+ * m_ref为共模参考(待机推力)。采用单次移动分块(整个预测域内输入保持不变)，
+ * 代价在(v, m)坐标下可分离：H_v*(v - v0)^2 + r_common*(m - m_ref)^2，v0为线性增益律。
+ * 箱约束在(v, m)平面内为菱形 |v|/2 <= m <= 100 - |v|/2，最优解分三个区域：
+ *   内部：v = v0, m = m_ref
+ *   贴tL=0(或tR=0)边：v = edge_ratio*|v0| + edge_common*m_ref, m = |v|/2
+ *   贴tR=100(或tL=100)边：v = edge_ratio*|v0| + edge_common*(100 - m_ref), m = 100 - |v|/2
+ * 各区域的系数在初始化时由预测响应表离线求出，运行时只做区域判断和仿射运算。
+ */
+
+/* MPC控制器结构体 */
+typedef struct {
+    /* 模型参数 */
+    float dt;                  // 控制周期(s)
+    float model_gain;          // 差动推力到角加速度的增益(度/秒^2/%)
+    float model_damping;       // 角速度阻尼系数(1/s)
+
+    /* 代价函数权重 */
+    float q_angle;             // 角度误差权重
+    float q_rate;              // 角速度权重
+    float r_input;             // 差动推力权重
+    float r_common;            // 共模偏离参考的权重
+    uint8_t horizon;           // 预测步数
+
+    /* 显式解系数(预计算) */
+    float gain_angle;          // 角度误差增益
+    float gain_rate;           // 角速度增益
+    float hessian;             // 差动推力的代价二次项系数H_v
+    float edge_ratio;          // 约束边上差动推力对v0的系数
+    float edge_common;         // 约束边上差动推力对共模余量的系数
+
+    /* 扰动观测器 */
+    float disturbance;         // 扰动估计(等效差动推力%)
+    float observer_gain;       // 观测器增益(0-1，按每10ms一次修正计)
+    float disturbance_limit;   // 扰动估计限幅(%)
+
+    /* 运行状态 */
+    float last_angle;          // 上次角度
+    float last_rate;           // 上次角速度
+    float last_input;          // 上次施加的差动推力(%)
+    float output;              // 最近一次差动推力输出 右-左(%)
+    float output_left;         // 最近一次左风扇推力(%)
+    float output_right;        // 最近一次右风扇推力(%)
+    uint8_t initialized;       // 是否已有上一拍数据
+} MPC_TypeDef;
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化MPC控制器
+  * @param  mpc: MPC结构体指针
+  * @param  dt: 控制周期(s)
+  * @param  horizon: 预测步数(1-MPC_HORIZON_MAX)
+  * @retval 无
+  */
+void MPC_Init(MPC_TypeDef *mpc, float dt, uint8_t horizon);
+
+/**
+  * @brief  修改控制周期和预测步数并重新计算显式解
+  * @param  mpc: MPC结构体指针
+  * @param  dt: 控制周期(s)
+  * @param  horizon: 预测步数(1-MPC_HORIZON_MAX)
+  * @retval 无
+  */
+void MPC_SetTiming(MPC_TypeDef *mpc, float dt, uint8_t horizon);
+
+/**
+  * @brief  设置预测模型参数并重新计算显式解
+  * @param  mpc: MPC结构体指针
+  * @param  gain: 差动推力到角加速度的增益(度/秒^2/%)
+  * @param  damping: 角速度阻尼系数(1/s)
+  * @retval 无
+  */
+void MPC_SetModel(MPC_TypeDef *mpc, float gain, float damping);
+
+/**
+  * @brief  设置代价函数权重并重新计算显式解
+  * @param  mpc: MPC结构体指针
+  * @param  q_angle: 角度误差权重
+  * @param  q_rate: 角速度权重
+  * @param  r_input: 差动推力权重
+  * @param  r_common: 共模偏离参考的权重
+  * @retval 无
+  */
+void MPC_SetWeights(MPC_TypeDef *mpc, float q_angle, float q_rate, float r_input, float r_common);
+
+/**
+  * @brief  计算左右风扇推力
+  * @param  mpc: MPC结构体指针
+  * @param  target: 目标角度(度)
+  * @param  angle: 当前角度(度)
+  * @param  rate: 当前角速度(度/秒)
+  * @param  rate_valid: 0表示由MPC内部对角度差分求角速度
+  * @param  dt: 与上一个样本的实际间隔(s)，用于差分和扰动观测
+  * @param  common_ref: 共模推力参考(%)
+  * @param  left: 输出左风扇推力(%)，范围[0, 100]
+  * @param  right: 输出右风扇推力(%)，范围[0, 100]
+  * @retval 无
+  * @note   只在有新样本时调用；预测增益仍按标称周期mpc->dt求出。
+  *         差动推力同时保存在mpc->output
+  */
+void MPC_Calculate(MPC_TypeDef *mpc, float target, float angle, float rate, uint8_t rate_valid,
+                   float dt, float common_ref, float *left, float *right);
+
+/**
+  * @brief  复位MPC运行状态
+  * @param  mpc: MPC结构体指针
+  * @retval 无
+  */
+void MPC_Reset(MPC_TypeDef *mpc);
+
+#endif /* __MPC_CONTROLLER_H */
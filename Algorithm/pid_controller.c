@@ -8,6 +8,12 @@
 #include "pid_controller.h"
 #include <math.h>
 
+/* 私有函数声明 */
+static float PID_ClampDt(const PID_TypeDef *pid, float dt);
+static float PID_PositionCore(const PID_TypeDef *cfg, float Kp, float Ki, float Kd,
+                              float *integral, float *derivative, float *lastError,
+                              float nextPoint, uint8_t useRate, float rate, float dt);
+
 /**
   * @brief  初始化PID控制器
   * @param  pid: 指向PID结构体的指针
@@ -26,6 +32,7 @@ void PID_Init(PID_TypeDef *pid, float Kp, float Ki, float Kd, PIDMode_TypeDef mo
     pid->Kd = Kd;
     pid->mode = mode;
     pid->sampleTime = sampleTime;
+    pid->lastDt = sampleTime;
     
     /* 初始化PID状态 */
     pid->setPoint = 0.0f;
@@ -54,59 +61,76 @@ void PID_Init(PID_TypeDef *pid, float Kp, float Ki, float Kd, PIDMode_TypeDef mo
 }
 
 /**
-  * @brief  计算PID输出 - 位置式PID
-  * @param  pid: 指向PID结构体的指针
+  * @brief  位置式PID单步计算核心
+  * @param  cfg: 提供设定值、限幅、死区、滤波和功能开关的PID结构体
+  * @param  Kp: 比例系数
+  * @param  Ki: 积分系数
+  * @param  Kd: 微分系数
+  * @param  integral: 积分项状态
+  * @param  derivative: 微分项状态
+  * @param  lastError: 上次误差状态
   * @param  nextPoint: 当前过程值
+  * @param  useRate: 1表示微分项使用外部提供的过程值变化率
+  * @param  rate: 过程值变化率(单位/秒)，useRate为0时忽略
+  * @param  dt: 距上次计算的时间(s)，已限幅
   * @retval float: 位置式PID计算输出值
+  * @note   私有函数。增益和状态单独传入，PID_TypeDef与批量求值共用同一段运算，
+  *         两者结果逐位一致
   */
-static float PID_CalculatePosition(PID_TypeDef *pid, float nextPoint)
+static float PID_PositionCore(const PID_TypeDef *cfg, float Kp, float Ki, float Kd,
+                              float *integral, float *derivative, float *lastError,
+                              float nextPoint, uint8_t useRate, float rate, float dt)
 {
     float error, pTerm, iTerm, dTerm;
-    float output;
-    
-    /* 更新当前过程值 */
-    pid->processValue = nextPoint;
+    float output, lpf;
+    float integralPrev = *integral;
     
     /* 计算当前误差 */
-    error = pid->setPoint - nextPoint;
+    error = cfg->setPoint - nextPoint;
     
     /* 死区处理 */
-    if (fabs(error) <= pid->deadBand) {
+    if (fabs(error) <= cfg->deadBand) {
         error = 0.0f;
     }
     
     /* 计算比例项 */
-    pTerm = pid->Kp * error;
+    pTerm = Kp * error;
     
     /* 计算积分项 */
-    if (pid->enableIntegral) {
+    if (cfg->enableIntegral) {
         /* 积分分离 */
-        if (!pid->integralSeparation || fabs(error) < pid->integralSeparationThreshold) {
-            pid->integral += error * pid->sampleTime;
+        if (!cfg->integralSeparation || fabs(error) < cfg->integralSeparationThreshold) {
+            *integral += error * dt;
             
             /* 积分限幅 */
-            if (pid->integral > pid->integralMax) {
-                pid->integral = pid->integralMax;
-            } else if (pid->integral < pid->integralMin) {
-                pid->integral = pid->integralMin;
+            if (*integral > cfg->integralMax) {
+                *integral = cfg->integralMax;
+            } else if (*integral < cfg->integralMin) {
+                *integral = cfg->integralMin;
             }
         }
-        iTerm = pid->Ki * pid->integral;
+        iTerm = Ki * *integral;
     } else {
         iTerm = 0.0f;
     }
     
     /* 计算微分项 */
-    if (pid->enableDerivative) {
-        if (pid->enableLPF) {
-            /* 带低通滤波的微分项计算 */
-            pid->derivative = pid->differentiatorLPF * pid->derivative + 
-                             (1.0f - pid->differentiatorLPF) * ((error - pid->lastError) / pid->sampleTime);
+    if (cfg->enableDerivative) {
+        if (useRate) {
+            /* 使用估计的变化率：设定值不变时 d(error)/dt = -rate，已滤波无需再低通 */
+            *derivative = -rate;
+        } else if (cfg->enableLPF) {
+            /* 带低通滤波的微分项计算：滤波时间常数 tau = Ts*a/(1-a) 不随dt变化，
+               系数按 tau/(tau+dt) 换算，dt等于Ts时即为原系数 */
+            lpf = cfg->differentiatorLPF * cfg->sampleTime;
+            lpf = lpf / (lpf + (1.0f - cfg->differentiatorLPF) * dt);
+            *derivative = lpf * *derivative + 
+                          (1.0f - lpf) * ((error - *lastError) / dt);
         } else {
             /* 标准微分项计算 */
-            pid->derivative = (error - pid->lastError) / pid->sampleTime;
+            *derivative = (error - *lastError) / dt;
         }
-        dTerm = pid->Kd * pid->derivative;
+        dTerm = Kd * *derivative;
     } else {
         dTerm = 0.0f;
     }
@@ -115,36 +139,60 @@ static float PID_CalculatePosition(PID_TypeDef *pid, float nextPoint)
     output = pTerm + iTerm + dTerm;
     
     /* 输出限幅 */
-    if (output > pid->outputMax) {
-        output = pid->outputMax;
+    if (output > cfg->outputMax) {
+        output = cfg->outputMax;
         
-        /* 抗积分饱和 */
-        if (pid->enableAntiWindup && pid->enableIntegral && error > 0.0f) {
-            pid->integral -= error * pid->sampleTime;
+        /* 抗积分饱和：恢复本次累加前的积分值(已被积分限幅截断的累加不能按步长扣减) */
+        if (cfg->enableAntiWindup && cfg->enableIntegral && error > 0.0f) {
+            *integral = integralPrev;
         }
-    } else if (output < pid->outputMin) {
-        output = pid->outputMin;
+    } else if (output < cfg->outputMin) {
+        output = cfg->outputMin;
         
         /* 抗积分饱和 */
-        if (pid->enableAntiWindup && pid->enableIntegral && error < 0.0f) {
-            pid->integral -= error * pid->sampleTime;
+        if (cfg->enableAntiWindup && cfg->enableIntegral && error < 0.0f) {
+            *integral = integralPrev;
         }
     }
     
     /* 保存状态 */
-    pid->lastError = error;
-    pid->output = output;
+    *lastError = error;
     
     return output;
 }
 
+/**
+  * @brief  计算PID输出 - 位置式PID
+  * @param  pid: 指向PID结构体的指针
+  * @param  nextPoint: 当前过程值
+  * @param  useRate: 1表示微分项使用外部提供的过程值变化率
+  * @param  rate: 过程值变化率(单位/秒)，useRate为0时忽略
+  * @param  dt: 距上次计算的时间(s)，已限幅
+  * @retval float: 位置式PID计算输出值
+  */
+static float PID_CalculatePosition(PID_TypeDef *pid, float nextPoint, uint8_t useRate, float rate, float dt)
+{
+    /* 更新当前过程值 */
+    pid->processValue = nextPoint;
+    
+    pid->output = PID_PositionCore(pid, pid->Kp, pid->Ki, pid->Kd,
+                                   &pid->integral, &pid->derivative, &pid->lastError,
+                                   nextPoint, useRate, rate, dt);
+    return pid->output;
+}
+
 /**
   * @brief  计算PID输出 - 增量式PID
   * @param  pid: 指向PID结构体的指针
   * @param  nextPoint: 当前过程值
+  * @param  useRate: 1表示微分项使用外部提供的过程值变化率
+  * @param  rate: 过程值变化率(单位/秒)，useRate为0时忽略
+  * @param  dt: 距上次计算的时间(s)，已限幅
   * @retval float: 增量式PID计算输出值
+  * @note   增量式的Ki、Kd按标称采样时间Ts整定，积分增量按dt/Ts缩放，
+  *         二阶差分按两段实际间隔分别求变化率；dt等于Ts时与定周期公式相同
   */
-static float PID_CalculateIncremental(PID_TypeDef *pid, float nextPoint)
+static float PID_CalculateIncremental(PID_TypeDef *pid, float nextPoint, uint8_t useRate, float rate, float dt)
 {
     float error, deltaP, deltaI, deltaD;
     float deltaOutput;
@@ -167,7 +215,7 @@ static float PID_CalculateIncremental(PID_TypeDef *pid, float nextPoint)
     if (pid->enableIntegral) {
         /* 积分分离 */
         if (!pid->integralSeparation || fabs(error) < pid->integralSeparationThreshold) {
-            deltaI = pid->Ki * error;
+            deltaI = pid->Ki * error * (dt / pid->sampleTime);
         } else {
             deltaI = 0.0f;
         }
@@ -177,12 +225,18 @@ static float PID_CalculateIncremental(PID_TypeDef *pid, float nextPoint)
     
     /* 计算微分项增量 */
     if (pid->enableDerivative) {
-        if (pid->enableLPF) {
+        if (useRate) {
+            /* 误差二阶差分 = Ts * (本次误差变化率 - 上次误差变化率) */
+            deltaD = pid->Kd * pid->sampleTime * (-rate - pid->derivative);
+            pid->derivative = -rate;
+        } else if (pid->enableLPF) {
             /* 带低通滤波的微分项计算 */
-            deltaD = pid->Kd * pid->differentiatorLPF * (error - 2 * pid->lastError + pid->prevError);
+            deltaD = pid->Kd * pid->differentiatorLPF * pid->sampleTime *
+                     ((error - pid->lastError) / dt - (pid->lastError - pid->prevError) / pid->lastDt);
         } else {
             /* 标准微分项计算 */
-            deltaD = pid->Kd * (error - 2 * pid->lastError + pid->prevError);
+            deltaD = pid->Kd * pid->sampleTime *
+                     ((error - pid->lastError) / dt - (pid->lastError - pid->prevError) / pid->lastDt);
         }
     } else {
         deltaD = 0.0f;
@@ -204,6 +258,7 @@ static float PID_CalculateIncremental(PID_TypeDef *pid, float nextPoint)
     /* 保存状态 */
     pid->prevError = pid->lastError;
     pid->lastError = error;
+    pid->lastDt = dt;
     
     return pid->output;
 }
@@ -216,13 +271,93 @@ static float PID_CalculateIncremental(PID_TypeDef *pid, float nextPoint)
   */
 float PID_Calculate(PID_TypeDef *pid, float nextPoint)
 {
+    return PID_CalculateDt(pid, nextPoint, pid->sampleTime);
+}
+
+/**
+  * @brief  按实际间隔计算PID输出
+  * @param  pid: 指向PID结构体的指针
+  * @param  nextPoint: 当前过程值
+  * @param  dt: 距上次计算的实际时间(s)，限幅到[Ts/PID_DT_CLAMP_RATIO, Ts*PID_DT_CLAMP_RATIO]
+  * @retval float: PID计算输出值
+  * @note   积分按dt累加，微分按dt求差商，控制周期变化时无需重新整定
+  */
+float PID_CalculateDt(PID_TypeDef *pid, float nextPoint, float dt)
+{
+    dt = PID_ClampDt(pid, dt);
+    if (pid->mode == PID_MODE_POSITION) {
+        return PID_CalculatePosition(pid, nextPoint, 0, 0.0f, dt);
+    } else {
+        return PID_CalculateIncremental(pid, nextPoint, 0, 0.0f, dt);
+    }
+}
+
+/**
+  * @brief  计算PID输出，微分项使用外部估计的变化率
+  * @param  pid: 指向PID结构体的指针
+  * @param  nextPoint: 当前过程值
+  * @param  rate: 过程值变化率(单位/秒)，如状态估计器给出的角速度
+  * @retval float: PID计算输出值
+  * @note   替代误差有限差分，避免对量化后的测量值求导
+  */
+float PID_CalculateWithRate(PID_TypeDef *pid, float nextPoint, float rate)
+{
+    return PID_CalculateWithRateDt(pid, nextPoint, rate, pid->sampleTime);
+}
+
+/**
+  * @brief  按实际间隔计算PID输出，微分项使用外部估计的变化率
+  * @param  pid: 指向PID结构体的指针
+  * @param  nextPoint: 当前过程值
+  * @param  rate: 过程值变化率(单位/秒)
+  * @param  dt: 距上次计算的实际时间(s)，限幅同PID_CalculateDt
+  * @retval float: PID计算输出值
+  */
+float PID_CalculateWithRateDt(PID_TypeDef *pid, float nextPoint, float rate, float dt)
+{
+    dt = PID_ClampDt(pid, dt);
     if (pid->mode == PID_MODE_POSITION) {
-        return PID_CalculatePosition(pid, nextPoint);
+        return PID_CalculatePosition(pid, nextPoint, 1, rate, dt);
     } else {
-        return PID_CalculateIncremental(pid, nextPoint);
+        return PID_CalculateIncremental(pid, nextPoint, 1, rate, dt);
     }
 }
 
+/**
+  * @brief  设置标称采样时间
+  * @param  pid: 指向PID结构体的指针
+  * @param  sampleTime: 标称采样时间，单位秒
+  * @retval 无
+  * @note   位置式的增益以秒为单位，修改控制频率后无需重新整定；
+  *         标称值决定dt限幅范围和微分滤波时间常数
+  */
+void PID_SetSampleTime(PID_TypeDef *pid, float sampleTime)
+{
+    if (sampleTime <= 0.0f) return;
+    
+    pid->sampleTime = sampleTime;
+    pid->lastDt = sampleTime;
+}
+
+/**
+  * @brief  限制实际间隔
+  * @param  pid: 指向PID结构体的指针
+  * @param  dt: 实际间隔(s)
+  * @retval float: 限幅后的间隔(s)
+  * @note   私有函数。dt非正(时钟未就绪或重复调用)按标称值处理；
+  *         过长的间隔(调试暂停、长时间关中断)不让积分一次跳变，过短的间隔不放大微分噪声
+  */
+static float PID_ClampDt(const PID_TypeDef *pid, float dt)
+{
+    float dt_min = pid->sampleTime / PID_DT_CLAMP_RATIO;
+    float dt_max = pid->sampleTime * PID_DT_CLAMP_RATIO;
+    
+    if (!(dt > 0.0f)) return pid->sampleTime;
+    if (dt < dt_min) return dt_min;
+    if (dt > dt_max) return dt_max;
+    return dt;
+}
+
 /**
   * @brief  设置PID目标值
   * @param  pid: 指向PID结构体的指针
@@ -326,6 +461,7 @@ void PID_Reset(PID_TypeDef *pid)
     pid->integral = 0.0f;
     pid->derivative = 0.0f;
     pid->output = 0.0f;
+    pid->lastDt = pid->sampleTime;
 }
 
 /**
@@ -384,3 +520,142 @@ float PID_GetError(PID_TypeDef *pid)
 {
     return pid->setPoint - pid->processValue;
 }
+
+#ifdef PID_BATCH
+/**
+  * @brief  初始化PID批量求值
+  * @param  batch: 批量结构体指针
+  * @param  proto: 提供共享配置和初始增益的PID结构体
+  * @param  count: 候选组数
+  * @param  storage: 至少PID_BATCH_FLOATS(count)个float的存储区
+  * @retval uint8_t: 1成功，0原型不是位置式
+  */
+uint8_t PID_BatchInit(PIDBatch_TypeDef *batch, const PID_TypeDef *proto, uint32_t count, float *storage)
+{
+    uint32_t i;
+    
+    if (proto->mode != PID_MODE_POSITION) return 0;
+    
+    batch->config = *proto;
+    batch->count = count;
+    batch->Kp = storage;
+    batch->Ki = storage + count;
+    batch->Kd = storage + 2 * count;
+    batch->integral = storage + 3 * count;
+    batch->derivative = storage + 4 * count;
+    batch->lastError = storage + 5 * count;
+    batch->output = storage + 6 * count;
+    
+    for (i = 0; i < count; i++) {
+        batch->Kp[i] = proto->Kp;
+        batch->Ki[i] = proto->Ki;
+        batch->Kd[i] = proto->Kd;
+    }
+    PID_BatchReset(batch);
+    return 1;
+}
+
+/**
+  * @brief  取批量结构体的一段区间
+  * @param  batch: 批量结构体指针
+  * @param  first: 区间起始组号
+  * @param  count: 区间组数
+  * @param  slice: 输出区间结构体，与batch共用存储
+  * @retval 无
+  */
+void PID_BatchSlice(const PIDBatch_TypeDef *batch, uint32_t first, uint32_t count, PIDBatch_TypeDef *slice)
+{
+    if (first > batch->count) first = batch->count;
+    if (count > batch->count - first) count = batch->count - first;
+    
+    slice->config = batch->config;
+    slice->count = count;
+    slice->Kp = batch->Kp + first;
+    slice->Ki = batch->Ki + first;
+    slice->Kd = batch->Kd + first;
+    slice->integral = batch->integral + first;
+    slice->derivative = batch->derivative + first;
+    slice->lastError = batch->lastError + first;
+    slice->output = batch->output + first;
+}
+
+/**
+  * @brief  设置一组候选的增益
+  * @param  batch: 批量结构体指针
+  * @param  index: 组号
+  * @param  Kp: 比例系数
+  * @param  Ki: 积分系数
+  * @param  Kd: 微分系数
+  * @retval 无
+  */
+void PID_BatchTune(PIDBatch_TypeDef *batch, uint32_t index, float Kp, float Ki, float Kd)
+{
+    if (index >= batch->count) return;
+    
+    batch->Kp[index] = Kp;
+    batch->Ki[index] = Ki;
+    batch->Kd[index] = Kd;
+}
+
+/**
+  * @brief  清零全部候选的状态
+  * @param  batch: 批量结构体指针
+  * @retval 无
+  * @note   与PID_Reset相同
+  */
+void PID_BatchReset(PIDBatch_TypeDef *batch)
+{
+    uint32_t i;
+    
+    for (i = 0; i < batch->count; i++) {
+        batch->integral[i] = 0.0f;
+        batch->derivative[i] = 0.0f;
+        batch->lastError[i] = 0.0f;
+        batch->output[i] = 0.0f;
+    }
+    batch->config.lastDt = batch->config.sampleTime;
+}
+
+/**
+  * @brief  按实际间隔计算全部候选的输出
+  * @param  batch: 批量结构体指针
+  * @param  nextPoint: 每组的当前过程值，count个
+  * @param  dt: 距上次计算的时间(s)，限幅同PID_CalculateDt
+  * @retval 无
+  * @note   各组数据连续存放，核心在本文件内可被内联，便于编译器展开和向量化
+  */
+void PID_BatchCalculate(PIDBatch_TypeDef *batch, const float *nextPoint, float dt)
+{
+    const PID_TypeDef *cfg = &batch->config;
+    uint32_t i;
+    
+    dt = PID_ClampDt(cfg, dt);
+    for (i = 0; i < batch->count; i++) {
+        batch->output[i] = PID_PositionCore(cfg, batch->Kp[i], batch->Ki[i], batch->Kd[i],
+                                            &batch->integral[i], &batch->derivative[i],
+                                            &batch->lastError[i], nextPoint[i], 0, 0.0f, dt);
+    }
+}
+
+/**
+  * @brief  导出一组候选为PID结构体
+  * @param  batch: 批量结构体指针
+  * @param  index: 组号
+  * @param  pid: 输出PID结构体，含增益和当前状态
+  * @retval 无
+  * @note   导出后可接着用PID_CalculateDt计算，与批量求值结果相同
+  */
+void PID_BatchExtract(const PIDBatch_TypeDef *batch, uint32_t index, PID_TypeDef *pid)
+{
+    *pid = batch->config;
+    if (index >= batch->count) return;
+    
+    pid->Kp = batch->Kp[index];
+    pid->Ki = batch->Ki[index];
+    pid->Kd = batch->Kd[index];
+    pid->integral = batch->integral[index];
+    pid->derivative = batch->derivative[index];
+    pid->lastError = batch->lastError[index];
+    pid->output = batch->output[index];
+}
+#endif
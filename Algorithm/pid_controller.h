@@ -8,7 +8,14 @@
 #ifndef __PID_CONTROLLER_H
 #define __PID_CONTROLLER_H
 
+#ifdef PID_BATCH
+#include <stdint.h>
+#else
 #include "stm32f10x.h"
+#endif
+
+/* 实际间隔限幅：dt限制在标称采样时间的[1/PID_DT_CLAMP_RATIO, PID_DT_CLAMP_RATIO]倍 */
+#define PID_DT_CLAMP_RATIO    4.0f
 
 /* PID控制器模式枚举 */
 typedef enum {
@@ -34,7 +41,8 @@ typedef struct {
     
     /* 配置参数 */
     PIDMode_TypeDef mode;    // PID模式
-    float sampleTime;        // 采样时间(s)
+    float sampleTime;        // 标称采样时间(s)
+    float lastDt;            // 上次计算的实际间隔(s)
     float outputMax;         // 输出上限
     float outputMin;         // 输出下限
     float integralMax;       // 积分限幅值
@@ -72,6 +80,42 @@ void PID_Init(PID_TypeDef *pid, float Kp, float Ki, float Kd, PIDMode_TypeDef mo
   */
 float PID_Calculate(PID_TypeDef *pid, float nextPoint);
 
+/**
+  * @brief  计算PID输出，微分项使用外部估计的变化率
+  * @param  pid: 指向PID结构体的指针
+  * @param  nextPoint: 当前过程值
+  * @param  rate: 过程值变化率(单位/秒)
+  * @retval float: PID计算输出值
+  */
+float PID_CalculateWithRate(PID_TypeDef *pid, float nextPoint, float rate);
+
+/**
+  * @brief  按实际间隔计算PID输出
+  * @param  pid: 指向PID结构体的指针
+  * @param  nextPoint: 当前过程值
+  * @param  dt: 距上次计算的实际时间(s)，限幅到标称值的[1/PID_DT_CLAMP_RATIO, PID_DT_CLAMP_RATIO]倍
+  * @retval float: PID计算输出值
+  */
+float PID_CalculateDt(PID_TypeDef *pid, float nextPoint, float dt);
+
+/**
+  * @brief  按实际间隔计算PID输出，微分项使用外部估计的变化率
+  * @param  pid: 指向PID结构体的指针
+  * @param  nextPoint: 当前过程值
+  * @param  rate: 过程值变化率(单位/秒)
+  * @param  dt: 距上次计算的实际时间(s)
+  * @retval float: PID计算输出值
+  */
+float PID_CalculateWithRateDt(PID_TypeDef *pid, float nextPoint, float rate, float dt);
+
+/**
+  * @brief  设置标称采样时间
+  * @param  pid: 指向PID结构体的指针
+  * @param  sampleTime: 标称采样时间，单位秒
+  * @retval 无
+  */
+void PID_SetSampleTime(PID_TypeDef *pid, float sampleTime);
+
 /**
   * @brief  设置PID目标值
   * @param  pid: 指向PID结构体的指针
@@ -161,4 +205,89 @@ void PID_EnableDerivative(PID_TypeDef *pid, uint8_t enable);
   */
 float PID_GetError(PID_TypeDef *pid);
 
+#ifdef PID_BATCH
+/*
+ * 批量求值(主机调参工具)：同一配置下的多组增益与状态按结构数组存放，
+ * 每组调用与PID_TypeDef相同的位置式计算核心，结果与固件逐位一致。
+ * 主机编译须使用-ffp-contract=off且不得使用-ffast-math，否则乘加合并会改变舍入。
+ * 数组由调用者提供，按区间切分后可由多个线程并行求值。
+ */
+#define PID_BATCH_FLOATS(count)  (7 * (count))  // 批量存储所需的float个数
+
+/* PID批量求值结构体 */
+typedef struct {
+    PID_TypeDef config;      // 共享配置：设定值、采样时间、限幅、死区、滤波和功能开关
+    uint32_t count;          // 候选组数
+    
+    /* 每组增益 */
+    float *Kp;
+    float *Ki;
+    float *Kd;
+    
+    /* 每组状态 */
+    float *integral;
+    float *derivative;
+    float *lastError;
+    float *output;
+} PIDBatch_TypeDef;
+
+/**
+  * @brief  初始化PID批量求值
+  * @param  batch: 批量结构体指针
+  * @param  proto: 提供共享配置和初始增益的PID结构体
+  * @param  count: 候选组数
+  * @param  storage: 至少PID_BATCH_FLOATS(count)个float的存储区
+  * @retval uint8_t: 1成功，0原型不是位置式
+  * @note   只支持位置式；各组增益初始为原型增益，状态清零
+  */
+uint8_t PID_BatchInit(PIDBatch_TypeDef *batch, const PID_TypeDef *proto, uint32_t count, float *storage);
+
+/**
+  * @brief  取批量结构体的一段区间
+  * @param  batch: 批量结构体指针
+  * @param  first: 区间起始组号
+  * @param  count: 区间组数
+  * @param  slice: 输出区间结构体，与batch共用存储
+  * @retval 无
+  */
+void PID_BatchSlice(const PIDBatch_TypeDef *batch, uint32_t first, uint32_t count, PIDBatch_TypeDef *slice);
+
+/**
+  * @brief  设置一组候选的增益
+  * @param  batch: 批量结构体指针
+  * @param  index: 组号
+  * @param  Kp: 比例系数
+  * @param  Ki: 积分系数
+  * @param  Kd: 微分系数
+  * @retval 无
+  */
+void PID_BatchTune(PIDBatch_TypeDef *batch, uint32_t index, float Kp, float Ki, float Kd);
+
+/**
+  * @brief  清零全部候选的状态
+  * @param  batch: 批量结构体指针
+  * @retval 无
+  */
+void PID_BatchReset(PIDBatch_TypeDef *batch);
+
+/**
+  * @brief  按实际间隔计算全部候选的输出
+  * @param  batch: 批量结构体指针
+  * @param  nextPoint: 每组的当前过程值，count个
+  * @param  dt: 距上次计算的时间(s)，限幅同PID_CalculateDt
+  * @retval 无
+  * @note   输出写入batch->output
+  */
+void PID_BatchCalculate(PIDBatch_TypeDef *batch, const float *nextPoint, float dt);
+
+/**
+  * @brief  导出一组候选为PID结构体
+  * @param  batch: 批量结构体指针
+  * @param  index: 组号
+  * @param  pid: 输出PID结构体，含增益和当前状态
+  * @retval 无
+  */
+void PID_BatchExtract(const PIDBatch_TypeDef *batch, uint32_t index, PID_TypeDef *pid);
+#endif
+
 #endif /* __PID_CONTROLLER_H */
@@ -0,0 +1,377 @@
+/**
+  ******************************************************************************
+  * @file    recorder.c
+  * @brief   控制环输入记录模块实现
+  ******************************************************************************
+  */
+
+#include "recorder.h"
+#include <stdio.h>
+#include <string.h>
+
+/* 每轴本周期的输入和输出，周期末写成记录 */
+typedef struct {
+    uint8_t faults;              // 传感器故障标志
+    uint8_t read;                // 读数方式(RECORDER_READ_x)
+    uint32_t angle;              // 角度读数原始位
+    uint32_t timestamp;          // 样本时间戳低32位
+    uint8_t rpm_flags;           // RECORDER_RPM_x，右风扇左移3位
+    uint32_t rpm[FAN_COUNT];     // 转速(float位)
+    uint8_t output;              // 1: 本周期输出了风扇指令
+    uint8_t fine;                // 高分辨率输出
+    uint16_t left, right;        // 风扇指令(推力或整数占空比)
+} RecorderAxis_TypeDef;
+
+/* 私有变量 */
+static AngleControl_TypeDef *g_rec_controls = NULL;        // 轴号基准
+static uint8_t g_rec_count = 0;                            // 轴数
+static RecorderAxis_TypeDef g_rec_axes[ANGLE_CONTROL_AXIS_COUNT];
+static RecorderRecord_TypeDef g_rec_ring[RECORDER_RING_SIZE];
+static volatile uint16_t g_rec_head = 0;                   // 写位置
+static volatile uint16_t g_rec_tail = 0;                   // 读位置
+static volatile uint8_t g_rec_active = 0;                  // 正在记录
+static volatile uint8_t g_rec_tick = 0;                    // 控制中断正在处理某轴
+static volatile uint8_t g_rec_nest = 0;                    // 嵌套接口深度
+static uint8_t g_rec_seq = 0;                              // 记录序号
+static uint32_t g_rec_dropped = 0;                         // 待报告的丢弃记录数
+static uint8_t g_rec_from_reset = 1;                       // 还没有任何轴运行过控制周期
+
+/* 私有函数声明 */
+static int8_t RECORDER_Axis(AngleControl_TypeDef *control);
+static void RECORDER_Push(uint8_t type, uint8_t axis, uint16_t arg, uint32_t a, uint32_t b, uint32_t c);
+
+/**
+  * @brief  初始化记录模块
+  * @param  controls: 角度控制结构体数组，数组下标即轴号
+  * @param  count: 轴数
+  * @retval 无
+  * @note   在ANGLE_CONTROL_Init之前调用；RECORDER_AUTOSTART为1时立即开始上电记录
+  */
+void RECORDER_Init(AngleControl_TypeDef *controls, uint8_t count)
+{
+    if (count > ANGLE_CONTROL_AXIS_COUNT) count = ANGLE_CONTROL_AXIS_COUNT;
+    g_rec_controls = controls;
+    g_rec_count = count;
+    g_rec_active = 0;
+    g_rec_head = 0;
+    g_rec_tail = 0;
+    g_rec_dropped = 0;
+    g_rec_from_reset = 1;
+
+#if RECORDER_AUTOSTART
+    RECORDER_Start();
+#endif
+}
+
+/**
+  * @brief  开始记录
+  * @param  无
+  * @retval 无
+  * @note   写START记录；控制中断已运行过时标记为非上电记录
+  */
+void RECORDER_Start(void)
+{
+    if (g_rec_controls == NULL || g_rec_active) return;
+
+    memset(g_rec_axes, 0, sizeof(g_rec_axes));
+    g_rec_active = 1;
+    RECORDER_Push(RECORDER_REC_START, 0, RECORDER_FORMAT, ANGLE_CONTROL_GetTickUs(),
+                  (uint32_t)ANGLE_SENSOR_GetOversampling() |
+                  ((uint32_t)g_rec_count << 16) | ((uint32_t)g_rec_from_reset << 24),
+                  ANGLE_CONTROL_GetTime());
+    printf("Recorder started (%s)\r\n", g_rec_from_reset ? "from reset" : "mid-run, not replayable");
+}
+
+/**
+  * @brief  停止记录，已缓冲的记录继续输出
+  * @param  无
+  * @retval 无
+  */
+void RECORDER_Stop(void)
+{
+    g_rec_active = 0;
+}
+
+/**
+  * @brief  查询是否在记录
+  * @param  无
+  * @retval uint8_t: 1正在记录
+  */
+uint8_t RECORDER_IsActive(void)
+{
+    return g_rec_active;
+}
+
+/**
+  * @brief  输出缓冲的记录
+  * @param  无
+  * @retval 无
+  * @note   在主循环中调用，每次最多输出RECORDER_BURST条
+  */
+void RECORDER_Process(void)
+{
+    RecorderRecord_TypeDef rec;
+    uint8_t n;
+
+    for (n = 0; n < RECORDER_BURST; n++) {
+        if (g_rec_tail == g_rec_head) return;
+        rec = g_rec_ring[g_rec_tail];
+        g_rec_tail = (g_rec_tail + 1) & (RECORDER_RING_SIZE - 1);
+
+        printf("$REC,%02X%02X%04X%08lX%08lX%08lX\r\n", rec.type_axis, rec.seq, rec.arg,
+               (unsigned long)rec.a, (unsigned long)rec.b, (unsigned long)rec.c);
+    }
+}
+
+/**
+  * @brief  记录按键
+  * @param  key: 键值
+  * @retval 无
+  */
+void RECORDER_Key(uint8_t key)
+{
+    if (!g_rec_active) return;
+    RECORDER_Push(RECORDER_REC_KEY, 0, key, ANGLE_CONTROL_GetTime(), 0, 0);
+}
+
+/**
+  * @brief  记录接口调用
+  * @param  control: 被调用的控制轴
+  * @param  cmd: 命令号(RECORDER_CMD_x)
+  * @param  a: 参数
+  * @param  b: 参数
+  * @param  c: 参数
+  * @retval 无
+  * @note   控制中断内(故障停机、序列结束)和其他接口内部的调用标记为嵌套
+  */
+void RECORDER_Command(AngleControl_TypeDef *control, uint16_t cmd, uint32_t a, uint32_t b, uint32_t c)
+{
+    int8_t axis;
+
+    if (!g_rec_active) return;
+    axis = RECORDER_Axis(control);
+    if (axis < 0) return;
+
+    if (g_rec_tick || g_rec_nest) {
+        cmd |= RECORDER_CMD_NESTED;
+    }
+    RECORDER_Push(RECORDER_REC_CMD, (uint8_t)axis, cmd, a, b, c);
+}
+
+/**
+  * @brief  取float的原始位
+  * @param  value: 浮点数
+  * @retval uint32_t: IEEE754单精度位
+  */
+uint32_t RECORDER_Float(float value)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+  * @brief  标记进入会调用其他接口的接口
+  * @param  无
+  * @retval 无
+  */
+void RECORDER_NestBegin(void)
+{
+    g_rec_nest++;
+}
+
+/**
+  * @brief  标记离开会调用其他接口的接口
+  * @param  无
+  * @retval 无
+  */
+void RECORDER_NestEnd(void)
+{
+    if (g_rec_nest > 0) g_rec_nest--;
+}
+
+/**
+  * @brief  控制周期开始
+  * @param  control: 角度控制结构体指针
+  * @retval 无
+  */
+void RECORDER_TickBegin(AngleControl_TypeDef *control)
+{
+    int8_t axis;
+
+    g_rec_from_reset = 0;
+    if (!g_rec_active) return;
+    axis = RECORDER_Axis(control);
+    if (axis < 0) return;
+
+    memset(&g_rec_axes[axis], 0, sizeof(RecorderAxis_TypeDef));
+    g_rec_tick = 1;
+}
+
+/**
+  * @brief  记录传感器故障标志
+  * @param  control: 角度控制结构体指针
+  * @param  faults: ANGLE_SENSOR_GetFault的返回值
+  * @retval 无
+  */
+void RECORDER_Fault(AngleControl_TypeDef *control, uint8_t faults)
+{
+    int8_t axis = RECORDER_Axis(control);
+
+    if (!g_rec_active || axis < 0) return;
+    g_rec_axes[axis].faults = faults;
+}
+
+/**
+  * @brief  记录角度读数
+  * @param  control: 角度控制结构体指针
+  * @param  read: 读数方式(RECORDER_READ_x)
+  * @param  value: 读数原始位(float或Q16.16)
+  * @param  timestamp: 读数后的样本时间戳(us)
+  * @retval 无
+  */
+void RECORDER_Angle(AngleControl_TypeDef *control, uint8_t read, uint32_t value, uint64_t timestamp)
+{
+    int8_t axis = RECORDER_Axis(control);
+
+    if (!g_rec_active || axis < 0) return;
+    g_rec_axes[axis].read = read;
+    g_rec_axes[axis].angle = value;
+    g_rec_axes[axis].timestamp = (uint32_t)timestamp;
+}
+
+/**
+  * @brief  记录测速读数
+  * @param  control: 角度控制结构体指针
+  * @param  fan: 风扇选择
+  * @param  stalled: TACH_IsStalled的返回值
+  * @param  read: 1表示读取了转速
+  * @param  rpm: TACH_GetRpm的返回值
+  * @retval 无
+  */
+void RECORDER_Rpm(AngleControl_TypeDef *control, FanSelect_TypeDef fan, uint8_t stalled,
+                  uint8_t read, float rpm)
+{
+    int8_t axis = RECORDER_Axis(control);
+    uint8_t flags = RECORDER_RPM_QUERIED;
+
+    if (!g_rec_active || axis < 0) return;
+    if (stalled) flags |= RECORDER_RPM_STALLED;
+    if (read) {
+        flags |= RECORDER_RPM_READ;
+        g_rec_axes[axis].rpm[fan] = RECORDER_Float(rpm);
+    }
+    g_rec_axes[axis].rpm_flags |= flags << (3 * fan);
+}
+
+/**
+  * @brief  记录风扇指令
+  * @param  control: 角度控制结构体指针
+  * @param  fine: 1为推力(0-FAN_THRUST_MAX)，0为整数占空比
+  * @param  left: 左风扇指令
+  * @param  right: 右风扇指令
+  * @retval 无
+  */
+void RECORDER_Output(AngleControl_TypeDef *control, uint8_t fine, uint16_t left, uint16_t right)
+{
+    int8_t axis = RECORDER_Axis(control);
+
+    if (!g_rec_active || axis < 0) return;
+    g_rec_axes[axis].output = 1;
+    g_rec_axes[axis].fine = fine;
+    g_rec_axes[axis].left = left;
+    g_rec_axes[axis].right = right;
+}
+
+/**
+  * @brief  控制周期结束，写入本周期记录
+  * @param  control: 角度控制结构体指针
+  * @retval 无
+  */
+void RECORDER_TickEnd(AngleControl_TypeDef *control)
+{
+    int8_t axis;
+    RecorderAxis_TypeDef *ax;
+
+    g_rec_tick = 0;
+    if (!g_rec_active) return;
+    axis = RECORDER_Axis(control);
+    if (axis < 0) return;
+    ax = &g_rec_axes[axis];
+
+    RECORDER_Push(RECORDER_REC_TICK, (uint8_t)axis, (uint16_t)(ax->faults | (ax->read << 8)),
+                  control->system_time, ax->angle, ax->timestamp);
+    if (ax->rpm_flags) {
+        RECORDER_Push(RECORDER_REC_RPM, (uint8_t)axis, ax->rpm_flags, ax->rpm[FAN_LEFT], ax->rpm[FAN_RIGHT], 0);
+    }
+    RECORDER_Push(RECORDER_REC_OUT, (uint8_t)axis,
+                  (uint16_t)((control->state & 0x0F) | ((control->mode & 0x0F) << 4) |
+                             (ax->fine << 8) | (ax->output << 9)),
+                  (uint32_t)ax->left | ((uint32_t)ax->right << 16),
+                  RECORDER_Float(control->applied_input), RECORDER_Float(control->current_angle));
+}
+
+/**
+  * @brief  由控制结构体求轴号
+  * @param  control: 角度控制结构体指针
+  * @retval int8_t: 轴号，不属于记录的数组时为-1
+  * @note   私有函数
+  */
+static int8_t RECORDER_Axis(AngleControl_TypeDef *control)
+{
+    if (g_rec_controls == NULL || control < g_rec_controls || control >= g_rec_controls + g_rec_count) {
+        return -1;
+    }
+    return (int8_t)(control - g_rec_controls);
+}
+
+/**
+  * @brief  写入一条记录
+  * @param  type: 记录类型
+  * @param  axis: 轴号
+  * @param  arg: 参数
+  * @param  a: 数据
+  * @param  b: 数据
+  * @param  c: 数据
+  * @retval 无
+  * @note   私有函数。控制中断和主循环都会写入，关中断完成；
+  *         缓冲满时丢弃并计数，之后第一条记录前补一条GAP
+  */
+static void RECORDER_Push(uint8_t type, uint8_t axis, uint16_t arg, uint32_t a, uint32_t b, uint32_t c)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint16_t free;
+    RecorderRecord_TypeDef *rec;
+
+    __disable_irq();
+
+    free = (g_rec_tail - g_rec_head - 1) & (RECORDER_RING_SIZE - 1);
+    if (free < ((g_rec_dropped > 0) ? 2 : 1)) {
+        g_rec_dropped++;
+    } else {
+        if (g_rec_dropped > 0) {
+            rec = &g_rec_ring[g_rec_head];
+            rec->type_axis = RECORDER_REC_GAP;
+            rec->seq = g_rec_seq++;
+            rec->arg = 0;
+            rec->a = g_rec_dropped;
+            rec->b = 0;
+            rec->c = 0;
+            g_rec_head = (g_rec_head + 1) & (RECORDER_RING_SIZE - 1);
+            g_rec_dropped = 0;
+        }
+        rec = &g_rec_ring[g_rec_head];
+        rec->type_axis = (uint8_t)(type | (axis << 4));
+        rec->seq = g_rec_seq++;
+        rec->arg = arg;
+        rec->a = a;
+        rec->b = b;
+        rec->c = c;
+        g_rec_head = (g_rec_head + 1) & (RECORDER_RING_SIZE - 1);
+    }
+
+    if (!primask) {
+        __enable_irq();
+    }
+}
@@ -0,0 +1,175 @@
+/**
+  ******************************************************************************
+  * @file    recorder.h
+  * @brief   控制环输入记录模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __RECORDER_H
+#define __RECORDER_H
+
+#include "stm32f10x.h"
+#include "angle_control.h"
+
+/*
+ * 记录控制环的全部输入，主机上用Tools/replay逐位重放：
+ * 控制中断每个周期记一条TICK(毫秒时间、传感器故障标志、角度读数的原始位和样本时间戳)，
+ * 转速内环读到测速时记一条RPM，周期末记一条OUT(状态、模式、风扇指令、差速输入、角度)
+ * 用于核对重放结果；主循环和串口对ANGLE_CONTROL_Set*等接口的调用记为CMD，按键记为KEY。
+ * 记录先写入RAM环形缓冲，主循环按行输出：
+ *   $REC,<32位十六进制>   依次为 类型|轴号<<4、序号、参数(16位)、a、b、c(各32位)
+ * 序号逐条加1，主机据此发现串口丢行。环形缓冲满时丢弃新记录并计数，
+ * 有空间后先写一条GAP，重放在GAP处停止。
+ * 记录带宽：单轴100Hz约每秒200条、7.6KB，接近115200波特率的2/3；
+ * 更高的控制频率或多轴时需降低频率或接受GAP。
+ * 只有从上电开始(在ANGLE_CONTROL_Init之前启动)的记录能逐位重放，
+ * 运行中启动的记录缺少控制器内部状态，START中标记为非上电记录。
+ */
+
+#ifndef RECORDER_AUTOSTART
+#define RECORDER_AUTOSTART    0       // 1: RECORDER_Init时立即开始记录(上电记录)
+#endif
+
+#define RECORDER_RING_SIZE    128     // 环形缓冲记录数(2的幂，每条16字节)
+#define RECORDER_BURST        8       // RECORDER_Process每次最多输出的记录数
+#define RECORDER_FORMAT       1       // 记录格式版本
+
+/* 记录类型 */
+#define RECORDER_REC_START    1       // 开始：参数=格式版本，a=控制节拍us，b=过采样率|轴数<<16|上电记录<<24，c=毫秒时间
+#define RECORDER_REC_TICK     2       // 控制周期输入：参数=故障标志|读数方式<<8，a=毫秒时间，b=角度原始位，c=样本时间戳低32位
+#define RECORDER_REC_RPM      3       // 测速：参数=RECORDER_RPM_x标志(右风扇左移3位)，a/b=左/右转速(float位)
+#define RECORDER_REC_OUT      4       // 控制输出：参数=状态|模式<<4|高分辨率<<8|已输出<<9，a=左|右<<16，b=差速输入，c=当前角度(float位)
+#define RECORDER_REC_CMD      5       // 接口调用：参数=命令号(RECORDER_CMD_x)|嵌套标志，a/b/c=参数
+#define RECORDER_REC_KEY      6       // 按键：参数=键值，a=毫秒时间
+#define RECORDER_REC_GAP      7       // 缓冲溢出：a=丢弃的记录数
+
+/* TICK读数方式 */
+#define RECORDER_READ_NONE    0       // 故障保持，未读角度
+#define RECORDER_READ_FLOAT   1       // ANGLE_SENSOR_GetAngleAt，b为float
+#define RECORDER_READ_Q16     2       // ANGLE_SENSOR_GetAngleQ16，b为Q16.16
+#define RECORDER_READ_FAILED  0x04    // 读数返回非ANGLE_SENSOR_OK
+
+/* RPM标志(每风扇3位) */
+#define RECORDER_RPM_QUERIED  0x01    // 查询了停转状态
+#define RECORDER_RPM_STALLED  0x02    // 停转
+#define RECORDER_RPM_READ     0x04    // 读取了转速
+
+/* 接口调用命令号，参数为调用时传入的原始值(float按位记录) */
+#define RECORDER_CMD_TARGET       1   // SetTarget(a=角度)
+#define RECORDER_CMD_MODE         2   // SetMode(a=模式)
+#define RECORDER_CMD_PID          3   // SetPID(a/b/c=kp/ki/kd)
+#define RECORDER_CMD_ESTIMATOR    4   // EnableEstimator(a=使能)
+#define RECORDER_CMD_EST_NOISE    5   // SetEstimatorNoise(a/b=过程/测量噪声)
+#define RECORDER_CMD_SYSID        6   // EnableIdentification(a=使能)
+#define RECORDER_CMD_FINE_OUTPUT  7   // EnableFineOutput(a=使能)
+#define RECORDER_CMD_ATTACH_TACH  8   // AttachTach(a=左有测速|右有测速<<1)
+#define RECORDER_CMD_RPM_LOOP     9   // EnableRpmLoop(a=使能)
+#define RECORDER_CMD_RPM_PARAMS   10  // SetRpmLoop(a/b/c=rpm_max/kp/ki)
+#define RECORDER_CMD_ALLOCATION   11  // SetAllocation(a=方式)
+#define RECORDER_CMD_MPC_MODEL    12  // SetMPCModel(a/b=增益/阻尼)
+#define RECORDER_CMD_STABLE       13  // SetStableCondition(a=误差，b=时间ms)
+#define RECORDER_CMD_EARLY_CONF   14  // SetEarlyConfidence(a=置信度)
+#define RECORDER_CMD_LOOP_RATE    15  // SetLoopRate成功(a=频率，b=轴数，c=选定的过采样率)
+#define RECORDER_CMD_SEQ_STEP     16  // ConfigSequence的一步(a=序号，b=角度，c=保持时间s)
+#define RECORDER_CMD_SEQUENCE     17  // ConfigSequence(a=步数)，各步紧接在前
+#define RECORDER_CMD_START_SEQ    18  // StartSequence
+#define RECORDER_CMD_FAN_PARAMS   19  // SetFanParameters(a=基础速度，b=差速比例)
+#define RECORDER_CMD_STOP         20  // Stop
+#define RECORDER_CMD_PROG_CLEAR   21  // ClearProgram(a=流式)
+#define RECORDER_CMD_PROG_STEP    22  // AppendStep(a=op|flags<<8|value<<16，b=tolerance|rate<<16，c=time)
+#define RECORDER_CMD_PROG_BUILTIN 23  // LoadProgram(a=内置程序号)
+#define RECORDER_CMD_SEQ_KEY      24  // SequenceKey(a=键值)
+#define RECORDER_CMD_NESTED       0x8000 // 在控制中断或其他接口内部发生，重放时由被调代码自行产生
+
+/* 记录 */
+typedef struct {
+    uint8_t type_axis;           // 类型|轴号<<4
+    uint8_t seq;                 // 序号
+    uint16_t arg;                // 参数
+    uint32_t a, b, c;            // 数据
+} RecorderRecord_TypeDef;
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化记录模块
+  * @param  controls: 角度控制结构体数组，数组下标即轴号
+  * @param  count: 轴数
+  * @retval 无
+  * @note   在ANGLE_CONTROL_Init之前调用；RECORDER_AUTOSTART为1时立即开始上电记录
+  */
+void RECORDER_Init(AngleControl_TypeDef *controls, uint8_t count);
+
+/**
+  * @brief  开始记录
+  * @param  无
+  * @retval 无
+  */
+void RECORDER_Start(void);
+
+/**
+  * @brief  停止记录，已缓冲的记录继续输出
+  * @param  无
+  * @retval 无
+  */
+void RECORDER_Stop(void);
+
+/**
+  * @brief  查询是否在记录
+  * @param  无
+  * @retval uint8_t: 1正在记录
+  */
+uint8_t RECORDER_IsActive(void);
+
+/**
+  * @brief  输出缓冲的记录
+  * @param  无
+  * @retval 无
+  * @note   在主循环中调用，每次最多输出RECORDER_BURST条
+  */
+void RECORDER_Process(void);
+
+/**
+  * @brief  记录按键
+  * @param  key: 键值
+  * @retval 无
+  */
+void RECORDER_Key(uint8_t key);
+
+/**
+  * @brief  记录接口调用
+  * @param  control: 被调用的控制轴
+  * @param  cmd: 命令号(RECORDER_CMD_x)
+  * @param  a: 参数
+  * @param  b: 参数
+  * @param  c: 参数
+  * @retval 无
+  */
+void RECORDER_Command(AngleControl_TypeDef *control, uint16_t cmd, uint32_t a, uint32_t b, uint32_t c);
+
+/**
+  * @brief  取float的原始位
+  * @param  value: 浮点数
+  * @retval uint32_t: IEEE754单精度位
+  */
+uint32_t RECORDER_Float(float value);
+
+/**
+  * @brief  标记进入/离开会调用其他接口的接口，期间的接口调用记为嵌套
+  * @param  无
+  * @retval 无
+  */
+void RECORDER_NestBegin(void);
+void RECORDER_NestEnd(void);
+
+/* 以下由angle_control.c在控制中断中调用 */
+void RECORDER_TickBegin(AngleControl_TypeDef *control);                        // 控制周期开始
+void RECORDER_Fault(AngleControl_TypeDef *control, uint8_t faults);            // 传感器故障标志
+void RECORDER_Angle(AngleControl_TypeDef *control, uint8_t read, uint32_t value,
+                    uint64_t timestamp);                                       // 角度读数
+void RECORDER_Rpm(AngleControl_TypeDef *control, FanSelect_TypeDef fan, uint8_t stalled,
+                  uint8_t read, float rpm);                                    // 测速读数
+void RECORDER_Output(AngleControl_TypeDef *control, uint8_t fine, uint16_t left, uint16_t right); // 风扇指令
+void RECORDER_TickEnd(AngleControl_TypeDef *control);                          // 控制周期结束，写入本周期记录
+
+#endif /* __RECORDER_H */
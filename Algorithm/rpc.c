@@ -0,0 +1,431 @@
+/**
+  ******************************************************************************
+  * @file    rpc.c
+  * @brief   主机工具二进制RPC模块实现
+  ******************************************************************************
+  * 参数读写按参数号分派到ANGLE_CONTROL_*接口，和命令行走同一套设置函数，
+  * 因此同样会被控制环记录(recorder)记为CMD。参数属性表由rpc_schema.h的
+  * RPC_PARAM_TABLE生成，放在Flash中。
+  ******************************************************************************
+  */
+
+#include "rpc.h"
+#include <stdio.h>
+#include <string.h>
+
+/* 参数属性 */
+typedef struct {
+    uint16_t id;                 // 参数号
+    uint8_t type;                // RPC_TYPE_x
+    uint8_t access;              // RPC_ACCESS_x
+} RpcParamInfo_TypeDef;
+
+#define RPC_PARAM_INFO(name, id, type, access, text) { id, type, access },
+static const RpcParamInfo_TypeDef g_rpc_params[] = {
+    RPC_PARAM_TABLE(RPC_PARAM_INFO)
+};
+#undef RPC_PARAM_INFO
+
+#define RPC_PARAM_COUNT (sizeof(g_rpc_params) / sizeof(g_rpc_params[0]))
+
+/* 数据流状态 */
+typedef struct {
+    uint16_t period;             // 上报周期(ms)，0关闭
+    uint32_t last_time;          // 上次上报时间(ms)
+} RpcStream_TypeDef;
+
+/* 私有变量 */
+static AngleControl_TypeDef *g_rpc_controls = NULL;
+static uint8_t g_rpc_count = 0;
+static RpcStream_TypeDef g_rpc_streams[ANGLE_CONTROL_AXIS_COUNT];
+
+/* 私有函数声明 */
+static void RPC_Send(uint8_t id, uint8_t op, const uint8_t *body, uint16_t len);
+static const RpcParamInfo_TypeDef *RPC_FindParam(uint16_t id);
+static uint8_t RPC_GetParam(AngleControl_TypeDef *control, uint16_t id, uint8_t *value);
+static uint8_t RPC_SetParam(AngleControl_TypeDef *control, uint16_t id, const uint8_t *value);
+static void RPC_FillSample(AngleControl_TypeDef *control, uint8_t axis, uint32_t now, uint8_t *sample);
+
+/**
+  * @brief  初始化RPC
+  * @param  controls: 角度控制结构体数组，数组下标即轴号
+  * @param  count: 轴数
+  * @retval 无
+  */
+void RPC_Init(AngleControl_TypeDef *controls, uint8_t count)
+{
+    g_rpc_controls = controls;
+    g_rpc_count = (count > ANGLE_CONTROL_AXIS_COUNT) ? ANGLE_CONTROL_AXIS_COUNT : count;
+    memset(g_rpc_streams, 0, sizeof(g_rpc_streams));
+}
+
+/**
+  * @brief  处理一帧请求并发送应答
+  * @param  frame: COBS编码的帧(不含分隔符)，原地解码，内容会被修改
+  * @param  len: 帧字节数
+  * @retval uint8_t: 1已处理，0帧无效(丢弃，不应答)
+  * @note   在主循环中调用，不要在中断中调用
+  */
+uint8_t RPC_Handle(uint8_t *frame, uint16_t len)
+{
+    RpcMessage_TypeDef msg;
+    uint8_t resp[1 + RPC_BODY_MAX];   // 状态码 + 负载
+    uint16_t resp_len = 0;
+    uint8_t status = RPC_STATUS_OK;
+    AngleControl_TypeDef *control = NULL;
+    float angles[RPC_SEQ_STEPS_MAX];
+    uint8_t holds[RPC_SEQ_STEPS_MAX];
+    SeqStep_TypeDef step;
+    const uint8_t *p;
+    uint8_t i, count;
+
+    if (g_rpc_controls == NULL) return 0;
+    if (!RPC_ParseFrame(frame, len, &msg)) return 0;
+    if (msg.id == RPC_ID_EVENT || (msg.op & RPC_OP_RESPONSE)) return 0;  // 只处理主机请求
+
+    /* 除PING/INFO外，消息体首字节为轴号 */
+    if (msg.op != RPC_OP_PING && msg.op != RPC_OP_INFO) {
+        if (msg.len < 1) {
+            status = RPC_STATUS_BAD_LEN;
+        } else if (msg.body[0] >= g_rpc_count) {
+            status = RPC_STATUS_BAD_AXIS;
+        } else {
+            control = &g_rpc_controls[msg.body[0]];
+        }
+    }
+
+    if (status == RPC_STATUS_OK) {
+        switch (msg.op) {
+        case RPC_OP_PING:
+            resp_len = (msg.len < RPC_BODY_MAX) ? msg.len : RPC_BODY_MAX - 1;  // 应答多一个状态字节
+            memcpy(&resp[1], msg.body, resp_len);
+            break;
+
+        case RPC_OP_INFO:
+            resp[1 + RPC_INFO_VERSION] = RPC_PROTOCOL_VERSION;
+            resp[1 + RPC_INFO_AXES] = g_rpc_count;
+            RPC_PutU16(&resp[1 + RPC_INFO_TICK_US], ANGLE_CONTROL_GetTickUs());
+            resp[1 + RPC_INFO_BODY_MAX] = RPC_BODY_MAX;
+            resp_len = RPC_INFO_LEN;
+            break;
+
+        case RPC_OP_GET_PARAM:
+            if (msg.len != 3) { status = RPC_STATUS_BAD_LEN; break; }
+            status = RPC_GetParam(control, RPC_GetU16(&msg.body[1]), &resp[1]);
+            if (status == RPC_STATUS_OK) resp_len = 4;
+            break;
+
+        case RPC_OP_SET_PARAM:
+            if (msg.len != 7) { status = RPC_STATUS_BAD_LEN; break; }
+            status = RPC_SetParam(control, RPC_GetU16(&msg.body[1]), &msg.body[3]);
+            break;
+
+        case RPC_OP_STOP:
+            if (msg.len != 1) { status = RPC_STATUS_BAD_LEN; break; }
+            ANGLE_CONTROL_Stop(control);
+            break;
+
+        case RPC_OP_SEQUENCE:
+            count = (msg.len >= 2) ? msg.body[1] : 0;
+            if (count == 0 || count > RPC_SEQ_STEPS_MAX || msg.len != 2 + count * RPC_SEQ_STEP_LEN) {
+                status = RPC_STATUS_BAD_LEN;
+                break;
+            }
+            for (i = 0; i < count; i++) {
+                angles[i] = RPC_GetF32(&msg.body[2 + i * RPC_SEQ_STEP_LEN]);
+                holds[i] = msg.body[2 + i * RPC_SEQ_STEP_LEN + 4];
+            }
+            if (!ANGLE_CONTROL_ConfigSequence(control, angles, holds, count)) {
+                status = RPC_STATUS_BAD_VALUE;
+                break;
+            }
+            ANGLE_CONTROL_StartSequence(control);
+            break;
+
+        case RPC_OP_SAMPLE:
+            if (msg.len != 1) { status = RPC_STATUS_BAD_LEN; break; }
+            RPC_FillSample(control, msg.body[0], ANGLE_CONTROL_GetTime(), &resp[1]);
+            resp_len = RPC_SAMPLE_LEN;
+            break;
+
+        case RPC_OP_STREAM:
+            if (msg.len != 3) { status = RPC_STATUS_BAD_LEN; break; }
+            g_rpc_streams[msg.body[0]].period = RPC_GetU16(&msg.body[1]);
+            if (g_rpc_streams[msg.body[0]].period != 0 &&
+                g_rpc_streams[msg.body[0]].period < RPC_STREAM_MIN_PERIOD) {
+                g_rpc_streams[msg.body[0]].period = RPC_STREAM_MIN_PERIOD;
+            }
+            g_rpc_streams[msg.body[0]].last_time = ANGLE_CONTROL_GetTime();
+            break;
+
+        case RPC_OP_SAVE:
+            if (msg.len != 1) { status = RPC_STATUS_BAD_LEN; break; }
+            if (ANGLE_CONTROL_SaveParams(control, msg.body[0]) != PARAM_OK) status = RPC_STATUS_STORAGE;
+            break;
+
+        case RPC_OP_PROG_CLEAR:
+            if (msg.len != 2) { status = RPC_STATUS_BAD_LEN; break; }
+            if (control->mode == CONTROL_MODE_SEQUENCE) ANGLE_CONTROL_Stop(control);
+            ANGLE_CONTROL_ClearProgram(control, msg.body[1]);
+            break;
+
+        case RPC_OP_PROG_APPEND:
+            count = (uint8_t)((msg.len - 1) / RPC_STEP_LEN);
+            if (count == 0 || msg.len != 1 + count * RPC_STEP_LEN) { status = RPC_STATUS_BAD_LEN; break; }
+            for (i = 0; i < count; i++) {
+                if (msg.body[1 + i * RPC_STEP_LEN + RPC_STEP_OP] > SEQ_OP_END_LOOP) break;
+            }
+            if (i < count) { status = RPC_STATUS_BAD_VALUE; break; }
+            /* 依次追加到缓冲满为止，其余由主机稍后重发 */
+            for (i = 0; i < count; i++) {
+                p = &msg.body[1 + i * RPC_STEP_LEN];
+                step.op = p[RPC_STEP_OP];
+                step.flags = p[RPC_STEP_FLAGS];
+                step.value = (int16_t)RPC_GetU16(&p[RPC_STEP_VALUE]);
+                step.tolerance = RPC_GetU16(&p[RPC_STEP_TOLERANCE]);
+                step.rate = RPC_GetU16(&p[RPC_STEP_RATE]);
+                step.time = RPC_GetU32(&p[RPC_STEP_TIME]);
+                if (ANGLE_CONTROL_AppendStep(control, &step) != SEQ_OK) break;
+            }
+            if (i == 0) { status = RPC_STATUS_BUSY; break; }
+            resp[1] = i;
+            RPC_PutU16(&resp[2], SEQ_Free(&control->sequence));
+            resp_len = 3;
+            break;
+
+        case RPC_OP_PROG_START:
+            if (msg.len != 2) { status = RPC_STATUS_BAD_LEN; break; }
+            if (msg.body[1] != RPC_PROG_UPLOADED && !ANGLE_CONTROL_LoadProgram(control, msg.body[1])) {
+                status = RPC_STATUS_BAD_VALUE;
+                break;
+            }
+            if (SEQ_IsEmpty(&control->sequence)) { status = RPC_STATUS_BAD_VALUE; break; }
+            ANGLE_CONTROL_StartSequence(control);
+            if (control->mode != CONTROL_MODE_SEQUENCE) status = RPC_STATUS_BUSY;   // 流式程序已执行过，须重新上传
+            break;
+
+        case RPC_OP_PROG_STATUS:
+            if (msg.len != 1) { status = RPC_STATUS_BAD_LEN; break; }
+            resp[1 + RPC_PROG_STATE] = (uint8_t)control->sequence.state;
+            resp[1 + RPC_PROG_PHASE] = (uint8_t)control->sequence.phase;
+            RPC_PutU16(&resp[1 + RPC_PROG_FREE], SEQ_Free(&control->sequence));
+            RPC_PutU32(&resp[1 + RPC_PROG_PC], control->sequence.pc);
+            resp_len = RPC_PROG_LEN;
+            break;
+
+        case RPC_OP_PROG_KEY:
+            if (msg.len != 2) { status = RPC_STATUS_BAD_LEN; break; }
+            ANGLE_CONTROL_SequenceKey(control, msg.body[1]);
+            break;
+
+        default:
+            status = RPC_STATUS_BAD_OP;
+            break;
+        }
+    }
+
+    if (status != RPC_STATUS_OK) resp_len = 0;
+    resp[0] = status;
+    RPC_Send(msg.id, (uint8_t)(msg.op | RPC_OP_RESPONSE), resp, (uint16_t)(resp_len + 1));
+    return 1;
+}
+
+/**
+  * @brief  数据流上报，到达各轴上报周期时发送STREAM_DATA
+  * @param  无
+  * @retval 无
+  * @note   在主循环中调用，不要在中断中调用
+  */
+void RPC_Process(void)
+{
+    uint8_t sample[RPC_SAMPLE_LEN];
+    uint32_t now = ANGLE_CONTROL_GetTime();
+    uint8_t i;
+
+    for (i = 0; i < g_rpc_count; i++) {
+        if (g_rpc_streams[i].period == 0) continue;
+        if ((now - g_rpc_streams[i].last_time) < g_rpc_streams[i].period) continue;
+        g_rpc_streams[i].last_time = now;
+        RPC_FillSample(&g_rpc_controls[i], i, now, sample);
+        RPC_Send(RPC_ID_EVENT, RPC_OP_STREAM_DATA, sample, RPC_SAMPLE_LEN);
+    }
+}
+
+/**
+  * @brief  组帧并发送
+  * @param  id: 请求号
+  * @param  op: 操作码
+  * @param  body: 消息体
+  * @param  len: 消息体字节数
+  * @retval 无
+  * @note   私有函数；经重定向的fputc阻塞发送，整帧连续发出
+  */
+static void RPC_Send(uint8_t id, uint8_t op, const uint8_t *body, uint16_t len)
+{
+    uint8_t frame[RPC_FRAME_MAX];
+    uint16_t n, i;
+
+    n = RPC_BuildFrame(id, op, body, len, frame);
+    for (i = 0; i < n; i++) putchar(frame[i]);
+}
+
+/**
+  * @brief  按参数号查找参数属性
+  * @param  id: 参数号
+  * @retval const RpcParamInfo_TypeDef*: 参数属性，NULL表示未知
+  * @note   私有函数
+  */
+static const RpcParamInfo_TypeDef *RPC_FindParam(uint16_t id)
+{
+    uint8_t i;
+
+    for (i = 0; i < RPC_PARAM_COUNT; i++) {
+        if (g_rpc_params[i].id == id) return &g_rpc_params[i];
+    }
+    return NULL;
+}
+
+/**
+  * @brief  读取参数
+  * @param  control: 角度控制结构体指针
+  * @param  id: 参数号
+  * @param  value: 输出4字节小端值
+  * @retval uint8_t: RPC_STATUS_x
+  * @note   私有函数
+  */
+static uint8_t RPC_GetParam(AngleControl_TypeDef *control, uint16_t id, uint8_t *value)
+{
+    const RpcParamInfo_TypeDef *info = RPC_FindParam(id);
+    float f = 0.0f;
+    uint32_t u = 0;
+
+    if (info == NULL) return RPC_STATUS_BAD_PARAM;
+
+    switch (id) {
+    case RPC_PARAM_TARGET:       f = control->target_angle; break;
+    case RPC_PARAM_MODE:         u = control->mode; break;
+    case RPC_PARAM_ANGLE:        f = control->current_angle; break;
+    case RPC_PARAM_STATE:        u = control->state; break;
+    case RPC_PARAM_KP:           f = control->pid.Kp; break;
+    case RPC_PARAM_KI:           f = control->pid.Ki; break;
+    case RPC_PARAM_KD:           f = control->pid.Kd; break;
+    case RPC_PARAM_FAN_BASE:     u = control->fan_base_speed; break;
+    case RPC_PARAM_FAN_RATIO:    u = control->dual_mode_ratio; break;
+    case RPC_PARAM_STABLE_ERROR: f = control->allowed_error; break;
+    case RPC_PARAM_STABLE_TIME:  u = control->stable_time; break;
+    case RPC_PARAM_EARLY_CONF:   f = control->early_confidence; break;
+    case RPC_PARAM_ESTIMATOR:    u = control->use_estimator; break;
+    case RPC_PARAM_FINE_OUTPUT:  u = control->fine_output; break;
+    case RPC_PARAM_RPM_LOOP:     u = control->rpm_loop; break;
+    case RPC_PARAM_ALLOCATION:   u = control->alloc_mode; break;
+    case RPC_PARAM_LOOP_RATE:    u = 1000000UL / ANGLE_CONTROL_GetTickUs(); break;
+    default: return RPC_STATUS_BAD_PARAM;
+    }
+
+    if (info->type == RPC_TYPE_F32) RPC_PutF32(value, f);
+    else RPC_PutU32(value, u);
+    return RPC_STATUS_OK;
+}
+
+/**
+  * @brief  写入参数
+  * @param  control: 角度控制结构体指针
+  * @param  id: 参数号
+  * @param  value: 4字节小端值
+  * @retval uint8_t: RPC_STATUS_x
+  * @note   私有函数；范围与命令行一致
+  */
+static uint8_t RPC_SetParam(AngleControl_TypeDef *control, uint16_t id, const uint8_t *value)
+{
+    const RpcParamInfo_TypeDef *info = RPC_FindParam(id);
+    float f = RPC_GetF32(value);
+    uint32_t u = RPC_GetU32(value);
+
+    if (info == NULL) return RPC_STATUS_BAD_PARAM;
+    if (info->access == RPC_ACCESS_RO) return RPC_STATUS_READ_ONLY;
+    if (info->type == RPC_TYPE_F32 && f != f) return RPC_STATUS_BAD_VALUE;  // NaN
+
+    switch (id) {
+    case RPC_PARAM_TARGET:
+        ANGLE_CONTROL_SetTarget(control, f);
+        break;
+    case RPC_PARAM_MODE:
+        if (u > CONTROL_MODE_DUAL_FAN_MPC) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_SetMode(control, (ControlMode_TypeDef)u);
+        break;
+    case RPC_PARAM_KP:
+        ANGLE_CONTROL_SetPID(control, f, control->pid.Ki, control->pid.Kd);
+        break;
+    case RPC_PARAM_KI:
+        ANGLE_CONTROL_SetPID(control, control->pid.Kp, f, control->pid.Kd);
+        break;
+    case RPC_PARAM_KD:
+        ANGLE_CONTROL_SetPID(control, control->pid.Kp, control->pid.Ki, f);
+        break;
+    case RPC_PARAM_FAN_BASE:
+        if (u > 100) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_SetFanParameters(control, (uint8_t)u, control->dual_mode_ratio);
+        break;
+    case RPC_PARAM_FAN_RATIO:
+        if (u > 100) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_SetFanParameters(control, control->fan_base_speed, (uint8_t)u);
+        break;
+    case RPC_PARAM_STABLE_ERROR:
+        if (f <= 0.0f) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_SetStableCondition(control, f, control->stable_time);
+        break;
+    case RPC_PARAM_STABLE_TIME:
+        if (u > 0xFFFF) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_SetStableCondition(control, control->allowed_error, (uint16_t)u);
+        break;
+    case RPC_PARAM_EARLY_CONF:
+        if (f < 0.0f) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_SetEarlyConfidence(control, f);
+        break;
+    case RPC_PARAM_ESTIMATOR:
+        if (u > 1) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_EnableEstimator(control, (uint8_t)u);
+        break;
+    case RPC_PARAM_FINE_OUTPUT:
+        if (u > 1) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_EnableFineOutput(control, (uint8_t)u);
+        break;
+    case RPC_PARAM_RPM_LOOP:
+        if (u > 1) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_EnableRpmLoop(control, (uint8_t)u);
+        break;
+    case RPC_PARAM_ALLOCATION:
+        if (u > ALLOC_MODE_MIN_POWER) return RPC_STATUS_BAD_VALUE;
+        ANGLE_CONTROL_SetAllocation(control, (AllocMode_TypeDef)u);
+        break;
+    case RPC_PARAM_LOOP_RATE:
+        if (u < ANGLE_CONTROL_RATE_MIN || u > ANGLE_CONTROL_RATE_MAX) return RPC_STATUS_BAD_VALUE;
+        if (!ANGLE_CONTROL_SetLoopRate(g_rpc_controls, g_rpc_count, (uint16_t)u)) return RPC_STATUS_BUSY;
+        break;
+    default:
+        return RPC_STATUS_BAD_PARAM;
+    }
+    return RPC_STATUS_OK;
+}
+
+/**
+  * @brief  填写状态样本
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号
+  * @param  now: 当前时间(ms)
+  * @param  sample: 输出RPC_SAMPLE_LEN字节
+  * @retval 无
+  * @note   私有函数
+  */
+static void RPC_FillSample(AngleControl_TypeDef *control, uint8_t axis, uint32_t now, uint8_t *sample)
+{
+    RPC_PutU32(&sample[RPC_SAMPLE_TIME], now);
+    sample[RPC_SAMPLE_AXIS] = axis;
+    sample[RPC_SAMPLE_MODE] = (uint8_t)control->mode;
+    sample[RPC_SAMPLE_STATE] = (uint8_t)control->state;
+    sample[RPC_SAMPLE_FAULT] = control->sensor_fault;
+    RPC_PutF32(&sample[RPC_SAMPLE_TARGET], control->target_angle);
+    RPC_PutF32(&sample[RPC_SAMPLE_ANGLE], control->current_angle);
+    RPC_PutF32(&sample[RPC_SAMPLE_RATE], control->current_rate);
+    RPC_PutF32(&sample[RPC_SAMPLE_INPUT], control->applied_input);
+}
@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************
+  * @file    rpc.h
+  * @brief   主机工具二进制RPC模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __RPC_H
+#define __RPC_H
+
+#include "stm32f10x.h"
+#include "angle_control.h"
+#include "rpc_codec.h"
+
+/*
+ * 协议见rpc_schema.h。USART_RxService把0x00分隔的帧组装到USART_RX_FRAME，
+ * SHELL_Process取到帧后调用RPC_Handle原地解码、执行并应答；
+ * 应答在主循环中同步发送，和文本输出交替出现在串口上，主机按0x00分帧并丢弃帧外文本。
+ * 请求按到达顺序处理，主机可以流水线发送多个请求，一次主循环把缓冲中的请求全部处理完，
+ * 流水线深度只受USART_RX_RING_LEN限制(最长帧约70字节，2048字节可缓存约29个)。
+ * 控制中断中的printf(如序列步进提示)可能插入正在发送的应答帧，该帧CRC失败被主机丢弃后超时重发。
+ */
+
+#define RPC_STREAM_MIN_PERIOD 10      // 数据流最小上报周期(ms)，115200波特率下每帧约3ms
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化RPC
+  * @param  controls: 角度控制结构体数组，数组下标即轴号
+  * @param  count: 轴数
+  * @retval 无
+  */
+void RPC_Init(AngleControl_TypeDef *controls, uint8_t count);
+
+/**
+  * @brief  处理一帧请求并发送应答
+  * @param  frame: COBS编码的帧(不含分隔符)，原地解码，内容会被修改
+  * @param  len: 帧字节数
+  * @retval uint8_t: 1已处理，0帧无效(丢弃，不应答)
+  * @note   在主循环中调用，不要在中断中调用
+  */
+uint8_t RPC_Handle(uint8_t *frame, uint16_t len);
+
+/**
+  * @brief  数据流上报，到达各轴上报周期时发送STREAM_DATA
+  * @param  无
+  * @retval 无
+  * @note   在主循环中调用，不要在中断中调用
+  */
+void RPC_Process(void);
+
+#endif /* __RPC_H */
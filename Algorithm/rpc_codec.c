@@ -0,0 +1,177 @@
+/**
+  ******************************************************************************
+  * @file    rpc_codec.c
+  * @brief   RPC帧编解码实现，固件与主机客户端共用
+  ******************************************************************************
+  * COBS把消息中的0x00替换为到下一个0x00的距离，编码后不含0x00，
+  * 开销为每254字节1字节；接收方遇到0x00即可确定帧边界，丢字节后在下一帧重新同步。
+  * CRC按位计算，不用查表，省下512字节Flash；64字节消息约需1.5k周期。
+  ******************************************************************************
+  */
+
+#include "rpc_codec.h"
+#include <string.h>
+
+/**
+  * @brief  计算CRC16-CCITT
+  * @param  data: 数据
+  * @param  len: 字节数
+  * @param  crc: 初值(首段用0xFFFF，分段计算时传入上一段结果)
+  * @retval uint16_t: CRC
+  */
+uint16_t RPC_Crc16(const uint8_t *data, uint16_t len, uint16_t crc)
+{
+    uint8_t bit;
+
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (bit = 0; bit < 8; bit++) {
+            if (crc & 0x8000) crc = (uint16_t)((crc << 1) ^ 0x1021);
+            else crc = (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+  * @brief  COBS编码
+  * @param  in: 原始数据
+  * @param  len: 原始字节数
+  * @param  out: 输出缓冲，至少len + len / 254 + 1字节，不能与in重叠
+  * @retval uint16_t: 编码后字节数(不含分隔符)
+  */
+uint16_t RPC_CobsEncode(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint16_t code_pos = 0;       // 当前段长度字节的位置
+    uint16_t pos = 1;
+    uint8_t code = 1;
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = pos++;
+            code = 1;
+        } else {
+            out[pos++] = in[i];
+            if (++code == 0xFF) {
+                out[code_pos] = code;
+                code_pos = pos++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+    return pos;
+}
+
+/**
+  * @brief  COBS解码
+  * @param  in: 编码数据(不含分隔符)
+  * @param  len: 编码字节数
+  * @param  out: 输出缓冲，至少len字节，可与in相同(原地解码)
+  * @retval uint16_t: 解码后字节数，0表示编码非法
+  */
+uint16_t RPC_CobsDecode(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint16_t i = 0;
+    uint16_t n = 0;
+    uint8_t code, k;
+
+    while (i < len) {
+        code = in[i++];
+        if (code == 0 || (uint16_t)(i + code - 1) > len) return 0;
+        for (k = 1; k < code; k++) out[n++] = in[i++];  // 写位置总在读位置之前，可原地解码
+        if (code != 0xFF && i < len) out[n++] = 0;
+    }
+    return n;
+}
+
+/**
+  * @brief  组帧：请求号、操作码、消息体加CRC后COBS编码，前后加0x00分隔符
+  * @param  id: 请求号
+  * @param  op: 操作码
+  * @param  body: 消息体(可为NULL当len为0)
+  * @param  len: 消息体字节数，不超过RPC_BODY_MAX
+  * @param  frame: 输出缓冲，至少RPC_FRAME_MAX字节
+  * @retval uint16_t: 帧字节数，0表示消息体过长
+  */
+uint16_t RPC_BuildFrame(uint8_t id, uint8_t op, const uint8_t *body, uint16_t len, uint8_t *frame)
+{
+    uint8_t msg[RPC_MSG_MAX];
+    uint16_t crc, n;
+
+    if (len > RPC_BODY_MAX) return 0;
+    msg[0] = id;
+    msg[1] = op;
+    if (len > 0) memcpy(&msg[2], body, len);
+    crc = RPC_Crc16(msg, (uint16_t)(len + 2), 0xFFFF);
+    RPC_PutU16(&msg[len + 2], crc);
+
+    frame[0] = 0x00;
+    n = RPC_CobsEncode(msg, (uint16_t)(len + 4), &frame[1]);
+    frame[n + 1] = 0x00;
+    return (uint16_t)(n + 2);
+}
+
+/**
+  * @brief  解帧：COBS原地解码并校验CRC
+  * @param  buf: 编码数据(不含分隔符)，解码结果写回此缓冲
+  * @param  len: 编码字节数
+  * @param  msg: 输出消息，body指向buf内
+  * @retval uint8_t: 1成功，0编码非法、长度不足或CRC错误
+  */
+uint8_t RPC_ParseFrame(uint8_t *buf, uint16_t len, RpcMessage_TypeDef *msg)
+{
+    uint16_t n = RPC_CobsDecode(buf, len, buf);
+
+    if (n < 4 || n > RPC_MSG_MAX) return 0;
+    if (RPC_Crc16(buf, (uint16_t)(n - 2), 0xFFFF) != RPC_GetU16(&buf[n - 2])) return 0;
+
+    msg->id = buf[0];
+    msg->op = buf[1];
+    msg->body = &buf[2];
+    msg->len = (uint16_t)(n - 4);
+    return 1;
+}
+
+void RPC_PutU16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+void RPC_PutU32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+void RPC_PutF32(uint8_t *p, float v)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &v, sizeof(bits));
+    RPC_PutU32(p, bits);
+}
+
+uint16_t RPC_GetU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+uint32_t RPC_GetU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+float RPC_GetF32(const uint8_t *p)
+{
+    uint32_t bits = RPC_GetU32(p);
+    float v;
+
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    rpc_codec.h
+  * @brief   RPC帧编解码(CRC16、COBS、小端字段)头文件，固件与主机客户端共用
+  ******************************************************************************
+  */
+
+#ifndef __RPC_CODEC_H
+#define __RPC_CODEC_H
+
+#include "rpc_schema.h"
+
+/* 解码后的消息 */
+typedef struct {
+    uint8_t id;                  // 请求号
+    uint8_t op;                  // 操作码
+    uint8_t *body;               // 消息体(指向解码缓冲内)
+    uint16_t len;                // 消息体字节数
+} RpcMessage_TypeDef;
+
+/* 函数声明 */
+
+/**
+  * @brief  计算CRC16-CCITT
+  * @param  data: 数据
+  * @param  len: 字节数
+  * @param  crc: 初值(首段用0xFFFF，分段计算时传入上一段结果)
+  * @retval uint16_t: CRC
+  */
+uint16_t RPC_Crc16(const uint8_t *data, uint16_t len, uint16_t crc);
+
+/**
+  * @brief  COBS编码
+  * @param  in: 原始数据
+  * @param  len: 原始字节数
+  * @param  out: 输出缓冲，至少len + len / 254 + 1字节，不能与in重叠
+  * @retval uint16_t: 编码后字节数(不含分隔符)
+  */
+uint16_t RPC_CobsEncode(const uint8_t *in, uint16_t len, uint8_t *out);
+
+/**
+  * @brief  COBS解码
+  * @param  in: 编码数据(不含分隔符)
+  * @param  len: 编码字节数
+  * @param  out: 输出缓冲，至少len字节，可与in相同(原地解码)
+  * @retval uint16_t: 解码后字节数，0表示编码非法
+  */
+uint16_t RPC_CobsDecode(const uint8_t *in, uint16_t len, uint8_t *out);
+
+/**
+  * @brief  组帧：请求号、操作码、消息体加CRC后COBS编码，前后加0x00分隔符
+  * @param  id: 请求号
+  * @param  op: 操作码
+  * @param  body: 消息体(可为NULL当len为0)
+  * @param  len: 消息体字节数，不超过RPC_BODY_MAX
+  * @param  frame: 输出缓冲，至少RPC_FRAME_MAX字节
+  * @retval uint16_t: 帧字节数，0表示消息体过长
+  */
+uint16_t RPC_BuildFrame(uint8_t id, uint8_t op, const uint8_t *body, uint16_t len, uint8_t *frame);
+
+/**
+  * @brief  解帧：COBS原地解码并校验CRC
+  * @param  buf: 编码数据(不含分隔符)，解码结果写回此缓冲
+  * @param  len: 编码字节数
+  * @param  msg: 输出消息，body指向buf内
+  * @retval uint8_t: 1成功，0编码非法、长度不足或CRC错误
+  */
+uint8_t RPC_ParseFrame(uint8_t *buf, uint16_t len, RpcMessage_TypeDef *msg);
+
+/* 小端字段读写，p不要求对齐 */
+void RPC_PutU16(uint8_t *p, uint16_t v);
+void RPC_PutU32(uint8_t *p, uint32_t v);
+void RPC_PutF32(uint8_t *p, float v);
+uint16_t RPC_GetU16(const uint8_t *p);
+uint32_t RPC_GetU32(const uint8_t *p);
+float RPC_GetF32(const uint8_t *p);
+
+#endif /* __RPC_CODEC_H */
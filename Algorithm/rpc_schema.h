@@ -0,0 +1,152 @@
+/**
+  ******************************************************************************
+  * @file    rpc_schema.h
+  * @brief   主机工具二进制RPC协议定义(固件与主机客户端共用)
+  ******************************************************************************
+  * 本文件只含协议常量和负载布局，不依赖器件头文件，Tools/rpc直接包含。
+  * 修改消息格式时同时增加RPC_PROTOCOL_VERSION，客户端用INFO请求核对。
+  ******************************************************************************
+  */
+
+#ifndef __RPC_SCHEMA_H
+#define __RPC_SCHEMA_H
+
+#include <stdint.h>
+
+/*
+ * 帧格式(与文本命令行共用USART1，文本中不会出现0x00)：
+ *
+ *   0x00 | COBS( 请求号 | 操作码 | 消息体... | CRC16低字节 | CRC16高字节 ) | 0x00
+ *
+ *   CRC16-CCITT(多项式0x1021，初值0xFFFF)覆盖请求号到消息体末尾。
+ *   请求号1~255由主机分配，应答原样带回，主机可连续发出多个请求不等应答(流水线)，
+ *   固件按到达顺序逐个处理并应答；请求号0保留给固件主动上报(数据流)。
+ *   应答操作码 = 请求操作码 | RPC_OP_RESPONSE，消息体第1字节为状态码(RPC_STATUS_x)，
+ *   状态非OK时没有后续负载。校验失败或长度不足的帧直接丢弃、不应答，由主机超时重发。
+ *   多字节字段一律小端，float为IEEE754单精度位模式。
+ */
+
+#define RPC_PROTOCOL_VERSION  2
+
+#define RPC_BODY_MAX          64      // 消息体最大字节数(不含请求号/操作码/CRC)
+#define RPC_MSG_MAX           (2 + RPC_BODY_MAX + 2)                 // 编码前消息最大字节数
+#define RPC_COBS_MAX          (RPC_MSG_MAX + RPC_MSG_MAX / 254 + 1)  // COBS编码后最大字节数
+#define RPC_FRAME_MAX         (RPC_COBS_MAX + 2)                     // 含前后分隔符的帧最大字节数
+
+#define RPC_ID_EVENT          0       // 固件主动上报使用的请求号
+
+/* 操作码 */
+#define RPC_OP_PING           0x01    // 请求:任意字节 应答:原样返回
+#define RPC_OP_INFO           0x02    // 请求:无 应答:RPC_INFO_x布局
+#define RPC_OP_GET_PARAM      0x03    // 请求:轴号(1) 参数号(2) 应答:值(4)
+#define RPC_OP_SET_PARAM      0x04    // 请求:轴号(1) 参数号(2) 值(4) 应答:无
+#define RPC_OP_STOP           0x05    // 请求:轴号(1) 应答:无
+#define RPC_OP_SEQUENCE       0x06    // 请求:轴号(1) 步数(1) {角度f32 保持s(1)}*n 应答:无，配置后立即开始
+#define RPC_OP_SAMPLE         0x07    // 请求:轴号(1) 应答:RPC_SAMPLE_x布局
+#define RPC_OP_STREAM         0x08    // 请求:轴号(1) 周期ms(2)，0停止 应答:无
+#define RPC_OP_SAVE           0x09    // 请求:轴号(1) 应答:无
+#define RPC_OP_PROG_CLEAR     0x0A    // 请求:轴号(1) 流式(1) 应答:无，清空序列程序并停止序列
+#define RPC_OP_PROG_APPEND    0x0B    // 请求:轴号(1) {序列指令}*n 应答:接收步数(1) 剩余空间(2)，一步未收为BUSY
+#define RPC_OP_PROG_START     0x0C    // 请求:轴号(1) 程序号(1) 应答:无，RPC_PROG_UPLOADED为已上传的程序
+#define RPC_OP_PROG_STATUS    0x0D    // 请求:轴号(1) 应答:RPC_PROG_x布局
+#define RPC_OP_PROG_KEY       0x0E    // 请求:轴号(1) 键值(1) 应答:无，满足等待中的WAIT_KEY
+#define RPC_OP_STREAM_DATA    0x40    // 上报(请求号0):RPC_SAMPLE_x布局
+#define RPC_OP_RESPONSE       0x80    // 应答标志位
+
+/* 应答状态码 */
+#define RPC_STATUS_OK         0
+#define RPC_STATUS_BAD_OP     1       // 未知操作码
+#define RPC_STATUS_BAD_LEN    2       // 消息体长度不符
+#define RPC_STATUS_BAD_AXIS   3       // 轴号超出范围
+#define RPC_STATUS_BAD_PARAM  4       // 未知参数号
+#define RPC_STATUS_BAD_VALUE  5       // 参数值超出范围
+#define RPC_STATUS_READ_ONLY  6       // 参数只读
+#define RPC_STATUS_BUSY       7       // 当前状态不允许(如修改控制频率时有轴在运行)
+#define RPC_STATUS_STORAGE    8       // 参数存储已满或写入失败
+
+/* 参数值类型 */
+#define RPC_TYPE_F32          0
+#define RPC_TYPE_U32          1
+
+/* 参数访问 */
+#define RPC_ACCESS_RO         0
+#define RPC_ACCESS_RW         1
+
+/*
+ * 参数表：X(枚举名, 参数号, 类型, 访问, 名称)
+ * 固件按参数号分派到ANGLE_CONTROL_*设置函数，主机客户端用名称表做命令行解析。
+ * 参数号一经发布不再改变含义，删除的参数号不复用。
+ */
+#define RPC_PARAM_TABLE(X) \
+    X(RPC_PARAM_TARGET,       0x0001, RPC_TYPE_F32, RPC_ACCESS_RW, "target")      /* 目标角度(度) */ \
+    X(RPC_PARAM_MODE,         0x0002, RPC_TYPE_U32, RPC_ACCESS_RW, "mode")        /* ControlMode_TypeDef，写入即启动该模式 */ \
+    X(RPC_PARAM_ANGLE,        0x0003, RPC_TYPE_F32, RPC_ACCESS_RO, "angle")       /* 当前角度(度) */ \
+    X(RPC_PARAM_STATE,        0x0004, RPC_TYPE_U32, RPC_ACCESS_RO, "state")       /* AngleState_TypeDef */ \
+    X(RPC_PARAM_KP,           0x0010, RPC_TYPE_F32, RPC_ACCESS_RW, "kp")          \
+    X(RPC_PARAM_KI,           0x0011, RPC_TYPE_F32, RPC_ACCESS_RW, "ki")          \
+    X(RPC_PARAM_KD,           0x0012, RPC_TYPE_F32, RPC_ACCESS_RW, "kd")          \
+    X(RPC_PARAM_FAN_BASE,     0x0020, RPC_TYPE_U32, RPC_ACCESS_RW, "fan_base")    /* 风扇基础速度(%) */ \
+    X(RPC_PARAM_FAN_RATIO,    0x0021, RPC_TYPE_U32, RPC_ACCESS_RW, "fan_ratio")   /* 差速比例(%) */ \
+    X(RPC_PARAM_STABLE_ERROR, 0x0030, RPC_TYPE_F32, RPC_ACCESS_RW, "stable_error") /* 稳定判定误差(度) */ \
+    X(RPC_PARAM_STABLE_TIME,  0x0031, RPC_TYPE_U32, RPC_ACCESS_RW, "stable_time") /* 稳定保持时间(ms) */ \
+    X(RPC_PARAM_EARLY_CONF,   0x0032, RPC_TYPE_F32, RPC_ACCESS_RW, "early_conf")  /* 序列提前稳定置信度(0-1)，大于1禁用 */ \
+    X(RPC_PARAM_ESTIMATOR,    0x0040, RPC_TYPE_U32, RPC_ACCESS_RW, "estimator")   /* 0/1 */ \
+    X(RPC_PARAM_FINE_OUTPUT,  0x0041, RPC_TYPE_U32, RPC_ACCESS_RW, "fine_output") /* 0/1 */ \
+    X(RPC_PARAM_RPM_LOOP,     0x0042, RPC_TYPE_U32, RPC_ACCESS_RW, "rpm_loop")    /* 0/1 */ \
+    X(RPC_PARAM_ALLOCATION,   0x0043, RPC_TYPE_U32, RPC_ACCESS_RW, "allocation")  /* AllocMode_TypeDef */ \
+    X(RPC_PARAM_LOOP_RATE,    0x0050, RPC_TYPE_U32, RPC_ACCESS_RW, "loop_rate")   /* 控制频率(Hz)，全部轴共用，轴号忽略 */
+
+#define RPC_PARAM_ENUM(name, id, type, access, text) name = id,
+typedef enum {
+    RPC_PARAM_TABLE(RPC_PARAM_ENUM)
+    RPC_PARAM_INVALID = 0xFFFF       // 表外参数号
+} RpcParam_TypeDef;
+#undef RPC_PARAM_ENUM
+
+/* 负载布局(字节偏移) */
+
+/* INFO应答 */
+#define RPC_INFO_VERSION      0       // 协议版本(1)
+#define RPC_INFO_AXES         1       // 轴数(1)
+#define RPC_INFO_TICK_US      2       // 控制周期us(2)
+#define RPC_INFO_BODY_MAX     4       // 消息体最大字节数(1)
+#define RPC_INFO_LEN          5
+
+/* SAMPLE应答和STREAM_DATA上报 */
+#define RPC_SAMPLE_TIME       0       // 系统时间ms(4)
+#define RPC_SAMPLE_AXIS       4       // 轴号(1)
+#define RPC_SAMPLE_MODE       5       // 控制模式(1)
+#define RPC_SAMPLE_STATE      6       // 控制状态(1)
+#define RPC_SAMPLE_FAULT      7       // 传感器故障标志(1)
+#define RPC_SAMPLE_TARGET     8       // 目标角度f32
+#define RPC_SAMPLE_ANGLE      12      // 当前角度f32
+#define RPC_SAMPLE_RATE       16      // 角速度f32
+#define RPC_SAMPLE_INPUT      20      // 差速占空比 右-左(%)f32
+#define RPC_SAMPLE_LEN        24
+
+/* SEQUENCE请求(旧接口，更长或带循环/斜坡的程序用PROG_x) */
+#define RPC_SEQ_STEPS_MAX     10      // 与旧的参数存储记录一致
+#define RPC_SEQ_STEP_LEN      5       // 每步:角度f32 保持时间s(1)
+
+/*
+ * 序列指令(PROG_APPEND每步)，字段含义和取值见sequence_engine.h的SeqStep_TypeDef、SEQ_OP_x、SEQ_RAMP_x。
+ * 流式程序边执行边追加：应答的接收步数少于请求时，其余的等剩余空间增加后重发。
+ */
+#define RPC_STEP_OP           0       // 指令(1)
+#define RPC_STEP_FLAGS        1       // 标志(1)
+#define RPC_STEP_VALUE        2       // 角度0.01度/键值/循环次数(i16)
+#define RPC_STEP_TOLERANCE    4       // 允许误差0.01度(2)
+#define RPC_STEP_RATE         6       // 斜坡速率0.1度/秒(2)
+#define RPC_STEP_TIME         8       // 时间ms(4)
+#define RPC_STEP_LEN          12
+#define RPC_PROG_STEPS_MAX    ((RPC_BODY_MAX - 1) / RPC_STEP_LEN)    // 每个PROG_APPEND最多5步
+#define RPC_PROG_UPLOADED     0xFF    // PROG_START程序号：已上传的程序，其余为内置程序SEQ_PROGRAM_x
+
+/* PROG_STATUS应答 */
+#define RPC_PROG_STATE        0       // SeqState_TypeDef(1)
+#define RPC_PROG_PHASE        1       // SeqPhase_TypeDef(1)
+#define RPC_PROG_FREE         2       // 剩余空间(2)
+#define RPC_PROG_PC           4       // 当前步序号(4)
+#define RPC_PROG_LEN          8
+
+#endif /* __RPC_SCHEMA_H */
@@ -0,0 +1,447 @@
+/**
+  ******************************************************************************
+  * @file    sequence_engine.c
+  * @brief   角度序列解释器模块实现
+  ******************************************************************************
+  * 主循环只写ring[]和tail(先写指令再加tail)，控制中断只写执行状态和release，
+  * 各自的32位字段在Cortex-M3上单次读写是原子的，追加步不需要关中断。
+  * SEQ_Clear/SEQ_LoadProgram/SEQ_Start先把状态置为IDLE再修改，中间被控制中断打断时
+  * 解释器不做任何动作。
+  ******************************************************************************
+  */
+
+#include "sequence_engine.h"
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#define SEQ_RING_MASK        (SEQ_RING_SIZE - 1)
+#define SEQ_ANGLE_MIN        -90.0f  // 与ANGLE_CONTROL_SetTarget的限幅一致
+#define SEQ_ANGLE_MAX        90.0f
+#define SEQ_SMOOTH_FACTOR    1.5f    // smoothstep峰值速度为平均速度的1.5倍
+
+/* 内置程序(Flash) */
+static const SeqStep_TypeDef g_seq_demo[] = {
+    {SEQ_OP_MOVE, SEQ_RAMP_STEP, 4500,  0, 0, 3000},
+    {SEQ_OP_MOVE, SEQ_RAMP_STEP, 6000,  0, 0, 3000},
+    {SEQ_OP_MOVE, SEQ_RAMP_STEP, 9000,  0, 0, 3000},
+    {SEQ_OP_MOVE, SEQ_RAMP_STEP, 12000, 0, 0, 3000},
+    {SEQ_OP_MOVE, SEQ_RAMP_STEP, 13500, 0, 0, 3000},
+    {SEQ_OP_END,  0,             0,     0, 0, 0}
+};
+
+static const SeqStep_TypeDef g_seq_sweep[] = {
+    {SEQ_OP_MOVE,     SEQ_RAMP_STEP,   0,    300, 0,   1000},
+    {SEQ_OP_LOOP,     0,               3,    0,   0,   0},
+    {SEQ_OP_MOVE,     SEQ_RAMP_LINEAR, 4000, 500, 100, 500},
+    {SEQ_OP_MOVE,     SEQ_RAMP_SMOOTH, 0,    500, 100, 500},
+    {SEQ_OP_END_LOOP, 0,               0,    0,   0,   0},
+    {SEQ_OP_WAIT_KEY, 0,               0,    0,   0,   30000},
+    {SEQ_OP_MOVE,     SEQ_RAMP_SMOOTH, 3000, 500, 150, 2000},
+    {SEQ_OP_END,      0,               0,    0,   0,   0}
+};
+
+/* 私有函数声明 */
+static uint8_t SEQ_Fetch(SeqEngine_TypeDef *seq);
+static uint8_t SEQ_Begin(SeqEngine_TypeDef *seq, uint32_t now);
+static uint8_t SEQ_Run(SeqEngine_TypeDef *seq, uint32_t now, float angle, uint8_t stable, uint8_t *events);
+static void SEQ_Next(SeqEngine_TypeDef *seq, uint32_t pc);
+static uint8_t SEQ_Fail(SeqEngine_TypeDef *seq);
+
+/**
+  * @brief  初始化解释器，程序为空的RAM缓冲(存储方式)
+  * @param  seq: 解释器结构体指针
+  * @retval 无
+  */
+void SEQ_Init(SeqEngine_TypeDef *seq)
+{
+    memset(seq, 0, sizeof(SeqEngine_TypeDef));
+    seq->state = SEQ_STATE_IDLE;
+    seq->phase = SEQ_PHASE_FETCH;
+}
+
+/**
+  * @brief  清空RAM程序缓冲并停止
+  * @param  seq: 解释器结构体指针
+  * @param  stream: 1流式方式，0存储方式
+  * @retval 无
+  */
+void SEQ_Clear(SeqEngine_TypeDef *seq, uint8_t stream)
+{
+    seq->state = SEQ_STATE_IDLE;
+    seq->program = NULL;
+    seq->program_len = 0;
+    seq->tail = 0;
+    seq->release = 0;
+    seq->pc = 0;
+    seq->stream = stream ? 1 : 0;
+}
+
+/**
+  * @brief  追加一步到RAM程序缓冲
+  * @param  seq: 解释器结构体指针
+  * @param  step: 指令
+  * @retval uint8_t: SEQ_OK/SEQ_FULL/SEQ_INVALID
+  * @note   在主循环中调用，可与控制中断中的SEQ_Update并发
+  */
+uint8_t SEQ_Append(SeqEngine_TypeDef *seq, const SeqStep_TypeDef *step)
+{
+    uint32_t tail = seq->tail;
+
+    if (seq->program != NULL || step->op > SEQ_OP_END_LOOP) return SEQ_INVALID;
+    if (tail - seq->release >= SEQ_RING_SIZE) return SEQ_FULL;
+
+    seq->ring[tail & SEQ_RING_MASK] = *step;
+    seq->tail = tail + 1;    // 指令写完后才对控制中断可见
+    return SEQ_OK;
+}
+
+/**
+  * @brief  RAM程序缓冲剩余可追加的步数
+  * @param  seq: 解释器结构体指针
+  * @retval uint16_t: 步数，Flash程序时为0
+  */
+uint16_t SEQ_Free(SeqEngine_TypeDef *seq)
+{
+    if (seq->program != NULL) return 0;
+    return (uint16_t)(SEQ_RING_SIZE - (seq->tail - seq->release));
+}
+
+/**
+  * @brief  改为执行Flash中的程序
+  * @param  seq: 解释器结构体指针
+  * @param  program: const指令数组
+  * @param  len: 步数
+  * @retval 无
+  */
+void SEQ_LoadProgram(SeqEngine_TypeDef *seq, const SeqStep_TypeDef *program, uint32_t len)
+{
+    seq->state = SEQ_STATE_IDLE;
+    seq->tail = 0;
+    seq->release = 0;
+    seq->pc = 0;
+    seq->stream = 0;
+    seq->program_len = len;
+    seq->program = program;
+}
+
+/**
+  * @brief  取内置程序
+  * @param  id: SEQ_PROGRAM_x
+  * @param  len: 返回步数
+  * @retval const SeqStep_TypeDef*: 程序，id无效时为NULL
+  */
+const SeqStep_TypeDef *SEQ_GetBuiltin(uint8_t id, uint32_t *len)
+{
+    switch (id) {
+        case SEQ_PROGRAM_DEMO:
+            *len = sizeof(g_seq_demo) / sizeof(g_seq_demo[0]);
+            return g_seq_demo;
+        case SEQ_PROGRAM_SWEEP:
+            *len = sizeof(g_seq_sweep) / sizeof(g_seq_sweep[0]);
+            return g_seq_sweep;
+        default:
+            *len = 0;
+            return NULL;
+    }
+}
+
+/**
+  * @brief  判断当前程序是否为空
+  * @param  seq: 解释器结构体指针
+  * @retval uint8_t: 1为空
+  */
+uint8_t SEQ_IsEmpty(SeqEngine_TypeDef *seq)
+{
+    if (seq->program != NULL) return (seq->program_len == 0) ? 1 : 0;
+    return (seq->tail == 0) ? 1 : 0;
+}
+
+/**
+  * @brief  从第一步开始运行
+  * @param  seq: 解释器结构体指针
+  * @param  now: 当前时间(ms)
+  * @param  setpoint: 当前设定值(度)，第一步斜坡的起点
+  * @retval uint8_t: 1成功，0程序为空或流式程序已释放了开头
+  */
+uint8_t SEQ_Start(SeqEngine_TypeDef *seq, uint32_t now, float setpoint)
+{
+    seq->state = SEQ_STATE_IDLE;
+    if (SEQ_IsEmpty(seq) || seq->release != 0) return 0;
+
+    seq->pc = 0;
+    seq->phase = SEQ_PHASE_FETCH;
+    seq->depth = 0;
+    seq->step_start = now;
+    seq->ramp_time = 0;
+    seq->from = setpoint;
+    seq->target = setpoint;
+    seq->setpoint = setpoint;
+    seq->key = 0;
+    seq->state = SEQ_STATE_RUNNING;
+    return 1;
+}
+
+/**
+  * @brief  停止运行
+  * @param  seq: 解释器结构体指针
+  * @retval 无
+  * @note   已完成或出错的状态保留，供查询
+  */
+void SEQ_Stop(SeqEngine_TypeDef *seq)
+{
+    if (seq->state == SEQ_STATE_RUNNING || seq->state == SEQ_STATE_STARVED) {
+        seq->state = SEQ_STATE_IDLE;
+    }
+}
+
+/**
+  * @brief  输入按键，只对等待中的WAIT_KEY有效
+  * @param  seq: 解释器结构体指针
+  * @param  key: 键值(非0)
+  * @retval 无
+  */
+void SEQ_Key(SeqEngine_TypeDef *seq, uint8_t key)
+{
+    if (seq->state == SEQ_STATE_RUNNING && seq->phase == SEQ_PHASE_KEY) {
+        seq->key = key;
+    }
+}
+
+/**
+  * @brief  推进一个控制周期
+  * @param  seq: 解释器结构体指针
+  * @param  now: 当前时间(ms)
+  * @param  angle: 当前角度(度)
+  * @param  stable: 1表示本轴稳定判定已确认稳定(允许误差为0的MOVE使用)
+  * @retval uint8_t: 本周期发生的事件(SEQ_EVENT_x)，设定值在seq->setpoint
+  * @note   在控制中断中调用
+  */
+uint8_t SEQ_Update(SeqEngine_TypeDef *seq, uint32_t now, float angle, uint8_t stable)
+{
+    uint8_t events = 0;
+    uint8_t ops;
+
+    if (seq->state == SEQ_STATE_STARVED) {
+        /* 后续步到达后从原处继续 */
+        if (seq->pc >= seq->tail) return 0;
+        seq->state = SEQ_STATE_RUNNING;
+    }
+    if (seq->state != SEQ_STATE_RUNNING) return 0;
+
+    for (ops = 0; ops < SEQ_OPS_PER_TICK; ops++) {
+        if (seq->phase == SEQ_PHASE_FETCH) {
+            events |= SEQ_Begin(seq, now);
+            if (seq->state != SEQ_STATE_RUNNING) break;
+            if (seq->phase == SEQ_PHASE_FETCH) continue;    // 不耗时的指令，继续下一条
+        }
+        if (!SEQ_Run(seq, now, angle, stable, &events)) break;
+    }
+
+    return events;
+}
+
+/**
+  * @brief  取当前步到seq->step
+  * @param  seq: 解释器结构体指针
+  * @retval uint8_t: 1取到，0没有可执行的步(状态已更新)
+  * @note   私有函数
+  */
+static uint8_t SEQ_Fetch(SeqEngine_TypeDef *seq)
+{
+    uint32_t pc = seq->pc;
+
+    if (seq->program != NULL) {
+        if (pc < seq->program_len) {
+            seq->step = seq->program[pc];
+            return 1;
+        }
+    } else if (pc < seq->tail) {
+        seq->step = seq->ring[pc & SEQ_RING_MASK];
+        return 1;
+    } else if (seq->stream) {
+        /* 缓冲已满却等不到下一步：循环体比缓冲长，永远无法追加 */
+        if (seq->tail - seq->release >= SEQ_RING_SIZE) {
+            SEQ_Fail(seq);
+            return 0;
+        }
+        seq->state = SEQ_STATE_STARVED;
+        return 0;
+    }
+
+    /* 程序末尾没有END，按END处理 */
+    seq->step.op = SEQ_OP_END;
+    return 1;
+}
+
+/**
+  * @brief  取下一步并开始执行
+  * @param  seq: 解释器结构体指针
+  * @param  now: 当前时间(ms)
+  * @retval uint8_t: 事件
+  * @note   私有函数。不耗时的指令在这里执行完，阶段保持为FETCH
+  */
+static uint8_t SEQ_Begin(SeqEngine_TypeDef *seq, uint32_t now)
+{
+    SeqStep_TypeDef *step = &seq->step;
+    SeqLoop_TypeDef *loop;
+    float distance;
+
+    if (!SEQ_Fetch(seq)) {
+        return (seq->state == SEQ_STATE_STARVED) ? SEQ_EVENT_STARVED : SEQ_EVENT_ERROR;
+    }
+
+    seq->step_start = now;
+    switch (step->op) {
+        case SEQ_OP_END:
+            seq->state = SEQ_STATE_DONE;
+            return SEQ_EVENT_DONE;
+
+        case SEQ_OP_MOVE:
+            seq->from = seq->setpoint;
+            seq->target = step->value * 0.01f;
+            if (seq->target > SEQ_ANGLE_MAX) seq->target = SEQ_ANGLE_MAX;
+            if (seq->target < SEQ_ANGLE_MIN) seq->target = SEQ_ANGLE_MIN;
+
+            distance = fabsf(seq->target - seq->from);
+            if ((step->flags & SEQ_RAMP_MASK) == SEQ_RAMP_STEP || step->rate == 0 || distance < 0.01f) {
+                seq->setpoint = seq->target;
+                seq->phase = (step->flags & SEQ_FLAG_NO_SETTLE) ? SEQ_PHASE_HOLD : SEQ_PHASE_SETTLE;
+            } else {
+                /* 斜坡时长 = 距离 / 速率，平滑斜坡峰值速度为rate */
+                seq->ramp_time = (uint32_t)(distance * 10000.0f / step->rate);
+                if ((step->flags & SEQ_RAMP_MASK) == SEQ_RAMP_SMOOTH) {
+                    seq->ramp_time = (uint32_t)(seq->ramp_time * SEQ_SMOOTH_FACTOR);
+                }
+                seq->phase = SEQ_PHASE_RAMP;
+            }
+            return SEQ_EVENT_MOVE;
+
+        case SEQ_OP_DELAY:
+            seq->phase = SEQ_PHASE_HOLD;
+            return 0;
+
+        case SEQ_OP_WAIT_KEY:
+            seq->key = 0;    // 进入等待之前的按键不算
+            seq->phase = SEQ_PHASE_KEY;
+            return SEQ_EVENT_KEY;
+
+        case SEQ_OP_LOOP:
+            if (seq->depth >= SEQ_LOOP_DEPTH) return SEQ_Fail(seq);
+            loop = &seq->loops[seq->depth++];
+            loop->start = seq->pc + 1;
+            loop->remaining = (step->value > 0) ? (uint16_t)step->value : 0;
+            SEQ_Next(seq, seq->pc + 1);
+            return 0;
+
+        case SEQ_OP_END_LOOP:
+            if (seq->depth == 0) return SEQ_Fail(seq);
+            loop = &seq->loops[seq->depth - 1];
+            if (loop->remaining != 0 && --loop->remaining == 0) {
+                seq->depth--;
+                SEQ_Next(seq, seq->pc + 1);
+            } else {
+                SEQ_Next(seq, loop->start);
+            }
+            return 0;
+
+        default:
+            return SEQ_Fail(seq);
+    }
+}
+
+/**
+  * @brief  执行当前步的一个周期
+  * @param  seq: 解释器结构体指针
+  * @param  now: 当前时间(ms)
+  * @param  angle: 当前角度(度)
+  * @param  stable: 本轴稳定判定结果
+  * @param  events: 事件累加
+  * @retval uint8_t: 1当前步已完成，0继续等待
+  * @note   私有函数
+  */
+static uint8_t SEQ_Run(SeqEngine_TypeDef *seq, uint32_t now, float angle, uint8_t stable, uint8_t *events)
+{
+    SeqStep_TypeDef *step = &seq->step;
+    uint32_t elapsed = now - seq->step_start;
+    uint8_t in_band;
+    float t;
+
+    switch (seq->phase) {
+        case SEQ_PHASE_RAMP:
+            if (elapsed < seq->ramp_time) {
+                t = (float)elapsed / (float)seq->ramp_time;
+                if ((step->flags & SEQ_RAMP_MASK) == SEQ_RAMP_SMOOTH) {
+                    t = t * t * (3.0f - 2.0f * t);
+                }
+                seq->setpoint = seq->from + (seq->target - seq->from) * t;
+                return 0;
+            }
+            seq->setpoint = seq->target;
+            seq->step_start = now;
+            seq->phase = (step->flags & SEQ_FLAG_NO_SETTLE) ? SEQ_PHASE_HOLD : SEQ_PHASE_SETTLE;
+            *events |= SEQ_EVENT_RAMP_END;
+            return 0;    // 斜坡结束的周期由调用者重设目标，下周期再判定
+
+        case SEQ_PHASE_SETTLE:
+        case SEQ_PHASE_HOLD:
+            if (step->op == SEQ_OP_MOVE && !(step->flags & SEQ_FLAG_NO_SETTLE)) {
+                in_band = (step->tolerance == 0) ? stable :
+                          (fabsf(angle - seq->target) <= step->tolerance * 0.01f);
+                if (!in_band) {
+                    /* 未到达(或保持中偏离)，保持时间重新计算 */
+                    seq->phase = SEQ_PHASE_SETTLE;
+                    return 0;
+                }
+                if (seq->phase == SEQ_PHASE_SETTLE) {
+                    seq->phase = SEQ_PHASE_HOLD;
+                    seq->step_start = now;
+                    elapsed = 0;
+                    *events |= SEQ_EVENT_HOLD;
+                }
+            }
+            if (elapsed < step->time) return 0;
+            break;
+
+        case SEQ_PHASE_KEY:
+            if (seq->key == 0 || (step->value != 0 && seq->key != step->value)) {
+                seq->key = 0;
+                if (step->time == 0 || elapsed < step->time) return 0;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    SEQ_Next(seq, seq->pc + 1);
+    return 1;
+}
+
+/**
+  * @brief  跳到指定步，流式方式下释放之前的步
+  * @param  seq: 解释器结构体指针
+  * @param  pc: 下一步序号
+  * @retval 无
+  * @note   私有函数。循环中最外层循环体要保留到循环结束
+  */
+static void SEQ_Next(SeqEngine_TypeDef *seq, uint32_t pc)
+{
+    seq->pc = pc;
+    seq->phase = SEQ_PHASE_FETCH;
+    if (seq->stream) {
+        seq->release = (seq->depth > 0 && seq->loops[0].start < pc) ? seq->loops[0].start : pc;
+    }
+}
+
+/**
+  * @brief  程序错误，停止执行
+  * @param  seq: 解释器结构体指针
+  * @retval uint8_t: SEQ_EVENT_ERROR
+  * @note   私有函数
+  */
+static uint8_t SEQ_Fail(SeqEngine_TypeDef *seq)
+{
+    seq->state = SEQ_STATE_ERROR;
+    return SEQ_EVENT_ERROR;
+}
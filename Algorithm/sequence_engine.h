@@ -0,0 +1,228 @@
+/**
+  ******************************************************************************
+  * @file    sequence_engine.h
+  * @brief   角度序列解释器模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __SEQUENCE_ENGINE_H
+#define __SEQUENCE_ENGINE_H
+
+#include "stm32f10x.h"
+
+/*
+ * 序列程序是定长12字节指令的线性表，由控制中断每周期推进一次：
+ *   MOVE      移到目标角度：可选斜坡(阶跃/匀速/平滑)，到达允许误差后保持time毫秒
+ *   DELAY     保持当前设定值time毫秒
+ *   WAIT_KEY  等待按键(value=键值，0为任意键)，time不为0时超时后继续
+ *   LOOP      循环开始，value为总次数(0为无限)，最多嵌套SEQ_LOOP_DEPTH层
+ *   END_LOOP  循环结束，回到对应LOOP之后
+ *   END       程序结束
+ *
+ * 程序来源两种：
+ *   Flash表  const数组，长度不限，SEQ_LoadProgram指定，见SEQ_GetBuiltin
+ *   RAM缓冲  SEQ_RING_SIZE步的环形缓冲，主循环用SEQ_Append追加：
+ *            存储方式整段程序放在缓冲内，可反复启动、可保存到参数存储；
+ *            流式方式已执行完的步随即释放，边执行边追加，总长度不限，
+ *            缓冲满时SEQ_Append返回SEQ_FULL，由上位机稍后重发(背压)；
+ *            执行到尚未到达的步时为STARVED状态，保持当前设定值等待。
+ * 流式方式下最外层循环的起点之后的步不能释放，循环体须小于缓冲长度。
+ *
+ * 每周期的计算量与程序长度无关：当前步的判定为O(1)，
+ * 不耗时的指令(LOOP/END_LOOP等)每周期最多连续执行SEQ_OPS_PER_TICK条，
+ * 只含这类指令的无限循环也不会卡住控制中断。
+ */
+
+#ifndef SEQ_RING_SIZE
+#define SEQ_RING_SIZE        32      // RAM程序缓冲步数(2的幂)，3轴时参数存储只容得下8
+#endif
+#define SEQ_LOOP_DEPTH       4       // 循环最大嵌套层数
+#define SEQ_OPS_PER_TICK     8       // 每周期最多执行的指令条数
+
+/* 指令 */
+#define SEQ_OP_END           0
+#define SEQ_OP_MOVE          1
+#define SEQ_OP_DELAY         2
+#define SEQ_OP_WAIT_KEY      3
+#define SEQ_OP_LOOP          4
+#define SEQ_OP_END_LOOP      5
+
+/* MOVE标志 */
+#define SEQ_RAMP_STEP        0x00    // 目标阶跃
+#define SEQ_RAMP_LINEAR      0x01    // 设定值匀速移动
+#define SEQ_RAMP_SMOOTH      0x02    // 设定值按smoothstep移动，峰值速度为rate
+#define SEQ_RAMP_MASK        0x03
+#define SEQ_FLAG_NO_SETTLE   0x04    // 不等到达，斜坡结束后只保持time毫秒(连续轨迹用)
+
+/* 序列指令，12字节，各字段含义随指令而定 */
+typedef struct {
+    uint8_t op;                  // SEQ_OP_x
+    uint8_t flags;               // MOVE: SEQ_RAMP_x | SEQ_FLAG_x
+    int16_t value;               // MOVE: 目标角度(0.01度)；WAIT_KEY: 键值；LOOP: 次数
+    uint16_t tolerance;          // MOVE: 允许误差(0.01度)，0表示使用本轴稳定判定
+    uint16_t rate;               // MOVE: 斜坡速率(0.1度/秒)，0表示阶跃
+    uint32_t time;               // MOVE: 保持时间；DELAY: 延时；WAIT_KEY: 超时，0不超时(ms)
+} SeqStep_TypeDef;
+
+/* 解释器状态 */
+typedef enum {
+    SEQ_STATE_IDLE = 0,          // 未运行
+    SEQ_STATE_RUNNING = 1,       // 运行中
+    SEQ_STATE_STARVED = 2,       // 流式程序等待后续步
+    SEQ_STATE_DONE = 3,          // 已完成
+    SEQ_STATE_ERROR = 4          // 程序错误(未知指令、循环不匹配、循环体超出缓冲)
+} SeqState_TypeDef;
+
+/* 当前步的阶段 */
+typedef enum {
+    SEQ_PHASE_FETCH = 0,         // 取下一步
+    SEQ_PHASE_RAMP = 1,          // MOVE斜坡中
+    SEQ_PHASE_SETTLE = 2,        // MOVE等待进入允许误差
+    SEQ_PHASE_HOLD = 3,          // MOVE保持/DELAY计时
+    SEQ_PHASE_KEY = 4            // 等待按键
+} SeqPhase_TypeDef;
+
+/* SEQ_Update返回的事件 */
+#define SEQ_EVENT_MOVE       0x01    // 开始新的MOVE，target为终点
+#define SEQ_EVENT_HOLD       0x02    // MOVE到达，开始保持
+#define SEQ_EVENT_RAMP_END   0x04    // 斜坡结束，设定值到达终点
+#define SEQ_EVENT_DONE       0x08    // 程序完成
+#define SEQ_EVENT_STARVED    0x10    // 进入等待后续步
+#define SEQ_EVENT_ERROR      0x20    // 程序错误
+#define SEQ_EVENT_KEY        0x40    // 开始等待按键
+
+/* SEQ_Append返回值 */
+#define SEQ_OK               0
+#define SEQ_FULL             1       // 缓冲已满，稍后重试
+#define SEQ_INVALID          2       // 指令无效，或当前为Flash程序
+
+/* 内置程序 */
+#define SEQ_PROGRAM_DEMO     0       // 45/60/90/120/135度各保持3秒(超出范围的角度按90度执行)
+#define SEQ_PROGRAM_SWEEP    1       // 0~40度往返3次，按键(或30秒)后平滑移到30度
+#define SEQ_PROGRAM_COUNT    2
+
+/* 循环栈项 */
+typedef struct {
+    uint32_t start;              // 循环体第一步的序号
+    uint16_t remaining;          // 剩余次数，0为无限
+} SeqLoop_TypeDef;
+
+/* 解释器结构体 */
+typedef struct {
+    /* 程序来源 */
+    const SeqStep_TypeDef *program; // Flash程序，NULL表示使用RAM缓冲
+    uint32_t program_len;           // Flash程序步数
+    SeqStep_TypeDef ring[SEQ_RING_SIZE]; // RAM程序缓冲，第n步在ring[n % SEQ_RING_SIZE]
+    volatile uint32_t tail;      // 已追加的步数(主循环写)
+    volatile uint32_t release;   // 此序号之前的步已可覆盖(控制中断写，仅流式)
+    uint8_t stream;              // 1: 流式方式
+
+    /* 执行状态(控制中断写) */
+    volatile SeqState_TypeDef state; // 解释器状态
+    SeqPhase_TypeDef phase;      // 当前步阶段
+    volatile uint32_t pc;        // 当前步序号
+    SeqStep_TypeDef step;        // 当前步副本
+    SeqLoop_TypeDef loops[SEQ_LOOP_DEPTH]; // 循环栈
+    uint8_t depth;               // 循环嵌套层数
+    uint32_t step_start;         // 当前阶段开始时间(ms)
+    uint32_t ramp_time;          // 斜坡时长(ms)
+    float from;                  // 斜坡起点(度)
+    float target;                // 当前MOVE终点(度)
+    float setpoint;              // 本周期设定值(度)
+    volatile uint8_t key;        // 待处理按键，0为无
+} SeqEngine_TypeDef;
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化解释器，程序为空的RAM缓冲(存储方式)
+  * @param  seq: 解释器结构体指针
+  * @retval 无
+  */
+void SEQ_Init(SeqEngine_TypeDef *seq);
+
+/**
+  * @brief  清空RAM程序缓冲并停止
+  * @param  seq: 解释器结构体指针
+  * @param  stream: 1流式方式，0存储方式
+  * @retval 无
+  */
+void SEQ_Clear(SeqEngine_TypeDef *seq, uint8_t stream);
+
+/**
+  * @brief  追加一步到RAM程序缓冲
+  * @param  seq: 解释器结构体指针
+  * @param  step: 指令
+  * @retval uint8_t: SEQ_OK/SEQ_FULL/SEQ_INVALID
+  * @note   在主循环中调用，可与控制中断中的SEQ_Update并发
+  */
+uint8_t SEQ_Append(SeqEngine_TypeDef *seq, const SeqStep_TypeDef *step);
+
+/**
+  * @brief  RAM程序缓冲剩余可追加的步数
+  * @param  seq: 解释器结构体指针
+  * @retval uint16_t: 步数，Flash程序时为0
+  */
+uint16_t SEQ_Free(SeqEngine_TypeDef *seq);
+
+/**
+  * @brief  改为执行Flash中的程序
+  * @param  seq: 解释器结构体指针
+  * @param  program: const指令数组
+  * @param  len: 步数
+  * @retval 无
+  */
+void SEQ_LoadProgram(SeqEngine_TypeDef *seq, const SeqStep_TypeDef *program, uint32_t len);
+
+/**
+  * @brief  取内置程序
+  * @param  id: SEQ_PROGRAM_x
+  * @param  len: 返回步数
+  * @retval const SeqStep_TypeDef*: 程序，id无效时为NULL
+  */
+const SeqStep_TypeDef *SEQ_GetBuiltin(uint8_t id, uint32_t *len);
+
+/**
+  * @brief  判断当前程序是否为空
+  * @param  seq: 解释器结构体指针
+  * @retval uint8_t: 1为空
+  */
+uint8_t SEQ_IsEmpty(SeqEngine_TypeDef *seq);
+
+/**
+  * @brief  从第一步开始运行
+  * @param  seq: 解释器结构体指针
+  * @param  now: 当前时间(ms)
+  * @param  setpoint: 当前设定值(度)，第一步斜坡的起点
+  * @retval uint8_t: 1成功，0程序为空或流式程序已释放了开头
+  */
+uint8_t SEQ_Start(SeqEngine_TypeDef *seq, uint32_t now, float setpoint);
+
+/**
+  * @brief  停止运行
+  * @param  seq: 解释器结构体指针
+  * @retval 无
+  * @note   已完成或出错的状态保留，供查询
+  */
+void SEQ_Stop(SeqEngine_TypeDef *seq);
+
+/**
+  * @brief  输入按键，只对等待中的WAIT_KEY有效
+  * @param  seq: 解释器结构体指针
+  * @param  key: 键值(非0)
+  * @retval 无
+  */
+void SEQ_Key(SeqEngine_TypeDef *seq, uint8_t key);
+
+/**
+  * @brief  推进一个控制周期
+  * @param  seq: 解释器结构体指针
+  * @param  now: 当前时间(ms)
+  * @param  angle: 当前角度(度)
+  * @param  stable: 1表示本轴稳定判定已确认稳定(允许误差为0的MOVE使用)
+  * @retval uint8_t: 本周期发生的事件(SEQ_EVENT_x)，设定值在seq->setpoint
+  * @note   在控制中断中调用
+  */
+uint8_t SEQ_Update(SeqEngine_TypeDef *seq, uint32_t now, float angle, uint8_t stable);
+
+#endif /* __SEQUENCE_ENGINE_H */
@@ -0,0 +1,622 @@
+/**
+  ******************************************************************************
+  * @file    shell.c
+  * @brief   串口命令行模块实现
+  ******************************************************************************
+  * 命令表为const，放在Flash中；C90不能在编译期对字符串求散列，
+  * 散列索引(每槽1字节命令号)在SHELL_Init中建立一次，查找为一次散列加一次strcmp。
+  ******************************************************************************
+  */
+
+#include "shell.h"
+#include "usart.h"
+#include "telemetry.h"
+#include "recorder.h"
+#include "rpc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 命令处理函数：argv[0]为命令名，返回0时打印用法 */
+typedef uint8_t (*ShellHandler_TypeDef)(uint8_t argc, char **argv);
+
+/* 命令表项 */
+typedef struct {
+    const char *name;            // 命令名
+    ShellHandler_TypeDef handler; // 处理函数
+    uint8_t argc_min;            // 最少参数数(含命令名)
+    uint8_t argc_max;            // 最多参数数(含命令名)
+    const char *usage;           // 用法
+} ShellCommand_TypeDef;
+
+/* 私有函数声明 */
+static uint8_t SHELL_CmdHelp(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdAxis(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdStatus(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdTarget(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdMode(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdPid(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdFan(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdSeq(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdProg(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdStop(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdRate(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdSave(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdCal(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdProf(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdTele(uint8_t argc, char **argv);
+static uint8_t SHELL_CmdRec(uint8_t argc, char **argv);
+static uint32_t SHELL_Hash(const char *s);
+static int8_t SHELL_Find(const char *name);
+static uint8_t SHELL_ParseFloat(const char *s, float *value);
+static uint8_t SHELL_ParseUint(const char *s, uint32_t max, uint32_t *value);
+
+/* 命令表 */
+static const ShellCommand_TypeDef g_shell_commands[] = {
+    {"help",   SHELL_CmdHelp,   1, 1,  "help"},
+    {"axis",   SHELL_CmdAxis,   1, 2,  "axis [n]"},
+    {"status", SHELL_CmdStatus, 1, 1,  "status"},
+    {"target", SHELL_CmdTarget, 2, 2,  "target <deg>"},
+    {"mode",   SHELL_CmdMode,   2, 2,  "mode <idle|single|dual|seq|mpc>"},
+    {"pid",    SHELL_CmdPid,    1, 4,  "pid [kp ki kd]"},
+    {"fan",    SHELL_CmdFan,    3, 3,  "fan <base%> <ratio%>"},
+    {"seq",    SHELL_CmdSeq,    2, SHELL_ARGC_MAX, "seq <deg> <hold_s> [...] | seq start"},
+    {"prog",   SHELL_CmdProg,   2, 7,  "prog clear [stream]|move <deg> <tol> <hold_ms> [dps lin|smooth|cont]|delay <ms>|"
+                                       "wait [key] [ms]|loop <n>|endloop|end|start [builtin]|key <k>|status"},
+    {"stop",   SHELL_CmdStop,   1, 1,  "stop"},
+    {"rate",   SHELL_CmdRate,   2, 2,  "rate <hz>"},
+    {"save",   SHELL_CmdSave,   1, 1,  "save"},
+    {"cal",    SHELL_CmdCal,    2, 3,  "cal zero|begin|point <deg>|finish|reset|save"},
+    {"prof",   SHELL_CmdProf,   1, 2,  "prof [reset]"},
+    {"tele",   SHELL_CmdTele,   2, 6,  "tele off|all|<ctl sid pwr tim> [period_ms]"},
+    {"rec",    SHELL_CmdRec,    2, 2,  "rec start|stop"}
+};
+
+#define SHELL_COMMAND_COUNT   (sizeof(g_shell_commands) / sizeof(g_shell_commands[0]))
+
+/* 模式名，下标为ControlMode_TypeDef */
+static const char *const g_shell_mode_names[] = {"idle", "single", "dual", "seq", "mpc"};
+
+/* 私有变量 */
+static AngleControl_TypeDef *g_shell_controls = NULL;      // 各轴控制结构体
+static uint8_t g_shell_count = 0;                          // 轴数
+static uint8_t g_shell_axis = 0;                           // 当前轴
+static uint8_t g_shell_index[SHELL_HASH_SIZE];             // 散列槽，命令号+1，0为空
+
+/**
+  * @brief  初始化命令行
+  * @param  controls: 角度控制结构体数组，数组下标即轴号
+  * @param  count: 轴数
+  * @retval 无
+  */
+void SHELL_Init(AngleControl_TypeDef *controls, uint8_t count)
+{
+    uint8_t i, slot;
+
+    g_shell_controls = controls;
+    g_shell_count = count;
+    g_shell_axis = 0;
+
+    /* 开放寻址，冲突时线性探测 */
+    memset(g_shell_index, 0, sizeof(g_shell_index));
+    for (i = 0; i < SHELL_COMMAND_COUNT; i++) {
+        slot = (uint8_t)(SHELL_Hash(g_shell_commands[i].name) & (SHELL_HASH_SIZE - 1));
+        while (g_shell_index[slot] != 0) {
+            slot = (slot + 1) & (SHELL_HASH_SIZE - 1);
+        }
+        g_shell_index[slot] = i + 1;
+    }
+}
+
+/**
+  * @brief  处理串口收到的命令行
+  * @param  无
+  * @retval 无
+  * @note   在主循环中调用，不要在中断中调用。依次执行接收缓冲中已到达的全部行，
+  *         批量上传时每次主循环不止处理一行；完成标志置位期间不会组装下一行，可直接在缓冲内切分
+  */
+void SHELL_Process(void)
+{
+    uint16_t len;
+    uint8_t event;
+
+    while ((event = USART_RxService()) != USART_RX_EV_NONE) {
+        if (event == USART_RX_EV_FRAME) {
+            RPC_Handle(USART_RX_FRAME, USART_RX_FRAME_STA & 0x1FFF);
+            USART_RX_FRAME_STA = 0;
+            continue;
+        }
+        len = USART_RX_STA & 0x3FFF;
+        USART_RX_BUF[len] = '\0';    // 行长最多USART_REC_LEN-1字节，末字节总是空闲
+        SHELL_Execute((char *)USART_RX_BUF);
+        USART_RX_STA = 0;
+    }
+}
+
+/**
+  * @brief  执行一行命令
+  * @param  line: 以'\0'结尾的命令行，原地切分，内容会被修改
+  * @retval uint8_t: 1成功，0命令未知或参数错误
+  */
+uint8_t SHELL_Execute(char *line)
+{
+    char *argv[SHELL_ARGC_MAX];
+    uint8_t argc = 0;
+    int8_t index;
+    const ShellCommand_TypeDef *cmd;
+
+    if (g_shell_controls == NULL) return 0;
+
+    /* 原地切分：分隔符替换为'\0'，argv指向缓冲内的各参数 */
+    while (*line != '\0') {
+        while (*line == ' ' || *line == '\t' || *line == '\r' || *line == '\n') {
+            *line++ = '\0';
+        }
+        if (*line == '\0') break;
+        if (argc == SHELL_ARGC_MAX) {
+            printf("Error: too many arguments\r\n");
+            return 0;
+        }
+        argv[argc++] = line;
+        while (*line != '\0' && *line != ' ' && *line != '\t' && *line != '\r' && *line != '\n') {
+            line++;
+        }
+    }
+    if (argc == 0) return 1;
+
+    index = SHELL_Find(argv[0]);
+    if (index < 0) {
+        printf("Unknown command: %s (try help)\r\n", argv[0]);
+        return 0;
+    }
+
+    cmd = &g_shell_commands[index];
+    if (argc < cmd->argc_min || argc > cmd->argc_max || !cmd->handler(argc, argv)) {
+        printf("Usage: %s\r\n", cmd->usage);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief  列出命令
+  */
+static uint8_t SHELL_CmdHelp(uint8_t argc, char **argv)
+{
+    uint8_t i;
+
+    for (i = 0; i < SHELL_COMMAND_COUNT; i++) {
+        printf("  %s\r\n", g_shell_commands[i].usage);
+    }
+    return 1;
+}
+
+/**
+  * @brief  查看/切换当前轴
+  */
+static uint8_t SHELL_CmdAxis(uint8_t argc, char **argv)
+{
+    uint32_t axis;
+
+    if (argc == 2) {
+        if (!SHELL_ParseUint(argv[1], g_shell_count - 1, &axis)) return 0;
+        g_shell_axis = (uint8_t)axis;
+    }
+    printf("Axis %d of %d\r\n", g_shell_axis, g_shell_count);
+    return 1;
+}
+
+/**
+  * @brief  当前轴状态
+  */
+static uint8_t SHELL_CmdStatus(uint8_t argc, char **argv)
+{
+    AngleControl_TypeDef *control = &g_shell_controls[g_shell_axis];
+    u32 overruns, long_lines;
+
+    printf("Axis %d: mode %s, state %d, target %.1f, angle %.2f, input %.1f\r\n", g_shell_axis,
+           (control->mode <= CONTROL_MODE_DUAL_FAN_MPC) ? g_shell_mode_names[control->mode] : "?",
+           control->state, control->target_angle, control->current_angle, control->applied_input);
+    printf("  PID %.3f/%.3f/%.3f, fan base %d%% ratio %d%%, stable %.1f deg %u ms\r\n",
+           control->pid.Kp, control->pid.Ki, control->pid.Kd, control->fan_base_speed,
+           control->dual_mode_ratio, control->allowed_error, control->stable_time);
+    printf("  estimator %d, fine output %d, rpm loop %d, sensor fault 0x%02X\r\n",
+           control->use_estimator, control->fine_output, control->rpm_loop, control->sensor_fault);
+    USART_RxGetErrors(&overruns, &long_lines);
+    printf("  uart rx overruns %lu, long lines %lu\r\n", (unsigned long)overruns, (unsigned long)long_lines);
+    return 1;
+}
+
+/**
+  * @brief  设置目标角度
+  */
+static uint8_t SHELL_CmdTarget(uint8_t argc, char **argv)
+{
+    float angle;
+
+    if (!SHELL_ParseFloat(argv[1], &angle)) return 0;
+    ANGLE_CONTROL_SetTarget(&g_shell_controls[g_shell_axis], angle);
+    return 1;
+}
+
+/**
+  * @brief  设置控制模式
+  */
+static uint8_t SHELL_CmdMode(uint8_t argc, char **argv)
+{
+    uint8_t i;
+
+    for (i = 0; i <= CONTROL_MODE_DUAL_FAN_MPC; i++) {
+        if (strcmp(argv[1], g_shell_mode_names[i]) == 0) {
+            ANGLE_CONTROL_SetMode(&g_shell_controls[g_shell_axis], (ControlMode_TypeDef)i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+  * @brief  查看/设置PID参数
+  */
+static uint8_t SHELL_CmdPid(uint8_t argc, char **argv)
+{
+    AngleControl_TypeDef *control = &g_shell_controls[g_shell_axis];
+    float kp, ki, kd;
+
+    if (argc == 1) {
+        printf("PID Kp=%.3f Ki=%.3f Kd=%.3f\r\n", control->pid.Kp, control->pid.Ki, control->pid.Kd);
+        return 1;
+    }
+    if (argc != 4 || !SHELL_ParseFloat(argv[1], &kp) || !SHELL_ParseFloat(argv[2], &ki) ||
+        !SHELL_ParseFloat(argv[3], &kd)) {
+        return 0;
+    }
+    ANGLE_CONTROL_SetPID(control, kp, ki, kd);
+    return 1;
+}
+
+/**
+  * @brief  设置风扇参数
+  */
+static uint8_t SHELL_CmdFan(uint8_t argc, char **argv)
+{
+    uint32_t base, ratio;
+
+    if (!SHELL_ParseUint(argv[1], 100, &base) || !SHELL_ParseUint(argv[2], 100, &ratio)) return 0;
+    ANGLE_CONTROL_SetFanParameters(&g_shell_controls[g_shell_axis], (uint8_t)base, (uint8_t)ratio);
+    return 1;
+}
+
+/**
+  * @brief  配置/开始角度序列
+  */
+static uint8_t SHELL_CmdSeq(uint8_t argc, char **argv)
+{
+    float angles[10];
+    uint8_t holds[10];
+    uint32_t hold;
+    uint8_t i, count;
+
+    if (argc == 2 && strcmp(argv[1], "start") == 0) {
+        ANGLE_CONTROL_StartSequence(&g_shell_controls[g_shell_axis]);
+        return 1;
+    }
+
+    /* 参数为角度/保持时间对 */
+    if ((argc - 1) % 2 != 0 || (argc - 1) / 2 > 10) return 0;
+    count = (argc - 1) / 2;
+    for (i = 0; i < count; i++) {
+        if (!SHELL_ParseFloat(argv[1 + 2 * i], &angles[i]) || !SHELL_ParseUint(argv[2 + 2 * i], 255, &hold)) {
+            return 0;
+        }
+        holds[i] = (uint8_t)hold;
+    }
+    return ANGLE_CONTROL_ConfigSequence(&g_shell_controls[g_shell_axis], angles, holds, count);
+}
+
+/**
+  * @brief  编辑/运行序列程序
+  */
+static uint8_t SHELL_CmdProg(uint8_t argc, char **argv)
+{
+    AngleControl_TypeDef *control = &g_shell_controls[g_shell_axis];
+    SeqEngine_TypeDef *seq = &control->sequence;
+    SeqStep_TypeDef step;
+    float angle, tolerance, rate;
+    uint32_t value, time;
+    uint8_t result;
+
+    memset(&step, 0, sizeof(step));
+    if (strcmp(argv[1], "clear") == 0) {
+        if (argc > 3 || (argc == 3 && strcmp(argv[2], "stream") != 0)) return 0;
+        if (control->mode == CONTROL_MODE_SEQUENCE) ANGLE_CONTROL_Stop(control);
+        ANGLE_CONTROL_ClearProgram(control, (uint8_t)(argc == 3));
+        return 1;
+    } else if (strcmp(argv[1], "start") == 0) {
+        if (argc > 3) return 0;
+        if (argc == 3) {
+            if (!SHELL_ParseUint(argv[2], SEQ_PROGRAM_COUNT - 1, &value)) return 0;
+            ANGLE_CONTROL_LoadProgram(control, (uint8_t)value);
+        }
+        ANGLE_CONTROL_StartSequence(control);
+        return 1;
+    } else if (strcmp(argv[1], "key") == 0) {
+        if (argc != 3 || !SHELL_ParseUint(argv[2], 255, &value)) return 0;
+        ANGLE_CONTROL_SequenceKey(control, (uint8_t)value);
+        return 1;
+    } else if (strcmp(argv[1], "status") == 0) {
+        printf("Program: %s, state %d, step %lu, free %u\r\n",
+               (seq->program != NULL) ? "builtin" : (seq->stream ? "stream" : "stored"),
+               seq->state, (unsigned long)seq->pc, SEQ_Free(seq));
+        return 1;
+    }
+
+    /* 其余为追加一步 */
+    if (strcmp(argv[1], "move") == 0) {
+        if (argc < 5 || argc == 6 ||
+            !SHELL_ParseFloat(argv[2], &angle) || !SHELL_ParseFloat(argv[3], &tolerance) ||
+            !SHELL_ParseUint(argv[4], 0xFFFFFFFFUL, &time) ||
+            angle < -90.0f || angle > 90.0f || tolerance < 0.0f || tolerance > 600.0f) return 0;
+        step.op = SEQ_OP_MOVE;
+        step.value = (int16_t)(angle * 100.0f);
+        step.tolerance = (uint16_t)(tolerance * 100.0f + 0.5f);
+        step.time = time;
+        if (argc == 7) {
+            if (!SHELL_ParseFloat(argv[5], &rate) || rate <= 0.0f || rate > 6000.0f) return 0;
+            step.rate = (uint16_t)(rate * 10.0f + 0.5f);
+            if (strcmp(argv[6], "lin") == 0) step.flags = SEQ_RAMP_LINEAR;
+            else if (strcmp(argv[6], "smooth") == 0) step.flags = SEQ_RAMP_SMOOTH;
+            else if (strcmp(argv[6], "cont") == 0) step.flags = SEQ_RAMP_LINEAR | SEQ_FLAG_NO_SETTLE;
+            else return 0;
+        }
+    } else if (strcmp(argv[1], "delay") == 0) {
+        if (argc != 3 || !SHELL_ParseUint(argv[2], 0xFFFFFFFFUL, &time)) return 0;
+        step.op = SEQ_OP_DELAY;
+        step.time = time;
+    } else if (strcmp(argv[1], "wait") == 0) {
+        value = 0;
+        time = 0;
+        if (argc > 4 || (argc >= 3 && !SHELL_ParseUint(argv[2], 255, &value)) ||
+            (argc == 4 && !SHELL_ParseUint(argv[3], 0xFFFFFFFFUL, &time))) return 0;
+        step.op = SEQ_OP_WAIT_KEY;
+        step.value = (int16_t)value;
+        step.time = time;
+    } else if (strcmp(argv[1], "loop") == 0) {
+        if (argc != 3 || !SHELL_ParseUint(argv[2], 32767, &value)) return 0;
+        step.op = SEQ_OP_LOOP;
+        step.value = (int16_t)value;
+    } else if (strcmp(argv[1], "endloop") == 0 && argc == 2) {
+        step.op = SEQ_OP_END_LOOP;
+    } else if (strcmp(argv[1], "end") == 0 && argc == 2) {
+        step.op = SEQ_OP_END;
+    } else {
+        return 0;
+    }
+
+    result = ANGLE_CONTROL_AppendStep(control, &step);
+    if (result == SEQ_FULL) {
+        printf("Error: program buffer full\r\n");
+    } else if (result == SEQ_INVALID) {
+        printf("Error: builtin program loaded, prog clear first\r\n");
+    }
+    return 1;
+}
+
+/**
+  * @brief  停止当前轴
+  */
+static uint8_t SHELL_CmdStop(uint8_t argc, char **argv)
+{
+    ANGLE_CONTROL_Stop(&g_shell_controls[g_shell_axis]);
+    return 1;
+}
+
+/**
+  * @brief  修改控制频率
+  */
+static uint8_t SHELL_CmdRate(uint8_t argc, char **argv)
+{
+    uint32_t rate;
+
+    if (!SHELL_ParseUint(argv[1], ANGLE_CONTROL_RATE_MAX, &rate) || rate < ANGLE_CONTROL_RATE_MIN) return 0;
+    ANGLE_CONTROL_SetLoopRate(g_shell_controls, g_shell_count, (uint16_t)rate);
+    return 1;
+}
+
+/**
+  * @brief  保存当前轴参数
+  */
+static uint8_t SHELL_CmdSave(uint8_t argc, char **argv)
+{
+    ParamStatus_TypeDef status;
+    
+    status = ANGLE_CONTROL_SaveParams(&g_shell_controls[g_shell_axis], g_shell_axis);
+    if (status != PARAM_OK) {
+        printf("Error: axis %d parameters not saved (%s)\r\n", g_shell_axis,
+               (status == PARAM_FULL) ? "store full" : "store error");
+        return 1;
+    }
+    printf("Axis %d parameters saved\r\n", g_shell_axis);
+    return 1;
+}
+
+/**
+  * @brief  角度传感器校准
+  * @note   zero把当前位置设为0度；begin/point/finish为多点校准，
+  *         save把全部轴的线性化表写入参数存储
+  */
+static uint8_t SHELL_CmdCal(uint8_t argc, char **argv)
+{
+    AngleSensor_TypeDef *sensor = g_shell_controls[g_shell_axis].sensor;
+    float angle;
+
+    if (argc == 3) {
+        if (strcmp(argv[1], "point") != 0 || !SHELL_ParseFloat(argv[2], &angle)) return 0;
+        if (ANGLE_SENSOR_CalAddPoint(sensor, angle) != ANGLE_SENSOR_OK) {
+            printf("Error: calibration point rejected\r\n");
+        }
+        return 1;
+    }
+
+    if (strcmp(argv[1], "zero") == 0) {
+        ANGLE_SENSOR_Calibrate(sensor);
+        printf("Angle offset %.2f\r\n", ANGLE_SENSOR_GetOffset(sensor));
+    } else if (strcmp(argv[1], "begin") == 0) {
+        ANGLE_SENSOR_CalBegin(sensor);
+    } else if (strcmp(argv[1], "finish") == 0) {
+        if (ANGLE_SENSOR_CalFinish(sensor) != ANGLE_SENSOR_OK) {
+            printf("Error: calibration failed\r\n");
+        }
+    } else if (strcmp(argv[1], "reset") == 0) {
+        ANGLE_SENSOR_ResetLinearization(sensor);
+    } else if (strcmp(argv[1], "save") == 0) {
+        /* 各轴传感器是同一数组的元素，第0轴的实例即数组首地址 */
+        if (ANGLE_SENSOR_SaveCalibration(g_shell_controls[0].sensor, g_shell_count) != ANGLE_SENSOR_OK) {
+            printf("Error: calibration not saved\r\n");
+        }
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief  控制计算耗时和周期抖动
+  */
+static uint8_t SHELL_CmdProf(uint8_t argc, char **argv)
+{
+    AngleControl_TypeDef *control = &g_shell_controls[g_shell_axis];
+    AngleTiming_TypeDef timing;
+    uint8_t reset = 0;
+
+    if (argc == 2) {
+        if (strcmp(argv[1], "reset") != 0) return 0;
+        reset = 1;
+    }
+
+    ANGLE_CONTROL_GetTiming(control, &timing, reset);
+    printf("Axis %d: cycles last %lu max %lu (%lu us), tick %u us\r\n", g_shell_axis,
+           (unsigned long)control->cycles_last, (unsigned long)control->cycles_max,
+           (unsigned long)(control->cycles_max / (SystemCoreClock / 1000000)), ANGLE_CONTROL_GetTickUs());
+    printf("  sample dt %lu us [%lu, %lu], loop dt [%lu, %lu] us\r\n",
+           (unsigned long)timing.sample_dt, (unsigned long)timing.sample_dt_min,
+           (unsigned long)timing.sample_dt_max, (unsigned long)timing.loop_dt_min,
+           (unsigned long)timing.loop_dt_max);
+    if (reset) {
+        control->cycles_max = 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief  遥测通道和周期
+  */
+static uint8_t SHELL_CmdTele(uint8_t argc, char **argv)
+{
+    uint8_t channels = TELEMETRY_CH_NONE;
+    uint32_t period;
+    uint8_t i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "off") == 0) channels = TELEMETRY_CH_NONE;
+        else if (strcmp(argv[i], "all") == 0) channels = TELEMETRY_CH_ALL;
+        else if (strcmp(argv[i], "ctl") == 0) channels |= TELEMETRY_CH_CONTROL;
+        else if (strcmp(argv[i], "sid") == 0) channels |= TELEMETRY_CH_SYSID;
+        else if (strcmp(argv[i], "pwr") == 0) channels |= TELEMETRY_CH_POWER;
+        else if (strcmp(argv[i], "tim") == 0) channels |= TELEMETRY_CH_TIMING;
+        else if (i == argc - 1 && SHELL_ParseUint(argv[i], 0xFFFF, &period)) TELEMETRY_SetPeriod((uint16_t)period);
+        else return 0;
+    }
+    TELEMETRY_SetChannels(channels);
+    printf("Telemetry channels 0x%02X\r\n", channels);
+    return 1;
+}
+
+/**
+  * @brief  控制环输入记录
+  */
+static uint8_t SHELL_CmdRec(uint8_t argc, char **argv)
+{
+    if (strcmp(argv[1], "start") == 0) {
+        RECORDER_Start();
+    } else if (strcmp(argv[1], "stop") == 0) {
+        RECORDER_Stop();
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief  字符串散列(FNV-1a)
+  * @param  s: 字符串
+  * @retval uint32_t: 散列值
+  * @note   私有函数
+  */
+static uint32_t SHELL_Hash(const char *s)
+{
+    uint32_t hash = 2166136261UL;
+
+    while (*s != '\0') {
+        hash ^= (uint8_t)*s++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/**
+  * @brief  查找命令
+  * @param  name: 命令名
+  * @retval int8_t: 命令号，未找到返回-1
+  * @note   私有函数
+  */
+static int8_t SHELL_Find(const char *name)
+{
+    uint8_t slot = (uint8_t)(SHELL_Hash(name) & (SHELL_HASH_SIZE - 1));
+    uint8_t probes;
+
+    for (probes = 0; probes < SHELL_HASH_SIZE && g_shell_index[slot] != 0; probes++) {
+        if (strcmp(g_shell_commands[g_shell_index[slot] - 1].name, name) == 0) {
+            return (int8_t)(g_shell_index[slot] - 1);
+        }
+        slot = (slot + 1) & (SHELL_HASH_SIZE - 1);
+    }
+    return -1;
+}
+
+/**
+  * @brief  解析浮点参数
+  * @param  s: 参数
+  * @param  value: 输出值
+  * @retval uint8_t: 1成功，0不是完整的数
+  * @note   私有函数
+  */
+static uint8_t SHELL_ParseFloat(const char *s, float *value)
+{
+    char *end;
+    double v = strtod(s, &end);
+
+    if (end == s || *end != '\0') return 0;
+    *value = (float)v;
+    return 1;
+}
+
+/**
+  * @brief  解析无符号整数参数
+  * @param  s: 参数
+  * @param  max: 允许的最大值
+  * @param  value: 输出值
+  * @retval uint8_t: 1成功，0不是完整的数或超范围
+  * @note   私有函数
+  */
+static uint8_t SHELL_ParseUint(const char *s, uint32_t max, uint32_t *value)
+{
+    char *end;
+    unsigned long v;
+
+    if (*s == '-') return 0;
+    v = strtoul(s, &end, 0);
+    if (end == s || *end != '\0' || v > max) return 0;
+    *value = (uint32_t)v;
+    return 1;
+}
@@ -0,0 +1,69 @@
+/**
+  ******************************************************************************
+  * @file    shell.h
+  * @brief   串口命令行模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __SHELL_H
+#define __SHELL_H
+
+#include "stm32f10x.h"
+#include "angle_control.h"
+
+/*
+ * USART_RxService把DMA收到的数据按行组装到USART_RX_BUF(以0x0d 0x0a结尾，USART_RX_STA最高位为完成标志)，
+ * 主循环调用SHELL_Process：在接收缓冲内原地把空格替换为'\0'切分参数，不复制；
+ * 处理完清除USART_RX_STA，才组装下一行。命令作用于当前轴(axis命令切换)。
+ * 同一串口上0x00分隔的二进制帧转交RPC_Handle(主机工具协议，见rpc_schema.h)。
+ *
+ *   help                          列出命令
+ *   axis [n]                      查看/切换当前轴
+ *   status                        当前轴状态
+ *   target <角度>                 设置目标角度
+ *   mode <idle|single|dual|seq|mpc>  设置控制模式
+ *   pid [kp ki kd]                查看/设置PID参数
+ *   fan <基础速度%> <差速比例%>    设置风扇参数
+ *   seq <角度> <保持s> [...]       配置角度序列(最多10步)；seq start 开始序列
+ *   prog clear [stream]           清空序列程序(stream为流式，边执行边追加)
+ *   prog move <角度> <误差> <保持ms> [度/秒 lin|smooth|cont]  追加MOVE，误差0使用稳定判定
+ *   prog delay <ms>|wait [键值] [超时ms]|loop <次数>|endloop|end  追加其余指令
+ *   prog start [内置程序号]|key <键值>|status  运行程序/输入按键/查看状态
+ *   stop                          停止当前轴
+ *   rate <Hz>                     修改控制频率(全部轴须空闲)
+ *   save                          保存当前轴参数
+ *   cal zero|begin|point <角度>|finish|reset|save  角度传感器校准
+ *   prof [reset]                  控制计算耗时和周期抖动
+ *   tele off|all|<ctl,sid,pwr,tim> [周期ms]  遥测通道和周期
+ *   rec start|stop                控制环输入记录
+ */
+
+#define SHELL_ARGC_MAX        22      // 每行最多参数数(含命令名)，seq 10步需要21个
+#define SHELL_HASH_SIZE       32      // 命令散列表槽数(2的幂，大于命令数)
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化命令行
+  * @param  controls: 角度控制结构体数组，数组下标即轴号
+  * @param  count: 轴数
+  * @retval 无
+  */
+void SHELL_Init(AngleControl_TypeDef *controls, uint8_t count);
+
+/**
+  * @brief  处理串口收到的命令行和RPC帧
+  * @param  无
+  * @retval 无
+  * @note   在主循环中调用，不要在中断中调用
+  */
+void SHELL_Process(void);
+
+/**
+  * @brief  执行一行命令
+  * @param  line: 以'\0'结尾的命令行，原地切分，内容会被修改
+  * @retval uint8_t: 1成功，0命令未知或参数错误
+  */
+uint8_t SHELL_Execute(char *line);
+
+#endif /* __SHELL_H */
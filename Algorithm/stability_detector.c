@@ -0,0 +1,202 @@
+/**
+  ******************************************************************************
+  * @file    stability_detector.c
+  * @brief   角度稳定判定(滑动窗口统计+滞回)模块实现
+  ******************************************************************************
+  */
+
+#include "stability_detector.h"
+#include <math.h>
+
+#define Q16_ONE                 65536.0f
+#define Q32_ONE                 4294967296.0f
+
+#define STABILITY_SPIKE_FACTOR  2.0f    // 单点毛刺容忍倍数(相对退出阈值)
+
+/* 私有函数声明 */
+static void STABILITY_UpdateStatistics(StabilityDetector_TypeDef *det);
+
+/**
+  * @brief  初始化稳定判定器
+  * @param  det: 判定器结构体指针
+  * @param  window: 窗口长度(样本，1-STABILITY_WINDOW_MAX)
+  * @param  enter_threshold: 进入阈值(度)
+  * @param  exit_threshold: 退出阈值(度)，不小于进入阈值
+  * @param  hold_samples: 确认稳定所需的带内样本数
+  * @retval 无
+  */
+void STABILITY_Init(StabilityDetector_TypeDef *det, uint8_t window,
+                    float enter_threshold, float exit_threshold, uint32_t hold_samples)
+{
+    if (window == 0) window = 1;
+    if (window > STABILITY_WINDOW_MAX) window = STABILITY_WINDOW_MAX;
+
+    det->window = window;
+    STABILITY_SetThresholds(det, enter_threshold, exit_threshold);
+    STABILITY_SetHoldSamples(det, hold_samples);
+    STABILITY_Reset(det);
+}
+
+/**
+  * @brief  设置滞回阈值
+  * @param  det: 判定器结构体指针
+  * @param  enter_threshold: 进入阈值(度)
+  * @param  exit_threshold: 退出阈值(度)
+  * @retval 无
+  */
+void STABILITY_SetThresholds(StabilityDetector_TypeDef *det, float enter_threshold, float exit_threshold)
+{
+    if (enter_threshold < 0.0f) enter_threshold = 0.0f;
+    if (exit_threshold < enter_threshold) exit_threshold = enter_threshold;
+
+    det->enter_threshold = enter_threshold;
+    det->exit_threshold = exit_threshold;
+}
+
+/**
+  * @brief  设置确认稳定所需的带内样本数
+  * @param  det: 判定器结构体指针
+  * @param  hold_samples: 样本数
+  * @retval 无
+  */
+void STABILITY_SetHoldSamples(StabilityDetector_TypeDef *det, uint32_t hold_samples)
+{
+    det->hold_samples = (hold_samples == 0) ? 1 : hold_samples;
+}
+
+/**
+  * @brief  清空窗口和判定状态(目标改变时调用)
+  * @param  det: 判定器结构体指针
+  * @retval 无
+  */
+void STABILITY_Reset(StabilityDetector_TypeDef *det)
+{
+    det->sum = 0;
+    det->sum_sq = 0;
+    det->head = 0;
+    det->count = 0;
+    det->max_head = 0;
+    det->max_count = 0;
+    det->seq = 0;
+
+    det->in_band_samples = 0;
+    det->state = STABILITY_UNSETTLED;
+
+    det->mean = 0.0f;
+    det->std_dev = 0.0f;
+    det->max_deviation = 0.0f;
+    det->confidence = 0.0f;
+}
+
+/**
+  * @brief  输入一个误差样本并更新判定
+  * @param  det: 判定器结构体指针
+  * @param  error: 角度误差(度)
+  * @retval StabilityState_TypeDef: 判定结果
+  */
+StabilityState_TypeDef STABILITY_Update(StabilityDetector_TypeDef *det, float error)
+{
+    int32_t e = (int32_t)(error * Q16_ONE);
+    int32_t mag = (e < 0) ? -e : e;
+    int32_t old;
+    uint8_t tail;
+    float abs_mean, abs_error, margin, time_factor;
+
+    /* 环形窗口：移出最旧样本，加入新样本 */
+    if (det->count == det->window) {
+        old = det->samples[det->head];
+        det->sum -= old;
+        det->sum_sq -= (int64_t)old * old;
+    } else {
+        det->count++;
+    }
+    det->samples[det->head] = e;
+    det->sum += e;
+    det->sum_sq += (int64_t)e * e;
+    det->head = (uint8_t)((det->head + 1) % det->window);
+
+    /* 单调队列：丢弃过期队首，再从队尾弹出不大于新值的元素 */
+    if (det->max_count > 0 && det->seq - det->max_seq[det->max_head] >= det->window) {
+        det->max_head = (uint8_t)((det->max_head + 1) % STABILITY_WINDOW_MAX);
+        det->max_count--;
+    }
+    while (det->max_count > 0) {
+        tail = (uint8_t)((det->max_head + det->max_count - 1) % STABILITY_WINDOW_MAX);
+        if (det->max_val[tail] > mag) break;
+        det->max_count--;
+    }
+    tail = (uint8_t)((det->max_head + det->max_count) % STABILITY_WINDOW_MAX);
+    det->max_seq[tail] = det->seq;
+    det->max_val[tail] = mag;
+    det->max_count++;
+    det->seq++;
+
+    STABILITY_UpdateStatistics(det);
+
+    /* 滞回判定 */
+    abs_mean = fabsf(det->mean);
+    abs_error = fabsf(error);
+
+    if (det->state == STABILITY_UNSETTLED) {
+        if (det->count == det->window &&
+            abs_mean <= det->enter_threshold &&
+            det->max_deviation <= det->exit_threshold) {
+            det->state = STABILITY_SETTLING;
+            det->in_band_samples = 0;
+        }
+    } else if (abs_mean > det->exit_threshold ||
+               abs_error > STABILITY_SPIKE_FACTOR * det->exit_threshold) {
+        det->state = STABILITY_UNSETTLED;
+        det->in_band_samples = 0;
+    }
+
+    if (det->state != STABILITY_UNSETTLED) {
+        det->in_band_samples++;
+        if (det->in_band_samples >= det->hold_samples) {
+            det->state = STABILITY_STABLE;
+        }
+    }
+
+    /* 提前置信度 */
+    if (det->state == STABILITY_UNSETTLED || det->exit_threshold <= 0.0f) {
+        det->confidence = 0.0f;
+    } else {
+        margin = 1.0f - (abs_mean + 2.0f * det->std_dev) / det->exit_threshold;
+        if (margin < 0.0f) margin = 0.0f;
+        time_factor = (float)det->in_band_samples / det->window;
+        if (time_factor > 1.0f) time_factor = 1.0f;
+        det->confidence = margin * time_factor;
+    }
+
+    return det->state;
+}
+
+/**
+  * @brief  判断是否可以提前认定稳定
+  * @param  det: 判定器结构体指针
+  * @param  min_confidence: 置信度门限(0-1)
+  * @retval uint8_t: 1表示已在带内且置信度达到门限
+  */
+uint8_t STABILITY_IsConfident(StabilityDetector_TypeDef *det, float min_confidence)
+{
+    if (det->state == STABILITY_STABLE) return 1;
+    return (det->state == STABILITY_SETTLING && det->confidence >= min_confidence) ? 1 : 0;
+}
+
+/**
+  * @brief  由运行和计算窗口统计量
+  * @param  det: 判定器结构体指针
+  * @retval 无
+  * @note   私有函数
+  */
+static void STABILITY_UpdateStatistics(StabilityDetector_TypeDef *det)
+{
+    float mean_q16 = (float)det->sum / det->count;
+    float var_q32 = (float)det->sum_sq / det->count - mean_q16 * mean_q16;
+
+    if (var_q32 < 0.0f) var_q32 = 0.0f;
+
+    det->mean = mean_q16 / Q16_ONE;
+    det->std_dev = sqrtf(var_q32 / Q32_ONE);
+    det->max_deviation = (float)det->max_val[det->max_head] / Q16_ONE;
+}
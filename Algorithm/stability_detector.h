@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file    stability_detector.h
+  * @brief   角度稳定判定(滑动窗口统计+滞回)模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __STABILITY_DETECTOR_H
+#define __STABILITY_DETECTOR_H
+
+#include "stm32f10x.h"
+
+#define STABILITY_WINDOW_MAX    64      // 滑动窗口最大长度(样本)
+
+/*
+ * 对角度误差 e = 当前角 - 目标角 维护一个环形窗口：
+ *   - 运行和/平方和(Q16定点，整数累加无漂移) -> 均值、标准差
+ *   - 单调队列 -> 窗口内最大|e|
+ * 每个样本的更新为O(1)(单调队列为均摊O(1))。
+ *
+ * 滞回判定：
+ *   进入带内：窗口已满，|均值| <= 进入阈值，且窗口内所有样本 |e| <= 退出阈值
+ *   保持带内：|均值| <= 退出阈值，且当前样本 |e| <= 2*退出阈值
+ * 偶发的单点毛刺不会打断带内计时。带内持续hold_samples个样本后确认稳定。
+ *
+ * 提前置信度(0-1)：窗口数据越靠近目标、越平稳，置信度越高；
+ *   confidence = clamp(1 - (|均值| + 2*标准差) / 退出阈值) * min(1, 带内样本数/窗口长度)
+ */
+
+/* 稳定判定结果 */
+typedef enum {
+    STABILITY_UNSETTLED = 0,    // 未进入允许误差带
+    STABILITY_SETTLING = 1,     // 已进入误差带，计时中
+    STABILITY_STABLE = 2        // 已确认稳定
+} StabilityState_TypeDef;
+
+/* 稳定判定器结构体 */
+typedef struct {
+    int32_t samples[STABILITY_WINDOW_MAX];   // 误差环形缓冲区 (Q16.16, 度)
+    int64_t sum;                             // 窗口内误差和
+    int64_t sum_sq;                          // 窗口内误差平方和 (Q32)
+    uint8_t window;                          // 窗口长度
+    uint8_t head;                            // 下一个写入位置
+    uint8_t count;                           // 窗口内样本数
+
+    /* 窗口最大|e|的单调递减队列(环形) */
+    uint32_t max_seq[STABILITY_WINDOW_MAX];  // 样本序号
+    int32_t max_val[STABILITY_WINDOW_MAX];   // |e| (Q16.16)
+    uint8_t max_head;                        // 队首位置
+    uint8_t max_count;                       // 队列长度
+    uint32_t seq;                            // 样本序号计数
+
+    float enter_threshold;                   // 进入阈值(度)
+    float exit_threshold;                    // 退出阈值(度)
+    uint32_t hold_samples;                   // 确认稳定所需带内样本数
+    uint32_t in_band_samples;                // 当前连续带内样本数
+    StabilityState_TypeDef state;            // 判定结果
+
+    float mean;                              // 窗口均值(度)
+    float std_dev;                           // 窗口标准差(度)
+    float max_deviation;                     // 窗口最大|e|(度)
+    float confidence;                        // 提前置信度(0-1)
+} StabilityDetector_TypeDef;
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化稳定判定器
+  * @param  det: 判定器结构体指针
+  * @param  window: 窗口长度(样本，1-STABILITY_WINDOW_MAX)
+  * @param  enter_threshold: 进入阈值(度)
+  * @param  exit_threshold: 退出阈值(度)，不小于进入阈值
+  * @param  hold_samples: 确认稳定所需的带内样本数
+  * @retval 无
+  */
+void STABILITY_Init(StabilityDetector_TypeDef *det, uint8_t window,
+                    float enter_threshold, float exit_threshold, uint32_t hold_samples);
+
+/**
+  * @brief  设置滞回阈值
+  * @param  det: 判定器结构体指针
+  * @param  enter_threshold: 进入阈值(度)
+  * @param  exit_threshold: 退出阈值(度)
+  * @retval 无
+  */
+void STABILITY_SetThresholds(StabilityDetector_TypeDef *det, float enter_threshold, float exit_threshold);
+
+/**
+  * @brief  设置确认稳定所需的带内样本数
+  * @param  det: 判定器结构体指针
+  * @param  hold_samples: 样本数
+  * @retval 无
+  */
+void STABILITY_SetHoldSamples(StabilityDetector_TypeDef *det, uint32_t hold_samples);
+
+/**
+  * @brief  清空窗口和判定状态(目标改变时调用)
+  * @param  det: 判定器结构体指针
+  * @retval 无
+  */
+void STABILITY_Reset(StabilityDetector_TypeDef *det);
+
+/**
+  * @brief  输入一个误差样本并更新判定
+  * @param  det: 判定器结构体指针
+  * @param  error: 角度误差(度)
+  * @retval StabilityState_TypeDef: 判定结果
+  */
+StabilityState_TypeDef STABILITY_Update(StabilityDetector_TypeDef *det, float error);
+
+/**
+  * @brief  判断是否可以提前认定稳定
+  * @param  det: 判定器结构体指针
+  * @param  min_confidence: 置信度门限(0-1)
+  * @retval uint8_t: 1表示已在带内且置信度达到门限
+  */
+uint8_t STABILITY_IsConfident(StabilityDetector_TypeDef *det, float min_confidence);
+
+#endif /* __STABILITY_DETECTOR_H */
@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  * @file    system_ident.c
+  * @brief   风力板动态在线辨识(递推最小二乘)模块实现
+  ******************************************************************************
+  */
+
+#include "system_ident.h"
+
+/* 信号归一化：角度和占空比均除以128，使回归向量落在[-1.5,1.5]附近，
+ * 便于定点运算；a、b参数不受统一缩放影响 */
+#define SYSID_SIGNAL_SCALE      (1.0f / 128.0f)
+
+#define SYSID_LAMBDA_MIN        0.90f   // 遗忘因子下限
+#define SYSID_STATS_ALPHA       0.01f   // 拟合度统计的指数加权系数
+
+/* 数值运算宏：浮点/定点两种实现共用同一套算法 */
+#if SYSID_USE_FIXED_POINT
+#define SV_FROM_FLOAT(x)        ((int32_t)((x) * 65536.0f))
+#define SV_TO_FLOAT(x)          ((float)(x) / 65536.0f)
+#define SV_MUL(a, b)            ((int32_t)(((int64_t)(a) * (b)) >> 16))
+#define SV_DIV(a, b)            ((int32_t)(((int64_t)(a) << 16) / (b)))
+#define SV_ZERO                 0
+#else
+#define SV_FROM_FLOAT(x)        (x)
+#define SV_TO_FLOAT(x)          (x)
+#define SV_MUL(a, b)            ((a) * (b))
+#define SV_DIV(a, b)            ((a) / (b))
+#define SV_ZERO                 0.0f
+#endif
+
+/**
+  * @brief  初始化辨识器
+  * @param  sysid: 辨识器结构体指针
+  * @param  lambda: 遗忘因子(0.9-1.0)
+  * @param  initial_covariance: 初始协方差(越大收敛越快)
+  * @retval 无
+  */
+void SYSID_Init(SysId_TypeDef *sysid, float lambda, float initial_covariance)
+{
+    sysid->initial_covariance = initial_covariance;
+    sysid->enabled = 0;
+
+    SYSID_SetForgettingFactor(sysid, lambda);
+    SYSID_Reset(sysid);
+}
+
+/**
+  * @brief  复位参数估计和协方差
+  * @param  sysid: 辨识器结构体指针
+  * @retval 无
+  */
+void SYSID_Reset(SysId_TypeDef *sysid)
+{
+    uint8_t i, j;
+
+    for (i = 0; i < SYSID_PARAM_COUNT; i++) {
+        sysid->theta[i] = SV_ZERO;
+        sysid->phi[i] = SV_ZERO;
+        for (j = 0; j < SYSID_PARAM_COUNT; j++) {
+            sysid->P[i][j] = (i == j) ? SV_FROM_FLOAT(sysid->initial_covariance) : SV_ZERO;
+        }
+    }
+
+    sysid->error_var = 0.0f;
+    sysid->output_mean = 0.0f;
+    sysid->output_var = 0.0f;
+    sysid->primed = 0;
+    sysid->history = 0;
+    sysid->updates = 0;
+}
+
+/**
+  * @brief  设置遗忘因子
+  * @param  sysid: 辨识器结构体指针
+  * @param  lambda: 遗忘因子(0.9-1.0)
+  * @retval 无
+  */
+void SYSID_SetForgettingFactor(SysId_TypeDef *sysid, float lambda)
+{
+    if (lambda > 1.0f) lambda = 1.0f;
+    if (lambda < SYSID_LAMBDA_MIN) lambda = SYSID_LAMBDA_MIN;
+
+    sysid->lambda = SV_FROM_FLOAT(lambda);
+    sysid->inv_lambda = SV_FROM_FLOAT(1.0f / lambda);
+}
+
+/**
+  * @brief  使能/禁用辨识
+  * @param  sysid: 辨识器结构体指针
+  * @param  enable: 使能状态 (1:使能, 0:禁用)
+  * @retval 无
+  */
+void SYSID_Enable(SysId_TypeDef *sysid, uint8_t enable)
+{
+    sysid->enabled = enable ? 1 : 0;
+
+    /* 重新使能时历史数据已不连续，需重新填充回归向量 */
+    sysid->history = 0;
+    sysid->primed = 0;
+}
+
+/**
+  * @brief  输入一组新的输出/输入样本并更新估计
+  * @param  sysid: 辨识器结构体指针
+  * @param  y: 当前输出(角度，度)
+  * @param  u: 本周期施加的输入(差速占空比，%)
+  * @retval 无
+  * @note   每个控制周期调用一次，运算量固定
+  */
+void SYSID_Update(SysId_TypeDef *sysid, float y, float u)
+{
+    SysIdValue_TypeDef ys = SV_FROM_FLOAT(y * SYSID_SIGNAL_SCALE);
+    SysIdValue_TypeDef us = SV_FROM_FLOAT(u * SYSID_SIGNAL_SCALE);
+    SysIdValue_TypeDef Pphi[SYSID_PARAM_COUNT];
+    SysIdValue_TypeDef gain[SYSID_PARAM_COUNT];
+    SysIdValue_TypeDef denom, prediction, error, forget;
+    float error_f, deviation;
+    uint8_t i, j;
+
+    if (!sysid->enabled) return;
+
+    if (sysid->primed) {
+        /* P*phi 与 phi'*P*phi */
+        denom = sysid->lambda;
+        prediction = SV_ZERO;
+        for (i = 0; i < SYSID_PARAM_COUNT; i++) {
+            Pphi[i] = SV_ZERO;
+            for (j = 0; j < SYSID_PARAM_COUNT; j++) {
+                Pphi[i] += SV_MUL(sysid->P[i][j], sysid->phi[j]);
+            }
+            denom += SV_MUL(sysid->phi[i], Pphi[i]);
+            prediction += SV_MUL(sysid->phi[i], sysid->theta[i]);
+        }
+
+        /* 增益与参数更新 */
+        error = ys - prediction;
+        for (i = 0; i < SYSID_PARAM_COUNT; i++) {
+            gain[i] = SV_DIV(Pphi[i], denom);
+            sysid->theta[i] += SV_MUL(gain[i], error);
+        }
+
+        /* 激励不足时协方差会按1/lambda增长，超过初值后停止遗忘 */
+        forget = sysid->inv_lambda;
+        for (i = 0; i < SYSID_PARAM_COUNT; i++) {
+            if (sysid->P[i][i] > SV_FROM_FLOAT(sysid->initial_covariance)) {
+                forget = SV_FROM_FLOAT(1.0f);
+                break;
+            }
+        }
+
+        /* P = (P - K*phi'*P) / lambda，只算上三角后镜像保持对称 */
+        for (i = 0; i < SYSID_PARAM_COUNT; i++) {
+            for (j = i; j < SYSID_PARAM_COUNT; j++) {
+                sysid->P[i][j] = SV_MUL(sysid->P[i][j] - SV_MUL(gain[i], Pphi[j]), forget);
+                sysid->P[j][i] = sysid->P[i][j];
+            }
+        }
+
+        /* 拟合度统计(以原始单位计) */
+        error_f = SV_TO_FLOAT(error) / SYSID_SIGNAL_SCALE;
+        deviation = y - sysid->output_mean;
+        sysid->output_mean += SYSID_STATS_ALPHA * deviation;
+        sysid->output_var += SYSID_STATS_ALPHA * (deviation * deviation - sysid->output_var);
+        sysid->error_var += SYSID_STATS_ALPHA * (error_f * error_f - sysid->error_var);
+
+        sysid->updates++;
+    } else {
+        sysid->output_mean = y;
+    }
+
+    /* 移位回归向量：phi = [-y1 -y2 u1 u2] */
+    sysid->phi[1] = sysid->phi[0];
+    sysid->phi[0] = -ys;
+    sysid->phi[3] = sysid->phi[2];
+    sysid->phi[2] = us;
+
+    if (!sysid->primed && ++sysid->history >= 2) {
+        sysid->primed = 1;
+    }
+}
+
+/**
+  * @brief  获取当前模型
+  * @param  sysid: 辨识器结构体指针
+  * @param  model: 输出模型结构体指针
+  * @retval 无
+  */
+void SYSID_GetModel(SysId_TypeDef *sysid, SysIdModel_TypeDef *model)
+{
+    float denom;
+    uint8_t i;
+
+    model->a1 = SV_TO_FLOAT(sysid->theta[0]);
+    model->a2 = SV_TO_FLOAT(sysid->theta[1]);
+    model->b1 = SV_TO_FLOAT(sysid->theta[2]);
+    model->b2 = SV_TO_FLOAT(sysid->theta[3]);
+
+    denom = 1.0f + model->a1 + model->a2;
+    model->dc_gain = (denom > 1e-4f || denom < -1e-4f) ? (model->b1 + model->b2) / denom : 0.0f;
+
+    model->trace = 0.0f;
+    for (i = 0; i < SYSID_PARAM_COUNT; i++) {
+        model->trace += SV_TO_FLOAT(sysid->P[i][i]);
+    }
+
+    if (sysid->output_var > 1e-6f) {
+        model->fit = 1.0f - sysid->error_var / sysid->output_var;
+        if (model->fit < 0.0f) model->fit = 0.0f;
+    } else {
+        model->fit = 0.0f;
+    }
+
+    model->updates = sysid->updates;
+}
@@ -0,0 +1,114 @@
+/**
+  ******************************************************************************
+  * @file    system_ident.h
+  * @brief   风力板动态在线辨识(递推最小二乘)模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __SYSTEM_IDENT_H
+#define __SYSTEM_IDENT_H
+
+#include "stm32f10x.h"
+
+/* 1: 使用定点(Q16.16)实现，0: 使用浮点实现 */
+#ifndef SYSID_USE_FIXED_POINT
+#define SYSID_USE_FIXED_POINT   0
+#endif
+
+#define SYSID_PARAM_COUNT       4       // ARX(2,2)参数个数
+
+/*
+ * 辨识模型 ARX(2,2)，输入u为差速占空比(右-左,%)，输出y为角度(度)：
+ *   y[k] = -a1*y[k-1] - a2*y[k-2] + b1*u[k-1] + b2*u[k-2] + e[k]
+ * 参数向量 theta = [a1 a2 b1 b2]，回归向量 phi = [-y1 -y2 u1 u2]
+ * 带遗忘因子的RLS每次更新的运算量固定(4x4矩阵，约100次乘加，4次除法)。
+ */
+
+#if SYSID_USE_FIXED_POINT
+typedef int32_t SysIdValue_TypeDef;     // Q16.16
+#else
+typedef float SysIdValue_TypeDef;
+#endif
+
+/* 辨识得到的模型(浮点，供显示/遥测) */
+typedef struct {
+    float a1, a2;              // 输出多项式系数
+    float b1, b2;              // 输入多项式系数
+    float dc_gain;             // 稳态增益 (b1+b2)/(1+a1+a2)，度/%
+    float fit;                 // 拟合度(0-1)，1-残差方差/输出方差
+    float trace;               // 协方差矩阵的迹，越小表示估计越确定
+    uint32_t updates;          // 更新次数
+} SysIdModel_TypeDef;
+
+/* RLS辨识器结构体 */
+typedef struct {
+    SysIdValue_TypeDef theta[SYSID_PARAM_COUNT];                     // 参数估计
+    SysIdValue_TypeDef P[SYSID_PARAM_COUNT][SYSID_PARAM_COUNT];      // 协方差矩阵
+    SysIdValue_TypeDef phi[SYSID_PARAM_COUNT];                       // 回归向量
+    SysIdValue_TypeDef lambda;                                       // 遗忘因子
+    SysIdValue_TypeDef inv_lambda;                                   // 遗忘因子倒数
+
+    float initial_covariance;  // 初始协方差
+    float error_var;           // 预测残差方差(指数加权)
+    float output_mean;         // 输出均值(指数加权)
+    float output_var;          // 输出方差(指数加权)
+
+    uint8_t enabled;           // 使能标志
+    uint8_t primed;            // 回归向量已填满
+    uint8_t history;           // 已累积的历史样本数
+    uint32_t updates;          // 更新次数
+} SysId_TypeDef;
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化辨识器
+  * @param  sysid: 辨识器结构体指针
+  * @param  lambda: 遗忘因子(0.9-1.0)
+  * @param  initial_covariance: 初始协方差(越大收敛越快)
+  * @retval 无
+  */
+void SYSID_Init(SysId_TypeDef *sysid, float lambda, float initial_covariance);
+
+/**
+  * @brief  复位参数估计和协方差
+  * @param  sysid: 辨识器结构体指针
+  * @retval 无
+  */
+void SYSID_Reset(SysId_TypeDef *sysid);
+
+/**
+  * @brief  设置遗忘因子
+  * @param  sysid: 辨识器结构体指针
+  * @param  lambda: 遗忘因子(0.9-1.0)
+  * @retval 无
+  */
+void SYSID_SetForgettingFactor(SysId_TypeDef *sysid, float lambda);
+
+/**
+  * @brief  使能/禁用辨识
+  * @param  sysid: 辨识器结构体指针
+  * @param  enable: 使能状态 (1:使能, 0:禁用)
+  * @retval 无
+  */
+void SYSID_Enable(SysId_TypeDef *sysid, uint8_t enable);
+
+/**
+  * @brief  输入一组新的输出/输入样本并更新估计
+  * @param  sysid: 辨识器结构体指针
+  * @param  y: 当前输出(角度，度)
+  * @param  u: 本周期施加的输入(差速占空比，%)
+  * @retval 无
+  * @note   每个控制周期调用一次，运算量固定
+  */
+void SYSID_Update(SysId_TypeDef *sysid, float y, float u);
+
+/**
+  * @brief  获取当前模型
+  * @param  sysid: 辨识器结构体指针
+  * @param  model: 输出模型结构体指针
+  * @retval 无
+  */
+void SYSID_GetModel(SysId_TypeDef *sysid, SysIdModel_TypeDef *model);
+
+#endif /* __SYSTEM_IDENT_H */
@@ -0,0 +1,178 @@
+/**
+  ******************************************************************************
+  * @file    telemetry.c
+  * @brief   串口遥测输出模块实现
+  ******************************************************************************
+  */
+
+#include "telemetry.h"
+#include <stdio.h>
+
+/* 私有变量 */
+static uint16_t g_telemetry_period = TELEMETRY_DEFAULT_PERIOD;  // 输出周期(ms)
+static uint8_t g_telemetry_channels = TELEMETRY_CH_NONE;        // 使能的通道
+static uint32_t g_telemetry_last_time = 0;                      // 上次输出时间
+
+/* 私有函数声明 */
+static void TELEMETRY_SendControl(AngleControl_TypeDef *control, uint8_t axis, uint32_t now);
+static void TELEMETRY_SendSysId(AngleControl_TypeDef *control, uint8_t axis, uint32_t now);
+static void TELEMETRY_SendPower(AngleControl_TypeDef *control, uint8_t axis, uint32_t now);
+static void TELEMETRY_SendTiming(AngleControl_TypeDef *control, uint8_t axis, uint32_t now);
+
+/**
+  * @brief  初始化遥测输出
+  * @param  period: 输出周期(ms)
+  * @param  channels: 使能的通道掩码
+  * @retval 无
+  */
+void TELEMETRY_Init(uint16_t period, uint8_t channels)
+{
+    TELEMETRY_SetPeriod(period);
+    g_telemetry_channels = channels;
+    g_telemetry_last_time = ANGLE_CONTROL_GetTime();
+}
+
+/**
+  * @brief  设置输出周期
+  * @param  period: 输出周期(ms)
+  * @retval 无
+  */
+void TELEMETRY_SetPeriod(uint16_t period)
+{
+    if (period < TELEMETRY_MIN_PERIOD) period = TELEMETRY_MIN_PERIOD;
+    g_telemetry_period = period;
+}
+
+/**
+  * @brief  设置使能的通道
+  * @param  channels: 通道掩码
+  * @retval 无
+  */
+void TELEMETRY_SetChannels(uint8_t channels)
+{
+    g_telemetry_channels = channels;
+}
+
+/**
+  * @brief  获取使能的通道
+  * @param  无
+  * @retval uint8_t: 通道掩码
+  */
+uint8_t TELEMETRY_GetChannels(void)
+{
+    return g_telemetry_channels;
+}
+
+/**
+  * @brief  遥测处理，到达输出周期时发送各通道数据
+  * @param  controls: 角度控制结构体数组
+  * @param  count: 轴数
+  * @retval 无
+  * @note   在主循环中调用，不要在中断中调用
+  */
+void TELEMETRY_Process(AngleControl_TypeDef *controls, uint8_t count)
+{
+    uint32_t now = ANGLE_CONTROL_GetTime();
+    uint8_t i;
+
+    if (g_telemetry_channels == TELEMETRY_CH_NONE) return;
+    if ((now - g_telemetry_last_time) < g_telemetry_period) return;
+    g_telemetry_last_time = now;
+
+    for (i = 0; i < count; i++) {
+        if (g_telemetry_channels & TELEMETRY_CH_CONTROL) {
+            TELEMETRY_SendControl(&controls[i], i, now);
+        }
+        if (g_telemetry_channels & TELEMETRY_CH_SYSID) {
+            TELEMETRY_SendSysId(&controls[i], i, now);
+        }
+        if (g_telemetry_channels & TELEMETRY_CH_POWER) {
+            TELEMETRY_SendPower(&controls[i], i, now);
+        }
+        if (g_telemetry_channels & TELEMETRY_CH_TIMING) {
+            TELEMETRY_SendTiming(&controls[i], i, now);
+        }
+    }
+}
+
+/**
+  * @brief  发送控制状态
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号
+  * @param  now: 当前时间(ms)
+  * @retval 无
+  * @note   私有函数
+  */
+static void TELEMETRY_SendControl(AngleControl_TypeDef *control, uint8_t axis, uint32_t now)
+{
+    printf("$CTL,%lu,%d,%d,%d,%.1f,%.2f,%.1f,%d,%d,%lu,%lu\r\n",
+           (unsigned long)now, axis, control->mode, control->state,
+           control->target_angle, control->current_angle, control->current_rate,
+           FAN_GetSpeed(control->fan, FAN_LEFT), FAN_GetSpeed(control->fan, FAN_RIGHT),
+           (unsigned long)control->cycles_last, (unsigned long)control->cycles_max);
+}
+
+/**
+  * @brief  发送辨识模型
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号
+  * @param  now: 当前时间(ms)
+  * @retval 无
+  * @note   私有函数。辨识器在控制中断中更新，关中断取快照保证参数一致
+  */
+static void TELEMETRY_SendSysId(AngleControl_TypeDef *control, uint8_t axis, uint32_t now)
+{
+    SysIdModel_TypeDef model;
+
+    __disable_irq();
+    SYSID_GetModel(&control->sysid, &model);
+    __enable_irq();
+
+    printf("$SID,%lu,%d,%.4f,%.4f,%.5f,%.5f,%.3f,%.3f,%.3f,%lu\r\n",
+           (unsigned long)now, axis, model.a1, model.a2, model.b1, model.b2,
+           model.dc_gain, model.fit, model.trace, (unsigned long)model.updates);
+}
+
+/**
+  * @brief  发送风扇电流、功率和转速
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号
+  * @param  now: 当前时间(ms)
+  * @retval 无
+  * @note   私有函数。未关联电流检测或测速的量输出0
+  */
+static void TELEMETRY_SendPower(AngleControl_TypeDef *control, uint8_t axis, uint32_t now)
+{
+    CurrentSense_TypeDef *cs = control->current;
+    Tach_TypeDef *left = control->tach[FAN_LEFT];
+    Tach_TypeDef *right = control->tach[FAN_RIGHT];
+
+    printf("$PWR,%lu,%d,%.3f,%.3f,%.2f,%.2f,%.0f,%.0f,%d,%d\r\n",
+           (unsigned long)now, axis,
+           cs ? CURRENT_SENSE_GetCurrent(cs, FAN_LEFT) : 0.0f,
+           cs ? CURRENT_SENSE_GetCurrent(cs, FAN_RIGHT) : 0.0f,
+           cs ? CURRENT_SENSE_GetPower(cs, FAN_LEFT) : 0.0f,
+           cs ? CURRENT_SENSE_GetPower(cs, FAN_RIGHT) : 0.0f,
+           left ? TACH_GetRpm(left) : 0.0f, right ? TACH_GetRpm(right) : 0.0f,
+           FAN_GetFault(control->fan, FAN_LEFT), FAN_GetFault(control->fan, FAN_RIGHT));
+}
+
+/**
+  * @brief  发送采样间隔和控制周期抖动
+  * @param  control: 角度控制结构体指针
+  * @param  axis: 轴号
+  * @param  now: 当前时间(ms)
+  * @retval 无
+  * @note   私有函数。输出后复位最小/最大值，每帧反映一个输出周期
+  */
+static void TELEMETRY_SendTiming(AngleControl_TypeDef *control, uint8_t axis, uint32_t now)
+{
+    AngleTiming_TypeDef timing;
+
+    ANGLE_CONTROL_GetTiming(control, &timing, 1);
+
+    printf("$TIM,%lu,%d,%lu,%lu,%lu,%lu,%lu\r\n",
+           (unsigned long)now, axis, (unsigned long)timing.sample_dt,
+           (unsigned long)timing.sample_dt_min, (unsigned long)timing.sample_dt_max,
+           (unsigned long)timing.loop_dt_min, (unsigned long)timing.loop_dt_max);
+}
@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    telemetry.h
+  * @brief   串口遥测输出模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+#include "stm32f10x.h"
+#include "angle_control.h"
+
+/* 遥测通道(可按位组合) */
+#define TELEMETRY_CH_NONE        0x00    // 关闭
+#define TELEMETRY_CH_CONTROL     0x01    // 控制状态 $CTL
+#define TELEMETRY_CH_SYSID       0x02    // 辨识模型 $SID
+#define TELEMETRY_CH_POWER       0x04    // 风扇电流/功率/转速 $PWR
+#define TELEMETRY_CH_TIMING      0x08    // 采样间隔/控制周期抖动 $TIM
+#define TELEMETRY_CH_ALL         0xFF    // 全部通道
+
+#define TELEMETRY_DEFAULT_PERIOD 100     // 默认输出周期(ms)
+#define TELEMETRY_MIN_PERIOD     20      // 最小输出周期(ms)，受115200波特率限制
+
+/*
+ * 输出格式(逗号分隔，每帧一行)：
+ *   $CTL,时间ms,轴号,模式,状态,目标角,当前角,角速度,左占空比,右占空比,本次耗时周期,最大耗时周期
+ *   $SID,时间ms,轴号,a1,a2,b1,b2,稳态增益,拟合度,协方差迹,更新次数
+ *   $PWR,时间ms,轴号,左电流A,右电流A,左机械功率W,右机械功率W,左转速,右转速,左过流,右过流
+ *   $TIM,时间ms,轴号,样本间隔us,最小样本间隔us,最大样本间隔us,最小控制周期us,最大控制周期us
+ *        (最小/最大值为本输出周期内的统计，每帧输出后复位)
+ */
+
+/* 函数声明 */
+
+/**
+  * @brief  初始化遥测输出
+  * @param  period: 输出周期(ms)
+  * @param  channels: 使能的通道掩码
+  * @retval 无
+  */
+void TELEMETRY_Init(uint16_t period, uint8_t channels);
+
+/**
+  * @brief  设置输出周期
+  * @param  period: 输出周期(ms)
+  * @retval 无
+  */
+void TELEMETRY_SetPeriod(uint16_t period);
+
+/**
+  * @brief  设置使能的通道
+  * @param  channels: 通道掩码
+  * @retval 无
+  */
+void TELEMETRY_SetChannels(uint8_t channels);
+
+/**
+  * @brief  获取使能的通道
+  * @param  无
+  * @retval uint8_t: 通道掩码
+  */
+uint8_t TELEMETRY_GetChannels(void);
+
+/**
+  * @brief  遥测处理，到达输出周期时发送各通道数据
+  * @param  controls: 角度控制结构体数组
+  * @param  count: 轴数
+  * @retval 无
+  * @note   在主循环中调用，不要在中断中调用
+  */
+void TELEMETRY_Process(AngleControl_TypeDef *controls, uint8_t count);
+
+#endif /* __TELEMETRY_H */
@@ -1,45 +1,123 @@
 #include "angle_sensor.h"
+#include "param_store.h"
+#include "timebase.h"
 #include "math.h"
 #include <stddef.h> /* 添加 NULL 定义的头文件 */
 
 /* 私有宏定义 */
-#define ADC_MIN           820     // ADC最小值
+#define ADC_MIN           820     // 默认表-90度位置
 #define ADC_MID           2420    // ADC中间值（0度位置）
-#define ADC_MAX           4020    // ADC最大值
+#define ADC_MAX           4020    // 默认表90度位置
 #define ADC_TIMEOUT_COUNT 1000    // ADC超时计数
+#define ADC_CONVERSION_NS 5667    // 单次转换时间(ns)：(55.5+12.5)周期 / 12MHz
+
+#define LUT_FRAC_BITS     (ANGLE_SENSOR_LUT_SHIFT + 8) // 查表时平均ADC为Q8，表内位置的小数位数
+#define LUT_ANGLE_LIMIT   180.0f  // 线性化表外推限幅(度)
+#define RANGE_ANGLE_Q16   (90L << 16) // 量程端点角度(Q16.16)
+#define RANGE_MARGIN      64      // 量程故障门限在端点外的余量(ADC计数)
+
+#define ADC_DMA_SWEEPS    (2 * ANGLE_SENSOR_OSR_CHUNK) // DMA缓冲的扫描轮数(两个半缓冲)
+
+/* 排序网络的比较交换 */
+#define SORT2(a, b)       do { if((a) > (b)) { uint16_t t_ = (a); (a) = (b); (b) = t_; } } while(0)
 
 /* 私有变量 */
-static float angle_offset = 0.0f; // 角度偏移值
+/* ADC1扫描+DMA循环缓冲：[扫描轮][扫描位置]，DMA持续刷新，读取无需等待转换 */
+static volatile uint16_t adc_dma_buffer[ADC_DMA_SWEEPS * ANGLE_SENSOR_MAX_CHANNELS];
+static uint8_t adc_channel_count = 0; // 扫描序列中的通道数
+static AngleSensor_TypeDef *adc_sensors = NULL; // 扫描序列对应的传感器实例(DMA中断累加)
+static volatile uint8_t adc_osr_log2 = ANGLE_SENSOR_OSR_LOG2_DEFAULT; // 过采样率(log2)
+
+/* 私有函数声明 */
+static int32_t ANGLE_SENSOR_Lookup(AngleSensor_TypeDef *sensor, uint32_t adc_sum, uint8_t count);
+static int32_t ANGLE_SENSOR_LookupQ8(AngleSensor_TypeDef *sensor, uint32_t x_q8);
+static uint16_t ANGLE_SENSOR_LatestSweep(void);
+static void ANGLE_SENSOR_OsrReset(volatile AngleOsr_TypeDef *osr);
+static void ANGLE_SENSOR_UpdateRange(AngleSensor_TypeDef *sensor);
+static int32_t ANGLE_SENSOR_AdcAtAngle(AngleSensor_TypeDef *sensor, int32_t angle_q16);
+static void ANGLE_SENSOR_Sort8(uint16_t *v);
+
+/* 预定义硬件描述 */
+const AngleSensorConfig_TypeDef ANGLE_SENSOR_CONFIG_PA3 = {GPIOA, GPIO_Pin_3, RCC_APB2Periph_GPIOA, ADC_Channel_3};
+const AngleSensorConfig_TypeDef ANGLE_SENSOR_CONFIG_PC2 = {GPIOC, GPIO_Pin_2, RCC_APB2Periph_GPIOC, ADC_Channel_12};
+const AngleSensorConfig_TypeDef ANGLE_SENSOR_CONFIG_PC3 = {GPIOC, GPIO_Pin_3, RCC_APB2Periph_GPIOC, ADC_Channel_13};
 
 /**
   * @brief  角度传感器初始化
-  * @retval AngleSensorStatus_TypeDef 初始化状态
+  * @param  sensors: 传感器实例数组
+  * @param  configs: 各实例的硬件描述
+  * @param  count: 传感器数量(1-ANGLE_SENSOR_MAX_CHANNELS)
+  * @retval AngleSensorStatus_TypeDef 初始化状态，ANGLE_SENSOR_TIMEOUT表示DMA未产生数据
+  * @note   所有传感器共用ADC1扫描序列，DMA1通道1循环搬运到缓冲区，
+  *         半满/全满中断累加过采样窗口
   */
-AngleSensorStatus_TypeDef ANGLE_SENSOR_Init(void)
+AngleSensorStatus_TypeDef ANGLE_SENSOR_Init(AngleSensor_TypeDef *sensors, const AngleSensorConfig_TypeDef *const *configs, uint8_t count)
 {
     ADC_InitTypeDef ADC_InitStructure;
     GPIO_InitTypeDef GPIO_InitStructure;
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    uint32_t timeout = ADC_TIMEOUT_COUNT * ADC_DMA_SWEEPS;
+    uint8_t i;
 
-    // 使能时钟
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_ADC1, ENABLE);
-    
-    // 配置GPIO - 修改为PA3
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_3;
+    if(sensors == NULL || configs == NULL) return ANGLE_SENSOR_ERROR;
+    if(count == 0 || count > ANGLE_SENSOR_MAX_CHANNELS) return ANGLE_SENSOR_ERROR;
+
+    // 使能时钟，ADC时钟 72MHz/6 = 12MHz
+    RCC_ADCCLKConfig(RCC_PCLK2_Div6);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC1, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    // 配置各通道GPIO
     GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
-    GPIO_Init(GPIOA, &GPIO_InitStructure);
+    for(i=0; i<count; i++) {
+        RCC_APB2PeriphClockCmd(configs[i]->gpio_rcc, ENABLE);
+        GPIO_InitStructure.GPIO_Pin = configs[i]->pin;
+        GPIO_Init(configs[i]->port, &GPIO_InitStructure);
 
-    // 配置ADC
+        sensors[i].config = configs[i];
+        sensors[i].scan_rank = i;
+        sensors[i].offset = 0.0f;
+        sensors[i].offset_q16 = 0;
+        sensors[i].cal_count = 0;
+        ANGLE_SENSOR_ResetLinearization(&sensors[i]);
+        ANGLE_SENSOR_OsrReset(&sensors[i].osr);
+        sensors[i].fault_windows = 0;
+        sensors[i].stale_count = 0;
+    }
+    adc_channel_count = count;
+    adc_sensors = sensors;
+
+    // 配置DMA：ADC1->DR 循环搬运 ADC_DMA_SWEEPS 轮扫描结果
+    DMA_DeInit(DMA1_Channel1);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&ADC1->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adc_dma_buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = (uint32_t)ADC_DMA_SWEEPS * count;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel1, &DMA_InitStructure);
+    DMA_Cmd(DMA1_Channel1, ENABLE);
+
+    // 配置ADC：扫描+连续转换
     ADC_DeInit(ADC1);
     ADC_InitStructure.ADC_Mode = ADC_Mode_Independent;
-    ADC_InitStructure.ADC_ScanConvMode = DISABLE;
+    ADC_InitStructure.ADC_ScanConvMode = (count > 1) ? ENABLE : DISABLE;
     ADC_InitStructure.ADC_ContinuousConvMode = ENABLE;
     ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_None;
     ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
-    ADC_InitStructure.ADC_NbrOfChannel = 1;
+    ADC_InitStructure.ADC_NbrOfChannel = count;
     ADC_Init(ADC1, &ADC_InitStructure);
 
-    // 修改为ADC通道3
-    ADC_RegularChannelConfig(ADC1, ADC_Channel_3, 1, ADC_SampleTime_55Cycles5);
+    for(i=0; i<count; i++) {
+        ADC_RegularChannelConfig(ADC1, configs[i]->adc_channel, i + 1, ADC_SampleTime_55Cycles5);
+    }
+    ADC_DMACmd(ADC1, ENABLE);
     ADC_Cmd(ADC1, ENABLE);
 
     // ADC校准
@@ -48,45 +126,58 @@ AngleSensorStatus_TypeDef ANGLE_SENSOR_Init(void)
     ADC_StartCalibration(ADC1);
     while(ADC_GetCalibrationStatus(ADC1));
     
+    DMA_ClearFlag(DMA1_FLAG_TC1);
     ADC_SoftwareStartConvCmd(ADC1, ENABLE);
 
+    // 等待缓冲区被完整填充一次
+    while(DMA_GetFlagStatus(DMA1_FLAG_TC1) == RESET) {
+        if(--timeout == 0) {
+            return ANGLE_SENSOR_TIMEOUT;
+        }
+    }
+
+    // 半满/全满中断：每ANGLE_SENSOR_OSR_CHUNK轮扫描累加一次
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel1_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    DMA_ClearITPendingBit(DMA1_IT_GL1);
+    DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
     return ANGLE_SENSOR_OK;
 }
+
 /**
   * @brief  获取当前角度值
+  * @param  sensor: 传感器实例
   * @retval float: 当前角度值，范围[-90, 90]度
+  * @note   取最近一个过采样窗口
   */
-float ANGLE_SENSOR_GetAngle(void)
+float ANGLE_SENSOR_GetAngle(AngleSensor_TypeDef *sensor)
 {
-    static uint16_t adc_buffer[8];
-    uint32_t sum = 0;
-    uint32_t timeout;
-    uint16_t avg_adc;
+    return ANGLE_SENSOR_GetAngleAt(sensor, NULL);
+}
+
+/**
+  * @brief  获取当前角度值及其采样时刻
+  * @param  sensor: 传感器实例
+  * @param  timestamp: 输出所用窗口的结束时刻(us)，可为NULL；ADC未就绪时不修改
+  * @retval float: 当前角度值，范围[-90, 90]度
+  */
+float ANGLE_SENSOR_GetAngleAt(AngleSensor_TypeDef *sensor, uint64_t *timestamp)
+{
+    int32_t angle_q16;
     float actual_angle;
-    int i;
-    
-    // 8次采样
-    for(i=0; i<8; i++) {
-        timeout = ADC_TIMEOUT_COUNT;
-        while(!ADC_GetFlagStatus(ADC1, ADC_FLAG_EOC)) {
-            if(--timeout == 0) {
-                return 0.0f;  // ADC读取超时，返回0度
-            }
-        }
-        adc_buffer[i] = ADC_GetConversionValue(ADC1);
-        sum += adc_buffer[i];
-    }
-    
-    // 计算平均值
-    avg_adc = sum / 8;
     
-    // 计算角度
-    if(avg_adc <= ADC_MID) {
-        actual_angle = (avg_adc - ADC_MID) * 90.0f / (ADC_MID - ADC_MIN);
-    } else {
-        actual_angle = (avg_adc - ADC_MID) * 90.0f / (ADC_MAX - ADC_MID);
+    if(ANGLE_SENSOR_GetAngleQ16(sensor, &angle_q16, timestamp) != ANGLE_SENSOR_OK) {
+        return 0.0f;  // ADC未就绪，返回0度
     }
     
+    // 线性化后的角度(去掉偏移，限幅和死区针对传感器读数)
+    actual_angle = (angle_q16 - sensor->offset_q16) / 65536.0f;
+    
     // 限幅
     if(actual_angle > 90.0f) actual_angle = 90.0f;
     if(actual_angle < -90.0f) actual_angle = -90.0f;
@@ -95,68 +186,740 @@ float ANGLE_SENSOR_GetAngle(void)
     if(fabs(actual_angle) < 0.5f) actual_angle = 0.0f;
     
     // 应用偏移
-    actual_angle += angle_offset;
+    actual_angle += sensor->offset;
     
     return actual_angle;
 }
 
+/**
+  * @brief  读取一组ADC原始样本
+  * @param  sensor: 传感器实例
+  * @param  buffer: 样本缓冲区
+  * @param  count: 样本数量(不超过ANGLE_SENSOR_BLOCK_SIZE)
+  * @retval AngleSensorStatus_TypeDef: ANGLE_SENSOR_TIMEOUT表示ADC/DMA未运行
+  * @note   从DMA循环缓冲区取本通道最近的count个样本(由旧到新)，不等待转换
+  */
+AngleSensorStatus_TypeDef ANGLE_SENSOR_ReadBlock(AngleSensor_TypeDef *sensor, uint16_t *buffer, uint8_t count)
+{
+    uint16_t sweep;
+    uint8_t i;
+    
+    if(sensor == NULL || buffer == NULL) return ANGLE_SENSOR_ERROR;
+    if(count > ANGLE_SENSOR_BLOCK_SIZE) return ANGLE_SENSOR_ERROR;
+    if(adc_channel_count == 0 || !(DMA1_Channel1->CCR & DMA_CCR1_EN)) return ANGLE_SENSOR_TIMEOUT;
+    
+    sweep = (uint16_t)((ANGLE_SENSOR_LatestSweep() + ADC_DMA_SWEEPS - count + 1) % ADC_DMA_SWEEPS);
+    for(i=0; i<count; i++) {
+        buffer[i] = adc_dma_buffer[sweep * adc_channel_count + sensor->scan_rank];
+        sweep = (uint16_t)((sweep + 1) % ADC_DMA_SWEEPS);
+    }
+    
+    return ANGLE_SENSOR_OK;
+}
+
+/**
+  * @brief  将ADC样本和换算为角度（定点）
+  * @param  sensor: 传感器实例
+  * @param  adc_sum: ADC样本累加和
+  * @param  count: 参与累加的样本数
+  * @retval int32_t: 角度值 (Q16.16, 度)，已应用偏移，不做限幅和死区处理
+  * @note   保留平均后的亚LSB分辨率，供状态估计器使用
+  */
+int32_t ANGLE_SENSOR_RawToAngleQ16(AngleSensor_TypeDef *sensor, uint32_t adc_sum, uint8_t count)
+{
+    if(count == 0) return sensor->offset_q16;
+    
+    return ANGLE_SENSOR_Lookup(sensor, adc_sum, count) + sensor->offset_q16;
+}
+
+/**
+  * @brief  查线性化表
+  * @param  sensor: 传感器实例
+  * @param  adc_sum: ADC样本累加和
+  * @param  count: 参与累加的样本数(非0)
+  * @retval int32_t: 角度值 (Q16.16, 度)，不含偏移
+  * @note   私有函数。平均值保留8位小数
+  */
+static int32_t ANGLE_SENSOR_Lookup(AngleSensor_TypeDef *sensor, uint32_t adc_sum, uint8_t count)
+{
+    return ANGLE_SENSOR_LookupQ8(sensor, (adc_sum << 8) / count);
+}
+
+/**
+  * @brief  按Q8定点ADC值查线性化表
+  * @param  sensor: 传感器实例
+  * @param  x_q8: ADC值 (Q24.8)
+  * @retval int32_t: 角度值 (Q16.16, 度)，不含偏移
+  * @note   私有函数。在相邻表项间线性插值
+  */
+static int32_t ANGLE_SENSOR_LookupQ8(AngleSensor_TypeDef *sensor, uint32_t x_q8)
+{
+    uint32_t index = x_q8 >> LUT_FRAC_BITS;
+    uint32_t frac = x_q8 & ((1UL << LUT_FRAC_BITS) - 1);
+    int32_t y0, y1;
+    
+    if(index >= ANGLE_SENSOR_LUT_SIZE - 1) return sensor->lut_q16[ANGLE_SENSOR_LUT_SIZE - 1];
+    
+    y0 = sensor->lut_q16[index];
+    y1 = sensor->lut_q16[index + 1];
+    return y0 + (int32_t)(((int64_t)(y1 - y0) * frac) >> LUT_FRAC_BITS);
+}
+
 /**
   * @brief  获取角度详细数据
+  * @param  sensor: 传感器实例
   * @param  angle_data: 角度数据结构体指针
   * @retval AngleSensorStatus_TypeDef: 传感器状态
   */
-AngleSensorStatus_TypeDef ANGLE_SENSOR_GetData(AngleData_TypeDef *angle_data)
+AngleSensorStatus_TypeDef ANGLE_SENSOR_GetData(AngleSensor_TypeDef *sensor, AngleData_TypeDef *angle_data)
 {
-    uint16_t raw_adc;
+    if(sensor == NULL || angle_data == NULL) return ANGLE_SENSOR_ERROR;
     
-    if(angle_data == NULL) return ANGLE_SENSOR_ERROR;
-    
-    raw_adc = ANGLE_SENSOR_ReadRaw();
-    if(raw_adc < ADC_MIN || raw_adc > ADC_MAX) {
+    angle_data->faults = ANGLE_SENSOR_GetFault(sensor);
+    if(angle_data->faults & ANGLE_SENSOR_FAULT_STALE) {
+        angle_data->status = ANGLE_SENSOR_TIMEOUT;
+        return ANGLE_SENSOR_TIMEOUT;
+    }
+    if(angle_data->faults & ANGLE_SENSOR_FAULT_RANGE) {
         angle_data->status = ANGLE_SENSOR_ERROR;
         return ANGLE_SENSOR_ERROR;
     }
     
-    angle_data->angle = ANGLE_SENSOR_GetAngle();
-    angle_data->raw_angle = angle_data->angle - angle_offset;
-    angle_data->timestamp = 0; // 需要系统时间支持
-    angle_data->status = ANGLE_SENSOR_OK;
+    /* 野值过多时数据已经过替换，仍然给出角度，由调用者根据faults决定是否采用 */
+    angle_data->timestamp = 0;
+    angle_data->angle = ANGLE_SENSOR_GetAngleAt(sensor, &angle_data->timestamp);
+    angle_data->raw_angle = angle_data->angle - sensor->offset;
+    angle_data->status = angle_data->faults ? ANGLE_SENSOR_ERROR : ANGLE_SENSOR_OK;
     
-    return ANGLE_SENSOR_OK;
+    return angle_data->status;
 }
 
 /**
   * @brief  校准角度传感器
+  * @param  sensor: 传感器实例
   * @retval AngleSensorStatus_TypeDef: 校准状态
   */
-AngleSensorStatus_TypeDef ANGLE_SENSOR_Calibrate(void)
+AngleSensorStatus_TypeDef ANGLE_SENSOR_Calibrate(AngleSensor_TypeDef *sensor)
 {
-    float current_angle = ANGLE_SENSOR_GetAngle() - angle_offset;
-    angle_offset = -current_angle; // 将当前位置校准为0度
+    float current_angle = ANGLE_SENSOR_GetAngle(sensor) - sensor->offset;
+    ANGLE_SENSOR_SetOffset(sensor, -current_angle); // 将当前位置校准为0度
     return ANGLE_SENSOR_OK;
 }
 
 /**
   * @brief  设置角度偏移
+  * @param  sensor: 传感器实例
   * @param  offset_angle: 偏移角度值
   * @retval 无
   */
-void ANGLE_SENSOR_SetOffset(float offset_angle)
+void ANGLE_SENSOR_SetOffset(AngleSensor_TypeDef *sensor, float offset_angle)
+{
+    sensor->offset = offset_angle;
+    sensor->offset_q16 = (int32_t)(offset_angle * 65536.0f);
+}
+
+/**
+  * @brief  获取角度偏移
+  * @param  sensor: 传感器实例
+  * @retval float: 当前偏移角度值
+  */
+float ANGLE_SENSOR_GetOffset(AngleSensor_TypeDef *sensor)
 {
-    angle_offset = offset_angle;
+    return sensor->offset;
 }
 
 /**
   * @brief  读取ADC原始值
-  * @retval uint16_t: ADC原始读数
+  * @param  sensor: 传感器实例
+  * @retval uint16_t: 最近一轮扫描中本通道的ADC读数，ADC未运行时返回0
   */
-uint16_t ANGLE_SENSOR_ReadRaw(void)
+uint16_t ANGLE_SENSOR_ReadRaw(AngleSensor_TypeDef *sensor)
 {
-    uint32_t timeout = ADC_TIMEOUT_COUNT;
-    while(!ADC_GetFlagStatus(ADC1, ADC_FLAG_EOC)) {
-        if(--timeout == 0) {
-            return 0;  // 超时返回0
+    if(adc_channel_count == 0) return 0;
+    
+    return adc_dma_buffer[ANGLE_SENSOR_LatestSweep() * adc_channel_count + sensor->scan_rank];
+}
+
+/**
+  * @brief  定位最近一轮完整扫描
+  * @param  无
+  * @retval uint16_t: 扫描轮序号(0 - ADC_DMA_SWEEPS-1)
+  * @note   私有函数。CNDTR为剩余传输数，据此求DMA正在写的位置
+  */
+static uint16_t ANGLE_SENSOR_LatestSweep(void)
+{
+    uint16_t total = (uint16_t)ADC_DMA_SWEEPS * adc_channel_count;
+    uint16_t next = total - (uint16_t)DMA1_Channel1->CNDTR;
+    
+    return (uint16_t)((next / adc_channel_count + ADC_DMA_SWEEPS - 1) % ADC_DMA_SWEEPS);
+}
+
+/**
+  * @brief  设置过采样率
+  * @param  osr_log2: 过采样率的log2，限制在[ANGLE_SENSOR_OSR_LOG2_MIN, ANGLE_SENSOR_OSR_LOG2_MAX]
+  * @retval 无
+  * @note   对所有通道生效并清空累加器，新窗口完成前ReadOversampled返回超时。
+  *         估计器按过采样率计算测量噪声：在ANGLE_CONTROL_Init之前设置，
+  *         或由ANGLE_CONTROL_SetLoopRate随控制周期选择
+  */
+void ANGLE_SENSOR_SetOversampling(uint8_t osr_log2)
+{
+    uint8_t i;
+    
+    if(osr_log2 < ANGLE_SENSOR_OSR_LOG2_MIN) osr_log2 = ANGLE_SENSOR_OSR_LOG2_MIN;
+    if(osr_log2 > ANGLE_SENSOR_OSR_LOG2_MAX) osr_log2 = ANGLE_SENSOR_OSR_LOG2_MAX;
+    
+    __disable_irq();
+    adc_osr_log2 = osr_log2;
+    for(i=0; i<adc_channel_count; i++) {
+        ANGLE_SENSOR_OsrReset(&adc_sensors[i].osr);
+    }
+    __enable_irq();
+}
+
+/**
+  * @brief  按控制周期选择过采样率
+  * @param  period_us: 控制周期(us)
+  * @retval uint8_t: 选定的过采样率(log2)
+  * @note   取窗口时长不超过一个控制周期的最大过采样率，使每个周期都有新窗口；
+  *         不超过默认值，避免低控制频率下窗口过长增加延迟。须在ANGLE_SENSOR_Init之后调用
+  */
+uint8_t ANGLE_SENSOR_FitOversampling(uint32_t period_us)
+{
+    uint32_t window_ns = (uint32_t)ADC_CONVERSION_NS * (adc_channel_count ? adc_channel_count : 1);
+    uint32_t scans = (uint32_t)(((uint64_t)period_us * 1000) / window_ns);
+    uint8_t osr_log2 = ANGLE_SENSOR_OSR_LOG2_MIN;
+    
+    while(osr_log2 < ANGLE_SENSOR_OSR_LOG2_DEFAULT && (2UL << osr_log2) <= scans) {
+        osr_log2++;
+    }
+    ANGLE_SENSOR_SetOversampling(osr_log2);
+    
+    return osr_log2;
+}
+
+/**
+  * @brief  获取过采样率
+  * @param  无
+  * @retval uint16_t: 每个窗口的样本数
+  */
+uint16_t ANGLE_SENSOR_GetOversampling(void)
+{
+    return (uint16_t)(1U << adc_osr_log2);
+}
+
+/**
+  * @brief  读取最近一个过采样窗口
+  * @param  sensor: 传感器实例
+  * @param  sum: 输出窗口内样本和
+  * @param  osr_log2: 输出窗口样本数的log2
+  * @param  timestamp: 输出窗口结束时刻(us)，可为NULL
+  * @retval AngleSensorStatus_TypeDef: ANGLE_SENSOR_TIMEOUT表示尚无完整窗口
+  * @note   窗口平均值对应的时刻比结束时刻早约半个窗口时长
+  */
+AngleSensorStatus_TypeDef ANGLE_SENSOR_ReadOversampled(AngleSensor_TypeDef *sensor, uint32_t *sum, uint8_t *osr_log2,
+                                                       uint64_t *timestamp)
+{
+    uint32_t windows;
+    
+    if(sensor == NULL || sum == NULL || osr_log2 == NULL) return ANGLE_SENSOR_ERROR;
+    
+    /* 和、位数与时间戳须来自同一窗口 */
+    __disable_irq();
+    windows = sensor->osr.windows;
+    *sum = sensor->osr.sum;
+    *osr_log2 = sensor->osr.sum_log2;
+    if(timestamp != NULL) *timestamp = sensor->osr.timestamp;
+    __enable_irq();
+    
+    return (windows == 0) ? ANGLE_SENSOR_TIMEOUT : ANGLE_SENSOR_OK;
+}
+
+/**
+  * @brief  读取抽取后的ADC码
+  * @param  sensor: 传感器实例
+  * @param  code: 输出16位ADC码(满量程65535，对应12位的4095*16)
+  * @retval AngleSensorStatus_TypeDef: ANGLE_SENSOR_TIMEOUT表示尚无完整窗口
+  * @note   有效位数约为12+osr_log2/2，低位在过采样率不足16位时只是补零
+  */
+AngleSensorStatus_TypeDef ANGLE_SENSOR_ReadDecimated(AngleSensor_TypeDef *sensor, uint16_t *code)
+{
+    AngleSensorStatus_TypeDef status;
+    uint32_t sum;
+    uint8_t osr_log2;
+    
+    if(code == NULL) return ANGLE_SENSOR_ERROR;
+    
+    status = ANGLE_SENSOR_ReadOversampled(sensor, &sum, &osr_log2, NULL);
+    if(status != ANGLE_SENSOR_OK) return status;
+    
+    *code = (uint16_t)((sum << 4) >> osr_log2);
+    return ANGLE_SENSOR_OK;
+}
+
+/**
+  * @brief  由最近一个过采样窗口求角度（定点）
+  * @param  sensor: 传感器实例
+  * @param  angle_q16: 输出角度值 (Q16.16, 度)，已应用偏移，不做限幅和死区处理
+  * @param  timestamp: 输出窗口结束时刻(us)，可为NULL
+  * @retval AngleSensorStatus_TypeDef: ANGLE_SENSOR_TIMEOUT表示尚无完整窗口
+  * @note   窗口平均只用移位，保留8位小数后查表
+  */
+AngleSensorStatus_TypeDef ANGLE_SENSOR_GetAngleQ16(AngleSensor_TypeDef *sensor, int32_t *angle_q16,
+                                                   uint64_t *timestamp)
+{
+    AngleSensorStatus_TypeDef status;
+    uint32_t sum;
+    uint8_t osr_log2;
+    
+    if(angle_q16 == NULL) return ANGLE_SENSOR_ERROR;
+    
+    status = ANGLE_SENSOR_ReadOversampled(sensor, &sum, &osr_log2, timestamp);
+    if(status != ANGLE_SENSOR_OK) return status;
+    
+    *angle_q16 = ANGLE_SENSOR_LookupQ8(sensor, (sum << 8) >> osr_log2) + sensor->offset_q16;
+    return ANGLE_SENSOR_OK;
+}
+
+/**
+  * @brief  向过采样累加器送入样本
+  * @param  osr: 累加器
+  * @param  osr_log2: 过采样率的log2
+  * @param  samples: 第一个样本
+  * @param  count: 样本数
+  * @param  stride: 相邻样本的间隔(扫描序列的通道数)
+  * @retval 无
+  * @note   每满2^osr_log2个样本更新窗口和并开始新窗口，不依赖硬件，可在主机上测试
+  */
+void ANGLE_SENSOR_OsrPush(volatile AngleOsr_TypeDef *osr, uint8_t osr_log2,
+                          const volatile uint16_t *samples, uint16_t count, uint8_t stride)
+{
+    uint16_t window = (uint16_t)(1U << osr_log2);
+    uint32_t acc = osr->acc;
+    uint16_t n = osr->count;
+    uint16_t i;
+    
+    for(i=0; i<count; i++) {
+        acc += *samples;
+        samples += stride;
+        if(++n >= window) {
+            osr->sum = acc;
+            osr->sum_log2 = osr_log2;
+            osr->faults = (uint8_t)((osr->range_hits ? ANGLE_SENSOR_FAULT_RANGE : 0) |
+                                    (osr->outliers > (window >> ANGLE_SENSOR_NOISY_SHIFT) ? ANGLE_SENSOR_FAULT_NOISY : 0));
+            osr->outliers = 0;
+            osr->range_hits = 0;
+            osr->windows++;
+            acc = 0;
+            n = 0;
         }
     }
-    return ADC_GetConversionValue(ADC1);
+    
+    osr->acc = acc;
+    osr->count = n;
+}
+
+/**
+  * @brief  对样本做野值剔除后送入过采样累加器
+  * @param  osr: 累加器
+  * @param  osr_log2: 过采样率的log2
+  * @param  samples: 第一个样本
+  * @param  count: 样本数(ANGLE_SENSOR_ROBUST_N的整数倍，余下的样本丢弃)
+  * @param  stride: 相邻样本的间隔(扫描序列的通道数)
+  * @retval 无
+  * @note   每组样本独立判定，替换数和超量程组数计入当前窗口；
+  *         量程为osr->range_min/range_max，随线性化表更新
+  */
+void ANGLE_SENSOR_FrontEnd(volatile AngleOsr_TypeDef *osr, uint8_t osr_log2,
+                           const volatile uint16_t *samples, uint16_t count, uint8_t stride)
+{
+    uint16_t block[ANGLE_SENSOR_ROBUST_N];
+    uint16_t median;
+    uint16_t i;
+    uint8_t j;
+    
+    for(i=0; i + ANGLE_SENSOR_ROBUST_N <= count; i += ANGLE_SENSOR_ROBUST_N) {
+        for(j=0; j<ANGLE_SENSOR_ROBUST_N; j++) {
+            block[j] = *samples;
+            samples += stride;
+        }
+        
+        osr->outliers += ANGLE_SENSOR_Hampel(block, &median);
+        if(median < osr->range_min || median > osr->range_max) {
+            osr->range_hits++;
+        }
+        
+        ANGLE_SENSOR_OsrPush(osr, osr_log2, block, ANGLE_SENSOR_ROBUST_N, 1);
+    }
+}
+
+/**
+  * @brief  一组样本的中值与野值替换(Hampel判据)
+  * @param  block: ANGLE_SENSOR_ROBUST_N个样本，野值原地替换为中值
+  * @param  median: 输出中值
+  * @retval uint8_t: 被替换的样本数
+  * @note   中值和MAD各用一次排序网络求出，阈值4.5*MAD约为高斯噪声的3σ
+  */
+uint8_t ANGLE_SENSOR_Hampel(uint16_t *block, uint16_t *median)
+{
+    uint16_t sorted[ANGLE_SENSOR_ROBUST_N];
+    uint16_t dev[ANGLE_SENSOR_ROBUST_N];
+    uint16_t med, mad, limit;
+    uint8_t replaced = 0;
+    uint8_t i;
+    
+    for(i=0; i<ANGLE_SENSOR_ROBUST_N; i++) {
+        sorted[i] = block[i];
+    }
+    ANGLE_SENSOR_Sort8(sorted);
+    med = (uint16_t)((sorted[3] + sorted[4] + 1) >> 1);
+    
+    for(i=0; i<ANGLE_SENSOR_ROBUST_N; i++) {
+        dev[i] = (block[i] > med) ? (uint16_t)(block[i] - med) : (uint16_t)(med - block[i]);
+    }
+    ANGLE_SENSOR_Sort8(dev);
+    mad = (uint16_t)((dev[3] + dev[4] + 1) >> 1);
+    
+    limit = (uint16_t)((mad * 9U) >> 1);
+    if(limit < ANGLE_SENSOR_HAMPEL_FLOOR) limit = ANGLE_SENSOR_HAMPEL_FLOOR;
+    
+    for(i=0; i<ANGLE_SENSOR_ROBUST_N; i++) {
+        if(block[i] > med + limit || block[i] + limit < med) {
+            block[i] = med;
+            replaced++;
+        }
+    }
+    
+    *median = med;
+    return replaced;
+}
+
+/**
+  * @brief  获取传感器故障标志
+  * @param  sensor: 传感器实例
+  * @retval uint8_t: ANGLE_SENSOR_FAULT_x的组合，0表示正常
+  * @note   每个控制周期调用一次；连续ANGLE_SENSOR_STALE_CALLS次没有新窗口时报数据停止
+  */
+uint8_t ANGLE_SENSOR_GetFault(AngleSensor_TypeDef *sensor)
+{
+    uint32_t windows = sensor->osr.windows;
+    uint8_t faults = sensor->osr.faults;
+    
+    if(windows != sensor->fault_windows) {
+        sensor->fault_windows = windows;
+        sensor->stale_count = 0;
+    } else if(sensor->stale_count < ANGLE_SENSOR_STALE_CALLS) {
+        sensor->stale_count++;
+    }
+    
+    if(windows == 0 || sensor->stale_count >= ANGLE_SENSOR_STALE_CALLS) {
+        faults |= ANGLE_SENSOR_FAULT_STALE;
+    }
+    
+    return faults;
+}
+
+/**
+  * @brief  8个样本升序排序
+  * @param  v: 样本数组
+  * @retval 无
+  * @note   私有函数。19个比较器的最优排序网络，无数据相关分支长度
+  */
+static void ANGLE_SENSOR_Sort8(uint16_t *v)
+{
+    SORT2(v[0], v[2]); SORT2(v[1], v[3]); SORT2(v[4], v[6]); SORT2(v[5], v[7]);
+    SORT2(v[0], v[4]); SORT2(v[1], v[5]); SORT2(v[2], v[6]); SORT2(v[3], v[7]);
+    SORT2(v[0], v[1]); SORT2(v[2], v[3]); SORT2(v[4], v[5]); SORT2(v[6], v[7]);
+    SORT2(v[2], v[4]); SORT2(v[3], v[5]);
+    SORT2(v[1], v[4]); SORT2(v[3], v[6]);
+    SORT2(v[1], v[2]); SORT2(v[3], v[4]); SORT2(v[5], v[6]);
+}
+
+/**
+  * @brief  DMA1通道1中断处理
+  * @param  无
+  * @retval 无
+  * @note   在DMA1_Channel1_IRQHandler中调用。半满时处理前半缓冲，全满时处理后半缓冲；
+  *         本次完成的窗口以进入中断的时刻为结束时间戳(OSR<64时偏晚不足一个半缓冲)
+  */
+void ANGLE_SENSOR_DMA_IRQHandler(void)
+{
+    const volatile uint16_t *half;
+    uint64_t now = TIMEBASE_GetMicros();
+    uint32_t windows;
+    uint8_t i;
+    
+    if(DMA_GetITStatus(DMA1_IT_HT1) != RESET) {
+        DMA_ClearITPendingBit(DMA1_IT_HT1);
+        half = adc_dma_buffer;
+    } else if(DMA_GetITStatus(DMA1_IT_TC1) != RESET) {
+        DMA_ClearITPendingBit(DMA1_IT_TC1);
+        half = adc_dma_buffer + ANGLE_SENSOR_OSR_CHUNK * adc_channel_count;
+    } else {
+        DMA_ClearITPendingBit(DMA1_IT_GL1);
+        return;
+    }
+    
+    for(i=0; i<adc_channel_count; i++) {
+        windows = adc_sensors[i].osr.windows;
+        ANGLE_SENSOR_FrontEnd(&adc_sensors[i].osr, adc_osr_log2,
+                              half + i, ANGLE_SENSOR_OSR_CHUNK, adc_channel_count);
+        if(adc_sensors[i].osr.windows != windows) {
+            adc_sensors[i].osr.timestamp = now;
+        }
+    }
+}
+
+/**
+  * @brief  清空过采样累加器
+  * @param  osr: 累加器
+  * @retval 无
+  * @note   私有函数
+  */
+static void ANGLE_SENSOR_OsrReset(volatile AngleOsr_TypeDef *osr)
+{
+    osr->acc = 0;
+    osr->count = 0;
+    osr->sum = 0;
+    osr->sum_log2 = 0;
+    osr->windows = 0;
+    osr->outliers = 0;
+    osr->range_hits = 0;
+    osr->faults = 0;
+    osr->timestamp = 0;
+}
+
+/**
+  * @brief  恢复默认两段线性表
+  * @param  sensor: 传感器实例
+  * @retval 无
+  * @note   ADC_MIN/ADC_MID/ADC_MAX分别对应-90/0/90度，两端外推
+  */
+void ANGLE_SENSOR_ResetLinearization(AngleSensor_TypeDef *sensor)
+{
+    int32_t x;
+    float angle;
+    uint8_t i;
+    
+    for(i=0; i<ANGLE_SENSOR_LUT_SIZE; i++) {
+        x = (int32_t)i << ANGLE_SENSOR_LUT_SHIFT;
+        if(x <= ADC_MID) {
+            angle = (x - ADC_MID) * 90.0f / (ADC_MID - ADC_MIN);
+        } else {
+            angle = (x - ADC_MID) * 90.0f / (ADC_MAX - ADC_MID);
+        }
+        sensor->lut_q16[i] = (int32_t)(angle * 65536.0f);
+    }
+    sensor->calibrated = 0;
+    ANGLE_SENSOR_UpdateRange(sensor);
+}
+
+/**
+  * @brief  由线性化表更新量程故障门限
+  * @param  sensor: 传感器实例
+  * @retval 无
+  * @note   私有函数。取表中±90度对应的ADC位置，向外各加RANGE_MARGIN，
+  *         校准后断线/短路门限随传感器实际的输出范围移动
+  */
+static void ANGLE_SENSOR_UpdateRange(AngleSensor_TypeDef *sensor)
+{
+    int32_t a = ANGLE_SENSOR_AdcAtAngle(sensor, -RANGE_ANGLE_Q16);
+    int32_t b = ANGLE_SENSOR_AdcAtAngle(sensor, RANGE_ANGLE_Q16);
+    int32_t lo = ((a < b) ? a : b) - RANGE_MARGIN;
+    int32_t hi = ((a < b) ? b : a) + RANGE_MARGIN;
+    
+    if(lo < 0) lo = 0;
+    if(hi > 4095) hi = 4095;
+    sensor->osr.range_min = (uint16_t)lo;
+    sensor->osr.range_max = (uint16_t)hi;
+}
+
+/**
+  * @brief  在线性化表中反查角度对应的ADC读数
+  * @param  sensor: 传感器实例
+  * @param  angle_q16: 角度(Q16.16)，不含偏移
+  * @retval int32_t: ADC计数；表内达不到该角度时取表的对应端
+  * @note   私有函数。表单调(递增或递减)，在包含该角度的一段内线性插值
+  */
+static int32_t ANGLE_SENSOR_AdcAtAngle(AngleSensor_TypeDef *sensor, int32_t angle_q16)
+{
+    const int32_t *lut = sensor->lut_q16;
+    int32_t y0, y1;
+    uint8_t rising = (lut[ANGLE_SENSOR_LUT_SIZE - 1] >= lut[0]) ? 1 : 0;
+    uint8_t i;
+    
+    for(i=0; i<ANGLE_SENSOR_LUT_SIZE - 1; i++) {
+        y0 = lut[i];
+        y1 = lut[i + 1];
+        if((angle_q16 >= y0 && angle_q16 <= y1) || (angle_q16 <= y0 && angle_q16 >= y1)) {
+            if(y1 == y0) return (int32_t)i << ANGLE_SENSOR_LUT_SHIFT;
+            return ((int32_t)i << ANGLE_SENSOR_LUT_SHIFT) +
+                   (int32_t)(((int64_t)(angle_q16 - y0) << ANGLE_SENSOR_LUT_SHIFT) / (y1 - y0));
+        }
+    }
+    
+    /* 表内达不到：低于表的角度取低角度一端 */
+    if((angle_q16 < lut[0]) == (rising != 0)) return 0;
+    return (ANGLE_SENSOR_LUT_SIZE - 1) << ANGLE_SENSOR_LUT_SHIFT;
+}
+
+/**
+  * @brief  开始多点校准
+  * @param  sensor: 传感器实例
+  * @retval 无
+  * @note   清除已采集的参考点，线性化表在CalFinish成功前保持不变
+  */
+void ANGLE_SENSOR_CalBegin(AngleSensor_TypeDef *sensor)
+{
+    sensor->cal_count = 0;
+}
+
+/**
+  * @brief  在当前位置采集一个参考点
+  * @param  sensor: 传感器实例
+  * @param  reference_angle: 板子当前的真实角度(度)，来自角度治具或引导扫描的已知位置
+  * @retval AngleSensorStatus_TypeDef: ANGLE_SENSOR_ERROR表示参考点已满
+  * @note   取最近一个过采样窗口的平均ADC读数，板子需静止
+  */
+AngleSensorStatus_TypeDef ANGLE_SENSOR_CalAddPoint(AngleSensor_TypeDef *sensor, float reference_angle)
+{
+    uint32_t sum;
+    uint8_t osr_log2;
+    AngleSensorStatus_TypeDef status;
+    
+    if(sensor->cal_count >= ANGLE_SENSOR_CAL_MAX_POINTS) return ANGLE_SENSOR_ERROR;
+    
+    status = ANGLE_SENSOR_ReadOversampled(sensor, &sum, &osr_log2, NULL);
+    if(status != ANGLE_SENSOR_OK) return status;
+    
+    sensor->cal_adc[sensor->cal_count] = (float)sum / (float)(1UL << osr_log2);
+    sensor->cal_angle[sensor->cal_count] = reference_angle;
+    sensor->cal_count++;
+    
+    return ANGLE_SENSOR_OK;
+}
+
+/**
+  * @brief  由参考点生成线性化表
+  * @param  sensor: 传感器实例
+  * @retval AngleSensorStatus_TypeDef: ANGLE_SENSOR_ERROR表示点数不足、间距过小或不单调，表不变
+  * @note   参考点按ADC排序后用单调三次Hermite(Fritsch-Carlson)插值，保证表单调；
+  *         两点时即为直线。参考角度为绝对角度，成功后偏移清零
+  */
+AngleSensorStatus_TypeDef ANGLE_SENSOR_CalFinish(AngleSensor_TypeDef *sensor)
+{
+    float *x = sensor->cal_adc;
+    float *y = sensor->cal_angle;
+    float slope[ANGLE_SENSOR_CAL_MAX_POINTS];
+    float secant[ANGLE_SENSOR_CAL_MAX_POINTS];
+    float h, t, t2, t3, xi, angle, w1, w2, tmp;
+    uint8_t n = sensor->cal_count;
+    uint8_t i, j, k;
+    
+    if(n < 2) return ANGLE_SENSOR_ERROR;
+    
+    /* 按ADC读数排序 */
+    for(i=1; i<n; i++) {
+        for(j=i; j>0 && x[j] < x[j-1]; j--) {
+            tmp = x[j]; x[j] = x[j-1]; x[j-1] = tmp;
+            tmp = y[j]; y[j] = y[j-1]; y[j-1] = tmp;
+        }
+    }
+    
+    /* 检查间距和单调性，求各段割线斜率 */
+    for(k=0; k<n-1; k++) {
+        h = x[k+1] - x[k];
+        if(h < ANGLE_SENSOR_CAL_MIN_SPACING) return ANGLE_SENSOR_ERROR;
+        secant[k] = (y[k+1] - y[k]) / h;
+        if(secant[k] == 0.0f || secant[k] * secant[0] < 0.0f) return ANGLE_SENSOR_ERROR;
+    }
+    
+    /* 节点斜率：端点取端段割线，内点取加权调和平均 */
+    slope[0] = secant[0];
+    slope[n-1] = secant[n-2];
+    for(k=1; k<n-1; k++) {
+        w1 = 2.0f * (x[k+1] - x[k]) + (x[k] - x[k-1]);
+        w2 = (x[k+1] - x[k]) + 2.0f * (x[k] - x[k-1]);
+        slope[k] = (w1 + w2) / (w1 / secant[k-1] + w2 / secant[k]);
+    }
+    
+    /* 在表节点处求值 */
+    k = 0;
+    for(i=0; i<ANGLE_SENSOR_LUT_SIZE; i++) {
+        xi = (float)((int32_t)i << ANGLE_SENSOR_LUT_SHIFT);
+        if(xi <= x[0]) {
+            angle = y[0] + slope[0] * (xi - x[0]);
+        } else if(xi >= x[n-1]) {
+            angle = y[n-1] + slope[n-1] * (xi - x[n-1]);
+        } else {
+            while(xi > x[k+1]) k++;
+            h = x[k+1] - x[k];
+            t = (xi - x[k]) / h;
+            t2 = t * t;
+            t3 = t2 * t;
+            angle = (2.0f * t3 - 3.0f * t2 + 1.0f) * y[k] + (t3 - 2.0f * t2 + t) * h * slope[k]
+                  + (-2.0f * t3 + 3.0f * t2) * y[k+1] + (t3 - t2) * h * slope[k+1];
+        }
+        if(angle > LUT_ANGLE_LIMIT) angle = LUT_ANGLE_LIMIT;
+        if(angle < -LUT_ANGLE_LIMIT) angle = -LUT_ANGLE_LIMIT;
+        sensor->lut_q16[i] = (int32_t)(angle * 65536.0f);
+    }
+    
+    sensor->calibrated = 1;
+    ANGLE_SENSOR_UpdateRange(sensor);
+    ANGLE_SENSOR_SetOffset(sensor, 0.0f);
+    
+    return ANGLE_SENSOR_OK;
+}
+
+/**
+  * @brief  保存线性化表
+  * @param  sensors: 传感器实例数组(与初始化时相同)
+  * @param  count: 传感器数量
+  * @retval AngleSensorStatus_TypeDef: ANGLE_SENSOR_ERROR表示参数存储已满
+  * @note   按扫描位置写入参数存储，未校准的位置删除已保存的表；
+  *         由参数存储在主循环中写入Flash
+  */
+AngleSensorStatus_TypeDef ANGLE_SENSOR_SaveCalibration(AngleSensor_TypeDef *sensors, uint8_t count)
+{
+    uint8_t i;
+    
+    if(sensors == NULL || count == 0 || count > ANGLE_SENSOR_MAX_CHANNELS) return ANGLE_SENSOR_ERROR;
+    
+    for(i=0; i<count; i++) {
+        if(!sensors[i].calibrated) {
+            PARAM_Delete(PARAM_KEY_ANGLE_LUT(sensors[i].scan_rank));
+        } else if(PARAM_Set(PARAM_KEY_ANGLE_LUT(sensors[i].scan_rank), sensors[i].lut_q16,
+                            sizeof(sensors[i].lut_q16)) != PARAM_OK) {
+            return ANGLE_SENSOR_ERROR;
+        }
+    }
+    
+    return ANGLE_SENSOR_OK;
+}
+
+/**
+  * @brief  加载线性化表
+  * @param  sensors: 传感器实例数组(已初始化)
+  * @param  count: 传感器数量
+  * @retval uint8_t: 加载成功的传感器个数
+  * @note   须在PARAM_Init之后调用，未保存的位置保持默认表
+  */
+uint8_t ANGLE_SENSOR_LoadCalibration(AngleSensor_TypeDef *sensors, uint8_t count)
+{
+    uint8_t loaded = 0;
+    uint8_t i;
+    
+    if(sensors == NULL || count > ANGLE_SENSOR_MAX_CHANNELS) return 0;
+    
+    for(i=0; i<count; i++) {
+        if(PARAM_Get(PARAM_KEY_ANGLE_LUT(sensors[i].scan_rank), sensors[i].lut_q16,
+                     sizeof(sensors[i].lut_q16)) == PARAM_OK) {
+            sensors[i].calibrated = 1;
+            ANGLE_SENSOR_UpdateRange(&sensors[i]);
+            loaded++;
+        }
+    }
+    
+    return loaded;
 }
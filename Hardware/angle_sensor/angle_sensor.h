@@ -14,16 +14,132 @@ typedef enum {
 typedef struct {
     float angle;              // 当前角度值 (度)
     float raw_angle;          // 原始角度读数
-    uint32_t timestamp;       // 时间戳（读取时间）
+    uint64_t timestamp;       // 所用过采样窗口结束时刻(us，TIMEBASE_GetMicros)
     AngleSensorStatus_TypeDef status; // 传感器状态
+    uint8_t faults;           // 故障标志(ANGLE_SENSOR_FAULT_x)
 } AngleData_TypeDef;
 
+/* 采样块配置 */
+#define ANGLE_SENSOR_BLOCK_SIZE   8       // 每次控制周期采集的ADC样本数
+#define ANGLE_SENSOR_MAX_CHANNELS 4       // ADC1扫描序列最多的角度通道数
+
+/*
+ * ADC->角度线性化表：ADC计数按ANGLE_SENSOR_LUT_STEP等分，表项为节点处的角度(Q16.16)，
+ * 运行时查表+线性插值。未校准时由默认两段线性关系生成；多点校准时
+ * 由参考点经单调三次Hermite插值(PCHIP)生成，两端按端段斜率外推。
+ */
+#define ANGLE_SENSOR_LUT_SHIFT    6                                     // 表步长的位数
+#define ANGLE_SENSOR_LUT_STEP     (1 << ANGLE_SENSOR_LUT_SHIFT)         // 表步长(ADC计数)
+#define ANGLE_SENSOR_LUT_SIZE     ((4096 >> ANGLE_SENSOR_LUT_SHIFT) + 1) // 表点数(65)
+#define ANGLE_SENSOR_CAL_MAX_POINTS 9     // 多点校准最多参考点数
+#define ANGLE_SENSOR_CAL_MIN_SPACING 16   // 相邻参考点最小ADC间距(计数)
+
+/*
+ * 过采样与抽取：DMA循环缓冲分两半，每半ANGLE_SENSOR_OSR_CHUNK轮扫描，
+ * 半满/全满中断把刚写完的一半按通道累加，每2^osr_log2个样本得到一个窗口和。
+ * 噪声不小于约0.5LSB时，每4倍过采样增加1位有效分辨率：
+ * OSR=256(osr_log2=8)时为16位。窗口时长为 OSR*通道数*5.67us，应小于控制周期
+ * (3通道OSR=256约4.4ms)。累加与换算全部为整数运算。
+ */
+#define ANGLE_SENSOR_OSR_CHUNK    64      // 每个半缓冲的扫描轮数(半满中断约1ms一次)
+#define ANGLE_SENSOR_OSR_LOG2_MIN 2       // 最小过采样率 2^2
+#define ANGLE_SENSOR_OSR_LOG2_MAX 10      // 最大过采样率 2^10(窗口和不超过22位)
+#define ANGLE_SENSOR_OSR_LOG2_DEFAULT 8   // 默认过采样率 256
+
+/*
+ * 鲁棒前端：累加前每ANGLE_SENSOR_ROBUST_N个样本为一组，排序网络求中值和MAD，
+ * 偏离中值超过 max(4.5*MAD, ANGLE_SENSOR_HAMPEL_FLOOR) 的样本(Hampel判据，约3σ)
+ * 以中值替换，单个ADC毛刺不再进入平均值。每组固定两次19比较器排序，开销有界。
+ * 每个过采样窗口统计替换的样本数和中值超量程的组数，窗口完成时生成故障标志。
+ */
+#define ANGLE_SENSOR_ROBUST_N     8       // 每组样本数(须整除ANGLE_SENSOR_OSR_CHUNK)
+#define ANGLE_SENSOR_HAMPEL_FLOOR 8       // 判据下限(LSB)，噪声很小时避免误判
+#define ANGLE_SENSOR_NOISY_SHIFT  3       // 窗口内替换样本超过窗口的1/8时报噪声故障
+#define ANGLE_SENSOR_STALE_CALLS  5       // 连续多少次GetFault无新窗口时报数据停止
+
+/* 传感器故障标志 */
+#define ANGLE_SENSOR_FAULT_RANGE  0x01    // 中值超出线性化表±90度位置外加余量(断线/短路)
+#define ANGLE_SENSOR_FAULT_NOISY  0x02    // 窗口内野值过多(接触不良/干扰)
+#define ANGLE_SENSOR_FAULT_STALE  0x04    // 没有新的过采样窗口(ADC/DMA停止)
+
+/* 角度传感器硬件描述 */
+typedef struct {
+    GPIO_TypeDef *port;       // 模拟输入端口
+    uint16_t pin;             // 模拟输入引脚
+    uint32_t gpio_rcc;        // 端口时钟
+    uint8_t adc_channel;      // ADC通道号
+} AngleSensorConfig_TypeDef;
+
+/* 过采样累加器(由DMA中断更新) */
+typedef struct {
+    uint32_t acc;             // 当前窗口的累加和
+    uint16_t count;           // 当前窗口已累加的样本数
+    uint32_t sum;             // 最近一个完整窗口的样本和
+    uint8_t sum_log2;         // sum对应的过采样率(log2)
+    uint32_t windows;         // 已完成的窗口数
+    uint16_t outliers;        // 当前窗口被替换的样本数
+    uint16_t range_hits;      // 当前窗口中值超量程的组数
+    uint16_t range_min;       // 有效中值下限(ADC计数)，由线性化表求出
+    uint16_t range_max;       // 有效中值上限(ADC计数)
+    uint8_t faults;           // 最近一个完整窗口的故障标志
+    uint64_t timestamp;       // 最近一个完整窗口的结束时刻(us)
+} AngleOsr_TypeDef;
+
+/* 角度传感器实例 */
+typedef struct {
+    const AngleSensorConfig_TypeDef *config; // 硬件描述
+    uint8_t scan_rank;        // 在ADC扫描序列中的位置(0起)
+    float offset;             // 角度偏移值
+    int32_t offset_q16;       // 角度偏移值 (Q16.16)
+    int32_t lut_q16[ANGLE_SENSOR_LUT_SIZE]; // ADC->角度线性化表 (Q16.16)
+    uint8_t calibrated;       // 1: 线性化表来自多点校准
+    
+    /* 多点校准参考点(按采集顺序) */
+    float cal_adc[ANGLE_SENSOR_CAL_MAX_POINTS];   // 平均ADC读数
+    float cal_angle[ANGLE_SENSOR_CAL_MAX_POINTS]; // 参考角度(度)
+    uint8_t cal_count;        // 已采集点数
+    
+    volatile AngleOsr_TypeDef osr; // 过采样累加器
+    uint32_t fault_windows;   // GetFault上次看到的窗口数
+    uint8_t stale_count;      // 连续无新窗口的GetFault次数
+} AngleSensor_TypeDef;
+
+/* 预定义硬件描述 */
+extern const AngleSensorConfig_TypeDef ANGLE_SENSOR_CONFIG_PA3;  // PA3 / ADC通道3
+extern const AngleSensorConfig_TypeDef ANGLE_SENSOR_CONFIG_PC2;  // PC2 / ADC通道12
+extern const AngleSensorConfig_TypeDef ANGLE_SENSOR_CONFIG_PC3;  // PC3 / ADC通道13
+
 /* 函数声明 */
-AngleSensorStatus_TypeDef ANGLE_SENSOR_Init(void);
-float ANGLE_SENSOR_GetAngle(void);
-AngleSensorStatus_TypeDef ANGLE_SENSOR_GetData(AngleData_TypeDef *angle_data);
-AngleSensorStatus_TypeDef ANGLE_SENSOR_Calibrate(void);
-void ANGLE_SENSOR_SetOffset(float offset_angle);
-uint16_t ANGLE_SENSOR_ReadRaw(void);
+AngleSensorStatus_TypeDef ANGLE_SENSOR_Init(AngleSensor_TypeDef *sensors, const AngleSensorConfig_TypeDef *const *configs, uint8_t count);
+float ANGLE_SENSOR_GetAngle(AngleSensor_TypeDef *sensor);
+float ANGLE_SENSOR_GetAngleAt(AngleSensor_TypeDef *sensor, uint64_t *timestamp);       // 获取角度及其采样时刻(us)
+AngleSensorStatus_TypeDef ANGLE_SENSOR_ReadBlock(AngleSensor_TypeDef *sensor, uint16_t *buffer, uint8_t count);
+int32_t ANGLE_SENSOR_RawToAngleQ16(AngleSensor_TypeDef *sensor, uint32_t adc_sum, uint8_t count);
+AngleSensorStatus_TypeDef ANGLE_SENSOR_GetData(AngleSensor_TypeDef *sensor, AngleData_TypeDef *angle_data);
+AngleSensorStatus_TypeDef ANGLE_SENSOR_Calibrate(AngleSensor_TypeDef *sensor);
+void ANGLE_SENSOR_SetOffset(AngleSensor_TypeDef *sensor, float offset_angle);
+float ANGLE_SENSOR_GetOffset(AngleSensor_TypeDef *sensor);
+uint16_t ANGLE_SENSOR_ReadRaw(AngleSensor_TypeDef *sensor);
+void ANGLE_SENSOR_CalBegin(AngleSensor_TypeDef *sensor);                               // 开始多点校准
+AngleSensorStatus_TypeDef ANGLE_SENSOR_CalAddPoint(AngleSensor_TypeDef *sensor, float reference_angle); // 在当前位置采集一个参考点
+AngleSensorStatus_TypeDef ANGLE_SENSOR_CalFinish(AngleSensor_TypeDef *sensor);         // 由参考点生成线性化表
+void ANGLE_SENSOR_ResetLinearization(AngleSensor_TypeDef *sensor);                     // 恢复默认两段线性表
+AngleSensorStatus_TypeDef ANGLE_SENSOR_SaveCalibration(AngleSensor_TypeDef *sensors, uint8_t count); // 线性化表写入参数存储
+uint8_t ANGLE_SENSOR_LoadCalibration(AngleSensor_TypeDef *sensors, uint8_t count);     // 从参数存储加载线性化表，返回加载的个数
+void ANGLE_SENSOR_SetOversampling(uint8_t osr_log2);                                   // 设置过采样率 2^osr_log2(所有通道)
+uint16_t ANGLE_SENSOR_GetOversampling(void);                                           // 获取过采样率
+uint8_t ANGLE_SENSOR_FitOversampling(uint32_t period_us);                              // 按控制周期选择过采样率
+AngleSensorStatus_TypeDef ANGLE_SENSOR_ReadOversampled(AngleSensor_TypeDef *sensor, uint32_t *sum, uint8_t *osr_log2,
+                                                       uint64_t *timestamp);           // 读取最近一个窗口和及结束时刻
+AngleSensorStatus_TypeDef ANGLE_SENSOR_ReadDecimated(AngleSensor_TypeDef *sensor, uint16_t *code); // 读取抽取后的16位ADC码
+AngleSensorStatus_TypeDef ANGLE_SENSOR_GetAngleQ16(AngleSensor_TypeDef *sensor, int32_t *angle_q16,
+                                                   uint64_t *timestamp);               // 由过采样窗口求角度(Q16.16，含偏移)
+void ANGLE_SENSOR_OsrPush(volatile AngleOsr_TypeDef *osr, uint8_t osr_log2,
+                          const volatile uint16_t *samples, uint16_t count, uint8_t stride); // 向累加器送入样本
+void ANGLE_SENSOR_FrontEnd(volatile AngleOsr_TypeDef *osr, uint8_t osr_log2,
+                           const volatile uint16_t *samples, uint16_t count, uint8_t stride); // 野值剔除后送入累加器
+uint8_t ANGLE_SENSOR_Hampel(uint16_t *block, uint16_t *median);                        // 一组样本的中值与野值替换，返回替换数
+uint8_t ANGLE_SENSOR_GetFault(AngleSensor_TypeDef *sensor);                            // 获取故障标志
+void ANGLE_SENSOR_DMA_IRQHandler(void);                                                // DMA1通道1中断处理
 
 #endif
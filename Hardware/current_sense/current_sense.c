@@ -0,0 +1,245 @@
+/**
+  ******************************************************************************
+  * @file    current_sense.c
+  * @brief   风扇电流检测(ADC注入通道)模块实现
+  ******************************************************************************
+  */
+
+#include "current_sense.h"
+#include <stddef.h>
+
+/* 私有宏定义 */
+#define CURRENT_SENSE_COUNTS_PER_AMP  (4095.0f * CURRENT_SENSE_SHUNT_OHMS * CURRENT_SENSE_AMP_GAIN / CURRENT_SENSE_VREF)
+#define CURRENT_SENSE_OFFSET_FILTER   0.05f    // 零偏跟踪滤波系数
+
+/* 私有变量 */
+static CurrentSense_TypeDef *current_sense = NULL; // ADC1注入组只有一组，JEOC中断使用的实例
+
+/* 预定义硬件描述 */
+const CurrentSenseConfig_TypeDef CURRENT_SENSE_CONFIG_TIM2 = {
+    TIM2, ADC_ExternalTrigInjecConv_T2_CC1,
+    {GPIOC, GPIOC}, {GPIO_Pin_4, GPIO_Pin_5}, RCC_APB2Periph_GPIOC,
+    {ADC_Channel_14, ADC_Channel_15}
+};
+
+/**
+  * @brief  按零偏和门限电流计算过流门限(ADC计数)
+  * @param  cs: 电流检测实例
+  * @param  fan: 风扇选择
+  * @retval 无
+  */
+static void CURRENT_SENSE_UpdateLimitRaw(CurrentSense_TypeDef *cs, FanSelect_TypeDef fan)
+{
+    float raw = cs->offset_raw[fan] + cs->limit * CURRENT_SENSE_COUNTS_PER_AMP;
+
+    cs->limit_raw[fan] = (raw >= 4095.0f) ? 4095 : (uint16_t)raw;
+}
+
+/**
+  * @brief  初始化电流检测
+  * @param  cs: 电流检测实例
+  * @param  config: 硬件描述
+  * @param  fan: 被检测的风扇驱动(需已初始化，PWM定时器与config->trigger_tim相同)
+  * @retval 无
+  * @note   须在ANGLE_SENSOR_Init之后调用：ADC1的规则扫描已经运行，这里只追加注入组
+  */
+void CURRENT_SENSE_Init(CurrentSense_TypeDef *cs, const CurrentSenseConfig_TypeDef *config, FanDriver_TypeDef *fan)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    TIM_OCInitTypeDef TIM_OCInitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    uint8_t i;
+
+    cs->config = config;
+    cs->fan = fan;
+    cs->limit = CURRENT_SENSE_DEFAULT_LIMIT;
+    for(i = 0; i < FAN_COUNT; i++) {
+        cs->sum[i] = 0;
+        cs->count[i] = 0;
+        cs->sample_state[i] = CURRENT_SENSE_SAMPLE_NONE;
+        cs->trip_count[i] = 0;
+        cs->offset_raw[i] = 0.0f;
+        cs->current[i] = 0.0f;
+        cs->power[i] = 0.0f;
+        CURRENT_SENSE_UpdateLimitRaw(cs, (FanSelect_TypeDef)i);
+    }
+    current_sense = cs;
+
+    /* 模拟输入 */
+    RCC_APB2PeriphClockCmd(config->gpio_rcc, ENABLE);
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
+    for(i = 0; i < FAN_COUNT; i++) {
+        GPIO_InitStructure.GPIO_Pin = config->pin[i];
+        GPIO_Init(config->port[i], &GPIO_InitStructure);
+    }
+
+    /* 触发：PWM定时器CC1比较事件，不输出到引脚；比较值预装载，在周期边界生效 */
+    TIM_OCStructInit(&TIM_OCInitStructure);
+    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_Timing;
+    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Disable;
+    TIM_OCInitStructure.TIM_Pulse = (uint16_t)(fan->period / 2);
+    TIM_OC1Init(config->trigger_tim, &TIM_OCInitStructure);
+    TIM_OC1PreloadConfig(config->trigger_tim, TIM_OCPreload_Enable);
+
+    /* 注入组：两路顺序转换，结果在JDR1/JDR2 */
+    ADC_InjectedSequencerLengthConfig(ADC1, FAN_COUNT);
+    for(i = 0; i < FAN_COUNT; i++) {
+        ADC_InjectedChannelConfig(ADC1, config->adc_channel[i], i + 1, ADC_SampleTime_7Cycles5);
+    }
+    ADC_AutoInjectedConvCmd(ADC1, DISABLE);
+    ADC_ExternalTrigInjectedConvConfig(ADC1, config->trigger);
+    ADC_ExternalTrigInjectedConvCmd(ADC1, ENABLE);
+
+    /* JEOC中断，与PWM更新中断同级 */
+    NVIC_InitStructure.NVIC_IRQChannel = ADC1_2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    ADC_ClearITPendingBit(ADC1, ADC_IT_JEOC);
+    ADC_ITConfig(ADC1, ADC_IT_JEOC, ENABLE);
+}
+
+/**
+  * @brief  控制周期处理
+  * @param  cs: 电流检测实例
+  * @retval 无
+  * @note   取走上一周期的中断累加，按样本用途更新电流或零偏；
+  *         再按当前比较值重新选择采样点和各路样本用途
+  */
+void CURRENT_SENSE_Update(CurrentSense_TypeDef *cs)
+{
+    FanDriver_TypeDef *drv = cs->fan;
+    uint32_t sum[FAN_COUNT];
+    uint16_t count[FAN_COUNT];
+    uint8_t state[FAN_COUNT], next[FAN_COUNT];
+    uint16_t ccr[FAN_COUNT];
+    uint16_t sample_at = 0xFFFF;
+    float mean, amps, emf;
+    uint8_t i;
+
+    /* 采样点：可采样风扇中导通时间最短者的中点，此时这些风扇都在导通 */
+    for(i = 0; i < FAN_COUNT; i++) {
+        ccr[i] = drv->ccr_base[i];
+        if(ccr[i] >= CURRENT_SENSE_MIN_ON_TICKS && ccr[i] < sample_at) {
+            sample_at = ccr[i];
+        }
+    }
+    for(i = 0; i < FAN_COUNT; i++) {
+        if(ccr[i] == 0 && !drv->ramping[i]) {
+            next[i] = CURRENT_SENSE_SAMPLE_OFF;
+        } else if(ccr[i] >= CURRENT_SENSE_MIN_ON_TICKS) {
+            next[i] = CURRENT_SENSE_SAMPLE_ON;
+        } else {
+            next[i] = CURRENT_SENSE_SAMPLE_NONE;
+        }
+    }
+    sample_at = (sample_at == 0xFFFF) ? (uint16_t)(drv->period / 2) : sample_at / 2;
+
+    /* 取走累加值并切换样本用途 */
+    __disable_irq();
+    for(i = 0; i < FAN_COUNT; i++) {
+        sum[i] = cs->sum[i];
+        count[i] = cs->count[i];
+        state[i] = cs->sample_state[i];
+        cs->sum[i] = 0;
+        cs->count[i] = 0;
+        cs->sample_state[i] = next[i];
+    }
+    __enable_irq();
+    TIM_SetCompare1(cs->config->trigger_tim, sample_at);
+
+    for(i = 0; i < FAN_COUNT; i++) {
+        if(count[i] > 0) {
+            mean = (float)sum[i] / count[i];
+            if(state[i] == CURRENT_SENSE_SAMPLE_OFF) {
+                /* 风扇关闭时的读数即放大器零偏 */
+                cs->offset_raw[i] += CURRENT_SENSE_OFFSET_FILTER * (mean - cs->offset_raw[i]);
+                CURRENT_SENSE_UpdateLimitRaw(cs, (FanSelect_TypeDef)i);
+                amps = 0.0f;
+            } else {
+                amps = (mean - cs->offset_raw[i]) / CURRENT_SENSE_COUNTS_PER_AMP;
+                if(amps < 0.0f) amps = 0.0f;
+            }
+            cs->current[i] += CURRENT_SENSE_FILTER * (amps - cs->current[i]);
+        }
+
+        /* 机械功率 = 反电动势 * 电流，反电动势 = 平均端电压 - 绕组压降 */
+        emf = CURRENT_SENSE_SUPPLY_VOLTAGE * ccr[i] / drv->period - cs->current[i] * CURRENT_SENSE_MOTOR_OHMS;
+        cs->power[i] = (emf > 0.0f) ? emf * cs->current[i] : 0.0f;
+    }
+}
+
+/**
+  * @brief  设置过流门限
+  * @param  cs: 电流检测实例
+  * @param  limit: 门限(A)，连续CURRENT_SENSE_TRIP_SAMPLES个PWM周期超过时切断该路风扇
+  * @retval 无
+  */
+void CURRENT_SENSE_SetLimit(CurrentSense_TypeDef *cs, float limit)
+{
+    uint8_t i;
+
+    if(limit <= 0.0f) return;
+    cs->limit = limit;
+    for(i = 0; i < FAN_COUNT; i++) {
+        CURRENT_SENSE_UpdateLimitRaw(cs, (FanSelect_TypeDef)i);
+    }
+}
+
+/**
+  * @brief  获取电流
+  * @param  cs: 电流检测实例
+  * @param  fan: 风扇选择
+  * @retval float: 绕组电流(A)
+  */
+float CURRENT_SENSE_GetCurrent(CurrentSense_TypeDef *cs, FanSelect_TypeDef fan)
+{
+    return cs->current[fan];
+}
+
+/**
+  * @brief  获取估算机械功率
+  * @param  cs: 电流检测实例
+  * @param  fan: 风扇选择
+  * @retval float: 机械功率(W)
+  */
+float CURRENT_SENSE_GetPower(CurrentSense_TypeDef *cs, FanSelect_TypeDef fan)
+{
+    return cs->power[fan];
+}
+
+/**
+  * @brief  ADC注入转换完成中断处理
+  * @param  无
+  * @retval 无
+  * @note   每个PWM周期一次；只累加和比较，过流时立即由风扇驱动切断该路
+  */
+void CURRENT_SENSE_IRQHandler(void)
+{
+    CurrentSense_TypeDef *cs = current_sense;
+    uint16_t raw;
+    uint8_t i;
+
+    if(ADC_GetITStatus(ADC1, ADC_IT_JEOC) == RESET) return;
+    ADC_ClearITPendingBit(ADC1, ADC_IT_JEOC);
+    if(cs == NULL) return;
+
+    for(i = 0; i < FAN_COUNT; i++) {
+        if(cs->sample_state[i] == CURRENT_SENSE_SAMPLE_NONE) continue;
+
+        raw = ADC_GetInjectedConversionValue(ADC1, (i == 0) ? ADC_InjectedChannel_1 : ADC_InjectedChannel_2);
+        cs->sum[i] += raw;
+        cs->count[i]++;
+
+        if(cs->sample_state[i] == CURRENT_SENSE_SAMPLE_ON && raw > cs->limit_raw[i]) {
+            if(++cs->trip_count[i] >= CURRENT_SENSE_TRIP_SAMPLES) {
+                cs->trip_count[i] = 0;
+                FAN_Trip(cs->fan, (FanSelect_TypeDef)i);
+            }
+        } else {
+            cs->trip_count[i] = 0;
+        }
+    }
+}
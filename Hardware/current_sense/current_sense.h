@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file    current_sense.h
+  * @brief   风扇电流检测(ADC注入通道)模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __CURRENT_SENSE_H
+#define __CURRENT_SENSE_H
+
+#include "stm32f10x.h"
+#include "fan_driver.h"
+
+/*
+ * 每路风扇一个分流电阻，经放大后接ADC1注入通道。PWM定时器的CC1比较事件
+ * (比较值 = 两路导通时间较短者的一半)触发注入转换，即在导通脉冲中点采样绕组电流；
+ * 规则通道的角度扫描+DMA不受影响。JEOC中断累加样本并做逐样本过流判定，
+ * 控制周期中取平均、滤波并估算机械功率。
+ */
+#define CURRENT_SENSE_VREF            3.3f     // ADC参考电压(V)
+#define CURRENT_SENSE_SHUNT_OHMS      0.1f     // 分流电阻(欧)
+#define CURRENT_SENSE_AMP_GAIN        20.0f    // 电流放大倍数
+#define CURRENT_SENSE_SUPPLY_VOLTAGE  12.0f    // 风扇电源电压(V)
+#define CURRENT_SENSE_MOTOR_OHMS      4.0f     // 绕组电阻(欧)，用于扣除铜损
+#define CURRENT_SENSE_DEFAULT_LIMIT   1.2f     // 默认过流门限(A)
+#define CURRENT_SENSE_TRIP_SAMPLES    8        // 连续超过门限的样本数(PWM周期)
+#define CURRENT_SENSE_FILTER          0.3f     // 电流一阶滤波系数(新值权重)
+#define CURRENT_SENSE_MIN_ON_TICKS    360      // 可采样的最短导通时间(定时器计数，5us@72MHz，两通道顺序转换约需3.6us)
+
+/* 各路样本的用途(由控制周期按导通时间决定，中断中只读取) */
+#define CURRENT_SENSE_SAMPLE_NONE     0        // 丢弃：导通时间太短，采样点可能落在关断期
+#define CURRENT_SENSE_SAMPLE_ON       1        // 导通中：测量绕组电流
+#define CURRENT_SENSE_SAMPLE_OFF      2        // 风扇关闭：跟踪零电流偏置
+
+/* 电流检测硬件描述 */
+typedef struct {
+    TIM_TypeDef *trigger_tim;     // 触发定时器(须与风扇驱动的PWM定时器相同)
+    uint32_t trigger;             // 注入转换外部触发 ADC_ExternalTrigInjecConv_xxx
+    GPIO_TypeDef *port[FAN_COUNT]; // 各路模拟输入端口
+    uint16_t pin[FAN_COUNT];      // 各路模拟输入引脚
+    uint32_t gpio_rcc;            // 端口时钟
+    uint8_t adc_channel[FAN_COUNT]; // 各路ADC通道号
+} CurrentSenseConfig_TypeDef;
+
+/* 电流检测实例 */
+typedef struct {
+    const CurrentSenseConfig_TypeDef *config; // 硬件描述
+    FanDriver_TypeDef *fan;       // 被检测的风扇驱动
+
+    /* 中断累加(JEOC) */
+    volatile uint32_t sum[FAN_COUNT];   // 样本累加
+    volatile uint16_t count[FAN_COUNT]; // 样本数
+    volatile uint8_t sample_state[FAN_COUNT]; // 样本用途 CURRENT_SENSE_SAMPLE_xxx
+    uint8_t trip_count[FAN_COUNT];      // 连续过流样本计数
+    volatile uint16_t limit_raw[FAN_COUNT]; // 过流门限(ADC计数，含偏置)
+    float offset_raw[FAN_COUNT];        // 零电流偏置(ADC计数)
+
+    /* 控制周期输出 */
+    float current[FAN_COUNT];     // 绕组电流(A)，滤波后
+    float power[FAN_COUNT];       // 估算机械功率(W)
+    float limit;                  // 过流门限(A)
+} CurrentSense_TypeDef;
+
+/* 预定义硬件描述 */
+extern const CurrentSenseConfig_TypeDef CURRENT_SENSE_CONFIG_TIM2; // 驱动0：PC4/PC5(ADC通道14/15)，TIM2_CC1触发
+
+/* 函数声明 */
+void CURRENT_SENSE_Init(CurrentSense_TypeDef *cs, const CurrentSenseConfig_TypeDef *config, FanDriver_TypeDef *fan); // 初始化(须在ANGLE_SENSOR_Init之后)
+void CURRENT_SENSE_Update(CurrentSense_TypeDef *cs);                 // 控制周期处理：平均、滤波、功率估算、更新采样点
+void CURRENT_SENSE_SetLimit(CurrentSense_TypeDef *cs, float limit);  // 设置过流门限(A)
+float CURRENT_SENSE_GetCurrent(CurrentSense_TypeDef *cs, FanSelect_TypeDef fan); // 获取电流(A)
+float CURRENT_SENSE_GetPower(CurrentSense_TypeDef *cs, FanSelect_TypeDef fan);   // 获取估算机械功率(W)
+void CURRENT_SENSE_IRQHandler(void);                                 // ADC注入转换完成中断处理，在ADC1_2中断中调用
+
+#endif /* __CURRENT_SENSE_H */
@@ -6,264 +6,1071 @@
   */
 
 #include "fan_driver.h"
+#include <stddef.h>
 
-/* 私有变量定义 */
-static uint8_t g_fan_speeds[2] = {0, 0};         // 风扇速度（左,右）
-static FanDirection_TypeDef g_fan_directions[2] = {FAN_DIR_FORWARD, FAN_DIR_FORWARD}; // 风扇方向
+/* 预定义硬件描述 */
+const FanDriverConfig_TypeDef FAN_DRIVER_CONFIG_TIM2 = {
+    TIM2, RCC_APB1Periph_TIM2, 0,
+    RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOB, 0,
+    {
+        {FAN_LEFT_PWM_PORT, FAN_LEFT_PWM_PIN, FAN_LEFT_IN1_PORT, FAN_LEFT_IN1_PIN,
+         FAN_LEFT_IN2_PORT, FAN_LEFT_IN2_PIN, 2},
+        {FAN_RIGHT_PWM_PORT, FAN_RIGHT_PWM_PIN, FAN_RIGHT_IN1_PORT, FAN_RIGHT_IN1_PIN,
+         FAN_RIGHT_IN2_PORT, FAN_RIGHT_IN2_PIN, 3}
+    },
+    FAN_STBY_PORT, FAN_STBY_PIN, TIM2_IRQn
+};
+
+const FanDriverConfig_TypeDef FAN_DRIVER_CONFIG_TIM8 = {
+    TIM8, RCC_APB2Periph_TIM8, 1,
+    RCC_APB2Periph_GPIOC | RCC_APB2Periph_GPIOE, 0,
+    {
+        {GPIOC, GPIO_Pin_8, GPIOE, GPIO_Pin_0, GPIOE, GPIO_Pin_1, 3},
+        {GPIOC, GPIO_Pin_9, GPIOE, GPIO_Pin_2, GPIOE, GPIO_Pin_3, 4}
+    },
+    GPIOE, GPIO_Pin_4, TIM8_UP_IRQn
+};
+
+const FanDriverConfig_TypeDef FAN_DRIVER_CONFIG_TIM1 = {
+    TIM1, RCC_APB2Periph_TIM1, 1,
+    RCC_APB2Periph_GPIOE, GPIO_FullRemap_TIM1,
+    {
+        {GPIOE, GPIO_Pin_9, GPIOE, GPIO_Pin_7, GPIOE, GPIO_Pin_8, 1},
+        {GPIOE, GPIO_Pin_11, GPIOE, GPIO_Pin_10, GPIOE, GPIO_Pin_12, 2}
+    },
+    GPIOE, GPIO_Pin_15, TIM1_UP_IRQn
+};
+
+const uint16_t FAN_THRUST_LUT_DEFAULT[FAN_THRUST_LUT_SIZE] = {
+    0, 8192, 11585, 14189, 16384, 18317, 20066, 21673, 23170,
+    24575, 25905, 27169, 28377, 29536, 30651, 31727, 32767
+};
+
+/* 已初始化的驱动实例，供PWM更新中断查找 */
+static FanDriver_TypeDef *fan_drivers[FAN_DRIVER_MAX];
+static uint8_t fan_driver_count = 0;
+
+/**
+  * @brief  写入指定通道的比较值
+  * @param  tim: 定时器
+  * @param  channel: 通道号(1-4)
+  * @param  ccr: 比较值
+  * @retval 无
+  */
+static void FAN_WriteCompare(TIM_TypeDef *tim, uint8_t channel, uint16_t ccr)
+{
+    switch(channel) {
+        case 1: TIM_SetCompare1(tim, ccr); break;
+        case 2: TIM_SetCompare2(tim, ccr); break;
+        case 3: TIM_SetCompare3(tim, ccr); break;
+        default: TIM_SetCompare4(tim, ccr); break;
+    }
+}
+
+/**
+  * @brief  推力查表插值得到占空比
+  * @param  lut: 推力->占空比表
+  * @param  thrust: 推力 (Q15)
+  * @retval uint16_t: 占空比 (Q15)
+  */
+static uint16_t FAN_ThrustToDuty(const uint16_t *lut, uint16_t thrust)
+{
+    uint16_t index;
+    uint16_t frac;
+    int32_t span;
+
+    if(thrust >= FAN_THRUST_MAX) return lut[FAN_THRUST_LUT_SIZE - 1];
+
+    /* 16段：高4位为段号，低11位为段内位置 */
+    index = thrust >> 11;
+    frac = thrust & 0x07FF;
+    span = (int32_t)lut[index + 1] - lut[index];
+
+    return (uint16_t)(lut[index] + ((span * frac) >> 11));
+}
+
+/* 各方向引脚状态的电平：bit0为IN1，bit1为IN2，下标为FAN_PINS_x */
+static const uint8_t FAN_PIN_LEVELS[4] = {0x01, 0x02, 0x00, 0x03};
+
+/**
+  * @brief  设置方向引脚，只写电平变化的引脚
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  state: FAN_PINS_FORWARD/FAN_PINS_REVERSE/FAN_PINS_OFF/FAN_PINS_BRAKE
+  * @retval 无
+  */
+static void FAN_WritePins(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint8_t state)
+{
+    const FanChannelConfig_TypeDef *ch = &drv->config->fans[fan];
+    uint8_t levels;
+    uint8_t changed;
+
+    /* 过流切断后保持高阻，直到清除故障 */
+    if(drv->fault[fan]) state = FAN_PINS_OFF;
+    if(drv->pin_state[fan] == state) return;
+
+    levels = FAN_PIN_LEVELS[state];
+    changed = (drv->pin_state[fan] == FAN_PINS_UNKNOWN) ? 0x03 : (levels ^ FAN_PIN_LEVELS[drv->pin_state[fan]]);
+    drv->pin_state[fan] = state;
+
+    if(changed & 0x01) {
+        if(levels & 0x01) GPIO_SetBits(ch->in1_port, ch->in1_pin);
+        else GPIO_ResetBits(ch->in1_port, ch->in1_pin);
+        drv->write_count++;
+    }
+    if(changed & 0x02) {
+        if(levels & 0x02) GPIO_SetBits(ch->in2_port, ch->in2_pin);
+        else GPIO_ResetBits(ch->in2_port, ch->in2_pin);
+        drv->write_count++;
+    }
+}
+
+/**
+  * @brief  按当前比较值写入通道，值未变化时不写寄存器
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @retval 无
+  * @note   抖动使能或斜坡进行中时比较值由PWM更新中断写入
+  */
+static void FAN_UpdateCompare(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    uint16_t ccr;
+
+    if(drv->dither_enabled || drv->ramping[fan]) return;
+
+    /* 未抖动时小数部分四舍五入 */
+    ccr = drv->ccr_base[fan] + (drv->ccr_frac[fan] >= FAN_THRUST_MAX / 2 ? 1 : 0);
+    if(drv->ccr_applied[fan] == ccr) return;
+
+    drv->ccr_applied[fan] = ccr;
+    FAN_WriteCompare(drv->config->tim, drv->config->fans[fan].tim_channel, ccr);
+    drv->write_count++;
+}
+
+/**
+  * @brief  由指令计算比较值的整数和小数部分
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  value: 指令 (Q15)，按cmd_lut解释为推力或线性占空比
+  * @retval 无
+  */
+static void FAN_ApplyCommand(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t value)
+{
+    uint16_t duty;
+    uint32_t ccr_q15;
+
+    /* 推力 -> 占空比(Q15) -> 比较值(Q15定点) */
+    duty = drv->cmd_lut[fan] ? FAN_ThrustToDuty(drv->thrust_lut, value) : value;
+    ccr_q15 = (uint32_t)duty * (drv->period - 1);
+
+    /* 整数部分与小数部分分开保存，中断中只读取不计算 */
+    drv->ccr_base[fan] = (uint16_t)(ccr_q15 / FAN_THRUST_MAX);
+    drv->ccr_frac[fan] = (uint16_t)(ccr_q15 % FAN_THRUST_MAX);
+}
+
+/**
+  * @brief  使能/禁用PWM更新中断
+  * @param  drv: 风扇驱动实例
+  * @retval 无
+  * @note   仅在抖动使能或有斜坡进行时需要更新中断
+  */
+static void FAN_UpdateIRQ(FanDriver_TypeDef *drv)
+{
+    uint8_t need = drv->dither_enabled;
+    uint8_t i;
+
+    for(i = 0; i < FAN_COUNT; i++) {
+        need |= drv->ramping[i];
+    }
+    TIM_ITConfig(drv->config->tim, TIM_IT_Update, need ? ENABLE : DISABLE);
+}
+
+/**
+  * @brief  设置目标指令
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  value: 目标指令 (Q15)
+  * @param  lut: 1: 推力指令(查表)，0: 线性占空比
+  * @retval 无
+  * @note   只有已预置斜坡(FAN_ArmRamp/软停止)或斜坡进行中时交给PWM更新中断逐周期逼近，
+  *         斜坡进行中的新目标沿用当前斜坡；其余指令立即计算比较值。闭环每周期的指令
+  *         因此不占用更新中断，也不绕开FAN_Commit的同步提交
+  */
+static void FAN_SetTarget(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t value, uint8_t lut)
+{
+    drv->cmd_lut[fan] = lut;
+    drv->cmd_target[fan] = value;
+    drv->stop_pending[fan] = 0;
+
+    if((drv->accel_step == 0 && drv->decel_step == 0) ||
+       (!drv->ramping[fan] && !drv->ramp_armed[fan]) ||
+       drv->cmd_current[fan] == ((uint32_t)value << 16)) {
+        drv->ramping[fan] = 0;
+        drv->cmd_current[fan] = (uint32_t)value << 16;
+        FAN_ApplyCommand(drv, fan, value);
+        return;
+    }
+
+    /* 先置标志再开中断，中断中不会误关 */
+    drv->ramp_armed[fan] = 0;
+    drv->ramping[fan] = 1;
+    FAN_UpdateIRQ(drv);
+}
+
+/**
+  * @brief  斜坡前进一个PWM周期
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @retval 无
+  * @note   在PWM更新中断中调用
+  */
+static void FAN_RampStep(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    uint32_t target = (uint32_t)drv->cmd_target[fan] << 16;
+    uint32_t current = drv->cmd_current[fan];
+    uint32_t step;
+
+    if(current < target) {
+        step = drv->accel_step;
+        current = (step == 0 || target - current <= step) ? target : current + step;
+    } else if(current > target) {
+        step = drv->decel_step;
+        current = (step == 0 || current - target <= step) ? target : current - step;
+    }
+
+    drv->cmd_current[fan] = current;
+    FAN_ApplyCommand(drv, fan, (uint16_t)(current >> 16));
+
+    if(current == target) {
+        drv->ramping[fan] = 0;
+
+        /* 软停止：到0后再改变方向引脚 */
+        if(drv->stop_pending[fan] && target == 0) {
+            drv->stop_pending[fan] = 0;
+            FAN_WritePins(drv, fan, (drv->stop_policy == FAN_STOP_BRAKE) ? FAN_PINS_BRAKE : FAN_PINS_OFF);
+        }
+    }
+}
+
+/**
+  * @brief  由百分比速度设置目标
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  speed: 风扇速度 (0-100)
+  * @retval 无
+  * @note   百分比指令按占空比线性映射，不查推力表
+  */
+static void FAN_LoadSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint8_t speed)
+{
+    uint16_t value;
+
+    /* 限制速度范围，故障时只允许0 */
+    if(speed > FAN_MAX_DUTY)
+        speed = FAN_MAX_DUTY;
+    if(drv->fault[fan])
+        speed = 0;
+
+    /* 保存设置的速度 */
+    value = (uint16_t)((uint32_t)speed * FAN_THRUST_MAX / 100);
+    drv->speeds[fan] = speed;
+    drv->thrusts[fan] = value;
+
+    FAN_SetTarget(drv, fan, value, 0);
+}
+
+/**
+  * @brief  由推力指令设置目标
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  thrust: 推力 (Q15，0-FAN_THRUST_MAX)
+  * @retval 无
+  */
+static void FAN_LoadThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t thrust)
+{
+    uint16_t duty;
+
+    if(thrust > FAN_THRUST_MAX)
+        thrust = FAN_THRUST_MAX;
+    if(drv->fault[fan])
+        thrust = 0;
+
+    drv->thrusts[fan] = thrust;
+    duty = FAN_ThrustToDuty(drv->thrust_lut, thrust);
+    drv->speeds[fan] = (uint8_t)(((uint32_t)duty * 100 + FAN_THRUST_MAX / 2) / FAN_THRUST_MAX);
+
+    FAN_SetTarget(drv, fan, thrust, 1);
+}
 
 /**
   * @brief  配置风扇控制相关的GPIO
-  * @param  无
+  * @param  config: 硬件描述
   * @retval 无
   */
-static void FAN_GPIO_Config(void)
+static void FAN_GPIO_Config(const FanDriverConfig_TypeDef *config)
 {
     GPIO_InitTypeDef GPIO_InitStructure;
-    
+    const FanChannelConfig_TypeDef *ch;
+    uint8_t i;
+
     /* 使能相关时钟 */
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOB | RCC_APB2Periph_AFIO, ENABLE);
-    
-    /* 左风扇PWM引脚配置 */
-    GPIO_InitStructure.GPIO_Pin = FAN_LEFT_PWM_PIN;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;  // 复用推挽输出
+    RCC_APB2PeriphClockCmd(config->gpio_rcc | RCC_APB2Periph_AFIO, ENABLE);
+
+    /* 引脚重映射 */
+    if(config->gpio_remap != 0) {
+        GPIO_PinRemapConfig(config->gpio_remap, ENABLE);
+    }
+
     GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    GPIO_Init(FAN_LEFT_PWM_PORT, &GPIO_InitStructure);
-    
-    /* 右风扇PWM引脚配置 */
-    GPIO_InitStructure.GPIO_Pin = FAN_RIGHT_PWM_PIN;
-    GPIO_Init(FAN_RIGHT_PWM_PORT, &GPIO_InitStructure);
-    
-    /* 左风扇方向控制引脚 */
-    GPIO_InitStructure.GPIO_Pin = FAN_LEFT_IN1_PIN;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;  // 推挽输出
-    GPIO_Init(FAN_LEFT_IN1_PORT, &GPIO_InitStructure);
-    
-    GPIO_InitStructure.GPIO_Pin = FAN_LEFT_IN2_PIN;
-    GPIO_Init(FAN_LEFT_IN2_PORT, &GPIO_InitStructure);
-    
-    /* 右风扇方向控制引脚 */
-    GPIO_InitStructure.GPIO_Pin = FAN_RIGHT_IN1_PIN;
-    GPIO_Init(FAN_RIGHT_IN1_PORT, &GPIO_InitStructure);
-    
-    GPIO_InitStructure.GPIO_Pin = FAN_RIGHT_IN2_PIN;
-    GPIO_Init(FAN_RIGHT_IN2_PORT, &GPIO_InitStructure);
-    
+
+    for(i = 0; i < FAN_COUNT; i++) {
+        ch = &config->fans[i];
+
+        /* 风扇PWM引脚配置 */
+        GPIO_InitStructure.GPIO_Pin = ch->pwm_pin;
+        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;  // 复用推挽输出
+        GPIO_Init(ch->pwm_port, &GPIO_InitStructure);
+
+        /* 风扇方向控制引脚 */
+        GPIO_InitStructure.GPIO_Pin = ch->in1_pin;
+        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;  // 推挽输出
+        GPIO_Init(ch->in1_port, &GPIO_InitStructure);
+
+        GPIO_InitStructure.GPIO_Pin = ch->in2_pin;
+        GPIO_Init(ch->in2_port, &GPIO_InitStructure);
+    }
+
     /* STBY引脚配置 */
-    GPIO_InitStructure.GPIO_Pin = FAN_STBY_PIN;
-    GPIO_Init(FAN_STBY_PORT, &GPIO_InitStructure);
-    
+    GPIO_InitStructure.GPIO_Pin = config->stby_pin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+    GPIO_Init(config->stby_port, &GPIO_InitStructure);
+
     /* 禁用STBY，激活TB6612 */
-    GPIO_SetBits(FAN_STBY_PORT, FAN_STBY_PIN);
+    GPIO_SetBits(config->stby_port, config->stby_pin);
+}
+
+/**
+  * @brief  获取定时器的输入时钟
+  * @param  config: 硬件描述
+  * @retval uint32_t: 定时器时钟(Hz)
+  * @note   APB预分频不为1时定时器时钟为PCLK的2倍
+  */
+static uint32_t FAN_GetTimerClock(const FanDriverConfig_TypeDef *config)
+{
+    RCC_ClocksTypeDef clocks;
+    uint32_t pclk;
+
+    RCC_GetClocksFreq(&clocks);
+    pclk = config->tim_on_apb2 ? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency;
+
+    return (pclk == clocks.HCLK_Frequency) ? pclk : pclk * 2;
+}
+
+/**
+  * @brief  计算PWM定时参数
+  * @param  tim_clock: 定时器时钟(Hz)
+  * @param  freq: 期望PWM频率(Hz)
+  * @param  min_bits: 要求的最低分辨率(位)
+  * @param  timing: 输出定时参数
+  * @retval FanStatus_TypeDef: FAN_ERROR表示频率无法实现或分辨率不足
+  * @note   取能使ARR不超过16位的最小预分频，周期计数最大即分辨率最高；
+  *         不访问硬件，可在任意平台上验证
+  */
+FanStatus_TypeDef FAN_ComputeTiming(uint32_t tim_clock, uint32_t freq, uint8_t min_bits, FanPwmTiming_TypeDef *timing)
+{
+    uint32_t ticks;
+    uint32_t prescaler;
+    uint32_t period;
+    uint8_t bits;
+
+    if(timing == NULL || freq == 0 || tim_clock < freq) return FAN_ERROR;
+
+    /* 每个PWM周期的定时器时钟数 */
+    ticks = tim_clock / freq;
+
+    /* 最小预分频：ceil(ticks / 65536)，PSC同样为16位 */
+    prescaler = (ticks + 65535) / 65536;
+    if(prescaler == 0) prescaler = 1;
+    if(prescaler > 65536) return FAN_ERROR;
+
+    /* 周期四舍五入以减小频率误差 */
+    period = (tim_clock / prescaler + freq / 2) / freq;
+    if(period > 65536) period = 65536;
+    if(period < 2) return FAN_ERROR;
+
+    for(bits = 0; bits < 16 && (period >> (bits + 1)) != 0; bits++);
+    if(bits < min_bits) return FAN_ERROR;
+
+    timing->prescaler = prescaler;
+    timing->period = period;
+    timing->freq = (tim_clock / prescaler + period / 2) / period;
+    timing->bits = bits;
+
+    return FAN_OK;
 }
 
 /**
   * @brief  配置风扇PWM输出的定时器
-  * @param  无
+  * @param  config: 硬件描述
+  * @param  timing: PWM定时参数
   * @retval 无
   */
-static void FAN_TIM_Config(void)
+static void FAN_TIM_Config(const FanDriverConfig_TypeDef *config, const FanPwmTiming_TypeDef *timing)
 {
     TIM_TimeBaseInitTypeDef  TIM_TimeBaseStructure;
     TIM_OCInitTypeDef  TIM_OCInitStructure;
-    
-    /* 使能TIM2时钟 */
-    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
-    
+    TIM_TypeDef *tim = config->tim;
+    uint8_t i;
+
+    /* 使能定时器时钟 */
+    if(config->tim_on_apb2) {
+        RCC_APB2PeriphClockCmd(config->tim_rcc, ENABLE);
+    } else {
+        RCC_APB1PeriphClockCmd(config->tim_rcc, ENABLE);
+    }
+
     /* 基本定时器配置 */
-    TIM_TimeBaseStructure.TIM_Period = FAN_PWM_PERIOD - 1;          // 自动重装载值
-    TIM_TimeBaseStructure.TIM_Prescaler = 72 - 1;                   // 预分频值，72M/72=1MHz
+    TIM_TimeBaseStructure.TIM_Period = (uint16_t)(timing->period - 1);       // 自动重装载值
+    TIM_TimeBaseStructure.TIM_Prescaler = (uint16_t)(timing->prescaler - 1); // 预分频值
     TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;         // 时钟分频
     TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;     // 向上计数
-    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
-    
+    TIM_TimeBaseStructure.TIM_RepetitionCounter = 0;                // 仅高级定时器使用
+    TIM_TimeBaseInit(tim, &TIM_TimeBaseStructure);
+
     /* 配置PWM模式 */
+    TIM_OCStructInit(&TIM_OCInitStructure);
     TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;               // PWM模式1
     TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;   // 输出使能
     TIM_OCInitStructure.TIM_Pulse = 0;                              // 初始占空比为0
     TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;       // 输出极性：高电平有效
-    
-    /* 配置左风扇PWM通道 */
-    TIM_OC2Init(TIM2, &TIM_OCInitStructure);
-    TIM_OC2PreloadConfig(TIM2, TIM_OCPreload_Enable);
-    
-    /* 配置右风扇PWM通道 */
-    TIM_OC3Init(TIM2, &TIM_OCInitStructure);
-    TIM_OC3PreloadConfig(TIM2, TIM_OCPreload_Enable);
-    
+
+    /* 配置左右风扇PWM通道 */
+    for(i = 0; i < FAN_COUNT; i++) {
+        switch(config->fans[i].tim_channel) {
+            case 1:
+                TIM_OC1Init(tim, &TIM_OCInitStructure);
+                TIM_OC1PreloadConfig(tim, TIM_OCPreload_Enable);
+                break;
+            case 2:
+                TIM_OC2Init(tim, &TIM_OCInitStructure);
+                TIM_OC2PreloadConfig(tim, TIM_OCPreload_Enable);
+                break;
+            case 3:
+                TIM_OC3Init(tim, &TIM_OCInitStructure);
+                TIM_OC3PreloadConfig(tim, TIM_OCPreload_Enable);
+                break;
+            default:
+                TIM_OC4Init(tim, &TIM_OCInitStructure);
+                TIM_OC4PreloadConfig(tim, TIM_OCPreload_Enable);
+                break;
+        }
+    }
+
     /* 使能定时器预装载寄存器 */
-    TIM_ARRPreloadConfig(TIM2, ENABLE);
-    
+    TIM_ARRPreloadConfig(tim, ENABLE);
+
     /* 启动定时器 */
-    TIM_Cmd(TIM2, ENABLE);
+    TIM_Cmd(tim, ENABLE);
+
+    /* 高级定时器需要打开主输出 */
+    if(config->tim_on_apb2) {
+        TIM_CtrlPWMOutputs(tim, ENABLE);
+    }
 }
 
 /**
-  * @brief  初始化风扇驱动模块
-  * @param  无
-  * @retval 无
+  * @brief  初始化风扇驱动实例
+  * @param  drv: 风扇驱动实例
+  * @param  config: 硬件描述
+  * @retval FanStatus_TypeDef: FAN_ERROR表示当前时钟下默认PWM频率/分辨率无法实现
   */
-void FAN_Init(void)
+FanStatus_TypeDef FAN_Init(FanDriver_TypeDef *drv, const FanDriverConfig_TypeDef *config)
 {
+    NVIC_InitTypeDef NVIC_InitStructure;
+    FanPwmTiming_TypeDef timing;
+    FanStatus_TypeDef status;
+    uint8_t i;
+
+    drv->config = config;
+    drv->thrust_lut = FAN_THRUST_LUT_DEFAULT;
+    drv->dither_enabled = 0;
+    drv->accel_step = 0;
+    drv->decel_step = 0;
+    drv->accel_rate = 0.0f;
+    drv->decel_rate = 0.0f;
+    drv->stop_policy = FAN_STOP_COAST;
+    for(i = 0; i < FAN_COUNT; i++) {
+        drv->speeds[i] = 0;
+        drv->directions[i] = FAN_DIR_FORWARD;
+        drv->thrusts[i] = 0;
+        drv->ccr_base[i] = 0;
+        drv->ccr_frac[i] = 0;
+        drv->dither_acc[i] = 0;
+        drv->ccr_applied[i] = 0xFFFF;           // 未知，首次必写
+        drv->pin_state[i] = FAN_PINS_UNKNOWN;
+        drv->stage[i].valid = 0;
+        drv->stage[i].dir_valid = 0;
+        drv->cmd_target[i] = 0;
+        drv->cmd_current[i] = 0;
+        drv->cmd_lut[i] = 0;
+        drv->ramping[i] = 0;
+        drv->ramp_armed[i] = 0;
+        drv->stop_pending[i] = 0;
+        drv->fault[i] = 0;
+    }
+    drv->write_count = 0;
+
     /* 配置GPIO */
-    FAN_GPIO_Config();
-    
+    FAN_GPIO_Config(config);
+
+    /* 计算定时参数；不满足时退回到不检查分辨率的同频率配置 */
+    status = FAN_ComputeTiming(FAN_GetTimerClock(config), FAN_PWM_FREQ, FAN_PWM_MIN_BITS, &timing);
+    if(status != FAN_OK) {
+        FAN_ComputeTiming(FAN_GetTimerClock(config), FAN_PWM_FREQ, 0, &timing);
+    }
+
     /* 配置定时器PWM */
-    FAN_TIM_Config();
-    
+    FAN_TIM_Config(config, &timing);
+    drv->period = timing.period;
+    drv->pwm_bits = timing.bits;
+    drv->pwm_freq = timing.freq;
+
+    /* PWM更新中断(抖动/斜坡用)，中断源按需开关，优先级低于1ms时基和控制中断 */
+    NVIC_InitStructure.NVIC_IRQChannel = config->irq_channel;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    /* 登记实例，供PWM更新中断使用 */
+    for(i = 0; i < fan_driver_count; i++) {
+        if(fan_drivers[i] == drv) break;
+    }
+    if(i == fan_driver_count && fan_driver_count < FAN_DRIVER_MAX) {
+        fan_drivers[fan_driver_count++] = drv;
+    }
+
     /* 初始停止所有风扇 */
-    FAN_StopAll();
+    FAN_StopAll(drv);
+
+    return status;
+}
+
+/**
+  * @brief  修改PWM频率
+  * @param  drv: 风扇驱动实例
+  * @param  freq: 期望PWM频率(Hz)
+  * @param  min_bits: 要求的最低分辨率(位)
+  * @retval FanStatus_TypeDef: FAN_ERROR表示无法满足，此时保持原配置
+  * @note   比较值按新周期重新换算，新周期和比较值在同一更新事件生效
+  */
+FanStatus_TypeDef FAN_SetPwmFrequency(FanDriver_TypeDef *drv, uint32_t freq, uint8_t min_bits)
+{
+    TIM_TypeDef *tim = drv->config->tim;
+    FanPwmTiming_TypeDef timing;
+    uint8_t i;
+
+    if(FAN_ComputeTiming(FAN_GetTimerClock(drv->config), freq, min_bits, &timing) != FAN_OK) {
+        return FAN_ERROR;
+    }
+
+    TIM_UpdateDisableConfig(tim, ENABLE);
+    TIM_PrescalerConfig(tim, (uint16_t)(timing.prescaler - 1), TIM_PSCReloadMode_Update);
+    TIM_SetAutoreload(tim, (uint16_t)(timing.period - 1));
+    drv->period = timing.period;
+    drv->pwm_bits = timing.bits;
+    drv->pwm_freq = timing.freq;
+
+    for(i = 0; i < FAN_COUNT; i++) {
+        FAN_ApplyCommand(drv, (FanSelect_TypeDef)i, (uint16_t)(drv->cmd_current[i] >> 16));
+        drv->ccr_applied[i] = 0xFFFF;   // 强制重写
+        FAN_UpdateCompare(drv, (FanSelect_TypeDef)i);
+    }
+    TIM_UpdateDisableConfig(tim, DISABLE);
+
+    /* 斜坡步长按新频率重算 */
+    FAN_SetRamp(drv, drv->accel_rate, drv->decel_rate);
+
+    return FAN_OK;
+}
+
+/**
+  * @brief  获取实际PWM频率
+  * @param  drv: 风扇驱动实例
+  * @retval uint32_t: PWM频率(Hz)
+  */
+uint32_t FAN_GetPwmFrequency(FanDriver_TypeDef *drv)
+{
+    return drv->pwm_freq;
+}
+
+/**
+  * @brief  获取有效占空比分辨率
+  * @param  drv: 风扇驱动实例
+  * @retval uint8_t: 分辨率(位)
+  */
+uint8_t FAN_GetResolutionBits(FanDriver_TypeDef *drv)
+{
+    return drv->pwm_bits;
 }
 
 /**
   * @brief  设置风扇方向
+  * @param  drv: 风扇驱动实例
   * @param  fan: 风扇选择
   * @param  direction: 风扇旋转方向
   * @retval 无
   */
-void FAN_SetDirection(FanSelect_TypeDef fan, FanDirection_TypeDef direction)
+void FAN_SetDirection(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, FanDirection_TypeDef direction)
 {
-    GPIO_TypeDef* IN1_PORT;
-    uint16_t IN1_PIN;
-    GPIO_TypeDef* IN2_PORT;
-    uint16_t IN2_PIN;
-    
     /* 保存设置的方向 */
-    g_fan_directions[fan] = direction;
-    
-    /* 获取对应风扇的控制引脚 */
-    if(fan == FAN_LEFT) {
-        IN1_PORT = FAN_LEFT_IN1_PORT;
-        IN1_PIN = FAN_LEFT_IN1_PIN;
-        IN2_PORT = FAN_LEFT_IN2_PORT;
-        IN2_PIN = FAN_LEFT_IN2_PIN;
-    } else {
-        IN1_PORT = FAN_RIGHT_IN1_PORT;
-        IN1_PIN = FAN_RIGHT_IN1_PIN;
-        IN2_PORT = FAN_RIGHT_IN2_PORT;
-        IN2_PIN = FAN_RIGHT_IN2_PIN;
-    }
-    
+    drv->directions[fan] = direction;
+
     /* 根据方向设置IN1/IN2引脚 */
-    if(direction == FAN_DIR_FORWARD) {
-        GPIO_SetBits(IN1_PORT, IN1_PIN);
-        GPIO_ResetBits(IN2_PORT, IN2_PIN);
-    } else {
-        GPIO_ResetBits(IN1_PORT, IN1_PIN);
-        GPIO_SetBits(IN2_PORT, IN2_PIN);
-    }
+    FAN_WritePins(drv, fan, (direction == FAN_DIR_FORWARD) ? FAN_PINS_FORWARD : FAN_PINS_REVERSE);
 }
 
 /**
   * @brief  设置风扇速度
+  * @param  drv: 风扇驱动实例
   * @param  fan: 风扇选择
   * @param  speed: 风扇速度 (0-100)
   * @retval 无
   */
-void FAN_SetSpeed(FanSelect_TypeDef fan, uint8_t speed)
+void FAN_SetSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint8_t speed)
 {
-    uint16_t ccr;
-    
-    /* 限制速度范围 */
-    if(speed > FAN_MAX_DUTY)
-        speed = FAN_MAX_DUTY;
-    
-    /* 保存设置的速度 */
-    g_fan_speeds[fan] = speed;
-    
-    /* 计算PWM占空比值 */
-    ccr = (uint16_t)((uint32_t)speed * (FAN_PWM_PERIOD - 1) / 100);
-    
+    FAN_LoadSpeed(drv, fan, speed);
+
     /* 设置PWM输出值 */
-    if(fan == FAN_LEFT) {
-        TIM_SetCompare2(TIM2, ccr);
-    } else {
-        TIM_SetCompare3(TIM2, ccr);
-    }
+    FAN_UpdateCompare(drv, fan);
 }
 
 /**
   * @brief  启动指定的风扇
+  * @param  drv: 风扇驱动实例
   * @param  fan: 风扇选择
   * @retval 无
   */
-void FAN_Start(FanSelect_TypeDef fan)
+void FAN_Start(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
 {
     /* 设置风扇方向 */
-    FAN_SetDirection(fan, g_fan_directions[fan]);
-    
+    FAN_SetDirection(drv, fan, drv->directions[fan]);
+
     /* 应用上一次设置的速度 */
-    FAN_SetSpeed(fan, g_fan_speeds[fan]);
+    FAN_SetSpeed(drv, fan, drv->speeds[fan]);
 }
 
 /**
   * @brief  停止指定的风扇
+  * @param  drv: 风扇驱动实例
   * @param  fan: 风扇选择
   * @retval 无
   */
-void FAN_Stop(FanSelect_TypeDef fan)
-{
-    GPIO_TypeDef* IN1_PORT;
-    uint16_t IN1_PIN;
-    GPIO_TypeDef* IN2_PORT;
-    uint16_t IN2_PIN;
-    
-    /* 获取对应风扇的控制引脚 */
-    if(fan == FAN_LEFT) {
-        IN1_PORT = FAN_LEFT_IN1_PORT;
-        IN1_PIN = FAN_LEFT_IN1_PIN;
-        IN2_PORT = FAN_LEFT_IN2_PORT;
-        IN2_PIN = FAN_LEFT_IN2_PIN;
-        
-        /* 设置PWM为0 */
-        TIM_SetCompare2(TIM2, 0);
-    } else {
-        IN1_PORT = FAN_RIGHT_IN1_PORT;
-        IN1_PIN = FAN_RIGHT_IN1_PIN;
-        IN2_PORT = FAN_RIGHT_IN2_PORT;
-        IN2_PIN = FAN_RIGHT_IN2_PIN;
-        
-        /* 设置PWM为0 */
-        TIM_SetCompare3(TIM2, 0);
+void FAN_Stop(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    /* 取消斜坡，设置PWM为0 */
+    drv->ramping[fan] = 0;
+    drv->ramp_armed[fan] = 0;
+    drv->stop_pending[fan] = 0;
+    drv->cmd_target[fan] = 0;
+    drv->cmd_current[fan] = 0;
+    drv->ccr_base[fan] = 0;
+    drv->ccr_frac[fan] = 0;
+    drv->stage[fan].valid = 0;
+    drv->stage[fan].dir_valid = 0;
+    if(drv->ccr_applied[fan] != 0) {
+        drv->ccr_applied[fan] = 0;
+        FAN_WriteCompare(drv->config->tim, drv->config->fans[fan].tim_channel, 0);
+        drv->write_count++;
     }
-    
-    /* 停止电机：TB6612的制动模式 */
-    GPIO_ResetBits(IN1_PORT, IN1_PIN);
-    GPIO_ResetBits(IN2_PORT, IN2_PIN);
-    
+
+    /* 停止电机：按停止方式滑行或制动 */
+    FAN_WritePins(drv, fan, (drv->stop_policy == FAN_STOP_BRAKE) ? FAN_PINS_BRAKE : FAN_PINS_OFF);
+
     /* 更新保存的速度为0 */
-    g_fan_speeds[fan] = 0;
+    drv->speeds[fan] = 0;
+    drv->thrusts[fan] = 0;
+}
+
+/**
+  * @brief  过流切断指定风扇
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @retval 无
+  * @note   由电流检测中断调用。先置故障标志再停止，被控制中断抢占时新指令也只能为0；
+  *         引脚保持高阻(不制动)，故障锁存到FAN_ClearFault
+  */
+void FAN_Trip(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    drv->fault[fan] = 1;
+    FAN_Stop(drv, fan);
+}
+
+/**
+  * @brief  清除过流故障
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @retval 无
+  * @note   只解除锁存，风扇保持停止，需重新给出指令
+  */
+void FAN_ClearFault(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    drv->fault[fan] = 0;
+}
+
+/**
+  * @brief  获取过流故障状态
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @retval uint8_t: 1表示已过流切断
+  */
+uint8_t FAN_GetFault(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    return drv->fault[fan];
 }
 
 /**
   * @brief  启动所有风扇
-  * @param  无
+  * @param  drv: 风扇驱动实例
   * @retval 无
   */
-void FAN_StartAll(void)
+void FAN_StartAll(FanDriver_TypeDef *drv)
 {
-    FAN_Start(FAN_LEFT);
-    FAN_Start(FAN_RIGHT);
+    FAN_Start(drv, FAN_LEFT);
+    FAN_Start(drv, FAN_RIGHT);
 }
 
 /**
   * @brief  停止所有风扇
-  * @param  无
+  * @param  drv: 风扇驱动实例
   * @retval 无
   */
-void FAN_StopAll(void)
+void FAN_StopAll(FanDriver_TypeDef *drv)
 {
-    FAN_Stop(FAN_LEFT);
-    FAN_Stop(FAN_RIGHT);
+    FAN_Stop(drv, FAN_LEFT);
+    FAN_Stop(drv, FAN_RIGHT);
 }
 
 /**
   * @brief  同时设置两个风扇的速度
+  * @param  drv: 风扇驱动实例
   * @param  left_speed: 左风扇速度 (0-100)
   * @param  right_speed: 右风扇速度 (0-100)
   * @retval 无
   */
-void FAN_SetDualSpeed(uint8_t left_speed, uint8_t right_speed)
+void FAN_SetDualSpeed(FanDriver_TypeDef *drv, uint8_t left_speed, uint8_t right_speed)
 {
-    FAN_SetSpeed(FAN_LEFT, left_speed);
-    FAN_SetSpeed(FAN_RIGHT, right_speed);
+    /* 两路在同一PWM周期边沿生效 */
+    FAN_StageSpeed(drv, FAN_LEFT, left_speed);
+    FAN_StageSpeed(drv, FAN_RIGHT, right_speed);
+    FAN_Commit(drv);
+}
+
+/**
+  * @brief  获取风扇当前速度
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @retval uint8_t: 风扇速度 (0-100)
+  */
+uint8_t FAN_GetSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    return drv->speeds[fan];
+}
+
+/**
+  * @brief  设置风扇推力指令
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  thrust: 推力 (Q15，0-FAN_THRUST_MAX)
+  * @retval 无
+  * @note   经推力->占空比表插值后映射到整个比较值范围；
+  *         比较值的小数部分在抖动使能时由PWM更新中断按sigma-delta方式分摊到各周期
+  */
+void FAN_SetThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t thrust)
+{
+    FAN_LoadThrust(drv, fan, thrust);
+    FAN_UpdateCompare(drv, fan);
+}
+
+/**
+  * @brief  暂存风扇速度，FAN_Commit时生效
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  speed: 风扇速度 (0-100)
+  * @retval 无
+  */
+void FAN_StageSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint8_t speed)
+{
+    drv->stage[fan].value = speed;
+    drv->stage[fan].is_thrust = 0;
+    drv->stage[fan].valid = 1;
+}
+
+/**
+  * @brief  暂存推力指令，FAN_Commit时生效
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  thrust: 推力 (Q15，0-FAN_THRUST_MAX)
+  * @retval 无
+  */
+void FAN_StageThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t thrust)
+{
+    drv->stage[fan].value = thrust;
+    drv->stage[fan].is_thrust = 1;
+    drv->stage[fan].valid = 1;
+}
+
+/**
+  * @brief  暂存风扇方向，FAN_Commit时生效
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @param  direction: 风扇旋转方向
+  * @retval 无
+  */
+void FAN_StageDirection(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, FanDirection_TypeDef direction)
+{
+    drv->stage[fan].direction = direction;
+    drv->stage[fan].dir_valid = 1;
+}
+
+/**
+  * @brief  一次性应用暂存的速度/推力和方向
+  * @param  drv: 风扇驱动实例
+  * @retval 无
+  * @note   写比较值期间置位UDIS，预装载寄存器不会被更新事件分批转移，
+  *         两路新比较值在同一个更新事件(PWM周期边沿)一起生效；
+  *         比较值和方向引脚与缓存相同时不写寄存器
+  */
+void FAN_Commit(FanDriver_TypeDef *drv)
+{
+    TIM_TypeDef *tim = drv->config->tim;
+    uint8_t i;
+
+    TIM_UpdateDisableConfig(tim, ENABLE);
+    for(i = 0; i < FAN_COUNT; i++) {
+        if(!drv->stage[i].valid) continue;
+        drv->stage[i].valid = 0;
+
+        if(drv->stage[i].is_thrust) {
+            FAN_LoadThrust(drv, (FanSelect_TypeDef)i, drv->stage[i].value);
+        } else {
+            FAN_LoadSpeed(drv, (FanSelect_TypeDef)i, (uint8_t)drv->stage[i].value);
+        }
+        FAN_UpdateCompare(drv, (FanSelect_TypeDef)i);
+    }
+    TIM_UpdateDisableConfig(tim, DISABLE);
+
+    for(i = 0; i < FAN_COUNT; i++) {
+        if(!drv->stage[i].dir_valid) continue;
+        drv->stage[i].dir_valid = 0;
+        FAN_SetDirection(drv, (FanSelect_TypeDef)i, drv->stage[i].direction);
+    }
+}
+
+/**
+  * @brief  获取寄存器写入计数
+  * @param  drv: 风扇驱动实例
+  * @retval uint32_t: 比较值和方向引脚的累计写入次数(不含抖动中断)
+  */
+uint32_t FAN_GetWriteCount(FanDriver_TypeDef *drv)
+{
+    return drv->write_count;
+}
+
+/**
+  * @brief  获取风扇推力指令
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @retval uint16_t: 推力 (Q15)
+  */
+uint16_t FAN_GetThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    return drv->thrusts[fan];
+}
+
+/**
+  * @brief  设置推力->占空比表
+  * @param  drv: 风扇驱动实例
+  * @param  lut: FAN_THRUST_LUT_SIZE点单调递增表 (Q15)，NULL恢复默认表
+  * @retval 无
+  * @note   表由标定得到，调用者需保证表在驱动使用期间有效
+  */
+void FAN_SetThrustTable(FanDriver_TypeDef *drv, const uint16_t *lut)
+{
+    drv->thrust_lut = (lut != NULL) ? lut : FAN_THRUST_LUT_DEFAULT;
+}
+
+/**
+  * @brief  使能/禁用sigma-delta抖动
+  * @param  drv: 风扇驱动实例
+  * @param  enable: 使能状态 (1:使能, 0:禁用)
+  * @retval 无
+  * @note   使能后每个PWM周期进入一次更新中断，比较值在base与base+1之间切换，
+  *         平均占空比恢复亚LSB分辨率
+  */
+void FAN_EnableDither(FanDriver_TypeDef *drv, uint8_t enable)
+{
+    uint8_t i;
+
+    drv->dither_enabled = enable ? 1 : 0;
+    for(i = 0; i < FAN_COUNT; i++) {
+        drv->dither_acc[i] = 0;
+    }
+    FAN_UpdateIRQ(drv);
+
+    /* 关闭抖动后按四舍五入值写回 */
+    for(i = 0; i < FAN_COUNT; i++) {
+        FAN_UpdateCompare(drv, (FanSelect_TypeDef)i);
+    }
+}
+
+/**
+  * @brief  设置斜坡加/减速率
+  * @param  drv: 风扇驱动实例
+  * @param  accel: 加速率(满量程/秒)，0表示立即到达
+  * @param  decel: 减速率(满量程/秒)，0表示立即到达
+  * @retval 无
+  * @note   速率按PWM周期折算为步长，在PWM更新中断中逐周期执行
+  */
+void FAN_SetRamp(FanDriver_TypeDef *drv, float accel, float decel)
+{
+    float scale = (float)FAN_THRUST_MAX * 65536.0f / drv->pwm_freq;
+    float max_step = (float)FAN_THRUST_MAX * 65536.0f;
+    float step;
+
+    drv->accel_rate = accel;
+    drv->decel_rate = decel;
+
+    step = (accel > 0.0f) ? accel * scale : 0.0f;
+    drv->accel_step = (step > max_step) ? (uint32_t)max_step : (uint32_t)step;
+    if(accel > 0.0f && drv->accel_step == 0) drv->accel_step = 1;
+
+    step = (decel > 0.0f) ? decel * scale : 0.0f;
+    drv->decel_step = (step > max_step) ? (uint32_t)max_step : (uint32_t)step;
+    if(decel > 0.0f && drv->decel_step == 0) drv->decel_step = 1;
+}
+
+/**
+  * @brief  设置停止方式
+  * @param  drv: 风扇驱动实例
+  * @param  policy: FAN_STOP_COAST滑行，FAN_STOP_BRAKE短路制动
+  * @retval 无
+  */
+void FAN_SetStopPolicy(FanDriver_TypeDef *drv, FanStopPolicy_TypeDef policy)
+{
+    drv->stop_policy = policy;
+}
+
+/**
+  * @brief  按减速率停止指定的风扇
+  * @param  drv: 风扇驱动实例
+  * @param  fan: 风扇选择
+  * @retval 无
+  * @note   减速到0后按停止方式设置方向引脚；未设置减速率时等同FAN_Stop。
+  *         停止后保持预置斜坡，重新给出指令时按加速率软启动
+  */
+void FAN_SoftStop(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+    if(drv->decel_step == 0) {
+        FAN_Stop(drv, fan);
+        return;
+    }
+
+    drv->stage[fan].valid = 0;
+    drv->stage[fan].dir_valid = 0;
+    drv->speeds[fan] = 0;
+    drv->thrusts[fan] = 0;
+
+    drv->ramp_armed[fan] = 1;
+    FAN_SetTarget(drv, fan, 0, drv->cmd_lut[fan]);
+    if(drv->ramping[fan]) {
+        drv->stop_pending[fan] = 1;
+    } else {
+        /* 已经为0 */
+        FAN_UpdateCompare(drv, fan);
+        FAN_WritePins(drv, fan, (drv->stop_policy == FAN_STOP_BRAKE) ? FAN_PINS_BRAKE : FAN_PINS_OFF);
+    }
+}
+
+/**
+  * @brief  按减速率停止所有风扇
+  * @param  drv: 风扇驱动实例
+  * @retval 无
+  */
+void FAN_SoftStopAll(FanDriver_TypeDef *drv)
+{
+    FAN_SoftStop(drv, FAN_LEFT);
+    FAN_SoftStop(drv, FAN_RIGHT);
+}
+
+/**
+  * @brief  预置斜坡：两路风扇的下一次指令变化按加/减速率过渡
+  * @param  drv: 风扇驱动实例
+  * @retval 无
+  * @note   用于模式交接和软启动。斜坡在指令追上目标后结束，之后的指令重新立即生效
+  */
+void FAN_ArmRamp(FanDriver_TypeDef *drv)
+{
+    uint8_t i;
+
+    for(i = 0; i < FAN_COUNT; i++) {
+        drv->ramp_armed[i] = 1;
+    }
+}
+
+/**
+  * @brief  是否有风扇处于斜坡过程
+  * @param  drv: 风扇驱动实例
+  * @retval uint8_t: 1表示斜坡进行中
+  */
+uint8_t FAN_IsRamping(FanDriver_TypeDef *drv)
+{
+    return (drv->ramping[FAN_LEFT] || drv->ramping[FAN_RIGHT]) ? 1 : 0;
+}
+
+/**
+  * @brief  PWM定时器更新中断处理
+  * @param  tim: 产生中断的定时器
+  * @retval 无
+  * @note   在对应定时器的更新中断服务函数中调用。比较值预装载，写入值在下一周期生效
+  */
+void FAN_IRQHandler(TIM_TypeDef *tim)
+{
+    FanDriver_TypeDef *drv;
+    uint16_t ccr;
+    uint8_t i, j;
+
+    if(TIM_GetITStatus(tim, TIM_IT_Update) == RESET) return;
+    TIM_ClearITPendingBit(tim, TIM_IT_Update);
+
+    for(i = 0; i < fan_driver_count; i++) {
+        drv = fan_drivers[i];
+        if(drv->config->tim != tim) continue;
+
+        for(j = 0; j < FAN_COUNT; j++) {
+            /* 斜坡：指令逼近目标一步 */
+            if(drv->ramping[j]) {
+                FAN_RampStep(drv, (FanSelect_TypeDef)j);
+            }
+
+            ccr = drv->ccr_base[j];
+            if(drv->dither_enabled) {
+                /* 一阶sigma-delta：累加小数部分，溢出时本周期比较值加1 */
+                drv->dither_acc[j] += drv->ccr_frac[j];
+                if(drv->dither_acc[j] >= FAN_THRUST_MAX) {
+                    drv->dither_acc[j] -= FAN_THRUST_MAX;
+                    ccr++;
+                }
+            } else if(drv->ccr_frac[j] >= FAN_THRUST_MAX / 2) {
+                ccr++;
+            }
+
+            if(drv->ccr_applied[j] != ccr) {
+                drv->ccr_applied[j] = ccr;
+                FAN_WriteCompare(tim, drv->config->fans[j].tim_channel, ccr);
+            }
+        }
+
+        /* 斜坡结束且未使能抖动时关闭更新中断 */
+        FAN_UpdateIRQ(drv);
+    }
 }
@@ -16,18 +16,52 @@ typedef enum {
     FAN_DIR_REVERSE = 1   // 反方向
 } FanDirection_TypeDef;
 
+/* 停止方式 */
+typedef enum {
+    FAN_STOP_COAST = 0,   // 滑行：IN1=IN2=L
+    FAN_STOP_BRAKE = 1    // 制动：IN1=IN2=H
+} FanStopPolicy_TypeDef;
+
 /* 风扇编号定义 */
 typedef enum {
     FAN_LEFT = 0,  // 左侧风扇
     FAN_RIGHT = 1  // 右侧风扇
 } FanSelect_TypeDef;
 
+#define FAN_COUNT            2                     // 每个驱动(一片TB6612)的风扇数
+
 /* 风扇控制相关宏定义 */
-#define FAN_PWM_FREQ         1000                  // PWM频率 (Hz)
+#define FAN_PWM_FREQ         20000                 // 默认PWM频率 (Hz)，高于人耳可闻范围
+#define FAN_PWM_MIN_BITS     11                    // 默认要求的最低占空比分辨率(位)
 #define FAN_MAX_DUTY         100                   // PWM最大占空比 (%)
-#define FAN_PWM_PERIOD       (SystemCoreClock/FAN_PWM_FREQ) // PWM周期
+#define FAN_TIM_CLOCK        72000000              // 定时器时钟(Hz)，用于编译期检查默认配置
+
+/* 编译期检查：默认频率下一个周期的计数值需满足分辨率要求 */
+#if (FAN_TIM_CLOCK / FAN_PWM_FREQ) < (1UL << FAN_PWM_MIN_BITS)
+#error "FAN_PWM_FREQ too high for FAN_PWM_MIN_BITS at FAN_TIM_CLOCK"
+#endif
+
+/* 驱动状态 */
+typedef enum {
+    FAN_OK = 0,           // 正常
+    FAN_ERROR = 1         // 参数无法满足
+} FanStatus_TypeDef;
+
+/* PWM定时参数 */
+typedef struct {
+    uint32_t prescaler;   // 预分频系数(PSC+1)
+    uint32_t period;      // 周期计数(ARR+1)
+    uint32_t freq;        // 实际PWM频率(Hz)
+    uint8_t bits;         // 有效分辨率(位)，floor(log2(period))
+} FanPwmTiming_TypeDef;
+
+/* 高分辨率推力指令 */
+#define FAN_THRUST_MAX       32767                 // 满推力 (Q15 1.0)
+#define FAN_THRUST_LUT_SIZE  17                    // 推力->占空比表点数(推力等分16段)
+#define FAN_DRIVER_MAX       3                     // 可注册PWM更新中断的驱动实例数
 
 /* 风扇GPIO定义 - 可根据实际硬件修改 */
+/* 驱动0：TIM2 */
 // 左风扇
 #define FAN_LEFT_PWM_PORT    GPIOA
 #define FAN_LEFT_PWM_PIN     GPIO_Pin_1           // TIM2_CH2
@@ -48,14 +82,129 @@ typedef enum {
 #define FAN_STBY_PORT        GPIOB
 #define FAN_STBY_PIN         GPIO_Pin_14
 
+/* 驱动1：TIM8 CH3/CH4 (PC8/PC9)，方向引脚PE0-PE3，STBY PE4 */
+/* 驱动2：TIM1完全重映射 CH1/CH2 (PE9/PE11)，方向引脚PE7/PE8/PE10/PE12，STBY PE15 */
+
+/* 单路风扇硬件描述 */
+typedef struct {
+    GPIO_TypeDef *pwm_port;     // PWM输出端口
+    uint16_t pwm_pin;           // PWM输出引脚
+    GPIO_TypeDef *in1_port;     // 方向控制IN1端口
+    uint16_t in1_pin;           // 方向控制IN1引脚
+    GPIO_TypeDef *in2_port;     // 方向控制IN2端口
+    uint16_t in2_pin;           // 方向控制IN2引脚
+    uint8_t tim_channel;        // 定时器通道号(1-4)
+} FanChannelConfig_TypeDef;
+
+/* 风扇驱动(一片TB6612，左右两路)硬件描述 */
+typedef struct {
+    TIM_TypeDef *tim;           // PWM定时器
+    uint32_t tim_rcc;           // 定时器时钟
+    uint8_t tim_on_apb2;        // 1: 定时器挂在APB2(TIM1/TIM8)
+    uint32_t gpio_rcc;          // 所用GPIO端口的APB2时钟
+    uint32_t gpio_remap;        // 引脚重映射(0表示不重映射)
+    FanChannelConfig_TypeDef fans[FAN_COUNT]; // 左右风扇通道
+    GPIO_TypeDef *stby_port;    // STBY端口
+    uint16_t stby_pin;          // STBY引脚
+    uint8_t irq_channel;        // 定时器更新中断号(抖动用)
+} FanDriverConfig_TypeDef;
+
+/* 方向引脚状态(缓存用) */
+#define FAN_PINS_FORWARD     0                     // IN1=H, IN2=L
+#define FAN_PINS_REVERSE     1                     // IN1=L, IN2=H
+#define FAN_PINS_OFF         2                     // IN1=L, IN2=L (TB6612输出高阻，惯性滑行)
+#define FAN_PINS_BRAKE       3                     // IN1=H, IN2=H (TB6612短路制动)
+#define FAN_PINS_UNKNOWN     0xFF                  // 未写入过
+
+/* 单路暂存指令，FAN_Commit时统一生效 */
+typedef struct {
+    uint16_t value;                 // 速度(%)或推力(Q15)
+    uint8_t is_thrust;              // 1: value为推力
+    uint8_t valid;                  // 速度/推力已暂存
+    FanDirection_TypeDef direction; // 方向
+    uint8_t dir_valid;              // 方向已暂存
+} FanStage_TypeDef;
+
+/* 风扇驱动实例 */
+typedef struct {
+    const FanDriverConfig_TypeDef *config;       // 硬件描述
+    uint8_t speeds[FAN_COUNT];                   // 风扇目标速度（左,右）
+    FanDirection_TypeDef directions[FAN_COUNT];  // 风扇方向
+    
+    uint32_t period;                             // PWM周期(ARR+1)，比较值满量程
+    uint8_t pwm_bits;                            // 有效占空比分辨率(位)
+    const uint16_t *thrust_lut;                  // 推力->占空比表 (Q15，FAN_THRUST_LUT_SIZE点)
+    uint16_t thrusts[FAN_COUNT];                 // 当前推力指令 (Q15)
+    
+    /* sigma-delta抖动：比较值 = ccr_base + (本周期进位 ? 1 : 0) */
+    uint8_t dither_enabled;                      // 抖动使能
+    volatile uint16_t ccr_base[FAN_COUNT];       // 比较值整数部分
+    volatile uint16_t ccr_frac[FAN_COUNT];       // 比较值小数部分 (Q15)
+    uint16_t dither_acc[FAN_COUNT];              // 抖动累加器 (Q15)
+    
+    /* 暂存与寄存器缓存 */
+    FanStage_TypeDef stage[FAN_COUNT];           // 暂存指令
+    volatile uint16_t ccr_applied[FAN_COUNT];    // 已写入的比较值
+    uint8_t pin_state[FAN_COUNT];                // 已写入的方向引脚状态
+    uint32_t write_count;                        // 寄存器写入计数(诊断用)
+    
+    /* 斜坡：指令以设定的加/减速率逐个PWM周期逼近目标。只用于模式交接、软启动和软停止，
+       闭环指令默认立即生效，与FAN_Commit在同一PWM边沿生效 */
+    uint32_t pwm_freq;                           // PWM频率(Hz)
+    uint32_t accel_step;                         // 每个PWM周期的加速步长 (Q15.16)，0表示立即到达
+    uint32_t decel_step;                         // 每个PWM周期的减速步长 (Q15.16)，0表示立即到达
+    float accel_rate;                            // 加速率(满量程/秒)
+    float decel_rate;                            // 减速率(满量程/秒)
+    volatile uint16_t cmd_target[FAN_COUNT];     // 目标指令 (Q15)
+    uint32_t cmd_current[FAN_COUNT];             // 当前指令 (Q15.16)
+    uint8_t cmd_lut[FAN_COUNT];                  // 1: 指令为推力(查表)，0: 指令为线性占空比
+    volatile uint8_t ramping[FAN_COUNT];         // 斜坡进行中
+    volatile uint8_t ramp_armed[FAN_COUNT];      // 下一次指令变化按斜坡过渡
+    volatile uint8_t stop_pending[FAN_COUNT];    // 减速到0后按停止方式设置引脚
+    FanStopPolicy_TypeDef stop_policy;           // 停止方式
+    volatile uint8_t fault[FAN_COUNT];           // 过流切断锁存
+} FanDriver_TypeDef;
+
+/* 默认推力->占空比表：推力近似与占空比平方成正比，占空比 = sqrt(推力) */
+extern const uint16_t FAN_THRUST_LUT_DEFAULT[FAN_THRUST_LUT_SIZE];
+
+/* 预定义硬件描述 */
+extern const FanDriverConfig_TypeDef FAN_DRIVER_CONFIG_TIM2; // 驱动0：TIM2 CH2/CH3
+extern const FanDriverConfig_TypeDef FAN_DRIVER_CONFIG_TIM8; // 驱动1：TIM8 CH3/CH4
+extern const FanDriverConfig_TypeDef FAN_DRIVER_CONFIG_TIM1; // 驱动2：TIM1 CH1/CH2(重映射)
+
 /* 函数声明 */
-void FAN_Init(void);                              // 初始化风扇控制模块
-void FAN_SetSpeed(FanSelect_TypeDef fan, uint8_t speed); // 设置风扇速度
-void FAN_SetDirection(FanSelect_TypeDef fan, FanDirection_TypeDef direction); // 设置风扇方向
-void FAN_Start(FanSelect_TypeDef fan);            // 启动风扇
-void FAN_Stop(FanSelect_TypeDef fan);             // 停止风扇
-void FAN_StartAll(void);                          // 启动所有风扇
-void FAN_StopAll(void);                           // 停止所有风扇
-void FAN_SetDualSpeed(uint8_t left_speed, uint8_t right_speed); // 同时设置两个风扇速度
+FanStatus_TypeDef FAN_Init(FanDriver_TypeDef *drv, const FanDriverConfig_TypeDef *config); // 初始化风扇驱动实例
+FanStatus_TypeDef FAN_ComputeTiming(uint32_t tim_clock, uint32_t freq, uint8_t min_bits, FanPwmTiming_TypeDef *timing); // 计算PWM定时参数(纯计算)
+FanStatus_TypeDef FAN_SetPwmFrequency(FanDriver_TypeDef *drv, uint32_t freq, uint8_t min_bits); // 修改PWM频率
+uint32_t FAN_GetPwmFrequency(FanDriver_TypeDef *drv);           // 获取实际PWM频率(Hz)
+uint8_t FAN_GetResolutionBits(FanDriver_TypeDef *drv);          // 获取有效占空比分辨率(位)
+void FAN_SetSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint8_t speed); // 设置风扇速度
+void FAN_SetDirection(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, FanDirection_TypeDef direction); // 设置风扇方向
+void FAN_Start(FanDriver_TypeDef *drv, FanSelect_TypeDef fan);  // 启动风扇
+void FAN_Stop(FanDriver_TypeDef *drv, FanSelect_TypeDef fan);   // 停止风扇
+void FAN_StartAll(FanDriver_TypeDef *drv);                      // 启动所有风扇
+void FAN_StopAll(FanDriver_TypeDef *drv);                       // 停止所有风扇
+void FAN_SetDualSpeed(FanDriver_TypeDef *drv, uint8_t left_speed, uint8_t right_speed); // 同时设置两个风扇速度
+uint8_t FAN_GetSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan); // 获取风扇当前速度
+void FAN_SetThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t thrust); // 设置推力指令 (Q15)
+uint16_t FAN_GetThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan); // 获取推力指令 (Q15)
+void FAN_StageSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint8_t speed); // 暂存速度
+void FAN_StageThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t thrust); // 暂存推力
+void FAN_StageDirection(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, FanDirection_TypeDef direction); // 暂存方向
+void FAN_Commit(FanDriver_TypeDef *drv);                        // 两路暂存指令在同一PWM边沿生效
+uint32_t FAN_GetWriteCount(FanDriver_TypeDef *drv);             // 获取寄存器写入计数
+void FAN_SetThrustTable(FanDriver_TypeDef *drv, const uint16_t *lut); // 设置推力->占空比表，NULL恢复默认
+void FAN_EnableDither(FanDriver_TypeDef *drv, uint8_t enable); // 使能/禁用sigma-delta抖动
+void FAN_SetRamp(FanDriver_TypeDef *drv, float accel, float decel); // 设置加/减速率(满量程/秒，0表示不限)
+void FAN_SetStopPolicy(FanDriver_TypeDef *drv, FanStopPolicy_TypeDef policy); // 设置停止方式
+void FAN_SoftStop(FanDriver_TypeDef *drv, FanSelect_TypeDef fan); // 按减速率停止风扇
+void FAN_SoftStopAll(FanDriver_TypeDef *drv);                   // 按减速率停止所有风扇
+void FAN_ArmRamp(FanDriver_TypeDef *drv);                       // 下一次指令变化按斜坡过渡(模式交接/软启动)
+uint8_t FAN_IsRamping(FanDriver_TypeDef *drv);                  // 是否有风扇处于斜坡过程
+void FAN_Trip(FanDriver_TypeDef *drv, FanSelect_TypeDef fan);   // 过流切断并锁存故障
+void FAN_ClearFault(FanDriver_TypeDef *drv, FanSelect_TypeDef fan); // 清除过流故障
+uint8_t FAN_GetFault(FanDriver_TypeDef *drv, FanSelect_TypeDef fan); // 获取过流故障状态
+void FAN_IRQHandler(TIM_TypeDef *tim);                          // PWM定时器更新中断处理，在定时器中断中调用
 
 #endif /* __FAN_DRIVER_H */
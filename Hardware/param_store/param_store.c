@@ -0,0 +1,602 @@
+/**
+  ******************************************************************************
+  * @file    param_store.c
+  * @brief   参数存储(内部Flash日志结构)模块实现
+  ******************************************************************************
+  */
+
+#include "param_store.h"
+#include <string.h>
+#ifdef PARAM_STORE_HOST
+#include <stdio.h>
+#endif
+
+/* 私有宏定义 */
+#define PARAM_MAGIC              0x314D5250 // 页头标识 "PRM1"
+#define PARAM_HEADER_SIZE        8          // 页头：标识(2半字)、序号、格式版本
+#define PARAM_KEY_ERASED         0xFFFF     // 擦除状态的键，表示日志结束
+#define PARAM_RECORD_HW(len)     (2 + ((len) + 1) / 2 + 1) // 记录半字数：键、长度、数据、CRC
+
+/* 编译期检查：缓存中的参数须能压缩进一页 */
+#if PARAM_HEADER_SIZE + PARAM_CACHE_SIZE + PARAM_MAX_KEYS * 7 > PARAM_PAGE_SIZE
+#error "PARAM_CACHE_SIZE too large to compact into one page"
+#endif
+
+/* 缓存项 */
+typedef struct {
+    uint16_t key;             // 键
+    uint16_t len;             // 长度(字节)
+    uint16_t offset;          // 在缓存数据区中的位置
+    uint8_t present;          // 0: 已删除
+    uint8_t dirty;            // 1: 待写入Flash
+} ParamEntry_TypeDef;
+
+/* 私有变量 */
+static ParamEntry_TypeDef param_entries[PARAM_MAX_KEYS]; // 缓存项
+static uint8_t param_entry_count = 0;                    // 缓存项数
+static uint8_t param_data[PARAM_CACHE_SIZE];             // 缓存数据区
+static uint16_t param_data_used = 0;                     // 已用数据区(字节)
+
+static const uint8_t *param_base = NULL;                 // 存储区起始
+static uint8_t param_active = 0;                         // 当前页
+static uint16_t param_seq = 0;                           // 当前页序号
+static uint8_t param_valid = 0;                          // 1: 当前页有有效页头
+static uint16_t param_write_pos = 0;                     // 当前页下一个空闲位置(字节)
+static uint8_t param_failed = 0;                         // Flash操作失败
+
+/* 正在分批写入的记录 */
+static uint16_t param_stage[PARAM_RECORD_HW(PARAM_MAX_LEN)];
+static uint16_t param_stage_hw = 0;                      // 记录半字数，0表示空闲
+static uint16_t param_stage_pos = 0;                     // 已写入半字数
+static uint8_t param_stage_entry = 0;                    // 对应的缓存项
+
+#ifdef PARAM_STORE_HOST
+static uint8_t param_image[PARAM_PAGE_COUNT * PARAM_PAGE_SIZE]; // Flash映像
+static uint8_t param_image_ready = 0;                    // 映像已初始化
+static FILE *param_file = NULL;                          // 映像文件
+#endif
+
+/* 私有函数声明 */
+static uint16_t PARAM_Read16(uint32_t offset);
+static uint8_t PARAM_FlashErase(uint8_t page);
+static uint8_t PARAM_FlashProgram(uint32_t offset, uint16_t value);
+static uint16_t PARAM_Crc16(const uint16_t *hw, uint16_t count);
+static int16_t PARAM_Find(uint16_t key);
+static ParamStatus_TypeDef PARAM_CacheStore(uint16_t key, const uint8_t *data, uint16_t len, uint8_t dirty);
+static void PARAM_CacheRelease(ParamEntry_TypeDef *entry);
+static uint16_t PARAM_StageRecord(uint8_t index);
+static ParamStatus_TypeDef PARAM_Compact(void);
+
+/**
+  * @brief  扫描存储区并加载缓存
+  * @param  无
+  * @retval ParamStatus_TypeDef: 始终PARAM_OK，无有效页时缓存为空
+  * @note   取序号最新的有效页按顺序回放记录；遇到残缺记录即停止，
+  *         并使下一次写入先压缩到新页
+  */
+ParamStatus_TypeDef PARAM_Init(void)
+{
+    uint32_t page_base;
+    uint16_t pos, key, len, hw, seq;
+    int16_t best = -1;
+    uint8_t p;
+    uint8_t torn = 0;
+
+#ifdef PARAM_STORE_HOST
+    if (!param_image_ready) {
+        memset(param_image, 0xFF, sizeof(param_image));
+        param_image_ready = 1;
+    }
+    param_base = param_image;
+#else
+    param_base = (const uint8_t *)PARAM_FLASH_BASE;
+#endif
+
+    param_entry_count = 0;
+    param_data_used = 0;
+    param_stage_hw = 0;
+    param_failed = 0;
+
+    /* 查找序号最新的有效页 */
+    for (p = 0; p < PARAM_PAGE_COUNT; p++) {
+        page_base = (uint32_t)p * PARAM_PAGE_SIZE;
+        if (PARAM_Read16(page_base) != (PARAM_MAGIC & 0xFFFF)) continue;
+        if (PARAM_Read16(page_base + 2) != (PARAM_MAGIC >> 16)) continue;
+        if (PARAM_Read16(page_base + 6) != PARAM_FORMAT_VERSION) continue;
+
+        seq = PARAM_Read16(page_base + 4);
+        if (best < 0 || (int16_t)(seq - param_seq) > 0) {
+            best = p;
+            param_seq = seq;
+        }
+    }
+
+    if (best < 0) {
+        param_active = 0;
+        param_seq = 0;
+        param_valid = 0;
+        param_write_pos = PARAM_PAGE_SIZE;
+        return PARAM_OK;
+    }
+    param_active = (uint8_t)best;
+    param_valid = 1;
+
+    /* 回放记录 */
+    page_base = (uint32_t)param_active * PARAM_PAGE_SIZE;
+    pos = PARAM_HEADER_SIZE;
+    while (pos + PARAM_RECORD_HW(0) * 2 <= PARAM_PAGE_SIZE) {
+        key = PARAM_Read16(page_base + pos);
+        if (key == PARAM_KEY_ERASED) break;
+
+        len = PARAM_Read16(page_base + pos + 2);
+        hw = PARAM_RECORD_HW(len);
+        if (len > PARAM_MAX_LEN || pos + hw * 2 > PARAM_PAGE_SIZE) {
+            torn = 1;
+            break;
+        }
+        if (PARAM_Crc16((const uint16_t *)(param_base + page_base + pos), hw - 1) !=
+            PARAM_Read16(page_base + pos + (hw - 1) * 2)) {
+            torn = 1;
+            break;
+        }
+
+        if (len == 0) {
+            PARAM_Delete(key);
+        } else {
+            PARAM_CacheStore(key, param_base + page_base + pos + 4, len, 0);
+        }
+        pos += hw * 2;
+    }
+
+    /* 回放产生的删除标记不需要再写 */
+    for (p = 0; p < param_entry_count; p++) {
+        param_entries[p].dirty = 0;
+    }
+    param_write_pos = torn ? PARAM_PAGE_SIZE : pos;
+
+    return PARAM_OK;
+}
+
+/**
+  * @brief  读取参数
+  * @param  key: 参数键
+  * @param  data: 输出缓冲区
+  * @param  len: 长度(字节)，须与保存时一致
+  * @retval ParamStatus_TypeDef: PARAM_NOT_FOUND表示未保存过，PARAM_ERROR表示长度不符
+  * @note   只读RAM缓存
+  */
+ParamStatus_TypeDef PARAM_Get(uint16_t key, void *data, uint16_t len)
+{
+    int16_t i = PARAM_Find(key);
+
+    if (data == NULL) return PARAM_ERROR;
+    if (i < 0 || !param_entries[i].present) return PARAM_NOT_FOUND;
+    if (param_entries[i].len != len) return PARAM_ERROR;
+
+    memcpy(data, &param_data[param_entries[i].offset], len);
+    return PARAM_OK;
+}
+
+/**
+  * @brief  读取变长参数
+  * @param  key: 参数键
+  * @param  data: 输出缓冲区
+  * @param  size: 缓冲区大小(字节)
+  * @param  len: 输出保存时的长度，可能大于size
+  * @retval ParamStatus_TypeDef: PARAM_NOT_FOUND表示未保存过
+  * @note   只读RAM缓存，复制min(保存长度, size)字节；记录格式自带版本和长度时使用
+  */
+ParamStatus_TypeDef PARAM_GetVar(uint16_t key, void *data, uint16_t size, uint16_t *len)
+{
+    int16_t i = PARAM_Find(key);
+
+    if (data == NULL || len == NULL) return PARAM_ERROR;
+    if (i < 0 || !param_entries[i].present) return PARAM_NOT_FOUND;
+
+    *len = param_entries[i].len;
+    memcpy(data, &param_data[param_entries[i].offset], (*len < size) ? *len : size);
+    return PARAM_OK;
+}
+
+/**
+  * @brief  修改参数
+  * @param  key: 参数键
+  * @param  data: 参数数据
+  * @param  len: 长度(1-PARAM_MAX_LEN字节)
+  * @retval ParamStatus_TypeDef: PARAM_ERROR表示与已有参数长度不符(改变长度时先PARAM_Delete再设置)
+  * @note   只写RAM缓存，数据未变化时不产生写入
+  */
+ParamStatus_TypeDef PARAM_Set(uint16_t key, const void *data, uint16_t len)
+{
+    int16_t i;
+
+    if (data == NULL || len == 0 || len > PARAM_MAX_LEN || key == PARAM_KEY_ERASED) return PARAM_ERROR;
+
+    i = PARAM_Find(key);
+    if (i >= 0 && param_entries[i].present && param_entries[i].len == len &&
+        memcmp(&param_data[param_entries[i].offset], data, len) == 0) {
+        return PARAM_OK;
+    }
+    return PARAM_CacheStore(key, (const uint8_t *)data, len, 1);
+}
+
+/**
+  * @brief  删除参数
+  * @param  key: 参数键
+  * @retval ParamStatus_TypeDef: PARAM_NOT_FOUND表示不存在
+  * @note   写入长度为0的删除标记，压缩时不再复制
+  */
+ParamStatus_TypeDef PARAM_Delete(uint16_t key)
+{
+    int16_t i = PARAM_Find(key);
+
+    if (i < 0 || !param_entries[i].present) return PARAM_NOT_FOUND;
+
+    param_entries[i].present = 0;
+    param_entries[i].dirty = 1;
+    return PARAM_OK;
+}
+
+/**
+  * @brief  是否有待写入的参数
+  * @param  无
+  * @retval uint8_t: 1表示有
+  */
+uint8_t PARAM_IsDirty(void)
+{
+    uint8_t i;
+
+    if (param_stage_hw != 0) return 1;
+    for (i = 0; i < param_entry_count; i++) {
+        if (param_entries[i].dirty) return 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief  分批写入待写参数
+  * @param  allow_erase: 1允许在当前页写满时压缩到下一页(擦页期间CPU停顿约20ms)
+  * @retval 无
+  * @note   在主循环中调用，每次最多写PARAM_WRITE_BURST个半字；
+  *         不允许擦除时待写参数保留在缓存中，直到下次允许
+  */
+void PARAM_Service(uint8_t allow_erase)
+{
+    uint16_t budget = PARAM_WRITE_BURST;
+    uint32_t offset;
+    uint16_t hw;
+    uint8_t i;
+
+    while (budget > 0) {
+        if (param_stage_hw == 0) {
+            /* 取下一个待写参数 */
+            for (i = 0; i < param_entry_count && !param_entries[i].dirty; i++);
+            if (i >= param_entry_count) return;
+
+            hw = PARAM_RECORD_HW(param_entries[i].present ? param_entries[i].len : 0);
+            if (!param_valid || param_write_pos + hw * 2 > PARAM_PAGE_SIZE) {
+                if (allow_erase && PARAM_Compact() != PARAM_OK) {
+                    param_failed = 1;
+                }
+                return;
+            }
+
+            param_stage_hw = PARAM_StageRecord(i);
+            param_stage_pos = 0;
+            param_stage_entry = i;
+            param_entries[i].dirty = 0;
+        }
+
+        offset = (uint32_t)param_active * PARAM_PAGE_SIZE + param_write_pos + param_stage_pos * 2;
+        if (!PARAM_FlashProgram(offset, param_stage[param_stage_pos])) {
+            /* 编程失败：放弃当前页剩余空间，下次压缩到新页 */
+            param_entries[param_stage_entry].dirty = 1;
+            param_stage_hw = 0;
+            param_write_pos = PARAM_PAGE_SIZE;
+            param_failed = 1;
+            return;
+        }
+        param_stage_pos++;
+        budget--;
+
+        if (param_stage_pos == param_stage_hw) {
+            param_write_pos += param_stage_hw * 2;
+            param_stage_hw = 0;
+        }
+    }
+}
+
+/**
+  * @brief  阻塞写入全部待写参数
+  * @param  无
+  * @retval ParamStatus_TypeDef: PARAM_ERROR表示Flash操作失败
+  * @note   允许擦页，只应在风扇停止时或主机测试中调用
+  */
+ParamStatus_TypeDef PARAM_Flush(void)
+{
+    param_failed = 0;
+    while (PARAM_IsDirty()) {
+        PARAM_Service(1);
+        if (param_failed) return PARAM_ERROR;
+    }
+    return PARAM_OK;
+}
+
+#ifdef PARAM_STORE_HOST
+/**
+  * @brief  打开(或创建)Flash映像文件
+  * @param  path: 文件路径
+  * @retval ParamStatus_TypeDef: PARAM_ERROR表示无法创建
+  * @note   新文件以擦除状态(0xFF)填充；之后每次擦写都同步到文件
+  */
+ParamStatus_TypeDef PARAM_HostOpen(const char *path)
+{
+    size_t got;
+
+    PARAM_HostClose();
+    memset(param_image, 0xFF, sizeof(param_image));
+    param_image_ready = 1;
+
+    param_file = fopen(path, "r+b");
+    if (param_file != NULL) {
+        got = fread(param_image, 1, sizeof(param_image), param_file);
+        if (got == sizeof(param_image)) return PARAM_OK;
+        memset(param_image + got, 0xFF, sizeof(param_image) - got);
+    } else {
+        param_file = fopen(path, "w+b");
+        if (param_file == NULL) return PARAM_ERROR;
+    }
+
+    fseek(param_file, 0, SEEK_SET);
+    fwrite(param_image, 1, sizeof(param_image), param_file);
+    fflush(param_file);
+    return PARAM_OK;
+}
+
+/**
+  * @brief  关闭映像文件
+  * @param  无
+  * @retval 无
+  */
+void PARAM_HostClose(void)
+{
+    if (param_file != NULL) {
+        fclose(param_file);
+        param_file = NULL;
+    }
+}
+#endif
+
+/**
+  * @brief  读取存储区中的半字
+  * @param  offset: 相对存储区起始的偏移(字节，偶数)
+  * @retval uint16_t: 半字
+  * @note   私有函数
+  */
+static uint16_t PARAM_Read16(uint32_t offset)
+{
+    return (uint16_t)(param_base[offset] | (param_base[offset + 1] << 8));
+}
+
+/**
+  * @brief  擦除一页
+  * @param  page: 页号(0-PARAM_PAGE_COUNT-1)
+  * @retval uint8_t: 1成功
+  * @note   私有函数
+  */
+static uint8_t PARAM_FlashErase(uint8_t page)
+{
+#ifdef PARAM_STORE_HOST
+    memset(param_image + (uint32_t)page * PARAM_PAGE_SIZE, 0xFF, PARAM_PAGE_SIZE);
+    if (param_file != NULL) {
+        fseek(param_file, (long)page * PARAM_PAGE_SIZE, SEEK_SET);
+        fwrite(param_image + (uint32_t)page * PARAM_PAGE_SIZE, 1, PARAM_PAGE_SIZE, param_file);
+        fflush(param_file);
+    }
+    return 1;
+#else
+    FLASH_Status status;
+
+    FLASH_Unlock();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    status = FLASH_ErasePage(PARAM_FLASH_BASE + (uint32_t)page * PARAM_PAGE_SIZE);
+    FLASH_Lock();
+    return (status == FLASH_COMPLETE) ? 1 : 0;
+#endif
+}
+
+/**
+  * @brief  编程一个半字
+  * @param  offset: 相对存储区起始的偏移(字节，偶数)
+  * @param  value: 半字
+  * @retval uint8_t: 1成功
+  * @note   私有函数。与硬件一致，主机映像中未擦除的位置(非0xFFFF)拒绝写入非0值
+  */
+static uint8_t PARAM_FlashProgram(uint32_t offset, uint16_t value)
+{
+#ifdef PARAM_STORE_HOST
+    if (PARAM_Read16(offset) != 0xFFFF && value != 0) return 0;
+    param_image[offset] = (uint8_t)(value & 0xFF);
+    param_image[offset + 1] = (uint8_t)(value >> 8);
+    if (param_file != NULL) {
+        fseek(param_file, (long)offset, SEEK_SET);
+        fwrite(param_image + offset, 1, 2, param_file);
+        fflush(param_file);
+    }
+    return 1;
+#else
+    FLASH_Status status;
+
+    FLASH_Unlock();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    status = FLASH_ProgramHalfWord(PARAM_FLASH_BASE + offset, value);
+    FLASH_Lock();
+    return (status == FLASH_COMPLETE) ? 1 : 0;
+#endif
+}
+
+/**
+  * @brief  计算CRC16(CCITT，初值0xFFFF)
+  * @param  hw: 半字数组(按小端字节序参与计算)
+  * @param  count: 半字数
+  * @retval uint16_t: CRC
+  * @note   私有函数
+  */
+static uint16_t PARAM_Crc16(const uint16_t *hw, uint16_t count)
+{
+    const uint8_t *bytes = (const uint8_t *)hw;
+    uint16_t crc = 0xFFFF;
+    uint16_t i;
+    uint8_t bit;
+
+    for (i = 0; i < count * 2; i++) {
+        crc ^= (uint16_t)bytes[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+  * @brief  查找缓存项
+  * @param  key: 参数键
+  * @retval int16_t: 缓存项序号，-1表示不存在
+  * @note   私有函数
+  */
+static int16_t PARAM_Find(uint16_t key)
+{
+    uint8_t i;
+
+    for (i = 0; i < param_entry_count; i++) {
+        if (param_entries[i].key == key) return i;
+    }
+    return -1;
+}
+
+/**
+  * @brief  写入缓存
+  * @param  key: 参数键
+  * @param  data: 参数数据
+  * @param  len: 长度(字节)
+  * @param  dirty: 1标记为待写入
+  * @retval ParamStatus_TypeDef: 结果
+  * @note   私有函数。已删除的键可以用新长度重新分配空间
+  */
+static ParamStatus_TypeDef PARAM_CacheStore(uint16_t key, const uint8_t *data, uint16_t len, uint8_t dirty)
+{
+    ParamEntry_TypeDef *entry;
+    int16_t i = PARAM_Find(key);
+
+    if (i >= 0) {
+        entry = &param_entries[i];
+        if (entry->len != len) {
+            if (entry->present) return PARAM_ERROR;
+            if (param_data_used - entry->len + len > PARAM_CACHE_SIZE) return PARAM_FULL;
+            PARAM_CacheRelease(entry);
+            entry->offset = param_data_used;
+            entry->len = len;
+            param_data_used += len;
+        }
+    } else {
+        if (param_entry_count >= PARAM_MAX_KEYS) return PARAM_FULL;
+        if (param_data_used + len > PARAM_CACHE_SIZE) return PARAM_FULL;
+        entry = &param_entries[param_entry_count++];
+        entry->key = key;
+        entry->len = len;
+        entry->offset = param_data_used;
+        param_data_used += len;
+    }
+
+    memcpy(&param_data[entry->offset], data, len);
+    entry->present = 1;
+    entry->dirty = dirty;
+    return PARAM_OK;
+}
+
+/**
+  * @brief  释放已删除项占用的缓存数据区
+  * @param  entry: 缓存项(已删除)
+  * @retval 无
+  * @note   私有函数。其后的数据前移，改变长度的参数反复保存时缓存不会耗尽；
+  *         正在分批写入的记录已复制到param_stage，不受移动影响
+  */
+static void PARAM_CacheRelease(ParamEntry_TypeDef *entry)
+{
+    uint16_t end = entry->offset + entry->len;
+    uint8_t i;
+
+    memmove(&param_data[entry->offset], &param_data[end], param_data_used - end);
+    for (i = 0; i < param_entry_count; i++) {
+        if (param_entries[i].offset >= end) param_entries[i].offset -= entry->len;
+    }
+    param_data_used -= entry->len;
+    entry->len = 0;
+}
+
+/**
+  * @brief  把缓存项组装成记录
+  * @param  index: 缓存项序号
+  * @retval uint16_t: 记录半字数
+  * @note   私有函数。已删除的项组装为长度0的删除标记；奇数长度补0xFF
+  */
+static uint16_t PARAM_StageRecord(uint8_t index)
+{
+    ParamEntry_TypeDef *entry = &param_entries[index];
+    uint16_t len = entry->present ? entry->len : 0;
+    uint16_t hw = PARAM_RECORD_HW(len);
+    uint8_t *bytes = (uint8_t *)&param_stage[2];
+
+    param_stage[0] = entry->key;
+    param_stage[1] = len;
+    memset(bytes, 0xFF, (hw - 3) * 2);
+    memcpy(bytes, &param_data[entry->offset], len);
+    param_stage[hw - 1] = PARAM_Crc16(param_stage, hw - 1);
+
+    return hw;
+}
+
+/**
+  * @brief  压缩到下一页
+  * @param  无
+  * @retval ParamStatus_TypeDef: PARAM_ERROR表示擦写失败，原页仍然有效
+  * @note   私有函数。擦除环形的下一页，写入全部有效参数，最后写页头使新页生效
+  */
+static ParamStatus_TypeDef PARAM_Compact(void)
+{
+    uint8_t page = (uint8_t)((param_active + 1) % PARAM_PAGE_COUNT);
+    uint32_t page_base = (uint32_t)page * PARAM_PAGE_SIZE;
+    uint16_t seq = (uint16_t)(param_seq + 1);
+    uint16_t pos = PARAM_HEADER_SIZE;
+    uint16_t hw, j;
+    uint8_t i;
+    uint8_t ok;
+
+    ok = PARAM_FlashErase(page);
+    for (i = 0; ok && i < param_entry_count; i++) {
+        if (!param_entries[i].present) continue;
+
+        hw = PARAM_StageRecord(i);
+        for (j = 0; ok && j < hw; j++) {
+            ok = PARAM_FlashProgram(page_base + pos + j * 2, param_stage[j]);
+        }
+        pos += hw * 2;
+    }
+
+    /* 页头最后写入 */
+    if (ok) ok = PARAM_FlashProgram(page_base + 2, (uint16_t)(PARAM_MAGIC >> 16));
+    if (ok) ok = PARAM_FlashProgram(page_base + 4, seq);
+    if (ok) ok = PARAM_FlashProgram(page_base + 6, PARAM_FORMAT_VERSION);
+    if (ok) ok = PARAM_FlashProgram(page_base, (uint16_t)(PARAM_MAGIC & 0xFFFF));
+    if (!ok) return PARAM_ERROR;
+
+    for (i = 0; i < param_entry_count; i++) {
+        param_entries[i].dirty = 0;
+    }
+    param_active = page;
+    param_seq = seq;
+    param_valid = 1;
+    param_write_pos = pos;
+
+    return PARAM_OK;
+}
@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file    param_store.h
+  * @brief   参数存储(内部Flash日志结构)模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __PARAM_STORE_H
+#define __PARAM_STORE_H
+
+#ifdef PARAM_STORE_HOST
+#include <stdint.h>
+#else
+#include "stm32f10x.h"
+#endif
+
+/*
+ * 参数以(键,长度,数据,CRC16)记录的形式追加写入Flash末尾的PARAM_PAGE_COUNT个页，
+ * 同一键的新记录覆盖旧记录。当前页写满时把RAM缓存中的全部有效参数压缩到环形的下一页，
+ * 各页轮流擦除以均衡磨损。页头(标识,序号,格式版本)在压缩完成后最后写入，
+ * 上电时取序号最新的有效页回放；记录的CRC在数据之后写入，掉电造成的残缺记录被忽略。
+ *
+ * 读取只访问RAM缓存。PARAM_Set只修改缓存并标记待写，由主循环的PARAM_Service
+ * 每次最多写PARAM_WRITE_BURST个半字；需要擦除(压缩)时只在调用者允许时进行，
+ * 避免控制中断在Flash擦除期间停顿。本模块不可重入，只在主循环中调用。
+ *
+ * 定义PARAM_STORE_HOST时使用文件映像代替Flash，用于主机测试。
+ */
+#define PARAM_PAGE_SIZE          2048       // Flash页大小(字节)
+#define PARAM_PAGE_COUNT         4          // 轮换使用的页数
+#define PARAM_FLASH_BASE         0x0807E000 // 存储区起始地址(512KB器件最后4页)
+#define PARAM_FORMAT_VERSION     1          // 记录格式版本，不符的页视为空
+#define PARAM_MAX_KEYS           32         // 最多参数个数
+#define PARAM_CACHE_SIZE         1536       // RAM缓存数据区(字节)，须能压缩进一页
+#define PARAM_MAX_LEN            512        // 单个参数最大长度(字节)
+#define PARAM_WRITE_BURST        32         // 每次PARAM_Service最多写入的半字数(每个约50us)
+
+/* 参数键：高字节为模块，低字节为实例(轴号/扫描位置) */
+#define PARAM_KEY_ANGLE_LUT(rank)     (0x0100 + (rank))  // 角度线性化表
+#define PARAM_KEY_ANGLE_OFFSET(axis)  (0x0110 + (axis))  // 角度偏移
+#define PARAM_KEY_PID(axis)           (0x0200 + (axis))  // 角度PID参数
+#define PARAM_KEY_FAN(axis)           (0x0210 + (axis))  // 风扇基础速度与差速比例
+#define PARAM_KEY_STABLE(axis)        (0x0220 + (axis))  // 稳定判定条件
+#define PARAM_KEY_SEQUENCE(axis)      (0x0230 + (axis))  // 角度序列(旧格式，只读取)
+#define PARAM_KEY_SEQ_PROGRAM(axis)   (0x0240 + (axis))  // 序列程序
+
+/* 参数存储状态 */
+typedef enum {
+    PARAM_OK = 0,             // 成功
+    PARAM_ERROR = 1,          // 参数错误或Flash操作失败
+    PARAM_NOT_FOUND = 2,      // 键不存在
+    PARAM_FULL = 3            // 键数或缓存已满
+} ParamStatus_TypeDef;
+
+/* 函数声明 */
+ParamStatus_TypeDef PARAM_Init(void);                                         // 扫描存储区并加载缓存
+ParamStatus_TypeDef PARAM_Get(uint16_t key, void *data, uint16_t len);        // 读取参数(长度须与保存时一致)
+ParamStatus_TypeDef PARAM_GetVar(uint16_t key, void *data, uint16_t size, uint16_t *len); // 读取变长参数(最多size字节)
+ParamStatus_TypeDef PARAM_Set(uint16_t key, const void *data, uint16_t len);  // 修改参数(只写缓存，待写入Flash)
+ParamStatus_TypeDef PARAM_Delete(uint16_t key);                               // 删除参数
+uint8_t PARAM_IsDirty(void);                                                  // 是否有待写入的参数
+void PARAM_Service(uint8_t allow_erase);                                      // 主循环调用：分批写入，allow_erase=1时允许压缩擦页
+ParamStatus_TypeDef PARAM_Flush(void);                                        // 阻塞写入全部待写参数(含擦页)
+
+#ifdef PARAM_STORE_HOST
+ParamStatus_TypeDef PARAM_HostOpen(const char *path);                         // 打开(或创建)Flash映像文件，须在PARAM_Init之前调用
+void PARAM_HostClose(void);                                                   // 关闭映像文件
+#endif
+
+#endif /* __PARAM_STORE_H */
@@ -0,0 +1,326 @@
+/**
+  ******************************************************************************
+  * @file    tach.c
+  * @brief   风扇测速(输入捕获+DMA)模块实现
+  ******************************************************************************
+  */
+
+#include "tach.h"
+#include <stddef.h>
+
+/* 私有宏定义 */
+#define TACH_RPM_FILTER          0.5f     // 转速一阶滤波系数(新值权重)
+#define TACH_IC_FILTER           0x06     // 输入捕获数字滤波(fDTS/4, N=6)
+#define TACH_LATE_WINDOW         0xFF00   // 捕获值晚于now(读取计数后才到达)的判定界限
+
+#if TACH_USE_SIMULATION
+#define TACH_SIM_DEFAULT_GAIN    60.0f      // 默认仿真稳态增益(RPM/%)
+#define TACH_SIM_DEFAULT_TAU     0.3f       // 默认仿真时间常数(s)
+#endif
+
+/* 预定义硬件描述 */
+const TachConfig_TypeDef TACH_CONFIG_TIM3_CH1 = {
+    TIM3, RCC_APB1Periph_TIM3, 0, TIM_Channel_1, TIM_DMA_CC1,
+    DMA1_Channel6, RCC_AHBPeriph_DMA1,
+    GPIOA, GPIO_Pin_6, RCC_APB2Periph_GPIOA
+};
+
+const TachConfig_TypeDef TACH_CONFIG_TIM5_CH1 = {
+    TIM5, RCC_APB1Periph_TIM5, 0, TIM_Channel_1, TIM_DMA_CC1,
+    DMA2_Channel5, RCC_AHBPeriph_DMA2,
+    GPIOA, GPIO_Pin_0, RCC_APB2Periph_GPIOA
+};
+
+#if !TACH_USE_SIMULATION
+/**
+  * @brief  获取捕获通道的比较/捕获寄存器地址
+  * @param  config: 硬件描述
+  * @retval uint32_t: CCRx地址
+  */
+static uint32_t TACH_GetCaptureAddress(const TachConfig_TypeDef *config)
+{
+    switch(config->tim_channel) {
+        case TIM_Channel_1: return (uint32_t)&config->tim->CCR1;
+        case TIM_Channel_2: return (uint32_t)&config->tim->CCR2;
+        case TIM_Channel_3: return (uint32_t)&config->tim->CCR3;
+        default:            return (uint32_t)&config->tim->CCR4;
+    }
+}
+
+/**
+  * @brief  配置捕获引脚、输入捕获通道和DMA
+  * @param  tach: 测速实例
+  * @retval 无
+  * @note   定时器未运行时按TACH_TIMER_CLOCK自由运行配置时基并启动
+  */
+static void TACH_HW_Config(Tach_TypeDef *tach)
+{
+    const TachConfig_TypeDef *config = tach->config;
+    GPIO_InitTypeDef GPIO_InitStructure;
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    TIM_ICInitTypeDef TIM_ICInitStructure;
+    DMA_InitTypeDef DMA_InitStructure;
+    RCC_ClocksTypeDef clocks;
+    uint32_t pclk, tim_clock;
+
+    if(config->tim_on_apb2) {
+        RCC_APB2PeriphClockCmd(config->tim_rcc, ENABLE);
+    } else {
+        RCC_APB1PeriphClockCmd(config->tim_rcc, ENABLE);
+    }
+
+    /* 时基：APB预分频不为1时定时器时钟为PCLK的2倍 */
+    if(!(config->tim->CR1 & TIM_CR1_CEN)) {
+        RCC_GetClocksFreq(&clocks);
+        pclk = config->tim_on_apb2 ? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency;
+        tim_clock = (pclk == clocks.HCLK_Frequency) ? pclk : pclk * 2;
+
+        TIM_TimeBaseStructure.TIM_Period = 0xFFFF;
+        TIM_TimeBaseStructure.TIM_Prescaler = (uint16_t)(tim_clock / TACH_TIMER_CLOCK - 1);
+        TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+        TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+        TIM_TimeBaseInit(config->tim, &TIM_TimeBaseStructure);
+        TIM_Cmd(config->tim, ENABLE);
+    }
+    RCC_APB2PeriphClockCmd(config->gpio_rcc, ENABLE);
+    RCC_AHBPeriphClockCmd(config->dma_rcc, ENABLE);
+
+    /* 测速线多为集电极开路输出，使用内部上拉 */
+    GPIO_InitStructure.GPIO_Pin = config->pin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;
+    GPIO_Init(config->port, &GPIO_InitStructure);
+
+    /* DMA：CCRx -> captures[] 循环搬运 */
+    DMA_DeInit(config->dma);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = TACH_GetCaptureAddress(config);
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)tach->captures;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = TACH_BUFFER_SIZE;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(config->dma, &DMA_InitStructure);
+    DMA_Cmd(config->dma, ENABLE);
+
+    /* 下降沿捕获，不分频 */
+    TIM_ICInitStructure.TIM_Channel = config->tim_channel;
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_Falling;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    TIM_ICInitStructure.TIM_ICFilter = TACH_IC_FILTER;
+    TIM_ICInit(config->tim, &TIM_ICInitStructure);
+
+    TIM_DMACmd(config->tim, config->tim_dma, ENABLE);
+}
+#endif
+
+/**
+  * @brief  初始化测速实例
+  * @param  tach: 测速实例
+  * @param  config: 硬件描述
+  * @retval 无
+  * @note   定时器须以TACH_TIMER_CLOCK、ARR=0xFFFF自由运行；与其他功能共用定时器时
+  *         (如TIM3同时产生控制节拍)由共用方保证时基一致
+  */
+void TACH_Init(Tach_TypeDef *tach, const TachConfig_TypeDef *config)
+{
+    uint8_t i;
+
+    tach->config = config;
+    for(i = 0; i < TACH_BUFFER_SIZE; i++) {
+        tach->captures[i] = 0;
+    }
+    tach->tail = 0;
+    tach->last_capture = 0;
+    tach->has_edge = 0;
+    tach->stalled = 1;
+    tach->idle_us = 0;
+    tach->period_us = 0;
+    tach->edge_count = 0;
+    tach->rpm = 0.0f;
+
+#if TACH_USE_SIMULATION
+    tach->sim_rpm = 0.0f;
+    tach->sim_command = 0.0f;
+    tach->sim_rpm_per_percent = TACH_SIM_DEFAULT_GAIN;
+    tach->sim_tau = TACH_SIM_DEFAULT_TAU;
+    tach->sim_head = 0;
+#else
+    TACH_HW_Config(tach);
+#endif
+
+    tach->last_now = TACH_GetCounter(tach);
+#if TACH_USE_SIMULATION
+    tach->sim_time = tach->last_now;
+    tach->sim_phase = 0.0f;
+#endif
+}
+
+/**
+  * @brief  读取捕获定时器计数值
+  * @param  tach: 测速实例
+  * @retval uint16_t: 当前计数值(us)
+  */
+uint16_t TACH_GetCounter(Tach_TypeDef *tach)
+{
+    if(tach->config == NULL) return 0;
+
+    return (uint16_t)tach->config->tim->CNT;
+}
+
+#if TACH_USE_SIMULATION
+/**
+  * @brief  推进仿真转速模型并写入对应的捕获值
+  * @param  tach: 测速实例
+  * @param  elapsed: 距上次更新经过的计数(us)
+  * @retval 无
+  * @note   仿真时间与计数值同余(mod 65536)，捕获值取脉冲沿时间的低16位，
+  *         与硬件DMA写入的数据走同一处理路径
+  */
+static void TACH_SimAdvance(Tach_TypeDef *tach, uint16_t elapsed)
+{
+    float dt = (float)elapsed / TACH_TIMER_CLOCK;
+    float target = tach->sim_command * tach->sim_rpm_per_percent;
+    float rate, t = 0.0f;
+
+    /* 一阶转速响应 */
+    if(tach->sim_tau > 0.0f) {
+        tach->sim_rpm += (target - tach->sim_rpm) * dt / (tach->sim_tau + dt);
+    } else {
+        tach->sim_rpm = target;
+    }
+
+    /* 按转速积分脉冲相位，每满一个脉冲写入一个捕获值 */
+    rate = tach->sim_rpm * TACH_PULSES_PER_REV / (60.0f * TACH_TIMER_CLOCK); // 脉冲/us
+    if(rate > 0.0f) {
+        while(tach->sim_phase + rate * (elapsed - t) >= 1.0f) {
+            t += (1.0f - tach->sim_phase) / rate;
+            tach->sim_phase = 0.0f;
+            tach->captures[tach->sim_head] = (uint16_t)(tach->sim_time + (uint32_t)t);
+            tach->sim_head = (tach->sim_head + 1) % TACH_BUFFER_SIZE;
+        }
+        tach->sim_phase += rate * (elapsed - t);
+    }
+
+    tach->sim_time += elapsed;
+}
+#endif
+
+/**
+  * @brief  处理新增捕获值，计算转速并检测停转
+  * @param  tach: 测速实例
+  * @param  now: 当前计数值(TACH_GetCounter)，两次调用间隔须小于65536-超时
+  * @retval 无
+  * @note   本次新增的所有周期取平均后再做一阶滤波；不使用中断
+  */
+void TACH_Update(Tach_TypeDef *tach, uint16_t now)
+{
+    uint16_t elapsed = (uint16_t)(now - tach->last_now);
+    uint16_t capture, period, since;
+    uint32_t sum = 0;
+    uint16_t count = 0;
+    uint8_t head;
+    float rpm;
+
+#if TACH_USE_SIMULATION
+    TACH_SimAdvance(tach, elapsed);
+    head = tach->sim_head;
+#else
+    head = (uint8_t)((TACH_BUFFER_SIZE - tach->config->dma->CNDTR) % TACH_BUFFER_SIZE);
+#endif
+    tach->last_now = now;
+
+    /* 逐个处理新增脉冲沿 */
+    while(tach->tail != head) {
+        capture = tach->captures[tach->tail];
+        tach->tail = (tach->tail + 1) % TACH_BUFFER_SIZE;
+
+        if(tach->has_edge) {
+            period = (uint16_t)(capture - tach->last_capture);
+            if(period < TACH_MIN_PERIOD_US) continue;   // 毛刺，保留原参考沿
+            sum += period;
+            count++;
+        }
+        tach->last_capture = capture;
+        tach->has_edge = 1;
+        tach->edge_count++;
+    }
+
+    /* 距上一个脉冲沿的时间 */
+    if(tach->has_edge) {
+        since = (uint16_t)(now - tach->last_capture);
+        tach->idle_us = (since > TACH_LATE_WINDOW) ? 0 : since;
+    } else if(tach->idle_us < TACH_STALL_TIMEOUT_US) {
+        tach->idle_us += elapsed;
+    }
+
+    if(tach->idle_us > TACH_STALL_TIMEOUT_US) {
+        /* 停转：丢弃参考沿，恢复转动后重新建立 */
+        tach->stalled = 1;
+        tach->has_edge = 0;
+        tach->period_us = 0;
+        tach->rpm = 0.0f;
+    } else if(count > 0) {
+        tach->period_us = sum / count;
+        rpm = 60.0f * TACH_TIMER_CLOCK / ((float)tach->period_us * TACH_PULSES_PER_REV);
+        if(tach->stalled) {
+            tach->rpm = rpm;
+            tach->stalled = 0;
+        } else {
+            tach->rpm += TACH_RPM_FILTER * (rpm - tach->rpm);
+        }
+    }
+}
+
+/**
+  * @brief  获取转速
+  * @param  tach: 测速实例
+  * @retval float: 转速(RPM)，停转时为0
+  */
+float TACH_GetRpm(Tach_TypeDef *tach)
+{
+    return tach->rpm;
+}
+
+/**
+  * @brief  是否停转
+  * @param  tach: 测速实例
+  * @retval uint8_t: 1表示超过TACH_STALL_TIMEOUT_US未见脉冲
+  */
+uint8_t TACH_IsStalled(Tach_TypeDef *tach)
+{
+    return tach->stalled;
+}
+
+#if TACH_USE_SIMULATION
+/**
+  * @brief  设置仿真转速模型
+  * @param  tach: 测速实例
+  * @param  rpm_per_percent: 稳态增益(RPM/%)，可用于模拟电压下降或风扇老化
+  * @param  tau: 时间常数(s)，0表示立即到达
+  * @retval 无
+  */
+void TACH_SimConfig(Tach_TypeDef *tach, float rpm_per_percent, float tau)
+{
+    tach->sim_rpm_per_percent = (rpm_per_percent > 0.0f) ? rpm_per_percent : 0.0f;
+    tach->sim_tau = (tau > 0.0f) ? tau : 0.0f;
+}
+
+/**
+  * @brief  设置仿真指令
+  * @param  tach: 测速实例
+  * @param  percent: 指令(0-100%)
+  * @retval 无
+  */
+void TACH_SimSetCommand(Tach_TypeDef *tach, float percent)
+{
+    if(percent < 0.0f) percent = 0.0f;
+    if(percent > 100.0f) percent = 100.0f;
+
+    tach->sim_command = percent;
+}
+#endif
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    tach.h
+  * @brief   风扇测速(输入捕获+DMA)模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __TACH_H
+#define __TACH_H
+
+#include "stm32f10x.h"
+
+/* 1: 不使用捕获硬件，由一阶转速模型生成捕获值(无测速线的板子或主机验证)，0: 硬件捕获 */
+#ifndef TACH_USE_SIMULATION
+#define TACH_USE_SIMULATION      0
+#endif
+
+/*
+ * 捕获定时器以1MHz自由运行(ARR=0xFFFF，约65.5ms回绕)，每个测速脉冲沿由DMA把
+ * CCRx搬到环形缓冲，中断不参与。TACH_Update在控制周期中读取新增的捕获值，
+ * 相邻捕获值的16位无符号差即脉冲周期；两次调用间隔加超时须小于回绕时间，
+ * 超时未见脉冲判为停转并丢弃参考沿，避免跨回绕的周期被误算。
+ */
+#define TACH_TIMER_CLOCK         1000000  // 捕获定时器计数频率(Hz)
+#define TACH_BUFFER_SIZE         16       // 每路DMA环形缓冲长度(捕获值个数)
+#define TACH_PULSES_PER_REV      2        // 每转脉冲数
+#define TACH_STALL_TIMEOUT_US    50000    // 停转判定超时(us)，须小于65536-调用间隔
+#define TACH_MIN_PERIOD_US       100      // 最短有效周期(us)，更短视为毛刺
+
+/* 测速硬件描述 */
+typedef struct {
+    TIM_TypeDef *tim;            // 捕获定时器(按TACH_TIMER_CLOCK自由运行)
+    uint32_t tim_rcc;            // 定时器时钟
+    uint8_t tim_on_apb2;         // 1: 定时器挂在APB2
+    uint16_t tim_channel;        // 捕获通道 TIM_Channel_x
+    uint16_t tim_dma;            // 捕获DMA请求 TIM_DMA_CCx
+    DMA_Channel_TypeDef *dma;    // 对应的DMA通道
+    uint32_t dma_rcc;            // DMA控制器时钟
+    GPIO_TypeDef *port;          // 测速输入端口
+    uint16_t pin;                // 测速输入引脚
+    uint32_t gpio_rcc;           // 端口时钟
+} TachConfig_TypeDef;
+
+/* 测速实例 */
+typedef struct {
+    const TachConfig_TypeDef *config; // 硬件描述(仿真时只使用其定时器计数)
+    volatile uint16_t captures[TACH_BUFFER_SIZE]; // DMA环形缓冲
+    uint8_t tail;                // 下一个待处理的缓冲位置
+
+    uint16_t last_capture;       // 上一个有效脉冲沿的捕获值
+    uint16_t last_now;           // 上次更新时的计数值
+    uint8_t has_edge;            // last_capture有效
+    uint8_t stalled;             // 1: 超时未见脉冲
+    uint32_t idle_us;            // 距上一个脉冲沿的时间(us)
+    uint32_t period_us;          // 最近一次更新的平均脉冲周期(us)
+    uint32_t edge_count;         // 累计脉冲沿数
+    float rpm;                   // 转速(RPM)
+
+#if TACH_USE_SIMULATION
+    float sim_rpm;               // 仿真转速(RPM)
+    float sim_command;           // 仿真指令(%)
+    float sim_rpm_per_percent;   // 仿真稳态增益(RPM/%)
+    float sim_tau;               // 仿真时间常数(s)，0表示立即到达
+    uint32_t sim_time;           // 仿真时间(us)，由计数值差累加
+    float sim_phase;             // 仿真脉冲相位(0-1)
+    uint8_t sim_head;            // 仿真写入位置
+#endif
+} Tach_TypeDef;
+
+/* 预定义硬件描述 */
+extern const TachConfig_TypeDef TACH_CONFIG_TIM3_CH1;  // PA6 / TIM3_CH1 / DMA1通道6
+extern const TachConfig_TypeDef TACH_CONFIG_TIM5_CH1;  // PA0 / TIM5_CH1 / DMA2通道5
+
+/* 函数声明 */
+void TACH_Init(Tach_TypeDef *tach, const TachConfig_TypeDef *config); // 初始化测速实例
+void TACH_Update(Tach_TypeDef *tach, uint16_t now);                  // 处理新增捕获值，计算转速并检测停转
+uint16_t TACH_GetCounter(Tach_TypeDef *tach);                        // 读取捕获定时器计数值
+float TACH_GetRpm(Tach_TypeDef *tach);                               // 获取转速(RPM)
+uint8_t TACH_IsStalled(Tach_TypeDef *tach);                          // 是否停转
+
+#if TACH_USE_SIMULATION
+void TACH_SimConfig(Tach_TypeDef *tach, float rpm_per_percent, float tau); // 设置仿真转速模型
+void TACH_SimSetCommand(Tach_TypeDef *tach, float percent);               // 设置仿真指令(%)
+#endif
+
+#endif /* __TACH_H */
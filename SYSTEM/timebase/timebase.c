@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file    timebase.c
+  * @brief   CPU周期计数(DWT)时基模块实现
+  ******************************************************************************
+  */
+
+#include "timebase.h"
+
+/* 私有变量 */
+static uint32_t g_cycles_high = 0;   // 64位周期计数的高32位
+static uint32_t g_cycles_last = 0;   // 上次读到的DWT_CYCCNT，用于检测回绕
+
+/**
+  * @brief  初始化DWT周期计数器
+  * @param  无
+  * @retval 无
+  */
+void TIMEBASE_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;  // 使能DWT/ITM跟踪单元
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+    g_cycles_high = 0;
+    g_cycles_last = 0;
+}
+
+/**
+  * @brief  读取CPU周期计数
+  * @param  无
+  * @retval uint32_t: 当前周期计数
+  */
+uint32_t TIMEBASE_GetCycles(void)
+{
+    return DWT_CYCCNT;
+}
+
+/**
+  * @brief  读取64位CPU周期计数
+  * @param  无
+  * @retval uint64_t: 自TIMEBASE_Init起的周期数
+  * @note   检测回绕和更新高位须原子完成，调用者可能已关中断，退出时恢复原状态
+  */
+uint64_t TIMEBASE_GetCycles64(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now;
+    uint64_t cycles;
+
+    __disable_irq();
+    now = DWT_CYCCNT;
+    if (now < g_cycles_last) {
+        g_cycles_high++;
+    }
+    g_cycles_last = now;
+    cycles = ((uint64_t)g_cycles_high << 32) | now;
+    if (!primask) {
+        __enable_irq();
+    }
+
+    return cycles;
+}
+
+/**
+  * @brief  读取微秒时间戳
+  * @param  无
+  * @retval uint64_t: 自TIMEBASE_Init起的微秒数
+  */
+uint64_t TIMEBASE_GetMicros(void)
+{
+    return TIMEBASE_GetCycles64() / (SystemCoreClock / 1000000);
+}
@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    timebase.h
+  * @brief   CPU周期计数(DWT)时基模块头文件
+  ******************************************************************************
+  */
+
+#ifndef __TIMEBASE_H
+#define __TIMEBASE_H
+
+#include "stm32f10x.h"
+
+/* DWT寄存器(CMSIS 1.30的core_cm3.h未提供DWT定义) */
+#define DWT_CTRL                (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT              (*(volatile uint32_t *)0xE0001004)
+#define DWT_CTRL_CYCCNTENA      0x00000001
+
+/**
+  * @brief  初始化DWT周期计数器
+  * @param  无
+  * @retval 无
+  */
+void TIMEBASE_Init(void);
+
+/**
+  * @brief  读取CPU周期计数
+  * @param  无
+  * @retval uint32_t: 当前周期计数(72MHz下约59.6s回绕一次)
+  * @note   差值用无符号减法即可正确处理回绕
+  */
+uint32_t TIMEBASE_GetCycles(void);
+
+/**
+  * @brief  读取64位CPU周期计数
+  * @param  无
+  * @retval uint64_t: 自TIMEBASE_Init起的周期数
+  * @note   软件记录32位计数的回绕，两次调用间隔须小于一个回绕周期(约59.6s)；
+  *         角度传感器DMA中断每1ms调用一次，可在中断和主循环中调用
+  */
+uint64_t TIMEBASE_GetCycles64(void);
+
+/**
+  * @brief  读取微秒时间戳
+  * @param  无
+  * @retval uint64_t: 自TIMEBASE_Init起的微秒数
+  * @note   统一的采样时间戳来源，同TIMEBASE_GetCycles64的调用间隔要求
+  */
+uint64_t TIMEBASE_GetMicros(void);
+
+#endif /* __TIMEBASE_H */
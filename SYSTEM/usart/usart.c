@@ -77,14 +77,41 @@ int GetKey (void)  {
 */
  
 #if EN_USART1_RX   //ʹ˽
-//1жϷ
-//ע,ȡUSARTx->SRܱĪĴ   	
+//1գDMA1ͨ5ѭдUSART_RX_RINGCPUֽڽж
+//ж(һ֡)DMA/ȫжֻѽյֽ
+//ѭUSART_RxServiceӻλȡһзŵUSART_RX_BUFUSART_RX_STAЭ鲻
+//0x00ָĶ֡(RPCıв0x00)ŵUSART_RX_FRAME
 u8 USART_RX_BUF[USART_REC_LEN];     //ջ,USART_REC_LENֽ.
 //״̬
 //bit15	ɱ־
 //bit14	յ0x0d
 //bit13~0	յЧֽĿ
 u16 USART_RX_STA=0;       //״̬	  
+u8 USART_RX_FRAME[USART_FRAME_LEN];	//֡,ָ
+//֡״̬
+//bit15	֡ɱ־
+//bit14	յʼ0x00,ڽ֡
+//bit13	֡,һ0x00
+//bit12~0	յֽ֡Ŀ
+u16 USART_RX_FRAME_STA=0;
+
+static u8 USART_RX_RING[USART_RX_RING_LEN];	//DMAѭջ
+static volatile u32 USART_RX_HEAD=0;		//DMAдֽ(жϸ)
+static u32 USART_RX_TAIL=0;					//ȡֽ(ѭ)
+static u16 USART_RX_POS=0;					//ϴжʱDMAдλ
+static u8 USART_RX_SKIP=0;					//г,β
+static u32 USART_RX_OVERRUNS=0;				//λ
+static u32 USART_RX_LONG=0;					//д
+
+//DMAʣѽյֽ
+///ȫжϱ֤θ֮DMAдȦ,дλñСΪƻ
+static void USART_RxUpdate(void)
+{
+	u16 pos=USART_RX_RING_LEN-(u16)DMA1_Channel5->CNDTR;
+	if(pos==USART_RX_RING_LEN)pos=0;
+	USART_RX_HEAD+=(u16)(pos-USART_RX_POS)&(USART_RX_RING_LEN-1);
+	USART_RX_POS=pos;
+}
   
 void uart_init(u32 bound)
 {
@@ -92,8 +119,10 @@ void uart_init(u32 bound)
 	GPIO_InitTypeDef GPIO_InitStructure;
 	USART_InitTypeDef USART_InitStructure;
 	NVIC_InitTypeDef NVIC_InitStructure;
+	DMA_InitTypeDef DMA_InitStructure;
 
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1|RCC_APB2Periph_GPIOA, ENABLE);	//ʹUSART1GPIOAʱ
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);	//ʹDMA1ʱ
 
 	//USART1_TX   GPIOA.9
 	GPIO_InitStructure.GPIO_Pin = GPIO_Pin_9; //PA.9
@@ -106,6 +135,24 @@ void uart_init(u32 bound)
 	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;//
 	GPIO_Init(GPIOA, &GPIO_InitStructure);//ʼGPIOA.10  
 
+	//USART1_RX DMAãDMA1ͨ5,->ڴ,ѭģʽ
+	DMA_DeInit(DMA1_Channel5);
+	DMA_InitStructure.DMA_PeripheralBaseAddr = (u32)&USART1->DR;
+	DMA_InitStructure.DMA_MemoryBaseAddr = (u32)USART_RX_RING;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+	DMA_InitStructure.DMA_BufferSize = USART_RX_RING_LEN;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;	//ADC(ͨ1)
+	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+	DMA_Init(DMA1_Channel5, &DMA_InitStructure);
+	USART_RX_HEAD=0;
+	USART_RX_TAIL=0;
+	USART_RX_POS=0;
+
 	//Usart1 NVIC 
 	NVIC_InitStructure.NVIC_IRQChannel = USART1_IRQn;
 	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority=3 ;//ռȼ3
@@ -113,6 +160,10 @@ void uart_init(u32 bound)
 	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;			//IRQͨʹ
 	NVIC_Init(&NVIC_InitStructure);	//ָĲʼVICĴ
 
+	//DMA1ͨ5 NVIC ,봮жͬһռȼ,߲ụ
+	NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel5_IRQn;
+	NVIC_Init(&NVIC_InitStructure);
+
 	//USART ʼ
 
 	USART_InitStructure.USART_BaudRate = bound;//ڲ
@@ -123,43 +174,113 @@ void uart_init(u32 bound)
 	USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;	//շģʽ
 
   USART_Init(USART1, &USART_InitStructure); //ʼ1
-  USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);//ڽж
+  DMA_ITConfig(DMA1_Channel5, DMA_IT_HT | DMA_IT_TC, ENABLE);//DMA/ȫж
+  DMA_Cmd(DMA1_Channel5, ENABLE);               //DMA
+  USART_DMACmd(USART1, USART_DMAReq_Rx, ENABLE);//ڽDMA
+  USART_ITConfig(USART1, USART_IT_IDLE, ENABLE);//ڿж
   USART_Cmd(USART1, ENABLE);                    //ʹܴ1 
 
 }
 
 void USART1_IRQHandler(void)                	//1жϷ
 {
-	u8 Res;
 #if SYSTEM_SUPPORT_OS 		//SYSTEM_SUPPORT_OSΪ棬Ҫ֧OS.
 	OSIntEnter();    
 #endif
-	if(USART_GetITStatus(USART1, USART_IT_RXNE) != RESET)  //ж(յݱ0x0d 0x0aβ)
+	if(USART_GetITStatus(USART1, USART_IT_IDLE) != RESET)  //ж:һ֡ݽս
 		{
-		Res =USART_ReceiveData(USART1);	//ȡյ
-		
-		if((USART_RX_STA&0x8000)==0)//δ
-			{
-			if(USART_RX_STA&0x4000)//յ0x0d
-				{
-				if(Res!=0x0a)USART_RX_STA=0;//մ,¿ʼ
-				else USART_RX_STA|=0x8000;	// 
-				}
-			else //ûյ0X0D
-				{	
-				if(Res==0x0d)USART_RX_STA|=0x4000;
-				else
-					{
-					USART_RX_BUF[USART_RX_STA&0X3FFF]=Res ;
-					USART_RX_STA++;
-					if(USART_RX_STA>(USART_REC_LEN-1))USART_RX_STA=0;//ݴ,¿ʼ	  
-					}		 
-				}
-			}   		 
-     } 
+		(void)USART1->SR;	//ȶSRٶDRIDLE־
+		(void)USART1->DR;
+		USART_RxUpdate();
+		}
 #if SYSTEM_SUPPORT_OS 	//SYSTEM_SUPPORT_OSΪ棬Ҫ֧OS.
 	OSIntExit();  											 
 #endif
 } 
+
+void DMA1_Channel5_IRQHandler(void)         	//1DMAжϷ
+{
+#if SYSTEM_SUPPORT_OS 		//SYSTEM_SUPPORT_OSΪ棬Ҫ֧OS.
+	OSIntEnter();    
+#endif
+	if(DMA_GetITStatus(DMA1_IT_HT5) != RESET)DMA_ClearITPendingBit(DMA1_IT_HT5);	//дһ
+	if(DMA_GetITStatus(DMA1_IT_TC5) != RESET)DMA_ClearITPendingBit(DMA1_IT_TC5);	//дһȦ
+	USART_RxUpdate();
+#if SYSTEM_SUPPORT_OS 	//SYSTEM_SUPPORT_OSΪ棬Ҫ֧OS.
+	OSIntExit();  											 
+#endif
+}
+
+//ӻλȡһеUSART_RX_BUF(0x0d 0x0aβ)һ֡USART_RX_FRAME(0x00 ֡ 0x00)
+//USART_RX_EV_LINE/USART_RX_EV_FRAMEʾһ/һ֡,USART_RX_STA/USART_RX_FRAME_STA0Żȡ
+//ѭеãε֮յݲܳUSART_RX_RING_LEN,δȡ
+u8 USART_RxService(void)
+{
+	u8 Res;
+	u32 head;
+	if(USART_RX_STA&0x8000)return USART_RX_EV_LINE;		//һлδ
+	if(USART_RX_FRAME_STA&0x8000)return USART_RX_EV_FRAME;	//һ֡δ
+	__disable_irq();
+	USART_RxUpdate();						//ж֮ǰҲȡ
+	head=USART_RX_HEAD;
+	__enable_irq();
+	if(head-USART_RX_TAIL>USART_RX_RING_LEN)	//DMAѸδȡ
+		{
+		USART_RX_TAIL=head-USART_RX_RING_LEN/2;	//µİȦ
+		USART_RX_STA=0;
+		USART_RX_SKIP=1;					//һβ¿ʼ
+		USART_RX_FRAME_STA=0;				//֡ɽշУ鶪
+		USART_RX_OVERRUNS++;
+		}
+	while(USART_RX_TAIL!=head)
+		{
+		Res=USART_RX_RING[USART_RX_TAIL&(USART_RX_RING_LEN-1)];
+		USART_RX_TAIL++;
+		if(Res==0x00)//ָ֡
+			{
+			if(USART_RX_FRAME_STA&0x2000)USART_RX_FRAME_STA=0;	//֡
+			else if(USART_RX_FRAME_STA&0x1FFF){USART_RX_FRAME_STA=(USART_RX_FRAME_STA&0x1FFF)|0x8000;return USART_RX_EV_FRAME;}	//֡
+			else USART_RX_FRAME_STA=0x4000;	//֡ʼ,0x00Ϊ֡϶
+			USART_RX_STA=0;				//δɵı
+			USART_RX_SKIP=0;
+			}
+		else if(USART_RX_FRAME_STA&0x4000)//ֽ֡
+			{
+			if(USART_RX_FRAME_STA&0x2000);	//֡,
+			else if((USART_RX_FRAME_STA&0x1FFF)<USART_FRAME_LEN){USART_RX_FRAME[USART_RX_FRAME_STA&0x1FFF]=Res;USART_RX_FRAME_STA++;}
+			else {USART_RX_FRAME_STA|=0x2000;USART_RX_LONG++;}
+			}
+		else if(USART_RX_STA&0x4000)//յ0x0d
+			{
+			if(Res!=0x0a)USART_RX_STA=0;//մ,¿ʼ
+			else if(USART_RX_SKIP){USART_RX_STA=0;USART_RX_SKIP=0;}//н
+			else {USART_RX_STA|=0x8000;return USART_RX_EV_LINE;}	// 
+			}
+		else //ûյ0X0D
+			{	
+			if(Res==0x0d)USART_RX_STA|=0x4000;
+			else if(!USART_RX_SKIP)
+				{
+				USART_RX_BUF[USART_RX_STA&0X3FFF]=Res ;
+				USART_RX_STA++;
+				if(USART_RX_STA>(USART_REC_LEN-1))//г,жǰѺе
+					{
+					USART_RX_STA=0;
+					USART_RX_SKIP=1;
+					USART_RX_LONG++;
+					}
+				}
+			}
+		}
+	return USART_RX_EV_NONE;
+}
+
+//ȡմ
+//overruns:λ,long_lines:/֡
+void USART_RxGetErrors(u32 *overruns,u32 *long_lines)
+{
+	*overruns=USART_RX_OVERRUNS;
+	*long_lines=USART_RX_LONG;
+}
 #endif	
 
@@ -26,13 +26,29 @@
 //4,޸EN_USART1_RXʹܷʽ
 //V1.5޸˵
 //1,˶UCOSII֧
+//V1.6޸˵
+//1,ոΪDMA1ͨ5ѭ+ж,ֽж
+//2,װƵѭUSART_RxService,USART_RX_BUF/USART_RX_STA÷
+//3,ж,
+//V1.7޸˵
+//1,0x00ָĶ֡(USART_RX_FRAME),ıйô1
+//2,USART_RxServiceUSART_RX_EV_LINE/USART_RX_EV_FRAME
 #define USART_REC_LEN  			200  	//ֽ 200
 #define EN_USART1_RX 			1		//ʹܣ1/ֹ01
+#define USART_RX_RING_LEN		2048	//DMAջλֽ(2),921600Լ22ms
+#define USART_FRAME_LEN			128		//ֽ֡(COBS,ָ)
+#define USART_RX_EV_NONE			0		//USART_RxServiceֵ:
+#define USART_RX_EV_LINE			1		//USART_RX_BUFһ
+#define USART_RX_EV_FRAME			2		//USART_RX_FRAMEһ֡
 	  	
 extern u8  USART_RX_BUF[USART_REC_LEN]; //ջ,USART_REC_LENֽ.ĩֽΪз 
 extern u16 USART_RX_STA;         		//״̬	
+extern u8  USART_RX_FRAME[USART_FRAME_LEN];	//֡
+extern u16 USART_RX_FRAME_STA;				//֡״̬,bit15,bit12~0ֽ
 //봮жϽգ벻Ҫעº궨
 void uart_init(u32 bound);
+u8 USART_RxService(void);						//ѭ:ȡһ/һ֡,USART_RX_EV_LINE/USART_RX_EV_FRAME
+void USART_RxGetErrors(u32 *overruns,u32 *long_lines);	//ȡմ
 #endif
 
 
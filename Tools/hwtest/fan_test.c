@@ -0,0 +1,367 @@
+/**
+  ******************************************************************************
+  * @file    fan_test.c
+  * @brief   风扇驱动寄存器写入测试(主机程序)
+  ******************************************************************************
+  * 用hw_fake.c代替标准外设库运行Hardware/fan_driver/fan_driver.c，按控制中断
+  * 的调用方式(暂存推力/速度和方向后FAN_Commit)执行若干控制周期，核对：
+  *   - 指令不变的周期不写比较值也不写方向引脚；
+  *   - 指令改变时只写变化的通道，方向不变时不写GPIO，
+  *     方向改变时只写电平变化的引脚；
+  *   - FAN_GetWriteCount与替身统计的写入次数一致，且没有写入原值的冗余写入；
+  *   - 设置了加/减速率但未预置斜坡时，闭环指令在Commit中立即写入，不开更新中断；
+  *   - 预置的斜坡和软停止由PWM更新中断完成，结束后关闭中断，之后的指令重新立即生效。
+  * 另外检查FAN_ComputeTiming在72/36/8MHz定时器时钟下的预分频、周期和分辨率，
+  * 无法满足的请求不改动输出；以及时钟不足时FAN_Init退回到不检查分辨率的配置
+  * 并返回FAN_ERROR，FAN_SetPwmFrequency失败时保持原配置。
+  * 有失败项时返回1。
+  *
+  * 编译运行(在仓库根目录)：
+  *   gcc -std=gnu99 -Wall -Wno-unused-parameter -ITools/hwtest/host -ITools/hwtest \
+  *       -IHardware/fan_driver Tools/hwtest/fan_test.c Tools/hwtest/hw_fake.c \
+  *       Hardware/fan_driver/fan_driver.c -o fan_test && ./fan_test
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hw_fake.h"
+#include "fan_driver.h"
+
+#define TEST_TICKS           10        // 指令不变时检查的控制周期数
+
+static int test_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { test_failures++; printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } \
+} while (0)
+
+/* 一个控制周期前的计数快照 */
+typedef struct {
+    uint32_t ccr;
+    uint32_t gpio;
+    uint32_t count;
+} TestSnapshot_TypeDef;
+
+static FanDriver_TypeDef test_fan;
+
+static void TEST_Snapshot(TestSnapshot_TypeDef *snap)
+{
+    snap->ccr = g_hw.ccr_writes;
+    snap->gpio = g_hw.gpio_writes;
+    snap->count = FAN_GetWriteCount(&test_fan);
+}
+
+/**
+  * @brief  按控制中断的方式执行一个周期
+  * @param  left: 左风扇推力 (Q15)
+  * @param  right: 右风扇推力 (Q15)
+  * @param  right_dir: 右风扇方向
+  * @retval 无
+  */
+static void TEST_ThrustTick(uint16_t left, uint16_t right, FanDirection_TypeDef right_dir)
+{
+    FAN_StageThrust(&test_fan, FAN_LEFT, left);
+    FAN_StageThrust(&test_fan, FAN_RIGHT, right);
+    FAN_StageDirection(&test_fan, FAN_LEFT, FAN_DIR_FORWARD);
+    FAN_StageDirection(&test_fan, FAN_RIGHT, right_dir);
+    FAN_Commit(&test_fan);
+}
+
+/**
+  * @brief  检查一个周期内的写入次数
+  * @param  snap: 周期前的快照
+  * @param  ccr: 期望的比较值写入次数
+  * @param  gpio: 期望的GPIO写入次数
+  * @param  what: 周期说明
+  * @retval 无
+  */
+static void TEST_ExpectWrites(const TestSnapshot_TypeDef *snap, uint32_t ccr, uint32_t gpio, const char *what)
+{
+    uint32_t d_ccr = g_hw.ccr_writes - snap->ccr;
+    uint32_t d_gpio = g_hw.gpio_writes - snap->gpio;
+    uint32_t d_count = FAN_GetWriteCount(&test_fan) - snap->count;
+
+    CHECK(d_ccr == ccr, "%s: %u CCR writes, expected %u", what, d_ccr, ccr);
+    CHECK(d_gpio == gpio, "%s: %u GPIO writes, expected %u", what, d_gpio, gpio);
+    CHECK(d_count == d_ccr + d_gpio, "%s: write count %u, peripheral saw %u", what, d_count, d_ccr + d_gpio);
+    CHECK((TIM2->CR1 & TIM_CR1_UDIS) == 0, "%s: UDIS left set", what);
+}
+
+static void TEST_CommitWrites(void)
+{
+    TestSnapshot_TypeDef snap;
+    uint16_t ccr;
+    int i;
+
+    HW_FAKE_Reset(72000000, 2, 1);
+    CHECK(FAN_Init(&test_fan, &FAN_DRIVER_CONFIG_TIM2) == FAN_OK, "FAN_Init at 72 MHz");
+    g_hw.ccr_same = 0;
+    g_hw.gpio_same = 0;
+
+    /* 首个周期：两路比较值，两路由滑行转正向只改IN1 */
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(16384, 8192, FAN_DIR_FORWARD);
+    TEST_ExpectWrites(&snap, 2, 2, "first tick");
+    CHECK(g_hw.udis_sets == 1, "commit should bracket the CCR writes with UDIS once");
+
+    /* 指令不变：不写任何寄存器 */
+    for (i = 0; i < TEST_TICKS; i++) {
+        TEST_Snapshot(&snap);
+        TEST_ThrustTick(16384, 8192, FAN_DIR_FORWARD);
+        TEST_ExpectWrites(&snap, 0, 0, "unchanged tick");
+    }
+
+    /* 只改左路推力：一次比较值写入，不写GPIO */
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(20000, 8192, FAN_DIR_FORWARD);
+    TEST_ExpectWrites(&snap, 1, 0, "left thrust changed");
+
+    /* 推力变化不足一个比较值LSB：不写 */
+    ccr = TIM2->CCR3;
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(20000, 8193, FAN_DIR_FORWARD);
+    TEST_ExpectWrites(&snap, TIM2->CCR3 != ccr ? 1 : 0, 0, "sub-LSB change");
+
+    /* 只改右路方向：两个方向引脚，不写比较值 */
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(20000, 8193, FAN_DIR_REVERSE);
+    TEST_ExpectWrites(&snap, 0, 2, "right direction changed");
+    CHECK((GPIOB->ODR & (FAN_RIGHT_IN1_PIN | FAN_RIGHT_IN2_PIN)) == FAN_RIGHT_IN2_PIN,
+          "right fan pins should be IN1=L IN2=H");
+
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(20000, 8193, FAN_DIR_REVERSE);
+    TEST_ExpectWrites(&snap, 0, 0, "unchanged after direction change");
+
+    /* 百分比指令同样按缓存跳过 */
+    for (i = 0; i < 3; i++) {
+        TEST_Snapshot(&snap);
+        FAN_SetDualSpeed(&test_fan, 40, 60);
+        TEST_ExpectWrites(&snap, i == 0 ? 2 : 0, 0, "dual speed");
+    }
+
+    /* 重复停止：第二次不写 */
+    TEST_Snapshot(&snap);
+    FAN_StopAll(&test_fan);
+    TEST_ExpectWrites(&snap, 2, 2, "stop");
+    TEST_Snapshot(&snap);
+    FAN_StopAll(&test_fan);
+    TEST_ExpectWrites(&snap, 0, 0, "second stop");
+
+    CHECK(g_hw.ccr_same == 0, "%u CCR writes repeated the register value", g_hw.ccr_same);
+    CHECK(g_hw.gpio_same == 0, "%u GPIO writes left the pins unchanged", g_hw.gpio_same);
+}
+
+static void TEST_RampWrites(void)
+{
+    TestSnapshot_TypeDef snap;
+    uint32_t cycles;
+
+    HW_FAKE_Reset(72000000, 2, 1);
+    FAN_Init(&test_fan, &FAN_DRIVER_CONFIG_TIM2);
+    FAN_SetRamp(&test_fan, 100.0f, 100.0f);  // 10ms满量程，200个PWM周期
+    TEST_ThrustTick(0, 0, FAN_DIR_FORWARD);
+    g_hw.ccr_same = 0;
+    g_hw.gpio_same = 0;
+
+    /* 未预置斜坡：闭环指令立即生效，不开更新中断 */
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(FAN_THRUST_MAX / 2, 0, FAN_DIR_FORWARD);
+    TEST_ExpectWrites(&snap, 1, 0, "unarmed command");
+    CHECK((TIM2->DIER & TIM_IT_Update) == 0, "update interrupt on for an unarmed command");
+    CHECK(!FAN_IsRamping(&test_fan), "unarmed command started a ramp");
+    TEST_ThrustTick(0, 0, FAN_DIR_FORWARD);
+
+    /* 预置斜坡(模式交接)：Commit不写比较值，由更新中断逐周期写 */
+    FAN_ArmRamp(&test_fan);
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(FAN_THRUST_MAX, 0, FAN_DIR_FORWARD);
+    TEST_ExpectWrites(&snap, 0, 0, "ramp start");
+    CHECK(TIM2->DIER & TIM_IT_Update, "update interrupt should be on while ramping");
+
+    for (cycles = 0; cycles < 1000 && FAN_IsRamping(&test_fan); cycles++) {
+        TIM2->SR |= TIM_IT_Update;
+        FAN_IRQHandler(TIM2);
+    }
+    CHECK(!FAN_IsRamping(&test_fan), "ramp did not finish");
+    CHECK(cycles >= 190 && cycles <= 210, "ramp took %u PWM cycles, expected about 200", cycles);
+    CHECK((TIM2->DIER & TIM_IT_Update) == 0, "update interrupt left on after ramp");
+    CHECK(TIM2->CCR2 == test_fan.period - 1, "left CCR %u after ramp, expected %u", TIM2->CCR2, test_fan.period - 1);
+
+    /* 斜坡结束后指令不变：不写 */
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(FAN_THRUST_MAX, 0, FAN_DIR_FORWARD);
+    TEST_ExpectWrites(&snap, 0, 0, "after ramp");
+
+    /* 斜坡结束后的新指令立即生效 */
+    TEST_Snapshot(&snap);
+    TEST_ThrustTick(FAN_THRUST_MAX / 2, 0, FAN_DIR_FORWARD);
+    TEST_ExpectWrites(&snap, 1, 0, "command after ramp");
+    CHECK(!FAN_IsRamping(&test_fan), "command after ramp started a ramp");
+
+    /* 软停止按减速率，到0后滑行 */
+    FAN_SoftStop(&test_fan, FAN_LEFT);
+    CHECK(FAN_IsRamping(&test_fan), "soft stop did not ramp");
+    for (cycles = 0; cycles < 1000 && FAN_IsRamping(&test_fan); cycles++) {
+        TIM2->SR |= TIM_IT_Update;
+        FAN_IRQHandler(TIM2);
+    }
+    CHECK(cycles >= 90 && cycles <= 110, "soft stop took %u PWM cycles, expected about 100", cycles);
+    CHECK(TIM2->CCR2 == 0, "left CCR %u after soft stop", TIM2->CCR2);
+
+    CHECK(g_hw.ccr_same == 0, "%u CCR writes repeated the register value during ramp", g_hw.ccr_same);
+}
+
+/**
+  * @brief  检查一组定时参数
+  * @param  tim_clock: 定时器时钟(Hz)
+  * @param  freq: 期望PWM频率(Hz)
+  * @param  min_bits: 要求的最低分辨率(位)
+  * @param  prescaler: 期望预分频系数，0表示期望FAN_ERROR
+  * @param  period: 期望周期计数
+  * @param  bits: 期望分辨率(位)
+  * @retval 无
+  */
+static void TEST_ExpectTiming(uint32_t tim_clock, uint32_t freq, uint8_t min_bits,
+                              uint32_t prescaler, uint32_t period, uint8_t bits)
+{
+    FanPwmTiming_TypeDef timing;
+    FanPwmTiming_TypeDef untouched;
+    FanStatus_TypeDef status;
+
+    memset(&timing, 0xA5, sizeof(timing));
+    untouched = timing;
+    status = FAN_ComputeTiming(tim_clock, freq, min_bits, &timing);
+
+    if (prescaler == 0) {
+        CHECK(status == FAN_ERROR, "%u Hz at %u Hz, %u bits should fail", freq, tim_clock, min_bits);
+        CHECK(memcmp(&timing, &untouched, sizeof(timing)) == 0, "%u Hz at %u Hz: output written on failure",
+              freq, tim_clock);
+        return;
+    }
+    CHECK(status == FAN_OK, "%u Hz at %u Hz, %u bits should succeed", freq, tim_clock, min_bits);
+    CHECK(timing.prescaler == prescaler && timing.period == period && timing.bits == bits,
+          "%u Hz at %u Hz: psc %u period %u bits %u, expected %u %u %u", freq, tim_clock,
+          timing.prescaler, timing.period, timing.bits, prescaler, period, bits);
+}
+
+static void TEST_ComputeTiming(void)
+{
+    static const uint32_t clocks[] = {72000000, 36000000, 8000000};
+    FanPwmTiming_TypeDef timing;
+    uint32_t freq;
+    uint32_t err;
+    uint8_t bits;
+    int c;
+
+    /* 默认20kHz：只有72MHz满足11位 */
+    TEST_ExpectTiming(72000000, FAN_PWM_FREQ, FAN_PWM_MIN_BITS, 1, 3600, 11);
+    TEST_ExpectTiming(36000000, FAN_PWM_FREQ, FAN_PWM_MIN_BITS, 0, 0, 0);
+    TEST_ExpectTiming(36000000, FAN_PWM_FREQ, 10, 1, 1800, 10);
+    TEST_ExpectTiming(8000000, FAN_PWM_FREQ, FAN_PWM_MIN_BITS, 0, 0, 0);
+    TEST_ExpectTiming(8000000, FAN_PWM_FREQ, 0, 1, 400, 8);
+    TEST_ExpectTiming(40960000, FAN_PWM_FREQ, 11, 1, 2048, 11);  // 11位的最低时钟
+    TEST_ExpectTiming(40940000, FAN_PWM_FREQ, 11, 0, 0, 0);      // 2047个计数
+
+    /* 低频：需要预分频，取使ARR不超过16位的最小值 */
+    TEST_ExpectTiming(72000000, 1000, 16, 0, 0, 0);               // 预分频后周期不足65536
+    TEST_ExpectTiming(72000000, 1000, 15, 2, 36000, 15);
+    TEST_ExpectTiming(72000000, 100, 0, 11, 65455, 15);
+    TEST_ExpectTiming(8000000, 100, 0, 2, 40000, 15);
+    TEST_ExpectTiming(72000000, 1, 0, 1099, 65514, 15);
+
+    /* 无法满足 */
+    TEST_ExpectTiming(72000000, 0, 0, 0, 0, 0);                   // 频率为0
+    TEST_ExpectTiming(8000000, 9000000, 0, 0, 0, 0);              // 高于定时器时钟
+    TEST_ExpectTiming(8000000, 8000000, 0, 0, 0, 0);              // 周期只有1个计数
+    TEST_ExpectTiming(72000000, 1000000, 7, 0, 0, 0);             // 72个计数只有6位
+    TEST_ExpectTiming(72000000, 1000000, 6, 1, 72, 6);
+    CHECK(FAN_ComputeTiming(72000000, FAN_PWM_FREQ, 0, NULL) == FAN_ERROR, "NULL output should fail");
+
+    /* 扫频：满足时参数合法、分辨率与周期一致、预分频最小、周期误差在舍入范围内 */
+    for (c = 0; c < 3; c++) {
+        for (freq = 1; freq <= 200000; freq += (freq < 1000) ? 1 : 97) {
+            if (FAN_ComputeTiming(clocks[c], freq, 0, &timing) != FAN_OK) {
+                CHECK(clocks[c] / freq < 2, "%u Hz at %u Hz failed with no resolution limit", freq, clocks[c]);
+                continue;
+            }
+            for (bits = 0; (timing.period >> (bits + 1)) != 0; bits++);
+            CHECK(timing.prescaler >= 1 && timing.prescaler <= 65536, "%u Hz: prescaler %u", freq, timing.prescaler);
+            CHECK(timing.period >= 2 && timing.period <= 65536, "%u Hz: period %u", freq, timing.period);
+            CHECK(timing.bits == bits, "%u Hz: bits %u for period %u", freq, timing.bits, timing.period);
+            CHECK((uint64_t)(timing.prescaler - 1) * 65536 < clocks[c] / freq,
+                  "%u Hz: prescaler %u not minimal", freq, timing.prescaler);
+            err = (uint32_t)llabs((int64_t)timing.prescaler * timing.period * freq - clocks[c]);
+            CHECK(err <= (uint64_t)timing.prescaler * freq / 2 + timing.prescaler * timing.period,
+                  "%u Hz at %u Hz: period error %u clocks", freq, clocks[c], err);
+        }
+    }
+}
+
+/**
+  * @brief  按时钟树初始化驱动并检查定时器配置
+  * @param  sysclk: 系统时钟(Hz)
+  * @param  apb1_div: APB1分频系数
+  * @param  config: 硬件描述
+  * @param  status: 期望的FAN_Init返回值
+  * @param  period: 期望的周期计数
+  * @param  bits: 期望的分辨率(位)
+  * @retval 无
+  */
+static void TEST_ExpectInit(uint32_t sysclk, uint8_t apb1_div, const FanDriverConfig_TypeDef *config,
+                            FanStatus_TypeDef status, uint32_t period, uint8_t bits)
+{
+    TIM_TypeDef *tim = config->tim;
+
+    HW_FAKE_Reset(sysclk, apb1_div, 1);
+    CHECK(FAN_Init(&test_fan, config) == status, "FAN_Init at %u Hz /%u: expected status %d",
+          sysclk, apb1_div, status);
+    CHECK(test_fan.period == period && FAN_GetResolutionBits(&test_fan) == bits,
+          "FAN_Init at %u Hz /%u: period %u bits %u, expected %u %u", sysclk, apb1_div,
+          test_fan.period, FAN_GetResolutionBits(&test_fan), period, bits);
+    CHECK(tim->ARR == period - 1 && tim->PSC == 0, "FAN_Init at %u Hz /%u: ARR %u PSC %u",
+          sysclk, apb1_div, tim->ARR, tim->PSC);
+    CHECK(FAN_GetPwmFrequency(&test_fan) == FAN_PWM_FREQ, "FAN_Init at %u Hz /%u: %u Hz",
+          sysclk, apb1_div, FAN_GetPwmFrequency(&test_fan));
+    CHECK(tim->CR1 & 0x0001, "FAN_Init at %u Hz /%u: timer not started", sysclk, apb1_div);
+}
+
+static void TEST_InitFallback(void)
+{
+    FanPwmTiming_TypeDef timing;
+
+    /* APB1分频时TIM2时钟为PCLK1的2倍 */
+    TEST_ExpectInit(72000000, 2, &FAN_DRIVER_CONFIG_TIM2, FAN_OK, 3600, 11);
+    TEST_ExpectInit(72000000, 1, &FAN_DRIVER_CONFIG_TIM8, FAN_OK, 3600, 11);
+
+    /* 时钟不足11位：仍按20kHz运行，分辨率降低并返回FAN_ERROR */
+    TEST_ExpectInit(72000000, 4, &FAN_DRIVER_CONFIG_TIM2, FAN_ERROR, 1800, 10);
+    TEST_ExpectInit(36000000, 1, &FAN_DRIVER_CONFIG_TIM2, FAN_ERROR, 1800, 10);
+    TEST_ExpectInit(8000000, 1, &FAN_DRIVER_CONFIG_TIM2, FAN_ERROR, 400, 8);
+
+    /* 退回的配置可以正常输出 */
+    FAN_SetThrust(&test_fan, FAN_LEFT, FAN_THRUST_MAX);
+    CHECK(TIM2->CCR2 == 399, "full thrust at 8 MHz: CCR %u, expected 399", TIM2->CCR2);
+
+    /* 无法满足的频率：保持原配置 */
+    CHECK(FAN_SetPwmFrequency(&test_fan, 1000000, 8) == FAN_ERROR, "1 MHz 8-bit at 8 MHz should fail");
+    CHECK(TIM2->ARR == 399 && test_fan.period == 400, "failed frequency change altered ARR %u", TIM2->ARR);
+    CHECK(FAN_SetPwmFrequency(&test_fan, 1000, 12) == FAN_OK, "1 kHz 12-bit at 8 MHz should succeed");
+    FAN_ComputeTiming(8000000, 1000, 12, &timing);
+    CHECK(TIM2->ARR == timing.period - 1 && TIM2->PSC == timing.prescaler - 1,
+          "1 kHz at 8 MHz: ARR %u PSC %u", TIM2->ARR, TIM2->PSC);
+    CHECK(TIM2->CCR2 == timing.period - 1, "full thrust after frequency change: CCR %u", TIM2->CCR2);
+}
+
+int main(void)
+{
+    TEST_CommitWrites();
+    TEST_RampWrites();
+    TEST_ComputeTiming();
+    TEST_InitFallback();
+
+    printf("%s: %d failure(s)\n", test_failures ? "FAIL" : "OK", test_failures);
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,359 @@
+/**
+  ******************************************************************************
+  * @file    stm32f10x.h
+  * @brief   硬件模块主机测试用的器件头文件替身
+  ******************************************************************************
+  * 主机编译Hardware/和SYSTEM/下的驱动时代替USER/stm32f10x.h：外设寄存器块是
+  * hw_fake.c中的普通变量，测试可以直接读写(如DMA剩余计数)；标准外设库函数
+  * 由hw_fake.c实现并记录调用。常量取值与标准外设库一致，只列出被测模块用到的部分。
+  * 包含路径中本目录须在USER/之前。
+  ******************************************************************************
+  */
+
+#ifndef __STM32F10x_H
+#define __STM32F10x_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t u32;
+typedef uint16_t u16;
+typedef uint8_t  u8;
+
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+
+/* 中断号 */
+typedef enum {
+    DMA1_Channel1_IRQn = 11,
+    DMA1_Channel5_IRQn = 15,
+    TIM1_UP_IRQn = 25,
+    TIM2_IRQn = 28,
+    USART1_IRQn = 37,
+    TIM8_UP_IRQn = 44
+} IRQn_Type;
+
+/* ---------------------------- 外设寄存器块 ---------------------------- */
+
+typedef struct {
+    volatile uint32_t CRL;
+    volatile uint32_t CRH;
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+    volatile uint32_t BSRR;
+    volatile uint32_t BRR;
+    volatile uint32_t LCKR;
+} GPIO_TypeDef;
+
+typedef struct {
+    volatile uint16_t CR1;
+    volatile uint16_t DIER;
+    volatile uint16_t SR;
+    volatile uint16_t PSC;
+    volatile uint16_t ARR;
+    volatile uint16_t CCR1;
+    volatile uint16_t CCR2;
+    volatile uint16_t CCR3;
+    volatile uint16_t CCR4;
+    volatile uint16_t BDTR;
+} TIM_TypeDef;
+
+typedef struct {
+    volatile uint32_t SR;
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t DR;
+} ADC_TypeDef;
+
+typedef struct {
+    volatile uint32_t CCR;
+    volatile uint32_t CNDTR;
+    volatile uint32_t CPAR;
+    volatile uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    volatile uint16_t SR;
+    volatile uint16_t DR;
+    volatile uint16_t BRR;
+    volatile uint16_t CR1;
+    volatile uint16_t CR2;
+    volatile uint16_t CR3;
+    volatile uint16_t GTPR;
+} USART_TypeDef;
+
+extern GPIO_TypeDef HW_GPIOA, HW_GPIOB, HW_GPIOC, HW_GPIOD, HW_GPIOE;
+extern TIM_TypeDef HW_TIM1, HW_TIM2, HW_TIM8;
+extern ADC_TypeDef HW_ADC1;
+extern DMA_Channel_TypeDef HW_DMA1_Channel1, HW_DMA1_Channel5;
+extern USART_TypeDef HW_USART1;
+
+#define GPIOA                ((GPIO_TypeDef *)&HW_GPIOA)
+#define GPIOB                ((GPIO_TypeDef *)&HW_GPIOB)
+#define GPIOC                ((GPIO_TypeDef *)&HW_GPIOC)
+#define GPIOD                ((GPIO_TypeDef *)&HW_GPIOD)
+#define GPIOE                ((GPIO_TypeDef *)&HW_GPIOE)
+#define TIM1                 ((TIM_TypeDef *)&HW_TIM1)
+#define TIM2                 ((TIM_TypeDef *)&HW_TIM2)
+#define TIM8                 ((TIM_TypeDef *)&HW_TIM8)
+#define ADC1                 ((ADC_TypeDef *)&HW_ADC1)
+#define DMA1_Channel1        ((DMA_Channel_TypeDef *)&HW_DMA1_Channel1)
+#define DMA1_Channel5        ((DMA_Channel_TypeDef *)&HW_DMA1_Channel5)
+#define USART1               ((USART_TypeDef *)&HW_USART1)
+
+/* ---------------------------- RCC ---------------------------- */
+
+typedef struct {
+    uint32_t SYSCLK_Frequency;
+    uint32_t HCLK_Frequency;
+    uint32_t PCLK1_Frequency;
+    uint32_t PCLK2_Frequency;
+    uint32_t ADCCLK_Frequency;
+} RCC_ClocksTypeDef;
+
+#define RCC_APB2Periph_AFIO  ((uint32_t)0x00000001)
+#define RCC_APB2Periph_GPIOA ((uint32_t)0x00000004)
+#define RCC_APB2Periph_GPIOB ((uint32_t)0x00000008)
+#define RCC_APB2Periph_GPIOC ((uint32_t)0x00000010)
+#define RCC_APB2Periph_GPIOD ((uint32_t)0x00000020)
+#define RCC_APB2Periph_GPIOE ((uint32_t)0x00000040)
+#define RCC_APB2Periph_TIM1  ((uint32_t)0x00000800)
+#define RCC_APB2Periph_TIM8  ((uint32_t)0x00002000)
+#define RCC_APB2Periph_ADC1  ((uint32_t)0x00000200)
+#define RCC_APB2Periph_USART1 ((uint32_t)0x00004000)
+#define RCC_APB1Periph_TIM2  ((uint32_t)0x00000001)
+#define RCC_AHBPeriph_DMA1   ((uint32_t)0x00000001)
+#define RCC_PCLK2_Div6       ((uint32_t)0x00008000)
+
+void RCC_GetClocksFreq(RCC_ClocksTypeDef *RCC_Clocks);
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState);
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState);
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState);
+void RCC_ADCCLKConfig(uint32_t RCC_PCLK2);
+
+/* ---------------------------- GPIO ---------------------------- */
+
+typedef enum {
+    GPIO_Speed_10MHz = 1,
+    GPIO_Speed_2MHz,
+    GPIO_Speed_50MHz
+} GPIOSpeed_TypeDef;
+
+typedef enum {
+    GPIO_Mode_AIN = 0x0,
+    GPIO_Mode_IN_FLOATING = 0x04,
+    GPIO_Mode_IPD = 0x28,
+    GPIO_Mode_IPU = 0x48,
+    GPIO_Mode_Out_OD = 0x14,
+    GPIO_Mode_Out_PP = 0x10,
+    GPIO_Mode_AF_OD = 0x1C,
+    GPIO_Mode_AF_PP = 0x18
+} GPIOMode_TypeDef;
+
+typedef struct {
+    uint16_t GPIO_Pin;
+    GPIOSpeed_TypeDef GPIO_Speed;
+    GPIOMode_TypeDef GPIO_Mode;
+} GPIO_InitTypeDef;
+
+#define GPIO_Pin_0           ((uint16_t)0x0001)
+#define GPIO_Pin_1           ((uint16_t)0x0002)
+#define GPIO_Pin_2           ((uint16_t)0x0004)
+#define GPIO_Pin_3           ((uint16_t)0x0008)
+#define GPIO_Pin_4           ((uint16_t)0x0010)
+#define GPIO_Pin_5           ((uint16_t)0x0020)
+#define GPIO_Pin_6           ((uint16_t)0x0040)
+#define GPIO_Pin_7           ((uint16_t)0x0080)
+#define GPIO_Pin_8           ((uint16_t)0x0100)
+#define GPIO_Pin_9           ((uint16_t)0x0200)
+#define GPIO_Pin_10          ((uint16_t)0x0400)
+#define GPIO_Pin_11          ((uint16_t)0x0800)
+#define GPIO_Pin_12          ((uint16_t)0x1000)
+#define GPIO_Pin_13          ((uint16_t)0x2000)
+#define GPIO_Pin_14          ((uint16_t)0x4000)
+#define GPIO_Pin_15          ((uint16_t)0x8000)
+
+#define GPIO_FullRemap_TIM1  ((uint32_t)0x001600C0)
+
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct);
+void GPIO_SetBits(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void GPIO_ResetBits(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void GPIO_PinRemapConfig(uint32_t GPIO_Remap, FunctionalState NewState);
+
+/* ---------------------------- TIM ---------------------------- */
+
+typedef struct {
+    uint16_t TIM_Prescaler;
+    uint16_t TIM_CounterMode;
+    uint16_t TIM_Period;
+    uint16_t TIM_ClockDivision;
+    uint8_t TIM_RepetitionCounter;
+} TIM_TimeBaseInitTypeDef;
+
+typedef struct {
+    uint16_t TIM_OCMode;
+    uint16_t TIM_OutputState;
+    uint16_t TIM_OutputNState;
+    uint16_t TIM_Pulse;
+    uint16_t TIM_OCPolarity;
+    uint16_t TIM_OCNPolarity;
+    uint16_t TIM_OCIdleState;
+    uint16_t TIM_OCNIdleState;
+} TIM_OCInitTypeDef;
+
+#define TIM_CKD_DIV1              ((uint16_t)0x0000)
+#define TIM_CounterMode_Up        ((uint16_t)0x0000)
+#define TIM_OCMode_PWM1           ((uint16_t)0x0060)
+#define TIM_OutputState_Enable    ((uint16_t)0x0001)
+#define TIM_OCPolarity_High       ((uint16_t)0x0000)
+#define TIM_OCPreload_Enable      ((uint16_t)0x0008)
+#define TIM_IT_Update             ((uint16_t)0x0001)
+#define TIM_PSCReloadMode_Update  ((uint16_t)0x0000)
+#define TIM_CR1_UDIS              ((uint16_t)0x0002)
+
+void TIM_TimeBaseInit(TIM_TypeDef *TIMx, TIM_TimeBaseInitTypeDef *TIM_TimeBaseInitStruct);
+void TIM_OCStructInit(TIM_OCInitTypeDef *TIM_OCInitStruct);
+void TIM_OC1Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct);
+void TIM_OC2Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct);
+void TIM_OC3Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct);
+void TIM_OC4Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct);
+void TIM_OC1PreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreload);
+void TIM_OC2PreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreload);
+void TIM_OC3PreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreload);
+void TIM_OC4PreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreload);
+void TIM_ARRPreloadConfig(TIM_TypeDef *TIMx, FunctionalState NewState);
+void TIM_Cmd(TIM_TypeDef *TIMx, FunctionalState NewState);
+void TIM_CtrlPWMOutputs(TIM_TypeDef *TIMx, FunctionalState NewState);
+void TIM_ITConfig(TIM_TypeDef *TIMx, uint16_t TIM_IT, FunctionalState NewState);
+void TIM_UpdateDisableConfig(TIM_TypeDef *TIMx, FunctionalState NewState);
+void TIM_PrescalerConfig(TIM_TypeDef *TIMx, uint16_t Prescaler, uint16_t TIM_PSCReloadMode);
+void TIM_SetAutoreload(TIM_TypeDef *TIMx, uint16_t Autoreload);
+void TIM_SetCompare1(TIM_TypeDef *TIMx, uint16_t Compare1);
+void TIM_SetCompare2(TIM_TypeDef *TIMx, uint16_t Compare2);
+void TIM_SetCompare3(TIM_TypeDef *TIMx, uint16_t Compare3);
+void TIM_SetCompare4(TIM_TypeDef *TIMx, uint16_t Compare4);
+ITStatus TIM_GetITStatus(TIM_TypeDef *TIMx, uint16_t TIM_IT);
+void TIM_ClearITPendingBit(TIM_TypeDef *TIMx, uint16_t TIM_IT);
+
+/* ---------------------------- DMA ---------------------------- */
+
+typedef struct {
+    uint32_t DMA_PeripheralBaseAddr;
+    uint32_t DMA_MemoryBaseAddr;
+    uint32_t DMA_DIR;
+    uint32_t DMA_BufferSize;
+    uint32_t DMA_PeripheralInc;
+    uint32_t DMA_MemoryInc;
+    uint32_t DMA_PeripheralDataSize;
+    uint32_t DMA_MemoryDataSize;
+    uint32_t DMA_Mode;
+    uint32_t DMA_Priority;
+    uint32_t DMA_M2M;
+} DMA_InitTypeDef;
+
+#define DMA_CCR1_EN                      ((uint16_t)0x0001)
+#define DMA_DIR_PeripheralSRC            ((uint32_t)0x00000000)
+#define DMA_PeripheralInc_Disable        ((uint32_t)0x00000000)
+#define DMA_MemoryInc_Enable             ((uint32_t)0x00000080)
+#define DMA_PeripheralDataSize_Byte      ((uint32_t)0x00000000)
+#define DMA_PeripheralDataSize_HalfWord  ((uint32_t)0x00000100)
+#define DMA_MemoryDataSize_Byte          ((uint32_t)0x00000000)
+#define DMA_MemoryDataSize_HalfWord      ((uint32_t)0x00000400)
+#define DMA_Mode_Circular                ((uint32_t)0x00000020)
+#define DMA_Priority_Medium              ((uint32_t)0x00001000)
+#define DMA_Priority_High                ((uint32_t)0x00002000)
+#define DMA_M2M_Disable                  ((uint32_t)0x00000000)
+#define DMA_IT_TC                        ((uint32_t)0x00000002)
+#define DMA_IT_HT                        ((uint32_t)0x00000004)
+#define DMA1_IT_GL1                      ((uint32_t)0x00000001)
+#define DMA1_IT_TC1                      ((uint32_t)0x00000002)
+#define DMA1_IT_HT1                      ((uint32_t)0x00000004)
+#define DMA1_FLAG_TC1                    ((uint32_t)0x00000002)
+#define DMA1_IT_GL5                      ((uint32_t)0x00010000)
+#define DMA1_IT_TC5                      ((uint32_t)0x00020000)
+#define DMA1_IT_HT5                      ((uint32_t)0x00040000)
+
+void DMA_DeInit(DMA_Channel_TypeDef *DMAy_Channelx);
+void DMA_Init(DMA_Channel_TypeDef *DMAy_Channelx, DMA_InitTypeDef *DMA_InitStruct);
+void DMA_Cmd(DMA_Channel_TypeDef *DMAy_Channelx, FunctionalState NewState);
+void DMA_ITConfig(DMA_Channel_TypeDef *DMAy_Channelx, uint32_t DMA_IT, FunctionalState NewState);
+FlagStatus DMA_GetFlagStatus(uint32_t DMAy_FLAG);
+void DMA_ClearFlag(uint32_t DMAy_FLAG);
+ITStatus DMA_GetITStatus(uint32_t DMAy_IT);
+void DMA_ClearITPendingBit(uint32_t DMAy_IT);
+
+/* ---------------------------- ADC ---------------------------- */
+
+typedef struct {
+    uint32_t ADC_Mode;
+    FunctionalState ADC_ScanConvMode;
+    FunctionalState ADC_ContinuousConvMode;
+    uint32_t ADC_ExternalTrigConv;
+    uint32_t ADC_DataAlign;
+    uint8_t ADC_NbrOfChannel;
+} ADC_InitTypeDef;
+
+#define ADC_Mode_Independent         ((uint32_t)0x00000000)
+#define ADC_ExternalTrigConv_None    ((uint32_t)0x000E0000)
+#define ADC_DataAlign_Right          ((uint32_t)0x00000000)
+#define ADC_Channel_3                ((uint8_t)0x03)
+#define ADC_Channel_12               ((uint8_t)0x0C)
+#define ADC_Channel_13               ((uint8_t)0x0D)
+#define ADC_SampleTime_55Cycles5     ((uint8_t)0x05)
+
+void ADC_DeInit(ADC_TypeDef *ADCx);
+void ADC_Init(ADC_TypeDef *ADCx, ADC_InitTypeDef *ADC_InitStruct);
+void ADC_RegularChannelConfig(ADC_TypeDef *ADCx, uint8_t ADC_Channel, uint8_t Rank, uint8_t ADC_SampleTime);
+void ADC_DMACmd(ADC_TypeDef *ADCx, FunctionalState NewState);
+void ADC_Cmd(ADC_TypeDef *ADCx, FunctionalState NewState);
+void ADC_ResetCalibration(ADC_TypeDef *ADCx);
+FlagStatus ADC_GetResetCalibrationStatus(ADC_TypeDef *ADCx);
+void ADC_StartCalibration(ADC_TypeDef *ADCx);
+FlagStatus ADC_GetCalibrationStatus(ADC_TypeDef *ADCx);
+void ADC_SoftwareStartConvCmd(ADC_TypeDef *ADCx, FunctionalState NewState);
+
+/* ---------------------------- USART ---------------------------- */
+
+typedef struct {
+    uint32_t USART_BaudRate;
+    uint16_t USART_WordLength;
+    uint16_t USART_StopBits;
+    uint16_t USART_Parity;
+    uint16_t USART_Mode;
+    uint16_t USART_HardwareFlowControl;
+} USART_InitTypeDef;
+
+#define USART_WordLength_8b              ((uint16_t)0x0000)
+#define USART_StopBits_1                 ((uint16_t)0x0000)
+#define USART_Parity_No                  ((uint16_t)0x0000)
+#define USART_Mode_Rx                    ((uint16_t)0x0004)
+#define USART_Mode_Tx                    ((uint16_t)0x0008)
+#define USART_HardwareFlowControl_None   ((uint16_t)0x0000)
+#define USART_IT_IDLE                    ((uint16_t)0x0424)
+#define USART_DMAReq_Rx                  ((uint16_t)0x0040)
+#define USART_FLAG_IDLE                  ((uint16_t)0x0010)
+#define USART_FLAG_TC                    ((uint16_t)0x0040)
+
+void USART_Init(USART_TypeDef *USARTx, USART_InitTypeDef *USART_InitStruct);
+void USART_Cmd(USART_TypeDef *USARTx, FunctionalState NewState);
+void USART_ITConfig(USART_TypeDef *USARTx, uint16_t USART_IT, FunctionalState NewState);
+void USART_DMACmd(USART_TypeDef *USARTx, uint16_t USART_DMAReq, FunctionalState NewState);
+ITStatus USART_GetITStatus(USART_TypeDef *USARTx, uint16_t USART_IT);
+
+/* ---------------------------- NVIC ---------------------------- */
+
+typedef struct {
+    uint8_t NVIC_IRQChannel;
+    uint8_t NVIC_IRQChannelPreemptionPriority;
+    uint8_t NVIC_IRQChannelSubPriority;
+    FunctionalState NVIC_IRQChannelCmd;
+} NVIC_InitTypeDef;
+
+void NVIC_Init(NVIC_InitTypeDef *NVIC_InitStruct);
+
+/* 测试单线程运行，中断开关为空操作 */
+#define __disable_irq()   ((void)0)
+#define __enable_irq()    ((void)0)
+#define __get_PRIMASK()   (0U)
+
+#endif /* __STM32F10x_H */
@@ -0,0 +1,332 @@
+/**
+  ******************************************************************************
+  * @file    hw_fake.c
+  * @brief   标准外设库的主机替身(硬件模块测试用)
+  ******************************************************************************
+  * 只实现被测驱动调用到的库函数：寄存器块是普通变量，函数按库的语义改写
+  * 对应寄存器，并在g_hw中累计比较值和GPIO的写入次数，供测试核对驱动的
+  * 寄存器缓存；写入值不改变寄存器的调用另计为冗余写入。
+  * 初始化类函数(GPIO_Init、NVIC_Init等)不记录。
+  ******************************************************************************
+  */
+
+#include "hw_fake.h"
+#include <string.h>
+
+GPIO_TypeDef HW_GPIOA, HW_GPIOB, HW_GPIOC, HW_GPIOD, HW_GPIOE;
+TIM_TypeDef HW_TIM1, HW_TIM2, HW_TIM8;
+ADC_TypeDef HW_ADC1;
+DMA_Channel_TypeDef HW_DMA1_Channel1, HW_DMA1_Channel5;
+USART_TypeDef HW_USART1;
+HwFake_TypeDef g_hw;
+
+/**
+  * @brief  清空外设寄存器和计数，设置时钟树
+  * @param  sysclk: 系统时钟(Hz)，AHB不分频
+  * @param  apb1_div: APB1分频系数(1/2/4/8/16)
+  * @param  apb2_div: APB2分频系数(1/2/4/8/16)
+  * @retval 无
+  */
+void HW_FAKE_Reset(uint32_t sysclk, uint8_t apb1_div, uint8_t apb2_div)
+{
+    memset(&HW_GPIOA, 0, sizeof(GPIO_TypeDef));
+    memset(&HW_GPIOB, 0, sizeof(GPIO_TypeDef));
+    memset(&HW_GPIOC, 0, sizeof(GPIO_TypeDef));
+    memset(&HW_GPIOD, 0, sizeof(GPIO_TypeDef));
+    memset(&HW_GPIOE, 0, sizeof(GPIO_TypeDef));
+    memset(&HW_TIM1, 0, sizeof(TIM_TypeDef));
+    memset(&HW_TIM2, 0, sizeof(TIM_TypeDef));
+    memset(&HW_TIM8, 0, sizeof(TIM_TypeDef));
+    memset(&HW_ADC1, 0, sizeof(ADC_TypeDef));
+    memset(&HW_DMA1_Channel1, 0, sizeof(DMA_Channel_TypeDef));
+    memset(&HW_DMA1_Channel5, 0, sizeof(DMA_Channel_TypeDef));
+    memset(&HW_USART1, 0, sizeof(USART_TypeDef));
+    memset(&g_hw, 0, sizeof(g_hw));
+
+    g_hw.clocks.SYSCLK_Frequency = sysclk;
+    g_hw.clocks.HCLK_Frequency = sysclk;
+    g_hw.clocks.PCLK1_Frequency = sysclk / apb1_div;
+    g_hw.clocks.PCLK2_Frequency = sysclk / apb2_div;
+    g_hw.clocks.ADCCLK_Frequency = sysclk / apb2_div / 6;
+}
+
+/* ---------------------------- RCC ---------------------------- */
+
+void RCC_GetClocksFreq(RCC_ClocksTypeDef *RCC_Clocks)
+{
+    *RCC_Clocks = g_hw.clocks;
+}
+
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState)
+{
+}
+
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState)
+{
+}
+
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState)
+{
+}
+
+void RCC_ADCCLKConfig(uint32_t RCC_PCLK2)
+{
+}
+
+/* ---------------------------- GPIO ---------------------------- */
+
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct)
+{
+}
+
+void GPIO_SetBits(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    if((GPIOx->ODR & GPIO_Pin) == GPIO_Pin) g_hw.gpio_same++;
+    GPIOx->ODR |= GPIO_Pin;
+    g_hw.gpio_writes++;
+}
+
+void GPIO_ResetBits(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    if((GPIOx->ODR & GPIO_Pin) == 0) g_hw.gpio_same++;
+    GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    g_hw.gpio_writes++;
+}
+
+void GPIO_PinRemapConfig(uint32_t GPIO_Remap, FunctionalState NewState)
+{
+}
+
+/* ---------------------------- TIM ---------------------------- */
+
+void TIM_TimeBaseInit(TIM_TypeDef *TIMx, TIM_TimeBaseInitTypeDef *TIM_TimeBaseInitStruct)
+{
+    TIMx->PSC = TIM_TimeBaseInitStruct->TIM_Prescaler;
+    TIMx->ARR = TIM_TimeBaseInitStruct->TIM_Period;
+}
+
+void TIM_OCStructInit(TIM_OCInitTypeDef *TIM_OCInitStruct)
+{
+    memset(TIM_OCInitStruct, 0, sizeof(TIM_OCInitTypeDef));
+}
+
+void TIM_OC1Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct) { TIMx->CCR1 = TIM_OCInitStruct->TIM_Pulse; }
+void TIM_OC2Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct) { TIMx->CCR2 = TIM_OCInitStruct->TIM_Pulse; }
+void TIM_OC3Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct) { TIMx->CCR3 = TIM_OCInitStruct->TIM_Pulse; }
+void TIM_OC4Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct) { TIMx->CCR4 = TIM_OCInitStruct->TIM_Pulse; }
+void TIM_OC1PreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreload) { }
+void TIM_OC2PreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreload) { }
+void TIM_OC3PreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreload) { }
+void TIM_OC4PreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreload) { }
+
+void TIM_ARRPreloadConfig(TIM_TypeDef *TIMx, FunctionalState NewState)
+{
+}
+
+void TIM_Cmd(TIM_TypeDef *TIMx, FunctionalState NewState)
+{
+    if(NewState != DISABLE) TIMx->CR1 |= 0x0001;
+    else TIMx->CR1 &= (uint16_t)~0x0001;
+}
+
+void TIM_CtrlPWMOutputs(TIM_TypeDef *TIMx, FunctionalState NewState)
+{
+    if(NewState != DISABLE) TIMx->BDTR |= 0x8000;
+    else TIMx->BDTR &= (uint16_t)~0x8000;
+}
+
+void TIM_ITConfig(TIM_TypeDef *TIMx, uint16_t TIM_IT, FunctionalState NewState)
+{
+    if(NewState != DISABLE) TIMx->DIER |= TIM_IT;
+    else TIMx->DIER &= (uint16_t)~TIM_IT;
+}
+
+void TIM_UpdateDisableConfig(TIM_TypeDef *TIMx, FunctionalState NewState)
+{
+    if(NewState != DISABLE) {
+        TIMx->CR1 |= TIM_CR1_UDIS;
+        g_hw.udis_sets++;
+    } else {
+        TIMx->CR1 &= (uint16_t)~TIM_CR1_UDIS;
+    }
+}
+
+void TIM_PrescalerConfig(TIM_TypeDef *TIMx, uint16_t Prescaler, uint16_t TIM_PSCReloadMode)
+{
+    TIMx->PSC = Prescaler;
+}
+
+void TIM_SetAutoreload(TIM_TypeDef *TIMx, uint16_t Autoreload)
+{
+    TIMx->ARR = Autoreload;
+}
+
+/* 比较值写入计数 */
+static void HW_FAKE_WriteCompare(volatile uint16_t *ccr, uint16_t value)
+{
+    if(*ccr == value) g_hw.ccr_same++;
+    *ccr = value;
+    g_hw.ccr_writes++;
+}
+
+void TIM_SetCompare1(TIM_TypeDef *TIMx, uint16_t Compare1) { HW_FAKE_WriteCompare(&TIMx->CCR1, Compare1); }
+void TIM_SetCompare2(TIM_TypeDef *TIMx, uint16_t Compare2) { HW_FAKE_WriteCompare(&TIMx->CCR2, Compare2); }
+void TIM_SetCompare3(TIM_TypeDef *TIMx, uint16_t Compare3) { HW_FAKE_WriteCompare(&TIMx->CCR3, Compare3); }
+void TIM_SetCompare4(TIM_TypeDef *TIMx, uint16_t Compare4) { HW_FAKE_WriteCompare(&TIMx->CCR4, Compare4); }
+
+ITStatus TIM_GetITStatus(TIM_TypeDef *TIMx, uint16_t TIM_IT)
+{
+    return ((TIMx->SR & TIM_IT) && (TIMx->DIER & TIM_IT)) ? SET : RESET;
+}
+
+void TIM_ClearITPendingBit(TIM_TypeDef *TIMx, uint16_t TIM_IT)
+{
+    TIMx->SR &= (uint16_t)~TIM_IT;
+}
+
+/* ---------------------------- DMA ---------------------------- */
+
+void DMA_DeInit(DMA_Channel_TypeDef *DMAy_Channelx)
+{
+    memset(DMAy_Channelx, 0, sizeof(DMA_Channel_TypeDef));
+}
+
+void DMA_Init(DMA_Channel_TypeDef *DMAy_Channelx, DMA_InitTypeDef *DMA_InitStruct)
+{
+    DMAy_Channelx->CNDTR = DMA_InitStruct->DMA_BufferSize;
+    DMAy_Channelx->CPAR = DMA_InitStruct->DMA_PeripheralBaseAddr;
+    DMAy_Channelx->CMAR = DMA_InitStruct->DMA_MemoryBaseAddr;
+}
+
+void DMA_Cmd(DMA_Channel_TypeDef *DMAy_Channelx, FunctionalState NewState)
+{
+    if(NewState != DISABLE) DMAy_Channelx->CCR |= DMA_CCR1_EN;
+    else DMAy_Channelx->CCR &= ~(uint32_t)DMA_CCR1_EN;
+}
+
+void DMA_ITConfig(DMA_Channel_TypeDef *DMAy_Channelx, uint32_t DMA_IT, FunctionalState NewState)
+{
+    if(NewState != DISABLE) DMAy_Channelx->CCR |= DMA_IT;
+    else DMAy_Channelx->CCR &= ~DMA_IT;
+}
+
+/* DMA标志由测试通过g_hw.dma_flags置位 */
+FlagStatus DMA_GetFlagStatus(uint32_t DMAy_FLAG)
+{
+    return (g_hw.dma_flags & DMAy_FLAG) ? SET : RESET;
+}
+
+void DMA_ClearFlag(uint32_t DMAy_FLAG)
+{
+    g_hw.dma_flags &= ~DMAy_FLAG;
+}
+
+ITStatus DMA_GetITStatus(uint32_t DMAy_IT)
+{
+    return (g_hw.dma_flags & DMAy_IT) ? SET : RESET;
+}
+
+void DMA_ClearITPendingBit(uint32_t DMAy_IT)
+{
+    g_hw.dma_flags &= ~DMAy_IT;
+}
+
+/* ---------------------------- ADC ---------------------------- */
+
+void ADC_DeInit(ADC_TypeDef *ADCx)
+{
+    memset(ADCx, 0, sizeof(ADC_TypeDef));
+}
+
+void ADC_Init(ADC_TypeDef *ADCx, ADC_InitTypeDef *ADC_InitStruct)
+{
+}
+
+void ADC_RegularChannelConfig(ADC_TypeDef *ADCx, uint8_t ADC_Channel, uint8_t Rank, uint8_t ADC_SampleTime)
+{
+}
+
+void ADC_DMACmd(ADC_TypeDef *ADCx, FunctionalState NewState)
+{
+}
+
+void ADC_Cmd(ADC_TypeDef *ADCx, FunctionalState NewState)
+{
+}
+
+/* 校准立即完成 */
+void ADC_ResetCalibration(ADC_TypeDef *ADCx)
+{
+}
+
+FlagStatus ADC_GetResetCalibrationStatus(ADC_TypeDef *ADCx)
+{
+    return RESET;
+}
+
+void ADC_StartCalibration(ADC_TypeDef *ADCx)
+{
+}
+
+FlagStatus ADC_GetCalibrationStatus(ADC_TypeDef *ADCx)
+{
+    return RESET;
+}
+
+void ADC_SoftwareStartConvCmd(ADC_TypeDef *ADCx, FunctionalState NewState)
+{
+}
+
+/* ---------------------------- USART ---------------------------- */
+
+void USART_Init(USART_TypeDef *USARTx, USART_InitTypeDef *USART_InitStruct)
+{
+    USARTx->CR1 = (USARTx->CR1 & (uint16_t)~0x000C) | USART_InitStruct->USART_Mode;
+    USARTx->BRR = (uint16_t)(g_hw.clocks.PCLK2_Frequency / USART_InitStruct->USART_BaudRate);
+}
+
+void USART_Cmd(USART_TypeDef *USARTx, FunctionalState NewState)
+{
+    if(NewState != DISABLE) USARTx->CR1 |= 0x2000;
+    else USARTx->CR1 &= (uint16_t)~0x2000;
+}
+
+/* 中断号编码同外设库：bit7~5寄存器(1:CR1 2:CR2 3:CR3)，bit4~0使能位，bit15~8状态位 */
+void USART_ITConfig(USART_TypeDef *USARTx, uint16_t USART_IT, FunctionalState NewState)
+{
+    volatile uint16_t *cr = (((USART_IT >> 5) & 0x07) == 1) ? &USARTx->CR1 :
+                            (((USART_IT >> 5) & 0x07) == 2) ? &USARTx->CR2 : &USARTx->CR3;
+    uint16_t mask = (uint16_t)(1U << (USART_IT & 0x1F));
+
+    if(NewState != DISABLE) *cr |= mask;
+    else *cr &= (uint16_t)~mask;
+}
+
+void USART_DMACmd(USART_TypeDef *USARTx, uint16_t USART_DMAReq, FunctionalState NewState)
+{
+    if(NewState != DISABLE) USARTx->CR3 |= USART_DMAReq;
+    else USARTx->CR3 &= (uint16_t)~USART_DMAReq;
+}
+
+/* 状态位(SR)由测试置位 */
+ITStatus USART_GetITStatus(USART_TypeDef *USARTx, uint16_t USART_IT)
+{
+    volatile uint16_t *cr = (((USART_IT >> 5) & 0x07) == 1) ? &USARTx->CR1 :
+                            (((USART_IT >> 5) & 0x07) == 2) ? &USARTx->CR2 : &USARTx->CR3;
+
+    return ((*cr & (1U << (USART_IT & 0x1F))) && (USARTx->SR & (1U << (USART_IT >> 8)))) ? SET : RESET;
+}
+
+/* ---------------------------- 时基 ---------------------------- */
+
+/* DWT周期计数不可用，时间由测试通过g_hw.micros推进 */
+uint64_t TIMEBASE_GetMicros(void)
+{
+    return g_hw.micros;
+}
+
+/* ---------------------------- NVIC ---------------------------- */
+
+void NVIC_Init(NVIC_InitTypeDef *NVIC_InitStruct)
+{
+}
@@ -0,0 +1,31 @@
+/**
+  ******************************************************************************
+  * @file    hw_fake.h
+  * @brief   标准外设库的主机替身(硬件模块测试用)
+  ******************************************************************************
+  * 另外提供依赖DWT的TIMEBASE_GetMicros，时间由测试设置。
+  ******************************************************************************
+  */
+
+#ifndef __HW_FAKE_H
+#define __HW_FAKE_H
+
+#include "stm32f10x.h"
+
+/* 替身状态：时钟由测试设置，寄存器写入由外设库函数累计 */
+typedef struct {
+    RCC_ClocksTypeDef clocks;    // RCC_GetClocksFreq返回的时钟
+    uint32_t ccr_writes;         // TIM_SetCompareN调用次数
+    uint32_t ccr_same;           // 其中写入值与寄存器原值相同的次数
+    uint32_t gpio_writes;        // GPIO_SetBits/GPIO_ResetBits调用次数
+    uint32_t gpio_same;          // 其中不改变输出电平的次数
+    uint32_t udis_sets;          // TIM_UpdateDisableConfig(ENABLE)调用次数
+    uint32_t dma_flags;          // DMA1的中断/标志位(DMA1_IT_x/DMA1_FLAG_x)，由测试置位
+    uint64_t micros;             // TIMEBASE_GetMicros的返回值
+} HwFake_TypeDef;
+
+extern HwFake_TypeDef g_hw;
+
+void HW_FAKE_Reset(uint32_t sysclk, uint8_t apb1_div, uint8_t apb2_div); // 清空外设和计数，设置时钟树
+
+#endif /* __HW_FAKE_H */
@@ -0,0 +1,166 @@
+/**
+  ******************************************************************************
+  * @file    osr_enob.c
+  * @brief   过采样有效位数测量(主机程序)
+  ******************************************************************************
+  * 向ANGLE_SENSOR_OsrPush(或-f时ANGLE_SENSOR_FrontEnd)送入合成的ADC数据流，
+  * 按固件的方式由窗口和求16位抽取码，统计各过采样率下的有效位数：
+  *   - 每个窗口的真值在有效ADC范围内均匀随机，样本 = round(真值 + 高斯噪声)，
+  *     按DMA缓冲的扫描顺序与其他通道交错(间隔ENOB_CHANNELS)；
+  *   - 误差 = 抽取码/16 - 真值(12位LSB)，扣除平均偏差(截断造成)后取均方根，
+  *     ENOB = 12 - log2(误差均方根 * sqrt(12))；
+  *   - 理论值 = (噪声σ² + ADC量化误差1/12)/OSR + 抽取码量化误差，噪声不小于约0.5LSB
+  *     时ADC量化误差才近似白噪声，更小的噪声下实测会低于理论值。
+  * 噪声1LSB时OSR=1约10.1位，OSR=256约14.1位，每4倍过采样约增加1位。
+  * 各过采样率的结果与理论值相差超过ENOB_TOLERANCE时返回1。
+  *
+  * 编译(在仓库根目录)：
+  *   gcc -std=gnu99 -O2 -Wall -Wno-unused-parameter -Wno-pointer-to-int-cast -DPARAM_STORE_HOST \
+  *       -ITools/hwtest/host -ITools/hwtest -IHardware/angle_sensor -IHardware/param_store -ISYSTEM/timebase \
+  *       Tools/hwtest/osr_enob.c Tools/hwtest/hw_fake.c Hardware/angle_sensor/angle_sensor.c \
+  *       Hardware/param_store/param_store.c -lm -o osr_enob
+  *
+  * 用法：
+  *   osr_enob [-n 噪声σ(LSB)] [-w 每个过采样率的窗口数] [-s 种子] [-f]
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "angle_sensor.h"
+
+#define ENOB_ADC_LOW         820.0     // 真值范围下限(与angle_sensor.c的ADC_MIN一致)
+#define ENOB_ADC_HIGH        4020.0    // 真值范围上限(ADC_MAX)
+#define ENOB_CHANNELS        3         // 扫描通道数，样本在缓冲中的间隔
+#define ENOB_LOG2_MAX        8         // 最大过采样率 2^8
+#define ENOB_TOLERANCE       0.15      // 与理论值的允许偏差(位)
+
+static uint16_t enob_buffer[(1U << ENOB_LOG2_MAX) * ENOB_CHANNELS];
+
+/**
+  * @brief  标准正态随机数(Box-Muller)
+  * @param  无
+  * @retval double: N(0,1)样本
+  */
+static double ENOB_Gauss(void)
+{
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/**
+  * @brief  一个过采样率下的有效位数
+  * @param  osr_log2: 过采样率的log2
+  * @param  noise: 噪声σ(LSB)
+  * @param  windows: 窗口数
+  * @param  front_end: 1: 经野值剔除前端送入
+  * @param  offset: 输出平均偏差(LSB)
+  * @retval double: 有效位数
+  */
+static double ENOB_Measure(uint8_t osr_log2, double noise, uint32_t windows, uint8_t front_end, double *offset)
+{
+    AngleOsr_TypeDef osr;
+    uint16_t count = (uint16_t)(1U << osr_log2);
+    double sum_err = 0.0;
+    double sum_err2 = 0.0;
+    double truth, x, err, mean;
+    uint32_t done;
+    uint16_t code;
+    uint16_t i;
+    uint8_t c;
+
+    memset(&osr, 0, sizeof(osr));
+
+    for (done = 0; done < windows; done++) {
+        truth = ENOB_ADC_LOW + (ENOB_ADC_HIGH - ENOB_ADC_LOW) * rand() / (double)RAND_MAX;
+        for (i = 0; i < count; i++) {
+            x = floor(truth + noise * ENOB_Gauss() + 0.5);
+            if (x < 0.0) x = 0.0;
+            if (x > 4095.0) x = 4095.0;
+            enob_buffer[i * ENOB_CHANNELS] = (uint16_t)x;
+            for (c = 1; c < ENOB_CHANNELS; c++) {
+                enob_buffer[i * ENOB_CHANNELS + c] = (uint16_t)(rand() & 0x0FFF);
+            }
+        }
+
+        if (front_end) {
+            ANGLE_SENSOR_FrontEnd(&osr, osr_log2, enob_buffer, count, ENOB_CHANNELS);
+        } else {
+            ANGLE_SENSOR_OsrPush(&osr, osr_log2, enob_buffer, count, ENOB_CHANNELS);
+        }
+        if (osr.windows != done + 1) {
+            printf("OSR %u: window %u not completed\n", count, done);
+            exit(1);
+        }
+
+        /* 与ANGLE_SENSOR_ReadDecimated相同的抽取 */
+        code = (uint16_t)((osr.sum << 4) >> osr.sum_log2);
+        err = code / 16.0 - truth;
+        sum_err += err;
+        sum_err2 += err * err;
+    }
+
+    mean = sum_err / windows;
+    *offset = mean;
+    return 12.0 - log2(sqrt(sum_err2 / windows - mean * mean) * sqrt(12.0));
+}
+
+int main(int argc, char *argv[])
+{
+    double noise = 1.0;
+    uint32_t windows = 20000;
+    unsigned int seed = 1;
+    uint8_t front_end = 0;
+    uint8_t osr_log2;
+    uint8_t first;
+    double enob = 0.0, theory, q, offset, base = 0.0;
+    int failures = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:w:s:f")) != -1) {
+        switch (opt) {
+        case 'n': noise = atof(optarg); break;
+        case 'w': windows = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': seed = (unsigned int)strtoul(optarg, NULL, 0); break;
+        case 'f': front_end = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-n noise_lsb] [-w windows] [-s seed] [-f]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (windows == 0 || noise < 0.0) {
+        fprintf(stderr, "windows must be > 0 and noise >= 0\n");
+        return 2;
+    }
+    srand(seed);
+
+    /* 前端按ANGLE_SENSOR_ROBUST_N个样本一组处理，窗口不能小于一组 */
+    first = 0;
+    if (front_end) {
+        while ((1U << first) < ANGLE_SENSOR_ROBUST_N) first++;
+    }
+
+    printf("noise %.2f LSB, %u windows per OSR, %s\n", noise, windows,
+           front_end ? "Hampel front end" : "direct accumulation");
+    printf("  OSR   ENOB  theory  offset(LSB)\n");
+    for (osr_log2 = first; osr_log2 <= ENOB_LOG2_MAX; osr_log2++) {
+        enob = ENOB_Measure(osr_log2, noise, windows, front_end, &offset);
+
+        /* 抽取码的量化间隔：OSR<16时低位补零 */
+        q = 1.0 / (1U << (osr_log2 < 4 ? osr_log2 : 4));
+        theory = 12.0 - log2(sqrt((noise * noise + 1.0 / 12.0) / (1U << osr_log2) + q * q / 12.0) * sqrt(12.0));
+        if (osr_log2 == first) base = enob;
+
+        printf("%5u  %5.2f  %6.2f  %+8.4f%s\n", 1U << osr_log2, enob, theory, offset,
+               fabs(enob - theory) > ENOB_TOLERANCE ? "  <- off" : "");
+        if (fabs(enob - theory) > ENOB_TOLERANCE) failures++;
+    }
+    printf("gain %.2f bits from OSR %u to %u\n", enob - base, 1U << first, 1U << ENOB_LOG2_MAX);
+
+    return failures ? 1 : 0;
+}
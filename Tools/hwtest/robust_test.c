@@ -0,0 +1,297 @@
+/**
+  ******************************************************************************
+  * @file    robust_test.c
+  * @brief   角度传感器鲁棒前端测试(主机程序)
+  ******************************************************************************
+  * 检查angle_sensor.c的野值剔除：
+  *   - 19比较器排序网络ANGLE_SENSOR_Sort8对全部256种0/1输入排序正确
+  *     (0-1原理：比较交换网络排好所有0/1序列即排好任意序列)，另抽查随机序列；
+  *   - ANGLE_SENSOR_Hampel的判据边界(恰好等于门限不替换)、台阶不被削平，
+  *     每组注入1-3个毛刺时毛刺全部替换为中值、正常样本最多误替换一个，
+  *     无毛刺时误替换率低于1e-4；
+  *   - ANGLE_SENSOR_FrontEnd把替换数计入窗口，超过窗口的1/8时报噪声故障；
+  *   - 量程故障门限由线性化表±90度位置外加余量求出，校准(含反向安装)后随表移动。
+  * Sort8为私有函数，本文件直接包含angle_sensor.c编译。有失败项时返回1。
+  *
+  * 编译运行(在仓库根目录)：
+  *   gcc -std=gnu99 -O2 -Wall -Wno-unused-parameter -Wno-pointer-to-int-cast -DPARAM_STORE_HOST \
+  *       -ITools/hwtest/host -ITools/hwtest -IHardware/angle_sensor -IHardware/param_store -ISYSTEM/timebase \
+  *       Tools/hwtest/robust_test.c Tools/hwtest/hw_fake.c Hardware/param_store/param_store.c \
+  *       -lm -o robust_test && ./robust_test
+  ******************************************************************************
+  */
+
+#include "../../Hardware/angle_sensor/angle_sensor.c"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RANDOM_SORTS    100000    // 随机排序抽查次数
+#define TEST_SPIKE_BLOCKS    100000    // 每种毛刺数的随机组数
+#define TEST_CLEAN_BLOCKS    200000    // 无毛刺的随机组数
+#define TEST_NOISE           1.5       // 随机组的高斯噪声σ(LSB)
+#define TEST_SPIKE_MIN       40        // 毛刺最小幅度(LSB)
+
+static int test_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { test_failures++; printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } \
+} while (0)
+
+/**
+  * @brief  标准正态随机数(Box-Muller)
+  * @param  无
+  * @retval double: N(0,1)样本
+  */
+static double TEST_Gauss(void)
+{
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int TEST_IsSorted(const uint16_t *v)
+{
+    int i;
+
+    for (i = 1; i < ANGLE_SENSOR_ROBUST_N; i++) {
+        if (v[i - 1] > v[i]) return 0;
+    }
+    return 1;
+}
+
+static int TEST_CompareU16(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+static void TEST_SortNetwork(void)
+{
+    uint16_t v[ANGLE_SENSOR_ROBUST_N];
+    uint16_t ref[ANGLE_SENSOR_ROBUST_N];
+    unsigned int pattern;
+    unsigned int ones;
+    int i, n;
+
+    /* 全部0/1输入：排序后为(8-k)个0接k个1 */
+    for (pattern = 0; pattern < (1U << ANGLE_SENSOR_ROBUST_N); pattern++) {
+        ones = 0;
+        for (i = 0; i < ANGLE_SENSOR_ROBUST_N; i++) {
+            v[i] = (uint16_t)((pattern >> i) & 1U);
+            ones += v[i];
+        }
+        ANGLE_SENSOR_Sort8(v);
+        for (i = 0; i < ANGLE_SENSOR_ROBUST_N; i++) {
+            if (v[i] != (i >= (int)(ANGLE_SENSOR_ROBUST_N - ones) ? 1 : 0)) break;
+        }
+        CHECK(i == ANGLE_SENSOR_ROBUST_N, "0/1 pattern 0x%02X not sorted", pattern);
+    }
+
+    /* 随机序列(含重复值)与qsort比较 */
+    for (n = 0; n < TEST_RANDOM_SORTS; n++) {
+        for (i = 0; i < ANGLE_SENSOR_ROBUST_N; i++) {
+            v[i] = (uint16_t)(rand() % ((n & 1) ? 8 : 4096));
+            ref[i] = v[i];
+        }
+        ANGLE_SENSOR_Sort8(v);
+        qsort(ref, ANGLE_SENSOR_ROBUST_N, sizeof(ref[0]), TEST_CompareU16);
+        if (!TEST_IsSorted(v) || memcmp(v, ref, sizeof(v)) != 0) {
+            CHECK(0, "random sequence %d not sorted", n);
+            break;
+        }
+    }
+}
+
+/**
+  * @brief  检查一组固定样本的替换结果
+  * @param  in: 输入样本
+  * @param  replaced: 期望替换数
+  * @param  median: 期望中值
+  * @param  what: 说明
+  * @retval 无
+  */
+static void TEST_ExpectHampel(const uint16_t *in, uint8_t replaced, uint16_t median, const char *what)
+{
+    uint16_t block[ANGLE_SENSOR_ROBUST_N];
+    uint16_t med;
+    uint8_t n;
+    int i;
+
+    memcpy(block, in, sizeof(block));
+    n = ANGLE_SENSOR_Hampel(block, &med);
+    CHECK(n == replaced, "%s: %u replaced, expected %u", what, n, replaced);
+    CHECK(med == median, "%s: median %u, expected %u", what, med, median);
+    for (i = 0; i < ANGLE_SENSOR_ROBUST_N; i++) {
+        CHECK(block[i] == in[i] || block[i] == med, "%s: sample %d became %u", what, i, block[i]);
+    }
+}
+
+static void TEST_HampelCases(void)
+{
+    static const uint16_t flat[8] = {1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000};
+    static const uint16_t at_floor[8] = {1000, 1000, 1000, 1000 + ANGLE_SENSOR_HAMPEL_FLOOR, 1000, 1000, 1000, 1000};
+    static const uint16_t over_floor[8] = {1000, 1000, 1000, 1001 + ANGLE_SENSOR_HAMPEL_FLOOR, 1000, 1000, 1000, 1000};
+    static const uint16_t low_spike[8] = {1000, 1001, 999, 1000, 0, 1002, 998, 1000};
+    static const uint16_t three_spikes[8] = {4095, 2000, 2001, 4095, 1999, 2000, 0, 2002};
+    static const uint16_t step[8] = {1000, 1000, 1000, 1000, 1100, 1100, 1100, 1100};
+    static const uint16_t spread[8] = {1000, 1010, 1020, 1030, 1040, 1050, 1060, 1200};
+
+    TEST_ExpectHampel(flat, 0, 1000, "flat block");
+    TEST_ExpectHampel(at_floor, 0, 1000, "deviation equal to floor");
+    TEST_ExpectHampel(over_floor, 1, 1000, "deviation one above floor");
+    TEST_ExpectHampel(low_spike, 1, 1000, "low spike");
+    TEST_ExpectHampel(three_spikes, 3, 2001, "three spikes");
+    TEST_ExpectHampel(step, 0, 1050, "step inside block");
+
+    /* MAD=20，门限90：1200偏离中值165被替换，其余保留 */
+    TEST_ExpectHampel(spread, 1, 1035, "spread block");
+}
+
+static void TEST_HampelRandom(void)
+{
+    uint16_t block[ANGLE_SENSOR_ROBUST_N];
+    uint16_t clean[ANGLE_SENSOR_ROBUST_N];
+    uint8_t spike[ANGLE_SENSOR_ROBUST_N];
+    uint32_t wrong = 0;
+    uint32_t false_hits = 0;
+    uint16_t med;
+    double base, x;
+    int k, n, i, pos, amp;
+    uint8_t replaced;
+
+    for (k = 0; k <= 3; k++) {
+        wrong = 0;
+        for (n = 0; n < (k ? TEST_SPIKE_BLOCKS : TEST_CLEAN_BLOCKS); n++) {
+            base = 1000.0 + rand() % 2000;
+            memset(spike, 0, sizeof(spike));
+            for (i = 0; i < ANGLE_SENSOR_ROBUST_N; i++) {
+                x = floor(base + TEST_NOISE * TEST_Gauss() + 0.5);
+                clean[i] = (uint16_t)x;
+            }
+            memcpy(block, clean, sizeof(block));
+
+            /* 在不同位置注入k个毛刺，正负随机 */
+            for (i = 0; i < k; i++) {
+                do pos = rand() % ANGLE_SENSOR_ROBUST_N; while (spike[pos]);
+                spike[pos] = 1;
+                amp = TEST_SPIKE_MIN + rand() % 1000;
+                block[pos] = (uint16_t)((rand() & 1) ? clean[pos] + amp : clean[pos] - amp);
+            }
+
+            replaced = ANGLE_SENSOR_Hampel(block, &med);
+            if (k == 0) {
+                false_hits += replaced;
+                continue;
+            }
+
+            /* 每个毛刺都被替换为中值，正常样本不动(误替换另计) */
+            for (i = 0; i < ANGLE_SENSOR_ROBUST_N; i++) {
+                if (spike[i] && block[i] != med) break;
+                if (!spike[i] && block[i] != clean[i] && block[i] != med) break;
+            }
+            if (i < ANGLE_SENSOR_ROBUST_N || replaced < k || replaced > k + 1) wrong++;
+        }
+        if (k == 0) {
+            printf("no spikes: %u false replacements in %u samples\n", false_hits,
+                   TEST_CLEAN_BLOCKS * ANGLE_SENSOR_ROBUST_N);
+            CHECK(false_hits <= TEST_CLEAN_BLOCKS * ANGLE_SENSOR_ROBUST_N / 10000,
+                  "false replacement rate above 1e-4");
+        } else {
+            printf("%d spike(s) per block: %u of %u blocks wrong\n", k, wrong, TEST_SPIKE_BLOCKS);
+            CHECK(wrong == 0, "%d spike(s): %u blocks not cleaned", k, wrong);
+        }
+    }
+}
+
+static void TEST_FrontEndCounts(void)
+{
+    static uint16_t samples[64 * 2];
+    AngleOsr_TypeDef osr;
+    int spikes, i;
+
+    /* OSR=64：替换数超过64/8=8时报噪声故障 */
+    for (spikes = 7; spikes <= 10; spikes++) {
+        memset(&osr, 0, sizeof(osr));
+        osr.range_min = ADC_MIN;
+        osr.range_max = ADC_MAX;
+        for (i = 0; i < 64; i++) {
+            samples[i * 2] = 2000;
+            samples[i * 2 + 1] = 4095;   // 另一通道，不应被读到
+        }
+        for (i = 0; i < spikes; i++) {
+            samples[(i * 7 % 64) * 2] = 3500;
+        }
+        ANGLE_SENSOR_FrontEnd(&osr, 6, samples, 64, 2);
+        CHECK(osr.windows == 1, "%d spikes: window not completed", spikes);
+        CHECK(osr.sum == 64 * 2000, "%d spikes: window sum %u, spikes leaked", spikes, osr.sum);
+        CHECK(((osr.faults & ANGLE_SENSOR_FAULT_NOISY) != 0) == (spikes > 8),
+              "%d spikes: faults 0x%02X", spikes, osr.faults);
+        CHECK((osr.faults & ANGLE_SENSOR_FAULT_RANGE) == 0, "%d spikes: range fault", spikes);
+    }
+
+    /* 中值超量程的组计入量程故障 */
+    memset(&osr, 0, sizeof(osr));
+    osr.range_min = ADC_MIN;
+    osr.range_max = ADC_MAX;
+    for (i = 0; i < 64; i++) {
+        samples[i * 2] = (i < 8) ? 100 : 2000;
+    }
+    ANGLE_SENSOR_FrontEnd(&osr, 6, samples, 64, 2);
+    CHECK(osr.faults == ANGLE_SENSOR_FAULT_RANGE, "one group below range_min: faults 0x%02X", osr.faults);
+}
+
+static void TEST_RangeFromTable(void)
+{
+    static AngleSensor_TypeDef sensor;
+    static uint16_t samples[64];
+    int i;
+
+    /* 默认表：±90度在ADC_MIN/ADC_MAX */
+    ANGLE_SENSOR_ResetLinearization(&sensor);
+    CHECK(abs((int)sensor.osr.range_min - (ADC_MIN - RANGE_MARGIN)) <= 1 &&
+          abs((int)sensor.osr.range_max - (ADC_MAX + RANGE_MARGIN)) <= 1,
+          "default range %u..%u", sensor.osr.range_min, sensor.osr.range_max);
+
+    /* 反向安装的两点校准：1000->60度，3000->-60度，±90度在500/3500 */
+    ANGLE_SENSOR_CalBegin(&sensor);
+    sensor.cal_adc[0] = 1000.0f;
+    sensor.cal_angle[0] = 60.0f;
+    sensor.cal_adc[1] = 3000.0f;
+    sensor.cal_angle[1] = -60.0f;
+    sensor.cal_count = 2;
+    CHECK(ANGLE_SENSOR_CalFinish(&sensor) == ANGLE_SENSOR_OK, "reversed calibration rejected");
+    CHECK(abs((int)sensor.osr.range_min - (500 - RANGE_MARGIN)) <= 1 &&
+          abs((int)sensor.osr.range_max - (3500 + RANGE_MARGIN)) <= 1,
+          "reversed range %u..%u", sensor.osr.range_min, sensor.osr.range_max);
+
+    /* 旧的固定门限内、新门限外的读数报量程故障 */
+    for (i = 0; i < 64; i++) samples[i] = 3800;
+    ANGLE_SENSOR_FrontEnd(&sensor.osr, 6, samples, 64, 1);
+    CHECK(sensor.osr.faults == ANGLE_SENSOR_FAULT_RANGE, "3800 outside calibrated range: faults 0x%02X",
+          sensor.osr.faults);
+
+    /* 表达不到±90度(量程很窄的校准)时门限取到ADC满量程端 */
+    ANGLE_SENSOR_CalBegin(&sensor);
+    sensor.cal_adc[0] = 0.0f;
+    sensor.cal_angle[0] = -10.0f;
+    sensor.cal_adc[1] = 4000.0f;
+    sensor.cal_angle[1] = 10.0f;
+    sensor.cal_count = 2;
+    CHECK(ANGLE_SENSOR_CalFinish(&sensor) == ANGLE_SENSOR_OK, "narrow calibration rejected");
+    CHECK(sensor.osr.range_min == 0 && sensor.osr.range_max == 4095,
+          "narrow range %u..%u", sensor.osr.range_min, sensor.osr.range_max);
+}
+
+int main(void)
+{
+    srand(1);
+    TEST_SortNetwork();
+    TEST_HampelCases();
+    TEST_HampelRandom();
+    TEST_FrontEndCounts();
+    TEST_RangeFromTable();
+
+    printf("%s: %d failure(s)\n", test_failures ? "FAIL" : "OK", test_failures);
+    return test_failures ? 1 : 0;
+}
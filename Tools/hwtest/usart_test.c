@@ -0,0 +1,470 @@
+/**
+  ******************************************************************************
+  * @file    usart_test.c
+  * @brief   串口DMA环形接收测试(主机程序)
+  ******************************************************************************
+  * 测试代替DMA向USART_RX_RING写字节并改写DMA1_Channel5的剩余计数，写到半圈/
+  * 一圈时照硬件置位DMA1_IT_HT5/DMA1_IT_TC5并调用DMA中断，一段数据结束时置位
+  * 空闲标志调用USART1_IRQHandler，再由USART_RxService取出行和帧，检查：
+  *   - 完整的行、分几次到达的行、未处理完时不取下一行；
+  *   - 跨过环形缓冲末尾的行和帧，剩余计数读到0(重装前)时按位置0处理；
+  *   - 0x00分隔的帧、连续0x00、帧打断半行、超长帧丢弃；
+  *   - 最长USART_REC_LEN-1字节的行能收下，更长的行整行丢弃并计数；
+  *   - 未取出的数据恰好一圈不算溢出，多一个字节即溢出：保留较新的半圈，
+  *     从下一个行尾重新开始，之后的行完整且连续；
+  *   - 921600波特率连续上传：主循环周期短于一圈的接收时间(约22ms)时不丢行，
+  *     超过时报溢出。
+  * 环形缓冲和读写位置为私有变量，本文件直接包含usart.c编译；usart.c为Keil重定义的
+  * fputc/_sys_exit在包含前改名，以免替换C库的函数。有失败项时返回1。
+  *
+  * 编译运行(在仓库根目录)：
+  *   gcc -std=gnu99 -O2 -Wall -Wno-unused-parameter -Wno-unknown-pragmas -Wno-pointer-to-int-cast \
+  *       -ITools/hwtest/host -ITools/hwtest -ISYSTEM/sys -ISYSTEM/usart \
+  *       Tools/hwtest/usart_test.c Tools/hwtest/hw_fake.c -o usart_test && ./usart_test
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hw_fake.h"
+
+#define fputc      USART_TEST_fputc
+#define _sys_exit  USART_TEST_sys_exit
+#include "../../SYSTEM/usart/usart.c"
+#undef fputc
+#undef _sys_exit
+
+#define TEST_LOG_LEN         65536     // 取出内容的记录缓冲
+#define TEST_BULK_BAUD       921600    // 连续上传的波特率
+#define TEST_BULK_MS         2000      // 连续上传的时长(ms)
+
+static const char test_bulk_line[] = "prog move -12.50 0.5 250 300 smooth\r\n"; // 连续上传的行
+
+static int test_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { test_failures++; printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } \
+} while (0)
+
+static uint32_t test_written = 0;                // DMA已写入的字节总数
+static char test_log[TEST_LOG_LEN];              // 取出的行记为"文本\n"，帧记为"{内容}\n"
+static uint32_t test_lines = 0;                  // 取出的行数
+static uint32_t test_frames = 0;                 // 取出的帧数
+
+/**
+  * @brief  复位外设和接收状态，照固件初始化串口
+  * @param  无
+  * @retval 无
+  */
+static void TEST_Reset(void)
+{
+    HW_FAKE_Reset(72000000, 2, 1);
+    memset(USART_RX_RING, 0, sizeof(USART_RX_RING));
+    USART_RX_STA = 0;
+    USART_RX_FRAME_STA = 0;
+    USART_RX_SKIP = 0;
+    USART_RX_OVERRUNS = 0;
+    USART_RX_LONG = 0;
+    uart_init(115200);
+    test_written = 0;
+    test_log[0] = '\0';
+    test_lines = 0;
+    test_frames = 0;
+}
+
+/**
+  * @brief  DMA写入数据
+  * @param  data: 数据
+  * @param  len: 字节数
+  * @param  idle: 1: 数据后线路空闲，进串口空闲中断
+  * @retval 无
+  */
+static void TEST_Receive(const char *data, uint32_t len, uint8_t idle)
+{
+    uint32_t i, pos;
+
+    for (i = 0; i < len; i++) {
+        USART_RX_RING[test_written & (USART_RX_RING_LEN - 1)] = (u8)data[i];
+        test_written++;
+
+        /* 循环模式：剩余计数减到0立即重装 */
+        pos = test_written & (USART_RX_RING_LEN - 1);
+        HW_DMA1_Channel5.CNDTR = USART_RX_RING_LEN - pos;
+        if (pos == USART_RX_RING_LEN / 2 || pos == 0) {
+            g_hw.dma_flags |= (pos == 0) ? DMA1_IT_TC5 : DMA1_IT_HT5;
+            DMA1_Channel5_IRQHandler();
+            CHECK(g_hw.dma_flags == 0, "DMA flags 0x%08X not cleared", g_hw.dma_flags);
+        }
+    }
+    if (idle) {
+        HW_USART1.SR |= USART_FLAG_IDLE;
+        USART1_IRQHandler();
+        HW_USART1.SR &= (uint16_t)~USART_FLAG_IDLE;
+    }
+}
+
+static void TEST_ReceiveString(const char *s)
+{
+    TEST_Receive(s, (uint32_t)strlen(s), 1);
+}
+
+/**
+  * @brief  主循环：取出已到达的全部行和帧，追加到记录
+  * @param  无
+  * @retval 无
+  */
+static void TEST_Service(void)
+{
+    size_t n = strlen(test_log);
+    uint8_t event;
+
+    while ((event = USART_RxService()) != USART_RX_EV_NONE) {
+        if (n + USART_REC_LEN + 4 > sizeof(test_log)) n = 0;    // 只有连续上传会记满，从头覆盖
+        if (event == USART_RX_EV_FRAME) {
+            n += sprintf(test_log + n, "{%.*s}\n", USART_RX_FRAME_STA & 0x1FFF, (const char *)USART_RX_FRAME);
+            USART_RX_FRAME_STA = 0;
+            test_frames++;
+        } else {
+            n += sprintf(test_log + n, "%.*s\n", USART_RX_STA & 0x3FFF, (const char *)USART_RX_BUF);
+            USART_RX_STA = 0;
+            test_lines++;
+        }
+    }
+}
+
+/**
+  * @brief  用短行把写入总数推进到to，并取走
+  * @param  to: 目标写入总数，与当前相差不小于2
+  * @retval 无
+  */
+static void TEST_Advance(uint32_t to)
+{
+    char line[128];
+    uint32_t n;
+
+    while (test_written < to) {
+        n = to - test_written;
+        if (n > 120) n = 100;
+        memset(line, 'z', n - 2);
+        line[n - 2] = '\r';
+        line[n - 1] = '\n';
+        TEST_Receive(line, n, 1);
+        TEST_Service();
+    }
+    test_log[0] = '\0';
+    test_lines = 0;
+}
+
+static void TEST_ExpectLog(const char *expect, const char *what)
+{
+    CHECK(strcmp(test_log, expect) == 0, "%s: got \"%s\", expected \"%s\"", what, test_log, expect);
+    test_log[0] = '\0';
+}
+
+static void TEST_Init(void)
+{
+    TEST_Reset();
+    CHECK(HW_DMA1_Channel5.CNDTR == USART_RX_RING_LEN, "DMA count %u after init", HW_DMA1_Channel5.CNDTR);
+    CHECK((HW_DMA1_Channel5.CCR & (DMA_CCR1_EN | DMA_IT_HT | DMA_IT_TC)) == (DMA_CCR1_EN | DMA_IT_HT | DMA_IT_TC),
+          "DMA channel 5 CCR 0x%08X", HW_DMA1_Channel5.CCR);
+    CHECK((HW_USART1.CR3 & USART_DMAReq_Rx) && (HW_USART1.CR1 & 0x0010) && (HW_USART1.CR1 & 0x2000),
+          "USART1 CR1 0x%04X CR3 0x%04X", HW_USART1.CR1, HW_USART1.CR3);
+    CHECK(USART_RxService() == USART_RX_EV_NONE, "event with nothing received");
+}
+
+static void TEST_Lines(void)
+{
+    TEST_Reset();
+
+    TEST_ReceiveString("status\r\ntarget 10\r\n");
+    TEST_Service();
+    TEST_ExpectLog("status\ntarget 10\n", "two lines");
+
+    /* 分几次到达的行 */
+    TEST_ReceiveString("mode du");
+    TEST_Service();
+    TEST_ExpectLog("", "half line");
+    TEST_ReceiveString("al\r");
+    TEST_Service();
+    TEST_ExpectLog("", "line before LF");
+    TEST_ReceiveString("\n\r\n");
+    TEST_Service();
+    TEST_ExpectLog("mode dual\n\n", "line completed by LF, then empty line");
+
+    /* 未清USART_RX_STA时不取下一行 */
+    TEST_ReceiveString("a\r\nb\r\n");
+    CHECK(USART_RxService() == USART_RX_EV_LINE, "first line not returned");
+    CHECK(USART_RxService() == USART_RX_EV_LINE && USART_RX_BUF[0] == 'a' && (USART_RX_STA & 0x3FFF) == 1,
+          "pending line overwritten");
+    USART_RX_STA = 0;
+    TEST_Service();
+    TEST_ExpectLog("b\n", "line after the pending one");
+
+    /* 无空闲中断时(连续数据)由USART_RxService读剩余计数 */
+    TEST_Receive("stop\r\n", 6, 0);
+    TEST_Service();
+    TEST_ExpectLog("stop\n", "line without idle interrupt");
+}
+
+static void TEST_Wrap(void)
+{
+    static const char line[] = "prog move 12.50 1.0 500\r\n";
+    static const char frame[] = "\0WRAPPED-FRAME\0";
+
+    TEST_Reset();
+
+    /* 行跨过环形缓冲末尾 */
+    TEST_Advance(USART_RX_RING_LEN - 7);
+    TEST_ReceiveString(line);
+    TEST_Service();
+    TEST_ExpectLog("prog move 12.50 1.0 500\n", "line across the ring end");
+
+    /* 帧跨过末尾 */
+    TEST_Advance(2 * USART_RX_RING_LEN - 5);
+    TEST_Receive(frame, sizeof(frame) - 1, 1);
+    TEST_Service();
+    TEST_ExpectLog("{WRAPPED-FRAME}\n", "frame across the ring end");
+
+    /* 行尾CRLF分在末尾两侧 */
+    TEST_Advance(3 * USART_RX_RING_LEN - 5);
+    TEST_ReceiveString("save\r\n");
+    TEST_Service();
+    TEST_ExpectLog("save\n", "CR and LF on both sides of the ring end");
+
+    /* 写到一圈末尾、全满中断之前剩余计数可能读到0(重装前)，按位置0处理 */
+    TEST_Advance(4 * USART_RX_RING_LEN - 6);
+    memcpy(&USART_RX_RING[USART_RX_RING_LEN - 6], "help\r\n", 6);
+    test_written += 6;
+    HW_DMA1_Channel5.CNDTR = 0;
+    TEST_Service();
+    TEST_ExpectLog("help\n", "line ending at count 0");
+    CHECK(USART_RX_HEAD == test_written, "count 0 read as %u bytes, expected %u", USART_RX_HEAD, test_written);
+    HW_DMA1_Channel5.CNDTR = USART_RX_RING_LEN;
+    g_hw.dma_flags |= DMA1_IT_TC5;
+    DMA1_Channel5_IRQHandler();
+    CHECK(USART_RX_HEAD == test_written, "reload counted as %u bytes, expected %u", USART_RX_HEAD, test_written);
+    TEST_ReceiveString("stop\r\n");
+    TEST_Service();
+    TEST_ExpectLog("stop\n", "line after the reload");
+}
+
+static void TEST_Frames(void)
+{
+    static const char frames[] = "\0ABC\0\0\0XY\0";
+    static const char interrupted[] = "statu\0PQ\0s\r\n";
+    char longframe[USART_FRAME_LEN + 3];
+    u32 overruns, long_lines;
+
+    TEST_Reset();
+
+    /* 连续的0x00视为帧间空隙 */
+    TEST_Receive(frames, sizeof(frames) - 1, 1);
+    TEST_Service();
+    TEST_ExpectLog("{ABC}\n{XY}\n", "frames with gaps");
+
+    /* 帧开始时半行作废 */
+    TEST_Receive(interrupted, sizeof(interrupted) - 1, 1);
+    TEST_Service();
+    TEST_ExpectLog("{PQ}\ns\n", "frame inside a line");
+
+    /* USART_FRAME_LEN字节的帧收下，多一个字节丢弃到下一个0x00 */
+    memset(longframe, 'F', sizeof(longframe));
+    longframe[0] = '\0';
+    longframe[USART_FRAME_LEN + 1] = '\0';
+    TEST_Receive(longframe, USART_FRAME_LEN + 2, 1);
+    TEST_Service();
+    CHECK(test_frames == 4 && strlen(test_log) == USART_FRAME_LEN + 3, "%u-byte frame not received", USART_FRAME_LEN);
+    test_log[0] = '\0';
+    longframe[USART_FRAME_LEN + 1] = 'F';
+    longframe[USART_FRAME_LEN + 2] = '\0';
+    TEST_Receive(longframe, USART_FRAME_LEN + 3, 1);
+    TEST_Receive("\0OK\0", 4, 1);
+    TEST_Service();
+    TEST_ExpectLog("{OK}\n", "frame after a long frame");
+    USART_RxGetErrors(&overruns, &long_lines);
+    CHECK(long_lines == 1 && overruns == 0, "long frame: %u long, %u overruns", long_lines, overruns);
+}
+
+static void TEST_LongLines(void)
+{
+    char line[1024];
+    char expect[USART_REC_LEN + 8];
+    u32 overruns, long_lines;
+
+    TEST_Reset();
+
+    /* USART_REC_LEN-1字节：末字节留给SHELL_Process写'\0' */
+    memset(line, 'a', USART_REC_LEN - 1);
+    strcpy(line + USART_REC_LEN - 1, "\r\n");
+    TEST_ReceiveString(line);
+    TEST_Service();
+    memset(expect, 'a', USART_REC_LEN - 1);
+    strcpy(expect + USART_REC_LEN - 1, "\n");
+    TEST_ExpectLog(expect, "longest line");
+
+    /* 再长一个字节整行丢弃，后半行不当作新行 */
+    memset(line, 'b', USART_REC_LEN);
+    strcpy(line + USART_REC_LEN, "\r\nnext\r\n");
+    TEST_ReceiveString(line);
+    TEST_Service();
+    TEST_ExpectLog("next\n", "line one byte too long");
+
+    /* 远超长度，分几次到达 */
+    memset(line, 'c', 1000);
+    line[1000] = '\0';
+    TEST_ReceiveString(line);
+    TEST_Service();
+    TEST_ReceiveString(line);
+    TEST_ReceiveString("\r\nrate 500\r\n");
+    TEST_Service();
+    TEST_ExpectLog("rate 500\n", "2000-byte line");
+
+    USART_RxGetErrors(&overruns, &long_lines);
+    CHECK(long_lines == 2 && overruns == 0, "long lines: %u long, %u overruns", long_lines, overruns);
+}
+
+/**
+  * @brief  写入count行"line %09u\r\n"(每行16字节)，不取出
+  * @param  first: 第一行的编号
+  * @param  count: 行数
+  * @retval 无
+  */
+static void TEST_NumberedLines(uint32_t first, uint32_t count)
+{
+    char line[32];
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        sprintf(line, "line %09u\r\n", first + i);
+        TEST_Receive(line, 16, 0);
+    }
+    TEST_Receive(NULL, 0, 1);
+}
+
+/**
+  * @brief  检查记录是否为编号连续的行
+  * @param  first: 期望的第一个编号
+  * @param  last: 期望的最后一个编号
+  * @param  what: 说明
+  * @retval 无
+  */
+static void TEST_ExpectNumbered(uint32_t first, uint32_t last, const char *what)
+{
+    const char *p = test_log;
+    unsigned int number, expect = first;
+    int used;
+
+    while (*p != '\0') {
+        if (sscanf(p, "line %9u\n%n", &number, &used) != 1 || used != 15 || number != expect) {
+            CHECK(0, "%s: line %u is \"%.15s\"", what, expect, p);
+            break;
+        }
+        expect++;
+        p += used;
+    }
+    CHECK(expect == last + 1, "%s: lines %u-%u, expected %u-%u", what, first, expect - 1, first, last);
+    test_log[0] = '\0';
+}
+
+static void TEST_Overrun(void)
+{
+    uint32_t start, tail, first;
+    u32 overruns, long_lines;
+
+    TEST_Reset();
+    TEST_Advance(700);
+
+    /* 恰好一圈未取出：不算溢出 */
+    TEST_NumberedLines(0, USART_RX_RING_LEN / 16);
+    TEST_Service();
+    TEST_ExpectNumbered(0, USART_RX_RING_LEN / 16 - 1, "one full ring");
+    USART_RxGetErrors(&overruns, &long_lines);
+    CHECK(overruns == 0, "full ring counted as %u overruns", overruns);
+
+    /* 多一个字节：DMA已覆盖最早的字节 */
+    start = test_written;
+    TEST_NumberedLines(1000, USART_RX_RING_LEN / 16);
+    TEST_ReceiveString("x");
+    TEST_Service();
+
+    /* 保留较新的半圈，丢弃其中第一个(可能不完整的)行 */
+    tail = test_written - USART_RX_RING_LEN / 2;
+    first = 1000 + (tail - start) / 16 + 1;
+    TEST_ExpectNumbered(first, 1000 + USART_RX_RING_LEN / 16 - 1, "one byte over a full ring");
+    USART_RxGetErrors(&overruns, &long_lines);
+    CHECK(overruns == 1 && long_lines == 0, "%u overruns, %u long", overruns, long_lines);
+
+    /* 溢出发生在行中间，恢复后半行"x"与后续数据拼接 */
+    TEST_ReceiveString("\r\n");
+    TEST_Service();
+    TEST_ExpectLog("x\n", "line after overrun");
+
+    /* 远超一圈：保留的半圈恰好从行首开始，该行同样丢弃 */
+    TEST_Receive("abc", 3, 0);
+    start = test_written;
+    TEST_NumberedLines(5000, 3 * USART_RX_RING_LEN / 16 + 7);
+    TEST_Service();
+    tail = test_written - USART_RX_RING_LEN / 2;
+    first = 5000 + (tail - start) / 16 + 1;
+    TEST_ExpectNumbered(first, 5000 + 3 * USART_RX_RING_LEN / 16 + 6, "three rings");
+    USART_RxGetErrors(&overruns, &long_lines);
+    CHECK(overruns == 2, "%u overruns after three rings", overruns);
+}
+
+/**
+  * @brief  921600波特率连续上传
+  * @param  loop_us: 主循环周期(us)
+  * @param  overruns: 输出溢出次数
+  * @retval uint32_t: 收到的行数
+  */
+static uint32_t TEST_Bulk(uint32_t loop_us, u32 *overruns)
+{
+    uint64_t credit = 0;
+    uint32_t elapsed, pos = 0, n;
+    u32 long_lines;
+
+    TEST_Reset();
+    for (elapsed = 0; elapsed < TEST_BULK_MS * 1000; elapsed += loop_us) {
+        /* 10位一字节 */
+        credit += (uint64_t)loop_us * TEST_BULK_BAUD / 10;
+        n = (uint32_t)(credit / 1000000);
+        credit -= (uint64_t)n * 1000000;
+        while (n-- > 0) {
+            TEST_Receive(&test_bulk_line[pos], 1, 0);
+            pos = (pos + 1) % (sizeof(test_bulk_line) - 1);
+        }
+        TEST_Service();
+    }
+    USART_RxGetErrors(overruns, &long_lines);
+    return test_lines;
+}
+
+static void TEST_BulkUpload(void)
+{
+    uint32_t expect = (uint32_t)((uint64_t)TEST_BULK_MS * TEST_BULK_BAUD / 10 / 1000 / (sizeof(test_bulk_line) - 1));
+    uint32_t lines;
+    u32 overruns;
+
+    lines = TEST_Bulk(20000, &overruns);
+    printf("921600 baud, 20 ms loop: %u lines, %u overruns\n", lines, overruns);
+    CHECK(overruns == 0 && lines + 1 >= expect, "20 ms loop: %u of %u lines, %u overruns", lines, expect, overruns);
+
+    lines = TEST_Bulk(25000, &overruns);
+    printf("921600 baud, 25 ms loop: %u lines, %u overruns\n", lines, overruns);
+    CHECK(overruns > 0 && lines < expect, "25 ms loop: no overrun reported");
+}
+
+int main(void)
+{
+    TEST_Init();
+    TEST_Lines();
+    TEST_Wrap();
+    TEST_Frames();
+    TEST_LongLines();
+    TEST_Overrun();
+    TEST_BulkUpload();
+
+    printf("%s: %d failure(s)\n", test_failures ? "FAIL" : "OK", test_failures);
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,449 @@
+/**
+  ******************************************************************************
+  * @file    pid_sweep.c
+  * @brief   角度PID增益批量扫描工具(主机程序)
+  ******************************************************************************
+  * 在Kp/Ki/Kd网格上对每组增益做阶跃仿真，按调节时间和超调排序，
+  * 输出排名表、调节时间/超调热力图和完整结果CSV。
+  *
+  * PID使用固件Algorithm/pid_controller.c的批量接口，与PID_TypeDef路径共用计算核心；
+  * 启动时抽取若干组增益与标量路径逐步比对输出，确认逐位一致。
+  * 候选按区间分给各线程，每个线程对自己的区间推进全部时间步。
+  *
+  * 编译(在仓库根目录)：
+  *   gcc -std=gnu99 -O3 -ffp-contract=off -DPID_BATCH -IAlgorithm \
+  *       Tools/pid_sweep/pid_sweep.c Algorithm/pid_controller.c -lm -lpthread -o pid_sweep
+  *
+  * 用法：
+  *   pid_sweep [-p min:max:n] [-i min:max:n] [-d min:max:n] [-t 线程数]
+  *             [-s 目标角度] [-b 稳定带宽] [-T 仿真时长] [-r 控制频率] [-n 排名条数] [-o 结果.csv]
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "pid_controller.h"
+
+/* 板子模型：风扇推力一阶滞后，铰链处重力恢复力矩和空气阻尼
+ *   thrust' = (u - thrust) / FAN_TAU
+ *   theta'' = GAIN * thrust - GRAVITY * sin(theta) - DAMPING * theta'
+ * 参数取自样机阶跃响应的粗略拟合，仅用于相对比较增益 */
+#define PLANT_FAN_TAU        0.10f    // 风扇推力时间常数(s)
+#define PLANT_GAIN           0.15f    // 每1%净推力的角加速度(rad/s^2)
+#define PLANT_GRAVITY        10.0f    // 重力恢复项(rad/s^2)
+#define PLANT_DAMPING        2.0f     // 阻尼(1/s)
+#define PLANT_QUANT          0.066f   // 角度量化(度)，12位ADC对应270°电位器
+#define PLANT_SUBSTEP        0.001f   // 模型积分步长(s)
+
+#define DEG_PER_RAD          57.29578f
+
+#define SWEEP_THREADS_MAX    64       // 最多线程数
+#define SWEEP_CHECK_COUNT    4        // 逐位比对的候选组数
+#define HEAT_RAMP            " .:-=+*#%@"  // 热力图字符，从好到差
+
+/* 网格轴 */
+typedef struct {
+    float min;
+    float max;
+    uint32_t n;
+} SweepAxis_TypeDef;
+
+/* 板子状态 */
+typedef struct {
+    float theta;                 // 角度(rad)
+    float omega;                 // 角速度(rad/s)
+    float thrust;                // 净推力(%)
+} Plant_TypeDef;
+
+/* 单组候选结果 */
+typedef struct {
+    uint32_t index;              // 组号
+    float settle;                // 调节时间(s)，最后一次离开稳定带的时刻；未稳定为负
+    float overshoot;             // 超调(%)
+    float iae;                   // 误差绝对值积分(度*s)
+} SweepResult_TypeDef;
+
+/* 扫描配置 */
+typedef struct {
+    SweepAxis_TypeDef kp, ki, kd;
+    float target;                // 阶跃目标角度(度)
+    float band;                  // 稳定带宽(±度)
+    float duration;              // 仿真时长(s)
+    float period;                // 控制周期(s)
+    uint32_t threads;
+    uint32_t top;
+    const char *csv;
+} SweepConfig_TypeDef;
+
+/* 线程任务 */
+typedef struct {
+    const SweepConfig_TypeDef *cfg;
+    PIDBatch_TypeDef slice;
+    SweepResult_TypeDef *results;  // 本区间结果
+    uint32_t first;
+} SweepTask_TypeDef;
+
+/**
+  * @brief  板子模型推进一个控制周期
+  * @param  plant: 板子状态
+  * @param  u: 净推力指令(%)，PID输出
+  * @param  period: 控制周期(s)
+  * @retval 无
+  */
+static void PLANT_Step(Plant_TypeDef *plant, float u, float period)
+{
+    float t, acc;
+
+    for (t = 0.0f; t < period - PLANT_SUBSTEP * 0.5f; t += PLANT_SUBSTEP) {
+        plant->thrust += (u - plant->thrust) * (PLANT_SUBSTEP / PLANT_FAN_TAU);
+        acc = PLANT_GAIN * plant->thrust - PLANT_GRAVITY * sinf(plant->theta) - PLANT_DAMPING * plant->omega;
+        plant->omega += acc * PLANT_SUBSTEP;
+        plant->theta += plant->omega * PLANT_SUBSTEP;
+    }
+}
+
+/**
+  * @brief  读取量化后的测量角度
+  * @param  plant: 板子状态
+  * @retval float: 测量角度(度)
+  */
+static float PLANT_Measure(const Plant_TypeDef *plant)
+{
+    return floorf(plant->theta * DEG_PER_RAD / PLANT_QUANT + 0.5f) * PLANT_QUANT;
+}
+
+/**
+  * @brief  取网格轴上第k个值
+  */
+static float SWEEP_AxisValue(const SweepAxis_TypeDef *axis, uint32_t k)
+{
+    if (axis->n <= 1) return axis->min;
+    return axis->min + (axis->max - axis->min) * k / (axis->n - 1);
+}
+
+/**
+  * @brief  组号拆分为网格坐标(Kp变化最快)
+  */
+static void SWEEP_Decode(const SweepConfig_TypeDef *cfg, uint32_t index, uint32_t *ip, uint32_t *ii, uint32_t *id)
+{
+    *ip = index % cfg->kp.n;
+    *ii = (index / cfg->kp.n) % cfg->ki.n;
+    *id = index / (cfg->kp.n * cfg->ki.n);
+}
+
+/**
+  * @brief  按固件角度环配置PID原型
+  */
+static void SWEEP_Prototype(const SweepConfig_TypeDef *cfg, PID_TypeDef *pid, float kp, float ki, float kd)
+{
+    PID_Init(pid, kp, ki, kd, PID_MODE_POSITION, cfg->period);
+    PID_SetOutputLimits(pid, -100.0f, 100.0f);
+    PID_SetPoint(pid, cfg->target);
+}
+
+/**
+  * @brief  线程入口：对区间内全部候选做阶跃仿真
+  */
+static void *SWEEP_Worker(void *arg)
+{
+    SweepTask_TypeDef *task = (SweepTask_TypeDef *)arg;
+    const SweepConfig_TypeDef *cfg = task->cfg;
+    uint32_t count = task->slice.count;
+    uint32_t steps = (uint32_t)(cfg->duration / cfg->period + 0.5f);
+    Plant_TypeDef *plants = calloc(count, sizeof(Plant_TypeDef));
+    float *measure = malloc(count * sizeof(float));
+    float *peak = malloc(count * sizeof(float));
+    uint32_t i, n;
+    float t, err;
+
+    for (i = 0; i < count; i++) {
+        peak[i] = 0.0f;
+        task->results[i].index = task->first + i;
+        task->results[i].settle = 0.0f;
+        task->results[i].iae = 0.0f;
+    }
+
+    for (n = 0; n < steps; n++) {
+        t = n * cfg->period;
+        for (i = 0; i < count; i++) {
+            measure[i] = PLANT_Measure(&plants[i]);
+        }
+        PID_BatchCalculate(&task->slice, measure, cfg->period);
+        for (i = 0; i < count; i++) {
+            err = fabsf(cfg->target - measure[i]);
+            if (err > cfg->band) task->results[i].settle = t + cfg->period;
+            if (measure[i] > peak[i]) peak[i] = measure[i];
+            task->results[i].iae += err * cfg->period;
+            PLANT_Step(&plants[i], task->slice.output[i], cfg->period);
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        /* 最后一步仍在带外视为未稳定 */
+        if (task->results[i].settle >= steps * cfg->period) task->results[i].settle = -1.0f;
+        task->results[i].overshoot = (peak[i] > cfg->target) ?
+                                     (peak[i] - cfg->target) * 100.0f / cfg->target : 0.0f;
+    }
+
+    free(plants);
+    free(measure);
+    free(peak);
+    return NULL;
+}
+
+/**
+  * @brief  抽查候选：批量路径与PID_TypeDef路径逐步比对
+  * @retval int: 不一致的组数
+  */
+static int SWEEP_CheckBitExact(const SweepConfig_TypeDef *cfg, const PIDBatch_TypeDef *batch)
+{
+    uint32_t picks[SWEEP_CHECK_COUNT];
+    uint32_t steps = (uint32_t)(cfg->duration / cfg->period + 0.5f);
+    uint32_t k, n;
+    int failed = 0;
+
+    picks[0] = 0;
+    picks[1] = batch->count / 3;
+    picks[2] = batch->count * 2 / 3;
+    picks[3] = batch->count - 1;
+
+    for (k = 0; k < SWEEP_CHECK_COUNT; k++) {
+        PIDBatch_TypeDef one;
+        float storage[PID_BATCH_FLOATS(1)];
+        PID_TypeDef pid;
+        Plant_TypeDef pa, pb;
+        float ma, mb, ua;
+
+        SWEEP_Prototype(cfg, &pid, batch->Kp[picks[k]], batch->Ki[picks[k]], batch->Kd[picks[k]]);
+        PID_BatchInit(&one, &pid, 1, storage);
+        memset(&pa, 0, sizeof(pa));
+        memset(&pb, 0, sizeof(pb));
+
+        for (n = 0; n < steps; n++) {
+            ma = PLANT_Measure(&pa);
+            mb = PLANT_Measure(&pb);
+            ua = PID_CalculateDt(&pid, ma, cfg->period);
+            PID_BatchCalculate(&one, &mb, cfg->period);
+            if (memcmp(&ua, &one.output[0], sizeof(float)) != 0) {
+                printf("Bit mismatch: candidate %u step %u scalar %.9g batch %.9g\n",
+                       picks[k], n, ua, one.output[0]);
+                failed++;
+                break;
+            }
+            PLANT_Step(&pa, ua, cfg->period);
+            PLANT_Step(&pb, one.output[0], cfg->period);
+        }
+    }
+    return failed;
+}
+
+/**
+  * @brief  排序：稳定的在前，调节时间短的在前，再比超调和IAE
+  */
+static int SWEEP_Compare(const void *a, const void *b)
+{
+    const SweepResult_TypeDef *ra = (const SweepResult_TypeDef *)a;
+    const SweepResult_TypeDef *rb = (const SweepResult_TypeDef *)b;
+
+    if ((ra->settle < 0.0f) != (rb->settle < 0.0f)) return (ra->settle < 0.0f) ? 1 : -1;
+    if (ra->settle != rb->settle) return (ra->settle < rb->settle) ? -1 : 1;
+    if (ra->overshoot != rb->overshoot) return (ra->overshoot < rb->overshoot) ? -1 : 1;
+    if (ra->iae != rb->iae) return (ra->iae < rb->iae) ? -1 : 1;
+    return 0;
+}
+
+/**
+  * @brief  打印Kp(列)xKi(行)热力图，Kd取最优候选所在层
+  * @param  value: 0打印调节时间，1打印超调
+  */
+static void SWEEP_PrintHeatmap(const SweepConfig_TypeDef *cfg, const SweepResult_TypeDef *by_index,
+                               uint32_t id, uint8_t value)
+{
+    uint32_t ip, ii, levels = (uint32_t)strlen(HEAT_RAMP);
+    float lo = 1e30f, hi = -1e30f, v;
+    const SweepResult_TypeDef *r;
+
+    /* 本层范围 */
+    for (ii = 0; ii < cfg->ki.n; ii++) {
+        for (ip = 0; ip < cfg->kp.n; ip++) {
+            r = &by_index[(id * cfg->ki.n + ii) * cfg->kp.n + ip];
+            if (r->settle < 0.0f) continue;
+            v = value ? r->overshoot : r->settle;
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+    }
+
+    printf("\n%s, Kd = %.3f  ('%c' %.2f .. '%c' %.2f, 'X' not settled)\n",
+           value ? "Overshoot (%)" : "Settling time (s)", SWEEP_AxisValue(&cfg->kd, id),
+           HEAT_RAMP[0], lo, HEAT_RAMP[levels - 1], hi);
+    printf("   Ki \\ Kp %.3f .. %.3f\n", cfg->kp.min, cfg->kp.max);
+    for (ii = cfg->ki.n; ii-- > 0; ) {
+        printf("%9.3f  ", SWEEP_AxisValue(&cfg->ki, ii));
+        for (ip = 0; ip < cfg->kp.n; ip++) {
+            r = &by_index[(id * cfg->ki.n + ii) * cfg->kp.n + ip];
+            if (r->settle < 0.0f) {
+                putchar('X');
+                continue;
+            }
+            v = value ? r->overshoot : r->settle;
+            putchar(HEAT_RAMP[(hi > lo) ? (uint32_t)((v - lo) / (hi - lo) * (levels - 1) + 0.5f) : 0]);
+        }
+        putchar('\n');
+    }
+}
+
+/**
+  * @brief  解析"min:max:n"
+  */
+static int SWEEP_ParseAxis(const char *text, SweepAxis_TypeDef *axis)
+{
+    unsigned n;
+
+    if (sscanf(text, "%f:%f:%u", &axis->min, &axis->max, &n) != 3 || n == 0) return 0;
+    axis->n = n;
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    SweepConfig_TypeDef cfg;
+    SweepTask_TypeDef tasks[SWEEP_THREADS_MAX];
+    pthread_t threads[SWEEP_THREADS_MAX];
+    PIDBatch_TypeDef batch;
+    PID_TypeDef proto;
+    SweepResult_TypeDef *results, *by_index;
+    float *storage;
+    uint32_t total, i, chunk, ip, ii, id, settled = 0;
+    struct timespec t0, t1;
+    double elapsed;
+    FILE *fp;
+    int opt;
+
+    cfg.kp.min = 2.0f;  cfg.kp.max = 20.0f; cfg.kp.n = 32;
+    cfg.ki.min = 0.0f;  cfg.ki.max = 5.0f;  cfg.ki.n = 16;
+    cfg.kd.min = 0.0f;  cfg.kd.max = 5.0f;  cfg.kd.n = 8;
+    cfg.target = 45.0f;
+    cfg.band = 5.0f;                     // 与赛题±5°判据一致
+    cfg.duration = 10.0f;
+    cfg.period = 0.01f;
+    cfg.threads = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    cfg.top = 15;
+    cfg.csv = NULL;
+
+    while ((opt = getopt(argc, argv, "p:i:d:t:s:b:T:r:n:o:h")) != -1) {
+        switch (opt) {
+        case 'p': if (!SWEEP_ParseAxis(optarg, &cfg.kp)) goto usage; break;
+        case 'i': if (!SWEEP_ParseAxis(optarg, &cfg.ki)) goto usage; break;
+        case 'd': if (!SWEEP_ParseAxis(optarg, &cfg.kd)) goto usage; break;
+        case 't': cfg.threads = (uint32_t)atoi(optarg); break;
+        case 's': cfg.target = (float)atof(optarg); break;
+        case 'b': cfg.band = (float)atof(optarg); break;
+        case 'T': cfg.duration = (float)atof(optarg); break;
+        case 'r': cfg.period = 1.0f / (float)atof(optarg); break;
+        case 'n': cfg.top = (uint32_t)atoi(optarg); break;
+        case 'o': cfg.csv = optarg; break;
+        default: goto usage;
+        }
+    }
+    if (cfg.threads < 1) cfg.threads = 1;
+    if (cfg.threads > SWEEP_THREADS_MAX) cfg.threads = SWEEP_THREADS_MAX;
+    if (!(cfg.target > 0.0f) || !(cfg.period > 0.0f) || !(cfg.duration > cfg.period)) goto usage;
+
+    total = cfg.kp.n * cfg.ki.n * cfg.kd.n;
+    storage = malloc(PID_BATCH_FLOATS(total) * sizeof(float));
+    results = malloc(total * sizeof(SweepResult_TypeDef));
+    by_index = malloc(total * sizeof(SweepResult_TypeDef));
+    if (!storage || !results || !by_index) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    SWEEP_Prototype(&cfg, &proto, 0.0f, 0.0f, 0.0f);
+    PID_BatchInit(&batch, &proto, total, storage);
+    for (i = 0; i < total; i++) {
+        SWEEP_Decode(&cfg, i, &ip, &ii, &id);
+        PID_BatchTune(&batch, i, SWEEP_AxisValue(&cfg.kp, ip), SWEEP_AxisValue(&cfg.ki, ii),
+                      SWEEP_AxisValue(&cfg.kd, id));
+    }
+
+    if (SWEEP_CheckBitExact(&cfg, &batch) != 0) {
+        fprintf(stderr, "Batch PID is not bit-exact with PID_TypeDef, check compiler flags\n");
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    chunk = (total + cfg.threads - 1) / cfg.threads;
+    for (i = 0; i < cfg.threads; i++) {
+        tasks[i].cfg = &cfg;
+        tasks[i].first = (i * chunk < total) ? i * chunk : total;
+        tasks[i].results = results + tasks[i].first;
+        PID_BatchSlice(&batch, tasks[i].first, chunk, &tasks[i].slice);
+        pthread_create(&threads[i], NULL, SWEEP_Worker, &tasks[i]);
+    }
+    for (i = 0; i < cfg.threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    elapsed = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+
+    memcpy(by_index, results, total * sizeof(SweepResult_TypeDef));
+    qsort(results, total, sizeof(SweepResult_TypeDef), SWEEP_Compare);
+    for (i = 0; i < total; i++) {
+        if (results[i].settle >= 0.0f) settled++;
+    }
+
+    printf("%u candidates, %u threads, %.3f s (%.0f candidates/s), %u settled within +/-%.1f deg\n",
+           total, cfg.threads, elapsed, total / elapsed, settled, cfg.band);
+    printf("Step 0 -> %.1f deg at %.0f Hz, batch output bit-exact with PID_TypeDef\n\n",
+           cfg.target, 1.0f / cfg.period);
+    printf("Rank      Kp      Ki      Kd  Settle(s)  Overshoot(%%)   IAE\n");
+    for (i = 0; i < cfg.top && i < total; i++) {
+        SWEEP_Decode(&cfg, results[i].index, &ip, &ii, &id);
+        if (results[i].settle < 0.0f) {
+            printf("%4u %7.3f %7.3f %7.3f          -             -  %6.2f\n", i + 1,
+                   SWEEP_AxisValue(&cfg.kp, ip), SWEEP_AxisValue(&cfg.ki, ii), SWEEP_AxisValue(&cfg.kd, id),
+                   results[i].iae);
+            continue;
+        }
+        printf("%4u %7.3f %7.3f %7.3f  %9.2f  %12.1f  %6.2f\n", i + 1,
+               SWEEP_AxisValue(&cfg.kp, ip), SWEEP_AxisValue(&cfg.ki, ii), SWEEP_AxisValue(&cfg.kd, id),
+               results[i].settle, results[i].overshoot, results[i].iae);
+    }
+
+    SWEEP_Decode(&cfg, results[0].index, &ip, &ii, &id);
+    SWEEP_PrintHeatmap(&cfg, by_index, id, 0);
+    SWEEP_PrintHeatmap(&cfg, by_index, id, 1);
+
+    if (cfg.csv) {
+        fp = fopen(cfg.csv, "w");
+        if (!fp) {
+            perror(cfg.csv);
+            return 1;
+        }
+        fprintf(fp, "kp,ki,kd,settle_s,overshoot_pct,iae\n");
+        for (i = 0; i < total; i++) {
+            SWEEP_Decode(&cfg, i, &ip, &ii, &id);
+            fprintf(fp, "%.4f,%.4f,%.4f,%.3f,%.2f,%.3f\n", SWEEP_AxisValue(&cfg.kp, ip),
+                    SWEEP_AxisValue(&cfg.ki, ii), SWEEP_AxisValue(&cfg.kd, id),
+                    by_index[i].settle, by_index[i].overshoot, by_index[i].iae);
+        }
+        fclose(fp);
+    }
+
+    free(storage);
+    free(results);
+    free(by_index);
+    return 0;
+
+usage:
+    fprintf(stderr, "Usage: %s [-p min:max:n] [-i min:max:n] [-d min:max:n] [-t threads]\n"
+                    "          [-s target_deg] [-b band_deg] [-T seconds] [-r rate_hz] [-n top] [-o out.csv]\n",
+            argv[0]);
+    return 2;
+}
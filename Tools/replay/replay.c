@@ -0,0 +1,583 @@
+/**
+  ******************************************************************************
+  * @file    replay.c
+  * @brief   控制环记录重放工具(主机程序)
+  ******************************************************************************
+  * 读取串口抓取的$REC记录(见Algorithm/recorder.h)，在主机上用固件的
+  * Algorithm/angle_control.c及其算法模块逐周期重放：接口调用记录按原顺序调用
+  * ANGLE_CONTROL_Set*等接口，TICK/RPM记录作为传感器和测速的返回值，
+  * 每周期把风扇指令、差速输入和角度与OUT记录逐位比较。
+  * 重放结果可写成CSV，也可与另一次重放的CSV比较，用于检查算法修改对同一段输入的影响。
+  *
+  * 只重放从上电开始的记录(START中的上电标志)，运行中启动的记录缺少控制器内部状态，
+  * -F强制重放时前若干周期的分歧是预期的。遇到GAP、序号不连续或第二条START时停止。
+  *
+  * 编译(在仓库根目录)：
+  *   gcc -std=gnu99 -O2 -ITools/sim/host -ITools/replay -IAlgorithm -IHardware/angle_sensor \
+  *       -IHardware/fan_driver -IHardware/tach -IHardware/current_sense -IHardware/param_store \
+  *       -ISYSTEM/timebase -ISYSTEM/delay -ISYSTEM/sys \
+  *       Tools/replay/replay.c Tools/replay/replay_hw.c Algorithm/recorder.c \
+  *       Algorithm/angle_control.c Algorithm/pid_controller.c Algorithm/angle_estimator.c \
+  *       Algorithm/mpc_controller.c Algorithm/control_allocation.c Algorithm/system_ident.c \
+  *       Algorithm/stability_detector.c Algorithm/sequence_engine.c -lm -o replay
+  *
+  * 用法：
+  *   replay [-F] [-v] [-o 结果.csv] [-r 参考.csv] 抓取文件
+  *   抓取文件可以混有固件的其他打印，只解析以$REC,开头的行
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "replay.h"
+
+#define REPLAY_SEQ_MAX       10        // ConfigSequence的最大步数
+
+/* 比较项 */
+#define REPLAY_DIFF_STATE    0x01
+#define REPLAY_DIFF_MODE     0x02
+#define REPLAY_DIFF_OUTPUT   0x04
+#define REPLAY_DIFF_APPLIED  0x08
+#define REPLAY_DIFF_ANGLE    0x10
+#define REPLAY_DIFF_INPUT    0x20      // 读数方式或测速查询与记录不同
+
+/* 重放统计 */
+typedef struct {
+    uint32_t ticks;              // 重放的控制周期数
+    uint32_t commands;           // 执行的接口调用
+    uint32_t nested;             // 跳过的嵌套调用
+    uint32_t keys;               // 按键
+    uint32_t divergences;        // 与OUT不一致的周期数
+    uint32_t ref_diffs;          // 与参考CSV不一致的行数
+    uint32_t start_ms, end_ms;   // 重放的时间范围(ms)
+} ReplayStats_TypeDef;
+
+/* 私有变量 */
+static AngleControl_TypeDef rp_controls[ANGLE_CONTROL_AXIS_COUNT];
+static uint64_t rp_timestamp[ANGLE_CONTROL_AXIS_COUNT]; // 各轴展开后的样本时间戳
+static float rp_seq_angles[REPLAY_SEQ_MAX];
+static uint8_t rp_seq_holds[REPLAY_SEQ_MAX];
+
+static float REPLAY_Float(uint32_t bits)
+{
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+  * @brief  解析一行$REC记录
+  * @param  line: 一行文本
+  * @param  rec: 输出记录
+  * @retval int: 1成功，0不是记录行
+  */
+static int REPLAY_ParseLine(const char *line, RecorderRecord_TypeDef *rec)
+{
+    const char *p = strstr(line, "$REC,");
+    char field[9];
+    int i;
+
+    if (p == NULL) return 0;
+    p += 5;
+    for (i = 0; i < 32; i++) {
+        if (!((p[i] >= '0' && p[i] <= '9') || (p[i] >= 'A' && p[i] <= 'F') || (p[i] >= 'a' && p[i] <= 'f'))) {
+            return 0;
+        }
+    }
+
+    memcpy(field, p, 2); field[2] = '\0';
+    rec->type_axis = (uint8_t)strtoul(field, NULL, 16);
+    memcpy(field, p + 2, 2); field[2] = '\0';
+    rec->seq = (uint8_t)strtoul(field, NULL, 16);
+    memcpy(field, p + 4, 4); field[4] = '\0';
+    rec->arg = (uint16_t)strtoul(field, NULL, 16);
+    memcpy(field, p + 8, 8); field[8] = '\0';
+    rec->a = (uint32_t)strtoul(field, NULL, 16);
+    memcpy(field, p + 16, 8);
+    rec->b = (uint32_t)strtoul(field, NULL, 16);
+    memcpy(field, p + 24, 8);
+    rec->c = (uint32_t)strtoul(field, NULL, 16);
+    return 1;
+}
+
+/**
+  * @brief  读取抓取文件中的全部记录
+  * @param  path: 文件路径
+  * @param  count: 输出记录数
+  * @retval RecorderRecord_TypeDef*: 记录数组，失败返回NULL
+  */
+static RecorderRecord_TypeDef *REPLAY_Load(const char *path, size_t *count)
+{
+    FILE *f = fopen(path, "r");
+    RecorderRecord_TypeDef *recs = NULL, *grown;
+    size_t n = 0, cap = 0;
+    char line[256];
+
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        if (n == cap) {
+            cap = cap ? cap * 2 : 4096;
+            grown = realloc(recs, cap * sizeof(*recs));
+            if (!grown) {
+                free(recs);
+                fclose(f);
+                return NULL;
+            }
+            recs = grown;
+        }
+        if (REPLAY_ParseLine(line, &recs[n])) n++;
+    }
+    fclose(f);
+    *count = n;
+    return recs;
+}
+
+/**
+  * @brief  执行一条接口调用记录
+  * @param  rec: CMD记录
+  * @retval int: 1成功，0未知命令
+  */
+static int REPLAY_Command(const RecorderRecord_TypeDef *rec)
+{
+    uint8_t axis = rec->type_axis >> 4;
+    AngleControl_TypeDef *control = &rp_controls[axis];
+    SeqStep_TypeDef step;
+
+    switch (rec->arg) {
+    case RECORDER_CMD_TARGET:
+        ANGLE_CONTROL_SetTarget(control, REPLAY_Float(rec->a));
+        break;
+    case RECORDER_CMD_MODE:
+        ANGLE_CONTROL_SetMode(control, (ControlMode_TypeDef)rec->a);
+        break;
+    case RECORDER_CMD_PID:
+        ANGLE_CONTROL_SetPID(control, REPLAY_Float(rec->a), REPLAY_Float(rec->b), REPLAY_Float(rec->c));
+        break;
+    case RECORDER_CMD_ESTIMATOR:
+        ANGLE_CONTROL_EnableEstimator(control, (uint8_t)rec->a);
+        break;
+    case RECORDER_CMD_EST_NOISE:
+        ANGLE_CONTROL_SetEstimatorNoise(control, REPLAY_Float(rec->a), REPLAY_Float(rec->b));
+        break;
+    case RECORDER_CMD_SYSID:
+        ANGLE_CONTROL_EnableIdentification(control, (uint8_t)rec->a);
+        break;
+    case RECORDER_CMD_FINE_OUTPUT:
+        ANGLE_CONTROL_EnableFineOutput(control, (uint8_t)rec->a);
+        break;
+    case RECORDER_CMD_ATTACH_TACH:
+        ANGLE_CONTROL_AttachTach(control, (rec->a & 0x01) ? &g_replay_tachs[axis][FAN_LEFT] : NULL,
+                                 (rec->a & 0x02) ? &g_replay_tachs[axis][FAN_RIGHT] : NULL);
+        break;
+    case RECORDER_CMD_RPM_LOOP:
+        ANGLE_CONTROL_EnableRpmLoop(control, (uint8_t)rec->a);
+        break;
+    case RECORDER_CMD_RPM_PARAMS:
+        ANGLE_CONTROL_SetRpmLoop(control, REPLAY_Float(rec->a), REPLAY_Float(rec->b), REPLAY_Float(rec->c));
+        break;
+    case RECORDER_CMD_ALLOCATION:
+        ANGLE_CONTROL_SetAllocation(control, (AllocMode_TypeDef)rec->a);
+        break;
+    case RECORDER_CMD_MPC_MODEL:
+        ANGLE_CONTROL_SetMPCModel(control, REPLAY_Float(rec->a), REPLAY_Float(rec->b));
+        break;
+    case RECORDER_CMD_STABLE:
+        ANGLE_CONTROL_SetStableCondition(control, REPLAY_Float(rec->a), (uint16_t)rec->b);
+        break;
+    case RECORDER_CMD_EARLY_CONF:
+        ANGLE_CONTROL_SetEarlyConfidence(control, REPLAY_Float(rec->a));
+        break;
+    case RECORDER_CMD_LOOP_RATE:
+        /* 目标上选定的过采样率由记录给出，不依赖主机的ADC时序 */
+        g_replay_osr = (uint16_t)rec->c;
+        ANGLE_CONTROL_SetLoopRate(control, (uint8_t)rec->b, (uint16_t)rec->a);
+        break;
+    case RECORDER_CMD_SEQ_STEP:
+        if (rec->a < REPLAY_SEQ_MAX) {
+            rp_seq_angles[rec->a] = REPLAY_Float(rec->b);
+            rp_seq_holds[rec->a] = (uint8_t)rec->c;
+        }
+        break;
+    case RECORDER_CMD_SEQUENCE:
+        ANGLE_CONTROL_ConfigSequence(control, rp_seq_angles, rp_seq_holds, (uint8_t)rec->a);
+        break;
+    case RECORDER_CMD_START_SEQ:
+        ANGLE_CONTROL_StartSequence(control);
+        break;
+    case RECORDER_CMD_FAN_PARAMS:
+        ANGLE_CONTROL_SetFanParameters(control, (uint8_t)rec->a, (uint8_t)rec->b);
+        break;
+    case RECORDER_CMD_STOP:
+        ANGLE_CONTROL_Stop(control);
+        break;
+    case RECORDER_CMD_PROG_CLEAR:
+        ANGLE_CONTROL_ClearProgram(control, (uint8_t)rec->a);
+        break;
+    case RECORDER_CMD_PROG_STEP:
+        step.op = (uint8_t)rec->a;
+        step.flags = (uint8_t)(rec->a >> 8);
+        step.value = (int16_t)(rec->a >> 16);
+        step.tolerance = (uint16_t)rec->b;
+        step.rate = (uint16_t)(rec->b >> 16);
+        step.time = rec->c;
+        ANGLE_CONTROL_AppendStep(control, &step);
+        break;
+    case RECORDER_CMD_PROG_BUILTIN:
+        ANGLE_CONTROL_LoadProgram(control, (uint8_t)rec->a);
+        break;
+    case RECORDER_CMD_SEQ_KEY:
+        ANGLE_CONTROL_SequenceKey(control, (uint8_t)rec->a);
+        break;
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief  装入一个控制周期的输入
+  * @param  tick: TICK记录
+  * @param  rpm: 紧随的RPM记录，没有时为NULL
+  * @retval 无
+  */
+static void REPLAY_LoadInputs(const RecorderRecord_TypeDef *tick, const RecorderRecord_TypeDef *rpm)
+{
+    uint8_t axis = tick->type_axis >> 4;
+    ReplayAxis_TypeDef *ax = &g_replay_axes[axis];
+    uint32_t low;
+
+    REPLAY_HwBeginTick(axis);
+    ax->faults = (uint8_t)(tick->arg & 0xFF);
+    ax->read = (uint8_t)(tick->arg >> 8);
+    ax->angle = tick->b;
+
+    /* 记录只有时间戳低32位，按与上一个样本的差展开 */
+    if (ax->read == RECORDER_READ_FLOAT || ax->read == RECORDER_READ_Q16) {
+        low = tick->c;
+        rp_timestamp[axis] += (uint32_t)(low - (uint32_t)rp_timestamp[axis]);
+    }
+    ax->timestamp = rp_timestamp[axis];
+
+    ax->rpm_flags = 0;
+    if (rpm) {
+        ax->rpm_flags = (uint8_t)rpm->arg;
+        ax->rpm[FAN_LEFT] = rpm->a;
+        ax->rpm[FAN_RIGHT] = rpm->b;
+    }
+}
+
+/**
+  * @brief  比较一个控制周期的结果与OUT记录
+  * @param  tick: TICK记录
+  * @param  out: OUT记录
+  * @retval uint8_t: REPLAY_DIFF_x的组合，0为一致
+  */
+static uint8_t REPLAY_Compare(const RecorderRecord_TypeDef *tick, const RecorderRecord_TypeDef *out)
+{
+    uint8_t axis = tick->type_axis >> 4;
+    AngleControl_TypeDef *control = &rp_controls[axis];
+    ReplayAxis_TypeDef *ax = &g_replay_axes[axis];
+    uint8_t diff = 0;
+    uint32_t output;
+
+    if ((uint32_t)control->state != (out->arg & 0x0F)) diff |= REPLAY_DIFF_STATE;
+    if ((uint32_t)control->mode != ((out->arg >> 4) & 0x0F)) diff |= REPLAY_DIFF_MODE;
+
+    output = (uint32_t)ax->left | ((uint32_t)ax->right << 16);
+    if (ax->output != ((out->arg >> 9) & 1) || (ax->output && (ax->fine != ((out->arg >> 8) & 1) || output != out->a))) {
+        diff |= REPLAY_DIFF_OUTPUT;
+    }
+    if (RECORDER_Float(control->applied_input) != out->b) diff |= REPLAY_DIFF_APPLIED;
+    if (RECORDER_Float(control->current_angle) != out->c) diff |= REPLAY_DIFF_ANGLE;
+    if (ax->used_read != ax->read || ax->used_rpm != ax->rpm_flags) diff |= REPLAY_DIFF_INPUT;
+    return diff;
+}
+
+/**
+  * @brief  打印第一处分歧的详细内容
+  * @param  tick: TICK记录
+  * @param  out: OUT记录
+  * @param  diff: REPLAY_DIFF_x的组合
+  * @retval 无
+  */
+static void REPLAY_PrintDivergence(const RecorderRecord_TypeDef *tick, const RecorderRecord_TypeDef *out, uint8_t diff)
+{
+    uint8_t axis = tick->type_axis >> 4;
+    AngleControl_TypeDef *control = &rp_controls[axis];
+    ReplayAxis_TypeDef *ax = &g_replay_axes[axis];
+
+    printf("First divergence: axis %u at %lu ms\n", axis, (unsigned long)tick->a);
+    printf("                  recorded        replayed\n");
+    if (diff & REPLAY_DIFF_STATE) {
+        printf("  state           %-15u %u\n", out->arg & 0x0F, (unsigned)control->state);
+    }
+    if (diff & REPLAY_DIFF_MODE) {
+        printf("  mode            %-15u %u\n", (out->arg >> 4) & 0x0F, (unsigned)control->mode);
+    }
+    if (diff & REPLAY_DIFF_OUTPUT) {
+        printf("  output          %s %5lu %5lu   %s %5u %5u\n",
+               !((out->arg >> 9) & 1) ? "none" : ((out->arg >> 8) & 1) ? "fine" : "duty",
+               (unsigned long)(out->a & 0xFFFF), (unsigned long)(out->a >> 16),
+               !ax->output ? "none" : ax->fine ? "fine" : "duty", ax->left, ax->right);
+    }
+    if (diff & REPLAY_DIFF_APPLIED) {
+        printf("  applied_input   %-15.9g %.9g\n", REPLAY_Float(out->b), control->applied_input);
+    }
+    if (diff & REPLAY_DIFF_ANGLE) {
+        printf("  current_angle   %-15.9g %.9g\n", REPLAY_Float(out->c), control->current_angle);
+    }
+    if (diff & REPLAY_DIFF_INPUT) {
+        printf("  read/rpm        0x%02X/0x%02X       0x%02X/0x%02X\n",
+               ax->read, ax->rpm_flags, ax->used_read, ax->used_rpm);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    RecorderRecord_TypeDef *recs, *rec, *tick, *rpm, *out;
+    ReplayStats_TypeDef stats;
+    size_t count, i, start;
+    uint16_t osr, tick_us;
+    uint8_t axes, from_reset, force = 0, verbose = 0, expect_seq, diff, axis;
+    const char *out_path = NULL, *ref_path = NULL;
+    const char *stop_reason = "end of capture";
+    FILE *csv = NULL, *ref = NULL;
+    char row[128], ref_row[128];
+    struct timespec t0, t1;
+    double wall;
+    int opt, saved_stdout = -1, devnull;
+
+    while ((opt = getopt(argc, argv, "Fvo:r:h")) != -1) {
+        switch (opt) {
+        case 'F': force = 1; break;
+        case 'v': verbose = 1; break;
+        case 'o': out_path = optarg; break;
+        case 'r': ref_path = optarg; break;
+        default: goto usage;
+        }
+    }
+    if (optind != argc - 1) goto usage;
+
+    recs = REPLAY_Load(argv[optind], &count);
+    if (!recs) return 2;
+
+    for (start = 0; start < count; start++) {
+        if ((recs[start].type_axis & 0x0F) == RECORDER_REC_START) break;
+    }
+    if (start == count) {
+        fprintf(stderr, "No START record in %s (%lu records)\n", argv[optind], (unsigned long)count);
+        return 2;
+    }
+    rec = &recs[start];
+    if (rec->arg != RECORDER_FORMAT) {
+        fprintf(stderr, "Unsupported record format %u (expected %u)\n", rec->arg, RECORDER_FORMAT);
+        return 2;
+    }
+    osr = (uint16_t)(rec->b & 0xFFFF);
+    axes = (uint8_t)((rec->b >> 16) & 0xFF);
+    from_reset = (uint8_t)((rec->b >> 24) & 0x01);
+    tick_us = (uint16_t)rec->a;
+    if (axes == 0 || axes > ANGLE_CONTROL_AXIS_COUNT) {
+        fprintf(stderr, "Capture has %u axes, replay supports %u\n", axes, ANGLE_CONTROL_AXIS_COUNT);
+        return 2;
+    }
+    if (!from_reset && !force) {
+        fprintf(stderr, "Recording was started mid-run and cannot be replayed bit-exactly (use -F to try anyway)\n");
+        return 2;
+    }
+
+    if (out_path) {
+        csv = fopen(out_path, "w");
+        if (!csv) {
+            perror(out_path);
+            return 2;
+        }
+        fprintf(csv, "axis,ms,mode,state,left,right,applied,angle\n");
+    }
+    if (ref_path) {
+        ref = fopen(ref_path, "r");
+        if (!ref) {
+            perror(ref_path);
+            return 2;
+        }
+        if (!fgets(ref_row, sizeof(ref_row), ref)) ref_row[0] = '\0';
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    stats.start_ms = rec->c;
+    stats.end_ms = rec->c;
+    memset(rp_controls, 0, sizeof(rp_controls));
+    memset(rp_timestamp, 0, sizeof(rp_timestamp));
+
+    /* 固件打印默认屏蔽，-v时保留 */
+    fflush(stdout);
+    if (!verbose) {
+        saved_stdout = dup(STDOUT_FILENO);
+        devnull = open("/dev/null", O_WRONLY);
+        if (saved_stdout >= 0 && devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+            close(devnull);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    REPLAY_HwReset(osr);
+    while (ANGLE_CONTROL_GetTime() < rec->c) ANGLE_CONTROL_TimeUpdate();
+    for (axis = 0; axis < axes; axis++) {
+        ANGLE_CONTROL_Init(&rp_controls[axis], CONTROL_MODE_IDLE, &g_replay_fans[axis], &g_replay_sensors[axis]);
+    }
+    if (ANGLE_CONTROL_GetTickUs() != tick_us) {
+        fprintf(stderr, "Warning: control tick %u us in capture, %u us in this build\n",
+                tick_us, ANGLE_CONTROL_GetTickUs());
+    }
+
+    expect_seq = (uint8_t)(rec->seq + 1);
+    for (i = start + 1; i < count; i++) {
+        rec = &recs[i];
+        if (rec->seq != expect_seq) {
+            stop_reason = "sequence gap (lost lines)";
+            break;
+        }
+        expect_seq++;
+
+        switch (rec->type_axis & 0x0F) {
+        case RECORDER_REC_CMD:
+            if (rec->arg & RECORDER_CMD_NESTED) {
+                stats.nested++;
+            } else if (REPLAY_Command(rec)) {
+                stats.commands++;
+            } else {
+                fprintf(stderr, "Warning: unknown command %u skipped\n", rec->arg);
+            }
+            continue;
+
+        case RECORDER_REC_KEY:
+            stats.keys++;
+            continue;
+
+        case RECORDER_REC_TICK:
+            break;
+
+        case RECORDER_REC_GAP:
+            stop_reason = "GAP (recorder overflow)";
+            goto done;
+
+        case RECORDER_REC_START:
+            stop_reason = "second START";
+            goto done;
+
+        default:
+            stop_reason = "unexpected record";
+            goto done;
+        }
+
+        /* TICK [RPM] OUT 总是连续写入 */
+        tick = rec;
+        rpm = NULL;
+        if (i + 1 < count && (recs[i + 1].type_axis & 0x0F) == RECORDER_REC_RPM) {
+            rpm = &recs[++i];
+            if (rpm->seq != expect_seq++) {
+                stop_reason = "sequence gap (lost lines)";
+                break;
+            }
+        }
+        if (i + 1 >= count || (recs[i + 1].type_axis & 0x0F) != RECORDER_REC_OUT ||
+            recs[i + 1].seq != expect_seq) {
+            stop_reason = "truncated tick";
+            break;
+        }
+        out = &recs[++i];
+        expect_seq++;
+
+        axis = tick->type_axis >> 4;
+        if (axis >= axes) {
+            stop_reason = "record for unknown axis";
+            break;
+        }
+        if (tick->a < ANGLE_CONTROL_GetTime()) {
+            stop_reason = "time went backwards";
+            break;
+        }
+        while (ANGLE_CONTROL_GetTime() < tick->a) ANGLE_CONTROL_TimeUpdate();
+        g_replay_micros = (uint64_t)tick->a * 1000;
+
+        REPLAY_LoadInputs(tick, rpm);
+        ANGLE_CONTROL_Process(&rp_controls[axis]);
+        stats.ticks++;
+        stats.end_ms = tick->a;
+
+        diff = REPLAY_Compare(tick, out);
+        if (diff) {
+            if (stats.divergences == 0) {
+                fflush(stdout);
+                if (saved_stdout >= 0) dup2(saved_stdout, STDOUT_FILENO);
+                REPLAY_PrintDivergence(tick, out, diff);
+                fflush(stdout);
+                if (saved_stdout >= 0) {
+                    devnull = open("/dev/null", O_WRONLY);
+                    if (devnull >= 0) {
+                        dup2(devnull, STDOUT_FILENO);
+                        close(devnull);
+                    }
+                }
+            }
+            stats.divergences++;
+        }
+
+        snprintf(row, sizeof(row), "%u,%lu,%u,%u,%u,%u,%.9g,%.9g\n", axis, (unsigned long)tick->a,
+                 (unsigned)rp_controls[axis].mode, (unsigned)rp_controls[axis].state,
+                 g_replay_axes[axis].left, g_replay_axes[axis].right,
+                 rp_controls[axis].applied_input, rp_controls[axis].current_angle);
+        if (csv) fputs(row, csv);
+        if (ref) {
+            if (!fgets(ref_row, sizeof(ref_row), ref)) ref_row[0] = '\0';
+            if (strcmp(row, ref_row) != 0) {
+                if (stats.ref_diffs == 0) {
+                    fprintf(stderr, "First difference from %s:\n  ref:    %s  replay: %s", ref_path,
+                            ref_row[0] ? ref_row : "(end of file)\n", row);
+                }
+                stats.ref_diffs++;
+            }
+        }
+    }
+
+done:
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    fflush(stdout);
+    if (saved_stdout >= 0) {
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+    }
+    if (csv) fclose(csv);
+    if (ref) fclose(ref);
+    free(recs);
+
+    wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    printf("Replayed %lu ticks on %u axes, %lu commands (%lu nested skipped), %lu keys\n",
+           (unsigned long)stats.ticks, axes, (unsigned long)stats.commands,
+           (unsigned long)stats.nested, (unsigned long)stats.keys);
+    printf("Stopped at: %s\n", stop_reason);
+    printf("Simulated %.3f s in %.3f s wall (%.0fx)\n", (stats.end_ms - stats.start_ms) * 1e-3, wall,
+           (wall > 0.0) ? (stats.end_ms - stats.start_ms) * 1e-3 / wall : 0.0);
+    printf("Divergences from recorded output: %lu\n", (unsigned long)stats.divergences);
+    if (ref_path) {
+        printf("Differences from %s: %lu\n", ref_path, (unsigned long)stats.ref_diffs);
+    }
+    return (stats.divergences || stats.ref_diffs) ? 1 : 0;
+
+usage:
+    fprintf(stderr, "Usage: %s [-F] [-v] [-o out.csv] [-r ref.csv] capture.log\n"
+                    "  -F  replay a capture started mid-run\n"
+                    "  -v  show firmware printf output\n"
+                    "  -o  write per-tick results as CSV\n"
+                    "  -r  compare per-tick results with a CSV from an earlier replay\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file    replay.h
+  * @brief   控制环记录重放工具头文件(主机程序)
+  ******************************************************************************
+  */
+
+#ifndef __REPLAY_H
+#define __REPLAY_H
+
+#include "angle_control.h"
+#include "recorder.h"
+
+/* 每轴本周期的重放输入和主机侧观察到的调用/输出 */
+typedef struct {
+    /* 记录给出的输入 */
+    uint8_t faults;              // 传感器故障标志
+    uint8_t read;                // 读数方式(RECORDER_READ_x)
+    uint32_t angle;              // 角度读数原始位
+    uint64_t timestamp;          // 样本时间戳(us，由低32位展开)
+    uint8_t rpm_flags;           // RECORDER_RPM_x，右风扇左移3位
+    uint32_t rpm[FAN_COUNT];     // 转速(float位)
+
+    /* 主机侧实际发生的调用 */
+    uint8_t used_read;           // 实际读数方式
+    uint8_t used_rpm;            // 实际测速查询，格式同rpm_flags
+    uint8_t output;              // 1: 输出了风扇指令
+    uint8_t fine;                // 高分辨率输出
+    uint16_t left, right;        // 风扇指令
+} ReplayAxis_TypeDef;
+
+/* 重放硬件实例，数组下标即轴号 */
+extern FanDriver_TypeDef g_replay_fans[ANGLE_CONTROL_AXIS_COUNT];
+extern AngleSensor_TypeDef g_replay_sensors[ANGLE_CONTROL_AXIS_COUNT];
+extern Tach_TypeDef g_replay_tachs[ANGLE_CONTROL_AXIS_COUNT][FAN_COUNT];
+extern ReplayAxis_TypeDef g_replay_axes[ANGLE_CONTROL_AXIS_COUNT];
+extern uint16_t g_replay_osr;      // ANGLE_SENSOR_GetOversampling返回的过采样率
+extern uint64_t g_replay_micros;   // TIMEBASE_GetMicros返回的时间(us)
+
+/* 函数声明 */
+void REPLAY_HwReset(uint16_t osr);                                         // 复位重放硬件状态
+void REPLAY_HwBeginTick(uint8_t axis);                                    // 清除本周期的主机侧观察
+
+#endif /* __REPLAY_H */
@@ -0,0 +1,277 @@
+/**
+  ******************************************************************************
+  * @file    replay_hw.c
+  * @brief   重放用的硬件接口实现(主机程序)
+  ******************************************************************************
+  * angle_control.c读取的传感器、测速和时基接口返回记录中的原始值，
+  * 风扇接口只记下指令供比对。实例指针由g_replay_*数组换算为轴号。
+  * 主机侧发生了记录中没有的调用(读数方式或测速查询不同)时记在used_*中，
+  * 由replay.c判为分歧。
+  ******************************************************************************
+  */
+
+#include "replay.h"
+#include "timebase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+FanDriver_TypeDef g_replay_fans[ANGLE_CONTROL_AXIS_COUNT];
+AngleSensor_TypeDef g_replay_sensors[ANGLE_CONTROL_AXIS_COUNT];
+Tach_TypeDef g_replay_tachs[ANGLE_CONTROL_AXIS_COUNT][FAN_COUNT];
+ReplayAxis_TypeDef g_replay_axes[ANGLE_CONTROL_AXIS_COUNT];
+uint16_t g_replay_osr;
+uint64_t g_replay_micros;
+
+/**
+  * @brief  复位重放硬件状态
+  * @param  osr: 记录开始时的过采样率
+  * @retval 无
+  */
+void REPLAY_HwReset(uint16_t osr)
+{
+    memset(g_replay_fans, 0, sizeof(g_replay_fans));
+    memset(g_replay_sensors, 0, sizeof(g_replay_sensors));
+    memset(g_replay_tachs, 0, sizeof(g_replay_tachs));
+    memset(g_replay_axes, 0, sizeof(g_replay_axes));
+    g_replay_osr = osr;
+    g_replay_micros = 0;
+}
+
+/**
+  * @brief  清除本周期的主机侧观察
+  * @param  axis: 轴号
+  * @retval 无
+  */
+void REPLAY_HwBeginTick(uint8_t axis)
+{
+    ReplayAxis_TypeDef *ax = &g_replay_axes[axis];
+
+    ax->used_read = RECORDER_READ_NONE;
+    ax->used_rpm = 0;
+    ax->output = 0;
+    ax->fine = 0;
+    ax->left = 0;
+    ax->right = 0;
+}
+
+/* 实例指针 -> 轴号 */
+static ReplayAxis_TypeDef *REPLAY_FanAxis(FanDriver_TypeDef *drv)
+{
+    return &g_replay_axes[drv - g_replay_fans];
+}
+
+static ReplayAxis_TypeDef *REPLAY_SensorAxis(AngleSensor_TypeDef *sensor)
+{
+    return &g_replay_axes[sensor - g_replay_sensors];
+}
+
+static ReplayAxis_TypeDef *REPLAY_TachAxis(Tach_TypeDef *tach, uint8_t *fan)
+{
+    size_t index = tach - &g_replay_tachs[0][0];
+
+    *fan = (uint8_t)(index % FAN_COUNT);
+    return &g_replay_axes[index / FAN_COUNT];
+}
+
+/* ---------------------------- 风扇驱动 ---------------------------- */
+
+void FAN_StopAll(FanDriver_TypeDef *drv)
+{
+}
+
+void FAN_SoftStopAll(FanDriver_TypeDef *drv)
+{
+}
+
+void FAN_SetRamp(FanDriver_TypeDef *drv, float accel, float decel)
+{
+}
+
+void FAN_ArmRamp(FanDriver_TypeDef *drv)
+{
+}
+
+void FAN_StageSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint8_t speed)
+{
+    ReplayAxis_TypeDef *ax = REPLAY_FanAxis(drv);
+
+    ax->output = 1;
+    ax->fine = 0;
+    if (fan == FAN_LEFT) ax->left = speed; else ax->right = speed;
+}
+
+void FAN_StageThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t thrust)
+{
+    ReplayAxis_TypeDef *ax = REPLAY_FanAxis(drv);
+
+    ax->output = 1;
+    ax->fine = 1;
+    if (fan == FAN_LEFT) ax->left = thrust; else ax->right = thrust;
+}
+
+void FAN_StageDirection(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, FanDirection_TypeDef direction)
+{
+}
+
+void FAN_Commit(FanDriver_TypeDef *drv)
+{
+}
+
+void FAN_EnableDither(FanDriver_TypeDef *drv, uint8_t enable)
+{
+}
+
+void FAN_ClearFault(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+}
+
+uint32_t FAN_GetPwmFrequency(FanDriver_TypeDef *drv)
+{
+    return FAN_PWM_FREQ;
+}
+
+uint8_t FAN_GetResolutionBits(FanDriver_TypeDef *drv)
+{
+    return FAN_PWM_MIN_BITS;
+}
+
+/* ---------------------------- 角度传感器 ---------------------------- */
+
+uint8_t ANGLE_SENSOR_GetFault(AngleSensor_TypeDef *sensor)
+{
+    return REPLAY_SensorAxis(sensor)->faults;
+}
+
+float ANGLE_SENSOR_GetAngleAt(AngleSensor_TypeDef *sensor, uint64_t *timestamp)
+{
+    ReplayAxis_TypeDef *ax = REPLAY_SensorAxis(sensor);
+    float angle;
+
+    ax->used_read = RECORDER_READ_FLOAT;
+    if (ax->read != RECORDER_READ_FLOAT) return 0.0f;
+    memcpy(&angle, &ax->angle, sizeof(angle));
+    *timestamp = ax->timestamp;
+    return angle;
+}
+
+AngleSensorStatus_TypeDef ANGLE_SENSOR_GetAngleQ16(AngleSensor_TypeDef *sensor, int32_t *angle_q16,
+                                                   uint64_t *timestamp)
+{
+    ReplayAxis_TypeDef *ax = REPLAY_SensorAxis(sensor);
+
+    ax->used_read = RECORDER_READ_Q16;
+    *timestamp = ax->timestamp;
+    if (ax->read & RECORDER_READ_FAILED) {
+        ax->used_read |= RECORDER_READ_FAILED;
+        return ANGLE_SENSOR_TIMEOUT;
+    }
+    *angle_q16 = (int32_t)ax->angle;
+    return ANGLE_SENSOR_OK;
+}
+
+/* 估计器的块接口在控制环中不使用，调用即说明固件路径与记录格式不符 */
+int32_t ANGLE_SENSOR_RawToAngleQ16(AngleSensor_TypeDef *sensor, uint32_t adc_sum, uint8_t count)
+{
+    fprintf(stderr, "replay: ANGLE_SENSOR_RawToAngleQ16 is not recorded\n");
+    exit(2);
+}
+
+void ANGLE_SENSOR_SetOffset(AngleSensor_TypeDef *sensor, float offset_angle)
+{
+    sensor->offset = offset_angle;
+    sensor->offset_q16 = (int32_t)(offset_angle * 65536.0f);
+}
+
+float ANGLE_SENSOR_GetOffset(AngleSensor_TypeDef *sensor)
+{
+    return sensor->offset;
+}
+
+uint16_t ANGLE_SENSOR_GetOversampling(void)
+{
+    return g_replay_osr;
+}
+
+/* 过采样率由LOOP_RATE记录给出，重放前已写入g_replay_osr */
+uint8_t ANGLE_SENSOR_FitOversampling(uint32_t period_us)
+{
+    uint8_t osr_log2 = 0;
+
+    while ((1U << (osr_log2 + 1)) <= g_replay_osr) osr_log2++;
+    return osr_log2;
+}
+
+/* ---------------------------- 测速/电流 ---------------------------- */
+
+void TACH_Update(Tach_TypeDef *tach, uint16_t now)
+{
+}
+
+uint16_t TACH_GetCounter(Tach_TypeDef *tach)
+{
+    return 0;
+}
+
+uint8_t TACH_IsStalled(Tach_TypeDef *tach)
+{
+    uint8_t fan;
+    ReplayAxis_TypeDef *ax = REPLAY_TachAxis(tach, &fan);
+
+    ax->used_rpm |= RECORDER_RPM_QUERIED << (3 * fan);
+    if (ax->rpm_flags & (RECORDER_RPM_STALLED << (3 * fan))) {
+        ax->used_rpm |= RECORDER_RPM_STALLED << (3 * fan);
+        return 1;
+    }
+    return 0;
+}
+
+float TACH_GetRpm(Tach_TypeDef *tach)
+{
+    uint8_t fan;
+    ReplayAxis_TypeDef *ax = REPLAY_TachAxis(tach, &fan);
+    float rpm;
+
+    ax->used_rpm |= RECORDER_RPM_READ << (3 * fan);
+    memcpy(&rpm, &ax->rpm[fan], sizeof(rpm));
+    return rpm;
+}
+
+void CURRENT_SENSE_Update(CurrentSense_TypeDef *cs)
+{
+}
+
+/* ---------------------------- 时基 ---------------------------- */
+
+uint32_t TIMEBASE_GetCycles(void)
+{
+    return (uint32_t)(g_replay_micros * 72);
+}
+
+uint64_t TIMEBASE_GetMicros(void)
+{
+    return g_replay_micros;
+}
+
+/* ---------------------------- 参数存储 ---------------------------- */
+
+/* 上电加载的参数已作为接口调用记录，重放时不再读取 */
+ParamStatus_TypeDef PARAM_Get(uint16_t key, void *data, uint16_t len)
+{
+    return PARAM_NOT_FOUND;
+}
+
+ParamStatus_TypeDef PARAM_GetVar(uint16_t key, void *data, uint16_t size, uint16_t *len)
+{
+    return PARAM_NOT_FOUND;
+}
+
+ParamStatus_TypeDef PARAM_Set(uint16_t key, const void *data, uint16_t len)
+{
+    return PARAM_OK;
+}
+
+ParamStatus_TypeDef PARAM_Delete(uint16_t key)
+{
+    return PARAM_OK;
+}
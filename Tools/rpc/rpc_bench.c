@@ -0,0 +1,497 @@
+/**
+  ******************************************************************************
+  * @file    rpc_bench.c
+  * @brief   RPC往返延迟和流水线吞吐测试(主机程序)
+  ******************************************************************************
+  * 默认在pty上启动模拟设备：子进程运行固件的Algorithm/rpc.c和角度控制模块，
+  * 控制对象为Tools/sim的板子模型，按实时推进；主循环照main.c的节奏
+  * (处理完收到的帧后延时-l ms)，发送按-b波特率折算阻塞时间(固件fputc是阻塞发送)，
+  * 接收按波特率限制每次可取的字节数。pty的内核缓冲代替DMA环形缓冲，不模拟溢出。
+  * -d指定串口时直接测真实设备。
+  *
+  * 测试项：
+  *   1. INFO核对协议版本
+  *   2. 逐个PING(8字节负载)的往返延迟分布
+  *   3. 不同流水线深度下GET_PARAM的吞吐(请求/s)和平均往返时间
+  *   4. SET_PARAM/GET_PARAM读回核对、错误状态码
+  *   5. 流式上传比固件缓冲长的序列程序(含WAIT_KEY)，核对执行完成
+  * 任一项失败返回1。
+  *
+  * 编译(在仓库根目录)：
+  *   gcc -std=gnu99 -O2 -ITools/sim/host -ITools/sim -ITools/rpc -IAlgorithm -IHardware/angle_sensor \
+  *       -IHardware/fan_driver -IHardware/tach -IHardware/current_sense -IHardware/param_store \
+  *       -ISYSTEM/timebase -ISYSTEM/delay -ISYSTEM/sys -DSystemCoreClock=72000000UL \
+  *       Tools/rpc/rpc_bench.c Tools/rpc/rpc_client.c Algorithm/rpc_codec.c Algorithm/rpc.c \
+  *       Tools/sim/sim_panel.c Tools/sim/sim_hw.c \
+  *       Algorithm/angle_control.c Algorithm/pid_controller.c Algorithm/angle_estimator.c \
+  *       Algorithm/mpc_controller.c Algorithm/control_allocation.c Algorithm/system_ident.c \
+  *       Algorithm/stability_detector.c Algorithm/sequence_engine.c Algorithm/recorder.c -lm -o rpc_bench
+  *
+  * 用法：
+  *   rpc_bench [-d 串口] [-b 波特率] [-l 主循环周期ms] [-n 请求数] [-w 最大流水线深度] [-t 超时ms]
+  *   rpc_bench -S [-b 波特率] [-l 主循环周期ms]   只运行模拟设备，打印pty路径供其他工具连接
+  *   模拟设备的-b为0时不限速
+  ******************************************************************************
+  */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "rpc_client.h"
+#include "rpc.h"
+#include "sim_panel.h"
+
+#define SD_FRAME_LEN         128       // 帧缓冲字节数，与USART_FRAME_LEN一致
+#define BENCH_PROG_MOVES     48        // 流式程序的MOVE+DELAY对数，总步数约为固件缓冲的3倍
+
+/* 测试配置 */
+typedef struct {
+    const char *device;          // 串口，NULL使用模拟设备
+    uint32_t baud;               // 波特率
+    uint32_t loop_ms;            // 模拟设备主循环延时(ms)
+    uint32_t count;              // 每项请求数
+    uint16_t window;             // 最大流水线深度
+    int timeout_ms;              // 单个请求超时
+} BenchConfig_TypeDef;
+
+/* 一项测试的结果 */
+typedef struct {
+    uint32_t done;               // 收到应答的请求数
+    uint32_t lost;               // 超时的请求数
+    uint64_t elapsed_us;         // 总耗时
+    uint64_t *rtt;               // 各请求往返时间(us)
+} BenchResult_TypeDef;
+
+/* 模拟设备 */
+static AngleControl_TypeDef sd_control;
+static FanDriver_TypeDef sd_fan;
+static AngleSensor_TypeDef sd_sensor;
+static int sd_fd = -1;
+static uint64_t sd_tx_bytes;
+
+/* ---------------------------- 模拟设备 ---------------------------- */
+
+/* stdout写到pty并计数，rpc.c经putchar发送 */
+static ssize_t SD_Write(void *cookie, const char *buf, size_t len)
+{
+    size_t done = 0;
+    ssize_t n;
+
+    while (done < len) {
+        n = write(sd_fd, buf + done, len - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    sd_tx_bytes += len;
+    return (ssize_t)len;
+}
+
+static void SD_SleepUs(uint64_t us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(us / 1000000ULL);
+    ts.tv_nsec = (long)(us % 1000000ULL) * 1000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+/**
+  * @brief  运行模拟设备，直到对端关闭
+  * @param  fd: pty一端(已设为原始、非阻塞模式)
+  * @param  baud: 折算收发时间的波特率，0不限速
+  * @param  loop_ms: 主循环每次的延时(ms)
+  * @retval 无
+  */
+static void SD_Run(int fd, uint32_t baud, uint32_t loop_ms)
+{
+    static uint8_t frame[SD_FRAME_LEN];
+    cookie_io_functions_t io = { NULL, SD_Write, NULL, NULL };
+    SimScenario_TypeDef scenario;
+    uint64_t start, now, next_ms = 1000, next_tick, rx_credit_us = 0, last;
+    uint16_t frame_len = 0;
+    uint8_t in_frame = 0, overflow = 0;
+    uint8_t buf[256];
+    size_t budget;
+    ssize_t n, i;
+
+    sd_fd = fd;
+    stdout = fopencookie(NULL, "w", io);
+    setvbuf(stdout, NULL, _IOFBF, 4096);
+
+    SIM_ScenarioNominal(&scenario);
+    SIM_Reset(&scenario, 1);
+    ANGLE_CONTROL_Init(&sd_control, CONTROL_MODE_IDLE, &sd_fan, &sd_sensor);
+    RPC_Init(&sd_control, 1);
+    fflush(stdout);
+    next_tick = ANGLE_CONTROL_GetTickUs();
+
+    start = RPC_ClientMicros();
+    last = start;
+    for (;;) {
+        /* 板子模型和控制中断追上实时 */
+        now = RPC_ClientMicros() - start;
+        while (g_sim.time_us < now) {
+            SIM_Step(SIM_STEP_US);
+            if (g_sim.time_us >= next_ms) {
+                ANGLE_CONTROL_TimeUpdate();
+                next_ms += 1000;
+            }
+            if (g_sim.time_us >= next_tick) {
+                next_tick += ANGLE_CONTROL_GetTickUs();
+                ANGLE_CONTROL_Process(&sd_control);
+            }
+        }
+
+        sd_tx_bytes = 0;
+
+        /* 串口接收：上次以来线路上最多能到达的字节数 */
+        rx_credit_us += RPC_ClientMicros() - last;
+        last = RPC_ClientMicros();
+        budget = baud ? (size_t)(rx_credit_us * baud / 10000000ULL) : sizeof(buf);
+        if (budget > sizeof(buf)) budget = sizeof(buf);
+        n = (budget > 0) ? read(fd, buf, budget) : 0;
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EINTR) break;   // EIO: 主机关闭了pty
+            n = 0;
+        }
+        if (baud) {
+            rx_credit_us -= (uint64_t)n * 10000000ULL / baud;
+            if (n < (ssize_t)budget) rx_credit_us = 0;  // 线路空闲，不累积
+        }
+
+        /* 分帧同USART_RxService，文本行忽略 */
+        for (i = 0; i < n; i++) {
+            if (buf[i] == 0x00) {
+                if (in_frame && overflow) {
+                    in_frame = 0;
+                } else if (in_frame && frame_len > 0) {
+                    RPC_Handle(frame, frame_len);
+                    in_frame = 0;
+                } else {
+                    in_frame = 1;
+                }
+                frame_len = 0;
+                overflow = 0;
+            } else if (in_frame) {
+                if (frame_len < sizeof(frame)) frame[frame_len++] = buf[i];
+                else overflow = 1;
+            }
+        }
+
+        RPC_Process();
+        fflush(stdout);
+
+        /* 阻塞发送的耗时加主循环延时 */
+        SD_SleepUs((baud ? sd_tx_bytes * 10000000ULL / baud : 0) + (uint64_t)loop_ms * 1000ULL);
+    }
+}
+
+/**
+  * @brief  创建原始模式的pty
+  * @param  master: 输出主端描述符
+  * @param  slave: 输出从端描述符
+  * @param  slave_name: 输出从端路径
+  * @param  name_len: slave_name字节数
+  * @retval int: 0成功，-1失败
+  */
+static int SD_OpenPty(int *master, int *slave, char *slave_name, size_t name_len)
+{
+    struct termios tio;
+
+    *master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (*master < 0 || grantpt(*master) != 0 || unlockpt(*master) != 0) return -1;
+    snprintf(slave_name, name_len, "%s", ptsname(*master));
+    *slave = open(slave_name, O_RDWR | O_NOCTTY);
+    if (*slave < 0) return -1;
+
+    /* 两端都不做换行转换和回显 */
+    tcgetattr(*slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*slave, TCSANOW, &tio);
+    tcgetattr(*master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*master, TCSANOW, &tio);
+    return 0;
+}
+
+/**
+  * @brief  创建pty并在子进程中启动模拟设备
+  * @param  cfg: 测试配置
+  * @param  pid: 输出子进程号
+  * @param  slave_name: 输出从端路径
+  * @param  name_len: slave_name字节数
+  * @retval int: 主端描述符，-1失败
+  */
+static int SD_Spawn(const BenchConfig_TypeDef *cfg, pid_t *pid, char *slave_name, size_t name_len)
+{
+    int master, slave;
+
+    if (SD_OpenPty(&master, &slave, slave_name, name_len) != 0) return -1;
+    fflush(stdout);
+    *pid = fork();
+    if (*pid < 0) return -1;
+    if (*pid == 0) {
+        close(master);
+        fcntl(slave, F_SETFL, fcntl(slave, F_GETFL) | O_NONBLOCK);
+        SD_Run(slave, cfg->baud, cfg->loop_ms);
+        _exit(0);
+    }
+    close(slave);
+    return master;
+}
+
+/* ---------------------------- 测试 ---------------------------- */
+
+static int BENCH_CompareU64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+  * @brief  以固定流水线深度发送count个请求，收齐应答或超时
+  * @param  c: 客户端
+  * @param  op: 操作码
+  * @param  body: 消息体
+  * @param  len: 消息体字节数
+  * @param  window: 流水线深度
+  * @param  count: 请求数
+  * @param  timeout_ms: 单个请求超时
+  * @param  result: 输出结果，rtt须有count个元素
+  * @retval 无
+  */
+static void BENCH_Run(RpcClient_TypeDef *c, uint8_t op, const uint8_t *body, uint16_t len,
+                      uint16_t window, uint32_t count, int timeout_ms, BenchResult_TypeDef *result)
+{
+    RpcReply_TypeDef reply;
+    uint64_t start = RPC_ClientMicros();
+    uint32_t sent = 0;
+    int r;
+
+    result->done = 0;
+    result->lost = 0;
+    while (result->done + result->lost < count) {
+        while (sent < count && c->outstanding < window) {
+            if (RPC_ClientSend(c, op, body, len) < 0) break;
+            sent++;
+        }
+        r = RPC_ClientReceive(c, &reply, 5);
+        if (r < 0) break;
+        if (r == 1 && reply.is_response && reply.op == op) {
+            result->rtt[result->done++] = reply.rtt_us;
+        }
+        result->lost += RPC_ClientExpire(c, (uint32_t)timeout_ms);
+    }
+    result->elapsed_us = RPC_ClientMicros() - start;
+    qsort(result->rtt, result->done, sizeof(result->rtt[0]), BENCH_CompareU64);
+}
+
+/* 排好序的往返时间的百分位(us) */
+static uint64_t BENCH_Percentile(const BenchResult_TypeDef *result, uint32_t percent)
+{
+    uint32_t index;
+
+    if (result->done == 0) return 0;
+    index = (uint32_t)(((uint64_t)result->done * percent + 99) / 100);
+    if (index > 0) index--;
+    return result->rtt[index];
+}
+
+static void BENCH_Usage(void)
+{
+    fprintf(stderr,
+            "usage: rpc_bench [-d device] [-b baud] [-l loop_ms] [-n count] [-w window] [-t timeout_ms]\n"
+            "       rpc_bench -S [-b baud] [-l loop_ms]    run the simulated device only\n");
+}
+
+int main(int argc, char **argv)
+{
+    BenchConfig_TypeDef cfg;
+    RpcClient_TypeDef client;
+    RpcReply_TypeDef reply;
+    BenchResult_TypeDef result;
+    uint8_t body[8];
+    uint8_t prog[(BENCH_PROG_MOVES * 2 + 2) * RPC_STEP_LEN];
+    uint32_t bits, steps;
+    uint64_t deadline;
+    uint64_t sum;
+    uint32_t i;
+    uint16_t window;
+    pid_t pid = -1;
+    char slave_name[64];
+    int fd, slave, opt, status, failed = 0, serve_only = 0;
+    float kp;
+
+    cfg.device = NULL;
+    cfg.baud = 115200;
+    cfg.loop_ms = 10;
+    cfg.count = 200;
+    cfg.window = 16;
+    cfg.timeout_ms = 500;
+
+    while ((opt = getopt(argc, argv, "d:b:l:n:w:t:Sh")) != -1) {
+        switch (opt) {
+        case 'd': cfg.device = optarg; break;
+        case 'b': cfg.baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'l': cfg.loop_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'n': cfg.count = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'w': cfg.window = (uint16_t)strtoul(optarg, NULL, 0); break;
+        case 't': cfg.timeout_ms = atoi(optarg); break;
+        case 'S': serve_only = 1; break;
+        default: BENCH_Usage(); return 2;
+        }
+    }
+    if (cfg.count == 0 || cfg.window == 0 || cfg.window > RPC_CLIENT_IDS) {
+        BENCH_Usage();
+        return 2;
+    }
+
+    if (cfg.device) {
+        if (RPC_ClientOpen(&client, cfg.device, cfg.baud) != 0) {
+            fprintf(stderr, "rpc_bench: %s: %s\n", cfg.device, strerror(errno));
+            return 2;
+        }
+        printf("device %s, %lu baud\n", cfg.device, (unsigned long)cfg.baud);
+    } else if (serve_only) {
+        /* 设备在主端，其他工具打开从端；本进程保持从端打开，没有客户端时读主端不会出错 */
+        if (SD_OpenPty(&fd, &slave, slave_name, sizeof(slave_name)) != 0) {
+            fprintf(stderr, "rpc_bench: pty: %s\n", strerror(errno));
+            return 2;
+        }
+        printf("simulated device on %s (%lu baud, loop %lu ms), Ctrl-C to stop\n", slave_name,
+               (unsigned long)cfg.baud, (unsigned long)cfg.loop_ms);
+        fflush(stdout);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        SD_Run(fd, cfg.baud, cfg.loop_ms);
+        return 0;
+    } else {
+        fd = SD_Spawn(&cfg, &pid, slave_name, sizeof(slave_name));
+        if (fd < 0) {
+            fprintf(stderr, "rpc_bench: pty: %s\n", strerror(errno));
+            return 2;
+        }
+        RPC_ClientAttach(&client, fd);
+        printf("simulated device on %s, %lu baud%s, main loop %lu ms\n", slave_name,
+               (unsigned long)cfg.baud, cfg.baud ? "" : " (unlimited)", (unsigned long)cfg.loop_ms);
+    }
+
+    result.rtt = malloc(sizeof(uint64_t) * cfg.count);
+    if (result.rtt == NULL) return 2;
+
+    /* 1. 协议版本 */
+    status = RPC_ClientCall(&client, RPC_OP_INFO, NULL, 0, &reply, cfg.timeout_ms * 4);
+    if (status != RPC_STATUS_OK || reply.len < RPC_INFO_LEN) {
+        printf("INFO: no answer\n");
+        failed = 1;
+        goto done;
+    }
+    printf("INFO: protocol %d, %d axes, tick %u us, body max %d\n", reply.data[RPC_INFO_VERSION],
+           reply.data[RPC_INFO_AXES], RPC_GetU16(&reply.data[RPC_INFO_TICK_US]), reply.data[RPC_INFO_BODY_MAX]);
+    if (reply.data[RPC_INFO_VERSION] != RPC_PROTOCOL_VERSION) {
+        printf("INFO: protocol version mismatch (host %d)\n", RPC_PROTOCOL_VERSION);
+        failed = 1;
+        goto done;
+    }
+
+    /* 2. 往返延迟 */
+    for (i = 0; i < sizeof(body); i++) body[i] = (uint8_t)(i * 37);   // 含0x00，检查COBS
+    BENCH_Run(&client, RPC_OP_PING, body, sizeof(body), 1, cfg.count, cfg.timeout_ms, &result);
+    for (sum = 0, i = 0; i < result.done; i++) sum += result.rtt[i];
+    printf("\nPING x%lu (window 1): lost %lu, rtt us min %llu p50 %llu avg %llu p99 %llu max %llu\n",
+           (unsigned long)cfg.count, (unsigned long)result.lost,
+           (unsigned long long)BENCH_Percentile(&result, 0), (unsigned long long)BENCH_Percentile(&result, 50),
+           (unsigned long long)(result.done ? sum / result.done : 0),
+           (unsigned long long)BENCH_Percentile(&result, 99), (unsigned long long)BENCH_Percentile(&result, 100));
+    if (result.lost) failed = 1;
+
+    /* 3. 流水线吞吐 */
+    body[0] = 0;
+    RPC_PutU16(&body[1], RPC_PARAM_ANGLE);
+    printf("\nGET_PARAM x%lu:\n  window   req/s   avg rtt us   p99 rtt us   lost\n", (unsigned long)cfg.count);
+    for (window = 1; ; window = (uint16_t)(window * 2)) {
+        if (window > cfg.window) window = cfg.window;
+        BENCH_Run(&client, RPC_OP_GET_PARAM, body, 3, window, cfg.count, cfg.timeout_ms, &result);
+        for (sum = 0, i = 0; i < result.done; i++) sum += result.rtt[i];
+        printf("  %6u %7.0f %12llu %12llu %6lu\n", window,
+               result.elapsed_us ? result.done * 1e6 / (double)result.elapsed_us : 0.0,
+               (unsigned long long)(result.done ? sum / result.done : 0),
+               (unsigned long long)BENCH_Percentile(&result, 99), (unsigned long)result.lost);
+        if (result.lost) failed = 1;
+        if (window == cfg.window) break;
+    }
+
+    /* 4. 读写核对和错误状态 */
+    kp = 1.25f;
+    memcpy(&bits, &kp, sizeof(bits));
+    status = RPC_ClientSetParam(&client, 0, RPC_PARAM_KP, bits, cfg.timeout_ms);
+    bits = 0;
+    if (status == RPC_STATUS_OK) status = RPC_ClientGetParam(&client, 0, RPC_PARAM_KP, &bits, cfg.timeout_ms);
+    memcpy(&kp, &bits, sizeof(kp));
+    printf("\nSET/GET kp: %s, read back %.3f\n", status < 0 ? "timeout" : RPC_ClientStatusName((uint8_t)status), kp);
+    if (status != RPC_STATUS_OK || kp != 1.25f) failed = 1;
+    status = RPC_ClientSetParam(&client, 0, RPC_PARAM_ANGLE, 0, cfg.timeout_ms);
+    printf("SET angle: %s (expect read only)\n", status < 0 ? "timeout" : RPC_ClientStatusName((uint8_t)status));
+    if (status != RPC_STATUS_READ_ONLY) failed = 1;
+    status = RPC_ClientGetParam(&client, 0, 0x7FFF, &bits, cfg.timeout_ms);
+    printf("GET 0x7FFF: %s (expect bad param)\n", status < 0 ? "timeout" : RPC_ClientStatusName((uint8_t)status));
+    if (status != RPC_STATUS_BAD_PARAM) failed = 1;
+
+    /* 5. 流式序列程序：允许误差取大值，每步只看保持时间 */
+    for (steps = 0, i = 0; i < BENCH_PROG_MOVES; i++) {
+        RPC_ClientPutStep(&prog[steps++ * RPC_STEP_LEN], SEQ_OP_MOVE, SEQ_RAMP_STEP,
+                          (int16_t)((i & 1) ? -1000 : 1000), 9000, 0, 20);
+        RPC_ClientPutStep(&prog[steps++ * RPC_STEP_LEN], SEQ_OP_DELAY, 0, 0, 0, 0, 10);
+    }
+    RPC_ClientPutStep(&prog[steps++ * RPC_STEP_LEN], SEQ_OP_WAIT_KEY, 0, 0, 0, 0, 0);
+    RPC_ClientPutStep(&prog[steps++ * RPC_STEP_LEN], SEQ_OP_END, 0, 0, 0, 0, 0);
+    status = RPC_ClientUpload(&client, 0, prog, steps, 1, cfg.timeout_ms * 4);
+    printf("\nPROG stream %lu steps: upload %s", (unsigned long)steps,
+           status < 0 ? "timeout" : RPC_ClientStatusName((uint8_t)status));
+    if (status != RPC_STATUS_OK) failed = 1;
+
+    /* 等到WAIT_KEY，按键后等到结束 */
+    deadline = RPC_ClientMicros() + 5000000;
+    body[0] = 0;
+    body[1] = 1;
+    while (status == RPC_STATUS_OK && RPC_ClientMicros() < deadline) {
+        status = RPC_ClientCall(&client, RPC_OP_PROG_STATUS, body, 1, &reply, cfg.timeout_ms);
+        if (status != RPC_STATUS_OK || reply.len != RPC_PROG_LEN) break;
+        if (reply.data[RPC_PROG_STATE] != SEQ_STATE_RUNNING && reply.data[RPC_PROG_STATE] != SEQ_STATE_STARVED) break;
+        if (reply.data[RPC_PROG_PHASE] == SEQ_PHASE_KEY) {
+            RPC_ClientCall(&client, RPC_OP_PROG_KEY, body, 2, &reply, cfg.timeout_ms);
+        }
+        usleep(20000);
+    }
+    printf(", final state %d at step %lu\n", reply.data[RPC_PROG_STATE],
+           (unsigned long)RPC_GetU32(&reply.data[RPC_PROG_PC]));
+    if (status != RPC_STATUS_OK || reply.data[RPC_PROG_STATE] != SEQ_STATE_DONE ||
+        RPC_GetU32(&reply.data[RPC_PROG_PC]) != steps - 1) {
+        failed = 1;
+    }
+
+done:
+    printf("\nbad frames %lu, stray %lu, expired %lu, text bytes %lu\n", (unsigned long)client.bad_frames,
+           (unsigned long)client.stray, (unsigned long)client.expired, (unsigned long)client.text_bytes);
+    free(result.rtt);
+    RPC_ClientClose(&client);
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+    }
+    printf("%s\n", failed ? "FAILED" : "OK");
+    return failed;
+}
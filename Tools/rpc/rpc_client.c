@@ -0,0 +1,480 @@
+/**
+  ******************************************************************************
+  * @file    rpc_client.c
+  * @brief   二进制RPC客户端库实现(Linux主机程序)
+  ******************************************************************************
+  * 只用POSIX接口(termios/poll)，不开线程；流水线由调用者交替调用
+  * RPC_ClientSend和RPC_ClientReceive实现，深度受固件接收环形缓冲限制(见Algorithm/rpc.h)。
+  * 丢帧不会重发：调用者用RPC_ClientExpire回收超时的请求号后自行决定是否重发。
+  ******************************************************************************
+  */
+
+#include "rpc_client.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define RPC_PARAM_NAME(name, id, type, access, text) { text, id, type, access },
+static const RpcParamName_TypeDef rc_params[] = {
+    RPC_PARAM_TABLE(RPC_PARAM_NAME)
+};
+#undef RPC_PARAM_NAME
+
+#define RC_PARAM_COUNT (sizeof(rc_params) / sizeof(rc_params[0]))
+
+/* 私有函数声明 */
+static void RC_Reset(RpcClient_TypeDef *c, int fd);
+static int RC_WriteAll(int fd, const uint8_t *data, size_t len);
+static int RC_FeedByte(RpcClient_TypeDef *c, uint8_t byte, RpcReply_TypeDef *reply);
+static int RC_Deliver(RpcClient_TypeDef *c, RpcReply_TypeDef *reply);
+
+uint64_t RPC_ClientMicros(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+/**
+  * @brief  打开串口并设为原始模式
+  * @param  c: 客户端
+  * @param  path: 设备路径
+  * @param  baud: 波特率(termios支持的标准值)
+  * @retval int: 0成功，-1失败(errno有效)
+  */
+int RPC_ClientOpen(RpcClient_TypeDef *c, const char *path, uint32_t baud)
+{
+    static const struct { uint32_t baud; speed_t speed; } bauds[] = {
+        { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+        { 115200, B115200 }, { 230400, B230400 }, { 460800, B460800 }, { 921600, B921600 },
+    };
+    struct termios tio;
+    size_t i;
+    int fd;
+
+    for (i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) {
+        if (bauds[i].baud == baud) break;
+    }
+    if (i == sizeof(bauds) / sizeof(bauds[0])) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) return -1;
+    if (tcgetattr(fd, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CRTSCTS;
+    cfsetispeed(&tio, bauds[i].speed);
+    cfsetospeed(&tio, bauds[i].speed);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    RC_Reset(c, fd);
+    return 0;
+}
+
+/**
+  * @brief  使用已打开的描述符(pty、socket等，须已是原始模式)
+  */
+void RPC_ClientAttach(RpcClient_TypeDef *c, int fd)
+{
+    RC_Reset(c, fd);
+}
+
+void RPC_ClientClose(RpcClient_TypeDef *c)
+{
+    if (c->fd >= 0) close(c->fd);
+    c->fd = -1;
+}
+
+/**
+  * @brief  发出请求，不等应答
+  * @param  c: 客户端
+  * @param  op: 操作码
+  * @param  body: 消息体
+  * @param  len: 消息体字节数
+  * @retval int: 分配的请求号，-1表示请求号用尽、消息过长或写失败
+  */
+int RPC_ClientSend(RpcClient_TypeDef *c, uint8_t op, const uint8_t *body, uint16_t len)
+{
+    uint8_t frame[RPC_FRAME_MAX];
+    uint16_t n, tries;
+    uint8_t id;
+
+    if (c->outstanding >= RPC_CLIENT_IDS) return -1;
+
+    /* 轮流使用请求号，跳过等待中的，迟到的旧应答不会被当成新请求的应答 */
+    for (tries = 0; tries < 256; tries++) {
+        id = c->next_id;
+        c->next_id = (uint8_t)(c->next_id + 1);
+        if (c->next_id == RPC_ID_EVENT) c->next_id = 1;
+        if (id != RPC_ID_EVENT && !c->pending[id]) break;
+    }
+
+    n = RPC_BuildFrame(id, op, body, len, frame);
+    if (n == 0) return -1;
+    c->sent_us[id] = RPC_ClientMicros();   // 写之前取时刻，写后被调度出去时往返时间不会偏小
+    if (RC_WriteAll(c->fd, frame, n) != 0) return -1;
+
+    c->pending[id] = 1;
+    c->outstanding++;
+    return id;
+}
+
+/**
+  * @brief  接收一条应答或上报
+  * @param  c: 客户端
+  * @param  reply: 输出消息
+  * @param  timeout_ms: 超时(ms)，0只处理已到达的数据，负数一直等
+  * @retval int: 1收到，0超时，-1读出错或对端关闭
+  */
+int RPC_ClientReceive(RpcClient_TypeDef *c, RpcReply_TypeDef *reply, int timeout_ms)
+{
+    uint64_t deadline = RPC_ClientMicros() + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0) * 1000ULL;
+    struct pollfd pfd;
+    uint64_t now;
+    ssize_t n;
+    int wait_ms;
+
+    for (;;) {
+        while (c->in_pos < c->in_len) {
+            if (RC_FeedByte(c, c->in[c->in_pos++], reply)) return 1;
+        }
+
+        if (timeout_ms < 0) {
+            wait_ms = -1;
+        } else {
+            now = RPC_ClientMicros();
+            wait_ms = (now >= deadline) ? 0 : (int)((deadline - now + 999) / 1000);
+        }
+        pfd.fd = c->fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, wait_ms) < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (!(pfd.revents & (POLLIN | POLLHUP | POLLERR))) {
+            if (wait_ms == 0) return 0;
+            continue;
+        }
+        n = read(c->fd, c->in, sizeof(c->in));
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            return -1;
+        }
+        if (n == 0) return -1;
+        c->in_pos = 0;
+        c->in_len = (uint16_t)n;
+    }
+}
+
+/**
+  * @brief  发出请求并等待它的应答
+  * @param  c: 客户端
+  * @param  op: 操作码
+  * @param  body: 消息体
+  * @param  len: 消息体字节数
+  * @param  reply: 输出应答
+  * @param  timeout_ms: 超时(ms)
+  * @retval int: 应答状态码，-1超时或出错
+  * @note   等待期间到达的其他应答和上报被丢弃，不要与流水线请求混用
+  */
+int RPC_ClientCall(RpcClient_TypeDef *c, uint8_t op, const uint8_t *body, uint16_t len,
+                   RpcReply_TypeDef *reply, int timeout_ms)
+{
+    uint64_t deadline;
+    uint64_t now;
+    int id, r;
+
+    id = RPC_ClientSend(c, op, body, len);
+    if (id < 0) return -1;
+    deadline = RPC_ClientMicros() + (uint64_t)timeout_ms * 1000ULL;
+
+    for (;;) {
+        now = RPC_ClientMicros();
+        if (now >= deadline) break;
+        r = RPC_ClientReceive(c, reply, (int)((deadline - now + 999) / 1000));
+        if (r < 0) break;
+        if (r == 1 && reply->is_response && reply->id == id) return reply->status;
+    }
+
+    /* 超时：回收请求号，迟到的应答按stray计数 */
+    if (c->pending[id]) {
+        c->pending[id] = 0;
+        c->outstanding--;
+        c->expired++;
+    }
+    return -1;
+}
+
+/**
+  * @brief  放弃超时未应答的请求
+  * @param  c: 客户端
+  * @param  timeout_ms: 超时(ms)
+  * @retval uint16_t: 放弃的请求数
+  */
+uint16_t RPC_ClientExpire(RpcClient_TypeDef *c, uint32_t timeout_ms)
+{
+    uint64_t now = RPC_ClientMicros();
+    uint16_t count = 0;
+    int id;
+
+    for (id = 1; id < 256; id++) {
+        if (c->pending[id] && now - c->sent_us[id] > (uint64_t)timeout_ms * 1000ULL) {
+            c->pending[id] = 0;
+            c->outstanding--;
+            c->expired++;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+  * @brief  读参数
+  * @param  bits: 输出值的原始位(float按位)
+  * @retval int: 状态码，-1超时或出错
+  */
+int RPC_ClientGetParam(RpcClient_TypeDef *c, uint8_t axis, uint16_t param, uint32_t *bits, int timeout_ms)
+{
+    RpcReply_TypeDef reply;
+    uint8_t body[3];
+    int status;
+
+    body[0] = axis;
+    RPC_PutU16(&body[1], param);
+    status = RPC_ClientCall(c, RPC_OP_GET_PARAM, body, sizeof(body), &reply, timeout_ms);
+    if (status == RPC_STATUS_OK) {
+        if (reply.len != 4) return -1;
+        *bits = RPC_GetU32(reply.data);
+    }
+    return status;
+}
+
+/**
+  * @brief  写参数
+  * @param  bits: 值的原始位(float按位)
+  * @retval int: 状态码，-1超时或出错
+  */
+int RPC_ClientSetParam(RpcClient_TypeDef *c, uint8_t axis, uint16_t param, uint32_t bits, int timeout_ms)
+{
+    RpcReply_TypeDef reply;
+    uint8_t body[7];
+
+    body[0] = axis;
+    RPC_PutU16(&body[1], param);
+    RPC_PutU32(&body[3], bits);
+    return RPC_ClientCall(c, RPC_OP_SET_PARAM, body, sizeof(body), &reply, timeout_ms);
+}
+
+/**
+  * @brief  按RPC_STEP_x布局编码一步序列指令
+  * @param  buf: 输出，RPC_STEP_LEN字节
+  */
+void RPC_ClientPutStep(uint8_t *buf, uint8_t op, uint8_t flags, int16_t value,
+                       uint16_t tolerance, uint16_t rate, uint32_t time)
+{
+    buf[RPC_STEP_OP] = op;
+    buf[RPC_STEP_FLAGS] = flags;
+    RPC_PutU16(&buf[RPC_STEP_VALUE], (uint16_t)value);
+    RPC_PutU16(&buf[RPC_STEP_TOLERANCE], tolerance);
+    RPC_PutU16(&buf[RPC_STEP_RATE], rate);
+    RPC_PutU32(&buf[RPC_STEP_TIME], time);
+}
+
+/**
+  * @brief  上传序列程序
+  * @param  steps: 已编码的指令，每步RPC_STEP_LEN字节
+  * @param  count: 步数
+  * @param  stream: 1流式：缓冲填满(或全部发完)后立即开始运行，其余边执行边追加；
+  *                 0存储：只上传，由PROG_START运行，步数不能超过固件缓冲
+  * @param  timeout_ms: 单个请求的超时，流式时也是缓冲一直没有空间的最长等待
+  * @retval int: 状态码，-1超时或出错
+  * @note   固件缓冲满时应答BUSY或只接收部分步，未接收的按应答的剩余空间重发
+  */
+int RPC_ClientUpload(RpcClient_TypeDef *c, uint8_t axis, const uint8_t *steps, uint32_t count,
+                     uint8_t stream, int timeout_ms)
+{
+    RpcReply_TypeDef reply;
+    uint8_t body[1 + RPC_PROG_STEPS_MAX * RPC_STEP_LEN];
+    uint32_t sent = 0, n;
+    uint64_t idle_since = RPC_ClientMicros();
+    uint8_t started = 0;
+    int status;
+
+    body[0] = axis;
+    body[1] = stream ? 1 : 0;
+    status = RPC_ClientCall(c, RPC_OP_PROG_CLEAR, body, 2, &reply, timeout_ms);
+    if (status != RPC_STATUS_OK) return status;
+
+    while (sent < count) {
+        n = count - sent;
+        if (n > RPC_PROG_STEPS_MAX) n = RPC_PROG_STEPS_MAX;
+        memcpy(&body[1], &steps[sent * RPC_STEP_LEN], n * RPC_STEP_LEN);
+        status = RPC_ClientCall(c, RPC_OP_PROG_APPEND, body, (uint16_t)(1 + n * RPC_STEP_LEN), &reply, timeout_ms);
+        if (status == RPC_STATUS_OK) {
+            if (reply.len != 3 || reply.data[0] == 0 || reply.data[0] > n) return -1;
+            sent += reply.data[0];
+            idle_since = RPC_ClientMicros();
+            if (reply.data[0] == n && sent < count) continue;
+        } else if (status != RPC_STATUS_BUSY) {
+            return status;
+        }
+
+        /* 缓冲已满：存储方式放不下；流式方式开始运行，等执行释放空间 */
+        if (!stream && sent < count) return RPC_STATUS_BUSY;
+        if (stream && !started) {
+            body[1] = RPC_PROG_UPLOADED;
+            status = RPC_ClientCall(c, RPC_OP_PROG_START, body, 2, &reply, timeout_ms);
+            if (status != RPC_STATUS_OK) return status;
+            started = 1;
+        }
+        if (sent < count) {
+            if (RPC_ClientMicros() - idle_since > (uint64_t)timeout_ms * 1000) return -1;
+            usleep(10000);
+        }
+    }
+
+    /* 流式程序一次就发完了 */
+    if (stream && !started) {
+        body[1] = RPC_PROG_UPLOADED;
+        return RPC_ClientCall(c, RPC_OP_PROG_START, body, 2, &reply, timeout_ms);
+    }
+    return RPC_STATUS_OK;
+}
+
+const RpcParamName_TypeDef *RPC_ClientFindParam(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < RC_PARAM_COUNT; i++) {
+        if (strcmp(rc_params[i].name, name) == 0) return &rc_params[i];
+    }
+    return NULL;
+}
+
+const RpcParamName_TypeDef *RPC_ClientParamTable(uint16_t *count)
+{
+    *count = (uint16_t)RC_PARAM_COUNT;
+    return rc_params;
+}
+
+const char *RPC_ClientStatusName(uint8_t status)
+{
+    static const char *names[] = {
+        "ok", "bad op", "bad length", "bad axis", "bad param", "bad value", "read only", "busy",
+        "storage"
+    };
+
+    return (status < sizeof(names) / sizeof(names[0])) ? names[status] : "?";
+}
+
+/* 复位客户端状态 */
+static void RC_Reset(RpcClient_TypeDef *c, int fd)
+{
+    memset(c, 0, sizeof(*c));
+    c->fd = fd;
+    c->next_id = 1;
+}
+
+static int RC_WriteAll(int fd, const uint8_t *data, size_t len)
+{
+    struct pollfd pfd;
+    ssize_t n;
+
+    while (len > 0) {
+        n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) return -1;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            poll(&pfd, 1, -1);
+            continue;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+  * @brief  分帧：0x00开始一帧，帧内再遇0x00结束；连续的0x00视为帧间空隙
+  * @retval int: 1得到一条有效消息
+  */
+static int RC_FeedByte(RpcClient_TypeDef *c, uint8_t byte, RpcReply_TypeDef *reply)
+{
+    if (byte == 0x00) {
+        if (c->rx_in_frame && !c->rx_overflow && c->rx_len > 0) {
+            c->rx_in_frame = 0;
+            return RC_Deliver(c, reply);
+        }
+        if (c->rx_in_frame && c->rx_overflow) {
+            c->rx_in_frame = 0;          // 超长帧的结束分隔符不开始新帧
+        } else {
+            c->rx_in_frame = 1;
+        }
+        c->rx_overflow = 0;
+        c->rx_len = 0;
+        return 0;
+    }
+    if (!c->rx_in_frame) {
+        c->text_bytes++;
+    } else if (c->rx_len < sizeof(c->rx)) {
+        c->rx[c->rx_len++] = byte;
+    } else {
+        c->rx_overflow = 1;
+        c->bad_frames++;
+    }
+    return 0;
+}
+
+/* 解码一帧，应答核对并释放请求号 */
+static int RC_Deliver(RpcClient_TypeDef *c, RpcReply_TypeDef *reply)
+{
+    RpcMessage_TypeDef msg;
+
+    if (!RPC_ParseFrame(c->rx, c->rx_len, &msg)) {
+        c->bad_frames++;
+        return 0;
+    }
+
+    reply->id = msg.id;
+    reply->rtt_us = 0;
+    if (msg.op & RPC_OP_RESPONSE) {
+        if (msg.len < 1 || msg.id == RPC_ID_EVENT || !c->pending[msg.id]) {
+            c->stray++;
+            return 0;
+        }
+        c->pending[msg.id] = 0;
+        c->outstanding--;
+        reply->is_response = 1;
+        reply->op = (uint8_t)(msg.op & ~RPC_OP_RESPONSE);
+        reply->status = msg.body[0];
+        reply->len = (uint16_t)(msg.len - 1);
+        memcpy(reply->data, &msg.body[1], reply->len);
+        reply->rtt_us = RPC_ClientMicros() - c->sent_us[msg.id];
+    } else {
+        reply->is_response = 0;
+        reply->op = msg.op;
+        reply->status = RPC_STATUS_OK;
+        reply->len = msg.len;
+        memcpy(reply->data, msg.body, msg.len);
+    }
+    return 1;
+}
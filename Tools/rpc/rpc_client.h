@@ -0,0 +1,85 @@
+/**
+  ******************************************************************************
+  * @file    rpc_client.h
+  * @brief   二进制RPC客户端库头文件(Linux主机程序)
+  ******************************************************************************
+  * 协议定义与固件共用Algorithm/rpc_schema.h，编解码共用Algorithm/rpc_codec.c。
+  * 请求号由库分配，RPC_ClientSend不等应答即可连续调用(流水线)，
+  * RPC_ClientReceive按到达顺序返回应答和数据流上报，应答带回请求号和往返时间。
+  * 串口上固件的文本输出夹在帧之间，接收时按0x00分帧后丢弃，只计数。
+  ******************************************************************************
+  */
+
+#ifndef __RPC_CLIENT_H
+#define __RPC_CLIENT_H
+
+#include <stdint.h>
+#include "rpc_codec.h"
+
+#define RPC_CLIENT_IDS       255      // 可用请求号1~255，即最大流水线深度
+
+/* 客户端状态 */
+typedef struct {
+    int fd;                              // 串口/pty文件描述符
+    uint8_t next_id;                     // 下一个分配的请求号
+    uint16_t outstanding;                // 已发出未应答的请求数
+    uint8_t pending[256];                // 1: 该请求号已发出未应答
+    uint64_t sent_us[256];               // 各请求号的发送时刻(us，CLOCK_MONOTONIC)
+
+    /* 读缓冲：一次read可能含多帧，未处理的字节留到下次 */
+    uint8_t in[512];
+    uint16_t in_pos, in_len;
+
+    /* 接收分帧，状态与固件USART_RxService相同 */
+    uint8_t rx[RPC_COBS_MAX];            // 帧缓冲(不含分隔符)
+    uint16_t rx_len;                     // 帧字节数
+    uint8_t rx_in_frame;                 // 1: 收到起始0x00，正在接收帧
+    uint8_t rx_overflow;                 // 1: 帧超长，丢弃到下一个0x00
+
+    /* 统计 */
+    uint32_t bad_frames;                 // 解码/CRC失败的帧
+    uint32_t stray;                      // 请求号不在等待中的应答
+    uint32_t expired;                    // 超时放弃的请求
+    uint32_t text_bytes;                 // 帧外文本字节
+} RpcClient_TypeDef;
+
+/* 收到的消息 */
+typedef struct {
+    uint8_t id;                          // 请求号，RPC_ID_EVENT为上报
+    uint8_t op;                          // 操作码(应答不含RPC_OP_RESPONSE位)
+    uint8_t is_response;                 // 1: 应答，0: 上报
+    uint8_t status;                      // 应答状态码(上报为RPC_STATUS_OK)
+    uint8_t data[RPC_BODY_MAX];          // 负载(应答不含状态字节)
+    uint16_t len;                        // 负载字节数
+    uint64_t rtt_us;                     // 应答的往返时间(us)
+} RpcReply_TypeDef;
+
+/* 参数表项，由RPC_PARAM_TABLE生成 */
+typedef struct {
+    const char *name;                    // 名称
+    uint16_t id;                         // 参数号
+    uint8_t type;                        // RPC_TYPE_x
+    uint8_t access;                      // RPC_ACCESS_x
+} RpcParamName_TypeDef;
+
+/* 函数声明 */
+int RPC_ClientOpen(RpcClient_TypeDef *c, const char *path, uint32_t baud);    // 打开串口并设为原始模式，0成功
+void RPC_ClientAttach(RpcClient_TypeDef *c, int fd);                           // 使用已打开的描述符(pty等)
+void RPC_ClientClose(RpcClient_TypeDef *c);                                    // 关闭
+int RPC_ClientSend(RpcClient_TypeDef *c, uint8_t op, const uint8_t *body, uint16_t len); // 发出请求，返回请求号，-1失败
+int RPC_ClientReceive(RpcClient_TypeDef *c, RpcReply_TypeDef *reply, int timeout_ms);    // 收一条消息，1收到，0超时，-1出错
+int RPC_ClientCall(RpcClient_TypeDef *c, uint8_t op, const uint8_t *body, uint16_t len,
+                   RpcReply_TypeDef *reply, int timeout_ms);                   // 发出并等待应答，返回状态码，-1超时/出错
+uint16_t RPC_ClientExpire(RpcClient_TypeDef *c, uint32_t timeout_ms);          // 放弃超过timeout_ms未应答的请求，返回个数
+int RPC_ClientGetParam(RpcClient_TypeDef *c, uint8_t axis, uint16_t param, uint32_t *bits, int timeout_ms); // 读参数(原始位)
+int RPC_ClientSetParam(RpcClient_TypeDef *c, uint8_t axis, uint16_t param, uint32_t bits, int timeout_ms);  // 写参数(原始位)
+void RPC_ClientPutStep(uint8_t *buf, uint8_t op, uint8_t flags, int16_t value,
+                       uint16_t tolerance, uint16_t rate, uint32_t time);          // 编码一步序列指令
+int RPC_ClientUpload(RpcClient_TypeDef *c, uint8_t axis, const uint8_t *steps, uint32_t count,
+                     uint8_t stream, int timeout_ms);                           // 上传序列程序，返回状态码，-1超时/出错
+const RpcParamName_TypeDef *RPC_ClientFindParam(const char *name);            // 按名称查参数，NULL表示未知
+const RpcParamName_TypeDef *RPC_ClientParamTable(uint16_t *count);             // 参数表
+const char *RPC_ClientStatusName(uint8_t status);                              // 状态码名称
+uint64_t RPC_ClientMicros(void);                                               // 单调时钟(us)
+
+#endif /* __RPC_CLIENT_H */
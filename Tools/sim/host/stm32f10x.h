@@ -0,0 +1,34 @@
+/**
+  ******************************************************************************
+  * @file    stm32f10x.h
+  * @brief   主机仿真用的器件头文件替身
+  ******************************************************************************
+  * 主机编译Algorithm/下的控制代码时代替USER/stm32f10x.h：只提供各模块头文件
+  * 用到的整数类型、外设结构体名和中断开关，外设本身由sim_hw.c在接口层模拟。
+  * 包含路径中本目录须在USER/之前。
+  ******************************************************************************
+  */
+
+#ifndef __STM32F10x_H
+#define __STM32F10x_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t u32;
+typedef uint16_t u16;
+typedef uint8_t  u8;
+
+/* 外设寄存器结构体只作为硬件描述中的指针类型出现 */
+typedef struct { uint32_t reserved; } GPIO_TypeDef;
+typedef struct { uint32_t reserved; } TIM_TypeDef;
+typedef struct { uint32_t reserved; } ADC_TypeDef;
+typedef struct { uint32_t reserved; } DMA_Channel_TypeDef;
+
+/* 仿真单线程推进，中断开关为空操作 */
+#define __disable_irq()   ((void)0)
+#define __enable_irq()    ((void)0)
+#define __get_PRIMASK()   (0U)
+#define __set_PRIMASK(x)  ((void)(x))
+
+#endif /* __STM32F10x_H */
@@ -0,0 +1,770 @@
+/**
+  ******************************************************************************
+  * @file    monte_carlo.c
+  * @brief   角度控制鲁棒性蒙特卡洛测试(主机程序)
+  ******************************************************************************
+  * 用固件的Algorithm/angle_control.c及其算法模块控制sim_panel.c的板子模型，
+  * 每个场景随机改变板子质量、风扇推力、传感器噪声、ADC零点和电源电压，
+  * 按赛题判据(±5°内3s到达，之后10s不离开)统计失败率和调节时间分布，
+  * 列出最差场景及其种子。同一种子总是复现同一场景，-x单独回放并输出轨迹。
+  * 风扇能耗按control_allocation的功率模型(ALLOC_Power)对施加的驱动积分，
+  * 推力取该驱动下的稳态推力；-c用同一组种子分别运行双风扇PID和MPC，逐场景比较
+  * 调节时间和能耗。稳态纹波为最后MC_RIPPLE_US内真实角度的峰峰值，-q选择输出
+  * 分辨率(整数占空比、推力指令+抖动、推力指令不抖动)以比较量化造成的极限环。
+  * -t在稳定后切换控制模式，比较三种交接方式的角度跌落和恢复时间：保持推力经
+  * 斜坡交接(固件)、保持推力不限斜率、切换时先停风扇(旧固件的做法)。
+  *
+  * 固件模块带有静态状态(系统时间、控制周期、过采样率)，并行用多进程：
+  * 每个工作进程依次运行分给它的场景，结果写入共享内存。
+  * 失败率超过-f门限时返回1，可作为更新增益前的检查。
+  *
+  * 编译(在仓库根目录)：
+  *   gcc -std=gnu99 -O2 -ITools/sim/host -ITools/sim -IAlgorithm -IHardware/angle_sensor \
+  *       -IHardware/fan_driver -IHardware/tach -IHardware/current_sense -IHardware/param_store \
+  *       -ISYSTEM/timebase -ISYSTEM/delay -ISYSTEM/sys \
+  *       Tools/sim/monte_carlo.c Tools/sim/sim_panel.c Tools/sim/sim_hw.c \
+  *       Algorithm/angle_control.c Algorithm/pid_controller.c Algorithm/angle_estimator.c \
+  *       Algorithm/mpc_controller.c Algorithm/control_allocation.c Algorithm/system_ident.c \
+  *       Algorithm/stability_detector.c Algorithm/sequence_engine.c Algorithm/recorder.c -lm -o monte_carlo
+  *
+  * 用法：
+  *   monte_carlo [-n 场景数] [-s 起始种子] [-j 进程数] [-m 45|single|dual|mpc] [-a 目标角度]
+  *               [-g kp,ki,kd] [-r 控制频率] [-b 允许误差] [-w 最差条数] [-f 失败率门限%]
+  *               [-q coarse|fine|nodither]
+  *   monte_carlo -x 种子 [-o 轨迹.csv] ...    回放单个场景(种子0为标称场景)
+  *   monte_carlo -c [-n 场景数] [-a 目标角度] ...  双风扇PID与MPC对比
+  *   monte_carlo -t 原模式,新模式 [-n 场景数] [-a 目标角度] ...  模式切换过渡对比
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "sim_panel.h"
+#include "angle_control.h"
+
+#define MC_REACH_TIME_US     3000000   // 到达判据：进入允许误差带的时限
+#define MC_HOLD_TIME_US      10000000  // 保持判据：进入后不离开的时长
+#define MC_DURATION_US       (MC_REACH_TIME_US + MC_HOLD_TIME_US + 2000000) // 仿真时长，须覆盖到达+保持
+#define MC_WORKERS_MAX       256       // 最多工作进程数
+#define MC_HIST_BIN          0.25f     // 调节时间直方图组距(s)
+#define MC_HIST_BINS         12        // 直方图组数(最后一组包含更长的时间)
+#define MC_RIPPLE_US         5000000   // 稳态纹波统计时长(仿真结束前)
+
+#define MC_SWITCH_US         10000000  // 过渡测试：切换模式的时刻
+#define MC_AFTER_US          6000000   // 过渡测试：切换后的观察时长
+#define MC_TRANSITION_BAND   1.0f      // 过渡测试：恢复判据(±度)
+
+/* 模式切换交接方式 */
+#define MC_HANDOVER_RAMP     0         // 保持推力，按固件默认斜率过渡
+#define MC_HANDOVER_DIRECT   1         // 保持推力，不限斜率
+#define MC_HANDOVER_STOP     2         // 切换前停止风扇(旧固件)
+#define MC_HANDOVER_COUNT    3
+
+/* 输出分辨率 */
+#define MC_OUTPUT_COARSE     0         // 整数百分比占空比(固件默认)
+#define MC_OUTPUT_FINE       1         // Q15推力指令，PWM抖动
+#define MC_OUTPUT_NODITHER   2         // Q15推力指令，比较值取整不抖动
+
+/* 失败标志 */
+#define MC_FAIL_REACH        0x01      // 3s内未进入误差带
+#define MC_FAIL_HOLD         0x02      // 3s内进入过，但未能从3s内某时刻起连续保持10s
+
+/* 运行配置 */
+typedef struct {
+    ControlMode_TypeDef mode;
+    float target;                // 目标角度(度)
+    float stable_error;          // 固件稳定判定误差(度)，同main.c的模式配置
+    uint16_t stable_time;        // 固件稳定判定时间(ms)
+    float band;                  // 判据允许误差(±度)
+    uint8_t custom_gains;        // 1: 使用kp/ki/kd
+    float kp, ki, kd;
+    uint16_t rate_hz;            // 控制频率，0为固件默认
+    uint8_t output;              // 输出分辨率 MC_OUTPUT_x
+} McConfig_TypeDef;
+
+/* 单个场景结果 */
+typedef struct {
+    uint64_t seed;
+    SimScenario_TypeDef scenario;
+    float entry;                 // 首次进入误差带的时刻(s)，未进入为-1
+    float settle;                // 最后一次进入且之后不再离开的时刻(s)，结束时在带外为-1
+    float overshoot;             // 超过目标的最大值(度)
+    float stable_fw;             // 固件判定稳定的时刻(s)，未判定为-1
+    float final_error;           // 结束时误差(度)
+    float energy;                // 风扇电能(J)，整个仿真时长
+    float ripple;                // 稳态纹波(度，峰峰值)
+    uint8_t fail;                // 失败标志
+} McResult_TypeDef;
+
+static AngleControl_TypeDef mc_control;
+static FanDriver_TypeDef mc_fan;
+static AngleSensor_TypeDef mc_sensor;
+
+/**
+  * @brief  当前两风扇的电功率
+  * @retval float: 功率(W)
+  * @note   推力取当前驱动(占空比×电源电压)对应的稳态推力，停转的风扇不计功率
+  */
+static float MC_FanPower(void)
+{
+    float volt = g_sim.scenario.supply / SIM_SUPPLY_NOMINAL;
+    float drive, power = 0.0f;
+    uint8_t i;
+
+    for (i = 0; i < 2; i++) {
+        drive = g_sim.duty[i] * volt;
+        power += ALLOC_Power(&mc_control.alloc, drive * drive * 100.0f);
+    }
+    return power;
+}
+
+/**
+  * @brief  生成场景、复位仿真并按配置初始化控制器
+  * @param  cfg: 运行配置
+  * @param  seed: 种子，0为标称场景
+  * @param  scenario: 输出场景参数
+  * @retval 无
+  * @note   与main.c相同的上电和模式配置顺序
+  */
+static void MC_Setup(const McConfig_TypeDef *cfg, uint64_t seed, SimScenario_TypeDef *scenario)
+{
+    if (seed == 0) {
+        SIM_ScenarioNominal(scenario);
+    } else {
+        SIM_ScenarioRandom(scenario, seed);
+    }
+    SIM_Reset(scenario, seed);
+
+    memset(&mc_control, 0, sizeof(mc_control));
+    memset(&mc_fan, 0, sizeof(mc_fan));
+    memset(&mc_sensor, 0, sizeof(mc_sensor));
+    ANGLE_CONTROL_Init(&mc_control, CONTROL_MODE_IDLE, &mc_fan, &mc_sensor);
+    if (cfg->rate_hz != 0) {
+        ANGLE_CONTROL_SetLoopRate(&mc_control, 1, cfg->rate_hz);
+    }
+    if (cfg->custom_gains) {
+        ANGLE_CONTROL_SetPID(&mc_control, cfg->kp, cfg->ki, cfg->kd);
+    }
+    if (cfg->output != MC_OUTPUT_COARSE) {
+        ANGLE_CONTROL_EnableFineOutput(&mc_control, 1);
+        if (cfg->output == MC_OUTPUT_NODITHER) FAN_EnableDither(&mc_fan, 0);
+    }
+    ANGLE_CONTROL_SetMode(&mc_control, cfg->mode);
+    ANGLE_CONTROL_SetStableCondition(&mc_control, cfg->stable_error, cfg->stable_time);
+    ANGLE_CONTROL_SetTarget(&mc_control, cfg->target);
+}
+
+/**
+  * @brief  运行一个场景
+  * @param  cfg: 运行配置
+  * @param  seed: 种子，0为标称场景
+  * @param  result: 输出结果
+  * @param  trace: 非NULL时按控制周期写入CSV轨迹
+  * @retval 无
+  * @note   判据按真实角度计算
+  */
+static void MC_RunScenario(const McConfig_TypeDef *cfg, uint64_t seed, McResult_TypeDef *result, FILE *trace)
+{
+    uint64_t now, next_ms = 1000, next_tick;
+    uint32_t tick_us;
+    float angle, err, t;
+    float ripple_min = 1e9f, ripple_max = -1e9f;
+    uint8_t inside = 0;
+
+    memset(result, 0, sizeof(*result));
+    result->seed = seed;
+    MC_Setup(cfg, seed, &result->scenario);
+
+    result->entry = -1.0f;
+    result->settle = -1.0f;
+    result->stable_fw = -1.0f;
+    result->overshoot = 0.0f;
+    tick_us = ANGLE_CONTROL_GetTickUs();
+    next_tick = tick_us;
+
+    if (trace) fprintf(trace, "t_s,target,angle,measured,duty_left,duty_right,state\n");
+
+    while (g_sim.time_us < MC_DURATION_US) {
+        SIM_Step(SIM_STEP_US);
+        result->energy += MC_FanPower() * (SIM_STEP_US * 1e-6f);
+        now = g_sim.time_us;
+        if (now >= next_ms) {
+            ANGLE_CONTROL_TimeUpdate();
+            next_ms += 1000;
+        }
+        if (now < next_tick) continue;
+        next_tick += tick_us;
+
+        ANGLE_CONTROL_Process(&mc_control);
+
+        /* 判据按控制周期采样真实角度 */
+        t = now * 1e-6f;
+        angle = SIM_GetAngle();
+        err = angle - cfg->target;
+        if (err > result->overshoot) result->overshoot = err;
+        if (fabsf(err) <= cfg->band) {
+            if (!inside) {
+                inside = 1;
+                result->settle = t;
+                if (result->entry < 0.0f) result->entry = t;
+            }
+        } else {
+            inside = 0;
+            result->settle = -1.0f;
+        }
+        if (result->stable_fw < 0.0f && mc_control.state == ANGLE_STATE_STABLE) {
+            result->stable_fw = t;
+        }
+        if (now + MC_RIPPLE_US >= MC_DURATION_US) {
+            if (angle < ripple_min) ripple_min = angle;
+            if (angle > ripple_max) ripple_max = angle;
+        }
+
+        if (trace) {
+            fprintf(trace, "%.3f,%.2f,%.3f,%.3f,%.3f,%.3f,%d\n", t, cfg->target, angle,
+                    mc_control.current_angle, g_sim.duty[0], g_sim.duty[1], (int)mc_control.state);
+        }
+    }
+
+    /* 仿真时长不短于到达时限+保持时长，最后一次进入在时限内即保持了足够长 */
+    result->final_error = SIM_GetAngle() - cfg->target;
+    result->ripple = ripple_max - ripple_min;
+    if (result->entry < 0.0f || result->entry * 1e6f > MC_REACH_TIME_US) {
+        result->fail |= MC_FAIL_REACH;
+    } else if (result->settle < 0.0f || result->settle * 1e6f > MC_REACH_TIME_US) {
+        result->fail |= MC_FAIL_HOLD;
+    }
+}
+
+/**
+  * @brief  运行一次模式切换过渡
+  * @param  cfg: 运行配置，cfg->mode为原模式
+  * @param  seed: 种子，0为标称场景
+  * @param  to: 新模式
+  * @param  handover: MC_HANDOVER_x
+  * @param  dip: 输出切换后的最大角度误差(度)
+  * @retval float: 切换后最后一次离开±MC_TRANSITION_BAND的时刻(s，相对切换)，
+  *         观察结束时仍在带外为-1
+  */
+static float MC_RunTransition(const McConfig_TypeDef *cfg, uint64_t seed, ControlMode_TypeDef to,
+                              uint8_t handover, float *dip)
+{
+    SimScenario_TypeDef scenario;
+    uint64_t now, next_ms = 1000, next_tick;
+    uint32_t tick_us;
+    uint8_t switched = 0;
+    float err, recover = 0.0f;
+
+    MC_Setup(cfg, seed, &scenario);
+    if (handover == MC_HANDOVER_DIRECT) {
+        FAN_SetRamp(&mc_fan, 0.0f, 0.0f);
+    }
+    tick_us = ANGLE_CONTROL_GetTickUs();
+    next_tick = tick_us;
+    *dip = 0.0f;
+
+    while (g_sim.time_us < MC_SWITCH_US + MC_AFTER_US) {
+        SIM_Step(SIM_STEP_US);
+        now = g_sim.time_us;
+        if (now >= next_ms) {
+            ANGLE_CONTROL_TimeUpdate();
+            next_ms += 1000;
+        }
+        if (now < next_tick) continue;
+        next_tick += tick_us;
+
+        if (!switched && now >= MC_SWITCH_US) {
+            switched = 1;
+            if (handover == MC_HANDOVER_STOP) FAN_StopAll(&mc_fan);
+            ANGLE_CONTROL_SetMode(&mc_control, to);
+            ANGLE_CONTROL_SetTarget(&mc_control, cfg->target);
+        }
+        ANGLE_CONTROL_Process(&mc_control);
+
+        if (switched) {
+            err = fabsf(SIM_GetAngle() - cfg->target);
+            if (err > *dip) *dip = err;
+            if (err > MC_TRANSITION_BAND) recover = (now - MC_SWITCH_US) * 1e-6f;
+        }
+    }
+
+    /* 观察结束时仍在带外视为未恢复 */
+    if (fabsf(SIM_GetAngle() - cfg->target) > MC_TRANSITION_BAND) return -1.0f;
+    return recover;
+}
+
+/**
+  * @brief  按调节时间排序：失败在前，调节时间长的在前
+  */
+static int MC_CompareWorst(const void *a, const void *b)
+{
+    const McResult_TypeDef *ra = (const McResult_TypeDef *)a;
+    const McResult_TypeDef *rb = (const McResult_TypeDef *)b;
+    float sa = (ra->settle < 0.0f) ? 1e9f : ra->settle;
+    float sb = (rb->settle < 0.0f) ? 1e9f : rb->settle;
+
+    if ((ra->fail != 0) != (rb->fail != 0)) return ra->fail ? -1 : 1;
+    if (sa != sb) return (sa > sb) ? -1 : 1;
+    if (ra->overshoot != rb->overshoot) return (ra->overshoot > rb->overshoot) ? -1 : 1;
+    return (ra->seed < rb->seed) ? -1 : 1;
+}
+
+static int MC_CompareFloat(const void *a, const void *b)
+{
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return (fa < fb) ? -1 : (fa > fb) ? 1 : 0;
+}
+
+/**
+  * @brief  打印一个结果行
+  */
+static void MC_PrintResult(const McResult_TypeDef *r)
+{
+    printf("%8llu %6.3f %5.2f %5.2f %6.1f %6.2f %6.2f %6.2f %9.2f %9.2f %7.1f  %s%s%s\n",
+           (unsigned long long)r->seed, r->scenario.mass, r->scenario.fan_strength, r->scenario.noise,
+           r->scenario.adc_offset, r->scenario.supply, r->entry, r->settle, r->overshoot, r->stable_fw, r->energy,
+           r->fail ? "" : "pass", (r->fail & MC_FAIL_REACH) ? "REACH " : "",
+           (r->fail & MC_FAIL_HOLD) ? "HOLD" : "");
+}
+
+/**
+  * @brief  汇总报告
+  * @retval float: 失败率(%)
+  */
+static float MC_Report(const McConfig_TypeDef *cfg, McResult_TypeDef *results, uint32_t count,
+                       uint32_t worst, uint32_t workers, double elapsed)
+{
+    uint32_t i, n_reach = 0, n_hold = 0, n_fail = 0, n_settled = 0;
+    uint32_t hist[MC_HIST_BINS];
+    float *settle = malloc(count * sizeof(float));
+    float *energy = malloc(count * sizeof(float));
+    float *ripple = malloc(count * sizeof(float));
+    uint32_t bin, peak = 1, k;
+
+    memset(hist, 0, sizeof(hist));
+    for (i = 0; i < count; i++) {
+        if (results[i].fail & MC_FAIL_REACH) n_reach++;
+        if (results[i].fail & MC_FAIL_HOLD) n_hold++;
+        if (results[i].fail) n_fail++;
+        energy[i] = results[i].energy;
+        ripple[i] = results[i].ripple;
+        if (results[i].settle >= 0.0f) {
+            settle[n_settled++] = results[i].settle;
+            bin = (uint32_t)(results[i].settle / MC_HIST_BIN);
+            if (bin >= MC_HIST_BINS) bin = MC_HIST_BINS - 1;
+            hist[bin]++;
+        }
+    }
+
+    printf("%u scenarios (seeds %llu..%llu), %u workers, %.2f s\n", count,
+           (unsigned long long)results[0].seed, (unsigned long long)results[count - 1].seed, workers, elapsed);
+    printf("Mode %d, target %.1f deg, loop %u Hz, gains %s, output %s\n", (int)cfg->mode, cfg->target,
+           cfg->rate_hz ? cfg->rate_hz : 1000000U / ANGLE_CONTROL_TICK_US,
+           cfg->custom_gains ? "custom" : "firmware default",
+           (cfg->output == MC_OUTPUT_FINE) ? "Q15 thrust + dither" :
+           (cfg->output == MC_OUTPUT_NODITHER) ? "Q15 thrust, no dither" : "integer duty");
+    printf("Criteria: within +/-%.1f deg by %.1f s, then no exit for %.1f s\n\n",
+           cfg->band, MC_REACH_TIME_US / 1e6f, MC_HOLD_TIME_US / 1e6f);
+    printf("  reach failures  %6u  (%.2f%%)\n", n_reach, n_reach * 100.0f / count);
+    printf("  hold failures   %6u  (%.2f%%)\n", n_hold, n_hold * 100.0f / count);
+    printf("  total failures  %6u  (%.2f%%)\n\n", n_fail, n_fail * 100.0f / count);
+
+    if (n_settled > 0) {
+        qsort(settle, n_settled, sizeof(float), MC_CompareFloat);
+        printf("Settle time (s, %u settled): min %.2f  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n",
+               n_settled, settle[0], settle[n_settled / 2], settle[n_settled * 9 / 10],
+               settle[n_settled * 99 / 100], settle[n_settled - 1]);
+        for (bin = 0; bin < MC_HIST_BINS; bin++) {
+            if (hist[bin] > peak) peak = hist[bin];
+        }
+        for (bin = 0; bin < MC_HIST_BINS; bin++) {
+            if (bin == MC_HIST_BINS - 1) {
+                printf("  >=%5.2f     %6u |", bin * MC_HIST_BIN, hist[bin]);
+            } else {
+                printf("  %4.2f-%4.2f  %6u |", bin * MC_HIST_BIN, (bin + 1) * MC_HIST_BIN, hist[bin]);
+            }
+            for (k = 0; k < (hist[bin] * 50 + peak - 1) / peak; k++) putchar('#');
+            putchar('\n');
+        }
+    }
+
+    qsort(energy, count, sizeof(float), MC_CompareFloat);
+    printf("Fan energy (J over %.1f s): min %.1f  p50 %.1f  p90 %.1f  max %.1f\n",
+           MC_DURATION_US / 1e6f, energy[0], energy[count / 2], energy[count * 9 / 10], energy[count - 1]);
+    qsort(ripple, count, sizeof(float), MC_CompareFloat);
+    printf("Steady ripple (deg p-p, last %.1f s): min %.3f  p50 %.3f  p90 %.3f  max %.3f\n",
+           MC_RIPPLE_US / 1e6f, ripple[0], ripple[count / 2], ripple[count * 9 / 10], ripple[count - 1]);
+
+    qsort(results, count, sizeof(McResult_TypeDef), MC_CompareWorst);
+    printf("\nWorst cases (replay with -x <seed>):\n");
+    printf("    seed   mass   fan noise offset supply  entry settle overshoot fw_stable  energy  result\n");
+    for (i = 0; i < worst && i < count; i++) {
+        MC_PrintResult(&results[i]);
+    }
+
+    free(settle);
+    free(energy);
+    free(ripple);
+    return n_fail * 100.0f / count;
+}
+
+/**
+  * @brief  多进程运行一组场景
+  * @param  cfg: 运行配置
+  * @param  results: 共享内存中的结果数组，results[i]对应种子base_seed+i
+  * @param  count: 场景数
+  * @param  base_seed: 起始种子
+  * @param  workers: 进程数
+  * @retval int: 0成功，-1创建进程失败或工作进程异常
+  */
+static int MC_RunBatch(const McConfig_TypeDef *cfg, McResult_TypeDef *results, uint32_t count,
+                       uint64_t base_seed, uint32_t workers)
+{
+    pid_t pids[MC_WORKERS_MAX];
+    uint32_t i, w;
+    int status, ret = 0;
+
+    fflush(stdout);
+    for (w = 0; w < workers; w++) {
+        pids[w] = fork();
+        if (pids[w] < 0) {
+            perror("fork");
+            return -1;
+        }
+        if (pids[w] == 0) {
+            /* 工作进程：屏蔽固件打印，按间隔取场景 */
+            if (!freopen("/dev/null", "w", stdout)) _exit(2);
+            for (i = w; i < count; i += workers) {
+                MC_RunScenario(cfg, base_seed + i, &results[i], NULL);
+            }
+            _exit(0);
+        }
+    }
+    for (w = 0; w < workers; w++) {
+        waitpid(pids[w], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Worker %u failed\n", w);
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/**
+  * @brief  打印一组结果的统计行：失败率、调节时间分位数、能耗分位数
+  */
+static void MC_PrintSummary(const char *name, const McResult_TypeDef *results, uint32_t count)
+{
+    float *settle = malloc(count * sizeof(float));
+    float *energy = malloc(count * sizeof(float));
+    uint32_t i, n_fail = 0, n_settled = 0;
+
+    for (i = 0; i < count; i++) {
+        if (results[i].fail) n_fail++;
+        if (results[i].settle >= 0.0f) settle[n_settled++] = results[i].settle;
+        energy[i] = results[i].energy;
+    }
+    qsort(energy, count, sizeof(float), MC_CompareFloat);
+    printf("  %-4s %6.2f%%", name, n_fail * 100.0f / count);
+    if (n_settled > 0) {
+        qsort(settle, n_settled, sizeof(float), MC_CompareFloat);
+        printf("   %5.2f %5.2f %5.2f", settle[n_settled / 2], settle[n_settled * 9 / 10], settle[n_settled - 1]);
+    } else {
+        printf("   %5s %5s %5s", "-", "-", "-");
+    }
+    printf("   %6.1f %6.1f %6.1f\n", energy[count / 2], energy[count * 9 / 10], energy[count - 1]);
+    free(settle);
+    free(energy);
+}
+
+/**
+  * @brief  双风扇PID与MPC对比：同一组种子各运行一次，逐场景比较
+  * @param  cfg: 运行配置(模式被覆盖)
+  * @retval int: 0成功，2运行失败
+  * @note   调节时间只比较两者都通过判据的场景；能耗比较全部场景
+  */
+static int MC_Compare(McConfig_TypeDef *cfg, uint32_t count, uint64_t base_seed, uint32_t workers)
+{
+    McResult_TypeDef *pid, *mpc;
+    uint32_t i, n_both = 0, n_faster = 0, n_cheaper = 0;
+    double d_settle = 0.0, d_energy = 0.0, e_pid = 0.0;
+
+    pid = mmap(NULL, 2 * count * sizeof(McResult_TypeDef), PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (pid == MAP_FAILED) {
+        perror("mmap");
+        return 2;
+    }
+    mpc = pid + count;
+
+    cfg->mode = CONTROL_MODE_DUAL_FAN;
+    if (MC_RunBatch(cfg, pid, count, base_seed, workers) != 0) return 2;
+    cfg->mode = CONTROL_MODE_DUAL_FAN_MPC;
+    if (MC_RunBatch(cfg, mpc, count, base_seed, workers) != 0) return 2;
+
+    for (i = 0; i < count; i++) {
+        if (!pid[i].fail && !mpc[i].fail) {
+            n_both++;
+            d_settle += mpc[i].settle - pid[i].settle;
+            if (mpc[i].settle < pid[i].settle) n_faster++;
+        }
+        d_energy += mpc[i].energy - pid[i].energy;
+        e_pid += pid[i].energy;
+        if (mpc[i].energy < pid[i].energy) n_cheaper++;
+    }
+
+    printf("PID vs MPC (dual fan), %u scenarios (seeds %llu..%llu), target %.1f deg\n",
+           count, (unsigned long long)base_seed, (unsigned long long)(base_seed + count - 1), cfg->target);
+    printf("Criteria: within +/-%.1f deg by %.1f s, then no exit for %.1f s; energy over %.1f s\n\n",
+           cfg->band, MC_REACH_TIME_US / 1e6f, MC_HOLD_TIME_US / 1e6f, MC_DURATION_US / 1e6f);
+    printf("        fail    settle p50   p90   max   energy p50    p90    max (J)\n");
+    MC_PrintSummary("PID", pid, count);
+    MC_PrintSummary("MPC", mpc, count);
+    printf("\nPaired by seed:\n");
+    if (n_both > 0) {
+        printf("  settle  MPC faster in %u of %u passing both, mean difference %+.3f s\n",
+               n_faster, n_both, d_settle / n_both);
+    }
+    printf("  energy  MPC lower in %u of %u, mean difference %+.1f J (%+.1f%%)\n",
+           n_cheaper, count, d_energy / count, (e_pid > 0.0) ? d_energy * 100.0 / e_pid : 0.0);
+
+    munmap(pid, 2 * count * sizeof(McResult_TypeDef));
+    return 0;
+}
+
+/**
+  * @brief  模式切换过渡对比：同一组种子按三种交接方式各运行一次
+  * @param  cfg: 运行配置，cfg->mode为原模式
+  * @param  to: 新模式
+  * @retval int: 0
+  * @note   单进程顺序运行，场景数宜在几百以内
+  */
+static int MC_Transition(const McConfig_TypeDef *cfg, ControlMode_TypeDef to, uint32_t count, uint64_t base_seed)
+{
+    static const char *names[MC_HANDOVER_COUNT] = {"ramp handover", "direct handover", "stop + restart"};
+    float *dip = malloc(MC_HANDOVER_COUNT * count * sizeof(float));
+    float *recover = malloc(MC_HANDOVER_COUNT * count * sizeof(float));
+    float *d, *r;
+    uint32_t i, n, lost;
+    uint8_t h;
+    int saved, null_fd;
+
+    /* 固件打印很多，运行期间把标准输出指向/dev/null */
+    fflush(stdout);
+    saved = dup(STDOUT_FILENO);
+    null_fd = open("/dev/null", O_WRONLY);
+    if (saved < 0 || null_fd < 0) {
+        perror("/dev/null");
+        return 2;
+    }
+    dup2(null_fd, STDOUT_FILENO);
+    for (h = 0; h < MC_HANDOVER_COUNT; h++) {
+        for (i = 0; i < count; i++) {
+            recover[h * count + i] = MC_RunTransition(cfg, base_seed + i, to, h, &dip[h * count + i]);
+        }
+    }
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(null_fd);
+
+    printf("Mode switch %d -> %d at %.1f s, target %.1f deg, %u scenarios (seeds %llu..%llu)\n",
+           (int)cfg->mode, (int)to, MC_SWITCH_US / 1e6f, cfg->target, count,
+           (unsigned long long)base_seed, (unsigned long long)(base_seed + count - 1));
+    printf("Recovery: last exit from +/-%.1f deg within %.1f s after the switch\n\n",
+           MC_TRANSITION_BAND, MC_AFTER_US / 1e6f);
+    printf("                    dip p50   p90   max   recover p50   p90   max   not recovered\n");
+
+    for (h = 0; h < MC_HANDOVER_COUNT; h++) {
+        d = &dip[h * count];
+        r = &recover[h * count];
+
+        /* 未恢复的排除在恢复时间统计之外 */
+        for (i = 0, n = 0; i < count; i++) {
+            if (r[i] >= 0.0f) r[n++] = r[i];
+        }
+        lost = count - n;
+        qsort(d, count, sizeof(float), MC_CompareFloat);
+        printf("  %-16s  %6.2f %5.2f %5.2f", names[h], d[count / 2], d[count * 9 / 10], d[count - 1]);
+        if (n > 0) {
+            qsort(r, n, sizeof(float), MC_CompareFloat);
+            printf("       %5.2f %5.2f %5.2f", r[n / 2], r[n * 9 / 10], r[n - 1]);
+        } else {
+            printf("       %5s %5s %5s", "-", "-", "-");
+        }
+        printf("   %6u\n", lost);
+    }
+
+    free(dip);
+    free(recover);
+    return 0;
+}
+
+/**
+  * @brief  解析输出分辨率名
+  */
+static int MC_ParseOutput(const char *name, McConfig_TypeDef *cfg)
+{
+    if (strcmp(name, "coarse") == 0) {
+        cfg->output = MC_OUTPUT_COARSE;
+    } else if (strcmp(name, "fine") == 0) {
+        cfg->output = MC_OUTPUT_FINE;
+    } else if (strcmp(name, "nodither") == 0) {
+        cfg->output = MC_OUTPUT_NODITHER;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief  解析模式名，按main.c的模式配置设置稳定条件
+  */
+static int MC_ParseMode(const char *name, McConfig_TypeDef *cfg)
+{
+    if (strcmp(name, "45") == 0) {
+        cfg->mode = CONTROL_MODE_SINGLE_FAN;
+        cfg->target = 45.0f;
+    } else if (strcmp(name, "single") == 0) {
+        cfg->mode = CONTROL_MODE_SINGLE_FAN;
+    } else if (strcmp(name, "dual") == 0) {
+        cfg->mode = CONTROL_MODE_DUAL_FAN;
+    } else if (strcmp(name, "mpc") == 0) {
+        cfg->mode = CONTROL_MODE_DUAL_FAN_MPC;
+    } else {
+        return 0;
+    }
+    if (cfg->mode == CONTROL_MODE_SINGLE_FAN) {
+        cfg->stable_error = 5.0f;
+        cfg->stable_time = 3000;
+    } else {
+        cfg->stable_error = 3.0f;
+        cfg->stable_time = 5000;
+    }
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    McConfig_TypeDef cfg;
+    McResult_TypeDef *results;
+    McResult_TypeDef one;
+    uint32_t count = 2000, workers, worst = 10;
+    uint64_t base_seed = 1, replay = 0;
+    uint8_t do_replay = 0, compare = 0, transition = 0;
+    ControlMode_TypeDef from = CONTROL_MODE_SINGLE_FAN, to = CONTROL_MODE_DUAL_FAN_MPC;
+    char *comma;
+    float max_fail = 1.0f, fail_rate;
+    const char *trace_path = NULL;
+    struct timespec t0, t1;
+    FILE *trace;
+    int opt;
+
+    memset(&cfg, 0, sizeof(cfg));
+    MC_ParseMode("45", &cfg);
+    cfg.band = 5.0f;
+    workers = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+
+    while ((opt = getopt(argc, argv, "n:s:j:m:a:g:r:b:w:f:x:o:q:t:ch")) != -1) {
+        switch (opt) {
+        case 'n': count = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': base_seed = strtoull(optarg, NULL, 0); break;
+        case 'j': workers = (uint32_t)atoi(optarg); break;
+        case 'm': if (!MC_ParseMode(optarg, &cfg)) goto usage; break;
+        case 'a': cfg.target = (float)atof(optarg); break;
+        case 'g':
+            if (sscanf(optarg, "%f,%f,%f", &cfg.kp, &cfg.ki, &cfg.kd) != 3) goto usage;
+            cfg.custom_gains = 1;
+            break;
+        case 'r': cfg.rate_hz = (uint16_t)atoi(optarg); break;
+        case 'b': cfg.band = (float)atof(optarg); break;
+        case 'w': worst = (uint32_t)atoi(optarg); break;
+        case 'f': max_fail = (float)atof(optarg); break;
+        case 'x': replay = strtoull(optarg, NULL, 0); do_replay = 1; break;
+        case 'o': trace_path = optarg; break;
+        case 'c': compare = 1; break;
+        case 'q': if (!MC_ParseOutput(optarg, &cfg)) goto usage; break;
+        case 't':
+            /* 原模式,新模式：解析新模式后再解析原模式，稳定条件按原模式 */
+            comma = strchr(optarg, ',');
+            if (comma == NULL) goto usage;
+            *comma = '\0';
+            if (!MC_ParseMode(comma + 1, &cfg)) goto usage;
+            to = cfg.mode;
+            if (!MC_ParseMode(optarg, &cfg)) goto usage;
+            from = cfg.mode;
+            transition = 1;
+            break;
+        default: goto usage;
+        }
+    }
+    if (count == 0) goto usage;
+    if (workers < 1) workers = 1;
+    if (workers > MC_WORKERS_MAX) workers = MC_WORKERS_MAX;
+    if (workers > count) workers = count;
+
+    if (transition) {
+        cfg.mode = from;
+        return MC_Transition(&cfg, to, count, base_seed);
+    }
+
+    if (compare) {
+        /* 对比按双风扇模式的稳定条件 */
+        MC_ParseMode("dual", &cfg);
+        return MC_Compare(&cfg, count, base_seed, workers);
+    }
+
+    /* 回放单个场景：固件打印保留在标准输出 */
+    if (do_replay) {
+        trace = NULL;
+        if (trace_path) {
+            trace = fopen(trace_path, "w");
+            if (!trace) {
+                perror(trace_path);
+                return 2;
+            }
+        }
+        MC_RunScenario(&cfg, replay, &one, trace);
+        if (trace) fclose(trace);
+        printf("\n    seed   mass   fan noise offset supply  entry settle overshoot fw_stable  energy  result\n");
+        MC_PrintResult(&one);
+        return one.fail ? 1 : 0;
+    }
+
+    results = mmap(NULL, count * sizeof(McResult_TypeDef), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap");
+        return 2;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (MC_RunBatch(&cfg, results, count, base_seed, workers) != 0) return 2;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    fail_rate = MC_Report(&cfg, results, count, worst, workers,
+                          (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9);
+    if (fail_rate > max_fail) {
+        printf("\nFAIL: failure rate %.2f%% above %.2f%%\n", fail_rate, max_fail);
+        return 1;
+    }
+    printf("\nPASS: failure rate %.2f%% within %.2f%%\n", fail_rate, max_fail);
+    return 0;
+
+usage:
+    fprintf(stderr, "Usage: %s [-n count] [-s seed] [-j workers] [-m 45|single|dual|mpc] [-a target]\n"
+                    "          [-g kp,ki,kd] [-r rate_hz] [-b band] [-w worst] [-f max_fail_pct]\n"
+                    "          [-q coarse|fine|nodither]\n"
+                    "       %s -x seed [-o trace.csv] ...   (seed 0 = nominal scenario)\n"
+                    "       %s -c [-n count] [-a target] ...    (dual-fan PID vs MPC)\n"
+                    "       %s -t from,to [-n count] [-a target] ...   (mode switch handover)\n",
+            argv[0], argv[0], argv[0], argv[0]);
+    return 2;
+}
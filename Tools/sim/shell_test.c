@@ -0,0 +1,473 @@
+/**
+  ******************************************************************************
+  * @file    shell_test.c
+  * @brief   命令行解析测试(主机程序)
+  ******************************************************************************
+  * 用脚本化的命令行驱动Algorithm/shell.c，控制代码连接sim_hw.c的仿真接口：
+  *   - 原地切分：多个空格/制表符、行首行尾空白、\r\n结尾、空行；
+  *   - 参数个数：恰好SHELL_ARGC_MAX个参数进入命令处理，多一个报错且argv不越界，
+  *     各命令的argc_min/argc_max边界；
+  *   - 散列查找：命令表中每个命令都经SHELL_Find找到自己，前缀、加长、大小写不同
+  *     的名字找不到，每个命令都有一行合法输入执行成功；
+  *   - 参数错误：非数字、带尾随字符、负数、超范围、未知模式/子命令都返回0并打印
+  *     用法，且不改动控制结构体；
+  *   - SHELL_Process依次执行接收服务交出的全部行，帧交给RPC_Handle。
+  * SHELL_Find为私有函数，本文件直接包含shell.c编译。串口接收、RPC_Handle、遥测设置和
+  * sim_hw.c没有的传感器校准接口在本文件中用桩实现，桩记录收到的参数。有失败项时返回1。
+  *
+  * 编译运行(在仓库根目录)：
+  *   gcc -std=gnu99 -O2 -Wall -Wno-unused-parameter -ITools/sim/host -ITools/sim -IAlgorithm \
+  *       -IHardware/angle_sensor -IHardware/fan_driver -IHardware/tach -IHardware/current_sense \
+  *       -IHardware/param_store -ISYSTEM/timebase -ISYSTEM/delay -ISYSTEM/sys -ISYSTEM/usart \
+  *       -DSystemCoreClock=72000000UL Tools/sim/shell_test.c Tools/sim/sim_panel.c Tools/sim/sim_hw.c \
+  *       Algorithm/angle_control.c Algorithm/pid_controller.c Algorithm/angle_estimator.c \
+  *       Algorithm/mpc_controller.c Algorithm/control_allocation.c Algorithm/system_ident.c \
+  *       Algorithm/stability_detector.c Algorithm/sequence_engine.c Algorithm/recorder.c \
+  *       -lm -o shell_test && ./shell_test
+  ******************************************************************************
+  */
+
+#include "../../Algorithm/shell.c"
+#include "sim_panel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_AXES            2         // 命令行管理的轴数
+#define TEST_LINE_LEN        512       // 测试命令行缓冲
+#define TEST_OUTPUT_LEN      4096      // 单条命令的输出缓冲
+
+static int test_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { test_failures++; printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } \
+} while (0)
+
+static AngleControl_TypeDef test_controls[TEST_AXES];
+static FanDriver_TypeDef test_fans[TEST_AXES];
+static AngleSensor_TypeDef test_sensors[TEST_AXES];
+static char test_output[TEST_OUTPUT_LEN];
+
+/* ---------------------------- 串口接收/RPC桩 ---------------------------- */
+
+u8 USART_RX_BUF[USART_REC_LEN];
+u16 USART_RX_STA = 0;
+u8 USART_RX_FRAME[USART_FRAME_LEN];
+u16 USART_RX_FRAME_STA = 0;
+
+static const char *const *test_script = NULL;    // 待交出的行，NULL结尾；以0x01开头的项按帧交出
+static uint8_t test_script_pos = 0;
+static uint8_t test_frames = 0;                  // RPC_Handle收到的帧数
+static uint16_t test_frame_len = 0;              // 最后一帧的长度
+
+u8 USART_RxService(void)
+{
+    const char *item;
+    uint16_t len;
+
+    if (test_script == NULL || test_script[test_script_pos] == NULL) return USART_RX_EV_NONE;
+    item = test_script[test_script_pos++];
+    if (item[0] == '\x01') {
+        /* 帧：第二字节起为内容 */
+        len = (uint16_t)strlen(item + 1);
+        memcpy(USART_RX_FRAME, item + 1, len);
+        USART_RX_FRAME_STA = 0x8000 | len;
+        return USART_RX_EV_FRAME;
+    }
+
+    /* 行：同USART_RxService，不含换行符 */
+    len = (uint16_t)strlen(item);
+    memcpy(USART_RX_BUF, item, len);
+    USART_RX_STA = 0x8000 | len;
+    return USART_RX_EV_LINE;
+}
+
+void USART_RxGetErrors(u32 *overruns, u32 *long_lines)
+{
+    *overruns = 0;
+    *long_lines = 0;
+}
+
+uint8_t RPC_Handle(uint8_t *frame, uint16_t len)
+{
+    test_frames++;
+    test_frame_len = len;
+    return 1;
+}
+
+/* ---------------------------- 遥测/校准桩 ---------------------------- */
+
+static uint16_t test_tele_period = 0;            // 最后设置的遥测周期
+static uint8_t test_tele_channels = 0;           // 最后设置的遥测通道
+static float test_cal_angle = 0.0f;              // 最后一个校准参考点
+static AngleSensor_TypeDef *test_cal_sensors = NULL; // 最后一次保存校准的传感器数组
+static uint8_t test_cal_count = 0;               // 最后一次保存校准的轴数
+
+void TELEMETRY_SetPeriod(uint16_t period)
+{
+    test_tele_period = period;
+}
+
+void TELEMETRY_SetChannels(uint8_t channels)
+{
+    test_tele_channels = channels;
+}
+
+AngleSensorStatus_TypeDef ANGLE_SENSOR_Calibrate(AngleSensor_TypeDef *sensor)
+{
+    return ANGLE_SENSOR_OK;
+}
+
+void ANGLE_SENSOR_CalBegin(AngleSensor_TypeDef *sensor)
+{
+}
+
+AngleSensorStatus_TypeDef ANGLE_SENSOR_CalAddPoint(AngleSensor_TypeDef *sensor, float reference_angle)
+{
+    test_cal_angle = reference_angle;
+    return ANGLE_SENSOR_OK;
+}
+
+AngleSensorStatus_TypeDef ANGLE_SENSOR_CalFinish(AngleSensor_TypeDef *sensor)
+{
+    return ANGLE_SENSOR_OK;
+}
+
+void ANGLE_SENSOR_ResetLinearization(AngleSensor_TypeDef *sensor)
+{
+}
+
+AngleSensorStatus_TypeDef ANGLE_SENSOR_SaveCalibration(AngleSensor_TypeDef *sensors, uint8_t count)
+{
+    test_cal_sensors = sensors;
+    test_cal_count = count;
+    return ANGLE_SENSOR_OK;
+}
+
+/* ---------------------------- 测试 ---------------------------- */
+
+/**
+  * @brief  执行一行命令并检查结果
+  * @param  line: 命令行(复制到可写缓冲后执行)
+  * @param  expect: 期望的SHELL_Execute返回值
+  * @param  output: 输出中应出现的文字，NULL不检查
+  * @retval 无
+  */
+static void TEST_Run(const char *line, uint8_t expect, const char *output)
+{
+    static char buffer[TEST_LINE_LEN];
+    FILE *console = stdout;
+    FILE *capture;
+    uint8_t result;
+
+    strncpy(buffer, line, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    memset(test_output, 0, sizeof(test_output));
+    capture = fmemopen(test_output, sizeof(test_output) - 1, "w");
+    stdout = capture;
+    result = SHELL_Execute(buffer);
+    fclose(capture);
+    stdout = console;
+
+    CHECK(result == expect, "\"%s\": returned %u, expected %u (output \"%s\")", line, result, expect, test_output);
+    if (output != NULL) {
+        CHECK(strstr(test_output, output) != NULL, "\"%s\": output \"%s\" lacks \"%s\"", line, test_output, output);
+    }
+}
+
+/**
+  * @brief  复位仿真和各轴控制结构体，重新初始化命令行
+  * @param  无
+  * @retval 无
+  */
+static void TEST_Reset(void)
+{
+    SimScenario_TypeDef scenario;
+    FILE *console = stdout;
+    uint8_t i;
+
+    stdout = fopen("/dev/null", "w");
+    SIM_ScenarioNominal(&scenario);
+    SIM_Reset(&scenario, 1);
+    for (i = 0; i < TEST_AXES; i++) {
+        ANGLE_CONTROL_Init(&test_controls[i], CONTROL_MODE_IDLE, &test_fans[i], &test_sensors[i]);
+    }
+    SHELL_Init(test_controls, TEST_AXES);
+    fclose(stdout);
+    stdout = console;
+}
+
+static void TEST_Tokenize(void)
+{
+    TEST_Reset();
+
+    TEST_Run("", 1, NULL);
+    TEST_Run(" \t \r\n", 1, NULL);
+    TEST_Run("target 12.5", 1, NULL);
+    CHECK(test_controls[0].target_angle == 12.5f, "target %.2f", test_controls[0].target_angle);
+    TEST_Run("   target \t  -20.25  \t\r\n", 1, NULL);
+    CHECK(test_controls[0].target_angle == -20.25f, "target %.2f", test_controls[0].target_angle);
+    TEST_Run("\tmode\tdual\r", 1, NULL);
+    CHECK(test_controls[0].mode == CONTROL_MODE_DUAL_FAN, "mode %d", test_controls[0].mode);
+    TEST_Run("mode idle\n", 1, NULL);
+    TEST_Run("fan  60   40", 1, NULL);
+    CHECK(test_controls[0].fan_base_speed == 60 && test_controls[0].dual_mode_ratio == 40,
+          "fan %u/%u", test_controls[0].fan_base_speed, test_controls[0].dual_mode_ratio);
+
+    /* 分隔符在命令名中间时命令名被切开 */
+    TEST_Run("tar get 5", 0, "Unknown command: tar");
+    TEST_Run("targ\tet 5", 0, "Unknown command: targ");
+}
+
+/**
+  * @brief  生成"seq"加count个参数的命令行
+  * @param  line: 输出缓冲
+  * @param  count: 参数个数(不含命令名)
+  * @retval 无
+  */
+static void TEST_SeqLine(char *line, int count)
+{
+    int i;
+
+    strcpy(line, "seq");
+    for (i = 0; i < count; i++) {
+        sprintf(line + strlen(line), (i & 1) ? " %d" : " %d.5", (i & 1) ? 2 : i - 10);
+    }
+}
+
+static void TEST_ArgcLimits(void)
+{
+    char line[TEST_LINE_LEN];
+
+    TEST_Reset();
+
+    /* 10对角度/保持时间 = 21个参数，能放进argv */
+    TEST_SeqLine(line, 20);
+    TEST_Run(line, 1, NULL);
+    CHECK(test_controls[0].sequence.tail == 11, "seq with 10 steps: %u steps appended", test_controls[0].sequence.tail);
+
+    /* SHELL_ARGC_MAX个参数仍进入命令处理，由seq以奇数个参数拒绝 */
+    TEST_SeqLine(line, SHELL_ARGC_MAX - 1);
+    TEST_Run(line, 0, "Usage: seq");
+
+    /* 再多一个在切分时拒绝，不调用命令处理 */
+    TEST_SeqLine(line, SHELL_ARGC_MAX);
+    TEST_Run(line, 0, "too many arguments");
+    CHECK(strstr(test_output, "Usage") == NULL, "too many arguments also printed usage");
+    TEST_SeqLine(line, 100);
+    TEST_Run(line, 0, "too many arguments");
+    CHECK(test_controls[0].sequence.tail == 11, "rejected seq changed the sequence (%u steps)",
+          test_controls[0].sequence.tail);
+
+    /* 行尾多余的空白不算参数 */
+    TEST_SeqLine(line, SHELL_ARGC_MAX - 1);
+    strcat(line, "        \t\t\r\n");
+    TEST_Run(line, 0, "Usage: seq");
+    CHECK(strstr(test_output, "too many") == NULL, "trailing whitespace counted as arguments");
+
+    /* 命令表的argc_min/argc_max边界 */
+    TEST_Run("help x", 0, "Usage: help");
+    TEST_Run("target", 0, "Usage: target");
+    TEST_Run("target 1 2", 0, "Usage: target");
+    TEST_Run("fan 50", 0, "Usage: fan");
+    TEST_Run("fan 50 50 50", 0, "Usage: fan");
+    TEST_Run("seq", 0, "Usage: seq");
+    TEST_Run("prog", 0, "Usage: prog");
+    TEST_Run("prog move 10 1 100 50 lin x", 0, "Usage: prog");
+    TEST_Run("cal", 0, "Usage: cal");
+    TEST_Run("cal point 1 2", 0, "Usage: cal");
+    TEST_Run("tele ctl sid pwr tim 50", 1, NULL);
+    TEST_Run("tele ctl sid pwr tim all 50", 0, "Usage: tele");
+    TEST_Run("rec", 0, "Usage: rec");
+}
+
+static void TEST_HashLookup(void)
+{
+    /* 每个命令一行合法输入 */
+    static const char *const valid[] = {
+        "help", "axis", "status", "target 5", "mode single", "pid", "fan 50 50", "seq 10 1",
+        "prog status", "stop", "rate 500", "save", "cal zero", "prof", "tele off", "rec stop"
+    };
+    static const char *const unknown[] = {
+        "hel", "helpp", "HELP", "Status", "s", "st", "stat", "targets", "modes", "x", "reset",
+        "cal_zero", "prog_start", "\x7F", "\xB2\xE2\xCA\xD4"
+    };
+    uint8_t used = 0;
+    uint8_t i, j;
+    size_t n;
+
+    TEST_Reset();
+
+    for (i = 0; i < SHELL_HASH_SIZE; i++) {
+        if (g_shell_index[i] != 0) used++;
+    }
+    CHECK(used == SHELL_COMMAND_COUNT, "%u hash slots used for %u commands", used, (unsigned)SHELL_COMMAND_COUNT);
+    CHECK(SHELL_COMMAND_COUNT < SHELL_HASH_SIZE, "hash table has no empty slot to end a probe");
+
+    for (i = 0; i < SHELL_COMMAND_COUNT; i++) {
+        CHECK(SHELL_Find(g_shell_commands[i].name) == (int8_t)i, "%s: found %d, expected %u",
+              g_shell_commands[i].name, SHELL_Find(g_shell_commands[i].name), i);
+
+        /* 命令名不能含空白，否则无法经切分后的argv[0]找到 */
+        CHECK(strpbrk(g_shell_commands[i].name, " \t\r\n") == NULL, "%s: name contains whitespace",
+              g_shell_commands[i].name);
+        CHECK(g_shell_commands[i].argc_min >= 1 && g_shell_commands[i].argc_min <= g_shell_commands[i].argc_max &&
+              g_shell_commands[i].argc_max <= SHELL_ARGC_MAX, "%s: argc range %u-%u",
+              g_shell_commands[i].name, g_shell_commands[i].argc_min, g_shell_commands[i].argc_max);
+
+        /* 经SHELL_Execute分派到该命令 */
+        for (j = 0; j < sizeof(valid) / sizeof(valid[0]); j++) {
+            n = strlen(g_shell_commands[i].name);
+            if (strncmp(valid[j], g_shell_commands[i].name, n) == 0 && (valid[j][n] == ' ' || valid[j][n] == '\0')) {
+                break;
+            }
+        }
+        CHECK(j < sizeof(valid) / sizeof(valid[0]), "%s: no valid line in the test", g_shell_commands[i].name);
+        if (j < sizeof(valid) / sizeof(valid[0])) {
+            TEST_Run(valid[j], 1, NULL);
+        }
+    }
+
+    for (i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++) {
+        CHECK(SHELL_Find(unknown[i]) == -1, "\"%s\" found as command %d", unknown[i], SHELL_Find(unknown[i]));
+    }
+    TEST_Run("reset", 0, "Unknown command: reset");
+    TEST_Run("HELP", 0, "Unknown command: HELP");
+
+    /* 未初始化时拒绝一切命令 */
+    g_shell_controls = NULL;
+    TEST_Run("help", 0, NULL);
+    TEST_Reset();
+}
+
+static void TEST_RejectArguments(void)
+{
+    AngleControl_TypeDef *control = &test_controls[0];
+
+    TEST_Reset();
+    TEST_Run("target 30", 1, NULL);
+    TEST_Run("fan 50 60", 1, NULL);
+    TEST_Run("pid 1 0.5 0.25", 1, NULL);
+
+    /* 浮点参数 */
+    TEST_Run("target abc", 0, "Usage: target");
+    TEST_Run("target 1.5x", 0, "Usage: target");
+    TEST_Run("target 1,5", 0, "Usage: target");
+    TEST_Run("target .", 0, "Usage: target");
+    TEST_Run("target -", 0, "Usage: target");
+    TEST_Run("pid 1 x 2", 0, "Usage: pid");
+    TEST_Run("pid 1 2", 0, "Usage: pid");
+    CHECK(control->target_angle == 30.0f, "rejected target changed target to %.2f", control->target_angle);
+    CHECK(control->pid.Kp == 1.0f && control->pid.Ki == 0.5f && control->pid.Kd == 0.25f,
+          "rejected pid changed gains to %.3f/%.3f/%.3f", control->pid.Kp, control->pid.Ki, control->pid.Kd);
+
+    /* 无符号整数参数：负数、超范围、尾随字符 */
+    TEST_Run("fan 101 50", 0, "Usage: fan");
+    TEST_Run("fan -1 50", 0, "Usage: fan");
+    TEST_Run("fan 50 0x65", 0, "Usage: fan");
+    TEST_Run("fan 50 1e2", 0, "Usage: fan");
+    TEST_Run("fan 50 50%", 0, "Usage: fan");
+    TEST_Run("fan 4294967346 50", 0, "Usage: fan");
+    TEST_Run("fan 100 0x64", 1, NULL);
+    CHECK(control->fan_base_speed == 100 && control->dual_mode_ratio == 100, "fan %u/%u",
+          control->fan_base_speed, control->dual_mode_ratio);
+    TEST_Run("rate 49", 0, "Usage: rate");
+    TEST_Run("rate 1001", 0, "Usage: rate");
+    TEST_Run("rate 0x3E8", 1, NULL);
+    CHECK(ANGLE_CONTROL_GetTickUs() == 1000, "rate 0x3E8: tick %u us", ANGLE_CONTROL_GetTickUs());
+    TEST_Run("axis 2", 0, "Usage: axis");
+    TEST_Run("axis -0", 0, "Usage: axis");
+    TEST_Run("axis 1", 1, "Axis 1 of 2");
+    TEST_Run("target -45", 1, NULL);
+    CHECK(test_controls[1].target_angle == -45.0f && control->target_angle == 30.0f,
+          "axis 1 target went to the wrong axis");
+    TEST_Run("axis 0", 1, NULL);
+
+    /* 模式名和子命令 */
+    TEST_Run("mode fast", 0, "Usage: mode");
+    TEST_Run("mode IDLE", 0, "Usage: mode");
+    TEST_Run("mode 2", 0, "Usage: mode");
+    CHECK(control->mode == CONTROL_MODE_IDLE, "rejected mode changed mode to %d", control->mode);
+    TEST_Run("seq 10", 0, "Usage: seq");
+    TEST_Run("seq 10 256", 0, "Usage: seq");
+    TEST_Run("seq 10 -1", 0, "Usage: seq");
+    TEST_Run("seq x 1", 0, "Usage: seq");
+    TEST_Run("seq begin", 0, "Usage: seq");
+    TEST_Run("prog bogus", 0, "Usage: prog");
+    TEST_Run("prog clear all", 0, "Usage: prog");
+    TEST_Run("prog start 99", 0, "Usage: prog");
+    TEST_Run("prog key 256", 0, "Usage: prog");
+    TEST_Run("prog move 91 1 100", 0, "Usage: prog");
+    TEST_Run("prog move 10 -1 100", 0, "Usage: prog");
+    TEST_Run("prog move 10 1 100 50", 0, "Usage: prog");
+    TEST_Run("prog move 10 1 100 0 lin", 0, "Usage: prog");
+    TEST_Run("prog move 10 1 100 50 fast", 0, "Usage: prog");
+    TEST_Run("prog delay", 0, "Usage: prog");
+    TEST_Run("prog wait 256", 0, "Usage: prog");
+    TEST_Run("prog loop 32768", 0, "Usage: prog");
+    TEST_Run("prog end now", 0, "Usage: prog");
+    TEST_Run("prog clear", 1, NULL);
+    TEST_Run("prog move 10 1 100 50 smooth", 1, NULL);
+    TEST_Run("prog wait 1 500", 1, NULL);
+    TEST_Run("prog end", 1, NULL);
+    CHECK(control->sequence.tail == 3, "%u steps appended, expected 3", control->sequence.tail);
+    TEST_Run("cal point -12.5", 1, NULL);
+    CHECK(test_cal_angle == -12.5f, "calibration point %.2f", test_cal_angle);
+    TEST_Run("axis 1", 1, NULL);
+    TEST_Run("cal save", 1, NULL);
+    CHECK(test_cal_sensors == &test_sensors[0] && test_cal_count == TEST_AXES,
+          "cal save passed sensor %p and %u axes", (void *)test_cal_sensors, test_cal_count);
+    TEST_Run("axis 0", 1, NULL);
+    TEST_Run("cal zero 1", 0, "Usage: cal");
+    TEST_Run("cal point abc", 0, "Usage: cal");
+    TEST_Run("cal bogus", 0, "Usage: cal");
+    TEST_Run("prof clear", 0, "Usage: prof");
+    TEST_Run("tele ctl foo", 0, "Usage: tele");
+    TEST_Run("tele 50 ctl", 0, "Usage: tele");
+    TEST_Run("tele ctl 70000", 0, "Usage: tele");
+    TEST_Run("tele ctl tim 250", 1, "Telemetry channels 0x09");
+    CHECK(test_tele_channels == 0x09 && test_tele_period == 250, "telemetry 0x%02X every %u ms",
+          test_tele_channels, test_tele_period);
+    TEST_Run("tele off", 1, NULL);
+    CHECK(test_tele_channels == TELEMETRY_CH_NONE, "tele off left channels 0x%02X", test_tele_channels);
+    TEST_Run("rec pause", 0, "Usage: rec");
+}
+
+static void TEST_Process(void)
+{
+    static const char *const script[] = {
+        "target 10", "", "\x01\x05\x01\x02", "bogus", "axis 1", "target 20", "axis 0", NULL
+    };
+    FILE *console = stdout;
+
+    TEST_Reset();
+    test_script = script;
+    test_script_pos = 0;
+    test_frames = 0;
+
+    stdout = fopen("/dev/null", "w");
+    SHELL_Process();
+    fclose(stdout);
+    stdout = console;
+
+    CHECK(test_script_pos == 7, "SHELL_Process consumed %u of 7 items", test_script_pos);
+    CHECK(test_frames == 1 && test_frame_len == 3, "%u frame(s), last length %u", test_frames, test_frame_len);
+    CHECK(USART_RX_STA == 0 && USART_RX_FRAME_STA == 0, "receive status not released");
+    CHECK(test_controls[0].target_angle == 10.0f && test_controls[1].target_angle == 20.0f,
+          "targets %.1f/%.1f after the batch", test_controls[0].target_angle, test_controls[1].target_angle);
+    CHECK(g_shell_axis == 0, "axis %u after the batch", g_shell_axis);
+    test_script = NULL;
+}
+
+int main(void)
+{
+    TEST_Tokenize();
+    TEST_ArgcLimits();
+    TEST_HashLookup();
+    TEST_RejectArguments();
+    TEST_Process();
+
+    printf("%s: %d failure(s)\n", test_failures ? "FAIL" : "OK", test_failures);
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,271 @@
+/**
+  ******************************************************************************
+  * @file    sim_hw.c
+  * @brief   控制代码所需硬件接口的主机仿真实现
+  ******************************************************************************
+  * 实现angle_control.c调用的风扇驱动、角度传感器、测速、电流检测、时基和参数存储接口，
+  * 全部读写sim_panel.c的g_sim。只模拟接口语义(暂存/提交、斜坡、过采样窗口、故障标志)，
+  * 不模拟寄存器。推力指令的占空比按默认PWM周期量化；抖动使能时各PWM周期的平均值
+  * 保留小数部分，PWM周期远短于风扇时间常数，按不量化处理。仿真只有一个轴，驱动/传感器实例指针只用于保存偏移等实例字段。
+  ******************************************************************************
+  */
+
+#include "sim_panel.h"
+#include "fan_driver.h"
+#include "angle_sensor.h"
+#include "tach.h"
+#include "current_sense.h"
+#include "param_store.h"
+#include "timebase.h"
+#include <math.h>
+
+#define SIM_CPU_CLOCK_MHZ    72        // TIMEBASE周期计数的换算频率
+#define SIM_PWM_PERIOD       (FAN_TIM_CLOCK / FAN_PWM_FREQ) // 默认PWM周期计数(ARR+1)
+
+/* ---------------------------- 风扇驱动 ---------------------------- */
+
+void FAN_StopAll(FanDriver_TypeDef *drv)
+{
+    uint8_t i;
+
+    for (i = 0; i < FAN_COUNT; i++) {
+        g_sim.duty[i] = 0.0f;
+        g_sim.duty_target[i] = 0.0f;
+        g_sim.duty_stage[i] = 0.0f;
+        g_sim.ramping[i] = 0;
+        g_sim.ramp_armed[i] = 0;
+    }
+}
+
+/**
+  * @brief  设置目标占空比
+  * @note   与fan_driver.c的FAN_SetTarget相同：只有预置斜坡或斜坡进行中时按加/减速率过渡
+  */
+static void SIM_SetDutyTarget(uint8_t fan, float duty)
+{
+    if (duty != g_sim.duty[fan] && g_sim.ramp_armed[fan]) {
+        g_sim.ramp_armed[fan] = 0;
+        g_sim.ramping[fan] = 1;
+    }
+    g_sim.duty_target[fan] = duty;
+}
+
+void FAN_SoftStopAll(FanDriver_TypeDef *drv)
+{
+    uint8_t i;
+
+    for (i = 0; i < FAN_COUNT; i++) {
+        g_sim.ramp_armed[i] = 1;
+        SIM_SetDutyTarget(i, 0.0f);
+        g_sim.duty_stage[i] = 0.0f;
+    }
+}
+
+void FAN_SetRamp(FanDriver_TypeDef *drv, float accel, float decel)
+{
+    g_sim.accel = (accel > 0.0f) ? accel : 0.0f;
+    g_sim.decel = (decel > 0.0f) ? decel : 0.0f;
+}
+
+void FAN_ArmRamp(FanDriver_TypeDef *drv)
+{
+    g_sim.ramp_armed[FAN_LEFT] = 1;
+    g_sim.ramp_armed[FAN_RIGHT] = 1;
+}
+
+void FAN_StageSpeed(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint8_t speed)
+{
+    if (speed > FAN_MAX_DUTY) speed = FAN_MAX_DUTY;
+    g_sim.duty_stage[fan] = speed / 100.0f;
+}
+
+/* 默认推力->占空比表为 占空比 = sqrt(推力) */
+void FAN_StageThrust(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, uint16_t thrust)
+{
+    float duty;
+
+    if (thrust > FAN_THRUST_MAX) thrust = FAN_THRUST_MAX;
+    duty = sqrtf((float)thrust / FAN_THRUST_MAX);
+    if (!g_sim.dither) {
+        /* 比较值四舍五入到整数 */
+        duty = floorf(duty * (SIM_PWM_PERIOD - 1) + 0.5f) / (SIM_PWM_PERIOD - 1);
+    }
+    g_sim.duty_stage[fan] = duty;
+}
+
+void FAN_StageDirection(FanDriver_TypeDef *drv, FanSelect_TypeDef fan, FanDirection_TypeDef direction)
+{
+    /* 控制代码只使用正方向 */
+}
+
+void FAN_Commit(FanDriver_TypeDef *drv)
+{
+    uint8_t i;
+
+    for (i = 0; i < FAN_COUNT; i++) {
+        SIM_SetDutyTarget(i, g_sim.duty_stage[i]);
+    }
+}
+
+void FAN_EnableDither(FanDriver_TypeDef *drv, uint8_t enable)
+{
+    g_sim.dither = enable ? 1 : 0;
+}
+
+void FAN_ClearFault(FanDriver_TypeDef *drv, FanSelect_TypeDef fan)
+{
+}
+
+uint32_t FAN_GetPwmFrequency(FanDriver_TypeDef *drv)
+{
+    return FAN_PWM_FREQ;
+}
+
+uint8_t FAN_GetResolutionBits(FanDriver_TypeDef *drv)
+{
+    return FAN_PWM_MIN_BITS;
+}
+
+/* ---------------------------- 角度传感器 ---------------------------- */
+
+/**
+  * @brief  取最近完成的过采样窗口
+  * @note   窗口连续首尾相接；窗口内角度变化很小，按结束时刻的角度采样
+  */
+static void SIM_UpdateWindow(void)
+{
+    uint32_t window = SIM_WindowUs();
+    uint64_t end = g_sim.time_us - g_sim.time_us % window;
+
+    if (end != g_sim.window_end || end == 0) {
+        g_sim.window_end = end;
+        g_sim.window_adc = SIM_SampleAdc();
+    }
+}
+
+AngleSensorStatus_TypeDef ANGLE_SENSOR_GetAngleQ16(AngleSensor_TypeDef *sensor, int32_t *angle_q16,
+                                                   uint64_t *timestamp)
+{
+    float angle;
+
+    SIM_UpdateWindow();
+    angle = (g_sim.window_adc - SIM_ADC_MID) / SIM_ADC_PER_DEG;
+    *angle_q16 = (int32_t)(angle * 65536.0f) + sensor->offset_q16;
+    if (timestamp != NULL) *timestamp = g_sim.window_end;
+    return ANGLE_SENSOR_OK;
+}
+
+int32_t ANGLE_SENSOR_RawToAngleQ16(AngleSensor_TypeDef *sensor, uint32_t adc_sum, uint8_t count)
+{
+    float angle;
+
+    if (count == 0) return sensor->offset_q16;
+    angle = ((float)adc_sum / count - SIM_ADC_MID) / SIM_ADC_PER_DEG;
+    return (int32_t)(angle * 65536.0f) + sensor->offset_q16;
+}
+
+float ANGLE_SENSOR_GetAngleAt(AngleSensor_TypeDef *sensor, uint64_t *timestamp)
+{
+    int32_t angle_q16;
+
+    ANGLE_SENSOR_GetAngleQ16(sensor, &angle_q16, timestamp);
+    return angle_q16 / 65536.0f;
+}
+
+uint8_t ANGLE_SENSOR_GetFault(AngleSensor_TypeDef *sensor)
+{
+    SIM_UpdateWindow();
+    if (g_sim.window_adc < SIM_ADC_MIN || g_sim.window_adc > SIM_ADC_MAX) {
+        return ANGLE_SENSOR_FAULT_RANGE;
+    }
+    return 0;
+}
+
+void ANGLE_SENSOR_SetOffset(AngleSensor_TypeDef *sensor, float offset_angle)
+{
+    sensor->offset = offset_angle;
+    sensor->offset_q16 = (int32_t)(offset_angle * 65536.0f);
+}
+
+float ANGLE_SENSOR_GetOffset(AngleSensor_TypeDef *sensor)
+{
+    return sensor->offset;
+}
+
+uint16_t ANGLE_SENSOR_GetOversampling(void)
+{
+    return (uint16_t)(1U << g_sim.osr_log2);
+}
+
+/* 与angle_sensor.c相同的选择规则 */
+uint8_t ANGLE_SENSOR_FitOversampling(uint32_t period_us)
+{
+    uint32_t scans = (uint32_t)(((uint64_t)period_us * 1000) / (SIM_ADC_CONVERSION_NS * SIM_ADC_CHANNELS));
+    uint8_t osr_log2 = ANGLE_SENSOR_OSR_LOG2_MIN;
+
+    while (osr_log2 < ANGLE_SENSOR_OSR_LOG2_DEFAULT && (2UL << osr_log2) <= scans) {
+        osr_log2++;
+    }
+    g_sim.osr_log2 = osr_log2;
+    g_sim.window_end = 0;
+    return osr_log2;
+}
+
+/* ---------------------------- 测速/电流(仿真中不关联) ---------------------------- */
+
+void TACH_Update(Tach_TypeDef *tach, uint16_t now)
+{
+}
+
+uint16_t TACH_GetCounter(Tach_TypeDef *tach)
+{
+    return (uint16_t)g_sim.time_us;
+}
+
+float TACH_GetRpm(Tach_TypeDef *tach)
+{
+    return 0.0f;
+}
+
+uint8_t TACH_IsStalled(Tach_TypeDef *tach)
+{
+    return 1;
+}
+
+void CURRENT_SENSE_Update(CurrentSense_TypeDef *cs)
+{
+}
+
+/* ---------------------------- 时基 ---------------------------- */
+
+uint32_t TIMEBASE_GetCycles(void)
+{
+    return (uint32_t)(g_sim.time_us * SIM_CPU_CLOCK_MHZ);
+}
+
+uint64_t TIMEBASE_GetMicros(void)
+{
+    return g_sim.time_us;
+}
+
+/* ---------------------------- 参数存储(空) ---------------------------- */
+
+ParamStatus_TypeDef PARAM_Get(uint16_t key, void *data, uint16_t len)
+{
+    return PARAM_NOT_FOUND;
+}
+
+ParamStatus_TypeDef PARAM_GetVar(uint16_t key, void *data, uint16_t size, uint16_t *len)
+{
+    return PARAM_NOT_FOUND;
+}
+
+ParamStatus_TypeDef PARAM_Set(uint16_t key, const void *data, uint16_t len)
+{
+    return PARAM_OK;
+}
+
+ParamStatus_TypeDef PARAM_Delete(uint16_t key)
+{
+    return PARAM_OK;
+}
@@ -0,0 +1,208 @@
+/**
+  ******************************************************************************
+  * @file    sim_panel.c
+  * @brief   风力板被控对象仿真模型实现(主机程序)
+  ******************************************************************************
+  */
+
+#include "sim_panel.h"
+#include <math.h>
+#include <string.h>
+
+#define SIM_GRAVITY          9.81f
+#define SIM_PI               3.14159265f
+#define SIM_DEG_PER_RAD      (180.0f / SIM_PI)
+
+/* 随机场景范围 */
+#define SIM_MASS_NOMINAL     0.10f     // 标称板子质量(kg)
+#define SIM_MASS_SPREAD      0.20f     // 质量±20%
+#define SIM_FAN_SPREAD       0.20f     // 风扇推力±20%
+#define SIM_NOISE_MIN        0.5f      // 噪声范围(ADC计数，1σ)
+#define SIM_NOISE_MAX        4.0f
+#define SIM_OFFSET_MAX       20.0f     // ADC零点偏移±20计数(约±1.1度)
+#define SIM_SUPPLY_MIN       11.0f     // 电源电压范围(V)
+#define SIM_SUPPLY_MAX       12.6f
+
+SimPanel_TypeDef g_sim;
+
+/**
+  * @brief  标称场景
+  * @param  scenario: 场景参数
+  * @retval 无
+  */
+void SIM_ScenarioNominal(SimScenario_TypeDef *scenario)
+{
+    scenario->mass = SIM_MASS_NOMINAL;
+    scenario->fan_strength = 1.0f;
+    scenario->noise = 1.0f;
+    scenario->adc_offset = 0.0f;
+    scenario->supply = SIM_SUPPLY_NOMINAL;
+}
+
+/**
+  * @brief  由种子生成随机场景
+  * @param  scenario: 场景参数
+  * @param  seed: 种子，同一种子总是生成同一场景
+  * @retval 无
+  */
+void SIM_ScenarioRandom(SimScenario_TypeDef *scenario, uint64_t seed)
+{
+    uint64_t state = seed;
+
+    scenario->mass = SIM_MASS_NOMINAL * SIM_Uniform(&state, 1.0f - SIM_MASS_SPREAD, 1.0f + SIM_MASS_SPREAD);
+    scenario->fan_strength = SIM_Uniform(&state, 1.0f - SIM_FAN_SPREAD, 1.0f + SIM_FAN_SPREAD);
+    scenario->noise = SIM_Uniform(&state, SIM_NOISE_MIN, SIM_NOISE_MAX);
+    scenario->adc_offset = SIM_Uniform(&state, -SIM_OFFSET_MAX, SIM_OFFSET_MAX);
+    scenario->supply = SIM_Uniform(&state, SIM_SUPPLY_MIN, SIM_SUPPLY_MAX);
+}
+
+/**
+  * @brief  复位仿真
+  * @param  scenario: 场景参数
+  * @param  seed: 传感器噪声种子
+  * @retval 无
+  * @note   板子静止于0度，风扇停转，过采样率为固件默认值
+  */
+void SIM_Reset(const SimScenario_TypeDef *scenario, uint64_t seed)
+{
+    memset(&g_sim, 0, sizeof(g_sim));
+    g_sim.scenario = *scenario;
+    g_sim.osr_log2 = 8;
+    g_sim.rng = seed ^ 0x5DEECE66DULL;
+}
+
+/**
+  * @brief  推进仿真时间
+  * @param  dt_us: 时长(us)，按SIM_STEP_US分步积分
+  * @retval 无
+  */
+void SIM_Step(uint32_t dt_us)
+{
+    const SimScenario_TypeDef *sc = &g_sim.scenario;
+    float inertia = sc->mass * SIM_PANEL_LENGTH * SIM_PANEL_LENGTH / 3.0f;
+    float gravity = sc->mass * SIM_GRAVITY * SIM_PANEL_LENGTH * 0.5f;
+    float force = SIM_FAN_FORCE * sc->fan_strength;
+    float volt = sc->supply / SIM_SUPPLY_NOMINAL;
+    float h, torque, limit = SIM_ANGLE_LIMIT / SIM_DEG_PER_RAD;
+    uint32_t step;
+    uint8_t i;
+
+    while (dt_us > 0) {
+        step = (dt_us > SIM_STEP_US) ? SIM_STEP_US : dt_us;
+        h = step * 1e-6f;
+
+        for (i = 0; i < 2; i++) {
+            /* 斜坡 */
+            float rate = (g_sim.duty_target[i] > g_sim.duty[i]) ? g_sim.accel : g_sim.decel;
+            float diff = g_sim.duty_target[i] - g_sim.duty[i];
+            if (!g_sim.ramping[i] || rate <= 0.0f || fabsf(diff) <= rate * h) {
+                g_sim.duty[i] = g_sim.duty_target[i];
+                g_sim.ramping[i] = 0;
+            } else {
+                g_sim.duty[i] += (diff > 0.0f) ? rate * h : -rate * h;
+            }
+            /* 转速一阶滞后 */
+            g_sim.speed[i] += (g_sim.duty[i] * volt - g_sim.speed[i]) * (h / SIM_FAN_TAU);
+        }
+
+        torque = SIM_FAN_ARM * force * (g_sim.speed[1] * g_sim.speed[1] - g_sim.speed[0] * g_sim.speed[0])
+               - gravity * sinf(g_sim.theta) - SIM_DAMPING * g_sim.omega;
+        g_sim.omega += torque / inertia * h;
+        g_sim.theta += g_sim.omega * h;
+
+        /* 机械限位 */
+        if (g_sim.theta > limit) {
+            g_sim.theta = limit;
+            if (g_sim.omega > 0.0f) g_sim.omega = 0.0f;
+        } else if (g_sim.theta < -limit) {
+            g_sim.theta = -limit;
+            if (g_sim.omega < 0.0f) g_sim.omega = 0.0f;
+        }
+
+        g_sim.time_us += step;
+        dt_us -= step;
+    }
+}
+
+/**
+  * @brief  真实角度
+  * @param  无
+  * @retval float: 角度(度)
+  */
+float SIM_GetAngle(void)
+{
+    return g_sim.theta * SIM_DEG_PER_RAD;
+}
+
+/**
+  * @brief  一个过采样窗口的平均ADC计数
+  * @param  无
+  * @retval float: 平均计数，分辨率1/OSR
+  * @note   噪声按平均后的σ/sqrt(OSR)直接生成；噪声小于0.5计数时单个样本
+  *         几乎不抖动，先量化到整数再平均，过采样不再提高分辨率
+  */
+float SIM_SampleAdc(void)
+{
+    const SimScenario_TypeDef *sc = &g_sim.scenario;
+    float osr = (float)(1UL << g_sim.osr_log2);
+    float x = SIM_ADC_MID + SIM_GetAngle() * SIM_ADC_PER_DEG + sc->adc_offset;
+
+    if (sc->noise < 0.5f) {
+        x = floorf(x + 0.5f);
+    }
+    x += sc->noise / sqrtf(osr) * SIM_Gaussian(&g_sim.rng);
+    x = floorf(x * osr + 0.5f) / osr;
+
+    if (x < 0.0f) x = 0.0f;
+    if (x > 4095.0f) x = 4095.0f;
+    return x;
+}
+
+/**
+  * @brief  过采样窗口时长
+  * @param  无
+  * @retval uint32_t: 窗口时长(us)
+  */
+uint32_t SIM_WindowUs(void)
+{
+    return (uint32_t)(((uint64_t)SIM_ADC_CHANNELS * SIM_ADC_CONVERSION_NS << g_sim.osr_log2) / 1000);
+}
+
+/**
+  * @brief  64位伪随机数(splitmix64)
+  * @param  state: 随机数状态
+  * @retval uint64_t: 随机数
+  */
+uint64_t SIM_Random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+  * @brief  均匀分布
+  * @param  state: 随机数状态
+  * @param  min: 下限
+  * @param  max: 上限
+  * @retval float: [min, max)内的随机数
+  */
+float SIM_Uniform(uint64_t *state, float min, float max)
+{
+    return min + (max - min) * (float)((SIM_Random(state) >> 40) * (1.0 / 16777216.0));
+}
+
+/**
+  * @brief  标准正态分布(Box-Muller)
+  * @param  state: 随机数状态
+  * @retval float: 随机数
+  */
+float SIM_Gaussian(uint64_t *state)
+{
+    float u1 = SIM_Uniform(state, 1e-7f, 1.0f);
+    float u2 = SIM_Uniform(state, 0.0f, 1.0f);
+
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * SIM_PI * u2);
+}
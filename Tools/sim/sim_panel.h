@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    sim_panel.h
+  * @brief   风力板被控对象仿真模型头文件(主机程序)
+  ******************************************************************************
+  */
+
+#ifndef __SIM_PANEL_H
+#define __SIM_PANEL_H
+
+#include <stdint.h>
+
+/*
+ * 板子绕上端铰链摆动，左右风扇在力臂SIM_FAN_ARM处产生相反力矩：
+ *   J * theta'' = ARM * (F_right - F_left) - m * g * L/2 * sin(theta) - DAMPING * theta'
+ *   J = m * L^2 / 3
+ * 风扇转速一阶滞后跟随 占空比*电源电压/标称电压，推力与转速平方成正比。
+ * 角度传感器按ADC_MID/ADC_MAX的默认两段线性关系把角度换算为ADC计数，
+ * 叠加零点偏移和高斯噪声后按过采样率平均并量化。
+ * 参数为样机的粗略估计，用于比较控制参数的鲁棒性而非精确预测。
+ */
+#define SIM_PANEL_LENGTH      0.20f     // 板长(m)，铰链到下沿
+#define SIM_FAN_ARM           0.15f     // 风扇推力到铰链的力臂(m)
+#define SIM_FAN_FORCE         1.0f      // 标称电压满速单风扇推力(N)
+#define SIM_FAN_TAU           0.15f     // 风扇转速时间常数(s)
+#define SIM_DAMPING           0.04f     // 空气阻尼(N*m*s/rad)
+#define SIM_ANGLE_LIMIT       135.0f    // 机械限位(度)
+#define SIM_SUPPLY_NOMINAL    12.0f     // 标称风扇电压(V)
+#define SIM_STEP_US           250       // 模型积分步长(us)
+
+/* 传感器ADC模型，与angle_sensor.c的默认两段线性表一致 */
+#define SIM_ADC_MID           2420.0f   // 0度ADC计数
+#define SIM_ADC_PER_DEG       (1600.0f / 90.0f) // 每度ADC计数
+#define SIM_ADC_MIN           820.0f    // 有效范围下限(超出报量程故障)
+#define SIM_ADC_MAX           4020.0f   // 有效范围上限
+#define SIM_ADC_CHANNELS      3         // 扫描通道数，决定过采样窗口时长
+#define SIM_ADC_CONVERSION_NS 5667      // 单次转换时间(ns)
+
+/* 场景参数 */
+typedef struct {
+    float mass;                  // 板子质量(kg)
+    float fan_strength;          // 风扇推力系数(相对SIM_FAN_FORCE)
+    float noise;                 // 传感器噪声(ADC计数，1σ)
+    float adc_offset;            // ADC零点偏移(计数)
+    float supply;                // 风扇电源电压(V)
+} SimScenario_TypeDef;
+
+/* 仿真状态 */
+typedef struct {
+    SimScenario_TypeDef scenario;
+    uint64_t time_us;            // 仿真时间(us)
+
+    /* 板子 */
+    float theta;                 // 角度(rad)
+    float omega;                 // 角速度(rad/s)
+
+    /* 风扇 */
+    float duty[2];               // 经斜坡后的占空比(0-1)，左、右
+    float duty_target[2];        // 目标占空比(0-1)
+    float duty_stage[2];         // 暂存占空比，FAN_Commit时生效
+    uint8_t dither;              // 1: PWM抖动使能，推力指令的占空比不量化
+    float speed[2];              // 转速(相对标称电压满速)
+    float accel;                 // 加速率(满量程/s)，0表示立即到达
+    float decel;                 // 减速率(满量程/s)，0表示立即到达
+    uint8_t ramping[2];          // 斜坡进行中
+    uint8_t ramp_armed[2];       // 下一次目标变化按斜坡过渡
+
+    /* 传感器 */
+    uint8_t osr_log2;            // 过采样率(log2)
+    uint64_t window_end;         // 最近一个过采样窗口的结束时刻(us)
+    float window_adc;            // 该窗口的平均ADC计数
+    uint64_t rng;                // 噪声随机数状态
+} SimPanel_TypeDef;
+
+extern SimPanel_TypeDef g_sim;   // 每个进程一个仿真实例，sim_hw.c的硬件接口读写它
+
+/* 函数声明 */
+void SIM_ScenarioNominal(SimScenario_TypeDef *scenario);                   // 标称场景
+void SIM_ScenarioRandom(SimScenario_TypeDef *scenario, uint64_t seed);     // 由种子生成随机场景
+void SIM_Reset(const SimScenario_TypeDef *scenario, uint64_t seed);        // 复位仿真：板子静止于0度，风扇停转
+void SIM_Step(uint32_t dt_us);                                             // 推进仿真时间
+float SIM_GetAngle(void);                                                  // 真实角度(度)
+float SIM_SampleAdc(void);                                                 // 一个过采样窗口的平均ADC计数
+uint32_t SIM_WindowUs(void);                                               // 过采样窗口时长(us)
+uint64_t SIM_Random(uint64_t *state);                                      // 64位伪随机数(splitmix64)
+float SIM_Uniform(uint64_t *state, float min, float max);                  // 均匀分布
+float SIM_Gaussian(uint64_t *state);                                       // 标准正态分布
+
+#endif /* __SIM_PANEL_H */
@@ -5,8 +5,16 @@
 #include "oled.h"
 #include "fan_driver.h"
 #include "angle_sensor.h"
+#include "tach.h"
+#include "current_sense.h"
+#include "param_store.h"
 #include "angle_control.h"
 #include "pid_controller.h"
+#include "telemetry.h"
+#include "recorder.h"
+#include "shell.h"
+#include "rpc.h"
+#include "timebase.h"
 #include <string.h>
 #include <math.h>
 
@@ -24,11 +32,36 @@ typedef enum {
     MODE_SINGLE_FAN_45DEG,    // 45ģʽ
     MODE_SINGLE_FAN_ANY,      // Ƕģʽ
     MODE_DUAL_FAN_ANY,        // ˫Ƕģʽ
-    MODE_DUAL_FAN_SEQUENCE    // ˫ģʽ
+    MODE_DUAL_FAN_SEQUENCE,   // ˫ģʽ
+    MODE_DUAL_FAN_MPC         // ˫MPCǶģʽ
 } WorkMode_TypeDef;
 
+/* 弶Ӳiʹõi͵iǶȴ */
+#define BOARD_AXIS_MAX  3
+#if ANGLE_CONTROL_AXIS_COUNT > BOARD_AXIS_MAX
+#error "ANGLE_CONTROL_AXIS_COUNT exceeds the axes described by this board"
+#endif
+static const FanDriverConfig_TypeDef *const g_fan_configs[BOARD_AXIS_MAX] = {
+    &FAN_DRIVER_CONFIG_TIM2, &FAN_DRIVER_CONFIG_TIM8, &FAN_DRIVER_CONFIG_TIM1
+};
+static const AngleSensorConfig_TypeDef *const g_sensor_configs[BOARD_AXIS_MAX] = {
+    &ANGLE_SENSOR_CONFIG_PA3, &ANGLE_SENSOR_CONFIG_PC2, &ANGLE_SENSOR_CONFIG_PC3
+};
+/* (,)NULLʾ÷δӲ */
+static const TachConfig_TypeDef *const g_tach_configs[BOARD_AXIS_MAX][FAN_COUNT] = {
+    {&TACH_CONFIG_TIM3_CH1, &TACH_CONFIG_TIM5_CH1}, {NULL, NULL}, {NULL, NULL}
+};
+/* (ADC1ֻһעͨһ)NULLʾδӷ */
+static const CurrentSenseConfig_TypeDef *const g_current_configs[BOARD_AXIS_MAX] = {
+    &CURRENT_SENSE_CONFIG_TIM2, NULL, NULL
+};
+
 /* ȫֱ */
-AngleControl_TypeDef g_angle_control;   // Ƕȿƽṹ
+static FanDriver_TypeDef g_fan_drivers[ANGLE_CONTROL_AXIS_COUNT];       // 
+static AngleSensor_TypeDef g_angle_sensors[ANGLE_CONTROL_AXIS_COUNT];   // Ƕȴ
+static Tach_TypeDef g_tachs[ANGLE_CONTROL_AXIS_COUNT][FAN_COUNT];       // Ȳ
+static CurrentSense_TypeDef g_current_sense;                            // ȵ
+AngleControl_TypeDef g_angle_controls[ANGLE_CONTROL_AXIS_COUNT];        // Ƕȿƽṹ壬0ɽ
 static SystemState_TypeDef g_systemState;      // ϵͳ״̬
 static WorkMode_TypeDef g_workMode;            // ģʽ
 static float g_targetAngle = 0.0f;            // ĿǶ
@@ -49,6 +82,7 @@ static void UserInterface_Process(void);
 static void ProcessKeys(void);
 static void MenuManager(void);
 static void ConfigureControlMode(WorkMode_TypeDef mode);
+static uint8_t ControlIdle(void);
 void DisplayStatus(void);
 
 /*
@@ -60,13 +94,62 @@ void DisplayStatus(void);
  */
 static void System_Init(void)
 {
+    uint8_t i, j;
+    
     NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
     delay_init();
     uart_init(115200);
     KEY_Init();
+    TIMEBASE_Init();
     
-    // ʼǶȿϵͳ
-    ANGLE_CONTROL_Init(&g_angle_control, CONTROL_MODE_IDLE);
+    // ʼӲADC1ɨ
+    if(ANGLE_SENSOR_Init(g_angle_sensors, g_sensor_configs, ANGLE_CONTROL_AXIS_COUNT) != ANGLE_SENSOR_OK) {
+        printf("Angle sensor init failed\r\n");
+    }
+    // ز洢ȡУ׼ԻδУ׼ͨʹĬ
+    PARAM_Init();
+    if(ANGLE_SENSOR_LoadCalibration(g_angle_sensors, ANGLE_CONTROL_AXIS_COUNT) > 0) {
+        printf("Angle sensor calibration loaded\r\n");
+    }
+    // ¼ڿƳʼ֮ǰܴϵ翪ʼλط
+    RECORDER_Init(g_angle_controls, ANGLE_CONTROL_AXIS_COUNT);
+    for(i = 0; i < ANGLE_CONTROL_AXIS_COUNT; i++) {
+        if(FAN_Init(&g_fan_drivers[i], g_fan_configs[i]) != FAN_OK) {
+            printf("Fan %d PWM %luHz below %d bits\r\n", i,
+                   (unsigned long)FAN_GetPwmFrequency(&g_fan_drivers[i]), FAN_PWM_MIN_BITS);
+        }
+        
+        // ʼǶȿϵͳ
+        ANGLE_CONTROL_Init(&g_angle_controls[i], CONTROL_MODE_IDLE, &g_fan_drivers[i], &g_angle_sensors[i]);
+        if(ANGLE_CONTROL_LoadParams(&g_angle_controls[i], i) > 0) {
+            printf("Axis %d parameters loaded\r\n", i);
+        }
+        
+        // ʼٲ
+        for(j = 0; j < FAN_COUNT; j++) {
+            if(g_tach_configs[i][j] != NULL) {
+                TACH_Init(&g_tachs[i][j], g_tach_configs[i][j]);
+            }
+        }
+        ANGLE_CONTROL_AttachTach(&g_angle_controls[i],
+                                 g_tach_configs[i][FAN_LEFT] != NULL ? &g_tachs[i][FAN_LEFT] : NULL,
+                                 g_tach_configs[i][FAN_RIGHT] != NULL ? &g_tachs[i][FAN_RIGHT] : NULL);
+        
+        // ʼ(ADC1ɨ֮)
+        if(g_current_configs[i] != NULL) {
+            CURRENT_SENSE_Init(&g_current_sense, g_current_configs[i], &g_fan_drivers[i]);
+            ANGLE_CONTROL_AttachCurrentSense(&g_angle_controls[i], &g_current_sense);
+        }
+    }
+    
+    // ʼң
+    TELEMETRY_Init(TELEMETRY_DEFAULT_PERIOD, TELEMETRY_CH_NONE);
+    
+    // ʼ
+    SHELL_Init(g_angle_controls, ANGLE_CONTROL_AXIS_COUNT);
+    
+    // ʼRPC(֡SHELL_Processת)
+    RPC_Init(g_angle_controls, ANGLE_CONTROL_AXIS_COUNT);
     
     // ʼʱ
     Timer_Init();
@@ -84,20 +167,29 @@ static void System_Init(void)
 static void Timer_Init(void)
 {
     TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    TIM_OCInitTypeDef TIM_OCInitStructure;
     NVIC_InitTypeDef NVIC_InitStructure;
     
     // ʹܶʱʱ
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3 | RCC_APB1Periph_TIM4, ENABLE);
     
-    // TIM3 - 10msж
-    TIM_TimeBaseStructure.TIM_Period = 9999;
+    // TIM3 - 1MHzУٲʱƽCC4Ƚжϲ
+    TIM_TimeBaseStructure.TIM_Period = 0xFFFF;
     TIM_TimeBaseStructure.TIM_Prescaler = 71;
     TIM_TimeBaseStructure.TIM_ClockDivision = 0;
     TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
     TIM_TimeBaseInit(TIM3, &TIM_TimeBaseStructure);
     
-    // TIM4 - 2msж
-    TIM_TimeBaseStructure.TIM_Period = 1999;
+    // TIM3 CC4 - Ƚжϣ(PB1Ϊ)
+    TIM_OCStructInit(&TIM_OCInitStructure);
+    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_Timing;
+    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Disable;
+    TIM_OCInitStructure.TIM_Pulse = ANGLE_CONTROL_TICK_US;
+    TIM_OC4Init(TIM3, &TIM_OCInitStructure);
+    TIM_OC4PreloadConfig(TIM3, TIM_OCPreload_Disable);
+    
+    // TIM4 - 1msжϣΪϵͳʱ(SysTickdelayռãж)
+    TIM_TimeBaseStructure.TIM_Period = 999;
     TIM_TimeBaseInit(TIM4, &TIM_TimeBaseStructure);
     
     // NVIC - TIM3
@@ -107,14 +199,14 @@ static void Timer_Init(void)
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
     
-    // NVIC - TIM4
+    // NVIC - TIM4ʱȼڿжϣѭмʱʧ
     NVIC_InitStructure.NVIC_IRQChannel = TIM4_IRQn;
-    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;
     NVIC_Init(&NVIC_InitStructure);
     
     // ʹܶʱж
-    TIM_ITConfig(TIM3, TIM_IT_Update, ENABLE);
+    TIM_ITConfig(TIM3, TIM_IT_CC4, ENABLE);
     TIM_ITConfig(TIM4, TIM_IT_Update, ENABLE);
     
     // ʱ
@@ -148,8 +240,18 @@ int main(void)
         // û
         UserInterface_Process();
         
+        SHELL_Process();  // кRPC
+        
         DisplayStatus();  // ʾ״̬
         
+        TELEMETRY_Process(g_angle_controls, ANGLE_CONTROL_AXIS_COUNT);  // ң
+        
+        RPC_Process();  // RPCϱ
+        
+        RECORDER_Process();  // Ŀƻ¼
+        
+        PARAM_Service(ControlIdle());  // дFlashȫʱҳ
+        
         // ʱ
         delay_ms(10);
     }
@@ -176,6 +278,7 @@ static void ProcessKeys(void)
     uint8_t key = KEY_Scan();
     if(key == KEY_NONE) return;
     printf("Key: %d\r\n", key);
+    RECORDER_Key(key);
     switch(g_systemState)
     {
 
@@ -187,10 +290,10 @@ static void ProcessKeys(void)
                 else g_workMode--;
                 
                 // ɾظжϣֻ߼
-                if(g_workMode > MODE_DUAL_FAN_SEQUENCE) {
+                if(g_workMode > MODE_DUAL_FAN_MPC) {
                     g_workMode = MODE_IDLE;
                 } else if(g_workMode == MODE_IDLE && key == KEY_DOWN) {
-                    g_workMode = MODE_DUAL_FAN_SEQUENCE;
+                    g_workMode = MODE_DUAL_FAN_MPC;
                 }
             }
             else if(key == KEY_ENTER)
@@ -204,6 +307,13 @@ static void ProcessKeys(void)
                     g_systemState = STATE_RUNNING;
                     g_modeStartTime = ANGLE_CONTROL_GetTime();
                 }
+                else if(g_workMode == MODE_DUAL_FAN_SEQUENCE)
+                {
+                    // ģʽĽǶɳֱӿʼ
+                    ConfigureControlMode(g_workMode);
+                    g_systemState = STATE_RUNNING;
+                    g_modeStartTime = ANGLE_CONTROL_GetTime();
+                }
                 else if(g_workMode != MODE_IDLE)
                 {
                     g_systemState = STATE_ANGLE_SETTING;
@@ -218,7 +328,7 @@ static void ProcessKeys(void)
                 g_targetAngle += 5.0f;
                 if(g_workMode == MODE_SINGLE_FAN_ANY && g_targetAngle > 90.0f)
                     g_targetAngle = 90.0f;
-                else if(g_workMode == MODE_DUAL_FAN_ANY && g_targetAngle > 180.0f)
+                else if((g_workMode == MODE_DUAL_FAN_ANY || g_workMode == MODE_DUAL_FAN_MPC) && g_targetAngle > 180.0f)
                     g_targetAngle = 180.0f;
             }
             else if(key == KEY_DOWN)
@@ -230,7 +340,7 @@ static void ProcessKeys(void)
             {
                 // ʼ
                 ConfigureControlMode(g_workMode);
-                ANGLE_CONTROL_SetTarget(&g_angle_control, g_targetAngle);
+                ANGLE_CONTROL_SetTarget(&g_angle_controls[0], g_targetAngle);
                 g_systemState = STATE_RUNNING;
                 g_modeStartTime = ANGLE_CONTROL_GetTime();
             }
@@ -245,9 +355,14 @@ static void ProcessKeys(void)
             if(key == KEY_MODE)
             {
                 // ֹͣƣز˵
-                ANGLE_CONTROL_Stop(&g_angle_control);
+                ANGLE_CONTROL_Stop(&g_angle_controls[0]);
                 g_systemState = STATE_MENU;
             }
+            else if(g_angle_controls[0].mode == CONTROL_MODE_SEQUENCE)
+            {
+                // ఴгWAIT_KEY
+                ANGLE_CONTROL_SequenceKey(&g_angle_controls[0], key);
+            }
             break;
             
         default:
@@ -265,37 +380,56 @@ static void ConfigureControlMode(WorkMode_TypeDef mode)
     switch(mode)
     {
         case MODE_SINGLE_FAN_45DEG:
-            ANGLE_CONTROL_SetMode(&g_angle_control, CONTROL_MODE_SINGLE_FAN);
-            ANGLE_CONTROL_SetStableCondition(&g_angle_control, 5.0f, 3000);
-            ANGLE_CONTROL_SetTarget(&g_angle_control, 45.0f);
+            ANGLE_CONTROL_SetMode(&g_angle_controls[0], CONTROL_MODE_SINGLE_FAN);
+            ANGLE_CONTROL_SetStableCondition(&g_angle_controls[0], 5.0f, 3000);
+            ANGLE_CONTROL_SetTarget(&g_angle_controls[0], 45.0f);
             break;
             
         case MODE_SINGLE_FAN_ANY:
-            ANGLE_CONTROL_SetMode(&g_angle_control, CONTROL_MODE_SINGLE_FAN);
-            ANGLE_CONTROL_SetStableCondition(&g_angle_control, 5.0f, 3000);
+            ANGLE_CONTROL_SetMode(&g_angle_controls[0], CONTROL_MODE_SINGLE_FAN);
+            ANGLE_CONTROL_SetStableCondition(&g_angle_controls[0], 5.0f, 3000);
             break;
             
         case MODE_DUAL_FAN_ANY:
-            ANGLE_CONTROL_SetMode(&g_angle_control, CONTROL_MODE_DUAL_FAN);
-            ANGLE_CONTROL_SetStableCondition(&g_angle_control, 3.0f, 5000);
+            ANGLE_CONTROL_SetMode(&g_angle_controls[0], CONTROL_MODE_DUAL_FAN);
+            ANGLE_CONTROL_SetStableCondition(&g_angle_controls[0], 3.0f, 5000);
+            break;
+            
+        case MODE_DUAL_FAN_MPC:
+            ANGLE_CONTROL_SetMode(&g_angle_controls[0], CONTROL_MODE_DUAL_FAN_MPC);
+            ANGLE_CONTROL_SetStableCondition(&g_angle_controls[0], 3.0f, 5000);
             break;
             
         case MODE_DUAL_FAN_SEQUENCE:
-            {
-                float angles[] = {45.0f, 60.0f, 90.0f, 120.0f, 135.0f};
-                uint8_t times[] = {3, 3, 3, 3, 3};
-                ANGLE_CONTROL_SetMode(&g_angle_control, CONTROL_MODE_SEQUENCE);
-                ANGLE_CONTROL_ConfigSequence(&g_angle_control, angles, times, 5);
-                ANGLE_CONTROL_SetStableCondition(&g_angle_control, 3.0f, 3000);
+            ANGLE_CONTROL_SetStableCondition(&g_angle_controls[0], 3.0f, 3000);
+            // δϴгʱʹó
+            if(SEQ_IsEmpty(&g_angle_controls[0].sequence)) {
+                ANGLE_CONTROL_LoadProgram(&g_angle_controls[0], SEQ_PROGRAM_DEMO);
             }
+            ANGLE_CONTROL_StartSequence(&g_angle_controls[0]);
             break;
             
         default:
-            ANGLE_CONTROL_SetMode(&g_angle_control, CONTROL_MODE_IDLE);
+            ANGLE_CONTROL_SetMode(&g_angle_controls[0], CONTROL_MODE_IDLE);
             break;
     }
 }
 
+/**
+  * @brief  жǷ
+  * @param  
+  * @retval uint8_t: 1ʾȫᴦڿģʽͣ
+  */
+static uint8_t ControlIdle(void)
+{
+    uint8_t i;
+    
+    for(i = 0; i < ANGLE_CONTROL_AXIS_COUNT; i++) {
+        if(g_angle_controls[i].mode != CONTROL_MODE_IDLE) return 0;
+    }
+    return 1;
+}
+
 /**
   * @brief  ʾ״̬
   * @param  
@@ -304,7 +438,7 @@ static void ConfigureControlMode(WorkMode_TypeDef mode)
 void DisplayStatus(void)
 {
     char buf[8][32];  // ʱ洢ǰҪʾ
-    float current_angle = ANGLE_SENSOR_GetAngle();
+    float current_angle = ANGLE_SENSOR_GetAngle(&g_angle_sensors[0]);
     uint32_t elapsed = 0;
     uint8_t needUpdate = 0;  // ǷҪʾ0=Ҫ1=Ҫ
     uint8_t i;
@@ -346,6 +480,9 @@ void DisplayStatus(void)
                 case MODE_DUAL_FAN_SEQUENCE:
                     strcpy(buf[2], "Sequence Mode");
                     break;
+                case MODE_DUAL_FAN_MPC:
+                    strcpy(buf[2], "Dual Fan MPC");
+                    break;
             }
             break;
             
@@ -28,7 +28,7 @@
 extern void DisplayStatus(void);
 
 /* 定义控制相关变量 */
-extern AngleControl_TypeDef g_angle_control;
+extern AngleControl_TypeDef g_angle_controls[ANGLE_CONTROL_AXIS_COUNT];
 
 void NMI_Handler(void)
 {
@@ -83,12 +83,11 @@ void PendSV_Handler(void)
   * @brief  系统滴答定时器中断处理函数
   * @param  无
   * @retval 无
-  * @note   更新系统时间，并调用系统时间更新函数
+  * @note   SysTick由delay模块以查询方式占用，不开启中断；
+  *         系统时间改由TIM4的1ms中断更新
   */
 void SysTick_Handler(void)
 {
-    /* 更新系统时间 */
-    ANGLE_CONTROL_TimeUpdate();
 }
 
 /**
@@ -99,13 +98,14 @@ void SysTick_Handler(void)
   */
 void TIM3_IRQHandler(void)
 {
-    /* 检查是否是更新中断 */
-    if (TIM_GetITStatus(TIM3, TIM_IT_Update) != RESET)
+    /* 检查是否是CC4比较中断(TIM3自由运行，兼作测速捕获时基) */
+    if (TIM_GetITStatus(TIM3, TIM_IT_CC4) != RESET)
     {
-        /* 清除中断标志位 */
-        TIM_ClearITPendingBit(TIM3, TIM_IT_Update);
-        /* 调用角度控制处理函数 */
-        ANGLE_CONTROL_Process(&g_angle_control);
+        /* 清除中断标志位并推进下一个控制节拍 */
+        TIM_ClearITPendingBit(TIM3, TIM_IT_CC4);
+        TIM_SetCompare4(TIM3, (uint16_t)(TIM_GetCapture4(TIM3) + ANGLE_CONTROL_GetTickUs()));
+        /* 依次处理各轴角度控制 */
+        ANGLE_CONTROL_ProcessAll(g_angle_controls, ANGLE_CONTROL_AXIS_COUNT);
     }
 }
 
@@ -113,6 +113,7 @@ void TIM3_IRQHandler(void)
   * @brief  定时器4中断服务函数
   * @param  无
   * @retval 无
+  * @note   1ms周期，提供系统毫秒时基
   */
 void TIM4_IRQHandler(void)
 {
@@ -122,12 +123,67 @@ void TIM4_IRQHandler(void)
         /* 清除中断标志位 */
         TIM_ClearITPendingBit(TIM4, TIM_IT_Update);
         
-        // 状态显示更新
-        // 例如：角度传感器数据采集或其他2ms周期任务
+        /* 更新系统时间 */
+        ANGLE_CONTROL_TimeUpdate();
         
     }
 }
 
+/**
+  * @brief  定时器2中断服务函数
+  * @param  无
+  * @retval 无
+  * @note   风扇PWM更新中断，仅在使能占空比抖动时开启
+  */
+void TIM2_IRQHandler(void)
+{
+    FAN_IRQHandler(TIM2);
+}
+
+/**
+  * @brief  定时器8更新中断服务函数
+  * @param  无
+  * @retval 无
+  * @note   风扇PWM更新中断，仅在使能占空比抖动时开启
+  */
+void TIM8_UP_IRQHandler(void)
+{
+    FAN_IRQHandler(TIM8);
+}
+
+/**
+  * @brief  定时器1更新中断服务函数
+  * @param  无
+  * @retval 无
+  * @note   风扇PWM更新中断，仅在使能占空比抖动时开启
+  */
+void TIM1_UP_IRQHandler(void)
+{
+    FAN_IRQHandler(TIM1);
+}
+
+/**
+  * @brief  ADC1/ADC2中断服务函数
+  * @param  无
+  * @retval 无
+  * @note   风扇电流注入转换完成，每个PWM周期一次
+  */
+void ADC1_2_IRQHandler(void)
+{
+    CURRENT_SENSE_IRQHandler();
+}
+
+/**
+  * @brief  DMA1通道1中断服务函数
+  * @param  无
+  * @retval 无
+  * @note   角度ADC扫描缓冲半满/全满，约1ms一次
+  */
+void DMA1_Channel1_IRQHandler(void)
+{
+    ANGLE_SENSOR_DMA_IRQHandler();
+}
+
 /******************************************************************************/
 /*                 STM32F10x Peripherals Interrupt Handlers                   */
 /*  Add here the Interrupt Handler for the used peripheral(s) (PPP), for the  */